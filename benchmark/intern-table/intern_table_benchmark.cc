@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni.h"
+
+#include "intern_table.h"
+#include "mirror/object_array-inl.h"
+#include "mirror/string-inl.h"
+#include "runtime.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace {
+
+extern "C" JNIEXPORT void JNICALL Java_InternTableBenchmark_internStrong(
+    JNIEnv* env, jclass, jobjectArray jstrings, jint reps) {
+  ScopedObjectAccess soa(env);
+  InternTable* const intern_table = Runtime::Current()->GetInternTable();
+  const int32_t length = soa.Decode<mirror::ObjectArray<mirror::String>*>(jstrings)->GetLength();
+  for (jint i = 0; i < reps; ++i) {
+    for (int32_t j = 0; j < length; ++j) {
+      // Interning may suspend, decode the array again for every string.
+      mirror::String* s = soa.Decode<mirror::ObjectArray<mirror::String>*>(jstrings)->Get(j);
+      CHECK(intern_table->InternStrong(s) != nullptr);
+    }
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_InternTableBenchmark_lookupStrong(
+    JNIEnv* env, jclass, jobjectArray jstrings, jint reps) {
+  ScopedObjectAccess soa(env);
+  InternTable* const intern_table = Runtime::Current()->GetInternTable();
+  mirror::ObjectArray<mirror::String>* strings =
+      soa.Decode<mirror::ObjectArray<mirror::String>*>(jstrings);
+  for (jint i = 0; i < reps; ++i) {
+    for (int32_t j = 0; j < strings->GetLength(); ++j) {
+      CHECK(intern_table->LookupStrong(soa.Self(), strings->Get(j)) != nullptr);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace art
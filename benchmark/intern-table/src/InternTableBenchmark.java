@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import com.google.caliper.SimpleBenchmark;
+
+public class InternTableBenchmark extends SimpleBenchmark {
+  private static final int NUM_THREADS = 4;
+  private static final int NUM_STRINGS = 1024;
+
+  private final String[] strings = new String[NUM_STRINGS];
+  private final ThreadLocal<Integer> threadIndex = new ThreadLocal<Integer>();
+  private int newStringsCount = 0;
+
+  public InternTableBenchmark() {
+    // Make sure to link methods before benchmark starts.
+    System.loadLibrary("artbenchmark");
+    for (int i = 0; i < NUM_STRINGS; ++i) {
+      strings[i] = "InternTableBenchmark string " + i;
+    }
+    internStrong(strings, 1);
+    lookupStrong(strings, 1);
+  }
+
+  public void timeInternStrongHit(int reps) {
+    internStrong(strings, reps);
+  }
+
+  public void timeInternStrongHitThreads(final int reps) throws InterruptedException {
+    runOnThreads(new Runnable() {
+      public void run() {
+        internStrong(strings, reps);
+      }
+    });
+  }
+
+  public void timeLookupStrongThreads(final int reps) throws InterruptedException {
+    runOnThreads(new Runnable() {
+      public void run() {
+        lookupStrong(strings, reps);
+      }
+    });
+  }
+
+  public void timeStringInternThreads(final int reps) throws InterruptedException {
+    runOnThreads(new Runnable() {
+      public void run() {
+        for (int i = 0; i < reps; ++i) {
+          for (String s : strings) {
+            s.intern();
+          }
+        }
+      }
+    });
+  }
+
+  // Every thread interns its own strings, which are new to the table.
+  public void timeStringInternNewThreads(final int reps) throws InterruptedException {
+    final int first = newStringsCount;
+    newStringsCount += NUM_THREADS * reps;
+    runOnThreads(new Runnable() {
+      public void run() {
+        int start = first + reps * threadIndex.get();
+        for (int i = start; i < start + reps; ++i) {
+          ("InternTableBenchmark new string " + i).intern();
+        }
+      }
+    });
+  }
+
+  private void runOnThreads(final Runnable runnable) throws InterruptedException {
+    Thread[] threads = new Thread[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; ++i) {
+      final int index = i;
+      threads[i] = new Thread(new Runnable() {
+        public void run() {
+          threadIndex.set(index);
+          runnable.run();
+        }
+      });
+    }
+    for (Thread thread : threads) {
+      thread.start();
+    }
+    for (Thread thread : threads) {
+      thread.join();
+    }
+  }
+
+  private static native void internStrong(String[] strings, int reps);
+  private static native void lookupStrong(String[] strings, int reps);
+}
@@ -326,6 +326,13 @@ ifeq ($(ART_USE_TLAB),true)
   art_cflags += -DART_USE_TLAB=1
 endif
 
+# Used to replace the full-size strings and resolved types arrays of the dex caches with
+# fixed-size hashed caches.
+ifeq ($(ART_USE_HASHED_DEX_CACHE),true)
+  art_cflags += -DART_USE_HASHED_DEX_CACHE=1
+  art_asflags += -DART_USE_HASHED_DEX_CACHE=1
+endif
+
 # Cflags for non-debug ART and ART tools.
 art_non_debug_cflags := \
   $(ART_NDEBUG_OPT_FLAG)
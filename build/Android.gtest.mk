@@ -78,8 +78,10 @@ ART_GTEST_dex2oat_test_DEX_DEPS := $(ART_GTEST_dex2oat_environment_tests_DEX_DEP
 ART_GTEST_exception_test_DEX_DEPS := ExceptionHandle
 ART_GTEST_image_test_DEX_DEPS := ImageLayoutA ImageLayoutB
 ART_GTEST_instrumentation_test_DEX_DEPS := Instrumentation
+ART_GTEST_jit_code_snapshot_test_DEX_DEPS := Main Nested
 ART_GTEST_jni_compiler_test_DEX_DEPS := MyClassNatives
 ART_GTEST_jni_internal_test_DEX_DEPS := AllFields StaticLeafMethods
+ART_GTEST_multi_dex_type_lookup_table_test_DEX_DEPS := MultiDex
 ART_GTEST_oat_file_assistant_test_DEX_DEPS := $(ART_GTEST_dex2oat_environment_tests_DEX_DEPS)
 ART_GTEST_oat_file_test_DEX_DEPS := Main MultiDex
 ART_GTEST_oat_test_DEX_DEPS := Main
@@ -219,6 +221,8 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/gc/accounting/mod_union_table_test.cc \
   runtime/gc/accounting/space_bitmap_test.cc \
   runtime/gc/collector/immune_spaces_test.cc \
+  runtime/gc/allocation_sampler_test.cc \
+  runtime/gc/gc_stats_test.cc \
   runtime/gc/heap_test.cc \
   runtime/gc/reference_queue_test.cc \
   runtime/gc/space/dlmalloc_space_static_test.cc \
@@ -226,10 +230,13 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/gc/space/large_object_space_test.cc \
   runtime/gc/space/rosalloc_space_static_test.cc \
   runtime/gc/space/rosalloc_space_random_test.cc \
+  runtime/gc/space/rosalloc_space_per_cpu_test.cc \
   runtime/gc/space/space_create_test.cc \
+  runtime/gc/string_dedup_table_test.cc \
   runtime/gc/task_processor_test.cc \
   runtime/gtest_test.cc \
   runtime/handle_scope_test.cc \
+  runtime/hprof/hprof_test.cc \
   runtime/indenter_test.cc \
   runtime/indirect_reference_table_test.cc \
   runtime/instrumentation_test.cc \
@@ -237,6 +244,7 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/interpreter/safe_math_test.cc \
   runtime/interpreter/unstarted_runtime_test.cc \
   runtime/java_vm_ext_test.cc \
+  runtime/jit/jit_code_snapshot_test.cc \
   runtime/jit/profile_compilation_info_test.cc \
   runtime/lambda/closure_test.cc \
   runtime/lambda/shorty_field_type_test.cc \
@@ -247,6 +255,7 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/mirror/object_test.cc \
   runtime/monitor_pool_test.cc \
   runtime/monitor_test.cc \
+  runtime/multi_dex_type_lookup_table_test.cc \
   runtime/oat_file_test.cc \
   runtime/oat_file_assistant_test.cc \
   runtime/parsed_options_test.cc \
@@ -285,6 +294,7 @@ COMPILER_GTEST_COMMON_SRC_FILES := \
   compiler/optimizing/induction_var_analysis_test.cc \
   compiler/optimizing/induction_var_range_test.cc \
   compiler/optimizing/licm_test.cc \
+  compiler/optimizing/loop_optimization_test.cc \
   compiler/optimizing/live_interval_test.cc \
   compiler/optimizing/nodes_test.cc \
   compiler/optimizing/parallel_move_test.cc \
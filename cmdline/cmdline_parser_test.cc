@@ -222,7 +222,13 @@ TEST_F(CmdlineParserTest, TestSimpleSuccesses) {
   EXPECT_SINGLE_PARSE_VALUE(true, "-XX:EnableHSpaceCompactForOOM", M::EnableHSpaceCompactForOOM);
   EXPECT_SINGLE_PARSE_VALUE(false, "-XX:DisableHSpaceCompactForOOM", M::EnableHSpaceCompactForOOM);
   EXPECT_SINGLE_PARSE_VALUE(0.5, "-XX:HeapTargetUtilization=0.5", M::HeapTargetUtilization);
+  EXPECT_SINGLE_PARSE_VALUE(0.05, "-XX:GcCpuShareTarget=0.05", M::GcCpuShareTarget);
   EXPECT_SINGLE_PARSE_VALUE(5u, "-XX:ParallelGCThreads=5", M::ParallelGCThreads);
+  EXPECT_SINGLE_PARSE_VALUE(4u, "-XX:HprofDumpThreads=4", M::HprofDumpThreads);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:HprofCompression=gzip", M::HprofGzip);
+  EXPECT_SINGLE_PARSE_EXISTS("-XX:HprofStreaming", M::HprofStreaming);
+  EXPECT_SINGLE_PARSE_EXISTS("-XX:StringDeduplication", M::StringDeduplication);
+  EXPECT_SINGLE_PARSE_VALUE(8u, "-XX:RegionPrezeroPoolSize=8", M::RegionPrezeroPoolSize);
   EXPECT_SINGLE_PARSE_EXISTS("-Xno-dex-file-fallback", M::NoDexFileFallback);
 }  // TEST_F
 
@@ -231,11 +237,13 @@ TEST_F(CmdlineParserTest, TestSimpleFailures) {
   EXPECT_SINGLE_PARSE_FAIL("abcdefg^%@#*(@#", CmdlineResult::kUnknown);
   // Test value map substitution fails
   EXPECT_SINGLE_PARSE_FAIL("-Xverify:whatever", CmdlineResult::kFailure);
+  EXPECT_SINGLE_PARSE_FAIL("-XX:HprofCompression=zstd", CmdlineResult::kFailure);
   // Test value type parsing failures
   EXPECT_SINGLE_PARSE_FAIL("-Xsswhatever", CmdlineResult::kFailure);  // invalid memory value
   EXPECT_SINGLE_PARSE_FAIL("-Xms123", CmdlineResult::kFailure);       // memory value too small
   EXPECT_SINGLE_PARSE_FAIL("-XX:HeapTargetUtilization=0.0", CmdlineResult::kOutOfRange);  // toosmal
   EXPECT_SINGLE_PARSE_FAIL("-XX:HeapTargetUtilization=2.0", CmdlineResult::kOutOfRange);  // toolarg
+  EXPECT_SINGLE_PARSE_FAIL("-XX:GcCpuShareTarget=2.0", CmdlineResult::kOutOfRange);  // too large
   EXPECT_SINGLE_PARSE_FAIL("-XX:ParallelGCThreads=-5", CmdlineResult::kOutOfRange);  // too small
   EXPECT_SINGLE_PARSE_FAIL("-Xgc:blablabla", CmdlineResult::kUsage);  // not a valid suboption
 }  // TEST_F
@@ -452,6 +452,8 @@ static gc::CollectorType ParseCollectorType(const std::string& option) {
     return gc::kCollectorTypeGSS;
   } else if (option == "CC") {
     return gc::kCollectorTypeCC;
+  } else if (option == "GenCC") {
+    return gc::kCollectorTypeGenCC;
   } else if (option == "MC") {
     return gc::kCollectorTypeMC;
   } else {
@@ -485,7 +487,10 @@ struct CmdlineType<XGcOption> : CmdlineTypeParser<XGcOption> {
     Split(option, ',', &gc_options);
     for (const std::string& gc_option : gc_options) {
       gc::CollectorType collector_type = ParseCollectorType(gc_option);
-      if (collector_type != gc::kCollectorTypeNone) {
+      if (collector_type == gc::kCollectorTypeGenCC && !kUseBakerReadBarrier) {
+        // Young collections gray the old objects, which needs the Baker read barrier.
+        return Result::Usage("-Xgc:GenCC requires a Baker read barrier build");
+      } else if (collector_type != gc::kCollectorTypeNone) {
         xgc.collector_type_ = collector_type;
       } else if (gc_option == "preverify") {
         xgc.verify_pre_gc_heap_ = true;
@@ -560,7 +565,9 @@ struct CmdlineType<BackgroundGcOption>
       background_collector_type_ = gc::kCollectorTypeHomogeneousSpaceCompact;
     } else {
       gc::CollectorType collector_type = ParseCollectorType(substring);
-      if (collector_type != gc::kCollectorTypeNone) {
+      if (collector_type == gc::kCollectorTypeGenCC && !kUseBakerReadBarrier) {
+        return Result::Usage("-XX:BackgroundGC=GenCC requires a Baker read barrier build");
+      } else if (collector_type != gc::kCollectorTypeNone) {
         background_collector_type_ = collector_type;
       } else {
         return Result::Failure();
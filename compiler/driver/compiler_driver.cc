@@ -45,6 +45,7 @@
 #include "dex/quick/dex_file_method_inliner.h"
 #include "dex/quick/dex_file_to_method_inliner_map.h"
 #include "driver/compiler_options.h"
+#include "jit/jit.h"
 #include "jni_internal.h"
 #include "object_lock.h"
 #include "profiler.h"
@@ -480,6 +481,9 @@ void CompilerDriver::CompileAll(jobject class_loader,
   // 3) Attempt to verify all classes
   // 4) Attempt to initialize image classes, and trivially initialized classes
   PreCompile(class_loader, dex_files, timings);
+  // The class tables keep the storage they replaced while loading classes until it is reclaimed,
+  // which the runtime only does when trimming the heap.
+  Runtime::Current()->GetClassLinker()->ReclaimClassTableStorage(Thread::Current());
   // Compile:
   // 1) Compile all classes and methods enabled for compilation. May fall back to dex-to-dex
   //    compilation.
@@ -1322,10 +1326,20 @@ void CompilerDriver::UpdateImageClasses(TimingLogger* timings) {
   }
 }
 
+// Code saved in a JitCodeSnapshot is installed by other processes, where the dex caches and
+// the class initialization of the compiling process do not hold.
+static bool IsJitCompilingForCodeSnapshot() {
+  Runtime* runtime = Runtime::Current();
+  return runtime->UseJitCompilation() && runtime->GetJit()->UseCodeSnapshot();
+}
+
 bool CompilerDriver::CanAssumeClassIsLoaded(mirror::Class* klass) {
   Runtime* runtime = Runtime::Current();
   if (!runtime->IsAotCompiler()) {
     DCHECK(runtime->UseJitCompilation());
+    if (IsJitCompilingForCodeSnapshot()) {
+      return false;
+    }
     // Having the klass reference here implies that the klass is already loaded.
     return true;
   }
@@ -1354,10 +1368,12 @@ void CompilerDriver::MarkForDexToDexCompilation(Thread* self, const MethodRefere
 bool CompilerDriver::CanAssumeTypeIsPresentInDexCache(Handle<mirror::DexCache> dex_cache,
                                                       uint32_t type_idx) {
   bool result = false;
-  if ((IsBootImage() &&
-       IsImageClass(dex_cache->GetDexFile()->StringDataByIdx(
-           dex_cache->GetDexFile()->GetTypeId(type_idx).descriptor_idx_))) ||
-      Runtime::Current()->UseJitCompilation()) {
+  // Another type may take the slot of a class in a hashed resolved types cache at any time.
+  if (!kUseHashedDexCache &&
+      ((IsBootImage() &&
+        IsImageClass(dex_cache->GetDexFile()->StringDataByIdx(
+            dex_cache->GetDexFile()->GetTypeId(type_idx).descriptor_idx_))) ||
+       (Runtime::Current()->UseJitCompilation() && !IsJitCompilingForCodeSnapshot()))) {
     mirror::Class* resolved_class = dex_cache->GetResolvedType(type_idx);
     result = (resolved_class != nullptr);
   }
@@ -1375,7 +1391,8 @@ bool CompilerDriver::CanAssumeStringIsPresentInDexCache(const DexFile& dex_file,
   // See also Compiler::ResolveDexFile
 
   bool result = false;
-  if (IsBootImage() || Runtime::Current()->UseJitCompilation()) {
+  if (IsBootImage() ||
+      (Runtime::Current()->UseJitCompilation() && !IsJitCompilingForCodeSnapshot())) {
     ScopedObjectAccess soa(Thread::Current());
     StackHandleScope<1> hs(soa.Self());
     ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
@@ -107,16 +107,18 @@ TEST_F(CompilerDriverTest, DISABLED_LARGE_CompileDexLibCore) {
   ASSERT_TRUE(java_lang_dex_file_ != nullptr);
   const DexFile& dex = *java_lang_dex_file_;
   mirror::DexCache* dex_cache = class_linker_->FindDexCache(soa.Self(), dex);
-  EXPECT_EQ(dex.NumStringIds(), dex_cache->NumStrings());
+  EXPECT_EQ(mirror::DexCache::NumStringSlots(dex.NumStringIds()), dex_cache->NumStrings());
   for (size_t i = 0; i < dex_cache->NumStrings(); i++) {
-    const mirror::String* string = dex_cache->GetResolvedString(i);
-    EXPECT_TRUE(string != nullptr) << "string_idx=" << i;
+    uint32_t string_idx;
+    const mirror::String* string = dex_cache->GetStringSlot(i, &string_idx);
+    EXPECT_TRUE(string != nullptr) << "string_idx=" << string_idx;
   }
-  EXPECT_EQ(dex.NumTypeIds(), dex_cache->NumResolvedTypes());
+  EXPECT_EQ(mirror::DexCache::NumTypeSlots(dex.NumTypeIds()), dex_cache->NumResolvedTypes());
   for (size_t i = 0; i < dex_cache->NumResolvedTypes(); i++) {
-    mirror::Class* type = dex_cache->GetResolvedType(i);
-    EXPECT_TRUE(type != nullptr) << "type_idx=" << i
-                              << " " << dex.GetTypeDescriptor(dex.GetTypeId(i));
+    uint32_t type_idx;
+    mirror::Class* type = dex_cache->GetTypeSlot(i, &type_idx);
+    EXPECT_TRUE(type != nullptr) << "type_idx=" << type_idx
+                              << " " << dex.GetTypeDescriptor(dex.GetTypeId(type_idx));
   }
   EXPECT_EQ(dex.NumMethodIds(), dex_cache->NumResolvedMethods());
   auto* cl = Runtime::Current()->GetClassLinker();
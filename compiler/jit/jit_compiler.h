@@ -36,7 +36,7 @@ class JitCompiler {
   virtual ~JitCompiler();
 
   // Compilation entrypoint. Returns whether the compilation succeeded.
-  bool CompileMethod(Thread* self, ArtMethod* method, bool osr)
+  bool CompileMethod(Thread* self, ArtMethod* method, bool osr, bool baseline)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   CompilerOptions* GetCompilerOptions() const {
@@ -52,7 +52,6 @@ class JitCompiler {
   std::unique_ptr<DexFileToMethodInlinerMap> method_inliner_map_;
   std::unique_ptr<CompilerDriver> compiler_driver_;
   std::unique_ptr<const InstructionSetFeatures> instruction_set_features_;
-  std::unique_ptr<File> perf_file_;
 
   JitCompiler();
 
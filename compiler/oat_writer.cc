@@ -44,6 +44,7 @@
 #include "mirror/class_loader.h"
 #include "mirror/dex_cache-inl.h"
 #include "mirror/object-inl.h"
+#include "multi_dex_type_lookup_table.h"
 #include "oat_quick_method_header.h"
 #include "os.h"
 #include "safe_map.h"
@@ -279,6 +280,7 @@ OatWriter::OatWriter(bool compiling_boot_image, TimingLogger* timings)
     size_(0u),
     bss_size_(0u),
     oat_data_offset_(0u),
+    multi_dex_lookup_table_offset_(0u),
     oat_header_(nullptr),
     size_dex_file_alignment_(0),
     size_executable_offset_alignment_(0),
@@ -307,6 +309,7 @@ OatWriter::OatWriter(bool compiling_boot_image, TimingLogger* timings)
     size_oat_dex_file_lookup_table_offset_(0),
     size_oat_lookup_table_alignment_(0),
     size_oat_lookup_table_(0),
+    size_oat_multi_dex_lookup_table_(0),
     size_oat_class_offsets_alignment_(0),
     size_oat_class_offsets_(0),
     size_oat_class_type_(0),
@@ -440,6 +443,7 @@ bool OatWriter::WriteAndOpenDexFiles(
   for (OatDexFile& oat_dex_file : oat_dex_files_) {
     oat_dex_file.ReserveTypeLookupTable(this);
   }
+  ReserveMultiDexTypeLookupTable();
   size_t size_after_type_lookup_tables = size_;
   // Reserve space for class offsets and update class_offsets_offset_.
   for (OatDexFile& oat_dex_file : oat_dex_files_) {
@@ -1589,6 +1593,7 @@ bool OatWriter::WriteCode(OutputStream* out) {
     DO_STAT(size_oat_dex_file_lookup_table_offset_);
     DO_STAT(size_oat_lookup_table_alignment_);
     DO_STAT(size_oat_lookup_table_);
+    DO_STAT(size_oat_multi_dex_lookup_table_);
     DO_STAT(size_oat_class_offsets_alignment_);
     DO_STAT(size_oat_class_offsets_);
     DO_STAT(size_oat_class_type_);
@@ -2194,6 +2199,36 @@ bool OatWriter::OpenDexFiles(
   return true;
 }
 
+void OatWriter::ReserveMultiDexTypeLookupTable() {
+  DCHECK_EQ(multi_dex_lookup_table_offset_, 0u);
+  // A single dex file is already covered by its own type lookup table.
+  if (oat_dex_files_.size() <= 1u) {
+    return;
+  }
+  std::vector<uint32_t> num_class_defs;
+  uint32_t total_class_defs = 0u;
+  for (const OatDexFile& oat_dex_file : oat_dex_files_) {
+    if (oat_dex_file.create_type_lookup_table_ != CreateTypeLookupTable::kCreate) {
+      return;
+    }
+    num_class_defs.push_back(oat_dex_file.class_offsets_.size());
+    total_class_defs += oat_dex_file.class_offsets_.size();
+  }
+  if (!MultiDexTypeLookupTable::SupportedSize(num_class_defs)) {
+    return;
+  }
+  // The table is required to be 4 byte aligned.
+  size_t original_offset = size_;
+  size_t offset = RoundUp(original_offset, 4);
+  size_oat_lookup_table_alignment_ += offset - original_offset;
+  size_t table_size = MultiDexTypeLookupTable::RawDataLength(total_class_defs);
+  multi_dex_lookup_table_offset_ = offset;
+  size_ = offset + table_size;
+  size_oat_multi_dex_lookup_table_ += table_size;
+  oat_header_->SetMultiDexTypeLookupTableOffset(
+      dchecked_integral_cast<uint32_t>(multi_dex_lookup_table_offset_));
+}
+
 bool OatWriter::WriteTypeLookupTables(
     MemMap* opened_dex_files_map,
     const std::vector<std::unique_ptr<const DexFile>>& opened_dex_files) {
@@ -2212,6 +2247,16 @@ bool OatWriter::WriteTypeLookupTables(
     }
   }
 
+  if (multi_dex_lookup_table_offset_ != 0u) {
+    std::vector<const DexFile*> dex_files;
+    for (const std::unique_ptr<const DexFile>& dex_file : opened_dex_files) {
+      dex_files.push_back(dex_file.get());
+    }
+    size_t map_offset = oat_dex_files_[0].dex_file_offset_;
+    MultiDexTypeLookupTable::Create(
+        dex_files, opened_dex_files_map->Begin() + (multi_dex_lookup_table_offset_ - map_offset));
+  }
+
   DCHECK_EQ(opened_dex_files_map == nullptr, opened_dex_files.empty());
   if (opened_dex_files_map != nullptr && !opened_dex_files_map->Sync()) {
     PLOG(ERROR) << "Failed to Sync() type lookup tables. Map: " << opened_dex_files_map->GetName();
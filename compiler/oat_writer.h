@@ -68,6 +68,9 @@ class MultiOatRelativePatcher;
 // ...
 // TypeLookupTable[D]
 //
+// MultiDexTypeLookupTable  one descriptor to (dex file, class def index) hash table for all
+//                          OatDexFiles, only present if there are several.
+//
 // ClassOffsets[0]   one table of OatClass offsets for each class def for each OatDexFile.
 // ClassOffsets[1]
 // ...
@@ -268,6 +271,7 @@ class OatWriter {
                     bool verify,
                     /*out*/ std::unique_ptr<MemMap>* opened_dex_files_map,
                     /*out*/ std::vector<std::unique_ptr<const DexFile>>* opened_dex_files);
+  void ReserveMultiDexTypeLookupTable();
   bool WriteTypeLookupTables(MemMap* opened_dex_files_map,
                              const std::vector<std::unique_ptr<const DexFile>>& opened_dex_files);
   bool WriteCodeAlignment(OutputStream* out, uint32_t aligned_code_delta);
@@ -315,6 +319,9 @@ class OatWriter {
   // Offset of the oat data from the start of the mmapped region of the elf file.
   size_t oat_data_offset_;
 
+  // Offset of the MultiDexTypeLookupTable from the oat data, or 0 if there is none.
+  size_t multi_dex_lookup_table_offset_;
+
   // data to write
   std::unique_ptr<OatHeader> oat_header_;
   dchecked_vector<OatDexFile> oat_dex_files_;
@@ -353,6 +360,7 @@ class OatWriter {
   uint32_t size_oat_dex_file_lookup_table_offset_;
   uint32_t size_oat_lookup_table_alignment_;
   uint32_t size_oat_lookup_table_;
+  uint32_t size_oat_multi_dex_lookup_table_;
   uint32_t size_oat_class_offsets_alignment_;
   uint32_t size_oat_class_offsets_;
   uint32_t size_oat_class_type_;
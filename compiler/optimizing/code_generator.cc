@@ -46,11 +46,14 @@
 #include "driver/compiler_driver.h"
 #include "graph_visualizer.h"
 #include "intrinsics.h"
+#include "jit/jit.h"
 #include "leb128.h"
 #include "mirror/array-inl.h"
+#include "mirror/dex_cache.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/object_reference.h"
 #include "parallel_move_resolver.h"
+#include "runtime.h"
 #include "ssa_liveness_analysis.h"
 #include "utils/assembler.h"
 
@@ -134,6 +137,16 @@ size_t CodeGenerator::GetCacheOffset(uint32_t index) {
   return sizeof(GcRoot<mirror::Object>) * index;
 }
 
+size_t CodeGenerator::GetStringPairOffset(uint32_t string_index) {
+  DCHECK(kUseHashedDexCache);
+  return sizeof(mirror::StringDexCachePair) * mirror::DexCache::StringSlotIndex(string_index);
+}
+
+size_t CodeGenerator::GetTypePairOffset(uint32_t type_index) {
+  DCHECK(kUseHashedDexCache);
+  return sizeof(mirror::TypeDexCachePair) * mirror::DexCache::TypeSlotIndex(type_index);
+}
+
 size_t CodeGenerator::GetCachePointerOffset(uint32_t index) {
   auto pointer_size = InstructionSetPointerSize(GetInstructionSet());
   return pointer_size * index;
@@ -544,9 +557,19 @@ void CodeGenerator::AllocateLocations(HInstruction* instruction) {
     if (instruction->NeedsCurrentMethod()) {
       SetRequiresCurrentMethod();
     }
+  } else if (GetGraph()->IsCompilingBaseline()) {
+    // Baseline code updates the hotness of the method in the entry suspend check,
+    // which requires a frame holding the current method.
+    MarkNotLeaf();
   }
 }
 
+uint16_t CodeGenerator::GetBaselineHotnessThreshold() {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  DCHECK(jit != nullptr);
+  return dchecked_integral_cast<uint16_t>(jit->OptimizeMethodThreshold());
+}
+
 void CodeGenerator::MaybeRecordStat(MethodCompilationStat compilation_stat, size_t count) const {
   if (stats_ != nullptr) {
     stats_->RecordStat(compilation_stat, count);
@@ -1175,7 +1198,10 @@ void CodeGenerator::ValidateInvokeRuntime(HInstruction* instruction, SlowPathCod
              instruction->IsLoadClass() ||
              instruction->IsLoadString() ||
              instruction->IsInstanceOf() ||
-             instruction->IsCheckCast())))
+             instruction->IsCheckCast())) ||
+           // Baseline code updates inline caches in a slow path, which
+           // does not trigger GC.
+           instruction->IsUpdateInlineCache())
         << "instruction->DebugName()=" << instruction->DebugName()
         << " instruction->GetSideEffects().ToString()=" << instruction->GetSideEffects().ToString()
         << " slow_path->GetDescription()=" << slow_path->GetDescription();
@@ -315,6 +315,10 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
     requires_current_method_ = true;
   }
 
+  // Return the hotness at which baseline code requests the compilation of its
+  // method with all optimizations.
+  static uint16_t GetBaselineHotnessThreshold();
+
   void SetRequiresCurrentMethod() {
     requires_current_method_ = true;
   }
@@ -337,6 +341,10 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
   // Note: this method assumes we always have the same pointer size, regardless
   // of the architecture.
   static size_t GetCacheOffset(uint32_t index);
+  // Variants for the (string, index) and (class, index) pairs of the hashed strings and resolved
+  // types caches, see kUseHashedDexCache.
+  static size_t GetStringPairOffset(uint32_t string_index);
+  static size_t GetTypePairOffset(uint32_t type_index);
   // Pointer variant for ArtMethod and ArtField arrays.
   size_t GetCachePointerOffset(uint32_t index);
 
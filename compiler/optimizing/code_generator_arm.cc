@@ -5082,6 +5082,10 @@ void LocationsBuilderARM::VisitLoadClass(HLoadClass* cls) {
       Location::RegisterLocation(calling_convention.GetRegisterAt(0)),
       Location::RegisterLocation(R0),
       /* code_generator_supports_read_barrier */ true);
+  if (kUseHashedDexCache && !cls->NeedsAccessCheck() && !cls->IsReferrersClass()) {
+    // For GenerateDexCachePairLoad().
+    cls->GetLocations()->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitLoadClass(HLoadClass* cls) {
@@ -5106,6 +5110,40 @@ void InstructionCodeGeneratorARM::VisitLoadClass(HLoadClass* cls) {
     // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
     GenerateGcRootFieldLoad(
         cls, out_loc, current_method, ArtMethod::DeclaringClassOffset().Int32Value());
+  } else if (kUseHashedDexCache) {
+    // The slot of the type may hold another type: check its index.
+    DCHECK(!cls->IsInDexCache());
+    DCHECK(cls->CanCallRuntime());
+    SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathARM(
+        cls, cls, cls->GetDexPc(), cls->MustGenerateClinitCheck());
+    codegen_->AddSlowPath(slow_path);
+    if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+      // The slow path read barriers need the address of the root, which can't be read apart
+      // from its index. Resolve the type in the runtime.
+      __ b(slow_path->GetEntryLabel());
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
+    Register temp = locations->GetTemp(0).AsRegister<Register>();
+    // /* mirror::TypeDexCachePair[] */ temp =
+    //        current_method.ptr_sized_fields_->dex_cache_resolved_types_
+    __ LoadFromOffset(kLoadWord,
+                      temp,
+                      current_method,
+                      ArtMethod::DexCacheResolvedTypesOffset(kArmPointerSize).Int32Value());
+    // /* mirror::TypeDexCachePair */ out = temp[type_index % cache size]
+    GenerateDexCachePairLoad(cls,
+                             out_loc,
+                             temp,
+                             CodeGenerator::GetTypePairOffset(cls->GetTypeIndex()),
+                             cls->GetTypeIndex(),
+                             slow_path->GetEntryLabel());
+    __ CompareAndBranchIfZero(out, slow_path->GetEntryLabel());
+    if (cls->MustGenerateClinitCheck()) {
+      GenerateClassInitializationCheck(slow_path, out);
+    } else {
+      __ Bind(slow_path->GetExitLabel());
+    }
   } else {
     // /* GcRoot<mirror::Class>[] */ out =
     //        current_method.ptr_sized_fields_->dex_cache_resolved_types_
@@ -5214,6 +5252,10 @@ void LocationsBuilderARM::VisitLoadString(HLoadString* load) {
     locations->SetInAt(0, Location::RequiresRegister());
   }
   locations->SetOut(Location::RequiresRegister());
+  if (kUseHashedDexCache && load_kind == HLoadString::LoadKind::kDexCacheViaMethod) {
+    // For GenerateDexCachePairLoad().
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitLoadString(HLoadString* load) {
@@ -5271,11 +5313,41 @@ void InstructionCodeGeneratorARM::VisitLoadString(HLoadString* load) {
       break;
     }
     case HLoadString::LoadKind::kDexCacheViaMethod: {
+      if (kUseHashedDexCache && kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+        // The slow path read barriers need the address of the root, which can't be read apart
+        // from its index. Resolve the string in the runtime.
+        DCHECK(!load->IsInDexCache());
+        SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathARM(load);
+        codegen_->AddSlowPath(slow_path);
+        __ b(slow_path->GetEntryLabel());
+        __ Bind(slow_path->GetExitLabel());
+        return;
+      }
       Register current_method = locations->InAt(0).AsRegister<Register>();
 
       // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
       GenerateGcRootFieldLoad(
           load, out_loc, current_method, ArtMethod::DeclaringClassOffset().Int32Value());
+      if (kUseHashedDexCache) {
+        // The slot of the string may hold another string: check its index.
+        DCHECK(!load->IsInDexCache());
+        Register temp = locations->GetTemp(0).AsRegister<Register>();
+        SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathARM(load);
+        codegen_->AddSlowPath(slow_path);
+        // /* mirror::StringDexCachePair[] */ temp = out->dex_cache_strings_
+        __ LoadFromOffset(
+            kLoadWord, temp, out, mirror::Class::DexCacheStringsOffset().Int32Value());
+        // /* mirror::StringDexCachePair */ out = temp[string_index % cache size]
+        GenerateDexCachePairLoad(load,
+                                 out_loc,
+                                 temp,
+                                 CodeGenerator::GetStringPairOffset(load->GetStringIndex()),
+                                 load->GetStringIndex(),
+                                 slow_path->GetEntryLabel());
+        __ CompareAndBranchIfZero(out, slow_path->GetEntryLabel());
+        __ Bind(slow_path->GetExitLabel());
+        return;
+      }
       // /* GcRoot<mirror::String>[] */ out = out->dex_cache_strings_
       __ LoadFromOffset(kLoadWord, out, out, mirror::Class::DexCacheStringsOffset().Int32Value());
       // /* GcRoot<mirror::String> */ out = out[string_index]
@@ -6020,6 +6092,38 @@ void InstructionCodeGeneratorARM::GenerateReferenceLoadTwoRegisters(HInstruction
   }
 }
 
+void InstructionCodeGeneratorARM::GenerateDexCachePairLoad(HInstruction* instruction,
+                                                           Location root,
+                                                           Register obj,
+                                                           uint32_t offset,
+                                                           uint32_t index,
+                                                           Label* miss) {
+  DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+  Register root_reg = root.AsRegister<Register>();
+  DCHECK_NE(root_reg, obj);
+  // The pair is stored with a single 8-byte write. Load it as a whole, with the root in the low
+  // word and the index in the high word, so that the root and the index match. LDREXD is
+  // single-copy atomic without the LPAE required for LDRD.
+  __ LoadImmediate(root_reg, offset);
+  __ add(IP, obj, ShifterOperand(root_reg));
+  __ ldrexd(root_reg, obj, IP);
+  __ CmpConstant(obj, dchecked_integral_cast<int32_t>(index));
+  __ b(miss, NE);
+  if (kEmitCompilerReadBarrier) {
+    // Fast path implementation of art::ReadBarrier::BarrierForRoot when
+    // Baker's read barrier are used, as in GenerateGcRootFieldLoad().
+    SlowPathCode* slow_path =
+        new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathARM(instruction, root, root);
+    codegen_->AddSlowPath(slow_path);
+
+    // IP = Thread::Current()->GetIsGcMarking()
+    __ LoadFromOffset(
+        kLoadWord, IP, TR, Thread::IsGcMarkingOffset<kArmWordSize>().Int32Value());
+    __ CompareAndBranchIfNonZero(IP, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 void InstructionCodeGeneratorARM::GenerateGcRootFieldLoad(HInstruction* instruction,
                                                           Location root,
                                                           Register obj,
@@ -273,6 +273,17 @@ class InstructionCodeGeneratorARM : public InstructionCodeGenerator {
                                Location root,
                                Register obj,
                                uint32_t offset);
+  // Generate a GC root reference load from a (root, index) pair of a hashed dex cache array:
+  //
+  //   root <- ((obj + offset)->index == index) ? (obj + offset)->root : goto miss
+  //
+  // with a single load of the pair, while honoring Baker's read barriers. `obj` is clobbered.
+  void GenerateDexCachePairLoad(HInstruction* instruction,
+                                Location root,
+                                Register obj,
+                                uint32_t offset,
+                                uint32_t index,
+                                Label* miss);
   void GenerateTestAndBranch(HInstruction* instruction,
                              size_t condition_input_index,
                              Label* true_target,
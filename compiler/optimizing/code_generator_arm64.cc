@@ -25,6 +25,7 @@
 #include "gc/accounting/card_table.h"
 #include "intrinsics.h"
 #include "intrinsics_arm64.h"
+#include "jit/profiling_info.h"
 #include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
 #include "offsets.h"
@@ -62,6 +63,7 @@ using helpers::OperandFromMemOperand;
 using helpers::OutputCPURegister;
 using helpers::OutputFPRegister;
 using helpers::OutputRegister;
+using helpers::QRegisterFrom;
 using helpers::RegisterFrom;
 using helpers::StackOperandFrom;
 using helpers::VIXLRegCodeFromART;
@@ -428,6 +430,60 @@ class SuspendCheckSlowPathARM64 : public SlowPathCodeARM64 {
   DISALLOW_COPY_AND_ASSIGN(SuspendCheckSlowPathARM64);
 };
 
+class CompileOptimizedSlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  explicit CompileOptimizedSlowPathARM64(HSuspendCheck* instruction)
+      : SlowPathCodeARM64(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    CodeGeneratorARM64* arm64_codegen = down_cast<CodeGeneratorARM64*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, instruction_->GetLocations());
+    InvokeRuntimeCallingConvention calling_convention;
+    __ Ldr(calling_convention.GetRegisterAt(0), MemOperand(sp, kCurrentMethodStackOffset));
+    arm64_codegen->InvokeRuntime(
+        QUICK_ENTRY_POINT(pCompileOptimized), instruction_, instruction_->GetDexPc(), this);
+    CheckEntrypointTypes<kQuickCompileOptimized, void, ArtMethod*>();
+    RestoreLiveRegisters(codegen, instruction_->GetLocations());
+    __ B(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "CompileOptimizedSlowPathARM64"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathARM64);
+};
+
+class UpdateInlineCacheSlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  explicit UpdateInlineCacheSlowPathARM64(HUpdateInlineCache* instruction)
+      : SlowPathCodeARM64(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    CodeGeneratorARM64* arm64_codegen = down_cast<CodeGeneratorARM64*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+    // Move the receiver first, as it may be in one of the other argument registers.
+    InvokeRuntimeCallingConvention calling_convention;
+    arm64_codegen->MoveLocation(LocationFrom(calling_convention.GetRegisterAt(0)),
+                                locations->InAt(0),
+                                Primitive::kPrimNot);
+    __ Ldr(calling_convention.GetRegisterAt(1), MemOperand(sp, kCurrentMethodStackOffset));
+    __ Mov(calling_convention.GetRegisterAt(2).W(), instruction_->GetDexPc());
+    arm64_codegen->InvokeRuntime(
+        QUICK_ENTRY_POINT(pUpdateInlineCache), instruction_, instruction_->GetDexPc(), this);
+    CheckEntrypointTypes<kQuickUpdateInlineCache, void, mirror::Object*, ArtMethod*, uint32_t>();
+    RestoreLiveRegisters(codegen, locations);
+    __ B(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "UpdateInlineCacheSlowPathARM64"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(UpdateInlineCacheSlowPathARM64);
+};
+
 class TypeCheckSlowPathARM64 : public SlowPathCodeARM64 {
  public:
   TypeCheckSlowPathARM64(HInstruction* instruction, bool is_fatal)
@@ -1236,6 +1292,10 @@ void CodeGeneratorARM64::MoveLocation(Location destination,
             ? Primitive::kPrimDouble
             : Primitive::kPrimFloat;
         __ Fmov(RegisterFrom(destination, dst_type), FPRegisterFrom(source, source_type));
+      } else if (GetGraph()->HasSIMD()) {
+        // Vector values occupy the full 128-bit register.
+        DCHECK(destination.IsFpuRegister());
+        __ Mov(QRegisterFrom(destination).V16B(), QRegisterFrom(source).V16B());
       } else {
         DCHECK(destination.IsFpuRegister());
         __ Fmov(FPRegister(dst), FPRegisterFrom(source, dst_type));
@@ -1526,6 +1586,10 @@ void InstructionCodeGeneratorARM64::GenerateSuspendCheck(HSuspendCheck* instruct
     DCHECK_EQ(slow_path->GetSuccessor(), successor);
   }
 
+  if (GetGraph()->IsCompilingBaseline()) {
+    GenerateIncreaseHotness(instruction);
+  }
+
   UseScratchRegisterScope temps(codegen_->GetVIXLAssembler());
   Register temp = temps.AcquireW();
 
@@ -1540,6 +1604,59 @@ void InstructionCodeGeneratorARM64::GenerateSuspendCheck(HSuspendCheck* instruct
   }
 }
 
+void InstructionCodeGeneratorARM64::GenerateIncreaseHotness(HSuspendCheck* instruction) {
+  // Baseline code counts method entries and loop back edges in the hotness of the
+  // method, and requests its compilation with all optimizations at the threshold.
+  SlowPathCodeARM64* slow_path =
+      new (GetGraph()->GetArena()) CompileOptimizedSlowPathARM64(instruction);
+  codegen_->AddSlowPath(slow_path);
+  UseScratchRegisterScope temps(codegen_->GetVIXLAssembler());
+  Register method = temps.AcquireX();
+  Register counter = temps.AcquireW();
+  MemOperand hotness(method, ArtMethod::HotnessCountOffset().Int32Value());
+  __ Ldr(method, MemOperand(sp, kCurrentMethodStackOffset));
+  __ Ldrh(counter, hotness);
+  __ Add(counter, counter, 1);
+  __ Strh(counter, hotness);
+  // The count may go past the threshold without reaching it exactly, e.g. when threads
+  // race on the increment, so request the compilation at any count above it.
+  __ Cmp(counter, CodeGenerator::GetBaselineHotnessThreshold());
+  __ B(hs, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void LocationsBuilderARM64::VisitUpdateInlineCache(HUpdateInlineCache* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorARM64::VisitUpdateInlineCache(HUpdateInlineCache* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register receiver = InputRegisterAt(instruction, 0);
+  Register temp = WRegisterFrom(locations->GetTemp(0));
+  SlowPathCodeARM64* slow_path =
+      new (GetGraph()->GetArena()) UpdateInlineCacheSlowPathARM64(instruction);
+  codegen_->AddSlowPath(slow_path);
+
+  // Only call the runtime when the receiver class is not the first class of the
+  // cache. The runtime looks up the cache again, as it may have been freed along
+  // with the ProfilingInfo of the method.
+  // /* HeapReference<Class> */ temp = receiver->klass_
+  __ Ldr(temp, HeapOperand(receiver, mirror::Object::ClassOffset()));
+  // No read barrier is needed, as the class is only compared to the cache.
+  GetAssembler()->MaybeUnpoisonHeapReference(temp);
+  UseScratchRegisterScope temps(codegen_->GetVIXLAssembler());
+  Register cache = temps.AcquireX();
+  Register first_class = temps.AcquireW();
+  __ Mov(cache, reinterpret_cast<uint64_t>(instruction->GetInlineCache()));
+  __ Ldr(first_class, MemOperand(cache, InlineCache::ClassesOffset().Int32Value()));
+  __ Cmp(temp, first_class);
+  __ B(ne, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 InstructionCodeGeneratorARM64::InstructionCodeGeneratorARM64(HGraph* graph,
                                                              CodeGeneratorARM64* codegen)
       : InstructionCodeGenerator(graph, codegen),
@@ -3941,6 +4058,37 @@ void InstructionCodeGeneratorARM64::VisitLoadClass(HLoadClass* cls) {
     // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
     GenerateGcRootFieldLoad(
         cls, out_loc, current_method, ArtMethod::DeclaringClassOffset().Int32Value());
+  } else if (kUseHashedDexCache) {
+    // The slot of the type may hold another type: check its index.
+    DCHECK(!cls->IsInDexCache());
+    DCHECK(cls->CanCallRuntime());
+    SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathARM64(
+        cls, cls, cls->GetDexPc(), cls->MustGenerateClinitCheck());
+    codegen_->AddSlowPath(slow_path);
+    if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+      // The slow path read barriers need the address of the root, which can't be read apart
+      // from its index. Resolve the type in the runtime.
+      __ B(slow_path->GetEntryLabel());
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
+    MemberOffset resolved_types_offset = ArtMethod::DexCacheResolvedTypesOffset(kArm64PointerSize);
+    // /* mirror::TypeDexCachePair[] */ out =
+    //        current_method.ptr_sized_fields_->dex_cache_resolved_types_
+    __ Ldr(out.X(), MemOperand(current_method, resolved_types_offset.Int32Value()));
+    // /* mirror::TypeDexCachePair */ out = out[type_index % cache size]
+    GenerateDexCachePairLoad(cls,
+                             out_loc,
+                             out.X(),
+                             CodeGenerator::GetTypePairOffset(cls->GetTypeIndex()),
+                             cls->GetTypeIndex(),
+                             slow_path->GetEntryLabel());
+    __ Cbz(out, slow_path->GetEntryLabel());
+    if (cls->MustGenerateClinitCheck()) {
+      GenerateClassInitializationCheck(slow_path, out);
+    } else {
+      __ Bind(slow_path->GetExitLabel());
+    }
   } else {
     MemberOffset resolved_types_offset = ArtMethod::DexCacheResolvedTypesOffset(kArm64PointerSize);
     // /* GcRoot<mirror::Class>[] */ out =
@@ -4103,12 +4251,38 @@ void InstructionCodeGeneratorARM64::VisitLoadString(HLoadString* load) {
       break;
     }
     case HLoadString::LoadKind::kDexCacheViaMethod: {
+      if (kUseHashedDexCache && kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+        // The slow path read barriers need the address of the root, which can't be read apart
+        // from its index. Resolve the string in the runtime.
+        DCHECK(!load->IsInDexCache());
+        SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathARM64(load);
+        codegen_->AddSlowPath(slow_path);
+        __ B(slow_path->GetEntryLabel());
+        __ Bind(slow_path->GetExitLabel());
+        return;
+      }
       Register current_method = InputRegisterAt(load, 0);
       // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
       GenerateGcRootFieldLoad(
           load, out_loc, current_method, ArtMethod::DeclaringClassOffset().Int32Value());
       // /* GcRoot<mirror::String>[] */ out = out->dex_cache_strings_
       __ Ldr(out.X(), HeapOperand(out, mirror::Class::DexCacheStringsOffset().Uint32Value()));
+      if (kUseHashedDexCache) {
+        // The slot of the string may hold another string: check its index.
+        DCHECK(!load->IsInDexCache());
+        SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathARM64(load);
+        codegen_->AddSlowPath(slow_path);
+        // /* mirror::StringDexCachePair */ out = out[string_index % cache size]
+        GenerateDexCachePairLoad(load,
+                                 out_loc,
+                                 out.X(),
+                                 CodeGenerator::GetStringPairOffset(load->GetStringIndex()),
+                                 load->GetStringIndex(),
+                                 slow_path->GetEntryLabel());
+        __ Cbz(out, slow_path->GetEntryLabel());
+        __ Bind(slow_path->GetExitLabel());
+        return;
+      }
       // /* GcRoot<mirror::String> */ out = out[string_index]
       GenerateGcRootFieldLoad(
           load, out_loc, out.X(), CodeGenerator::GetCacheOffset(load->GetStringIndex()));
@@ -4892,6 +5066,43 @@ void InstructionCodeGeneratorARM64::GenerateReferenceLoadTwoRegisters(HInstructi
   }
 }
 
+void InstructionCodeGeneratorARM64::GenerateDexCachePairLoad(HInstruction* instruction,
+                                                             Location root,
+                                                             vixl::Register obj,
+                                                             uint32_t offset,
+                                                             uint32_t index,
+                                                             vixl::Label* miss) {
+  DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+  Register root_reg = RegisterFrom(root, Primitive::kPrimNot);
+  MacroAssembler* masm = GetVIXLAssembler();
+  {
+    UseScratchRegisterScope temps(masm);
+    Register temp = temps.AcquireX();
+    // The pair is stored with a single 8-byte write. Load it as a whole, with the root in the low
+    // half and the index in the high half, so that the root and the index match.
+    __ Ldr(root_reg.X(), MemOperand(obj.X(), offset));
+    __ Lsr(temp, root_reg.X(), 32);
+    __ Cmp(temp.W(), index);
+    __ B(ne, miss);
+    // Clear the index from the high half, references are used as 64-bit base addresses.
+    __ Mov(root_reg.W(), root_reg.W());
+  }
+  if (kEmitCompilerReadBarrier) {
+    // Fast path implementation of art::ReadBarrier::BarrierForRoot when
+    // Baker's read barrier are used, as in GenerateGcRootFieldLoad().
+    SlowPathCodeARM64* slow_path =
+        new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathARM64(instruction, root, root);
+    codegen_->AddSlowPath(slow_path);
+
+    UseScratchRegisterScope temps(masm);
+    Register temp = temps.AcquireW();
+    // temp = Thread::Current()->GetIsGcMarking()
+    __ Ldr(temp, MemOperand(tr, Thread::IsGcMarkingOffset<kArm64WordSize>().Int32Value()));
+    __ Cbnz(temp, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 void InstructionCodeGeneratorARM64::GenerateGcRootFieldLoad(HInstruction* instruction,
                                                             Location root,
                                                             vixl::Register obj,
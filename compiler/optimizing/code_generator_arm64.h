@@ -198,6 +198,8 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
   FOR_EACH_CONCRETE_INSTRUCTION_COMMON(DECLARE_VISIT_INSTRUCTION)
   FOR_EACH_CONCRETE_INSTRUCTION_ARM64(DECLARE_VISIT_INSTRUCTION)
   FOR_EACH_CONCRETE_INSTRUCTION_SHARED(DECLARE_VISIT_INSTRUCTION)
+  FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(DECLARE_VISIT_INSTRUCTION)
+  FOR_EACH_CONCRETE_INSTRUCTION_JIT_BASELINE(DECLARE_VISIT_INSTRUCTION)
 
 #undef DECLARE_VISIT_INSTRUCTION
 
@@ -212,6 +214,8 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
  private:
   void GenerateClassInitializationCheck(SlowPathCodeARM64* slow_path, vixl::Register class_reg);
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
+  // Generate the update of the hotness of the method in the baseline code of `instruction`.
+  void GenerateIncreaseHotness(HSuspendCheck* instruction);
   void HandleBinaryOp(HBinaryOperation* instr);
 
   void HandleFieldSet(HInstruction* instruction,
@@ -258,6 +262,17 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
                                vixl::Register obj,
                                uint32_t offset,
                                vixl::Label* fixup_label = nullptr);
+  // Generate a GC root reference load from a (root, index) pair of a hashed dex cache array:
+  //
+  //   root <- ((obj + offset)->index == index) ? (obj + offset)->root : goto miss
+  //
+  // with a single load of the pair, while honoring Baker's read barriers.
+  void GenerateDexCachePairLoad(HInstruction* instruction,
+                                Location root,
+                                vixl::Register obj,
+                                uint32_t offset,
+                                uint32_t index,
+                                vixl::Label* miss);
 
   // Generate a floating-point comparison.
   void GenerateFcmp(HInstruction* instruction);
@@ -290,6 +305,8 @@ class LocationsBuilderARM64 : public HGraphVisitor {
   FOR_EACH_CONCRETE_INSTRUCTION_COMMON(DECLARE_VISIT_INSTRUCTION)
   FOR_EACH_CONCRETE_INSTRUCTION_ARM64(DECLARE_VISIT_INSTRUCTION)
   FOR_EACH_CONCRETE_INSTRUCTION_SHARED(DECLARE_VISIT_INSTRUCTION)
+  FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(DECLARE_VISIT_INSTRUCTION)
+  FOR_EACH_CONCRETE_INSTRUCTION_JIT_BASELINE(DECLARE_VISIT_INSTRUCTION)
 
 #undef DECLARE_VISIT_INSTRUCTION
 
@@ -3993,6 +3993,19 @@ void InstructionCodeGeneratorMIPS::VisitLoadClass(HLoadClass* cls) {
     DCHECK(!cls->MustGenerateClinitCheck());
     __ LoadFromOffset(kLoadWord, out, current_method,
                       ArtMethod::DeclaringClassOffset().Int32Value());
+  } else if (kUseHashedDexCache) {
+    // The slot of the type in the hashed resolved types cache may hold another type. As for
+    // strings, resolve the type (and initialize its class if needed) in the runtime.
+    DCHECK(!cls->IsInDexCache());
+    DCHECK(cls->CanCallRuntime());
+    SlowPathCodeMIPS* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathMIPS(
+        cls,
+        cls,
+        cls->GetDexPc(),
+        cls->MustGenerateClinitCheck());
+    codegen_->AddSlowPath(slow_path);
+    __ B(slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
   } else {
     __ LoadFromOffset(kLoadWord, out, current_method,
                       ArtMethod::DexCacheResolvedTypesOffset(kMipsPointerSize).Int32Value());
@@ -4053,6 +4066,17 @@ void LocationsBuilderMIPS::VisitLoadString(HLoadString* load) {
 void InstructionCodeGeneratorMIPS::VisitLoadString(HLoadString* load) {
   LocationSummary* locations = load->GetLocations();
   Register out = locations->Out().AsRegister<Register>();
+  if (kUseHashedDexCache) {
+    // The slot of the string in the hashed strings cache may hold another string. MIPS32 has no
+    // single-copy atomic 8-byte load to read the string together with its index, resolve the
+    // string in the runtime.
+    DCHECK(!load->IsInDexCache());
+    SlowPathCodeMIPS* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathMIPS(load);
+    codegen_->AddSlowPath(slow_path);
+    __ B(slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   Register current_method = locations->InAt(0).AsRegister<Register>();
   __ LoadFromOffset(kLoadWord, out, current_method, ArtMethod::DeclaringClassOffset().Int32Value());
   __ LoadFromOffset(kLoadWord, out, out, mirror::Class::DexCacheStringsOffset().Int32Value());
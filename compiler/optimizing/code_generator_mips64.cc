@@ -3211,6 +3211,32 @@ void InstructionCodeGeneratorMIPS64::VisitLoadClass(HLoadClass* cls) {
     DCHECK(!cls->MustGenerateClinitCheck());
     __ LoadFromOffset(kLoadUnsignedWord, out, current_method,
                       ArtMethod::DeclaringClassOffset().Int32Value());
+  } else if (kUseHashedDexCache) {
+    // The slot of the type may hold another type: check its index. The pair is stored with a
+    // single 8-byte write. Load it as a whole, with the class in the low word and the index in
+    // the high word, so that the class and the index match.
+    DCHECK(!cls->IsInDexCache());
+    DCHECK(cls->CanCallRuntime());
+    SlowPathCodeMIPS64* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathMIPS64(
+        cls,
+        cls,
+        cls->GetDexPc(),
+        cls->MustGenerateClinitCheck());
+    codegen_->AddSlowPath(slow_path);
+    __ LoadFromOffset(kLoadDoubleword, out, current_method,
+                      ArtMethod::DexCacheResolvedTypesOffset(kMips64PointerSize).Int32Value());
+    __ LoadFromOffset(
+        kLoadDoubleword, out, out, CodeGenerator::GetTypePairOffset(cls->GetTypeIndex()));
+    __ Dsrl32(TMP, out, 0);
+    __ LoadConst32(AT, dchecked_integral_cast<int32_t>(cls->GetTypeIndex()));
+    __ Bnec(TMP, AT, slow_path->GetEntryLabel());
+    __ Dext(out, out, 0, 32);
+    __ Beqzc(out, slow_path->GetEntryLabel());
+    if (cls->MustGenerateClinitCheck()) {
+      GenerateClassInitializationCheck(slow_path, out);
+    } else {
+      __ Bind(slow_path->GetExitLabel());
+    }
   } else {
     __ LoadFromOffset(kLoadDoubleword, out, current_method,
                       ArtMethod::DexCacheResolvedTypesOffset(kMips64PointerSize).Int32Value());
@@ -3276,6 +3302,23 @@ void InstructionCodeGeneratorMIPS64::VisitLoadString(HLoadString* load) {
   __ LoadFromOffset(kLoadUnsignedWord, out, current_method,
                     ArtMethod::DeclaringClassOffset().Int32Value());
   __ LoadFromOffset(kLoadDoubleword, out, out, mirror::Class::DexCacheStringsOffset().Int32Value());
+  if (kUseHashedDexCache) {
+    // The slot of the string may hold another string: check its index. The pair is stored with
+    // a single 8-byte write. Load it as a whole, with the string in the low word and the index in
+    // the high word, so that the string and the index match.
+    DCHECK(!load->IsInDexCache());
+    SlowPathCodeMIPS64* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathMIPS64(load);
+    codegen_->AddSlowPath(slow_path);
+    __ LoadFromOffset(
+        kLoadDoubleword, out, out, CodeGenerator::GetStringPairOffset(load->GetStringIndex()));
+    __ Dsrl32(TMP, out, 0);
+    __ LoadConst32(AT, dchecked_integral_cast<int32_t>(load->GetStringIndex()));
+    __ Bnec(TMP, AT, slow_path->GetEntryLabel());
+    __ Dext(out, out, 0, 32);
+    __ Beqzc(out, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   __ LoadFromOffset(
       kLoadUnsignedWord, out, out, CodeGenerator::GetCacheOffset(load->GetStringIndex()));
   // TODO: We will need a read barrier here.
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "code_generator_arm64.h"
+
+#include "common_arm64.h"
+#include "mirror/array-inl.h"
+#include "utils/arm64/assembler_arm64.h"
+
+using namespace vixl;   // NOLINT(build/namespaces)
+
+namespace art {
+namespace arm64 {
+
+using helpers::HeapOperand;
+using helpers::InputRegisterAt;
+using helpers::Int64ConstantFrom;
+using helpers::OutputRegister;
+using helpers::QRegisterFrom;
+using helpers::RegisterFrom;
+using helpers::WRegisterFrom;
+
+#define __ GetVIXLAssembler()->
+
+//
+// Helpers.
+//
+
+// Returns the vector register at the given location, arranged in lanes of the packed type.
+static FPRegister VRegisterFrom(Location location, Primitive::Type packed_type) {
+  FPRegister reg = QRegisterFrom(location);
+  switch (packed_type) {
+    case Primitive::kPrimByte:
+      return reg.V16B();
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+      return reg.V8H();
+    case Primitive::kPrimInt:
+      return reg.V4S();
+    case Primitive::kPrimLong:
+      return reg.V2D();
+    default:
+      LOG(FATAL) << "Unsupported SIMD type " << packed_type;
+      UNREACHABLE();
+  }
+}
+
+static void CreateVecUnOpLocations(ArenaAllocator* arena, HVecUnaryOperation* instruction) {
+  LocationSummary* locations = new (arena) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kNoOutputOverlap);
+}
+
+static void CreateVecBinOpLocations(ArenaAllocator* arena, HVecBinaryOperation* instruction) {
+  LocationSummary* locations = new (arena) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kNoOutputOverlap);
+}
+
+static void CreateVecMemLocations(ArenaAllocator* arena,
+                                  HVecMemoryOperation* instruction,
+                                  bool is_load) {
+  LocationSummary* locations = new (arena) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RegisterOrConstant(instruction->GetIndex()));
+  if (is_load) {
+    locations->SetOut(Location::RequiresFpuRegister());
+  } else {
+    locations->SetInAt(2, Location::RequiresFpuRegister());
+  }
+}
+
+// Returns the memory operand a[i] of a vector memory operation, where the elements
+// of the array are of the given type. A non-constant index is added to the base in a
+// scratch register, since vector loads and stores do not support a scaled index.
+static MemOperand VecAddress(vixl::MacroAssembler* masm,
+                             HVecMemoryOperation* instruction,
+                             UseScratchRegisterScope* temps_scope,
+                             Primitive::Type type) {
+  Register base = InputRegisterAt(instruction, 0);
+  Location index = instruction->GetLocations()->InAt(1);
+  uint32_t offset = mirror::Array::DataOffset(Primitive::ComponentSize(type)).Uint32Value();
+  size_t shift = Primitive::ComponentSizeShift(type);
+  if (index.IsConstant()) {
+    offset += Int64ConstantFrom(index) << shift;
+    return HeapOperand(base, offset);
+  }
+  Register temp = temps_scope->AcquireSameSizeAs(base);
+  masm->Add(temp, base, Operand(WRegisterFrom(index), LSL, shift));
+  return HeapOperand(temp, offset);
+}
+
+//
+// Unary operations.
+//
+
+void LocationsBuilderARM64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetOut(Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorARM64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type type = instruction->GetPackedType();
+  FPRegister dst = VRegisterFrom(locations->Out(), type);
+  __ Dup(dst, RegisterFrom(locations->InAt(0), instruction->GetInput()->GetType()));
+}
+
+void LocationsBuilderARM64::VisitVecNeg(HVecNeg* instruction) {
+  CreateVecUnOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecNeg(HVecNeg* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type type = instruction->GetPackedType();
+  __ Neg(VRegisterFrom(locations->Out(), type), VRegisterFrom(locations->InAt(0), type));
+}
+
+void LocationsBuilderARM64::VisitVecNot(HVecNot* instruction) {
+  CreateVecUnOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecNot(HVecNot* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  // Bitwise not is independent of the packed type.
+  __ Not(QRegisterFrom(locations->Out()).V16B(), QRegisterFrom(locations->InAt(0)).V16B());
+}
+
+//
+// Binary operations.
+//
+
+void LocationsBuilderARM64::VisitVecAdd(HVecAdd* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecAdd(HVecAdd* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type type = instruction->GetPackedType();
+  __ Add(VRegisterFrom(locations->Out(), type),
+         VRegisterFrom(locations->InAt(0), type),
+         VRegisterFrom(locations->InAt(1), type));
+}
+
+void LocationsBuilderARM64::VisitVecSub(HVecSub* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecSub(HVecSub* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type type = instruction->GetPackedType();
+  __ Sub(VRegisterFrom(locations->Out(), type),
+         VRegisterFrom(locations->InAt(0), type),
+         VRegisterFrom(locations->InAt(1), type));
+}
+
+void LocationsBuilderARM64::VisitVecMul(HVecMul* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecMul(HVecMul* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type type = instruction->GetPackedType();
+  DCHECK_NE(type, Primitive::kPrimLong);
+  __ Mul(VRegisterFrom(locations->Out(), type),
+         VRegisterFrom(locations->InAt(0), type),
+         VRegisterFrom(locations->InAt(1), type));
+}
+
+void LocationsBuilderARM64::VisitVecMin(HVecMin* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecMin(HVecMin* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type type = instruction->GetPackedType();
+  DCHECK_EQ(type, Primitive::kPrimInt);
+  __ Smin(VRegisterFrom(locations->Out(), type),
+          VRegisterFrom(locations->InAt(0), type),
+          VRegisterFrom(locations->InAt(1), type));
+}
+
+void LocationsBuilderARM64::VisitVecMax(HVecMax* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecMax(HVecMax* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type type = instruction->GetPackedType();
+  DCHECK_EQ(type, Primitive::kPrimInt);
+  __ Smax(VRegisterFrom(locations->Out(), type),
+          VRegisterFrom(locations->InAt(0), type),
+          VRegisterFrom(locations->InAt(1), type));
+}
+
+void LocationsBuilderARM64::VisitVecAnd(HVecAnd* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecAnd(HVecAnd* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  __ And(QRegisterFrom(locations->Out()).V16B(),
+         QRegisterFrom(locations->InAt(0)).V16B(),
+         QRegisterFrom(locations->InAt(1)).V16B());
+}
+
+void LocationsBuilderARM64::VisitVecOr(HVecOr* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecOr(HVecOr* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  __ Orr(QRegisterFrom(locations->Out()).V16B(),
+         QRegisterFrom(locations->InAt(0)).V16B(),
+         QRegisterFrom(locations->InAt(1)).V16B());
+}
+
+void LocationsBuilderARM64::VisitVecXor(HVecXor* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecXor(HVecXor* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  __ Eor(QRegisterFrom(locations->Out()).V16B(),
+         QRegisterFrom(locations->InAt(0)).V16B(),
+         QRegisterFrom(locations->InAt(1)).V16B());
+}
+
+//
+// Memory operations.
+//
+
+void LocationsBuilderARM64::VisitVecLoad(HVecLoad* instruction) {
+  CreateVecMemLocations(GetGraph()->GetArena(), instruction, /* is_load */ true);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecLoad(HVecLoad* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type component_type = instruction->GetComponentType();
+  FPRegister reg = QRegisterFrom(locations->Out());
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  MemOperand address = VecAddress(GetVIXLAssembler(), instruction, &temps, component_type);
+  if (!instruction->IsWidening()) {
+    __ Ldr(reg, address);
+    return;
+  }
+  // Widening loads extend every element into an int lane.
+  DCHECK_EQ(instruction->GetPackedType(), Primitive::kPrimInt);
+  switch (component_type) {
+    case Primitive::kPrimByte:
+      __ Ldr(reg.S(), address);
+      __ Sxtl(reg.V8H(), reg.V8B());
+      __ Sxtl(reg.V4S(), reg.V4H());
+      break;
+    case Primitive::kPrimChar:
+      __ Ldr(reg.D(), address);
+      __ Uxtl(reg.V4S(), reg.V4H());
+      break;
+    case Primitive::kPrimShort:
+      __ Ldr(reg.D(), address);
+      __ Sxtl(reg.V4S(), reg.V4H());
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD widening from " << component_type;
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderARM64::VisitVecStore(HVecStore* instruction) {
+  CreateVecMemLocations(GetGraph()->GetArena(), instruction, /* is_load */ false);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecStore(HVecStore* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  MemOperand address =
+      VecAddress(GetVIXLAssembler(), instruction, &temps, instruction->GetPackedType());
+  __ Str(QRegisterFrom(locations->InAt(2)), address);
+}
+
+//
+// Reductions.
+//
+
+void LocationsBuilderARM64::VisitVecReduce(HVecReduce* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The output is written before the accumulator is read.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecReduce(HVecReduce* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Primitive::Type type = instruction->GetPackedType();
+  FPRegister src = VRegisterFrom(locations->InAt(0), type);
+  Register acc = InputRegisterAt(instruction, 1);
+  Register out = OutputRegister(instruction);
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  FPRegister tmp = temps.AcquireD();
+  switch (type) {
+    case Primitive::kPrimInt:
+      switch (instruction->GetKind()) {
+        case HVecReduce::kSum:
+          __ Addv(tmp.S(), src);
+          __ Fmov(out, tmp.S());
+          __ Add(out, out, acc);
+          break;
+        case HVecReduce::kMin:
+          __ Sminv(tmp.S(), src);
+          __ Fmov(out, tmp.S());
+          __ Cmp(out, acc);
+          __ Csel(out, out, acc, lt);
+          break;
+        case HVecReduce::kMax:
+          __ Smaxv(tmp.S(), src);
+          __ Fmov(out, tmp.S());
+          __ Cmp(out, acc);
+          __ Csel(out, out, acc, gt);
+          break;
+      }
+      break;
+    case Primitive::kPrimLong:
+      DCHECK_EQ(instruction->GetKind(), HVecReduce::kSum);
+      __ Addp(tmp, src);
+      __ Fmov(out, tmp);
+      __ Add(out, out, acc);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type " << type;
+      UNREACHABLE();
+  }
+}
+
+#undef __
+
+}  // namespace arm64
+}  // namespace art
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "code_generator_x86_64.h"
+
+#include "base/bit_utils.h"
+#include "mirror/array-inl.h"
+#include "utils/x86_64/assembler_x86_64.h"
+
+namespace art {
+namespace x86_64 {
+
+#define __ down_cast<X86_64Assembler*>(GetAssembler())->
+
+//
+// Helpers.
+//
+
+// Returns the memory operand a[i] of a vector memory operation, where the
+// elements of the array are of the given size.
+static Address VecAddress(LocationSummary* locations, size_t size) {
+  CpuRegister base = locations->InAt(0).AsRegister<CpuRegister>();
+  Location index = locations->InAt(1);
+  ScaleFactor scale = static_cast<ScaleFactor>(CTZ(size));
+  uint32_t offset = mirror::Array::DataOffset(size).Uint32Value();
+  if (index.IsConstant()) {
+    offset += index.GetConstant()->AsIntConstant()->GetValue() << scale;
+    return Address(base, offset);
+  }
+  return Address(base, index.AsRegister<CpuRegister>(), scale, offset);
+}
+
+static void CreateVecUnOpLocations(ArenaAllocator* arena, HVecUnaryOperation* instruction) {
+  LocationSummary* locations = new (arena) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kOutputOverlap);
+}
+
+static void CreateVecBinOpLocations(ArenaAllocator* arena, HVecBinaryOperation* instruction) {
+  LocationSummary* locations = new (arena) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresFpuRegister());
+  locations->SetOut(Location::SameAsFirstInput());
+}
+
+//
+// Unary operations.
+//
+
+void LocationsBuilderX86_64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetOut(Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  CpuRegister src = locations->InAt(0).AsRegister<CpuRegister>();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  switch (instruction->GetPackedType()) {
+    case Primitive::kPrimByte:
+      __ movd(dst, src, /* is64bit */ false);
+      __ punpcklbw(dst, dst);
+      __ punpcklwd(dst, dst);
+      __ pshufd(dst, dst, Immediate(0));
+      break;
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+      __ movd(dst, src, /* is64bit */ false);
+      __ punpcklwd(dst, dst);
+      __ pshufd(dst, dst, Immediate(0));
+      break;
+    case Primitive::kPrimInt:
+      __ movd(dst, src, /* is64bit */ false);
+      __ pshufd(dst, dst, Immediate(0));
+      break;
+    case Primitive::kPrimLong:
+      __ movd(dst, src, /* is64bit */ true);
+      __ punpcklqdq(dst, dst);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecNeg(HVecNeg* instruction) {
+  CreateVecUnOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecNeg(HVecNeg* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister src = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  // Computes neg(x) = 0 - x.
+  __ pxor(dst, dst);
+  switch (instruction->GetPackedType()) {
+    case Primitive::kPrimByte:
+      __ psubb(dst, src);
+      break;
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+      __ psubw(dst, src);
+      break;
+    case Primitive::kPrimInt:
+      __ psubd(dst, src);
+      break;
+    case Primitive::kPrimLong:
+      __ psubq(dst, src);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecNot(HVecNot* instruction) {
+  CreateVecUnOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecNot(HVecNot* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister src = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  // Computes not(x) = x ^ all-ones, for any packed type.
+  __ pcmpeqb(dst, dst);
+  __ pxor(dst, src);
+}
+
+//
+// Binary operations.
+//
+
+void LocationsBuilderX86_64::VisitVecAdd(HVecAdd* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecAdd(HVecAdd* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  XmmRegister dst = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  switch (instruction->GetPackedType()) {
+    case Primitive::kPrimByte:
+      __ paddb(dst, src);
+      break;
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+      __ paddw(dst, src);
+      break;
+    case Primitive::kPrimInt:
+      __ paddd(dst, src);
+      break;
+    case Primitive::kPrimLong:
+      __ paddq(dst, src);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecSub(HVecSub* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecSub(HVecSub* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  XmmRegister dst = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  switch (instruction->GetPackedType()) {
+    case Primitive::kPrimByte:
+      __ psubb(dst, src);
+      break;
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+      __ psubw(dst, src);
+      break;
+    case Primitive::kPrimInt:
+      __ psubd(dst, src);
+      break;
+    case Primitive::kPrimLong:
+      __ psubq(dst, src);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecMul(HVecMul* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecMul(HVecMul* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  XmmRegister dst = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  switch (instruction->GetPackedType()) {
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+      __ pmullw(dst, src);
+      break;
+    case Primitive::kPrimInt:
+      __ pmulld(dst, src);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecMin(HVecMin* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecMin(HVecMin* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  DCHECK_EQ(instruction->GetPackedType(), Primitive::kPrimInt);
+  __ pminsd(locations->InAt(0).AsFpuRegister<XmmRegister>(),
+            locations->InAt(1).AsFpuRegister<XmmRegister>());
+}
+
+void LocationsBuilderX86_64::VisitVecMax(HVecMax* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecMax(HVecMax* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  DCHECK_EQ(instruction->GetPackedType(), Primitive::kPrimInt);
+  __ pmaxsd(locations->InAt(0).AsFpuRegister<XmmRegister>(),
+            locations->InAt(1).AsFpuRegister<XmmRegister>());
+}
+
+void LocationsBuilderX86_64::VisitVecAnd(HVecAnd* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecAnd(HVecAnd* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  __ pand(locations->InAt(0).AsFpuRegister<XmmRegister>(),
+          locations->InAt(1).AsFpuRegister<XmmRegister>());
+}
+
+void LocationsBuilderX86_64::VisitVecOr(HVecOr* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecOr(HVecOr* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  __ por(locations->InAt(0).AsFpuRegister<XmmRegister>(),
+         locations->InAt(1).AsFpuRegister<XmmRegister>());
+}
+
+void LocationsBuilderX86_64::VisitVecXor(HVecXor* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetArena(), instruction);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecXor(HVecXor* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  __ pxor(locations->InAt(0).AsFpuRegister<XmmRegister>(),
+          locations->InAt(1).AsFpuRegister<XmmRegister>());
+}
+
+//
+// Memory operations.
+//
+
+void LocationsBuilderX86_64::VisitVecLoad(HVecLoad* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RegisterOrConstant(instruction->GetIndex()));
+  locations->SetOut(Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecLoad(HVecLoad* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  Primitive::Type component_type = instruction->GetComponentType();
+  Address address = VecAddress(locations, Primitive::ComponentSize(component_type));
+  if (!instruction->IsWidening()) {
+    __ movdqu(dst, address);
+    return;
+  }
+  // Widening loads extend every element into an int lane.
+  DCHECK_EQ(instruction->GetPackedType(), Primitive::kPrimInt);
+  switch (component_type) {
+    case Primitive::kPrimByte:
+      __ pmovsxbd(dst, address);
+      break;
+    case Primitive::kPrimChar:
+      __ pmovzxwd(dst, address);
+      break;
+    case Primitive::kPrimShort:
+      __ pmovsxwd(dst, address);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD widening from " << component_type;
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecStore(HVecStore* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RegisterOrConstant(instruction->GetIndex()));
+  locations->SetInAt(2, Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecStore(HVecStore* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Address address = VecAddress(locations, Primitive::ComponentSize(instruction->GetPackedType()));
+  __ movdqu(address, locations->InAt(2).AsFpuRegister<XmmRegister>());
+}
+
+//
+// Reductions.
+//
+
+void LocationsBuilderX86_64::VisitVecReduce(HVecReduce* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The output is written before the accumulator is read.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecReduce(HVecReduce* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister src = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  CpuRegister acc = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+  XmmRegister tmp1 = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+  XmmRegister tmp2 = locations->GetTemp(1).AsFpuRegister<XmmRegister>();
+  HVecReduce::ReductionKind kind = instruction->GetKind();
+  switch (instruction->GetPackedType()) {
+    case Primitive::kPrimInt:
+      // Folds the upper half onto the lower half twice, after which
+      // the lowest lane holds the reduction over all four lanes.
+      __ movaps(tmp1, src);
+      __ pshufd(tmp2, src, Immediate(0x4E));
+      switch (kind) {
+        case HVecReduce::kSum:
+          __ paddd(tmp1, tmp2);
+          __ pshufd(tmp2, tmp1, Immediate(0xB1));
+          __ paddd(tmp1, tmp2);
+          __ movd(out, tmp1, /* is64bit */ false);
+          __ addl(out, acc);
+          break;
+        case HVecReduce::kMin:
+          __ pminsd(tmp1, tmp2);
+          __ pshufd(tmp2, tmp1, Immediate(0xB1));
+          __ pminsd(tmp1, tmp2);
+          __ movd(out, tmp1, /* is64bit */ false);
+          __ cmpl(out, acc);
+          __ cmov(kGreater, out, acc, /* is64bit */ false);
+          break;
+        case HVecReduce::kMax:
+          __ pmaxsd(tmp1, tmp2);
+          __ pshufd(tmp2, tmp1, Immediate(0xB1));
+          __ pmaxsd(tmp1, tmp2);
+          __ movd(out, tmp1, /* is64bit */ false);
+          __ cmpl(out, acc);
+          __ cmov(kLess, out, acc, /* is64bit */ false);
+          break;
+      }
+      break;
+    case Primitive::kPrimLong:
+      DCHECK_EQ(kind, HVecReduce::kSum);
+      __ movaps(tmp1, src);
+      __ pshufd(tmp2, src, Immediate(0x4E));
+      __ paddq(tmp1, tmp2);
+      __ movd(out, tmp1, /* is64bit */ true);
+      __ addq(out, acc);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+#undef __
+
+}  // namespace x86_64
+}  // namespace art
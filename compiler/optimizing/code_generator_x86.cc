@@ -5882,6 +5882,12 @@ void LocationsBuilderX86::VisitLoadClass(HLoadClass* cls) {
       Location::RegisterLocation(calling_convention.GetRegisterAt(0)),
       Location::RegisterLocation(EAX),
       /* code_generator_supports_read_barrier */ true);
+  if (kUseHashedDexCache && !cls->NeedsAccessCheck() && !cls->IsReferrersClass()) {
+    // For GenerateDexCachePairLoad().
+    LocationSummary* locations = cls->GetLocations();
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresFpuRegister());
+  }
 }
 
 void InstructionCodeGeneratorX86::VisitLoadClass(HLoadClass* cls) {
@@ -5906,6 +5912,39 @@ void InstructionCodeGeneratorX86::VisitLoadClass(HLoadClass* cls) {
     // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
     GenerateGcRootFieldLoad(
         cls, out_loc, Address(current_method, ArtMethod::DeclaringClassOffset().Int32Value()));
+  } else if (kUseHashedDexCache) {
+    // The slot of the type may hold another type: check its index.
+    DCHECK(!cls->IsInDexCache());
+    DCHECK(cls->CanCallRuntime());
+    SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathX86(
+        cls, cls, cls->GetDexPc(), cls->MustGenerateClinitCheck());
+    codegen_->AddSlowPath(slow_path);
+    if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+      // The slow path read barriers need the address of the root, which can't be read apart
+      // from its index. Resolve the type in the runtime.
+      __ jmp(slow_path->GetEntryLabel());
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
+    // /* mirror::TypeDexCachePair[] */ out =
+    //        current_method.ptr_sized_fields_->dex_cache_resolved_types_
+    __ movl(out, Address(current_method,
+                         ArtMethod::DexCacheResolvedTypesOffset(kX86PointerSize).Int32Value()));
+    // /* mirror::TypeDexCachePair */ out = out[type_index % cache size]
+    GenerateDexCachePairLoad(cls,
+                             out_loc,
+                             Address(out, CodeGenerator::GetTypePairOffset(cls->GetTypeIndex())),
+                             cls->GetTypeIndex(),
+                             slow_path->GetEntryLabel(),
+                             locations->GetTemp(0),
+                             locations->GetTemp(1));
+    __ testl(out, out);
+    __ j(kEqual, slow_path->GetEntryLabel());
+    if (cls->MustGenerateClinitCheck()) {
+      GenerateClassInitializationCheck(slow_path, out);
+    } else {
+      __ Bind(slow_path->GetExitLabel());
+    }
   } else {
     // /* GcRoot<mirror::Class>[] */ out =
     //        current_method.ptr_sized_fields_->dex_cache_resolved_types_
@@ -6015,6 +6054,11 @@ void LocationsBuilderX86::VisitLoadString(HLoadString* load) {
     locations->SetInAt(0, Location::RequiresRegister());
   }
   locations->SetOut(Location::RequiresRegister());
+  if (kUseHashedDexCache && load_kind == HLoadString::LoadKind::kDexCacheViaMethod) {
+    // For GenerateDexCachePairLoad().
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresFpuRegister());
+  }
 }
 
 void InstructionCodeGeneratorX86::VisitLoadString(HLoadString* load) {
@@ -6059,6 +6103,16 @@ void InstructionCodeGeneratorX86::VisitLoadString(HLoadString* load) {
       break;
     }
     case HLoadString::LoadKind::kDexCacheViaMethod: {
+      if (kUseHashedDexCache && kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+        // The slow path read barriers need the address of the root, which can't be read apart
+        // from its index. Resolve the string in the runtime.
+        DCHECK(!load->IsInDexCache());
+        SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathX86(load);
+        codegen_->AddSlowPath(slow_path);
+        __ jmp(slow_path->GetEntryLabel());
+        __ Bind(slow_path->GetExitLabel());
+        return;
+      }
       Register current_method = locations->InAt(0).AsRegister<Register>();
 
       // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
@@ -6067,6 +6121,25 @@ void InstructionCodeGeneratorX86::VisitLoadString(HLoadString* load) {
 
       // /* GcRoot<mirror::String>[] */ out = out->dex_cache_strings_
       __ movl(out, Address(out, mirror::Class::DexCacheStringsOffset().Int32Value()));
+      if (kUseHashedDexCache) {
+        // The slot of the string may hold another string: check its index.
+        DCHECK(!load->IsInDexCache());
+        SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathX86(load);
+        codegen_->AddSlowPath(slow_path);
+        // /* mirror::StringDexCachePair */ out = out[string_index % cache size]
+        GenerateDexCachePairLoad(load,
+                                 out_loc,
+                                 Address(out, CodeGenerator::GetStringPairOffset(
+                                     load->GetStringIndex())),
+                                 load->GetStringIndex(),
+                                 slow_path->GetEntryLabel(),
+                                 locations->GetTemp(0),
+                                 locations->GetTemp(1));
+        __ testl(out, out);
+        __ j(kEqual, slow_path->GetEntryLabel());
+        __ Bind(slow_path->GetExitLabel());
+        return;
+      }
       // /* GcRoot<mirror::String> */ out = out[string_index]
       GenerateGcRootFieldLoad(
           load, out_loc, Address(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())));
@@ -6771,6 +6844,39 @@ void InstructionCodeGeneratorX86::GenerateReferenceLoadTwoRegisters(HInstruction
   }
 }
 
+void InstructionCodeGeneratorX86::GenerateDexCachePairLoad(HInstruction* instruction,
+                                                           Location root,
+                                                           const Address& address,
+                                                           uint32_t index,
+                                                           Label* miss,
+                                                           Location temp,
+                                                           Location fp_temp) {
+  DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+  Register root_reg = root.AsRegister<Register>();
+  Register temp_reg = temp.AsRegister<Register>();
+  XmmRegister fp_temp_reg = fp_temp.AsFpuRegister<XmmRegister>();
+  // The pair is stored with a single 8-byte write. Load it as a whole, with the root in the low
+  // half and the index in the high half, so that the root and the index match.
+  __ movsd(fp_temp_reg, address);
+  __ movd(root_reg, fp_temp_reg);
+  __ psrlq(fp_temp_reg, Immediate(32));
+  __ movd(temp_reg, fp_temp_reg);
+  __ cmpl(temp_reg, Immediate(dchecked_integral_cast<int32_t>(index)));
+  __ j(kNotEqual, miss);
+  if (kEmitCompilerReadBarrier) {
+    // Fast path implementation of art::ReadBarrier::BarrierForRoot when
+    // Baker's read barrier are used, as in GenerateGcRootFieldLoad().
+    SlowPathCode* slow_path =
+        new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathX86(instruction, root, root);
+    codegen_->AddSlowPath(slow_path);
+
+    __ fs()->cmpl(Address::Absolute(Thread::IsGcMarkingOffset<kX86WordSize>().Int32Value()),
+                  Immediate(0));
+    __ j(kNotEqual, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 void InstructionCodeGeneratorX86::GenerateGcRootFieldLoad(HInstruction* instruction,
                                                           Location root,
                                                           const Address& address,
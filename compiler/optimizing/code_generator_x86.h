@@ -265,6 +265,18 @@ class InstructionCodeGeneratorX86 : public InstructionCodeGenerator {
                                Location root,
                                const Address& address,
                                Label* fixup_label = nullptr);
+  // Generate a GC root reference load from a (root, index) pair of a hashed dex cache array:
+  //
+  //   root <- (address->index == index) ? address->root : goto miss
+  //
+  // with a single load of the pair, while honoring Baker's read barriers.
+  void GenerateDexCachePairLoad(HInstruction* instruction,
+                                Location root,
+                                const Address& address,
+                                uint32_t index,
+                                Label* miss,
+                                Location temp,
+                                Location fp_temp);
 
   // Push value to FPU stack. `is_fp` specifies whether the value is floating point or not.
   // `is_wide` specifies whether it is long/double or not.
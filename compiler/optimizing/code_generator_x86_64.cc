@@ -23,6 +23,7 @@
 #include "gc/accounting/card_table.h"
 #include "intrinsics.h"
 #include "intrinsics_x86_64.h"
+#include "jit/profiling_info.h"
 #include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object_reference.h"
@@ -709,6 +710,66 @@ class ReadBarrierForRootSlowPathX86_64 : public SlowPathCode {
   DISALLOW_COPY_AND_ASSIGN(ReadBarrierForRootSlowPathX86_64);
 };
 
+class CompileOptimizedSlowPathX86_64 : public SlowPathCode {
+ public:
+  explicit CompileOptimizedSlowPathX86_64(HSuspendCheck* instruction)
+      : SlowPathCode(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    CodeGeneratorX86_64* x86_64_codegen = down_cast<CodeGeneratorX86_64*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, instruction_->GetLocations());
+    InvokeRuntimeCallingConvention calling_convention;
+    __ movq(CpuRegister(calling_convention.GetRegisterAt(0)),
+            Address(CpuRegister(RSP), kCurrentMethodStackOffset));
+    x86_64_codegen->InvokeRuntime(QUICK_ENTRY_POINT(pCompileOptimized),
+                                  instruction_,
+                                  instruction_->GetDexPc(),
+                                  this);
+    CheckEntrypointTypes<kQuickCompileOptimized, void, ArtMethod*>();
+    RestoreLiveRegisters(codegen, instruction_->GetLocations());
+    __ jmp(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "CompileOptimizedSlowPathX86_64"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathX86_64);
+};
+
+class UpdateInlineCacheSlowPathX86_64 : public SlowPathCode {
+ public:
+  explicit UpdateInlineCacheSlowPathX86_64(HUpdateInlineCache* instruction)
+      : SlowPathCode(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    CodeGeneratorX86_64* x86_64_codegen = down_cast<CodeGeneratorX86_64*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+    // Move the receiver first, as it may be in one of the other argument registers.
+    InvokeRuntimeCallingConvention calling_convention;
+    x86_64_codegen->Move(Location::RegisterLocation(calling_convention.GetRegisterAt(0)),
+                         locations->InAt(0));
+    __ movq(CpuRegister(calling_convention.GetRegisterAt(1)),
+            Address(CpuRegister(RSP), kCurrentMethodStackOffset));
+    __ movl(CpuRegister(calling_convention.GetRegisterAt(2)),
+            Immediate(instruction_->GetDexPc()));
+    x86_64_codegen->InvokeRuntime(QUICK_ENTRY_POINT(pUpdateInlineCache),
+                                  instruction_,
+                                  instruction_->GetDexPc(),
+                                  this);
+    CheckEntrypointTypes<kQuickUpdateInlineCache, void, mirror::Object*, ArtMethod*, uint32_t>();
+    RestoreLiveRegisters(codegen, locations);
+    __ jmp(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "UpdateInlineCacheSlowPathX86_64"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(UpdateInlineCacheSlowPathX86_64);
+};
+
 #undef __
 #define __ down_cast<X86_64Assembler*>(GetAssembler())->
 
@@ -5094,6 +5155,10 @@ void InstructionCodeGeneratorX86_64::GenerateSuspendCheck(HSuspendCheck* instruc
     DCHECK_EQ(slow_path->GetSuccessor(), successor);
   }
 
+  if (GetGraph()->IsCompilingBaseline()) {
+    GenerateIncreaseHotness(instruction);
+  }
+
   __ gs()->cmpw(Address::Absolute(Thread::ThreadFlagsOffset<kX86_64WordSize>().Int32Value(),
                                   /* no_rip */ true),
                 Immediate(0));
@@ -5106,6 +5171,52 @@ void InstructionCodeGeneratorX86_64::GenerateSuspendCheck(HSuspendCheck* instruc
   }
 }
 
+void InstructionCodeGeneratorX86_64::GenerateIncreaseHotness(HSuspendCheck* instruction) {
+  // Baseline code counts method entries and loop back edges in the hotness of the
+  // method, and requests its compilation with all optimizations at the threshold.
+  SlowPathCode* slow_path =
+      new (GetGraph()->GetArena()) CompileOptimizedSlowPathX86_64(instruction);
+  codegen_->AddSlowPath(slow_path);
+  CpuRegister method(TMP);
+  __ movq(method, Address(CpuRegister(RSP), kCurrentMethodStackOffset));
+  Address hotness(method, ArtMethod::HotnessCountOffset().Int32Value());
+  __ addw(hotness, Immediate(1));
+  // The count may go past the threshold without reaching it exactly, e.g. when threads
+  // race on the increment, so request the compilation at any count above it.
+  __ cmpw(hotness, Immediate(CodeGenerator::GetBaselineHotnessThreshold()));
+  __ j(kAboveEqual, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void LocationsBuilderX86_64::VisitUpdateInlineCache(HUpdateInlineCache* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitUpdateInlineCache(HUpdateInlineCache* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  CpuRegister receiver = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister temp = locations->GetTemp(0).AsRegister<CpuRegister>();
+  SlowPathCode* slow_path =
+      new (GetGraph()->GetArena()) UpdateInlineCacheSlowPathX86_64(instruction);
+  codegen_->AddSlowPath(slow_path);
+
+  // Only call the runtime when the receiver class is not the first class of the
+  // cache. The runtime looks up the cache again, as it may have been freed along
+  // with the ProfilingInfo of the method.
+  // /* HeapReference<Class> */ temp = receiver->klass_
+  __ movl(temp, Address(receiver, mirror::Object::ClassOffset().Int32Value()));
+  // No read barrier is needed, as the class is only compared to the cache.
+  __ MaybeUnpoisonHeapReference(temp);
+  codegen_->Load64BitValue(CpuRegister(TMP),
+                           reinterpret_cast<int64_t>(instruction->GetInlineCache()));
+  __ cmpl(temp, Address(CpuRegister(TMP), InlineCache::ClassesOffset().Int32Value()));
+  __ j(kNotEqual, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 X86_64Assembler* ParallelMoveResolverX86_64::GetAssembler() const {
   return codegen_->GetAssembler();
 }
@@ -5350,6 +5461,37 @@ void InstructionCodeGeneratorX86_64::VisitLoadClass(HLoadClass* cls) {
     // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
     GenerateGcRootFieldLoad(
         cls, out_loc, Address(current_method, ArtMethod::DeclaringClassOffset().Int32Value()));
+  } else if (kUseHashedDexCache) {
+    // The slot of the type may hold another type: check its index.
+    DCHECK(!cls->IsInDexCache());
+    DCHECK(cls->CanCallRuntime());
+    SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathX86_64(
+        cls, cls, cls->GetDexPc(), cls->MustGenerateClinitCheck());
+    codegen_->AddSlowPath(slow_path);
+    if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+      // The slow path read barriers need the address of the root, which can't be read apart
+      // from its index. Resolve the type in the runtime.
+      __ jmp(slow_path->GetEntryLabel());
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
+    // /* mirror::TypeDexCachePair[] */ out =
+    //        current_method.ptr_sized_fields_->dex_cache_resolved_types_
+    __ movq(out, Address(current_method,
+                         ArtMethod::DexCacheResolvedTypesOffset(kX86_64PointerSize).Int32Value()));
+    // /* mirror::TypeDexCachePair */ out = out[type_index % cache size]
+    GenerateDexCachePairLoad(cls,
+                             out_loc,
+                             Address(out, CodeGenerator::GetTypePairOffset(cls->GetTypeIndex())),
+                             cls->GetTypeIndex(),
+                             slow_path->GetEntryLabel());
+    __ testl(out, out);
+    __ j(kEqual, slow_path->GetEntryLabel());
+    if (cls->MustGenerateClinitCheck()) {
+      GenerateClassInitializationCheck(slow_path, out);
+    } else {
+      __ Bind(slow_path->GetExitLabel());
+    }
   } else {
     // /* GcRoot<mirror::Class>[] */ out =
     //        current_method.ptr_sized_fields_->dex_cache_resolved_types_
@@ -5482,6 +5624,16 @@ void InstructionCodeGeneratorX86_64::VisitLoadString(HLoadString* load) {
       break;
     }
     case HLoadString::LoadKind::kDexCacheViaMethod: {
+      if (kUseHashedDexCache && kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+        // The slow path read barriers need the address of the root, which can't be read apart
+        // from its index. Resolve the string in the runtime.
+        DCHECK(!load->IsInDexCache());
+        SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathX86_64(load);
+        codegen_->AddSlowPath(slow_path);
+        __ jmp(slow_path->GetEntryLabel());
+        __ Bind(slow_path->GetExitLabel());
+        return;
+      }
       CpuRegister current_method = locations->InAt(0).AsRegister<CpuRegister>();
 
       // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
@@ -5489,6 +5641,23 @@ void InstructionCodeGeneratorX86_64::VisitLoadString(HLoadString* load) {
           load, out_loc, Address(current_method, ArtMethod::DeclaringClassOffset().Int32Value()));
       // /* GcRoot<mirror::String>[] */ out = out->dex_cache_strings_
       __ movq(out, Address(out, mirror::Class::DexCacheStringsOffset().Uint32Value()));
+      if (kUseHashedDexCache) {
+        // The slot of the string may hold another string: check its index.
+        DCHECK(!load->IsInDexCache());
+        SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathX86_64(load);
+        codegen_->AddSlowPath(slow_path);
+        // /* mirror::StringDexCachePair */ out = out[string_index % cache size]
+        GenerateDexCachePairLoad(load,
+                                 out_loc,
+                                 Address(out, CodeGenerator::GetStringPairOffset(
+                                     load->GetStringIndex())),
+                                 load->GetStringIndex(),
+                                 slow_path->GetEntryLabel());
+        __ testl(out, out);
+        __ j(kEqual, slow_path->GetEntryLabel());
+        __ Bind(slow_path->GetExitLabel());
+        return;
+      }
       // /* GcRoot<mirror::String> */ out = out[string_index]
       GenerateGcRootFieldLoad(
           load, out_loc, Address(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())));
@@ -6234,6 +6403,35 @@ void InstructionCodeGeneratorX86_64::GenerateReferenceLoadTwoRegisters(HInstruct
   }
 }
 
+void InstructionCodeGeneratorX86_64::GenerateDexCachePairLoad(HInstruction* instruction,
+                                                              Location root,
+                                                              const Address& address,
+                                                              uint32_t index,
+                                                              Label* miss) {
+  DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+  CpuRegister root_reg = root.AsRegister<CpuRegister>();
+  // The pair is stored with a single 8-byte write. Load it as a whole, with the root in the low
+  // half and the index in the high half, so that the root and the index match.
+  __ movq(root_reg, address);
+  __ rorq(root_reg, Immediate(32));
+  __ cmpl(root_reg, Immediate(dchecked_integral_cast<int32_t>(index)));
+  __ j(kNotEqual, miss);
+  __ shrq(root_reg, Immediate(32));
+  if (kEmitCompilerReadBarrier) {
+    // Fast path implementation of art::ReadBarrier::BarrierForRoot when
+    // Baker's read barrier are used, as in GenerateGcRootFieldLoad().
+    SlowPathCode* slow_path =
+        new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathX86_64(instruction, root, root);
+    codegen_->AddSlowPath(slow_path);
+
+    __ gs()->cmpl(Address::Absolute(Thread::IsGcMarkingOffset<kX86_64WordSize>().Int32Value(),
+                                    /* no_rip */ true),
+                  Immediate(0));
+    __ j(kNotEqual, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 void InstructionCodeGeneratorX86_64::GenerateGcRootFieldLoad(HInstruction* instruction,
                                                              Location root,
                                                              const Address& address,
@@ -1029,4 +1029,41 @@ void GraphChecker::VisitTypeConversion(HTypeConversion* instruction) {
   }
 }
 
+void GraphChecker::VisitVecOperation(HVecOperation* instruction) {
+  VisitInstruction(instruction);
+  if (!instruction->IsVectorValue()) {
+    return;
+  }
+  // Vector values cannot be spilled, nor kept in an environment.
+  if (instruction->HasEnvironmentUses()) {
+    AddError(StringPrintf("Vector value %s:%d has environment uses.",
+                          instruction->DebugName(),
+                          instruction->GetId()));
+  }
+  for (const HUseListNode<HInstruction*>& use : instruction->GetUses()) {
+    HInstruction* user = use.GetUser();
+    if (user->GetBlock() != instruction->GetBlock() || user->IsPhi()) {
+      AddError(StringPrintf("Vector value %s:%d in block %d is used by %s:%d outside of it.",
+                            instruction->DebugName(),
+                            instruction->GetId(),
+                            instruction->GetBlock()->GetBlockId(),
+                            user->DebugName(),
+                            user->GetId()));
+      continue;
+    }
+    for (HInstruction* between = instruction->GetNext();
+         between != nullptr && between != user;
+         between = between->GetNext()) {
+      if (between->NeedsEnvironment()) {
+        AddError(StringPrintf("Vector value %s:%d is live across %s:%d, which may call.",
+                              instruction->DebugName(),
+                              instruction->GetId(),
+                              between->DebugName(),
+                              between->GetId()));
+        break;
+      }
+    }
+  }
+}
+
 }  // namespace art
@@ -376,6 +376,8 @@ class HGraphVisualizerPrinter : public HGraphDelegateVisitor {
         << load_class->MustGenerateClinitCheck() << std::noboolalpha;
     StartAttributeStream("needs_access_check") << std::boolalpha
         << load_class->NeedsAccessCheck() << std::noboolalpha;
+    StartAttributeStream("class_name")
+        << PrettyType(load_class->GetTypeIndex(), load_class->GetDexFile());
   }
 
   void VisitLoadString(HLoadString* load_string) OVERRIDE {
@@ -467,6 +469,20 @@ class HGraphVisualizerPrinter : public HGraphDelegateVisitor {
     StartAttributeStream("kind") << (try_boundary->IsEntry() ? "entry" : "exit");
   }
 
+  void VisitVecOperation(HVecOperation* instruction) OVERRIDE {
+    StartAttributeStream("packed_type") << instruction->GetPackedType();
+  }
+
+  void VisitVecLoad(HVecLoad* instruction) OVERRIDE {
+    VisitVecOperation(instruction);
+    StartAttributeStream("component_type") << instruction->GetComponentType();
+  }
+
+  void VisitVecReduce(HVecReduce* instruction) OVERRIDE {
+    VisitVecOperation(instruction);
+    StartAttributeStream("kind") << instruction->GetKind();
+  }
+
 #if defined(ART_ENABLE_CODEGEN_arm) || defined(ART_ENABLE_CODEGEN_arm64)
   void VisitMultiplyAccumulate(HMultiplyAccumulate* instruction) OVERRIDE {
     StartAttributeStream("kind") << instruction->GetOpKind();
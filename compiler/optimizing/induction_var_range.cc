@@ -220,6 +220,35 @@ void InductionVarRange::GenerateTakenTest(HInstruction* context,
   }
 }
 
+HInstruction* InductionVarRange::GenerateTripCount(HLoopInformation* loop,
+                                                   HGraph* graph,
+                                                   HBasicBlock* block) {
+  HInductionVarAnalysis::InductionInfo* trip =
+      induction_analysis_->LookupInfo(loop, loop->GetHeader()->GetLastInstruction());
+  if (trip == nullptr || IsUnsafeTripCount(trip)) {
+    return nullptr;  // unknown or possibly infinite loop
+  }
+  // Determine if code generation is feasible before generating any actual code.
+  // The trip count is evaluated outside the loop, hence in_body is false.
+  const bool in_body = false;
+  const bool is_min = false;
+  bool needs_taken_test = IsBodyTripCount(trip);
+  if (!GenerateCode(trip->op_a, nullptr, nullptr, nullptr, nullptr, in_body, is_min) ||
+      (needs_taken_test &&
+       !GenerateCode(trip->op_b, nullptr, nullptr, nullptr, nullptr, in_body, is_min))) {
+    return nullptr;
+  }
+  HInstruction* trip_count = nullptr;
+  GenerateCode(trip->op_a, nullptr, graph, block, &trip_count, in_body, is_min);
+  if (needs_taken_test) {
+    HInstruction* taken_test = nullptr;
+    GenerateCode(trip->op_b, nullptr, graph, block, &taken_test, in_body, is_min);
+    trip_count = Insert(block, new (graph->GetArena()) HSelect(
+        taken_test, trip_count, graph->GetIntConstant(0), kNoDexPc));
+  }
+  return trip_count;
+}
+
 //
 // Private class methods.
 //
@@ -116,6 +116,15 @@ class InductionVarRange {
                          HBasicBlock* block,
                          /*out*/ HInstruction** taken_test);
 
+  /**
+   * Generates code for the trip count of the given loop, i.e. the number of times the loop
+   * body is executed, in given block and graph. If the trip count is only valid when the
+   * loop is taken, the returned value is guarded by the taken-test (yielding 0 otherwise).
+   * The value should be interpreted as unsigned. Returns nullptr if the loop does not
+   * have a known, safe trip count or if code generation is not possible.
+   */
+  HInstruction* GenerateTripCount(HLoopInformation* loop, HGraph* graph, HBasicBlock* block);
+
  private:
   /*
    * Enum used in IsConstant() request.
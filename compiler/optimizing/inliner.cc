@@ -18,6 +18,7 @@
 
 #include "art_method-inl.h"
 #include "builder.h"
+#include "cha.h"
 #include "class_linker.h"
 #include "constant_folding.h"
 #include "dead_code_elimination.h"
@@ -299,6 +300,16 @@ bool HInliner::TryInline(HInvoke* invoke_instruction) {
 
   DCHECK(!invoke_instruction->IsInvokeStaticOrDirect());
 
+  // Check if the class hierarchy analysis knows a single implementation.
+  if (Runtime::Current()->UseJitCompilation()) {
+    ArtMethod* single_implementation =
+        FindSingleImplementation(invoke_instruction, resolved_method);
+    if (single_implementation != nullptr) {
+      return TryInlineSingleImplementation(
+          invoke_instruction, resolved_method, single_implementation);
+    }
+  }
+
   // Check if we can use an inline cache.
   ArtMethod* caller = graph_->GetArtMethod();
   if (Runtime::Current()->UseJitCompilation()) {
@@ -433,14 +444,16 @@ HInstruction* HInliner::AddTypeGuard(HInstruction* receiver,
 
   const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
   // Note that we will just compare the classes, so we don't need Java semantics access checks.
-  // Also, the caller of `AddTypeGuard` must have guaranteed that the class is in the dex cache.
-  HLoadClass* load_class = new (graph_->GetArena()) HLoadClass(graph_->GetCurrentMethod(),
-                                                               class_index,
-                                                               caller_dex_file,
-                                                               is_referrer,
-                                                               invoke_instruction->GetDexPc(),
-                                                               /* needs_access_check */ false,
-                                                               /* is_in_dex_cache */ true);
+  // Also, the caller of `AddTypeGuard` must have guaranteed that the class is in the dex cache,
+  // but a hashed resolved types cache may evict it, and the load then resolves it again.
+  HLoadClass* load_class = new (graph_->GetArena()) HLoadClass(
+      graph_->GetCurrentMethod(),
+      class_index,
+      caller_dex_file,
+      is_referrer,
+      invoke_instruction->GetDexPc(),
+      /* needs_access_check */ false,
+      /* is_in_dex_cache */ !kUseHashedDexCache);
 
   HNotEqual* compare = new (graph_->GetArena()) HNotEqual(load_class, receiver_class);
   // TODO: Extend reference type propagation to understand the guard.
@@ -450,6 +463,9 @@ HInstruction* HInliner::AddTypeGuard(HInstruction* receiver,
     bb_cursor->InsertInstructionBefore(receiver_class, bb_cursor->GetFirstInstruction());
   }
   bb_cursor->InsertInstructionAfter(load_class, receiver_class);
+  if (load_class->NeedsEnvironment()) {
+    load_class->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  }
   bb_cursor->InsertInstructionAfter(compare, load_class);
   if (with_deoptimization) {
     HDeoptimize* deoptimize = new (graph_->GetArena()) HDeoptimize(
@@ -682,9 +698,40 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
   }
 
   // We successfully inlined, now add a guard.
+  AddMethodGuardAndReplace(receiver,
+                           cursor,
+                           bb_cursor,
+                           actual_method,
+                           invoke_instruction,
+                           return_replacement,
+                           /* with_deoptimization */ !outermost_graph_->IsCompilingOsr());
+
+  // Run type propagation to get the guard typed.
+  ReferenceTypePropagation rtp_fixup(graph_,
+                                     outer_compilation_unit_.GetDexCache(),
+                                     handles_,
+                                     /* is_first_run */ false);
+  rtp_fixup.Run();
+
+  MaybeRecordStat(kInlinedPolymorphicCall);
+
+  return true;
+}
+
+void HInliner::AddMethodGuardAndReplace(HInstruction* receiver,
+                                        HInstruction* cursor,
+                                        HBasicBlock* bb_cursor,
+                                        ArtMethod* method,
+                                        HInvoke* invoke_instruction,
+                                        HInstruction* return_replacement,
+                                        bool with_deoptimization) {
+  ClassLinker* class_linker = caller_compilation_unit_.GetClassLinker();
   HInstanceFieldGet* receiver_class = BuildGetReceiverClass(
       class_linker, receiver, invoke_instruction->GetDexPc());
 
+  size_t method_index = invoke_instruction->IsInvokeVirtual()
+      ? invoke_instruction->AsInvokeVirtual()->GetVTableIndex()
+      : invoke_instruction->AsInvokeInterface()->GetImtIndex();
   Primitive::Type type = Is64BitInstructionSet(graph_->GetInstructionSet())
       ? Primitive::kPrimLong
       : Primitive::kPrimInt;
@@ -699,10 +746,10 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
   HConstant* constant;
   if (type == Primitive::kPrimLong) {
     constant = graph_->GetLongConstant(
-        reinterpret_cast<intptr_t>(actual_method), invoke_instruction->GetDexPc());
+        reinterpret_cast<intptr_t>(method), invoke_instruction->GetDexPc());
   } else {
     constant = graph_->GetIntConstant(
-        reinterpret_cast<intptr_t>(actual_method), invoke_instruction->GetDexPc());
+        reinterpret_cast<intptr_t>(method), invoke_instruction->GetDexPc());
   }
 
   HNotEqual* compare = new (graph_->GetArena()) HNotEqual(class_table_get, constant);
@@ -714,9 +761,10 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
   bb_cursor->InsertInstructionAfter(class_table_get, receiver_class);
   bb_cursor->InsertInstructionAfter(compare, class_table_get);
 
-  if (outermost_graph_->IsCompilingOsr()) {
+  if (!with_deoptimization) {
     CreateDiamondPatternForPolymorphicInline(compare, return_replacement, invoke_instruction);
   } else {
+    DCHECK(!outermost_graph_->IsCompilingOsr());
     // TODO: Extend reference type propagation to understand the guard.
     HDeoptimize* deoptimize = new (graph_->GetArena()) HDeoptimize(
         compare, invoke_instruction->GetDexPc());
@@ -727,6 +775,82 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
     }
     invoke_instruction->GetBlock()->RemoveInstruction(invoke_instruction);
   }
+}
+
+ArtMethod* HInliner::FindSingleImplementation(HInvoke* invoke_instruction,
+                                              ArtMethod* resolved_method) {
+  DCHECK(invoke_instruction->IsInvokeVirtual() || invoke_instruction->IsInvokeInterface())
+      << invoke_instruction->DebugName();
+  if (graph_->GetInstructionSet() == kMips64) {
+    // TODO: Support HClassTableGet for mips64.
+    return nullptr;
+  }
+  ClassHierarchyAnalysis* cha = Runtime::Current()->GetClassHierarchyAnalysis();
+  if (cha == nullptr) {
+    return nullptr;
+  }
+  ArtMethod* single_implementation = cha->GetSingleImplementation(resolved_method);
+  if (single_implementation == nullptr) {
+    return nullptr;
+  }
+
+  // The guard loads the receiver's vtable or IMT entry for the call. Make sure
+  // the implementation's own class has it in that entry. Subclasses may still
+  // have an IMT conflict in that slot, see TryInlineSingleImplementation().
+  size_t pointer_size = caller_compilation_unit_.GetClassLinker()->GetImagePointerSize();
+  mirror::Class* implementation_class = single_implementation->GetDeclaringClass();
+  if (invoke_instruction->IsInvokeInterface()) {
+    if (!implementation_class->ShouldHaveImt()) {
+      return nullptr;
+    }
+    uint32_t imt_index = invoke_instruction->AsInvokeInterface()->GetImtIndex();
+    ArtMethod* imt_method = implementation_class->GetImt(pointer_size)->Get(
+        imt_index % ImTable::kSize, pointer_size);
+    if (imt_method != single_implementation) {
+      VLOG(compiler) << "Single implementation " << PrettyMethod(single_implementation)
+                     << " is not inlined because of an IMT conflict";
+      return nullptr;
+    }
+  } else {
+    uint32_t vtable_index = invoke_instruction->AsInvokeVirtual()->GetVTableIndex();
+    if (implementation_class->GetVTableEntry(vtable_index, pointer_size) != single_implementation) {
+      return nullptr;
+    }
+  }
+  return single_implementation;
+}
+
+bool HInliner::TryInlineSingleImplementation(HInvoke* invoke_instruction,
+                                             ArtMethod* resolved_method,
+                                             ArtMethod* single_implementation) {
+  // This optimization only works under JIT, as the guard embeds the method pointer.
+  DCHECK(Runtime::Current()->UseJitCompilation());
+
+  HInstruction* receiver = invoke_instruction->InputAt(0);
+  HInstruction* cursor = invoke_instruction->GetPrevious();
+  HBasicBlock* bb_cursor = invoke_instruction->GetBlock();
+
+  HInstruction* return_replacement = nullptr;
+  if (!TryBuildAndInline(invoke_instruction, single_implementation, &return_replacement)) {
+    return false;
+  }
+
+  // We successfully inlined, now add a guard. A vtable guard only fails for
+  // receivers of classes loaded after the compilation, and the code depending on
+  // the single implementation is then invalidated. An IMT guard also fails for
+  // subclasses of the implementation with a conflict in the IMT slot, which still
+  // call the single implementation: keep the interface call for them rather than
+  // deoptimizing on every call.
+  bool with_deoptimization =
+      invoke_instruction->IsInvokeVirtual() && !outermost_graph_->IsCompilingOsr();
+  AddMethodGuardAndReplace(receiver,
+                           cursor,
+                           bb_cursor,
+                           single_implementation,
+                           invoke_instruction,
+                           return_replacement,
+                           with_deoptimization);
+  outermost_graph_->AddCHASingleImplementationDependency(resolved_method);
 
   // Run type propagation to get the guard typed.
   ReferenceTypePropagation rtp_fixup(graph_,
@@ -735,8 +859,7 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
                                      /* is_first_run */ false);
   rtp_fixup.Run();
 
-  MaybeRecordStat(kInlinedPolymorphicCall);
-
+  MaybeRecordStat(kCHAInline);
   return true;
 }
 
@@ -1085,6 +1208,7 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
       invoke_type,
       graph_->IsDebuggable(),
       /* osr */ false,
+      /* baseline */ false,
       caller_instruction_counter);
   callee_graph->SetArtMethod(resolved_method);
 
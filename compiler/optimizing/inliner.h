@@ -118,6 +118,22 @@ class HInliner : public HOptimization {
                                             const InlineCache& ic)
     SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Return the single implementation of `resolved_method` known to the class
+  // hierarchy analysis, if the call can be guarded on it. Return null otherwise.
+  ArtMethod* FindSingleImplementation(HInvoke* invoke_instruction, ArtMethod* resolved_method)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Try to inline the single implementation of a virtual or interface call. If
+  // successful, the code in the graph will look like:
+  // if (receiver.getClass().vtable[index] != single_implementation) deopt
+  // ... // inlined code
+  // and the compiled code depends on `resolved_method` keeping a single implementation.
+  // For an interface call, the guard on the IMT entry falls back to the interface
+  // call instead of deoptimizing.
+  bool TryInlineSingleImplementation(HInvoke* invoke_instruction,
+                                     ArtMethod* resolved_method,
+                                     ArtMethod* single_implementation)
+    SHARED_REQUIRES(Locks::mutator_lock_);
 
   HInstanceFieldGet* BuildGetReceiverClass(ClassLinker* class_linker,
                                            HInstruction* receiver,
@@ -148,6 +164,23 @@ class HInliner : public HOptimization {
                              bool with_deoptimization)
     SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Add a guard checking that the receiver's vtable or IMT entry for the call is
+  // `method`, and replace `invoke_instruction` with `return_replacement`. This will
+  // add to the graph:
+  // i0 = HFieldGet(receiver, klass)
+  // i1 = HClassTableGet(i0, index)
+  // i2 = HNotEqual(i1, method)
+  // HDeoptimize(i2) if `with_deoptimization` is true, or a diamond pattern keeping
+  // the invoke otherwise. OSR compilation does not support HDeoptimize.
+  void AddMethodGuardAndReplace(HInstruction* receiver,
+                                HInstruction* cursor,
+                                HBasicBlock* bb_cursor,
+                                ArtMethod* method,
+                                HInvoke* invoke_instruction,
+                                HInstruction* return_replacement,
+                                bool with_deoptimization)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
   /*
    * Ad-hoc implementation for implementing a diamond pattern in the graph for
    * polymorphic inlining:
@@ -19,6 +19,7 @@
 #include "bytecode_utils.h"
 #include "class_linker.h"
 #include "driver/compiler_options.h"
+#include "jit/profiling_info.h"
 #include "scoped_thread_state_change.h"
 
 namespace art {
@@ -961,8 +962,9 @@ bool HInstructionBuilder::IsInitialized(Handle<mirror::Class> cls) const {
     return false;
   }
 
-  // `CanAssumeClassIsLoaded` will return true if we're JITting, or will
-  // check whether the class is in an image for the AOT compilation.
+  // `CanAssumeClassIsLoaded` will return true if we're JITting (but not for a
+  // JitCodeSnapshot), or will check whether the class is in an image for the AOT
+  // compilation.
   if (cls->IsInitialized() &&
       compiler_driver_->CanAssumeClassIsLoaded(cls.Get())) {
     return true;
@@ -1123,12 +1125,30 @@ bool HInstructionBuilder::HandleInvoke(HInvoke* invoke,
     argument_index++;
   }
 
+  if (graph_->IsCompilingBaseline() &&
+      (invoke->IsInvokeVirtual() || invoke->IsInvokeInterface())) {
+    BuildUpdateInlineCache(invoke);
+  }
+
   AppendInstruction(invoke);
   latest_result_ = invoke;
 
   return true;
 }
 
+void HInstructionBuilder::BuildUpdateInlineCache(HInvoke* invoke) {
+  ScopedObjectAccess soa(Thread::Current());
+  ProfilingInfo* info = graph_->GetArtMethod()->GetProfilingInfo(sizeof(void*));
+  if (info == nullptr) {
+    return;
+  }
+  const InlineCache* cache = info->GetInlineCache(invoke->GetDexPc());
+  if (cache != nullptr) {
+    AppendInstruction(
+        new (arena_) HUpdateInlineCache(invoke->InputAt(0), cache, invoke->GetDexPc()));
+  }
+}
+
 bool HInstructionBuilder::HandleStringInit(HInvoke* invoke,
                                            uint32_t number_of_vreg_arguments,
                                            uint32_t* args,
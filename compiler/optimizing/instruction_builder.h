@@ -247,6 +247,10 @@ class HInstructionBuilder : public ValueObject {
                         const char* descriptor);
   void HandleStringInitResult(HInvokeStaticOrDirect* invoke);
 
+  // Build a HUpdateInlineCache recording the receiver class of the virtual or
+  // interface call `invoke`, if the method profiles the call.
+  void BuildUpdateInlineCache(HInvoke* invoke);
+
   HClinitCheck* ProcessClinitCheckForInvoke(
       uint32_t dex_pc,
       ArtMethod* method,
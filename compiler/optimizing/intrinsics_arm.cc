@@ -936,6 +936,10 @@ void IntrinsicCodeGeneratorARM::VisitUnsafeCASObject(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM::VisitStringCharAt(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCallOnSlowPath,
                                                             kIntrinsified);
@@ -985,6 +989,10 @@ void IntrinsicCodeGeneratorARM::VisitStringCharAt(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM::VisitStringCompareTo(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   // The inputs plus one temp.
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
@@ -1015,6 +1023,10 @@ void IntrinsicCodeGeneratorARM::VisitStringCompareTo(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM::VisitStringEquals(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kNoCall,
                                                             kIntrinsified);
@@ -1160,6 +1172,10 @@ static void GenerateVisitStringIndexOf(HInvoke* invoke,
 }
 
 void IntrinsicLocationsBuilderARM::VisitStringIndexOf(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
                                                             kIntrinsified);
@@ -1180,6 +1196,10 @@ void IntrinsicCodeGeneratorARM::VisitStringIndexOf(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM::VisitStringIndexOfAfter(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
                                                             kIntrinsified);
@@ -1930,6 +1950,10 @@ void IntrinsicCodeGeneratorARM::VisitShortReverseBytes(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM::VisitStringGetCharsNoCheck(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kNoCall,
                                                             kIntrinsified);
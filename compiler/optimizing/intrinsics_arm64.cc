@@ -1160,13 +1160,29 @@ void IntrinsicCodeGeneratorARM64::VisitStringCharAt(HInvoke* invoke) {
 
   __ Ldr(temp, HeapOperand(obj, count_offset));          // temp = str.length.
   codegen_->MaybeRecordImplicitNullCheck(invoke);
-  __ Cmp(idx, temp);
+  if (mirror::kUseStringCompression) {
+    // Strip the compression flag from the count before the bounds check.
+    __ And(out, temp, Operand(std::numeric_limits<int32_t>::max()));
+    __ Cmp(idx, out);
+  } else {
+    __ Cmp(idx, temp);
+  }
   __ B(hs, slow_path->GetEntryLabel());
 
   __ Add(array_temp, obj, Operand(value_offset.Int32Value()));  // array_temp := str.value.
 
   // Load the value.
-  __ Ldrh(out, MemOperand(array_temp.X(), idx, UXTW, 1));  // out := array_temp[idx].
+  if (mirror::kUseStringCompression) {
+    vixl::Label uncompressed_load, done;
+    __ Tbz(temp, kWRegSize - 1, &uncompressed_load);
+    __ Ldrb(out, MemOperand(array_temp.X(), idx, UXTW));     // out := array_temp[idx].
+    __ B(&done);
+    __ Bind(&uncompressed_load);
+    __ Ldrh(out, MemOperand(array_temp.X(), idx, UXTW, 1));  // out := array_temp[idx].
+    __ Bind(&done);
+  } else {
+    __ Ldrh(out, MemOperand(array_temp.X(), idx, UXTW, 1));  // out := array_temp[idx].
+  }
 
   __ Bind(slow_path->GetExitLabel());
 }
@@ -1259,8 +1275,18 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
   __ Ldr(temp, MemOperand(str.X(), count_offset));
   __ Ldr(temp1, MemOperand(arg.X(), count_offset));
   // Check if lengths are equal, return false if they're not.
+  // With string compression, this also checks that the compression flags are equal.
   __ Cmp(temp, temp1);
   __ B(&return_false, ne);
+  if (mirror::kUseStringCompression) {
+    vixl::Label string_uncompressed;
+    // Turn the length of compressed strings into the number of 16-bit units of their bytes.
+    __ Tbz(temp, kWRegSize - 1, &string_uncompressed);
+    __ And(temp, temp, Operand(std::numeric_limits<int32_t>::max()));
+    __ Add(temp, temp, Operand(1));
+    __ Lsr(temp, temp, 1);
+    __ Bind(&string_uncompressed);
+  }
   // Store offset of string value in preparation for comparison loop
   __ Mov(temp1, value_offset);
   // Return true if both strings are empty.
@@ -1344,6 +1370,10 @@ static void GenerateVisitStringIndexOf(HInvoke* invoke,
 }
 
 void IntrinsicLocationsBuilderARM64::VisitStringIndexOf(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
                                                             kIntrinsified);
@@ -1364,6 +1394,10 @@ void IntrinsicCodeGeneratorARM64::VisitStringIndexOf(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM64::VisitStringIndexOfAfter(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
                                                             kIntrinsified);
@@ -1644,6 +1678,10 @@ void IntrinsicCodeGeneratorARM64::VisitMathNextAfter(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM64::VisitStringGetCharsNoCheck(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kNoCall,
                                                             kIntrinsified);
@@ -1287,6 +1287,10 @@ void IntrinsicCodeGeneratorMIPS64::VisitUnsafeCASObject(HInvoke* invoke) {
 
 // char java.lang.String.charAt(int index)
 void IntrinsicLocationsBuilderMIPS64::VisitStringCharAt(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCallOnSlowPath,
                                                             kIntrinsified);
@@ -1333,6 +1337,10 @@ void IntrinsicCodeGeneratorMIPS64::VisitStringCharAt(HInvoke* invoke) {
 
 // int java.lang.String.compareTo(String anotherString)
 void IntrinsicLocationsBuilderMIPS64::VisitStringCompareTo(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
                                                             kIntrinsified);
@@ -1366,6 +1374,10 @@ void IntrinsicCodeGeneratorMIPS64::VisitStringCompareTo(HInvoke* invoke) {
 
 // boolean java.lang.String.equals(Object anObject)
 void IntrinsicLocationsBuilderMIPS64::VisitStringEquals(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kNoCall,
                                                             kIntrinsified);
@@ -1520,6 +1532,10 @@ static void GenerateStringIndexOf(HInvoke* invoke,
 
 // int java.lang.String.indexOf(int ch)
 void IntrinsicLocationsBuilderMIPS64::VisitStringIndexOf(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
                                                             kIntrinsified);
@@ -1541,6 +1557,10 @@ void IntrinsicCodeGeneratorMIPS64::VisitStringIndexOf(HInvoke* invoke) {
 
 // int java.lang.String.indexOf(int ch, int fromIndex)
 void IntrinsicLocationsBuilderMIPS64::VisitStringIndexOfAfter(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
                                                             kIntrinsified);
@@ -1031,6 +1031,10 @@ void IntrinsicCodeGeneratorX86::VisitMathNextAfter(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderX86::VisitStringCharAt(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   // The inputs plus one temp.
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCallOnSlowPath,
@@ -1250,6 +1254,10 @@ void IntrinsicCodeGeneratorX86::VisitSystemArrayCopyChar(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderX86::VisitStringCompareTo(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   // The inputs plus one temp.
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCall,
@@ -1278,6 +1286,10 @@ void IntrinsicCodeGeneratorX86::VisitStringCompareTo(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderX86::VisitStringEquals(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kNoCall,
                                                             kIntrinsified);
@@ -1507,6 +1519,10 @@ static void GenerateStringIndexOf(HInvoke* invoke,
 }
 
 void IntrinsicLocationsBuilderX86::VisitStringIndexOf(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   CreateStringIndexOfLocations(invoke, arena_, /* start_at_zero */ true);
 }
 
@@ -1515,6 +1531,10 @@ void IntrinsicCodeGeneratorX86::VisitStringIndexOf(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderX86::VisitStringIndexOfAfter(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   CreateStringIndexOfLocations(invoke, arena_, /* start_at_zero */ false);
 }
 
@@ -1602,6 +1622,10 @@ void IntrinsicCodeGeneratorX86::VisitStringNewStringFromString(HInvoke* invoke)
 }
 
 void IntrinsicLocationsBuilderX86::VisitStringGetCharsNoCheck(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   // public void getChars(int srcBegin, int srcEnd, char[] dst, int dstBegin);
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kNoCall,
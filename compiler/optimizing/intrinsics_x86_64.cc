@@ -924,12 +924,32 @@ void IntrinsicCodeGeneratorX86_64::VisitStringCharAt(HInvoke* invoke) {
 
   X86_64Assembler* assembler = GetAssembler();
 
-  __ cmpl(idx, Address(obj, count_offset));
-  codegen_->MaybeRecordImplicitNullCheck(invoke);
-  __ j(kAboveEqual, slow_path->GetEntryLabel());
+  if (mirror::kUseStringCompression) {
+    CpuRegister temp = locations->GetTemp(0).AsRegister<CpuRegister>();
+    NearLabel uncompressed_load, done;
+    // Strip the compression flag from the count before the bounds check.
+    __ movl(temp, Address(obj, count_offset));
+    codegen_->MaybeRecordImplicitNullCheck(invoke);
+    __ andl(temp, Immediate(std::numeric_limits<int32_t>::max()));
+    __ cmpl(idx, temp);
+    __ j(kAboveEqual, slow_path->GetEntryLabel());
+    __ cmpl(Address(obj, count_offset), Immediate(0));
+    __ j(kGreaterEqual, &uncompressed_load);
+    // out = out[idx].
+    __ movzxb(out, Address(out, idx, ScaleFactor::TIMES_1, value_offset));
+    __ jmp(&done);
+    __ Bind(&uncompressed_load);
+    // out = out[2*idx].
+    __ movzxw(out, Address(out, idx, ScaleFactor::TIMES_2, value_offset));
+    __ Bind(&done);
+  } else {
+    __ cmpl(idx, Address(obj, count_offset));
+    codegen_->MaybeRecordImplicitNullCheck(invoke);
+    __ j(kAboveEqual, slow_path->GetEntryLabel());
 
-  // out = out[2*idx].
-  __ movzxw(out, Address(out, idx, ScaleFactor::TIMES_2, value_offset));
+    // out = out[2*idx].
+    __ movzxw(out, Address(out, idx, ScaleFactor::TIMES_2, value_offset));
+  }
 
   __ Bind(slow_path->GetExitLabel());
 }
@@ -1438,8 +1458,19 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   // Load length of receiver string.
   __ movl(rcx, Address(str, count_offset));
   // Check if lengths are equal, return false if they're not.
+  // With string compression, this also checks that the compression flags are equal.
   __ cmpl(rcx, Address(arg, count_offset));
   __ j(kNotEqual, &return_false);
+  if (mirror::kUseStringCompression) {
+    NearLabel string_uncompressed;
+    // Turn the length of compressed strings into the number of 16-bit units of their bytes.
+    __ cmpl(rcx, Immediate(0));
+    __ j(kGreaterEqual, &string_uncompressed);
+    __ andl(rcx, Immediate(std::numeric_limits<int32_t>::max()));
+    __ addl(rcx, Immediate(1));
+    __ shrl(rcx, Immediate(1));
+    __ Bind(&string_uncompressed);
+  }
   // Return true if both strings are empty.
   __ jrcxz(&return_true);
 
@@ -1608,6 +1639,10 @@ static void GenerateStringIndexOf(HInvoke* invoke,
 }
 
 void IntrinsicLocationsBuilderX86_64::VisitStringIndexOf(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   CreateStringIndexOfLocations(invoke, arena_, /* start_at_zero */ true);
 }
 
@@ -1616,6 +1651,10 @@ void IntrinsicCodeGeneratorX86_64::VisitStringIndexOf(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderX86_64::VisitStringIndexOfAfter(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   CreateStringIndexOfLocations(invoke, arena_, /* start_at_zero */ false);
 }
 
@@ -1706,6 +1745,10 @@ void IntrinsicCodeGeneratorX86_64::VisitStringNewStringFromString(HInvoke* invok
 }
 
 void IntrinsicLocationsBuilderX86_64::VisitStringGetCharsNoCheck(HInvoke* invoke) {
+  if (mirror::kUseStringCompression) {
+    // The intrinsic does not handle compressed strings, call the method instead.
+    return;
+  }
   // public void getChars(int srcBegin, int srcEnd, char[] dst, int dstBegin);
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kNoCall,
@@ -15,6 +15,7 @@
  */
 
 #include "load_store_elimination.h"
+#include "common_dominator.h"
 #include "side_effects_analysis.h"
 
 #include <iostream>
@@ -31,7 +32,8 @@ constexpr size_t kMaxNumberOfHeapLocations = 32;
 // whether it's a singleton, returned, etc.
 class ReferenceInfo : public ArenaObject<kArenaAllocMisc> {
  public:
-  ReferenceInfo(HInstruction* reference, size_t pos) : reference_(reference), position_(pos) {
+  ReferenceInfo(HInstruction* reference, size_t pos)
+      : reference_(reference), position_(pos), has_index_aliasing_(false) {
     is_singleton_ = true;
     is_singleton_and_not_returned_ = true;
     if (!reference_->IsNewInstance() && !reference_->IsNewArray()) {
@@ -102,11 +104,22 @@ class ReferenceInfo : public ArenaObject<kArenaAllocMisc> {
     return is_singleton_and_not_returned_;
   }
 
+  // Returns true if two different array element locations of reference_ may
+  // alias, for example because one of them is accessed with a non-constant index.
+  bool HasIndexAliasing() const {
+    return has_index_aliasing_;
+  }
+
+  void SetHasIndexAliasing(bool has_index_aliasing) {
+    has_index_aliasing_ = has_index_aliasing;
+  }
+
  private:
   HInstruction* const reference_;
   const size_t position_;     // position in HeapLocationCollector's ref_info_array_.
   bool is_singleton_;         // can only be referred to by a single name in the method.
   bool is_singleton_and_not_returned_;  // reference_ is singleton and not returned to caller.
+  bool has_index_aliasing_;   // array elements of reference_ may alias with each other.
 
   DISALLOW_COPY_AND_ASSIGN(ReferenceInfo);
 };
@@ -282,6 +295,15 @@ class HeapLocationCollector : public HGraphVisitor {
       for (size_t j = i + 1; j < number_of_locations; j++) {
         if (ComputeMayAlias(i, j)) {
           aliasing_matrix_.SetBit(CheckedAliasingMatrixPosition(i, j, pos));
+          HeapLocation* loc1 = heap_locations_[i];
+          HeapLocation* loc2 = heap_locations_[j];
+          if (loc1->IsArrayElement() &&
+              loc2->IsArrayElement() &&
+              loc1->GetReferenceInfo() == loc2->GetReferenceInfo()) {
+            // Stores into one of these elements cannot be removed, since a load
+            // from the other element may observe them.
+            loc1->GetReferenceInfo()->SetHasIndexAliasing(true);
+          }
         }
         pos++;
       }
@@ -453,6 +475,11 @@ class HeapLocationCollector : public HGraphVisitor {
     CreateReferenceInfoForReferenceType(new_instance);
   }
 
+  void VisitNewArray(HNewArray* new_array) OVERRIDE {
+    // Any references appearing in the ref_info_array_ so far cannot alias with new_array.
+    CreateReferenceInfoForReferenceType(new_array);
+  }
+
   void VisitInvokeStaticOrDirect(HInvokeStaticOrDirect* instruction) OVERRIDE {
     CreateReferenceInfoForReferenceType(instruction);
   }
@@ -522,7 +549,16 @@ class LSEVisitor : public HGraphVisitor {
         removed_loads_(graph->GetArena()->Adapter(kArenaAllocLSE)),
         substitute_instructions_for_loads_(graph->GetArena()->Adapter(kArenaAllocLSE)),
         possibly_removed_stores_(graph->GetArena()->Adapter(kArenaAllocLSE)),
-        singleton_new_instances_(graph->GetArena()->Adapter(kArenaAllocLSE)) {
+        singleton_new_instances_(graph->GetArena()->Adapter(kArenaAllocLSE)),
+        singleton_new_arrays_(graph->GetArena()->Adapter(kArenaAllocLSE)),
+        escaping_new_instances_(graph->GetArena()->Adapter(kArenaAllocLSE)),
+        merged_value_phis_(graph->GetArena()->Adapter(kArenaAllocLSE)),
+        merged_value_locations_(graph->GetArena()->Adapter(kArenaAllocLSE)),
+        cold_blocks_(graph->GetArena(),
+                     graph->GetBlocks().size(),
+                     /* expandable */ false,
+                     kArenaAllocLSE),
+        cold_blocks_computed_(false) {
   }
 
   void VisitBasicBlock(HBasicBlock* block) OVERRIDE {
@@ -566,12 +602,36 @@ class LSEVisitor : public HGraphVisitor {
       store->GetBlock()->RemoveInstruction(store);
     }
 
-    // TODO: remove unnecessary allocations.
-    // Eliminate instructions in singleton_new_instances_ that:
-    // - don't have uses,
+    // Remove the phis merging heap values which did not replace any load. Phis are
+    // visited in reverse order of creation, since a phi can only be used by phis
+    // created after it.
+    for (auto it = merged_value_phis_.rbegin(); it != merged_value_phis_.rend(); ++it) {
+      HPhi* phi = *it;
+      if (phi->GetUses().empty()) {
+        DCHECK(phi->GetEnvUses().empty());
+        phi->GetBlock()->RemovePhi(phi);
+      }
+    }
+
+    // Eliminate allocations that are only used by environments. All loads from and
+    // stores into them have been removed. Such allocations:
     // - don't have finalizers,
     // - are instantiable and accessible,
     // - have no/separate clinit check.
+    // The methods cannot deoptimize, so the environment uses are not needed.
+    for (HInstruction* new_instance : singleton_new_instances_) {
+      TryRemovingAllocation(new_instance);
+    }
+    for (HInstruction* new_array : singleton_new_arrays_) {
+      TryRemovingAllocation(new_array);
+    }
+
+    // Materialize the allocations which only escape on cold paths on these paths. Later
+    // allocations go first, as sinking their stores may leave an earlier allocation stored
+    // into them escaping only on the cold path, too.
+    for (auto it = escaping_new_instances_.rbegin(); it != escaping_new_instances_.rend(); ++it) {
+      TrySinkingAllocation((*it)->AsNewInstance());
+    }
   }
 
  private:
@@ -580,9 +640,21 @@ class LSEVisitor : public HGraphVisitor {
   // effects (which is essentially merging also), since a load later from the
   // location won't be eliminated.
   void KeepIfIsStore(HInstruction* heap_value) {
-    if (heap_value == kDefaultHeapValue ||
-        heap_value == kUnknownHeapValue ||
-        !heap_value->IsInstanceFieldSet()) {
+    if (heap_value == kDefaultHeapValue || heap_value == kUnknownHeapValue) {
+      return;
+    }
+    if (heap_value->IsPhi()) {
+      // A phi created for merged heap values needs the last store in each
+      // predecessor, since the phi takes the stored values.
+      size_t idx = FindMergedValueLocation(heap_value->AsPhi());
+      if (idx != HeapLocationCollector::kHeapLocationNotFound) {
+        for (HBasicBlock* predecessor : heap_value->GetBlock()->GetPredecessors()) {
+          KeepIfIsStore(heap_values_for_[predecessor->GetBlockId()][idx]);
+        }
+      }
+      return;
+    }
+    if (!heap_value->IsInstanceFieldSet() && !heap_value->IsArraySet()) {
       return;
     }
     auto idx = std::find(possibly_removed_stores_.begin(),
@@ -650,7 +722,9 @@ class LSEVisitor : public HGraphVisitor {
         for (size_t j = 1; j < predecessors.size(); j++) {
           HInstruction* pred_value = heap_values_for_[predecessors[j]->GetBlockId()][i];
           if (pred_value != pred0_value) {
-            heap_values[i] = kUnknownHeapValue;
+            // Different values reach the block. For a singleton, they can be
+            // merged with a phi, which replaces the object's field in registers.
+            heap_values[i] = TryMergingWithPhi(block, i);
             break;
           }
         }
@@ -666,6 +740,219 @@ class LSEVisitor : public HGraphVisitor {
     }
   }
 
+  // Returns the value held by a heap location whose heap value is `heap_value`,
+  // which must be known. For a possibly removed store, that is the stored value.
+  HInstruction* GetActualValue(HInstruction* heap_value) {
+    DCHECK_NE(heap_value, kUnknownHeapValue);
+    DCHECK_NE(heap_value, kDefaultHeapValue);
+    if (heap_value->IsInstanceFieldSet()) {
+      return heap_value->InputAt(1);
+    } else if (heap_value->IsArraySet()) {
+      return heap_value->InputAt(2);
+    }
+    return heap_value;
+  }
+
+  // Different heap values of location `idx` reach `block` from its predecessors.
+  // If the location belongs to a singleton and all the values are known, create
+  // a phi merging them in `block` and return it. Otherwise return kUnknownHeapValue.
+  HInstruction* TryMergingWithPhi(HBasicBlock* block, size_t idx) {
+    const ArenaVector<HBasicBlock*>& predecessors = block->GetPredecessors();
+    HeapLocation* location = heap_location_collector_.GetHeapLocation(idx);
+    ReferenceInfo* ref_info = location->GetReferenceInfo();
+    if (!ref_info->IsSingleton() ||
+        (location->IsArrayElement() && ref_info->HasIndexAliasing())) {
+      return kUnknownHeapValue;
+    }
+    // Find the type of the location from the values which are not the default one.
+    Primitive::Type type = Primitive::kPrimVoid;
+    for (HBasicBlock* predecessor : predecessors) {
+      HInstruction* pred_value = heap_values_for_[predecessor->GetBlockId()][idx];
+      if (pred_value == kUnknownHeapValue) {
+        return kUnknownHeapValue;
+      }
+      if (pred_value == kDefaultHeapValue) {
+        continue;
+      }
+      Primitive::Type value_type = HPhi::ToPhiType(GetActualValue(pred_value)->GetType());
+      if (type == Primitive::kPrimVoid) {
+        type = value_type;
+      } else if (type != value_type) {
+        return kUnknownHeapValue;
+      }
+    }
+    if (type == Primitive::kPrimVoid || type == Primitive::kPrimNot) {
+      // References are not merged, as the phi would need type information.
+      return kUnknownHeapValue;
+    }
+    ArenaAllocator* arena = GetGraph()->GetArena();
+    HPhi* phi = new (arena) HPhi(arena, kNoRegNumber, 0, type);
+    for (HBasicBlock* predecessor : predecessors) {
+      HInstruction* pred_value = heap_values_for_[predecessor->GetBlockId()][idx];
+      phi->AddInput(pred_value == kDefaultHeapValue
+                        ? GetDefaultValue(type)
+                        : GetActualValue(pred_value));
+    }
+    block->AddPhi(phi);
+    merged_value_phis_.push_back(phi);
+    merged_value_locations_.push_back(idx);
+    return phi;
+  }
+
+  // Returns the heap location `phi` merges the values of, or kHeapLocationNotFound
+  // if `phi` was not created by this pass.
+  size_t FindMergedValueLocation(HPhi* phi) const {
+    for (size_t i = 0, size = merged_value_phis_.size(); i < size; i++) {
+      if (merged_value_phis_[i] == phi) {
+        return merged_value_locations_[i];
+      }
+    }
+    return HeapLocationCollector::kHeapLocationNotFound;
+  }
+
+  void TryRemovingAllocation(HInstruction* allocation) {
+    if (!allocation->HasNonEnvironmentUses()) {
+      allocation->RemoveEnvironmentUsers();
+      allocation->GetBlock()->RemoveInstruction(allocation);
+    }
+  }
+
+  // A block is cold if all paths from it end with a throw. Since the method has no catch
+  // blocks, a cold block runs at most once for each execution of its loop.
+  bool IsCold(HBasicBlock* block) {
+    if (!cold_blocks_computed_) {
+      cold_blocks_computed_ = true;
+      bool changed = true;
+      while (changed) {
+        changed = false;
+        for (HPostOrderIterator it(*GetGraph()); !it.Done(); it.Advance()) {
+          HBasicBlock* current = it.Current();
+          if (cold_blocks_.IsBitSet(current->GetBlockId())) {
+            continue;
+          }
+          bool is_cold = current->GetLastInstruction()->IsThrow();
+          if (!is_cold && !current->GetSuccessors().empty()) {
+            is_cold = true;
+            for (HBasicBlock* successor : current->GetSuccessors()) {
+              is_cold = is_cold && cold_blocks_.IsBitSet(successor->GetBlockId());
+            }
+          }
+          if (is_cold) {
+            cold_blocks_.SetBit(current->GetBlockId());
+            changed = true;
+          }
+        }
+      }
+    }
+    return cold_blocks_.IsBitSet(block->GetBlockId());
+  }
+
+  // `allocation` escapes. If all escapes are in cold blocks, move it to the start of the cold
+  // block dominating them, so that the other paths don't allocate. The stores into it on the
+  // way there must be on all paths to that block and are moved after it, keeping the last
+  // store to each field. The method cannot deoptimize, so the environment uses not dominated
+  // by the new position are removed, as in TryRemovingAllocation. OSR code needs them at
+  // the suspend checks of loop headers, so it keeps its allocations.
+  void TrySinkingAllocation(HNewInstance* allocation) {
+    if (GetGraph()->IsCompilingOsr()) {
+      return;
+    }
+    HBasicBlock* allocation_block = allocation->GetBlock();
+    HBasicBlock* cold_block = nullptr;
+    for (const HUseListNode<HInstruction*>& use : allocation->GetUses()) {
+      HInstruction* user = use.GetUser();
+      if (user->IsInstanceFieldSet() &&
+          user->InputAt(0) == allocation &&
+          user->InputAt(1) != allocation) {
+        continue;
+      }
+      if (user->IsPhi() ||
+          user->IsBoundType() ||
+          user->IsUnresolvedInstanceFieldGet() ||
+          user->IsUnresolvedInstanceFieldSet() ||
+          !IsCold(user->GetBlock())) {
+        return;
+      }
+      cold_block = (cold_block == nullptr)
+          ? user->GetBlock()
+          : CommonDominator::ForPair(cold_block, user->GetBlock());
+    }
+    if (cold_block == nullptr ||
+        cold_block == allocation_block ||
+        !IsCold(cold_block) ||
+        cold_block->GetLoopInformation() != allocation_block->GetLoopInformation()) {
+      return;
+    }
+    // The stores which are not dominated by the cold block must be in blocks of the dominator
+    // chain from the allocation to it, outside of inner loops.
+    size_t num_hot_stores = 0;
+    for (const HUseListNode<HInstruction*>& use : allocation->GetUses()) {
+      HBasicBlock* block = use.GetUser()->GetBlock();
+      if (cold_block->Dominates(block)) {
+        continue;
+      }
+      if (!block->Dominates(cold_block) ||
+          block->GetLoopInformation() != allocation_block->GetLoopInformation()) {
+        return;
+      }
+      ++num_hot_stores;
+    }
+    ArenaVector<HBasicBlock*> chain(GetGraph()->GetArena()->Adapter(kArenaAllocLSE));
+    for (HBasicBlock* block = cold_block->GetDominator();
+         block != allocation_block;
+         block = block->GetDominator()) {
+      chain.push_back(block);
+    }
+    chain.push_back(allocation_block);
+    ArenaVector<HInstruction*> last_stores(GetGraph()->GetArena()->Adapter(kArenaAllocLSE));
+    ArenaVector<HInstruction*> overwritten_stores(GetGraph()->GetArena()->Adapter(kArenaAllocLSE));
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      for (HInstructionIterator inst_it((*it)->GetInstructions()); !inst_it.Done();
+           inst_it.Advance()) {
+        HInstruction* instruction = inst_it.Current();
+        if (!instruction->IsInstanceFieldSet() || instruction->InputAt(0) != allocation) {
+          continue;
+        }
+        uint32_t offset =
+            instruction->AsInstanceFieldSet()->GetFieldInfo().GetFieldOffset().Uint32Value();
+        auto same_field = std::find_if(
+            last_stores.begin(),
+            last_stores.end(),
+            [offset](HInstruction* store) {
+              return store->AsInstanceFieldSet()->GetFieldInfo().GetFieldOffset().Uint32Value() ==
+                  offset;
+            });
+        if (same_field != last_stores.end()) {
+          overwritten_stores.push_back(*same_field);
+          *same_field = instruction;
+        } else {
+          last_stores.push_back(instruction);
+        }
+      }
+    }
+    DCHECK_EQ(num_hot_stores, last_stores.size() + overwritten_stores.size());
+
+    HInstruction* cursor = cold_block->GetFirstInstruction();
+    allocation->MoveBefore(cursor);
+    for (HInstruction* store : last_stores) {
+      store->MoveBefore(cursor);
+    }
+    for (HInstruction* store : overwritten_stores) {
+      store->GetBlock()->RemoveInstruction(store);
+    }
+    ArenaVector<std::pair<HEnvironment*, size_t>> hot_env_uses(
+        GetGraph()->GetArena()->Adapter(kArenaAllocLSE));
+    for (const HUseListNode<HEnvironment*>& use : allocation->GetEnvUses()) {
+      if (!cold_block->Dominates(use.GetUser()->GetHolder()->GetBlock())) {
+        hot_env_uses.push_back(std::make_pair(use.GetUser(), use.GetIndex()));
+      }
+    }
+    for (const std::pair<HEnvironment*, size_t>& env_use : hot_env_uses) {
+      env_use.first->RemoveAsUserOfInput(env_use.second);
+      env_use.first->SetRawEnvAt(env_use.second, nullptr);
+    }
+  }
+
   // `instruction` is being removed. Try to see if the null check on it
   // can be removed. This can happen if the same value is set in two branches
   // but not in dominators. Such as:
@@ -726,13 +1013,14 @@ class LSEVisitor : public HGraphVisitor {
       heap_values[idx] = constant;
       return;
     }
-    if (heap_value != kUnknownHeapValue && heap_value->IsInstanceFieldSet()) {
+    if (heap_value != kUnknownHeapValue &&
+        (heap_value->IsInstanceFieldSet() || heap_value->IsArraySet())) {
       HInstruction* store = heap_value;
       // This load must be from a singleton since it's from the same field
       // that a "removed" store puts the value. That store must be to a singleton's field.
       DCHECK(ref_info->IsSingleton());
       // Get the real heap value of the store.
-      heap_value = store->InputAt(1);
+      heap_value = GetActualValue(store);
     }
     if (heap_value == kUnknownHeapValue) {
       // Load isn't eliminated. Put the load as the value into the HeapLocation.
@@ -788,9 +1076,11 @@ class LSEVisitor : public HGraphVisitor {
     if (Equal(heap_value, value)) {
       // Store into the heap location with the same value.
       same_value = true;
-    } else if (index != nullptr) {
+    } else if (index != nullptr && ref_info->HasIndexAliasing()) {
       // For array element, don't eliminate stores since it can be easily aliased
       // with non-constant index.
+    } else if (instruction->IsArraySet() && instruction->AsArraySet()->NeedsTypeCheck()) {
+      // The store may throw ArrayStoreException.
     } else if (!heap_location_collector_.MayDeoptimize() &&
                ref_info->IsSingletonAndNotReturned()) {
       // Store into a field of a singleton that's not returned. The value cannot be
@@ -799,9 +1089,9 @@ class LSEVisitor : public HGraphVisitor {
       // merging or loop side effects. Stores whose values are killed due to merging/loop side
       // effects later will be removed from possibly_removed_stores_ when that is detected.
       possibly_redundant = true;
-      HNewInstance* new_instance = ref_info->GetReference()->AsNewInstance();
-      DCHECK(new_instance != nullptr);
-      if (new_instance->IsFinalizable()) {
+      HInstruction* reference = ref_info->GetReference();
+      DCHECK(reference->IsNewInstance() || reference->IsNewArray());
+      if (reference->IsNewInstance() && reference->AsNewInstance()->IsFinalizable()) {
         // Finalizable objects escape globally. Need to keep the store.
         possibly_redundant = false;
       } else {
@@ -830,7 +1120,7 @@ class LSEVisitor : public HGraphVisitor {
 
     if (!same_value) {
       if (possibly_redundant) {
-        DCHECK(instruction->IsInstanceFieldSet());
+        DCHECK(instruction->IsInstanceFieldSet() || instruction->IsArraySet());
         // Put the store as the heap value. If the value is loaded from heap
         // by a load later, this store isn't really redundant.
         heap_values[idx] = instruction;
@@ -972,8 +1262,13 @@ class LSEVisitor : public HGraphVisitor {
     if (!heap_location_collector_.MayDeoptimize() &&
         ref_info->IsSingletonAndNotReturned() &&
         !new_instance->IsFinalizable() &&
-        !new_instance->CanThrow()) {
-      // TODO: add new_instance to singleton_new_instances_ and enable allocation elimination.
+        !new_instance->NeedsChecks()) {
+      singleton_new_instances_.push_back(new_instance);
+    } else if (!heap_location_collector_.MayDeoptimize() &&
+               !ref_info->IsSingleton() &&
+               !new_instance->IsFinalizable() &&
+               !new_instance->NeedsChecks()) {
+      escaping_new_instances_.push_back(new_instance);
     }
     ArenaVector<HInstruction*>& heap_values =
         heap_values_for_[new_instance->GetBlock()->GetBlockId()];
@@ -988,6 +1283,34 @@ class LSEVisitor : public HGraphVisitor {
     }
   }
 
+  void VisitNewArray(HNewArray* new_array) OVERRIDE {
+    ReferenceInfo* ref_info = heap_location_collector_.FindReferenceInfoOf(new_array);
+    if (ref_info == nullptr) {
+      // new_array isn't used for array accesses. No need to process it.
+      return;
+    }
+    HInstruction* length = new_array->InputAt(0);
+    if (!heap_location_collector_.MayDeoptimize() &&
+        ref_info->IsSingletonAndNotReturned() &&
+        !ref_info->HasIndexAliasing() &&
+        new_array->GetEntrypoint() != kQuickAllocArrayWithAccessCheck &&
+        length->IsIntConstant() &&
+        length->AsIntConstant()->GetValue() >= 0) {
+      // The allocation cannot throw NegativeArraySizeException or IllegalAccessError.
+      singleton_new_arrays_.push_back(new_array);
+    }
+    ArenaVector<HInstruction*>& heap_values =
+        heap_values_for_[new_array->GetBlock()->GetBlockId()];
+    for (size_t i = 0; i < heap_values.size(); i++) {
+      HeapLocation* location = heap_location_collector_.GetHeapLocation(i);
+      if (location->GetReferenceInfo()->GetReference() == new_array &&
+          location->IsArrayElement()) {
+        // Array elements are set to default heap values.
+        heap_values[i] = kDefaultHeapValue;
+      }
+    }
+  }
+
   // Find an instruction's substitute if it should be removed.
   // Return the same instruction if it should not be removed.
   HInstruction* FindSubstitute(HInstruction* instruction) {
@@ -1015,7 +1338,21 @@ class LSEVisitor : public HGraphVisitor {
   // found that the store cannot be eliminated.
   ArenaVector<HInstruction*> possibly_removed_stores_;
 
+  // Allocations which may be removed if all their loads and stores are removed.
   ArenaVector<HInstruction*> singleton_new_instances_;
+  ArenaVector<HInstruction*> singleton_new_arrays_;
+
+  // Allocations which escape, and may be moved to the cold paths on which they escape.
+  ArenaVector<HInstruction*> escaping_new_instances_;
+
+  // Phis created to merge the heap values of a singleton's location in blocks
+  // with several predecessors, and the index of the merged heap location.
+  ArenaVector<HPhi*> merged_value_phis_;
+  ArenaVector<size_t> merged_value_locations_;
+
+  // Whether each block is cold, see IsCold(). Computed on the first query.
+  ArenaBitVector cold_blocks_;
+  bool cold_blocks_computed_;
 
   DISALLOW_COPY_AND_ASSIGN(LSEVisitor);
 };
@@ -0,0 +1,1127 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loop_optimization.h"
+
+#include "arch/instruction_set_features.h"
+#include "arch/x86_64/instruction_set_features_x86_64.h"
+#include "driver/compiler_driver.h"
+
+namespace art {
+
+// Maximum number of vector operations in a vector loop body. Keeping this number
+// small keeps all vector values in registers, since vector values cannot be
+// spilled. This is not a guarantee: the register allocator DCHECKs it.
+static constexpr size_t kMaxVectorOperations = 10;
+
+// Maximum number of instructions in an unrolled loop body, and maximum unrolling
+// factor. The factor is the largest power of two for which the body fits the budget.
+static constexpr size_t kMaxUnrolledInstructions = 40;
+static constexpr size_t kMaxUnrollFactor = 4;
+
+// Maximum number of instructions in a loop body of which the first iteration is peeled.
+static constexpr size_t kMaxPeeledInstructions = 20;
+
+// Returns true if the given instruction is an int constant with the given value.
+static bool IsIntConstant(HInstruction* instruction, int32_t value) {
+  return instruction->IsIntConstant() && instruction->AsIntConstant()->GetValue() == value;
+}
+
+// Returns true if the given instruction is the Math.min(int, int) or Math.max(int, int)
+// intrinsic, and sets the corresponding reduction kind.
+static bool IsIntMinMax(HInstruction* instruction,
+                        /*out*/ HVecReduce::ReductionKind* kind = nullptr) {
+  if (instruction->IsInvokeStaticOrDirect()) {
+    switch (instruction->AsInvokeStaticOrDirect()->GetIntrinsic()) {
+      case Intrinsics::kMathMinIntInt:
+        if (kind != nullptr) {
+          *kind = HVecReduce::kMin;
+        }
+        return true;
+      case Intrinsics::kMathMaxIntInt:
+        if (kind != nullptr) {
+          *kind = HVecReduce::kMax;
+        }
+        return true;
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
+// Returns true for the integral types that can be packed in vector lanes.
+static bool IsPackableType(Primitive::Type type) {
+  switch (type) {
+    case Primitive::kPrimByte:
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+    case Primitive::kPrimInt:
+    case Primitive::kPrimLong:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if a scalar of the given type can be used in lanes of the given packed type,
+// i.e. it has the same precision, or (for narrow lanes) only its lower bits are used.
+static bool IsCompatibleScalar(Primitive::Type type, Primitive::Type packed_type) {
+  switch (packed_type) {
+    case Primitive::kPrimByte:
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+      return type == Primitive::kPrimInt || type == Primitive::kPrimByte ||
+             type == Primitive::kPrimChar || type == Primitive::kPrimShort;
+    case Primitive::kPrimInt:
+    case Primitive::kPrimLong:
+      return type == packed_type;
+    default:
+      return false;
+  }
+}
+
+// Returns true if the given instruction can be copied by the peeling and unrolling
+// transformations, which is true for arithmetic, array accesses and the checks
+// that guard them.
+static bool IsCloneable(HInstruction* instruction) {
+  switch (instruction->GetKind()) {
+    case HInstruction::kAdd:
+    case HInstruction::kSub:
+    case HInstruction::kMul:
+    case HInstruction::kDiv:
+    case HInstruction::kRem:
+    case HInstruction::kAnd:
+    case HInstruction::kOr:
+    case HInstruction::kXor:
+    case HInstruction::kShl:
+    case HInstruction::kShr:
+    case HInstruction::kUShr:
+    case HInstruction::kNeg:
+    case HInstruction::kNot:
+    case HInstruction::kTypeConversion:
+    case HInstruction::kArrayGet:
+    case HInstruction::kArraySet:
+    case HInstruction::kArrayLength:
+    case HInstruction::kNullCheck:
+    case HInstruction::kBoundsCheck:
+    case HInstruction::kDivZeroCheck:
+      return true;
+    default:
+      return false;
+  }
+}
+
+//
+// Class methods.
+//
+
+HLoopOptimization::HLoopOptimization(HGraph* graph,
+                                     const CompilerDriver* compiler_driver,
+                                     HInductionVarAnalysis* induction_analysis,
+                                     OptimizingCompilerStats* stats)
+    : HOptimization(graph, kLoopOptimizationPassName, stats),
+      compiler_driver_(compiler_driver),
+      induction_range_(induction_analysis),
+      induction_(nullptr),
+      vector_induction_(nullptr),
+      vector_length_(0),
+      vector_operations_(0),
+      reductions_(graph->GetArena()->Adapter(kArenaAllocLoopOptimization)),
+      array_refs_(graph->GetArena()->Adapter(kArenaAllocLoopOptimization)),
+      packed_types_(std::less<HInstruction*>(),
+                    graph->GetArena()->Adapter(kArenaAllocLoopOptimization)),
+      vector_map_(std::less<HInstruction*>(),
+                  graph->GetArena()->Adapter(kArenaAllocLoopOptimization)),
+      clone_map_(std::less<HInstruction*>(),
+                 graph->GetArena()->Adapter(kArenaAllocLoopOptimization)) {}
+
+void HLoopOptimization::Run() {
+  // Skip if the graph contains constructs that complicate the transformation
+  // (debuggability, exception handling, irreducible loops, OSR entries).
+  if (graph_->IsDebuggable() ||
+      graph_->HasTryCatch() ||
+      graph_->HasIrreducibleLoops() ||
+      graph_->IsCompilingOsr()) {
+    return;
+  }
+
+  // Only targets that support SIMD code generation are considered for vectorization.
+  // Peeling and unrolling are restricted to the targets they were tested on.
+  bool can_vectorize = false;
+  bool can_unroll = false;
+  switch (graph_->GetInstructionSet()) {
+    case kArm64:
+      can_vectorize = true;
+      can_unroll = true;
+      break;
+    case kX86_64:
+      // Packed int multiplication and min/max require SSE4.1.
+      can_vectorize = compiler_driver_ != nullptr &&
+          compiler_driver_->GetInstructionSetFeatures()
+              ->AsX86_64InstructionSetFeatures()->HasSSE4_1();
+      can_unroll = true;
+      break;
+    default:
+      break;
+  }
+  if (!can_vectorize && !can_unroll) {
+    return;
+  }
+
+  // Collect all loops first, since vectorization and unrolling add new loops to the graph.
+  ArenaVector<HLoopInformation*> loops(graph_->GetArena()->Adapter(kArenaAllocLoopOptimization));
+  for (HPostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    if (block->IsLoopHeader()) {
+      loops.push_back(block->GetLoopInformation());
+    }
+  }
+  for (HLoopInformation* loop : loops) {
+    if (can_vectorize && TryVectorizeLoop(loop)) {
+      MaybeRecordStat(kLoopVectorized);
+    } else if (can_unroll) {
+      TryPeelAndUnrollLoop(loop);
+    }
+  }
+}
+
+//
+// Loop analysis.
+//
+
+bool HLoopOptimization::IsUnitIncrement(HPhi* phi, HInstruction* update) const {
+  // Matches update = phi + 1, in int precision.
+  if (phi->GetType() == Primitive::kPrimInt &&
+      update->IsAdd() &&
+      update->GetType() == Primitive::kPrimInt) {
+    HInstruction* a = update->InputAt(0);
+    HInstruction* b = update->InputAt(1);
+    return (a == phi && IsIntConstant(b, 1)) || (b == phi && IsIntConstant(a, 1));
+  }
+  return false;
+}
+
+bool HLoopOptimization::IsReduction(HLoopInformation* loop, HPhi* phi, HBasicBlock* body) {
+  HInstruction* update = phi->InputAt(1);
+  if (update->GetBlock() != body || !update->HasOnlyOneNonEnvironmentUse()) {
+    return false;
+  }
+  // Inside the loop, the phi may only be used by its update.
+  for (const HUseListNode<HInstruction*>& use : phi->GetUses()) {
+    HInstruction* user = use.GetUser();
+    if (user != update && loop->Contains(*user->GetBlock())) {
+      return false;
+    }
+  }
+  // Matches update = phi + x (sum), or update = min/max(phi, x) (min/max).
+  HVecReduce::ReductionKind kind = HVecReduce::kSum;
+  if (update->IsAdd()) {
+    if (phi->GetType() != Primitive::kPrimInt && phi->GetType() != Primitive::kPrimLong) {
+      return false;
+    }
+  } else if (!IsIntMinMax(update, &kind)) {
+    return false;
+  }
+  HInstruction* a = update->InputAt(0);
+  HInstruction* b = update->InputAt(1);
+  if (a == phi && b != phi) {
+    reductions_.push_back(Reduction(phi, update, b, kind));
+    return true;
+  } else if (b == phi && a != phi) {
+    reductions_.push_back(Reduction(phi, update, a, kind));
+    return true;
+  }
+  return false;
+}
+
+bool HLoopOptimization::IsReductionUpdate(HInstruction* instruction) const {
+  for (const Reduction& reduction : reductions_) {
+    if (reduction.update == instruction) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HLoopOptimization::IsUnitIndex(HInstruction* index, /*out*/ HInstruction** offset) const {
+  // Matches index = i, or index = i + x, for loop invariant x.
+  if (index == induction_) {
+    *offset = nullptr;
+    return true;
+  } else if (index->IsAdd() && index->GetType() == Primitive::kPrimInt) {
+    HLoopInformation* loop = induction_->GetBlock()->GetLoopInformation();
+    HInstruction* a = index->InputAt(0);
+    HInstruction* b = index->InputAt(1);
+    if (a == induction_ && loop->IsDefinedOutOfTheLoop(b)) {
+      *offset = b;
+      return true;
+    } else if (b == induction_ && loop->IsDefinedOutOfTheLoop(a)) {
+      *offset = a;
+      return true;
+    }
+  }
+  return false;
+}
+
+HBasicBlock* HLoopOptimization::GetSimpleLoopBody(HLoopInformation* loop) const {
+  // Only inner loops consisting of a header and a single body block,
+  // which is the back edge, are considered.
+  HBasicBlock* header = loop->GetHeader();
+  if (loop->IsIrreducible() ||
+      loop->NumberOfBackEdges() != 1 ||
+      loop->GetBlocks().NumSetBits() != 2 ||
+      header->GetSuccessors().size() != 2) {
+    return nullptr;
+  }
+  HBasicBlock* body = loop->GetBackEdges()[0];
+  if (body == header ||
+      body->GetPredecessors().size() != 1 ||
+      body->GetSinglePredecessor() != header) {
+    return nullptr;
+  }
+
+  // The header only consists of phis, the suspend check, the exit condition and the if.
+  HInstruction* suspend_check = header->GetFirstInstruction();
+  HInstruction* if_instruction = header->GetLastInstruction();
+  if (suspend_check != loop->GetSuspendCheck() ||
+      !if_instruction->IsIf() ||
+      suspend_check->GetNext() != if_instruction->InputAt(0) ||
+      if_instruction->InputAt(0)->GetNext() != if_instruction ||
+      !if_instruction->InputAt(0)->HasOnlyOneNonEnvironmentUse()) {
+    return nullptr;
+  }
+  return body;
+}
+
+//
+// Vectorization analysis.
+//
+
+bool HLoopOptimization::TryVectorizeLoop(HLoopInformation* loop) {
+  // Reset phase-local state.
+  induction_ = nullptr;
+  vector_induction_ = nullptr;
+  vector_length_ = 0;
+  vector_operations_ = 0;
+  reductions_.clear();
+  array_refs_.clear();
+  packed_types_.clear();
+  vector_map_.clear();
+
+  HBasicBlock* header = loop->GetHeader();
+  HBasicBlock* body = GetSimpleLoopBody(loop);
+  if (body == nullptr) {
+    return false;
+  }
+
+  // All phis are either the unit stride basic induction or a reduction.
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* phi = it.Current()->AsPhi();
+    if (phi->InputCount() != 2) {
+      return false;
+    } else if (induction_ == nullptr &&
+               phi->InputAt(1)->GetBlock() == body &&
+               IsUnitIncrement(phi, phi->InputAt(1))) {
+      induction_ = phi;
+    } else if (!IsReduction(loop, phi, body)) {
+      return false;
+    }
+  }
+  if (induction_ == nullptr) {
+    return false;
+  }
+
+  // Analyze the body and the array references.
+  HInstruction* runtime_base1 = nullptr;
+  HInstruction* runtime_base2 = nullptr;
+  if (!CanVectorize(body) || !CheckArrayReferences(&runtime_base1, &runtime_base2)) {
+    return false;
+  }
+
+  return Vectorize(loop, body, runtime_base1, runtime_base2);
+}
+
+bool HLoopOptimization::CanVectorize(HBasicBlock* body) {
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (instruction->IsGoto()) {
+      continue;
+    } else if (instruction->IsArraySet() || IsReductionUpdate(instruction)) {
+      // Definitions must be vectorized.
+      if (!VectorizeDef(instruction)) {
+        return false;
+      }
+    } else if (instruction->GetSideEffects().DoesAnyWrite() ||
+               instruction->CanThrow() ||
+               instruction->IsControlFlow() ||
+               instruction->IsSuspendCheck() ||
+               (instruction->NeedsEnvironment() && !IsIntMinMax(instruction))) {
+      // Any other instruction must be free of side effects, so that it can simply be
+      // omitted from the vector loop body if it is not used by a definition.
+      return false;
+    }
+  }
+  // Require at least one definition.
+  return vector_length_ != 0;
+}
+
+bool HLoopOptimization::VectorizeDef(HInstruction* instruction) {
+  uint64_t restrictions = kNone;
+  if (instruction->IsArraySet()) {
+    // Array store a[i + x] = value.
+    HLoopInformation* loop = induction_->GetBlock()->GetLoopInformation();
+    HInstruction* base = instruction->InputAt(0);
+    HInstruction* index = instruction->InputAt(1);
+    HInstruction* value = instruction->InputAt(2);
+    HInstruction* offset = nullptr;
+    Primitive::Type type = instruction->AsArraySet()->GetComponentType();
+    if (loop->IsDefinedOutOfTheLoop(base) &&
+        IsUnitIndex(index, &offset) &&
+        TrySetVectorType(type, &restrictions) &&
+        TrySetPackedType(instruction, type) &&
+        VectorizeUse(value, type, restrictions)) {
+      array_refs_.push_back(ArrayReference(base, offset, type, /* lhs */ true));
+      return true;
+    }
+    return false;
+  }
+  // Reduction update phi = phi + x, or phi = min/max(phi, x).
+  for (const Reduction& reduction : reductions_) {
+    if (reduction.update == instruction) {
+      Primitive::Type type = reduction.phi->GetType();
+      return TrySetVectorType(type, &restrictions) &&
+             (reduction.kind == HVecReduce::kSum || (restrictions & kNoMinMax) == 0) &&
+             TrySetPackedType(instruction, type) &&
+             VectorizeUse(reduction.operand, type, restrictions);
+    }
+  }
+  return false;
+}
+
+bool HLoopOptimization::VectorizeUse(HInstruction* instruction,
+                                     Primitive::Type packed_type,
+                                     uint64_t restrictions) {
+  HLoopInformation* loop = induction_->GetBlock()->GetLoopInformation();
+  if (loop->IsDefinedOutOfTheLoop(instruction)) {
+    // Loop invariant, replicated into a vector.
+    return IsCompatibleScalar(instruction->GetType(), packed_type) &&
+           TrySetPackedType(instruction, packed_type);
+  } else if (instruction->GetBlock() == loop->GetHeader()) {
+    // Loop phis (vectorizing the basic induction itself is not supported).
+    return false;
+  }
+  switch (instruction->GetKind()) {
+    case HInstruction::kArrayGet: {
+      // Array load a[i + x], possibly widening narrower elements into int lanes.
+      HInstruction* base = instruction->InputAt(0);
+      HInstruction* index = instruction->InputAt(1);
+      HInstruction* offset = nullptr;
+      Primitive::Type type = instruction->GetType();
+      bool same_size = IsPackableType(type) &&
+          Primitive::ComponentSize(type) == Primitive::ComponentSize(packed_type);
+      bool widening = packed_type == Primitive::kPrimInt &&
+          (type == Primitive::kPrimByte ||
+           type == Primitive::kPrimChar ||
+           type == Primitive::kPrimShort);
+      if ((same_size || widening) &&
+          loop->IsDefinedOutOfTheLoop(base) &&
+          IsUnitIndex(index, &offset) &&
+          TrySetPackedType(instruction, packed_type)) {
+        array_refs_.push_back(ArrayReference(base, offset, type, /* lhs */ false));
+        return true;
+      }
+      return false;
+    }
+    case HInstruction::kTypeConversion: {
+      // Narrowing of an int into lanes of the same size as the result is a no-op,
+      // since the lanes only keep the lower bits anyway.
+      HTypeConversion* conversion = instruction->AsTypeConversion();
+      Primitive::Type from = conversion->GetInputType();
+      Primitive::Type to = conversion->GetResultType();
+      if (from == Primitive::kPrimInt &&
+          packed_type != Primitive::kPrimInt &&
+          packed_type != Primitive::kPrimLong &&
+          IsCompatibleScalar(to, packed_type) &&
+          Primitive::ComponentSize(to) == Primitive::ComponentSize(packed_type)) {
+        return TrySetPackedType(instruction, packed_type) &&
+               VectorizeUse(conversion->GetInput(), packed_type, restrictions);
+      }
+      return false;
+    }
+    case HInstruction::kNeg:
+    case HInstruction::kNot:
+      return IsCompatibleScalar(instruction->GetType(), packed_type) &&
+             TrySetPackedType(instruction, packed_type) &&
+             VectorizeUse(instruction->InputAt(0), packed_type, restrictions);
+    case HInstruction::kMul:
+      if ((restrictions & kNoMul) != 0) {
+        return false;
+      }
+      FALLTHROUGH_INTENDED;
+    case HInstruction::kAdd:
+    case HInstruction::kSub:
+    case HInstruction::kAnd:
+    case HInstruction::kOr:
+    case HInstruction::kXor:
+      return IsCompatibleScalar(instruction->GetType(), packed_type) &&
+             TrySetPackedType(instruction, packed_type) &&
+             VectorizeUse(instruction->InputAt(0), packed_type, restrictions) &&
+             VectorizeUse(instruction->InputAt(1), packed_type, restrictions);
+    case HInstruction::kInvokeStaticOrDirect:
+      // Math.min/max(int, int) only operates on full int lanes.
+      return IsIntMinMax(instruction) &&
+             (restrictions & kNoMinMax) == 0 &&
+             packed_type == Primitive::kPrimInt &&
+             TrySetPackedType(instruction, packed_type) &&
+             VectorizeUse(instruction->InputAt(0), packed_type, restrictions) &&
+             VectorizeUse(instruction->InputAt(1), packed_type, restrictions);
+    default:
+      return false;
+  }
+}
+
+bool HLoopOptimization::TrySetVectorType(Primitive::Type type,
+                                         /*out*/ uint64_t* restrictions) {
+  switch (graph_->GetInstructionSet()) {
+    case kArm64:
+      // Allow vectorization for all ARM64 devices, because Android assumes that
+      // ARMv8 AArch64 always supports advanced SIMD.
+      switch (type) {
+        case Primitive::kPrimByte:
+        case Primitive::kPrimChar:
+        case Primitive::kPrimShort:
+          *restrictions |= kNoMinMax;
+          return TrySetVectorLength(type);
+        case Primitive::kPrimInt:
+          return TrySetVectorLength(type);
+        case Primitive::kPrimLong:
+          *restrictions |= kNoMul | kNoMinMax;
+          return TrySetVectorLength(type);
+        default:
+          return false;
+      }
+    case kX86_64:
+      // Allow vectorization for devices with SSE4.1 (verified in Run()).
+      switch (type) {
+        case Primitive::kPrimByte:
+          *restrictions |= kNoMul | kNoMinMax;
+          return TrySetVectorLength(type);
+        case Primitive::kPrimChar:
+        case Primitive::kPrimShort:
+          *restrictions |= kNoMinMax;
+          return TrySetVectorLength(type);
+        case Primitive::kPrimInt:
+          return TrySetVectorLength(type);
+        case Primitive::kPrimLong:
+          *restrictions |= kNoMul | kNoMinMax;
+          return TrySetVectorLength(type);
+        default:
+          return false;
+      }
+    default:
+      return false;
+  }
+}
+
+bool HLoopOptimization::TrySetVectorLength(Primitive::Type type) {
+  // All vector operations in the loop body must agree on the vector length.
+  size_t length = HVecOperation::VectorLengthOf(type);
+  if (vector_length_ == 0) {
+    vector_length_ = length;
+  }
+  return vector_length_ == length;
+}
+
+bool HLoopOptimization::TrySetPackedType(HInstruction* instruction, Primitive::Type packed_type) {
+  auto it = packed_types_.find(instruction);
+  if (it != packed_types_.end()) {
+    // Already vectorized: the lanes must agree in size.
+    return Primitive::ComponentSize(it->second) == Primitive::ComponentSize(packed_type);
+  }
+  packed_types_.Put(instruction, packed_type);
+  return ++vector_operations_ <= kMaxVectorOperations;
+}
+
+bool HLoopOptimization::CheckArrayReferences(/*out*/ HInstruction** runtime_base1,
+                                             /*out*/ HInstruction** runtime_base2) const {
+  for (size_t i = 0; i < array_refs_.size(); i++) {
+    for (size_t j = i + 1; j < array_refs_.size(); j++) {
+      const ArrayReference& r1 = array_refs_[i];
+      const ArrayReference& r2 = array_refs_[j];
+      if ((!r1.lhs && !r2.lhs) || r1.type != r2.type || r1.offset == r2.offset) {
+        // Reads only, arrays of different types, or references to the same relative
+        // element: vector operations preserve the original order of all accesses.
+        continue;
+      } else if (r1.base == r2.base) {
+        // Loop-carried dependence on the same array.
+        return false;
+      } else if (*runtime_base1 == nullptr) {
+        // Different arrays are only independent if they are not the same at runtime.
+        *runtime_base1 = r1.base;
+        *runtime_base2 = r2.base;
+      } else if (!(*runtime_base1 == r1.base && *runtime_base2 == r2.base) &&
+                 !(*runtime_base1 == r2.base && *runtime_base2 == r1.base)) {
+        // At most one runtime test is generated.
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//
+// Vectorization synthesis.
+//
+
+bool HLoopOptimization::Vectorize(HLoopInformation* loop,
+                                  HBasicBlock* body,
+                                  HInstruction* runtime_base1,
+                                  HInstruction* runtime_base2) {
+  ArenaAllocator* arena = graph_->GetArena();
+  HBasicBlock* header = loop->GetHeader();
+  HBasicBlock* preheader = loop->GetPreHeader();
+
+  // Generate the vector trip count in the preheader (interpreted as unsigned):
+  //   stc = <trip count>
+  //   vtc = stc & -VL                  (rounded down to a multiple of VL)
+  //   vtc = (a != b) ? vtc : 0         (if a runtime test is needed)
+  HInstruction* stc = induction_range_.GenerateTripCount(loop, graph_, preheader);
+  if (stc == nullptr) {
+    return false;
+  }
+  int32_t mask = -static_cast<int32_t>(vector_length_);
+  HInstruction* vtc = nullptr;
+  if (stc->IsIntConstant()) {
+    int32_t value = stc->AsIntConstant()->GetValue() & mask;
+    if (value == 0) {
+      return false;  // not worthwhile
+    }
+    vtc = graph_->GetIntConstant(value);
+  } else {
+    vtc = Insert(preheader,
+                 new (arena) HAnd(Primitive::kPrimInt, stc, graph_->GetIntConstant(mask)));
+  }
+  if (runtime_base1 != nullptr) {
+    HInstruction* test = Insert(preheader, new (arena) HNotEqual(runtime_base1, runtime_base2));
+    vtc = Insert(preheader, new (arena) HSelect(test, vtc, graph_->GetIntConstant(0), kNoDexPc));
+  }
+  HInstruction* lo = induction_->InputAt(0);
+  HInstruction* hi = Insert(preheader, new (arena) HAdd(Primitive::kPrimInt, lo, vtc));
+
+  // Generate the vector loop in front of the original loop:
+  //   for (j = lo; j < hi; j += VL) { <vector body> }
+  HBasicBlock* vector_header = graph_->TransformLoopForVectorization(header);
+  HBasicBlock* vector_body = vector_header->GetSuccessors()[0];
+  vector_induction_ = induction_->InputAt(0);
+  DCHECK(vector_induction_->IsPhi() && vector_induction_->GetBlock() == vector_header);
+  HInstruction* condition = new (arena) HLessThan(vector_induction_, hi);
+  vector_header->AddInstruction(condition);
+  vector_header->AddInstruction(new (arena) HIf(condition));
+
+  // Generate the vector body in the original program order, which preserves
+  // the order of all memory accesses.
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (packed_types_.find(instruction) != packed_types_.end()) {
+      GenerateVecOperation(instruction, vector_body);
+    }
+  }
+
+  // Complete the phis of the vector loop.
+  HInstruction* next = Insert(vector_body, new (arena) HAdd(
+      Primitive::kPrimInt, vector_induction_, graph_->GetIntConstant(vector_length_)));
+  vector_induction_->AsPhi()->AddInput(next);
+  for (const Reduction& reduction : reductions_) {
+    reduction.phi->InputAt(0)->AsPhi()->AddInput(vector_map_.Get(reduction.update));
+  }
+
+  graph_->SetHasSIMD(true);
+  return true;
+}
+
+HInstruction* HLoopOptimization::GenerateVecOperand(HInstruction* instruction,
+                                                    HBasicBlock* block) {
+  auto it = vector_map_.find(instruction);
+  if (it != vector_map_.end()) {
+    return it->second;
+  }
+  // Operands in the loop body precede their uses, so this must be a loop invariant,
+  // which is replicated inside the vector loop body to keep it out of the header.
+  DCHECK(induction_->GetBlock()->GetLoopInformation()->IsDefinedOutOfTheLoop(instruction));
+  HInstruction* vector = Insert(block, new (graph_->GetArena()) HVecReplicateScalar(
+      graph_->GetArena(), instruction, packed_types_.Get(instruction), vector_length_));
+  vector_map_.Put(instruction, vector);
+  return vector;
+}
+
+HInstruction* HLoopOptimization::GenerateVecIndex(HInstruction* index, HBasicBlock* block) {
+  if (index == induction_) {
+    return vector_induction_;
+  }
+  auto it = vector_map_.find(index);
+  if (it != vector_map_.end()) {
+    return it->second;
+  }
+  HInstruction* offset = nullptr;
+  bool is_unit_index = IsUnitIndex(index, &offset);
+  DCHECK(is_unit_index);
+  HInstruction* vector_index = Insert(block, new (graph_->GetArena()) HAdd(
+      Primitive::kPrimInt, vector_induction_, offset));
+  vector_map_.Put(index, vector_index);
+  return vector_index;
+}
+
+void HLoopOptimization::GenerateVecOperation(HInstruction* instruction, HBasicBlock* block) {
+  ArenaAllocator* arena = graph_->GetArena();
+  Primitive::Type type = packed_types_.Get(instruction);
+  size_t vl = vector_length_;
+  HInstruction* vector = nullptr;
+  // Reductions.
+  for (const Reduction& reduction : reductions_) {
+    if (reduction.update == instruction) {
+      vector = new (arena) HVecReduce(arena,
+                                      GenerateVecOperand(reduction.operand, block),
+                                      reduction.phi->InputAt(0),  // counterpart in vector loop
+                                      type,
+                                      vl,
+                                      reduction.kind);
+      vector_map_.Put(instruction, Insert(block, vector));
+      return;
+    }
+  }
+  // Other operations.
+  switch (instruction->GetKind()) {
+    case HInstruction::kArrayGet:
+      vector = new (arena) HVecLoad(arena,
+                                    instruction->InputAt(0),
+                                    GenerateVecIndex(instruction->InputAt(1), block),
+                                    type,
+                                    instruction->GetType(),
+                                    vl);
+      break;
+    case HInstruction::kArraySet:
+      vector = new (arena) HVecStore(arena,
+                                     instruction->InputAt(0),
+                                     GenerateVecIndex(instruction->InputAt(1), block),
+                                     GenerateVecOperand(instruction->InputAt(2), block),
+                                     type,
+                                     vl);
+      break;
+    case HInstruction::kTypeConversion:
+      // Lanes keep the lower bits only, so the narrowing is implicit.
+      vector_map_.Put(instruction, GenerateVecOperand(instruction->InputAt(0), block));
+      return;
+    case HInstruction::kNeg:
+      vector = new (arena) HVecNeg(
+          arena, GenerateVecOperand(instruction->InputAt(0), block), type, vl);
+      break;
+    case HInstruction::kNot:
+      vector = new (arena) HVecNot(
+          arena, GenerateVecOperand(instruction->InputAt(0), block), type, vl);
+      break;
+    case HInstruction::kInvokeStaticOrDirect: {
+      HInstruction* left = GenerateVecOperand(instruction->InputAt(0), block);
+      HInstruction* right = GenerateVecOperand(instruction->InputAt(1), block);
+      HVecReduce::ReductionKind kind = HVecReduce::kSum;
+      bool is_min_max = IsIntMinMax(instruction, &kind);
+      DCHECK(is_min_max);
+      if (kind == HVecReduce::kMin) {
+        vector = new (arena) HVecMin(arena, left, right, type, vl);
+      } else {
+        vector = new (arena) HVecMax(arena, left, right, type, vl);
+      }
+      break;
+    }
+    default: {
+      HInstruction* left = GenerateVecOperand(instruction->InputAt(0), block);
+      HInstruction* right = GenerateVecOperand(instruction->InputAt(1), block);
+      switch (instruction->GetKind()) {
+        case HInstruction::kAdd:
+          vector = new (arena) HVecAdd(arena, left, right, type, vl);
+          break;
+        case HInstruction::kSub:
+          vector = new (arena) HVecSub(arena, left, right, type, vl);
+          break;
+        case HInstruction::kMul:
+          vector = new (arena) HVecMul(arena, left, right, type, vl);
+          break;
+        case HInstruction::kAnd:
+          vector = new (arena) HVecAnd(arena, left, right, type, vl);
+          break;
+        case HInstruction::kOr:
+          vector = new (arena) HVecOr(arena, left, right, type, vl);
+          break;
+        case HInstruction::kXor:
+          vector = new (arena) HVecXor(arena, left, right, type, vl);
+          break;
+        default:
+          LOG(FATAL) << "Unsupported SIMD operation " << instruction->DebugName();
+          UNREACHABLE();
+      }
+      break;
+    }
+  }
+  vector_map_.Put(instruction, Insert(block, vector));
+}
+
+HInstruction* HLoopOptimization::Insert(HBasicBlock* block, HInstruction* instruction) {
+  DCHECK(block->GetLastInstruction() != nullptr);
+  block->InsertInstructionBefore(instruction, block->GetLastInstruction());
+  return instruction;
+}
+
+//
+// Peeling and unrolling.
+//
+
+void HLoopOptimization::TryPeelAndUnrollLoop(HLoopInformation* loop) {
+  // Reset phase-local state.
+  induction_ = nullptr;
+  clone_map_.clear();
+
+  HBasicBlock* header = loop->GetHeader();
+  HBasicBlock* body = GetSimpleLoopBody(loop);
+  if (body == nullptr) {
+    return;
+  }
+
+  // Any phi is allowed, as long as one of them is the unit stride basic induction.
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* phi = it.Current()->AsPhi();
+    if (phi->InputCount() != 2) {
+      return;
+    } else if (induction_ == nullptr &&
+               phi->InputAt(1)->GetBlock() == body &&
+               IsUnitIncrement(phi, phi->InputAt(1))) {
+      induction_ = phi;
+    }
+  }
+  size_t body_size = 0;
+  if (induction_ == nullptr || !CanCloneBody(loop, body, &body_size)) {
+    return;
+  }
+
+  // Peeling is only worthwhile if it removes a loop invariant check from the body.
+  bool peel = false;
+  if (body_size <= kMaxPeeledInstructions) {
+    for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+      if (IsInvariantCheck(loop, it.Current())) {
+        peel = true;
+        break;
+      }
+    }
+  }
+  size_t factor = kMaxUnrollFactor;
+  while (factor > 1 && factor * body_size > kMaxUnrolledInstructions) {
+    factor >>= 1;
+  }
+  if (!peel && factor == 1) {
+    return;
+  }
+
+  // The first iteration can only be peeled without a test in front of it if the loop
+  // is known to be taken, i.e. if the trip count (interpreted as unsigned) is a
+  // non-zero constant.
+  HInstruction* stc = induction_range_.GenerateTripCount(loop, graph_, loop->GetPreHeader());
+  if (stc == nullptr) {
+    return;
+  }
+  if (peel && stc->IsIntConstant() && stc->AsIntConstant()->GetValue() != 0) {
+    PeelFirstIteration(loop, body);
+    stc = graph_->GetIntConstant(stc->AsIntConstant()->GetValue() - 1);
+    MaybeRecordStat(kLoopPeeled);
+  }
+  if (factor > 1 && Unroll(loop, body, stc, factor)) {
+    MaybeRecordStat(kLoopUnrolled);
+  }
+}
+
+bool HLoopOptimization::CanCloneBody(HLoopInformation* loop,
+                                     HBasicBlock* body,
+                                     /*out*/ size_t* body_size) const {
+  // A copy of the body only has access to the values of the phis of the header,
+  // and not to the exit condition.
+  HBasicBlock* header = loop->GetHeader();
+  auto is_available = [header](HInstruction* value) {
+    return value->GetBlock() != header || value->IsPhi();
+  };
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (instruction->IsGoto()) {
+      continue;
+    } else if (!IsCloneable(instruction)) {
+      return false;
+    }
+    for (size_t i = 0, e = instruction->InputCount(); i < e; ++i) {
+      if (!is_available(instruction->InputAt(i))) {
+        return false;
+      }
+    }
+    for (HEnvironment* environment = instruction->GetEnvironment();
+         environment != nullptr;
+         environment = environment->GetParent()) {
+      for (size_t i = 0, e = environment->Size(); i < e; ++i) {
+        HInstruction* value = environment->GetInstructionAt(i);
+        if (value != nullptr && !is_available(value)) {
+          return false;
+        }
+      }
+    }
+    (*body_size)++;
+  }
+  return true;
+}
+
+bool HLoopOptimization::IsInvariantCheck(HLoopInformation* loop,
+                                         HInstruction* instruction) const {
+  if (!instruction->IsNullCheck() &&
+      !instruction->IsBoundsCheck() &&
+      !instruction->IsDivZeroCheck()) {
+    return false;
+  }
+  for (size_t i = 0, e = instruction->InputCount(); i < e; ++i) {
+    if (!loop->IsDefinedOutOfTheLoop(instruction->InputAt(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HLoopOptimization::PeelFirstIteration(HLoopInformation* loop, HBasicBlock* body) {
+  HBasicBlock* header = loop->GetHeader();
+
+  // Generate the first iteration at the end of the preheader, starting from the
+  // initial values of the phis.
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    clone_map_.Overwrite(it.Current(), it.Current()->InputAt(0));
+  }
+  GenerateBodyCopy(header, body, loop->GetPreHeader());
+
+  // The loop continues with the values of the phis after the first iteration.
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* phi = it.Current()->AsPhi();
+    phi->ReplaceInput(clone_map_.Get(phi), 0);
+  }
+
+  // The checks of the first iteration dominate the loop, so the loop invariant
+  // checks of the body always succeed and are replaced by their peeled copies.
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (IsInvariantCheck(loop, instruction)) {
+      instruction->ReplaceWith(clone_map_.Get(instruction));
+      body->RemoveInstruction(instruction);
+    }
+  }
+}
+
+bool HLoopOptimization::Unroll(HLoopInformation* loop,
+                               HBasicBlock* body,
+                               HInstruction* stc,
+                               size_t factor) {
+  ArenaAllocator* arena = graph_->GetArena();
+  HBasicBlock* header = loop->GetHeader();
+  HBasicBlock* preheader = loop->GetPreHeader();
+
+  // Generate the unrolled trip count in the preheader (interpreted as unsigned):
+  //   utc = stc & -UF                  (rounded down to a multiple of UF)
+  int32_t mask = -static_cast<int32_t>(factor);
+  HInstruction* utc = nullptr;
+  if (stc->IsIntConstant()) {
+    int32_t value = stc->AsIntConstant()->GetValue() & mask;
+    if (value == 0) {
+      return false;  // not worthwhile
+    }
+    utc = graph_->GetIntConstant(value);
+  } else {
+    utc = Insert(preheader,
+                 new (arena) HAnd(Primitive::kPrimInt, stc, graph_->GetIntConstant(mask)));
+  }
+  HInstruction* lo = induction_->InputAt(0);
+  HInstruction* hi = Insert(preheader, new (arena) HAdd(Primitive::kPrimInt, lo, utc));
+
+  // Generate the unrolled loop in front of the original loop:
+  //   for (j = lo; j < hi; j += UF) { <body(j)> ... <body(j + UF - 1)> }
+  HBasicBlock* unrolled_header = graph_->TransformLoopForVectorization(header);
+  HBasicBlock* unrolled_body = unrolled_header->GetSuccessors()[0];
+  HInstruction* condition = new (arena) HLessThan(induction_->InputAt(0), hi);
+  unrolled_header->AddInstruction(condition);
+  unrolled_header->AddInstruction(new (arena) HIf(condition));
+
+  // Every copy of the body continues with the values of the phis after the previous
+  // copy, starting from the phis of the unrolled loop, which are the counterparts
+  // of the original phis. The suspend check of the unrolled header is the only one
+  // executed for all copies.
+  clone_map_.clear();
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    clone_map_.Overwrite(it.Current(), it.Current()->InputAt(0));
+  }
+  for (size_t i = 0; i < factor; i++) {
+    GenerateBodyCopy(header, body, unrolled_body);
+  }
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* phi = it.Current()->AsPhi();
+    phi->InputAt(0)->AsPhi()->AddInput(clone_map_.Get(phi));
+  }
+  return true;
+}
+
+void HLoopOptimization::GenerateBodyCopy(HBasicBlock* header,
+                                         HBasicBlock* body,
+                                         HBasicBlock* block) {
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (instruction->IsGoto()) {
+      continue;
+    }
+    HInstruction* clone = Insert(block, CloneInstruction(instruction));
+    if (instruction->HasEnvironment()) {
+      // The environment of the copy refers to the values of the copy.
+      clone->CopyEnvironmentFrom(instruction->GetEnvironment());
+      for (HEnvironment* environment = clone->GetEnvironment();
+           environment != nullptr;
+           environment = environment->GetParent()) {
+        for (size_t i = 0, e = environment->Size(); i < e; ++i) {
+          HInstruction* value = environment->GetInstructionAt(i);
+          if (value == nullptr) {
+            continue;
+          }
+          HInstruction* cloned_value = GetClonedValue(value);
+          if (cloned_value != value) {
+            environment->RemoveAsUserOfInput(i);
+            environment->SetRawEnvAt(i, cloned_value);
+            cloned_value->AddEnvUseAt(environment, i);
+          }
+        }
+      }
+    }
+    clone_map_.Overwrite(instruction, clone);
+  }
+  // Advance all phis at once, since a phi may take the value of another phi.
+  ArenaVector<HInstruction*> next_values(
+      graph_->GetArena()->Adapter(kArenaAllocLoopOptimization));
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    next_values.push_back(GetClonedValue(it.Current()->InputAt(1)));
+  }
+  size_t index = 0;
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    clone_map_.Overwrite(it.Current(), next_values[index++]);
+  }
+}
+
+HInstruction* HLoopOptimization::CloneInstruction(HInstruction* instruction) {
+  ArenaAllocator* arena = graph_->GetArena();
+  Primitive::Type type = instruction->GetType();
+  uint32_t dex_pc = instruction->GetDexPc();
+  HInstruction* a = GetClonedValue(instruction->InputAt(0));
+  HInstruction* b =
+      (instruction->InputCount() > 1) ? GetClonedValue(instruction->InputAt(1)) : nullptr;
+  HInstruction* clone = nullptr;
+  switch (instruction->GetKind()) {
+    case HInstruction::kAdd:
+      clone = new (arena) HAdd(type, a, b, dex_pc);
+      break;
+    case HInstruction::kSub:
+      clone = new (arena) HSub(type, a, b, dex_pc);
+      break;
+    case HInstruction::kMul:
+      clone = new (arena) HMul(type, a, b, dex_pc);
+      break;
+    case HInstruction::kDiv:
+      clone = new (arena) HDiv(type, a, b, dex_pc);
+      break;
+    case HInstruction::kRem:
+      clone = new (arena) HRem(type, a, b, dex_pc);
+      break;
+    case HInstruction::kAnd:
+      clone = new (arena) HAnd(type, a, b, dex_pc);
+      break;
+    case HInstruction::kOr:
+      clone = new (arena) HOr(type, a, b, dex_pc);
+      break;
+    case HInstruction::kXor:
+      clone = new (arena) HXor(type, a, b, dex_pc);
+      break;
+    case HInstruction::kShl:
+      clone = new (arena) HShl(type, a, b, dex_pc);
+      break;
+    case HInstruction::kShr:
+      clone = new (arena) HShr(type, a, b, dex_pc);
+      break;
+    case HInstruction::kUShr:
+      clone = new (arena) HUShr(type, a, b, dex_pc);
+      break;
+    case HInstruction::kNeg:
+      clone = new (arena) HNeg(type, a, dex_pc);
+      break;
+    case HInstruction::kNot:
+      clone = new (arena) HNot(type, a, dex_pc);
+      break;
+    case HInstruction::kTypeConversion:
+      clone = new (arena) HTypeConversion(type, a, dex_pc);
+      break;
+    case HInstruction::kArrayGet:
+      clone = new (arena) HArrayGet(a, b, type, dex_pc, instruction->GetSideEffects());
+      break;
+    case HInstruction::kArraySet: {
+      HArraySet* array_set = instruction->AsArraySet();
+      HArraySet* copy = new (arena) HArraySet(a,
+                                              b,
+                                              GetClonedValue(array_set->GetValue()),
+                                              array_set->GetRawExpectedComponentType(),
+                                              dex_pc,
+                                              array_set->GetSideEffects());
+      if (!array_set->NeedsTypeCheck()) {
+        copy->ClearNeedsTypeCheck();
+      }
+      if (!array_set->GetValueCanBeNull()) {
+        copy->ClearValueCanBeNull();
+      }
+      if (array_set->StaticTypeOfArrayIsObjectArray()) {
+        copy->SetStaticTypeOfArrayIsObjectArray();
+      }
+      clone = copy;
+      break;
+    }
+    case HInstruction::kArrayLength:
+      clone = new (arena) HArrayLength(a, dex_pc);
+      break;
+    case HInstruction::kNullCheck:
+      clone = new (arena) HNullCheck(a, dex_pc);
+      break;
+    case HInstruction::kBoundsCheck:
+      clone = new (arena) HBoundsCheck(a, b, dex_pc);
+      break;
+    case HInstruction::kDivZeroCheck:
+      clone = new (arena) HDivZeroCheck(a, dex_pc);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported clone of " << instruction->DebugName();
+      UNREACHABLE();
+  }
+  if (type == Primitive::kPrimNot) {
+    clone->SetReferenceTypeInfo(instruction->GetReferenceTypeInfo());
+  }
+  return clone;
+}
+
+HInstruction* HLoopOptimization::GetClonedValue(HInstruction* instruction) const {
+  // Values that are not in the map are defined outside the loop.
+  auto it = clone_map_.find(instruction);
+  return (it != clone_map_.end()) ? it->second : instruction;
+}
+
+}  // namespace art
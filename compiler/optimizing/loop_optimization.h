@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_LOOP_OPTIMIZATION_H_
+#define ART_COMPILER_OPTIMIZING_LOOP_OPTIMIZATION_H_
+
+#include "base/arena_containers.h"
+#include "induction_var_range.h"
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+class CompilerDriver;
+
+/**
+ * Loop optimizations. Currently this pass vectorizes simple inner loops: loops
+ * that consist of a header and a single body block, with a unit stride basic
+ * induction and a known trip count. The original loop is preceded by a vector
+ * loop that executes the body on VL elements at a time and is kept as the
+ * cleanup loop for the remaining iterations:
+ *
+ *   for (j = L; j < L + vtc; j += VL) {   // vtc = (trip count) rounded down to VL
+ *     <vector body>
+ *   }
+ *   for (i = j; i < U; i++) {             // original loop
+ *     <scalar body>
+ *   }
+ *
+ * No vector value is live across the vector loop header, which ensures that
+ * vector values never need to be saved at a safepoint or spilled.
+ *
+ * On ARM64 and x86_64, simple inner loops that are not vectorized are unrolled
+ * instead, by a factor chosen to keep the unrolled body within a code size budget. The unrolled loop
+ * precedes the original loop in the same way, and executes a single suspend
+ * check for every group of unrolled iterations:
+ *
+ *   for (j = L; j < L + utc; j += UF) {   // utc = (trip count) rounded down to UF
+ *     <body(j)> ... <body(j + UF - 1)>
+ *   }
+ *   for (i = j; i < U; i++) {             // original loop
+ *     <body(i)>
+ *   }
+ *
+ * When the trip count is known to be non-zero and the body contains loop
+ * invariant checks, which LICM cannot hoist out of the body, the first
+ * iteration is peeled into the preheader beforehand. The peeled checks
+ * dominate the loop, and replace the checks in the loop body.
+ */
+class HLoopOptimization : public HOptimization {
+ public:
+  HLoopOptimization(HGraph* graph,
+                    const CompilerDriver* compiler_driver,
+                    HInductionVarAnalysis* induction_analysis,
+                    OptimizingCompilerStats* stats);
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kLoopOptimizationPassName = "loop_optimization";
+
+ private:
+  /*
+   * Vectorization restrictions, as imposed by the target on a packed type.
+   */
+  enum VectorRestrictions {
+    kNone     = 0,        // no restrictions
+    kNoMul    = 1 << 0,   // no multiplication
+    kNoMinMax = 1 << 1,   // no min/max
+  };
+
+  /*
+   * Array reference in the loop body, defined by an array base, an invariant
+   * offset relative to the loop induction (nullptr denotes zero), the type
+   * of the array elements, and whether the reference is written.
+   */
+  struct ArrayReference {
+    ArrayReference(HInstruction* b, HInstruction* o, Primitive::Type t, bool l)
+        : base(b), offset(o), type(t), lhs(l) {}
+    HInstruction* base;
+    HInstruction* offset;
+    Primitive::Type type;
+    bool lhs;
+  };
+
+  /*
+   * Reduction of a loop phi into a scalar, defined by the phi, its update
+   * in the loop body, and the operand that is folded in each iteration.
+   */
+  struct Reduction {
+    Reduction(HPhi* p, HInstruction* u, HInstruction* x, HVecReduce::ReductionKind k)
+        : phi(p), update(u), operand(x), kind(k) {}
+    HPhi* phi;
+    HInstruction* update;
+    HInstruction* operand;
+    HVecReduce::ReductionKind kind;
+  };
+
+  // Loop analysis.
+  bool IsUnitIncrement(HPhi* phi, HInstruction* update) const;
+  bool IsReduction(HLoopInformation* loop, HPhi* phi, HBasicBlock* body);
+  bool IsReductionUpdate(HInstruction* instruction) const;
+  bool IsUnitIndex(HInstruction* index, /*out*/ HInstruction** offset) const;
+
+  HBasicBlock* GetSimpleLoopBody(HLoopInformation* loop) const;
+
+  // Vectorization analysis.
+  bool TryVectorizeLoop(HLoopInformation* loop);
+  bool CanVectorize(HBasicBlock* body);
+  bool VectorizeDef(HInstruction* instruction);
+  bool VectorizeUse(HInstruction* instruction,
+                    Primitive::Type packed_type,
+                    uint64_t restrictions);
+  bool TrySetVectorType(Primitive::Type type, /*out*/ uint64_t* restrictions);
+  bool TrySetVectorLength(Primitive::Type type);
+  bool TrySetPackedType(HInstruction* instruction, Primitive::Type packed_type);
+  bool CheckArrayReferences(/*out*/ HInstruction** runtime_base1,
+                            /*out*/ HInstruction** runtime_base2) const;
+
+  // Vectorization synthesis.
+  bool Vectorize(HLoopInformation* loop,
+                 HBasicBlock* body,
+                 HInstruction* runtime_base1,
+                 HInstruction* runtime_base2);
+  HInstruction* GenerateVecOperand(HInstruction* instruction, HBasicBlock* block);
+  HInstruction* GenerateVecIndex(HInstruction* index, HBasicBlock* block);
+  void GenerateVecOperation(HInstruction* instruction, HBasicBlock* block);
+  HInstruction* Insert(HBasicBlock* block, HInstruction* instruction);
+
+  // Peeling and unrolling.
+  void TryPeelAndUnrollLoop(HLoopInformation* loop);
+  bool CanCloneBody(HLoopInformation* loop, HBasicBlock* body, /*out*/ size_t* body_size) const;
+  bool IsInvariantCheck(HLoopInformation* loop, HInstruction* instruction) const;
+  void PeelFirstIteration(HLoopInformation* loop, HBasicBlock* body);
+  bool Unroll(HLoopInformation* loop, HBasicBlock* body, HInstruction* stc, size_t factor);
+  void GenerateBodyCopy(HBasicBlock* header, HBasicBlock* body, HBasicBlock* block);
+  HInstruction* CloneInstruction(HInstruction* instruction);
+  HInstruction* GetClonedValue(HInstruction* instruction) const;
+
+  const CompilerDriver* const compiler_driver_;
+
+  // Range information based on prior induction variable analysis.
+  InductionVarRange induction_range_;
+
+  // Phase-local state, cleared for every loop that is considered.
+  HPhi* induction_;                   // basic induction of the loop
+  HInstruction* vector_induction_;    // its counterpart in the vector loop
+  size_t vector_length_;              // number of elements per vector
+  size_t vector_operations_;          // number of vector operations in the body
+  ArenaVector<Reduction> reductions_;
+  ArenaVector<ArrayReference> array_refs_;
+
+  // Maps every scalar instruction that is vectorized to its packed type,
+  // and (during synthesis) to the instruction that replaces it.
+  ArenaSafeMap<HInstruction*, Primitive::Type> packed_types_;
+  ArenaSafeMap<HInstruction*, HInstruction*> vector_map_;
+
+  // Maps every instruction of the loop header and body to its value in the
+  // copy of the loop body that is being generated by peeling or unrolling.
+  ArenaSafeMap<HInstruction*, HInstruction*> clone_map_;
+
+  DISALLOW_COPY_AND_ASSIGN(HLoopOptimization);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_LOOP_OPTIMIZATION_H_
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/arena_allocator.h"
+#include "graph_checker.h"
+#include "induction_var_analysis.h"
+#include "loop_optimization.h"
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+
+namespace art {
+
+/**
+ * Fixture class for the loop optimization tests.
+ */
+class LoopOptimizationTest : public CommonCompilerTest {
+ public:
+  LoopOptimizationTest() : pool_(), allocator_(&pool_) {}
+
+  ~LoopOptimizationTest() { }
+
+  // Builds "for (int i = 0; i < 100; i++) { a[i] = 1; }" for the given instruction set.
+  void BuildArrayStoreLoop(InstructionSet instruction_set) {
+    graph_ = new (&allocator_) HGraph(
+        &allocator_, *reinterpret_cast<DexFile*>(allocator_.Alloc(sizeof(DexFile))), -1, false,
+        instruction_set);
+    graph_->SetNumberOfVRegs(2);
+
+    entry_ = new (&allocator_) HBasicBlock(graph_);
+    preheader_ = new (&allocator_) HBasicBlock(graph_);
+    header_ = new (&allocator_) HBasicBlock(graph_);
+    body_ = new (&allocator_) HBasicBlock(graph_);
+    return_ = new (&allocator_) HBasicBlock(graph_);
+    exit_ = new (&allocator_) HBasicBlock(graph_);
+    graph_->AddBlock(entry_);
+    graph_->AddBlock(preheader_);
+    graph_->AddBlock(header_);
+    graph_->AddBlock(body_);
+    graph_->AddBlock(return_);
+    graph_->AddBlock(exit_);
+    graph_->SetEntryBlock(entry_);
+    graph_->SetExitBlock(exit_);
+    entry_->AddSuccessor(preheader_);
+    preheader_->AddSuccessor(header_);
+    header_->AddSuccessor(body_);
+    header_->AddSuccessor(return_);
+    body_->AddSuccessor(header_);
+    return_->AddSuccessor(exit_);
+
+    HInstruction* array = new (&allocator_) HParameterValue(
+        graph_->GetDexFile(), 0, 0, Primitive::kPrimNot, true);
+    entry_->AddInstruction(array);
+    entry_->AddInstruction(new (&allocator_) HGoto());
+    preheader_->AddInstruction(new (&allocator_) HGoto());
+
+    HPhi* phi = new (&allocator_) HPhi(&allocator_, 1, 0, Primitive::kPrimInt);
+    header_->AddPhi(phi);
+    HSuspendCheck* suspend_check = new (&allocator_) HSuspendCheck();
+    header_->AddInstruction(suspend_check);
+    HEnvironment* environment = new (&allocator_) HEnvironment(
+        &allocator_, 2, graph_->GetDexFile(), graph_->GetMethodIdx(), 0, kStatic, suspend_check);
+    ArenaVector<HInstruction*> locals({ array, phi }, allocator_.Adapter(kArenaAllocInstruction));
+    environment->CopyFrom(locals);
+    suspend_check->SetRawEnvironment(environment);
+    HInstruction* compare = new (&allocator_) HLessThan(phi, graph_->GetIntConstant(100));
+    header_->AddInstruction(compare);
+    header_->AddInstruction(new (&allocator_) HIf(compare));
+
+    body_->AddInstruction(new (&allocator_) HArraySet(
+        array, phi, graph_->GetIntConstant(1), Primitive::kPrimInt, 0));
+    HInstruction* increment =
+        new (&allocator_) HAdd(Primitive::kPrimInt, phi, graph_->GetIntConstant(1));
+    body_->AddInstruction(increment);
+    body_->AddInstruction(new (&allocator_) HGoto());
+    phi->AddInput(graph_->GetIntConstant(0));
+    phi->AddInput(increment);
+
+    return_->AddInstruction(new (&allocator_) HReturnVoid());
+    exit_->AddInstruction(new (&allocator_) HExit());
+  }
+
+  // Runs the loop optimization, and checks that the resulting graph is valid.
+  void PerformLoopOptimization() {
+    graph_->BuildDominatorTree();
+    HInductionVarAnalysis induction(graph_);
+    induction.Run();
+    HLoopOptimization(graph_, nullptr, &induction, nullptr).Run();
+
+    GraphChecker graph_checker(graph_);
+    graph_checker.Run();
+    ASSERT_TRUE(graph_checker.IsValid());
+  }
+
+  ArenaPool pool_;
+  ArenaAllocator allocator_;
+  HGraph* graph_;
+
+  HBasicBlock* entry_;
+  HBasicBlock* preheader_;
+  HBasicBlock* header_;
+  HBasicBlock* body_;
+  HBasicBlock* return_;
+  HBasicBlock* exit_;
+};
+
+TEST_F(LoopOptimizationTest, Vectorize) {
+  BuildArrayStoreLoop(kArm64);
+  PerformLoopOptimization();
+  EXPECT_TRUE(graph_->HasSIMD());
+  // The vector loop is placed in front of the original loop, which keeps one
+  // entry edge and its back edge.
+  EXPECT_EQ(2u, header_->GetPredecessors().size());
+  HBasicBlock* new_preheader = header_->GetLoopInformation()->GetPreHeader();
+  EXPECT_NE(preheader_, new_preheader);
+  EXPECT_EQ(1u, new_preheader->GetSuccessors().size());
+}
+
+TEST_F(LoopOptimizationTest, VectorValueLiveAcrossCall) {
+  BuildArrayStoreLoop(kArm64);
+  PerformLoopOptimization();
+  ASSERT_TRUE(graph_->HasSIMD());
+  // Vector values cannot be spilled, so the graph checker rejects one live across a call.
+  HInstruction* replicate = nullptr;
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (it.Current()->IsVecReplicateScalar()) {
+        replicate = it.Current();
+      }
+    }
+  }
+  ASSERT_TRUE(replicate != nullptr);
+  replicate->GetBlock()->InsertInstructionAfter(new (&allocator_) HSuspendCheck(), replicate);
+  GraphChecker graph_checker(graph_);
+  graph_checker.Run();
+  ASSERT_FALSE(graph_checker.IsValid());
+  bool found = false;
+  for (const std::string& error : graph_checker.GetErrors()) {
+    found |= (error.find("is live across SuspendCheck") != std::string::npos);
+  }
+  EXPECT_TRUE(found);
+}
+
+TEST_F(LoopOptimizationTest, Unroll) {
+  // No SIMD code generation for x86_64 without the instruction set features.
+  BuildArrayStoreLoop(kX86_64);
+  PerformLoopOptimization();
+  EXPECT_FALSE(graph_->HasSIMD());
+  // The unrolled loop is placed in front of the original loop.
+  EXPECT_EQ(2u, header_->GetPredecessors().size());
+  EXPECT_NE(preheader_, header_->GetLoopInformation()->GetPreHeader());
+}
+
+TEST_F(LoopOptimizationTest, NoUnrollOnUntestedTarget) {
+  BuildArrayStoreLoop(kThumb2);
+  PerformLoopOptimization();
+  EXPECT_EQ(preheader_, header_->GetLoopInformation()->GetPreHeader());
+}
+
+}  // namespace art
@@ -2251,6 +2251,88 @@ void HGraph::TransformLoopHeaderForBCE(HBasicBlock* header) {
       new_pre_header, old_pre_header, /* replace_if_back_edge */ false);
 }
 
+HBasicBlock* HGraph::TransformLoopForVectorization(HBasicBlock* header) {
+  DCHECK(header->IsLoopHeader());
+  HLoopInformation* loop = header->GetLoopInformation();
+  HBasicBlock* old_pre_header = loop->GetPreHeader();
+
+  HBasicBlock* new_header = new (arena_) HBasicBlock(this, header->GetDexPc());
+  HBasicBlock* new_body = new (arena_) HBasicBlock(this, header->GetDexPc());
+  HBasicBlock* new_pre_header = new (arena_) HBasicBlock(this, header->GetDexPc());
+  AddBlock(new_header);
+  AddBlock(new_body);
+  AddBlock(new_pre_header);
+
+  // Set up control flow: old_pre_header -> new_header <-> new_body, and
+  // new_header -> new_pre_header -> header. Replacing the predecessor of the header
+  // also adds the new_pre_header -> header edge.
+  header->ReplacePredecessor(old_pre_header, new_pre_header);
+  old_pre_header->AddSuccessor(new_header);
+  new_header->AddSuccessor(new_body);  // True successor
+  new_header->AddSuccessor(new_pre_header);  // False successor
+  new_body->AddSuccessor(new_header);
+
+  // Set up dominators.
+  old_pre_header->ReplaceDominatedBlock(header, new_header);
+  new_header->SetDominator(old_pre_header);
+  new_header->dominated_blocks_.push_back(new_body);
+  new_body->SetDominator(new_header);
+  new_header->dominated_blocks_.push_back(new_pre_header);
+  new_pre_header->SetDominator(new_header);
+  new_pre_header->dominated_blocks_.push_back(header);
+  header->SetDominator(new_pre_header);
+
+  // Fix reverse post order.
+  size_t index_of_header = IndexOfElement(reverse_post_order_, header);
+  MakeRoomFor(&reverse_post_order_, 3, index_of_header - 1);
+  reverse_post_order_[index_of_header++] = new_header;
+  reverse_post_order_[index_of_header++] = new_body;
+  reverse_post_order_[index_of_header++] = new_pre_header;
+
+  // Give every loop phi a counterpart in the new header. On exit of the new
+  // loop, the original phi continues from the value of its counterpart.
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* phi = it.Current()->AsPhi();
+    HPhi* new_phi =
+        new (arena_) HPhi(arena_, phi->GetRegNumber(), 0, phi->GetType(), phi->GetDexPc());
+    new_header->AddPhi(new_phi);
+    new_phi->AddInput(phi->InputAt(0));
+    if (phi->GetType() == Primitive::kPrimNot) {
+      new_phi->SetCanBeNull(phi->CanBeNull());
+      new_phi->SetReferenceTypeInfo(phi->GetReferenceTypeInfo());
+    }
+    phi->ReplaceInput(new_phi, 0);
+  }
+
+  // Add gotos and the suspend check of the new loop. The client must add the
+  // conditional in the new header. Since the first input of each original loop
+  // phi is now its counterpart, the loop phi adjustment yields the right environment.
+  HSuspendCheck* suspend_check = new (arena_) HSuspendCheck(header->GetDexPc());
+  new_header->AddInstruction(suspend_check);
+  suspend_check->CopyEnvironmentFromWithLoopPhiAdjustment(
+      loop->GetSuspendCheck()->GetEnvironment(), header);
+  new_body->AddInstruction(new (arena_) HGoto());
+  new_pre_header->AddInstruction(new (arena_) HGoto());
+
+  // Update loop information.
+  new_header->AddBackEdge(new_body);
+  new_header->GetLoopInformation()->SetSuspendCheck(suspend_check);
+  new_header->GetLoopInformation()->Populate();
+  HLoopInformationOutwardIterator it(*new_header);
+  for (it.Advance(); !it.Done(); it.Advance()) {
+    it.Current()->Add(new_header);
+    it.Current()->Add(new_body);
+  }
+  TryCatchInformation* try_catch_info = old_pre_header->IsTryBlock()
+      ? old_pre_header->GetTryCatchInformation()
+      : nullptr;
+  new_header->SetTryCatchInformation(try_catch_info);
+  new_body->SetTryCatchInformation(try_catch_info);
+  UpdateLoopAndTryInformationOfNewBlock(
+      new_pre_header, old_pre_header, /* replace_if_back_edge */ false);
+  return new_header;
+}
+
 static void CheckAgainstUpperBound(ReferenceTypeInfo rti, ReferenceTypeInfo upper_bound_rti)
     SHARED_REQUIRES(Locks::mutator_lock_) {
   if (rti.IsValid()) {
@@ -2494,6 +2576,20 @@ std::ostream& operator<<(std::ostream& os, HLoadString::LoadKind rhs) {
   }
 }
 
+std::ostream& operator<<(std::ostream& os, const HVecReduce::ReductionKind& rhs) {
+  switch (rhs) {
+    case HVecReduce::kSum:
+      return os << "sum";
+    case HVecReduce::kMin:
+      return os << "min";
+    case HVecReduce::kMax:
+      return os << "max";
+    default:
+      LOG(FATAL) << "Unknown HVecReduce::ReductionKind: " << static_cast<int>(rhs);
+      UNREACHABLE();
+  }
+}
+
 void HInstruction::RemoveEnvironmentUsers() {
   for (const HUseListNode<HEnvironment*>& use : GetEnvUses()) {
     HEnvironment* user = use.GetUser();
@@ -56,6 +56,7 @@ class HNullConstant;
 class HPhi;
 class HSuspendCheck;
 class HTryBoundary;
+class InlineCache;
 class LiveInterval;
 class LocationSummary;
 class SlowPathCode;
@@ -283,6 +284,7 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
          InvokeType invoke_type = kInvalidInvokeType,
          bool debuggable = false,
          bool osr = false,
+         bool baseline = false,
          int start_instruction_id = 0)
       : arena_(arena),
         blocks_(arena->Adapter(kArenaAllocBlockList)),
@@ -297,6 +299,7 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         has_bounds_checks_(false),
         has_try_catch_(false),
         has_irreducible_loops_(false),
+        has_simd_(false),
         debuggable_(debuggable),
         current_instruction_id_(start_instruction_id),
         dex_file_(dex_file),
@@ -312,7 +315,9 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         cached_double_constants_(std::less<int64_t>(), arena->Adapter(kArenaAllocConstantsMap)),
         cached_current_method_(nullptr),
         inexact_object_rti_(ReferenceTypeInfo::CreateInvalid()),
-        osr_(osr) {
+        osr_(osr),
+        baseline_(baseline),
+        cha_single_implementation_list_(std::less<ArtMethod*>(), arena->Adapter(kArenaAllocCHA)) {
     blocks_.reserve(kDefaultNumberOfBlocks);
   }
 
@@ -368,6 +373,14 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // put deoptimization instructions, etc.
   void TransformLoopHeaderForBCE(HBasicBlock* header);
 
+  // Inserts a new, empty loop between the pre-header of the loop defined by
+  // `header` and `header` itself, and returns the header of the new loop.
+  // Every phi of `header` gets a counterpart phi in the new header, carrying
+  // the original initial value; the original phi takes the value of its
+  // counterpart on exit of the new loop. The caller must add the back edge
+  // input of the new phis and the exit condition of the new header.
+  HBasicBlock* TransformLoopForVectorization(HBasicBlock* header);
+
   // Removes `block` from the graph. Assumes `block` has been disconnected from
   // other blocks and has no instructions or phis.
   void DeleteDeadEmptyBlock(HBasicBlock* block);
@@ -502,12 +515,17 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
 
   bool IsCompilingOsr() const { return osr_; }
 
+  bool IsCompilingBaseline() const { return baseline_; }
+
   bool HasTryCatch() const { return has_try_catch_; }
   void SetHasTryCatch(bool value) { has_try_catch_ = value; }
 
   bool HasIrreducibleLoops() const { return has_irreducible_loops_; }
   void SetHasIrreducibleLoops(bool value) { has_irreducible_loops_ = value; }
 
+  bool HasSIMD() const { return has_simd_; }
+  void SetHasSIMD(bool value) { has_simd_ = value; }
+
   ArtMethod* GetArtMethod() const { return art_method_; }
   void SetArtMethod(ArtMethod* method) { art_method_ = method; }
 
@@ -518,6 +536,14 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
 
   ReferenceTypeInfo GetInexactObjectRti() const { return inexact_object_rti_; }
 
+  const ArenaSet<ArtMethod*>& GetCHASingleImplementationList() const {
+    return cha_single_implementation_list_;
+  }
+
+  void AddCHASingleImplementationDependency(ArtMethod* method) {
+    cha_single_implementation_list_.insert(method);
+  }
+
  private:
   void RemoveInstructionsAsUsersFromDeadBlocks(const ArenaBitVector& visited) const;
   void RemoveDeadBlocks(const ArenaBitVector& visited);
@@ -588,6 +614,11 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // Flag whether there are any irreducible loops in the graph.
   bool has_irreducible_loops_;
 
+  // Flag whether SIMD instructions appear in the graph. If true, the
+  // code generators may have to be more careful spilling the wider
+  // contents of SIMD registers.
+  bool has_simd_;
+
   // Indicates whether the graph should be compiled in a way that
   // ensures full debuggability. If false, we can apply more
   // aggressive optimizations that may limit the level of debugging.
@@ -637,6 +668,15 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // compiled code entries which the interpreter can directly jump to.
   const bool osr_;
 
+  // Whether we are compiling this graph for the baseline tier of the JIT: only the
+  // passes needed to generate code are run, and the generated code keeps updating
+  // the hotness and the inline caches of the method.
+  const bool baseline_;
+
+  // Methods whose single implementation the code relies on, as reported by the
+  // class hierarchy analysis. Only used by the JIT.
+  ArenaSet<ArtMethod*> cha_single_implementation_list_;
+
   friend class SsaBuilder;           // For caching constants.
   friend class SsaLivenessAnalysis;  // For the linear order.
   friend class HInliner;             // For the reverse post order.
@@ -1292,6 +1332,33 @@ class HLoopInformationOutwardIterator : public ValueObject {
   M(Arm64IntermediateAddress, Instruction)
 #endif
 
+/*
+ * Vector instructions, generated by the loop optimizer only for
+ * architectures that support SIMD code generation.
+ */
+#define FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(M)                         \
+  M(VecReplicateScalar, VecUnaryOperation)                              \
+  M(VecNeg, VecUnaryOperation)                                          \
+  M(VecNot, VecUnaryOperation)                                          \
+  M(VecAdd, VecBinaryOperation)                                         \
+  M(VecSub, VecBinaryOperation)                                         \
+  M(VecMul, VecBinaryOperation)                                         \
+  M(VecMin, VecBinaryOperation)                                         \
+  M(VecMax, VecBinaryOperation)                                         \
+  M(VecAnd, VecBinaryOperation)                                         \
+  M(VecOr, VecBinaryOperation)                                          \
+  M(VecXor, VecBinaryOperation)                                         \
+  M(VecLoad, VecMemoryOperation)                                        \
+  M(VecStore, VecMemoryOperation)                                       \
+  M(VecReduce, VecOperation)
+
+/*
+ * Instructions emitted only in the baseline code of the JIT, for architectures
+ * that support baseline compilation.
+ */
+#define FOR_EACH_CONCRETE_INSTRUCTION_JIT_BASELINE(M)                   \
+  M(UpdateInlineCache, Instruction)
+
 #define FOR_EACH_CONCRETE_INSTRUCTION_MIPS(M)
 
 #define FOR_EACH_CONCRETE_INSTRUCTION_MIPS64(M)
@@ -1311,6 +1378,8 @@ class HLoopInformationOutwardIterator : public ValueObject {
 #define FOR_EACH_CONCRETE_INSTRUCTION(M)                                \
   FOR_EACH_CONCRETE_INSTRUCTION_COMMON(M)                               \
   FOR_EACH_CONCRETE_INSTRUCTION_SHARED(M)                               \
+  FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(M)                               \
+  FOR_EACH_CONCRETE_INSTRUCTION_JIT_BASELINE(M)                         \
   FOR_EACH_CONCRETE_INSTRUCTION_ARM(M)                                  \
   FOR_EACH_CONCRETE_INSTRUCTION_ARM64(M)                                \
   FOR_EACH_CONCRETE_INSTRUCTION_MIPS(M)                                 \
@@ -1323,7 +1392,11 @@ class HLoopInformationOutwardIterator : public ValueObject {
   M(Constant, Instruction)                                              \
   M(UnaryOperation, Instruction)                                        \
   M(BinaryOperation, Instruction)                                       \
-  M(Invoke, Instruction)
+  M(Invoke, Instruction)                                                \
+  M(VecOperation, Instruction)                                          \
+  M(VecUnaryOperation, VecOperation)                                    \
+  M(VecBinaryOperation, VecOperation)                                   \
+  M(VecMemoryOperation, VecOperation)
 
 #define FOR_EACH_INSTRUCTION(M)                                         \
   FOR_EACH_CONCRETE_INSTRUCTION(M)                                      \
@@ -2025,8 +2098,9 @@ class HInstruction : public ArenaObject<kArenaAllocInstruction> {
   //      to walk the stack and have the current method stored at a specific stack address.
   // (2): Object literals like classes and strings, that are loaded from the dex cache
   //      fields of the current method.
+  // (3): Inline cache updates of baseline code, which pass the current method to the runtime.
   bool NeedsCurrentMethod() const {
-    return NeedsEnvironment() || IsLoadClass() || IsLoadString();
+    return NeedsEnvironment() || IsLoadClass() || IsLoadString() || IsUpdateInlineCache();
   }
 
   // Returns whether the code generation of the instruction will require to have access
@@ -3628,8 +3702,12 @@ class HNewInstance : public HExpression<2> {
 
   // It may throw when called on type that's not instantiable/accessible.
   // It can throw OOME.
-  // TODO: distinguish between the two cases so we can for example allow allocation elimination.
-  bool CanThrow() const OVERRIDE { return GetPackedFlag<kFlagCanThrow>() || true; }
+  bool CanThrow() const OVERRIDE { return true; }
+
+  // Returns whether the allocation may throw for a reason other than OOME, i.e.
+  // the type may not be instantiable or accessible. Allocations which do not
+  // need these checks can be eliminated when the object is not used.
+  bool NeedsChecks() const { return GetPackedFlag<kFlagCanThrow>(); }
 
   bool IsFinalizable() const { return GetPackedFlag<kFlagFinalizable>(); }
 
@@ -5329,6 +5407,29 @@ class HNativeDebugInfo : public HTemplateInstruction<0> {
   DISALLOW_COPY_AND_ASSIGN(HNativeDebugInfo);
 };
 
+// Records the class of the receiver of a virtual or interface call in the inline
+// cache of the call, which the JIT uses when optimizing the method. Only used in
+// baseline code.
+class HUpdateInlineCache : public HTemplateInstruction<1> {
+ public:
+  HUpdateInlineCache(HInstruction* receiver, const InlineCache* inline_cache, uint32_t dex_pc)
+      // Calls the runtime to update the cache, which does not trigger GC. The write
+      // side effects prevent the instruction from being removed.
+      : HTemplateInstruction(SideEffects::AllWrites(), dex_pc),
+        inline_cache_(inline_cache) {
+    SetRawInputAt(0, receiver);
+  }
+
+  const InlineCache* GetInlineCache() const { return inline_cache_; }
+
+  DECLARE_INSTRUCTION(UpdateInlineCache);
+
+ private:
+  const InlineCache* const inline_cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(HUpdateInlineCache);
+};
+
 /**
  * Instruction to load a Class object.
  */
@@ -6347,6 +6448,7 @@ class HParallelMove : public HTemplateInstruction<0> {
 #ifdef ART_ENABLE_CODEGEN_x86
 #include "nodes_x86.h"
 #endif
+#include "nodes_vector.h"
 
 namespace art {
 
@@ -41,6 +41,7 @@
 #include "bounds_check_elimination.h"
 #include "builder.h"
 #include "code_generator.h"
+#include "code_sinking.h"
 #include "compiled_method.h"
 #include "compiler.h"
 #include "constant_folding.h"
@@ -68,6 +69,7 @@
 #include "jni/quick/jni_compiler.h"
 #include "licm.h"
 #include "load_store_elimination.h"
+#include "loop_optimization.h"
 #include "nodes.h"
 #include "oat_quick_method_header.h"
 #include "prepare_for_register_allocation.h"
@@ -292,7 +294,11 @@ class OptimizingCompiler FINAL : public Compiler {
     }
   }
 
-  bool JitCompile(Thread* self, jit::JitCodeCache* code_cache, ArtMethod* method, bool osr)
+  bool JitCompile(Thread* self,
+                  jit::JitCodeCache* code_cache,
+                  ArtMethod* method,
+                  bool osr,
+                  bool baseline)
       OVERRIDE
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -322,7 +328,8 @@ class OptimizingCompiler FINAL : public Compiler {
                             const DexFile& dex_file,
                             Handle<mirror::DexCache> dex_cache,
                             ArtMethod* method,
-                            bool osr) const;
+                            bool osr,
+                            bool baseline) const;
 
   std::unique_ptr<OptimizingCompilerStats> compilation_stats_;
 
@@ -387,6 +394,13 @@ static bool InstructionSetSupportsReadBarrier(InstructionSet instruction_set) {
       || instruction_set == kX86_64;
 }
 
+// Baseline code is supported on ARM64 and x86-64 at the moment. Other architectures
+// compile hot methods with all optimizations right away.
+static bool IsBaselineCompilationSupported(InstructionSet instruction_set) {
+  return instruction_set == kArm64
+      || instruction_set == kX86_64;
+}
+
 static void RunOptimizations(HOptimization* optimizations[],
                              size_t length,
                              PassObserver* pass_observer) {
@@ -481,7 +495,9 @@ static void RunArchOptimizations(InstructionSet instruction_set,
 NO_INLINE  // Avoid increasing caller's frame size by large stack-allocated objects.
 static void AllocateRegisters(HGraph* graph,
                               CodeGenerator* codegen,
-                              PassObserver* pass_observer) {
+                              PassObserver* pass_observer,
+                              RegisterAllocator::Strategy strategy,
+                              OptimizingCompilerStats* stats) {
   {
     PassScope scope(PrepareForRegisterAllocation::kPrepareForRegisterAllocationPassName,
                     pass_observer);
@@ -494,7 +510,8 @@ static void AllocateRegisters(HGraph* graph,
   }
   {
     PassScope scope(RegisterAllocator::kRegisterAllocatorPassName, pass_observer);
-    RegisterAllocator(graph->GetArena(), codegen, liveness).AllocateRegisters();
+    RegisterAllocator::Create(graph->GetArena(), codegen, liveness, strategy, stats)
+        ->AllocateRegisters();
   }
 }
 
@@ -521,12 +538,16 @@ static void RunOptimizations(HGraph* graph,
   LoadStoreElimination* lse = new (arena) LoadStoreElimination(graph, *side_effects);
   HInductionVarAnalysis* induction = new (arena) HInductionVarAnalysis(graph);
   BoundsCheckElimination* bce = new (arena) BoundsCheckElimination(graph, *side_effects, induction);
+  // Loop optimizations need induction information on the graph after BCE and LSE.
+  HInductionVarAnalysis* induction2 = new (arena) HInductionVarAnalysis(graph);
+  HLoopOptimization* loop = new (arena) HLoopOptimization(graph, driver, induction2, stats);
   HSharpening* sharpening = new (arena) HSharpening(graph, codegen, dex_compilation_unit, driver);
   InstructionSimplifier* simplify2 = new (arena) InstructionSimplifier(
       graph, stats, "instruction_simplifier_after_bce");
   InstructionSimplifier* simplify3 = new (arena) InstructionSimplifier(
       graph, stats, "instruction_simplifier_before_codegen");
   IntrinsicsRecognizer* intrinsics = new (arena) IntrinsicsRecognizer(graph, driver, stats);
+  CodeSinking* code_sinking = new (arena) CodeSinking(graph, stats);
 
   HOptimization* optimizations1[] = {
     intrinsics,
@@ -552,7 +573,10 @@ static void RunOptimizations(HGraph* graph,
     fold3,  // evaluates code generated by dynamic bce
     simplify2,
     lse,
+    induction2,
+    loop,
     dce2,
+    code_sinking,
     // The codegen has a few assumptions that only the instruction simplifier
     // can satisfy. For example, the code generator does not expect to see a
     // HTypeConversion from a type to the same type.
@@ -561,7 +585,31 @@ static void RunOptimizations(HGraph* graph,
   RunOptimizations(optimizations2, arraysize(optimizations2), pass_observer);
 
   RunArchOptimizations(driver->GetInstructionSet(), graph, codegen, stats, pass_observer);
-  AllocateRegisters(graph, codegen, pass_observer);
+  // The JIT favors compilation speed, and always uses the linear scan allocator.
+  RegisterAllocator::Strategy regalloc_strategy = Runtime::Current()->UseJitCompilation()
+      ? RegisterAllocator::kRegisterAllocatorLinearScan
+      : driver->GetCompilerOptions().GetRegisterAllocationStrategy();
+  AllocateRegisters(graph, codegen, pass_observer, regalloc_strategy, stats);
+}
+
+// Baseline code is compiled as fast as possible: only the passes the code generator
+// relies on are run, and the JIT later recompiles the method with all optimizations
+// once its baseline code gets hot.
+static void RunBaselineOptimizations(HGraph* graph,
+                                     CodeGenerator* codegen,
+                                     OptimizingCompilerStats* stats,
+                                     PassObserver* pass_observer) {
+  ArenaAllocator* arena = graph->GetArena();
+  InstructionSimplifier* simplify = new (arena) InstructionSimplifier(
+      graph, stats, "instruction_simplifier_before_codegen");
+  HOptimization* optimizations[] = {
+    // The codegen has a few assumptions that only the instruction simplifier
+    // can satisfy.
+    simplify,
+  };
+  RunOptimizations(optimizations, arraysize(optimizations), pass_observer);
+  AllocateRegisters(
+      graph, codegen, pass_observer, RegisterAllocator::kRegisterAllocatorLinearScan, stats);
 }
 
 static ArenaVector<LinkerPatch> EmitAndSortLinkerPatches(CodeGenerator* codegen) {
@@ -616,7 +664,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
                                               const DexFile& dex_file,
                                               Handle<mirror::DexCache> dex_cache,
                                               ArtMethod* method,
-                                              bool osr) const {
+                                              bool osr,
+                                              bool baseline) const {
   MaybeRecordStat(MethodCompilationStat::kAttemptCompilation);
   CompilerDriver* compiler_driver = GetCompilerDriver();
   InstructionSet instruction_set = compiler_driver->GetInstructionSet();
@@ -678,7 +727,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
       compiler_driver->GetInstructionSet(),
       kInvalidInvokeType,
       compiler_driver->GetCompilerOptions().GetDebuggable(),
-      osr);
+      osr,
+      baseline && IsBaselineCompilationSupported(instruction_set));
 
   const uint8_t* interpreter_metadata = nullptr;
   if (method == nullptr) {
@@ -769,13 +819,17 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
       }
     }
 
-    RunOptimizations(graph,
-                     codegen.get(),
-                     compiler_driver,
-                     compilation_stats_.get(),
-                     dex_compilation_unit,
-                     &pass_observer,
-                     &handles);
+    if (graph->IsCompilingBaseline()) {
+      RunBaselineOptimizations(graph, codegen.get(), compilation_stats_.get(), &pass_observer);
+    } else {
+      RunOptimizations(graph,
+                       codegen.get(),
+                       compiler_driver,
+                       compilation_stats_.get(),
+                       dex_compilation_unit,
+                       &pass_observer,
+                       &handles);
+    }
 
     codegen->Compile(code_allocator);
     pass_observer.DumpDisassembly();
@@ -814,7 +868,8 @@ CompiledMethod* OptimizingCompiler::Compile(const DexFile::CodeItem* code_item,
                    dex_file,
                    dex_cache,
                    nullptr,
-                   /* osr */ false));
+                   /* osr */ false,
+                   /* baseline */ false));
     if (codegen.get() != nullptr) {
       MaybeRecordStat(MethodCompilationStat::kCompiled);
       method = Emit(&arena, &code_allocator, codegen.get(), compiler_driver, code_item);
@@ -865,10 +920,55 @@ bool IsCompilingWithCoreImage() {
   return false;
 }
 
+// Returns whether the code compiled for `graph` only refers to the process through
+// the current method, the thread and the runtime entrypoints, and can therefore be
+// saved in a JitCodeSnapshot and installed by another process.
+static bool IsRelocatableJitCode(HGraph* graph) {
+  if (graph->IsCompilingOsr() ||
+      graph->IsCompilingBaseline() ||
+      !graph->GetCHASingleImplementationList().empty()) {
+    return false;
+  }
+  for (HBasicBlock* block : graph->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      if (instruction->IsClassTableGet()) {
+        // Inlining guards compare the result with ArtMethod pointers.
+        return false;
+      } else if (instruction->IsLoadString()) {
+        HLoadString::LoadKind load_kind = instruction->AsLoadString()->GetLoadKind();
+        if (load_kind == HLoadString::LoadKind::kBootImageAddress ||
+            load_kind == HLoadString::LoadKind::kDexCacheAddress) {
+          return false;
+        }
+      } else if (instruction->IsInvokeStaticOrDirect()) {
+        HInvokeStaticOrDirect* invoke = instruction->AsInvokeStaticOrDirect();
+        switch (invoke->GetMethodLoadKind()) {
+          case HInvokeStaticOrDirect::MethodLoadKind::kStringInit:
+          case HInvokeStaticOrDirect::MethodLoadKind::kRecursive:
+          case HInvokeStaticOrDirect::MethodLoadKind::kDexCacheViaMethod:
+            break;
+          default:
+            return false;
+        }
+        switch (invoke->GetCodePtrLocation()) {
+          case HInvokeStaticOrDirect::CodePtrLocation::kCallSelf:
+          case HInvokeStaticOrDirect::CodePtrLocation::kCallArtMethod:
+            break;
+          default:
+            return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 bool OptimizingCompiler::JitCompile(Thread* self,
                                     jit::JitCodeCache* code_cache,
                                     ArtMethod* method,
-                                    bool osr) {
+                                    bool osr,
+                                    bool baseline) {
   StackHandleScope<2> hs(self);
   Handle<mirror::ClassLoader> class_loader(hs.NewHandle(
       method->GetDeclaringClass()->GetClassLoader()));
@@ -901,7 +1001,8 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                    *dex_file,
                    dex_cache,
                    method,
-                   osr));
+                   osr,
+                   baseline));
     if (codegen.get() == nullptr) {
       return false;
     }
@@ -921,6 +1022,8 @@ bool OptimizingCompiler::JitCompile(Thread* self,
   }
   MaybeRecordStat(MethodCompilationStat::kCompiled);
   codegen->BuildStackMaps(MemoryRegion(stack_map_data, stack_map_size), *code_item);
+  bool relocatable = Runtime::Current()->GetJit()->UseCodeSnapshot() &&
+      IsRelocatableJitCode(codegen->GetGraph());
   const void* code = code_cache->CommitCode(
       self,
       method,
@@ -930,7 +1033,10 @@ bool OptimizingCompiler::JitCompile(Thread* self,
       codegen->GetFpuSpillMask(),
       code_allocator.GetMemory().data(),
       code_allocator.GetSize(),
-      osr);
+      osr,
+      codegen->GetGraph()->IsCompilingBaseline(),
+      relocatable,
+      codegen->GetGraph()->GetCHASingleImplementationList());
 
   if (code == nullptr) {
     code_cache->ClearData(self, stack_map_data);
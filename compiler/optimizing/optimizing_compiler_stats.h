@@ -65,6 +65,13 @@ enum MethodCompilationStat {
   kInlinedInvokeVirtualOrInterface,
   kImplicitNullCheckGenerated,
   kExplicitNullCheckGenerated,
+  kLoopVectorized,
+  kLoopUnrolled,
+  kLoopPeeled,
+  kRegisterSpills,
+  kRegisterReloads,
+  kCHAInline,
+  kInstructionSunk,
   kLastStat
 };
 
@@ -143,6 +150,13 @@ class OptimizingCompilerStats {
       case kInlinedInvokeVirtualOrInterface: name = "InlinedInvokeVirtualOrInterface"; break;
       case kImplicitNullCheckGenerated: name = "ImplicitNullCheckGenerated"; break;
       case kExplicitNullCheckGenerated: name = "ExplicitNullCheckGenerated"; break;
+      case kLoopVectorized: name = "LoopVectorized"; break;
+      case kLoopUnrolled: name = "LoopUnrolled"; break;
+      case kLoopPeeled: name = "LoopPeeled"; break;
+      case kRegisterSpills: name = "RegisterSpills"; break;
+      case kRegisterReloads: name = "RegisterReloads"; break;
+      case kCHAInline: name = "CHAInline"; break;
+      case kInstructionSunk: name = "InstructionSunk"; break;
 
       case kLastStat:
         LOG(FATAL) << "invalid stat "
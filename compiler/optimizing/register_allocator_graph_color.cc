@@ -0,0 +1,1594 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "register_allocator_graph_color.h"
+
+#include <bitset>
+#include <limits>
+#include <queue>
+
+#include "base/bit_vector-inl.h"
+#include "base/stl_util.h"
+#include "code_generator.h"
+#include "register_allocation_resolver.h"
+#include "ssa_liveness_analysis.h"
+
+namespace art {
+
+// Highest number of registers of a given kind on any supported instruction set.
+// Used to size register masks, which need to know their size at compile time.
+static constexpr size_t kMaxNumRegs = 32;
+
+// Sentinel for nodes which have not been assigned a color.
+static constexpr int kNoColor = -1;
+
+// Estimated number of iterations of a loop, used to weigh the cost of moves and
+// register uses by loop nesting depth.
+static constexpr float kLoopWeight = 10.0f;
+
+// Loop nesting depth beyond which we no longer increase weights, to avoid overflows.
+static constexpr size_t kMaxWeightedLoopDepth = 10;
+
+// Returns an estimate of how often `block` executes relative to the method entry.
+static float ComputeBlockWeight(const HBasicBlock& block) {
+  float weight = 1.0f;
+  size_t depth = 0;
+  for (HLoopInformationOutwardIterator it(block);
+       !it.Done() && depth < kMaxWeightedLoopDepth;
+       it.Advance(), ++depth) {
+    weight *= kLoopWeight;
+  }
+  return weight;
+}
+
+// Returns the weighted number of definitions and uses of `interval`, that is, the
+// cost of the loads and stores needed if `interval` does not get a register.
+static float ComputeUseWeight(LiveInterval* interval) {
+  float weight = 0.0f;
+  HInstruction* defined_by = interval->GetParent()->GetDefinedBy();
+  if (interval->IsParent() && defined_by != nullptr) {
+    weight += ComputeBlockWeight(*defined_by->GetBlock());
+  }
+  size_t start = interval->GetStart();
+  size_t end = interval->GetEnd();
+  for (UsePosition* use = interval->GetFirstUse();
+       use != nullptr && use->GetPosition() <= end;
+       use = use->GetNext()) {
+    if (use->GetPosition() > start && !use->IsSynthesized()) {
+      weight += ComputeBlockWeight(*use->GetUser()->GetBlock());
+    }
+  }
+  return weight;
+}
+
+static bool IsCoreInterval(LiveInterval* interval) {
+  return !interval->IsFloatingPoint();
+}
+
+// Calls `visitor(start, end)` in increasing order for each window [start, end) where
+// `interval` must be in a register: right after its definition if the definition
+// requires a register, and right before each use requiring a register.
+// Overlapping or adjacent windows are merged.
+template <typename Visitor>
+static void ForEachRegisterWindow(LiveInterval* interval, const Visitor& visitor) {
+  size_t start = interval->GetStart();
+  size_t end = interval->GetEnd();
+  size_t window_start = kNoLifetime;
+  size_t window_end = kNoLifetime;
+  auto add_window = [&](size_t from, size_t to) {
+    if (window_start != kNoLifetime && from <= window_end) {
+      window_end = std::max(window_end, to);
+    } else {
+      if (window_start != kNoLifetime) {
+        visitor(window_start, window_end);
+      }
+      window_start = from;
+      window_end = to;
+    }
+  };
+
+  if (interval->FirstRegisterUse() == start) {
+    add_window(start, start + 1);
+  }
+  for (UsePosition* use = interval->GetFirstUse();
+       use != nullptr && use->GetPosition() <= end;
+       use = use->GetNext()) {
+    size_t position = use->GetPosition();
+    if (position > start && use->RequiresRegister()) {
+      add_window(position - 1, position);
+    }
+  }
+  if (window_start != kNoLifetime) {
+    visitor(window_start, window_end);
+  }
+}
+
+// Returns whether `interval` must be assigned a register, that is, whether it
+// is a temporary or only covers positions where a register is required.
+// Such intervals cannot be split any further.
+static bool IsRequiredInterval(LiveInterval* interval) {
+  if (interval->IsTemp() || interval->HasRegister()) {
+    return true;
+  }
+  size_t covered_until = interval->GetStart();
+  bool has_gap = false;
+  bool has_window = false;
+  ForEachRegisterWindow(interval, [&](size_t start, size_t end) {
+    has_gap = has_gap || (start > covered_until);
+    covered_until = std::max(covered_until, end);
+    has_window = true;
+  });
+  return has_window && !has_gap && covered_until >= interval->GetEnd();
+}
+
+// Returns whether `output` may be assigned the same register as `input`: the
+// instruction defining `output` does not require its output to be distinct from its
+// inputs, and `input` is the interval of one of its inputs dying at that instruction.
+// See LiveInterval::CanUseInputRegister.
+static bool CanShareInputRegister(LiveInterval* output, LiveInterval* input) {
+  HInstruction* defined_by = output->GetDefinedBy();
+  if (!output->IsParent() || defined_by == nullptr) {
+    return false;
+  }
+  LocationSummary* locations = defined_by->GetLocations();
+  size_t position = defined_by->GetLifetimePosition();
+  if (locations->OutputCanOverlapWithInputs()
+      || !locations->Out().IsUnallocated()
+      || output->GetStart() != position) {
+    return false;
+  }
+  for (HInputIterator it(defined_by); !it.Done(); it.Advance()) {
+    LiveInterval* parent = it.Current()->GetLiveInterval();
+    if (parent != input->GetParent() || !input->CoversSlow(position)) {
+      continue;
+    }
+    // The input must not be live after the instruction.
+    for (LiveInterval* sibling = parent; sibling != nullptr; sibling = sibling->GetNextSibling()) {
+      if (sibling->CoversSlow(position + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// Returns whether the live ranges of `a` and `b` intersect.
+static bool RangesIntersect(LiveInterval* a, LiveInterval* b) {
+  LiveRange* range_a = a->GetFirstRange();
+  LiveRange* range_b = b->GetFirstRange();
+  while (range_a != nullptr && range_b != nullptr) {
+    if (range_a->IsBefore(*range_b)) {
+      range_a = range_a->GetNext();
+    } else if (range_b->IsBefore(*range_a)) {
+      range_b = range_b->GetNext();
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+enum class NodeStage {
+  kInitial,           // Not yet in a worklist.
+  kPrecolored,        // Fixed nodes, never removed from the graph.
+  kSimplifyWorklist,  // Low degree, not move-related.
+  kFreezeWorklist,    // Low degree, move-related.
+  kSpillWorklist,     // High degree.
+  kCoalesced,         // Merged into another node, see InterferenceNode::GetAlias.
+  kPruned             // Removed from the graph and pushed on the select stack.
+};
+
+enum class CoalesceStage {
+  kWorklist,     // Ready to be considered for coalescing.
+  kActive,       // Not yet ready, may become ready when the degree of a node drops.
+  kFrozen,       // No longer considered; the nodes may still be given the same color.
+  kConstrained,  // The two nodes interfere.
+  kCoalesced     // The two nodes have been merged.
+};
+
+class InterferenceNode;
+
+// A move between two intervals which can be eliminated by giving both intervals
+// the same register.
+class CoalesceOpportunity : public ArenaObject<kArenaAllocRegisterAllocator> {
+ public:
+  CoalesceOpportunity(InterferenceNode* a, InterferenceNode* b, float priority)
+      : node_a_(a), node_b_(b), stage_(CoalesceStage::kWorklist), priority_(priority) {}
+
+  InterferenceNode* GetNodeA() const { return node_a_; }
+  InterferenceNode* GetNodeB() const { return node_b_; }
+  CoalesceStage GetStage() const { return stage_; }
+  void SetStage(CoalesceStage stage) { stage_ = stage; }
+  float GetPriority() const { return priority_; }
+
+ private:
+  InterferenceNode* const node_a_;
+  InterferenceNode* const node_b_;
+  CoalesceStage stage_;
+
+  // Estimated cost of the move, weighed by loop depth.
+  const float priority_;
+
+  DISALLOW_COPY_AND_ASSIGN(CoalesceOpportunity);
+};
+
+// A node of the interference graph. Each node represents a live interval, or a
+// physical register for the intervals of `RegisterAllocatorGraphColor::BlockRegister`.
+// To save memory, precolored nodes do not record their adjacent nodes.
+class InterferenceNode : public ArenaObject<kArenaAllocRegisterAllocator> {
+ public:
+  InterferenceNode(ArenaAllocator* allocator, LiveInterval* interval)
+      : interval_(interval),
+        stage_(interval->HasRegister() ? NodeStage::kPrecolored : NodeStage::kInitial),
+        adjacent_nodes_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        coalesce_opportunities_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        out_degree_(0),
+        alias_(this),
+        color_(interval->HasRegister() ? interval->GetRegister() : kNoColor),
+        requires_color_(IsRequiredInterval(interval)),
+        crosses_call_(interval->HasWillCallSafepoint()),
+        use_weight_(interval->IsFixed() ? 0.0f : ComputeUseWeight(interval)),
+        length_(interval->GetEnd() - interval->GetStart()) {}
+
+  LiveInterval* GetInterval() const { return interval_; }
+
+  NodeStage GetStage() const { return stage_; }
+  void SetStage(NodeStage stage) { stage_ = stage; }
+
+  bool IsPrecolored() const { return stage_ == NodeStage::kPrecolored; }
+
+  // Whether the node is still part of the graph being pruned.
+  bool IsInGraph() const {
+    return stage_ != NodeStage::kCoalesced && stage_ != NodeStage::kPruned;
+  }
+
+  int GetColor() const { return color_; }
+  void SetColor(int color) { color_ = color; }
+  bool HasColor() const { return color_ != kNoColor; }
+
+  void AddInterference(InterferenceNode* other) {
+    DCHECK(!IsPrecolored()) << "Precolored nodes do not record their interferences";
+    DCHECK_NE(this, other) << "Should not create self loops in the interference graph";
+    adjacent_nodes_.push_back(other);
+    ++out_degree_;
+  }
+
+  bool ContainsInterference(InterferenceNode* other) const {
+    DCHECK(!IsPrecolored());
+    return ContainsElement(adjacent_nodes_, other);
+  }
+
+  const ArenaVector<InterferenceNode*>& GetAdjacentNodes() const { return adjacent_nodes_; }
+
+  size_t GetOutDegree() const {
+    return IsPrecolored() ? std::numeric_limits<size_t>::max() : out_degree_;
+  }
+
+  void DecrementOutDegree() {
+    DCHECK_NE(out_degree_, 0u);
+    --out_degree_;
+  }
+
+  void AddCoalesceOpportunity(CoalesceOpportunity* opportunity) {
+    coalesce_opportunities_.push_back(opportunity);
+  }
+
+  const ArenaVector<CoalesceOpportunity*>& GetCoalesceOpportunities() const {
+    return coalesce_opportunities_;
+  }
+
+  // Returns the node this node has been coalesced into, or the node itself.
+  InterferenceNode* GetAlias() {
+    if (alias_ != this) {
+      alias_ = alias_->GetAlias();
+    }
+    return alias_;
+  }
+
+  // Merge `other` into this node.
+  void Absorb(InterferenceNode* other) {
+    DCHECK_NE(this, other);
+    other->alias_ = this;
+    other->stage_ = NodeStage::kCoalesced;
+    if (!IsPrecolored()) {
+      coalesce_opportunities_.insert(coalesce_opportunities_.end(),
+                                     other->coalesce_opportunities_.begin(),
+                                     other->coalesce_opportunities_.end());
+      requires_color_ = requires_color_ || other->requires_color_;
+      crosses_call_ = crosses_call_ || other->crosses_call_;
+      use_weight_ += other->use_weight_;
+      length_ += other->length_;
+    }
+  }
+
+  bool RequiresColor() const { return requires_color_; }
+  bool CrossesCall() const { return crosses_call_; }
+
+  // Nodes with a low spill weight are the first candidates for spilling.
+  float GetSpillWeight() const {
+    if (requires_color_ || length_ == 0) {
+      return std::numeric_limits<float>::max();
+    }
+    return use_weight_ / length_;
+  }
+
+ private:
+  LiveInterval* const interval_;
+  NodeStage stage_;
+  ArenaVector<InterferenceNode*> adjacent_nodes_;
+  ArenaVector<CoalesceOpportunity*> coalesce_opportunities_;
+  size_t out_degree_;
+  InterferenceNode* alias_;
+  int color_;
+  bool requires_color_;
+  bool crosses_call_;
+  float use_weight_;
+  size_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(InterferenceNode);
+};
+
+static bool CompareCoalesceOpportunities(const CoalesceOpportunity* lhs,
+                                         const CoalesceOpportunity* rhs) {
+  return lhs->GetPriority() < rhs->GetPriority();
+}
+
+static bool CompareSpillWeights(const InterferenceNode* lhs, const InterferenceNode* rhs) {
+  return lhs->GetSpillWeight() > rhs->GetSpillWeight();
+}
+
+// One attempt at coloring the intervals of a given register kind: builds the
+// interference graph, prunes it with iterated coalescing, and assigns colors.
+class ColoringIteration {
+ public:
+  ColoringIteration(RegisterAllocatorGraphColor* register_allocator,
+                    ArenaAllocator* allocator,
+                    bool processing_core_regs,
+                    size_t num_regs)
+      : register_allocator_(register_allocator),
+        allocator_(allocator),
+        processing_core_regs_(processing_core_regs),
+        num_regs_(num_regs),
+        interval_nodes_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        physical_nodes_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        interval_node_map_(std::less<LiveInterval*>(),
+                           allocator->Adapter(kArenaAllocRegisterAllocator)),
+        simplify_worklist_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        freeze_worklist_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        spill_worklist_(CompareSpillWeights,
+                        ArenaVector<InterferenceNode*>(
+                            allocator->Adapter(kArenaAllocRegisterAllocator))),
+        coalesce_worklist_(CompareCoalesceOpportunities,
+                           ArenaVector<CoalesceOpportunity*>(
+                               allocator->Adapter(kArenaAllocRegisterAllocator))),
+        pruned_nodes_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        failed_nodes_(allocator->Adapter(kArenaAllocRegisterAllocator)) {}
+
+  // Create a node for each interval of `intervals` and for each physical
+  // register interval, and connect the nodes whose intervals intersect.
+  void BuildInterferenceGraph(const ArenaVector<LiveInterval*>& intervals,
+                              const ArenaVector<LiveInterval*>& physical_intervals);
+
+  // Record the moves which could be eliminated by coalescing nodes.
+  void FindCoalesceOpportunities();
+
+  // Remove nodes from the graph one by one, coalescing nodes along the way.
+  void PruneInterferenceGraph();
+
+  // Color the nodes in the reverse order of pruning. Returns whether all
+  // nodes could be colored.
+  bool ColorInterferenceGraph();
+
+  const ArenaVector<InterferenceNode*>& GetIntervalNodes() const { return interval_nodes_; }
+
+  // Nodes which could not be colored by `ColorInterferenceGraph`.
+  const ArenaVector<InterferenceNode*>& GetFailedNodes() const { return failed_nodes_; }
+
+ private:
+  bool IsLowDegree(InterferenceNode* node) const {
+    return node->GetOutDegree() < num_regs_;
+  }
+
+  void AddEdge(InterferenceNode* a, InterferenceNode* b);
+  InterferenceNode* FindNode(LiveInterval* interval) const;
+  void CreateCoalesceOpportunity(LiveInterval* a, LiveInterval* b, float priority);
+  void CreateCoalesceOpportunity(InterferenceNode* a, InterferenceNode* b, float priority);
+
+  // Whether `node` has coalesce opportunities which are still being considered.
+  bool IsMoveRelated(InterferenceNode* node) const;
+
+  // Whether `node` interferes with a node of color `color`.
+  bool InterferesWithColor(InterferenceNode* node, int color) const;
+  bool Interferes(InterferenceNode* a, InterferenceNode* b) const;
+
+  void PushToWorklist(InterferenceNode* node);
+  void PruneNode(InterferenceNode* node);
+  void DecrementDegree(InterferenceNode* node);
+  void EnableCoalesceOpportunities(InterferenceNode* node);
+  void FreezeMoves(InterferenceNode* node);
+  void AddToSimplifyIfDone(InterferenceNode* node);
+
+  // Briggs test, for two uncolored nodes.
+  bool CanCoalesceConservatively(InterferenceNode* a, InterferenceNode* b) const;
+
+  // George test, for a precolored node `into` and an uncolored node `from`.
+  bool CanCoalesceIntoPrecolored(InterferenceNode* from, InterferenceNode* into) const;
+
+  void Combine(InterferenceNode* from, InterferenceNode* into);
+  void Coalesce(CoalesceOpportunity* opportunity);
+
+  // Returns a free register, preferring caller-save registers unless `crosses_call`.
+  int FindFreeColor(const std::bitset<kMaxNumRegs>& conflicts, bool crosses_call) const;
+
+  RegisterAllocatorGraphColor* const register_allocator_;
+  ArenaAllocator* const allocator_;
+  const bool processing_core_regs_;
+
+  // Number of registers which can be allocated for this register kind.
+  const size_t num_regs_;
+
+  ArenaVector<InterferenceNode*> interval_nodes_;
+
+  // Precolored nodes for physical registers, indexed by register.
+  ArenaVector<InterferenceNode*> physical_nodes_;
+
+  ArenaSafeMap<LiveInterval*, InterferenceNode*> interval_node_map_;
+
+  // Worklists. Nodes may remain in a worklist after changing stage; such
+  // entries are skipped when popped.
+  ArenaVector<InterferenceNode*> simplify_worklist_;
+  ArenaVector<InterferenceNode*> freeze_worklist_;
+  std::priority_queue<InterferenceNode*,
+                      ArenaVector<InterferenceNode*>,
+                      decltype(&CompareSpillWeights)> spill_worklist_;
+  std::priority_queue<CoalesceOpportunity*,
+                      ArenaVector<CoalesceOpportunity*>,
+                      decltype(&CompareCoalesceOpportunities)> coalesce_worklist_;
+
+  // The select stack.
+  ArenaVector<InterferenceNode*> pruned_nodes_;
+
+  ArenaVector<InterferenceNode*> failed_nodes_;
+
+  DISALLOW_COPY_AND_ASSIGN(ColoringIteration);
+};
+
+void ColoringIteration::AddEdge(InterferenceNode* a, InterferenceNode* b) {
+  if (!a->IsPrecolored()) {
+    a->AddInterference(b);
+  }
+  if (!b->IsPrecolored()) {
+    b->AddInterference(a);
+  }
+}
+
+void ColoringIteration::BuildInterferenceGraph(
+    const ArenaVector<LiveInterval*>& intervals,
+    const ArenaVector<LiveInterval*>& physical_intervals) {
+  ArenaVector<InterferenceNode*> sorted_nodes(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (LiveInterval* interval : intervals) {
+    InterferenceNode* node = new (allocator_) InterferenceNode(allocator_, interval);
+    interval_nodes_.push_back(node);
+    interval_node_map_.Put(interval, node);
+    sorted_nodes.push_back(node);
+  }
+  physical_nodes_.resize(physical_intervals.size(), nullptr);
+  for (size_t reg = 0; reg < physical_intervals.size(); ++reg) {
+    LiveInterval* fixed = physical_intervals[reg];
+    if (fixed != nullptr) {
+      InterferenceNode* node = new (allocator_) InterferenceNode(allocator_, fixed);
+      physical_nodes_[reg] = node;
+      sorted_nodes.push_back(node);
+    }
+  }
+
+  // Sweep over the intervals in order of start position, keeping track of the
+  // intervals which may still intersect the current one.
+  std::sort(sorted_nodes.begin(), sorted_nodes.end(),
+            [](const InterferenceNode* lhs, const InterferenceNode* rhs) {
+              return lhs->GetInterval()->GetStart() < rhs->GetInterval()->GetStart();
+            });
+  ArenaVector<InterferenceNode*> live(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (InterferenceNode* node : sorted_nodes) {
+    LiveInterval* interval = node->GetInterval();
+    size_t start = interval->GetStart();
+    live.erase(std::remove_if(live.begin(),
+                              live.end(),
+                              [start](const InterferenceNode* other) {
+                                return other->GetInterval()->GetEnd() <= start;
+                              }),
+               live.end());
+    for (InterferenceNode* other : live) {
+      if (node->IsPrecolored() && other->IsPrecolored()) {
+        continue;
+      }
+      LiveInterval* other_interval = other->GetInterval();
+      if (RangesIntersect(interval, other_interval)
+          && !CanShareInputRegister(interval, other_interval)
+          && !CanShareInputRegister(other_interval, interval)) {
+        AddEdge(node, other);
+      }
+    }
+    live.push_back(node);
+  }
+}
+
+InterferenceNode* ColoringIteration::FindNode(LiveInterval* interval) const {
+  if (interval == nullptr) {
+    return nullptr;
+  }
+  auto it = interval_node_map_.find(interval);
+  return it == interval_node_map_.end() ? nullptr : it->second;
+}
+
+void ColoringIteration::CreateCoalesceOpportunity(LiveInterval* a,
+                                                  LiveInterval* b,
+                                                  float priority) {
+  CreateCoalesceOpportunity(FindNode(a), FindNode(b), priority);
+}
+
+void ColoringIteration::CreateCoalesceOpportunity(InterferenceNode* a,
+                                                  InterferenceNode* b,
+                                                  float priority) {
+  if (a == nullptr || b == nullptr || a == b || (a->IsPrecolored() && b->IsPrecolored())) {
+    return;
+  }
+  CoalesceOpportunity* opportunity = new (allocator_) CoalesceOpportunity(a, b, priority);
+  a->AddCoalesceOpportunity(opportunity);
+  b->AddCoalesceOpportunity(opportunity);
+  coalesce_worklist_.push(opportunity);
+}
+
+void ColoringIteration::FindCoalesceOpportunities() {
+  const SsaLivenessAnalysis& liveness = register_allocator_->liveness_;
+
+  for (InterferenceNode* node : interval_nodes_) {
+    LiveInterval* interval = node->GetInterval();
+    if (interval->IsTemp()) {
+      continue;
+    }
+
+    // Adjacent siblings within a block are connected by a move.
+    LiveInterval* next_sibling = interval->GetNextSibling();
+    if (next_sibling != nullptr && interval->GetEnd() == next_sibling->GetStart()) {
+      size_t position = next_sibling->GetStart();
+      HBasicBlock* block = liveness.GetBlockFromPosition(position / 2);
+      CreateCoalesceOpportunity(node, FindNode(next_sibling), ComputeBlockWeight(*block));
+    }
+
+    HInstruction* defined_by = interval->GetDefinedBy();
+    if (!interval->IsParent() || defined_by == nullptr) {
+      continue;
+    }
+    LocationSummary* locations = defined_by->GetLocations();
+    size_t position = defined_by->GetLifetimePosition();
+    float weight = ComputeBlockWeight(*defined_by->GetBlock());
+    Location out = locations->Out();
+    for (size_t i = 0, e = defined_by->InputCount(); i < e; ++i) {
+      LiveInterval* input = defined_by->InputAt(i)->GetLiveInterval();
+      if (input == nullptr || IsCoreInterval(input) != processing_core_regs_) {
+        continue;
+      }
+      Location in = locations->InAt(i);
+      if (i == 0 && out.IsUnallocated() && out.GetPolicy() == Location::kSameAsFirstInput) {
+        // The input is moved to the output location before the instruction.
+        CreateCoalesceOpportunity(input->GetSiblingAt(position - 1), interval, weight);
+      } else if (in.IsRegister() || in.IsFpuRegister()) {
+        // The input is moved to a fixed register before the instruction.
+        CreateCoalesceOpportunity(
+            FindNode(input->GetSiblingAt(position - 1)), physical_nodes_[in.reg()], weight);
+      } else if (in.IsUnallocated()) {
+        LiveInterval* sibling = input->GetSiblingAt(position);
+        if (sibling != nullptr && CanShareInputRegister(interval, sibling)) {
+          CreateCoalesceOpportunity(sibling, interval, weight);
+        }
+      }
+    }
+  }
+
+  // Values flowing along control flow edges, including phi inputs, are connected by moves.
+  for (HLinearOrderIterator it(*register_allocator_->codegen_->GetGraph());
+       !it.Done();
+       it.Advance()) {
+    HBasicBlock* block = it.Current();
+    if (block->IsCatchBlock() ||
+        (block->IsLoopHeader() && block->GetLoopInformation()->IsIrreducible())) {
+      // Values live at the entry of these blocks are spilled.
+      continue;
+    }
+    size_t to_position = block->GetLifetimeStart();
+    const ArenaVector<HBasicBlock*>& predecessors = block->GetPredecessors();
+    for (size_t i = 0, e = predecessors.size(); i < e; ++i) {
+      HBasicBlock* predecessor = predecessors[i];
+      size_t from_position = predecessor->GetLifetimeEnd() - 1;
+      float weight = ComputeBlockWeight(*predecessor);
+      for (uint32_t idx : liveness.GetLiveInSet(*block)->Indexes()) {
+        LiveInterval* parent = liveness.GetInstructionFromSsaIndex(idx)->GetLiveInterval();
+        if (IsCoreInterval(parent) != processing_core_regs_) {
+          continue;
+        }
+        LiveInterval* from = parent->GetSiblingAt(from_position);
+        LiveInterval* to = parent->GetSiblingAt(to_position);
+        if (from != to) {
+          CreateCoalesceOpportunity(from, to, weight);
+        }
+      }
+      for (HInstructionIterator phi_it(block->GetPhis()); !phi_it.Done(); phi_it.Advance()) {
+        HInstruction* phi = phi_it.Current();
+        LiveInterval* interval = phi->GetLiveInterval();
+        if (interval == nullptr || IsCoreInterval(interval) != processing_core_regs_) {
+          continue;
+        }
+        LiveInterval* input = phi->InputAt(i)->GetLiveInterval();
+        CreateCoalesceOpportunity(input->GetSiblingAt(from_position),
+                                  interval->GetSiblingAt(to_position),
+                                  weight);
+      }
+    }
+  }
+}
+
+bool ColoringIteration::IsMoveRelated(InterferenceNode* node) const {
+  for (CoalesceOpportunity* opportunity : node->GetCoalesceOpportunities()) {
+    if (opportunity->GetStage() == CoalesceStage::kWorklist
+        || opportunity->GetStage() == CoalesceStage::kActive) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ColoringIteration::InterferesWithColor(InterferenceNode* node, int color) const {
+  DCHECK(!node->IsPrecolored());
+  for (InterferenceNode* adjacent : node->GetAdjacentNodes()) {
+    InterferenceNode* alias = adjacent->GetAlias();
+    if (alias->IsPrecolored() && alias->GetColor() == color) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ColoringIteration::Interferes(InterferenceNode* a, InterferenceNode* b) const {
+  if (a->IsPrecolored()) {
+    return InterferesWithColor(b, a->GetColor());
+  } else if (b->IsPrecolored()) {
+    return InterferesWithColor(a, b->GetColor());
+  } else {
+    return a->ContainsInterference(b);
+  }
+}
+
+void ColoringIteration::PushToWorklist(InterferenceNode* node) {
+  DCHECK(!node->IsPrecolored());
+  if (!IsLowDegree(node)) {
+    node->SetStage(NodeStage::kSpillWorklist);
+    spill_worklist_.push(node);
+  } else if (IsMoveRelated(node)) {
+    node->SetStage(NodeStage::kFreezeWorklist);
+    freeze_worklist_.push_back(node);
+  } else {
+    node->SetStage(NodeStage::kSimplifyWorklist);
+    simplify_worklist_.push_back(node);
+  }
+}
+
+void ColoringIteration::EnableCoalesceOpportunities(InterferenceNode* node) {
+  for (CoalesceOpportunity* opportunity : node->GetCoalesceOpportunities()) {
+    if (opportunity->GetStage() == CoalesceStage::kActive) {
+      opportunity->SetStage(CoalesceStage::kWorklist);
+      coalesce_worklist_.push(opportunity);
+    }
+  }
+}
+
+void ColoringIteration::DecrementDegree(InterferenceNode* node) {
+  if (node->IsPrecolored()) {
+    return;
+  }
+  node->DecrementOutDegree();
+  if (node->GetOutDegree() == num_regs_ - 1) {
+    // The node just became low degree: moves involving it or its neighbors
+    // may now pass the coalescing tests.
+    EnableCoalesceOpportunities(node);
+    for (InterferenceNode* adjacent : node->GetAdjacentNodes()) {
+      if (adjacent->IsInGraph() && !adjacent->IsPrecolored()) {
+        EnableCoalesceOpportunities(adjacent);
+      }
+    }
+    if (node->GetStage() == NodeStage::kSpillWorklist) {
+      PushToWorklist(node);
+    }
+  }
+}
+
+void ColoringIteration::PruneNode(InterferenceNode* node) {
+  DCHECK(!node->IsPrecolored());
+  node->SetStage(NodeStage::kPruned);
+  pruned_nodes_.push_back(node);
+  for (InterferenceNode* adjacent : node->GetAdjacentNodes()) {
+    if (adjacent->IsInGraph()) {
+      DecrementDegree(adjacent);
+    }
+  }
+}
+
+void ColoringIteration::AddToSimplifyIfDone(InterferenceNode* node) {
+  if (node->GetStage() == NodeStage::kFreezeWorklist
+      && !IsMoveRelated(node)
+      && IsLowDegree(node)) {
+    node->SetStage(NodeStage::kSimplifyWorklist);
+    simplify_worklist_.push_back(node);
+  }
+}
+
+void ColoringIteration::FreezeMoves(InterferenceNode* node) {
+  for (CoalesceOpportunity* opportunity : node->GetCoalesceOpportunities()) {
+    if (opportunity->GetStage() != CoalesceStage::kWorklist
+        && opportunity->GetStage() != CoalesceStage::kActive) {
+      continue;
+    }
+    opportunity->SetStage(CoalesceStage::kFrozen);
+    InterferenceNode* a = opportunity->GetNodeA()->GetAlias();
+    InterferenceNode* b = opportunity->GetNodeB()->GetAlias();
+    InterferenceNode* other = (a == node) ? b : a;
+    if (!other->IsPrecolored()) {
+      AddToSimplifyIfDone(other);
+    }
+  }
+}
+
+bool ColoringIteration::CanCoalesceConservatively(InterferenceNode* a,
+                                                  InterferenceNode* b) const {
+  // Coalescing is safe if the merged node has fewer than `num_regs_` neighbors of
+  // high degree. Neighbors shared by both nodes are counted twice, which is conservative.
+  size_t high_degree_neighbors = 0;
+  for (InterferenceNode* node : {a, b}) {
+    for (InterferenceNode* adjacent : node->GetAdjacentNodes()) {
+      if (adjacent->IsInGraph() && !IsLowDegree(adjacent)) {
+        ++high_degree_neighbors;
+      }
+    }
+  }
+  return high_degree_neighbors < num_regs_;
+}
+
+bool ColoringIteration::CanCoalesceIntoPrecolored(InterferenceNode* from,
+                                                  InterferenceNode* into) const {
+  DCHECK(into->IsPrecolored());
+  // Coalescing is safe if every neighbor of `from` either has low degree or already
+  // interferes with the color of `into`.
+  for (InterferenceNode* adjacent : from->GetAdjacentNodes()) {
+    if (!adjacent->IsInGraph() || adjacent->IsPrecolored() || IsLowDegree(adjacent)) {
+      continue;
+    }
+    if (!InterferesWithColor(adjacent, into->GetColor())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ColoringIteration::Combine(InterferenceNode* from, InterferenceNode* into) {
+  into->Absorb(from);
+  for (InterferenceNode* adjacent : from->GetAdjacentNodes()) {
+    if (!adjacent->IsInGraph()) {
+      continue;
+    }
+    if (!adjacent->IsPrecolored() && !adjacent->ContainsInterference(into)) {
+      adjacent->AddInterference(into);
+      if (!into->IsPrecolored()) {
+        into->AddInterference(adjacent);
+      }
+    } else if (adjacent->IsPrecolored() && !into->IsPrecolored()
+               && !into->ContainsInterference(adjacent)) {
+      into->AddInterference(adjacent);
+    }
+    // `adjacent` lost `from` as a neighbor.
+    DecrementDegree(adjacent);
+  }
+  if (!into->IsPrecolored()
+      && !IsLowDegree(into)
+      && into->GetStage() == NodeStage::kFreezeWorklist) {
+    into->SetStage(NodeStage::kSpillWorklist);
+    spill_worklist_.push(into);
+  }
+}
+
+void ColoringIteration::Coalesce(CoalesceOpportunity* opportunity) {
+  InterferenceNode* into = opportunity->GetNodeA()->GetAlias();
+  InterferenceNode* from = opportunity->GetNodeB()->GetAlias();
+  if (from->IsPrecolored()) {
+    std::swap(into, from);
+  }
+
+  if (into == from) {
+    opportunity->SetStage(CoalesceStage::kCoalesced);
+    if (!into->IsPrecolored()) {
+      AddToSimplifyIfDone(into);
+    }
+  } else if (from->IsPrecolored() || Interferes(into, from)) {
+    opportunity->SetStage(CoalesceStage::kConstrained);
+    if (!into->IsPrecolored()) {
+      AddToSimplifyIfDone(into);
+    }
+    if (!from->IsPrecolored()) {
+      AddToSimplifyIfDone(from);
+    }
+  } else if (into->IsPrecolored()
+             ? CanCoalesceIntoPrecolored(from, into)
+             : CanCoalesceConservatively(into, from)) {
+    opportunity->SetStage(CoalesceStage::kCoalesced);
+    Combine(from, into);
+    if (!into->IsPrecolored()) {
+      AddToSimplifyIfDone(into);
+    }
+  } else {
+    opportunity->SetStage(CoalesceStage::kActive);
+  }
+}
+
+void ColoringIteration::PruneInterferenceGraph() {
+  for (InterferenceNode* node : interval_nodes_) {
+    if (!node->IsPrecolored()) {
+      PushToWorklist(node);
+    }
+  }
+
+  while (true) {
+    if (!simplify_worklist_.empty()) {
+      InterferenceNode* node = simplify_worklist_.back();
+      simplify_worklist_.pop_back();
+      if (node->GetStage() == NodeStage::kSimplifyWorklist) {
+        PruneNode(node);
+      }
+    } else if (!coalesce_worklist_.empty()) {
+      CoalesceOpportunity* opportunity = coalesce_worklist_.top();
+      coalesce_worklist_.pop();
+      if (opportunity->GetStage() == CoalesceStage::kWorklist) {
+        Coalesce(opportunity);
+      }
+    } else if (!freeze_worklist_.empty()) {
+      // Give up coalescing a low degree node, so that it can be simplified.
+      InterferenceNode* node = freeze_worklist_.back();
+      freeze_worklist_.pop_back();
+      if (node->GetStage() == NodeStage::kFreezeWorklist) {
+        node->SetStage(NodeStage::kSimplifyWorklist);
+        simplify_worklist_.push_back(node);
+        FreezeMoves(node);
+      }
+    } else if (!spill_worklist_.empty()) {
+      // Optimistically select the node with the lowest spill weight for simplification.
+      InterferenceNode* node = spill_worklist_.top();
+      spill_worklist_.pop();
+      if (node->GetStage() == NodeStage::kSpillWorklist) {
+        node->SetStage(NodeStage::kSimplifyWorklist);
+        simplify_worklist_.push_back(node);
+        FreezeMoves(node);
+      }
+    } else {
+      break;
+    }
+  }
+}
+
+int ColoringIteration::FindFreeColor(const std::bitset<kMaxNumRegs>& conflicts,
+                                     bool crosses_call) const {
+  size_t number_of_registers = processing_core_regs_
+      ? register_allocator_->codegen_->GetNumberOfCoreRegisters()
+      : register_allocator_->codegen_->GetNumberOfFloatingPointRegisters();
+  // Intervals live across calls are already prevented from using caller-save
+  // registers. Other intervals prefer caller-save registers, which do not need
+  // to be saved in the frame entry.
+  if (!crosses_call) {
+    for (size_t reg = 0; reg < number_of_registers; ++reg) {
+      if (!conflicts.test(reg) && register_allocator_->IsCallerSave(reg, processing_core_regs_)) {
+        return static_cast<int>(reg);
+      }
+    }
+  }
+  for (size_t reg = 0; reg < number_of_registers; ++reg) {
+    if (!conflicts.test(reg)) {
+      return static_cast<int>(reg);
+    }
+  }
+  return kNoColor;
+}
+
+bool ColoringIteration::ColorInterferenceGraph() {
+  CodeGenerator* codegen = register_allocator_->codegen_;
+  size_t number_of_registers = processing_core_regs_
+      ? codegen->GetNumberOfCoreRegisters()
+      : codegen->GetNumberOfFloatingPointRegisters();
+  const bool* blocked_registers = processing_core_regs_
+      ? codegen->GetBlockedCoreRegisters()
+      : codegen->GetBlockedFloatingPointRegisters();
+  DCHECK_LE(number_of_registers, kMaxNumRegs);
+
+  bool successful = true;
+  while (!pruned_nodes_.empty()) {
+    InterferenceNode* node = pruned_nodes_.back();
+    pruned_nodes_.pop_back();
+
+    std::bitset<kMaxNumRegs> conflicts;
+    for (size_t reg = 0; reg < number_of_registers; ++reg) {
+      if (blocked_registers[reg]) {
+        conflicts.set(reg);
+      }
+    }
+    for (InterferenceNode* adjacent : node->GetAdjacentNodes()) {
+      InterferenceNode* alias = adjacent->GetAlias();
+      if (alias->HasColor()) {
+        conflicts.set(alias->GetColor());
+      }
+    }
+
+    // Prefer the color of a node this node is moved to or from, starting with
+    // the most expensive move.
+    int color = kNoColor;
+    float best_priority = 0.0f;
+    for (CoalesceOpportunity* opportunity : node->GetCoalesceOpportunities()) {
+      InterferenceNode* a = opportunity->GetNodeA()->GetAlias();
+      InterferenceNode* b = opportunity->GetNodeB()->GetAlias();
+      InterferenceNode* other = (a == node) ? b : a;
+      if (other != node
+          && other->HasColor()
+          && !conflicts.test(other->GetColor())
+          && (color == kNoColor || opportunity->GetPriority() > best_priority)) {
+        color = other->GetColor();
+        best_priority = opportunity->GetPriority();
+      }
+    }
+    if (color == kNoColor) {
+      color = FindFreeColor(conflicts, node->CrossesCall());
+    }
+
+    if (color == kNoColor) {
+      failed_nodes_.push_back(node);
+      successful = false;
+    } else {
+      node->SetColor(color);
+    }
+  }
+  return successful;
+}
+
+RegisterAllocatorGraphColor::RegisterAllocatorGraphColor(ArenaAllocator* allocator,
+                                                         CodeGenerator* codegen,
+                                                         const SsaLivenessAnalysis& liveness,
+                                                         OptimizingCompilerStats* stats,
+                                                         bool iterative_move_coalescing)
+      : RegisterAllocator(allocator, codegen, liveness, stats),
+        core_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        fp_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        temp_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        safepoints_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        physical_core_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        physical_fp_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        int_spill_slot_counter_(0),
+        double_spill_slot_counter_(0),
+        float_spill_slot_counter_(0),
+        long_spill_slot_counter_(0),
+        catch_phi_spill_slot_counter_(0),
+        reserved_out_slots_(InstructionSetPointerSize(codegen->GetInstructionSet()) / kVRegSize
+                            + codegen->GetGraph()->GetMaximumNumberOfOutVRegs()),
+        max_safepoint_live_core_regs_(0),
+        max_safepoint_live_fp_regs_(0),
+        iterative_move_coalescing_(iterative_move_coalescing) {
+  // The graph coloring allocator does not handle register pairs.
+  DCHECK(!codegen->NeedsTwoRegisters(Primitive::kPrimLong));
+  DCHECK(!codegen->NeedsTwoRegisters(Primitive::kPrimDouble));
+
+  codegen->SetupBlockedRegisters();
+  physical_core_intervals_.resize(codegen->GetNumberOfCoreRegisters(), nullptr);
+  physical_fp_intervals_.resize(codegen->GetNumberOfFloatingPointRegisters(), nullptr);
+}
+
+void RegisterAllocatorGraphColor::AllocateRegisters() {
+  ProcessInstructions();
+
+  for (bool processing_core_regs : {true, false}) {
+    bool coalesce = iterative_move_coalescing_;
+    while (!TryColoring(processing_core_regs, coalesce)) {
+      // Coalescing can prevent intervals which require a register from being
+      // colored; retry without it once intervals have been split.
+      coalesce = false;
+    }
+  }
+
+  ComputeMaxSafepointLiveRegisters();
+  AllocateSpillSlots();
+
+  RegisterAllocationResolver(allocator_, codegen_, liveness_, stats_)
+      .Resolve(max_safepoint_live_core_regs_,
+               max_safepoint_live_fp_regs_,
+               reserved_out_slots_,
+               int_spill_slot_counter_,
+               long_spill_slot_counter_,
+               float_spill_slot_counter_,
+               double_spill_slot_counter_,
+               catch_phi_spill_slot_counter_,
+               temp_intervals_);
+
+  if (kIsDebugBuild) {
+    Validate(/* log_fatal_on_failure */ true);
+    // Check that the linear order is still correct with regards to lifetime positions.
+    ValidateLinearOrder();
+  }
+}
+
+bool RegisterAllocatorGraphColor::TryColoring(bool processing_core_regs, bool coalesce) {
+  ArenaVector<LiveInterval*>& intervals = processing_core_regs ? core_intervals_ : fp_intervals_;
+  const ArenaVector<LiveInterval*>& physical_intervals = processing_core_regs
+      ? physical_core_intervals_
+      : physical_fp_intervals_;
+  size_t number_of_registers = processing_core_regs
+      ? codegen_->GetNumberOfCoreRegisters()
+      : codegen_->GetNumberOfFloatingPointRegisters();
+  const bool* blocked_registers = processing_core_regs
+      ? codegen_->GetBlockedCoreRegisters()
+      : codegen_->GetBlockedFloatingPointRegisters();
+  size_t number_of_available_registers = 0;
+  for (size_t reg = 0; reg < number_of_registers; ++reg) {
+    if (!blocked_registers[reg]) {
+      ++number_of_available_registers;
+    }
+  }
+
+  // Use a separate arena for each attempt, as failed attempts are thrown away.
+  ArenaAllocator coloring_allocator(allocator_->GetArenaPool());
+  ColoringIteration iteration(this,
+                              &coloring_allocator,
+                              processing_core_regs,
+                              number_of_available_registers);
+  iteration.BuildInterferenceGraph(intervals, physical_intervals);
+  if (coalesce) {
+    iteration.FindCoalesceOpportunities();
+  }
+  iteration.PruneInterferenceGraph();
+  if (iteration.ColorInterferenceGraph()) {
+    AssignRegisters(iteration, processing_core_regs);
+    return true;
+  }
+
+  // Coloring failed. Split the intervals of the nodes which could not be colored
+  // around their register uses. If a node only contains intervals which require
+  // a register, split its colored neighbors instead.
+  ArenaVector<LiveInterval*> to_split(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (InterferenceNode* node : iteration.GetIntervalNodes()) {
+    if (!node->GetAlias()->HasColor() && !node->RequiresColor()) {
+      to_split.push_back(node->GetInterval());
+    }
+  }
+  for (InterferenceNode* failed : iteration.GetFailedNodes()) {
+    if (failed->RequiresColor()) {
+      for (InterferenceNode* adjacent : failed->GetAdjacentNodes()) {
+        if (!adjacent->IsPrecolored() && !adjacent->RequiresColor()) {
+          to_split.push_back(adjacent->GetInterval());
+        }
+      }
+    }
+  }
+  if (to_split.empty()) {
+    LOG(FATAL) << "Not enough " << (processing_core_regs ? "core" : "floating point")
+               << " registers to color the interference graph";
+    UNREACHABLE();
+  }
+
+  std::sort(to_split.begin(), to_split.end());
+  to_split.erase(std::unique(to_split.begin(), to_split.end()), to_split.end());
+  intervals.erase(std::remove_if(intervals.begin(),
+                                 intervals.end(),
+                                 [&to_split](LiveInterval* interval) {
+                                   return std::binary_search(
+                                       to_split.begin(), to_split.end(), interval);
+                                 }),
+                  intervals.end());
+  for (LiveInterval* interval : to_split) {
+    SplitAtRegisterUses(interval, &intervals);
+  }
+  return false;
+}
+
+void RegisterAllocatorGraphColor::AssignRegisters(const ColoringIteration& iteration,
+                                                  bool processing_core_regs) {
+  for (InterferenceNode* node : iteration.GetIntervalNodes()) {
+    LiveInterval* interval = node->GetInterval();
+    int color = node->GetAlias()->GetColor();
+    DCHECK_NE(color, kNoColor);
+    if (interval->HasRegister()) {
+      DCHECK_EQ(interval->GetRegister(), color);
+    } else {
+      interval->SetRegister(color);
+    }
+    codegen_->AddAllocatedRegister(processing_core_regs
+        ? Location::RegisterLocation(color)
+        : Location::FpuRegisterLocation(color));
+  }
+}
+
+void RegisterAllocatorGraphColor::SplitAtRegisterUses(LiveInterval* interval,
+                                                      ArenaVector<LiveInterval*>* intervals) {
+  DCHECK(!interval->IsTemp());
+  DCHECK(!interval->HasRegister());
+  // The parts of `interval` outside of register windows stay in the spill slot.
+  LiveInterval* current = interval;
+  ForEachRegisterWindow(interval, [&](size_t start, size_t end) {
+    DCHECK(current != nullptr);
+    if (start > current->GetStart()) {
+      current = Split(current, start);
+    }
+    LiveInterval* window = current;
+    current = (end < current->GetEnd()) ? Split(current, end) : nullptr;
+    intervals->push_back(window);
+  });
+}
+
+void RegisterAllocatorGraphColor::ProcessInstructions() {
+  // Iterate post-order, so that the ranges of physical register intervals are
+  // complete for the positions after the instruction being processed.
+  for (HLinearPostOrderIterator it(*codegen_->GetGraph()); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    for (HBackwardInstructionIterator back_it(block->GetInstructions());
+         !back_it.Done();
+         back_it.Advance()) {
+      ProcessInstruction(back_it.Current());
+    }
+    for (HInstructionIterator inst_it(block->GetPhis()); !inst_it.Done(); inst_it.Advance()) {
+      ProcessInstruction(inst_it.Current());
+    }
+
+    if (block->IsCatchBlock() ||
+        (block->IsLoopHeader() && block->GetLoopInformation()->IsIrreducible())) {
+      // By blocking all registers at the top of each catch block or irreducible loop, we force
+      // intervals belonging to the live-in set of the catch/header block to be spilled.
+      size_t position = block->GetLifetimeStart();
+      BlockRegisters(position, position + 1);
+    }
+  }
+}
+
+void RegisterAllocatorGraphColor::ProcessInstruction(HInstruction* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  if (locations == nullptr) {
+    return;
+  }
+  size_t position = instruction->GetLifetimePosition();
+
+  CheckForTempLiveIntervals(instruction);
+
+  if (locations->NeedsSafepoint()) {
+    if (codegen_->IsLeafMethod()) {
+      // We do this here because we do not want the suspend check to artificially
+      // create live registers.
+      DCHECK(instruction->IsSuspendCheckEntry());
+      DCHECK_EQ(locations->GetTempCount(), 0u);
+      instruction->GetBlock()->RemoveInstruction(instruction);
+      return;
+    }
+    safepoints_.push_back(instruction);
+  }
+
+  if (locations->WillCall()) {
+    BlockRegisters(position, position + 1, /* caller_save_only */ true);
+  }
+
+  CheckForFixedInputs(instruction);
+
+  LiveInterval* interval = instruction->GetLiveInterval();
+  if (interval == nullptr) {
+    return;
+  }
+  DCHECK(!interval->HasHighInterval());
+
+  AddSafepointsFor(instruction);
+  CheckForFixedOutput(instruction);
+
+  if (instruction->IsPhi() && instruction->AsPhi()->IsCatchPhi()) {
+    AllocateSpillSlotForCatchPhi(instruction->AsPhi());
+  }
+
+  ArenaVector<LiveInterval*>& intervals = IsCoreInterval(interval)
+      ? core_intervals_
+      : fp_intervals_;
+  if (interval->HasSpillSlot() || instruction->IsConstant()) {
+    // Split just before first register use.
+    size_t first_register_use = interval->FirstRegisterUse();
+    if (first_register_use != kNoLifetime) {
+      LiveInterval* split = SplitBetween(interval, interval->GetStart(), first_register_use - 1);
+      intervals.push_back(split);
+    } else {
+      // Nothing to do, we won't allocate a register for this value.
+    }
+  } else if (interval->HasRegister()) {
+    // The output of this instruction is in a fixed register. If the register is
+    // blocked later on, for instance by a call, only keep it until then.
+    LiveInterval* fixed = IsCoreInterval(interval)
+        ? physical_core_intervals_[interval->GetRegister()]
+        : physical_fp_intervals_[interval->GetRegister()];
+    size_t intersection = kNoLifetime;
+    if (fixed != nullptr) {
+      fixed->ResetSearchCache();
+      intersection = fixed->FirstIntersectionWith(interval);
+    }
+    intervals.push_back(interval);
+    if (intersection != kNoLifetime) {
+      DCHECK_GT(intersection, interval->GetStart());
+      intervals.push_back(SplitBetween(interval, interval->GetStart(), intersection));
+    }
+  } else {
+    intervals.push_back(interval);
+  }
+}
+
+void RegisterAllocatorGraphColor::CheckForTempLiveIntervals(HInstruction* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  size_t position = instruction->GetLifetimePosition();
+
+  for (size_t i = 0; i < locations->GetTempCount(); ++i) {
+    Location temp = locations->GetTemp(i);
+    if (temp.IsRegister() || temp.IsFpuRegister()) {
+      BlockRegister(temp, position, position + 1);
+      // Ensure that an explicit temporary register is marked as being allocated.
+      codegen_->AddAllocatedRegister(temp);
+    } else {
+      DCHECK(temp.IsUnallocated());
+      switch (temp.GetPolicy()) {
+        case Location::kRequiresRegister: {
+          LiveInterval* interval =
+              LiveInterval::MakeTempInterval(allocator_, Primitive::kPrimInt);
+          interval->AddTempUse(instruction, i);
+          core_intervals_.push_back(interval);
+          temp_intervals_.push_back(interval);
+          break;
+        }
+
+        case Location::kRequiresFpuRegister: {
+          LiveInterval* interval =
+              LiveInterval::MakeTempInterval(allocator_, Primitive::kPrimDouble);
+          interval->AddTempUse(instruction, i);
+          fp_intervals_.push_back(interval);
+          temp_intervals_.push_back(interval);
+          break;
+        }
+
+        default:
+          LOG(FATAL) << "Unexpected policy for temporary location "
+                     << temp.GetPolicy();
+      }
+    }
+  }
+}
+
+void RegisterAllocatorGraphColor::CheckForFixedInputs(HInstruction* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  size_t position = instruction->GetLifetimePosition();
+  for (size_t i = 0; i < locations->GetInputCount(); ++i) {
+    Location input = locations->InAt(i);
+    if (input.IsRegister() || input.IsFpuRegister()) {
+      BlockRegister(input, position, position + 1);
+    } else {
+      DCHECK(!input.IsPair());
+    }
+  }
+}
+
+void RegisterAllocatorGraphColor::AddSafepointsFor(HInstruction* instruction) {
+  LiveInterval* interval = instruction->GetLiveInterval();
+  for (size_t safepoint_index = safepoints_.size(); safepoint_index > 0; --safepoint_index) {
+    HInstruction* safepoint = safepoints_[safepoint_index - 1u];
+    size_t safepoint_position = safepoint->GetLifetimePosition();
+
+    // Test that safepoints are ordered in the optimal way.
+    DCHECK(safepoint_index == safepoints_.size() ||
+           safepoints_[safepoint_index]->GetLifetimePosition() < safepoint_position);
+
+    if (safepoint_position == interval->GetStart()) {
+      // The safepoint is for this instruction, so the location of the instruction
+      // does not need to be saved.
+      DCHECK_EQ(safepoint_index, safepoints_.size());
+      DCHECK_EQ(safepoint, instruction);
+      continue;
+    } else if (interval->IsDeadAt(safepoint_position)) {
+      break;
+    } else if (!interval->Covers(safepoint_position)) {
+      // Hole in the interval.
+      continue;
+    }
+    interval->AddSafepoint(safepoint);
+  }
+  interval->ResetSearchCache();
+}
+
+void RegisterAllocatorGraphColor::CheckForFixedOutput(HInstruction* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  size_t position = instruction->GetLifetimePosition();
+  LiveInterval* interval = instruction->GetLiveInterval();
+
+  // Some instructions define their output in fixed register/stack slot. We need
+  // to ensure we know these locations before doing register allocation. For a
+  // given register, we create an interval that covers these locations. The register
+  // will be unavailable at these locations when trying to allocate one for an
+  // interval.
+  //
+  // The backwards walking ensures the ranges are ordered on increasing start positions.
+  Location output = locations->Out();
+  if (output.IsUnallocated() && output.GetPolicy() == Location::kSameAsFirstInput) {
+    Location first = locations->InAt(0);
+    if (first.IsRegister() || first.IsFpuRegister()) {
+      interval->SetFrom(position + 1);
+      interval->SetRegister(first.reg());
+    } else {
+      DCHECK(!first.IsPair());
+    }
+  } else if (output.IsRegister() || output.IsFpuRegister()) {
+    // Shift the interval's start by one to account for the blocked register.
+    interval->SetFrom(position + 1);
+    interval->SetRegister(output.reg());
+    BlockRegister(output, position, position + 1);
+  } else if (output.IsStackSlot() || output.IsDoubleStackSlot()) {
+    interval->SetSpillSlot(output.GetStackIndex());
+  } else {
+    DCHECK(output.IsUnallocated() || output.IsConstant());
+  }
+}
+
+void RegisterAllocatorGraphColor::BlockRegister(Location location, size_t start, size_t end) {
+  int reg = location.reg();
+  DCHECK(location.IsRegister() || location.IsFpuRegister());
+  LiveInterval* interval = location.IsRegister()
+      ? physical_core_intervals_[reg]
+      : physical_fp_intervals_[reg];
+  Primitive::Type type = location.IsRegister()
+      ? Primitive::kPrimInt
+      : Primitive::kPrimFloat;
+  if (interval == nullptr) {
+    interval = LiveInterval::MakeFixedInterval(allocator_, reg, type);
+    if (location.IsRegister()) {
+      physical_core_intervals_[reg] = interval;
+    } else {
+      physical_fp_intervals_[reg] = interval;
+    }
+  }
+  DCHECK(interval->GetRegister() == reg);
+  interval->AddRange(start, end);
+}
+
+void RegisterAllocatorGraphColor::BlockRegisters(size_t start, size_t end, bool caller_save_only) {
+  for (size_t i = 0; i < codegen_->GetNumberOfCoreRegisters(); ++i) {
+    if (!caller_save_only || !codegen_->IsCoreCalleeSaveRegister(i)) {
+      BlockRegister(Location::RegisterLocation(i), start, end);
+    }
+  }
+  for (size_t i = 0; i < codegen_->GetNumberOfFloatingPointRegisters(); ++i) {
+    if (!caller_save_only || !codegen_->IsFloatingPointCalleeSaveRegister(i)) {
+      BlockRegister(Location::FpuRegisterLocation(i), start, end);
+    }
+  }
+}
+
+bool RegisterAllocatorGraphColor::IsCallerSave(size_t reg, bool processing_core_regs) {
+  return processing_core_regs
+      ? !codegen_->IsCoreCalleeSaveRegister(reg)
+      : !codegen_->IsFloatingPointCalleeSaveRegister(reg);
+}
+
+void RegisterAllocatorGraphColor::ComputeMaxSafepointLiveRegisters() {
+  // Count, for each safepoint calling on the slow path, the registers which the
+  // slow path needs to save.
+  size_t number_of_positions = liveness_.GetMaxLifetimePosition() / 2 + 1;
+  ArenaVector<size_t> live_core_regs(number_of_positions,
+                                     0u,
+                                     allocator_->Adapter(kArenaAllocRegisterAllocator));
+  ArenaVector<size_t> live_fp_regs(number_of_positions,
+                                   0u,
+                                   allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (size_t i = 0, e = liveness_.GetNumberOfSsaValues(); i < e; ++i) {
+    LiveInterval* parent = liveness_.GetInstructionFromSsaIndex(i)->GetLiveInterval();
+    ArenaVector<size_t>& live_regs = IsCoreInterval(parent) ? live_core_regs : live_fp_regs;
+    for (LiveInterval* sibling = parent; sibling != nullptr; sibling = sibling->GetNextSibling()) {
+      if (!sibling->HasRegister()) {
+        continue;
+      }
+      for (SafepointPosition* safepoint = sibling->GetFirstSafepoint();
+           safepoint != nullptr;
+           safepoint = safepoint->GetNext()) {
+        if (safepoint->GetLocations()->OnlyCallsOnSlowPath()) {
+          size_t count = ++live_regs[safepoint->GetPosition() / 2];
+          size_t* max = IsCoreInterval(parent)
+              ? &max_safepoint_live_core_regs_
+              : &max_safepoint_live_fp_regs_;
+          *max = std::max(*max, count);
+        }
+      }
+    }
+  }
+}
+
+void RegisterAllocatorGraphColor::AllocateSpillSlots() {
+  // Collect the intervals which are not entirely in registers and need a spill slot.
+  ArenaVector<LiveInterval*> intervals(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (size_t i = 0, e = liveness_.GetNumberOfSsaValues(); i < e; ++i) {
+    HInstruction* instruction = liveness_.GetInstructionFromSsaIndex(i);
+    LiveInterval* parent = instruction->GetLiveInterval();
+    if (parent->HasSpillSlot()) {
+      continue;
+    }
+    bool needs_spill_slot = false;
+    for (LiveInterval* sibling = parent; sibling != nullptr; sibling = sibling->GetNextSibling()) {
+      if (!sibling->HasRegister()) {
+        needs_spill_slot = true;
+        break;
+      }
+    }
+    if (!needs_spill_slot) {
+      continue;
+    }
+
+    DCHECK(!instruction->IsPhi() || !instruction->AsPhi()->IsCatchPhi());
+    DCHECK(!IsVectorValue(parent)) << instruction->DebugName();
+    if (instruction->IsParameterValue()) {
+      // Parameters have their own stack slot.
+      parent->SetSpillSlot(codegen_->GetStackSlotOfParameter(instruction->AsParameterValue()));
+    } else if (instruction->IsCurrentMethod()) {
+      parent->SetSpillSlot(0);
+    } else if (!instruction->IsConstant()) {
+      // Constants don't need a spill slot.
+      intervals.push_back(parent);
+    }
+  }
+
+  // Assign slots greedily in order of start position, reusing a slot once the
+  // interval previously using it is dead, as the linear scan allocator does.
+  std::sort(intervals.begin(), intervals.end(),
+            [](const LiveInterval* lhs, const LiveInterval* rhs) {
+              return lhs->GetStart() < rhs->GetStart();
+            });
+  ArenaVector<size_t> int_spill_slots(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  ArenaVector<size_t> long_spill_slots(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  ArenaVector<size_t> float_spill_slots(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  ArenaVector<size_t> double_spill_slots(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (LiveInterval* parent : intervals) {
+    ArenaVector<size_t>* spill_slots = nullptr;
+    switch (parent->GetType()) {
+      case Primitive::kPrimDouble:
+        spill_slots = &double_spill_slots;
+        break;
+      case Primitive::kPrimLong:
+        spill_slots = &long_spill_slots;
+        break;
+      case Primitive::kPrimFloat:
+        spill_slots = &float_spill_slots;
+        break;
+      case Primitive::kPrimNot:
+      case Primitive::kPrimInt:
+      case Primitive::kPrimChar:
+      case Primitive::kPrimByte:
+      case Primitive::kPrimBoolean:
+      case Primitive::kPrimShort:
+        spill_slots = &int_spill_slots;
+        break;
+      case Primitive::kPrimVoid:
+        LOG(FATAL) << "Unexpected type for interval " << parent->GetType();
+    }
+
+    // Find an available spill slot.
+    size_t slot = 0;
+    for (size_t e = spill_slots->size(); slot < e; ++slot) {
+      if ((*spill_slots)[slot] <= parent->GetStart()
+          && (slot == (e - 1) || (*spill_slots)[slot + 1] <= parent->GetStart())) {
+        break;
+      }
+    }
+
+    size_t end = parent->GetLastSibling()->GetEnd();
+    if (parent->NeedsTwoSpillSlots()) {
+      if (slot + 2u > spill_slots->size()) {
+        // We need a new spill slot.
+        spill_slots->resize(slot + 2u, end);
+      }
+      (*spill_slots)[slot] = end;
+      (*spill_slots)[slot + 1] = end;
+    } else {
+      if (slot == spill_slots->size()) {
+        // We need a new spill slot.
+        spill_slots->push_back(end);
+      } else {
+        (*spill_slots)[slot] = end;
+      }
+    }
+
+    // Note that the exact spill slot location will be computed when we resolve,
+    // that is when we know the number of spill slots for each type.
+    parent->SetSpillSlot(slot);
+  }
+
+  int_spill_slot_counter_ = int_spill_slots.size();
+  long_spill_slot_counter_ = long_spill_slots.size();
+  float_spill_slot_counter_ = float_spill_slots.size();
+  double_spill_slot_counter_ = double_spill_slots.size();
+}
+
+void RegisterAllocatorGraphColor::AllocateSpillSlotForCatchPhi(HPhi* phi) {
+  LiveInterval* interval = phi->GetLiveInterval();
+
+  HInstruction* previous_phi = phi->GetPrevious();
+  DCHECK(previous_phi == nullptr ||
+         previous_phi->AsPhi()->GetRegNumber() <= phi->GetRegNumber())
+      << "Phis expected to be sorted by vreg number, so that equivalent phis are adjacent.";
+
+  if (phi->IsVRegEquivalentOf(previous_phi)) {
+    // This is an equivalent of the previous phi. We need to assign the same
+    // catch phi slot.
+    DCHECK(previous_phi->GetLiveInterval()->HasSpillSlot());
+    interval->SetSpillSlot(previous_phi->GetLiveInterval()->GetSpillSlot());
+  } else {
+    // Allocate a new spill slot for this catch phi.
+    // TODO: Reuse spill slots when intervals of phis from different catch
+    //       blocks do not overlap.
+    interval->SetSpillSlot(catch_phi_spill_slot_counter_);
+    catch_phi_spill_slot_counter_ += interval->NeedsTwoSpillSlots() ? 2 : 1;
+  }
+}
+
+bool RegisterAllocatorGraphColor::Validate(bool log_fatal_on_failure) {
+  for (bool processing_core_regs : {true, false}) {
+    ArenaVector<LiveInterval*> intervals(
+        allocator_->Adapter(kArenaAllocRegisterAllocatorValidate));
+    for (size_t i = 0; i < liveness_.GetNumberOfSsaValues(); ++i) {
+      HInstruction* instruction = liveness_.GetInstructionFromSsaIndex(i);
+      LiveInterval* interval = instruction->GetLiveInterval();
+      if (interval != nullptr && IsCoreInterval(interval) == processing_core_regs) {
+        intervals.push_back(interval);
+      }
+    }
+
+    const ArenaVector<LiveInterval*>& physical_intervals = processing_core_regs
+        ? physical_core_intervals_
+        : physical_fp_intervals_;
+    for (LiveInterval* fixed : physical_intervals) {
+      if (fixed != nullptr) {
+        intervals.push_back(fixed);
+      }
+    }
+
+    for (LiveInterval* temp : temp_intervals_) {
+      if (IsCoreInterval(temp) == processing_core_regs) {
+        intervals.push_back(temp);
+      }
+    }
+
+    size_t spill_slots = int_spill_slot_counter_
+                       + long_spill_slot_counter_
+                       + float_spill_slot_counter_
+                       + double_spill_slot_counter_
+                       + catch_phi_spill_slot_counter_;
+    bool ok = ValidateIntervals(intervals,
+                                spill_slots,
+                                reserved_out_slots_,
+                                *codegen_,
+                                allocator_,
+                                processing_core_regs,
+                                log_fatal_on_failure);
+    if (!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace art
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_REGISTER_ALLOCATOR_GRAPH_COLOR_H_
+#define ART_COMPILER_OPTIMIZING_REGISTER_ALLOCATOR_GRAPH_COLOR_H_
+
+#include "base/arena_containers.h"
+#include "base/macros.h"
+#include "register_allocator.h"
+
+namespace art {
+
+class CodeGenerator;
+class ColoringIteration;
+class HInstruction;
+class HPhi;
+class LiveInterval;
+class Location;
+class SsaLivenessAnalysis;
+
+/**
+ * A graph coloring register allocator.
+ *
+ * The algorithm proceeds as follows:
+ * (1) Live intervals are collected from the liveness analysis, and fixed or
+ *     temporary register requirements of instructions are recorded, exactly
+ *     as the linear scan allocator does.
+ * (2) For each register kind (core and floating point), an interference graph
+ *     is built over the live intervals. Nodes are live intervals; edges connect
+ *     intervals that are live at the same time. Physical registers blocked by
+ *     instructions are represented by precolored nodes.
+ * (3) Move-related intervals (split siblings, phis and their inputs, outputs
+ *     and the inputs they can share a register with) are recorded as coalesce
+ *     opportunities.
+ * (4) The graph is pruned by iterated register coalescing (George and Appel):
+ *     low-degree nodes are simplified, moves are conservatively coalesced
+ *     (Briggs and George tests), move-related nodes are frozen when nothing
+ *     else can be done, and the cheapest high-degree node is chosen as a
+ *     potential spill.
+ * (5) Nodes are popped off the select stack and colored optimistically.
+ *     Intervals which could not be colored are split around their register
+ *     uses (the remaining parts live in their spill slot), and steps (2) to
+ *     (5) are repeated until every interval requiring a register has one.
+ * (6) Spill slots are assigned, and the shared resolver inserts the moves.
+ *
+ * The allocator does not handle register pairs, so it is only used for
+ * instruction sets where every value fits in a single register.
+ */
+class RegisterAllocatorGraphColor : public RegisterAllocator {
+ public:
+  RegisterAllocatorGraphColor(ArenaAllocator* allocator,
+                              CodeGenerator* codegen,
+                              const SsaLivenessAnalysis& analysis,
+                              OptimizingCompilerStats* stats = nullptr,
+                              bool iterative_move_coalescing = true);
+  ~RegisterAllocatorGraphColor() OVERRIDE {}
+
+  void AllocateRegisters() OVERRIDE;
+
+  bool Validate(bool log_fatal_on_failure) OVERRIDE;
+
+ private:
+  // Collect all intervals and prepare for register allocation.
+  void ProcessInstructions();
+  void ProcessInstruction(HInstruction* instruction);
+
+  // Create synthesized intervals for the temporaries of an instruction.
+  void CheckForTempLiveIntervals(HInstruction* instruction);
+
+  // If any inputs require specific registers, block those registers
+  // at the position of this instruction.
+  void CheckForFixedInputs(HInstruction* instruction);
+
+  // Add all applicable safepoints to the live interval of an instruction.
+  // Depends on instructions being processed in reverse linear order.
+  void AddSafepointsFor(HInstruction* instruction);
+
+  // If the output of an instruction requires a specific register or stack
+  // slot, record it in the live interval of the instruction.
+  void CheckForFixedOutput(HInstruction* instruction);
+
+  // Ensure that the given register cannot be allocated for a given range.
+  void BlockRegister(Location location, size_t start, size_t end);
+  void BlockRegisters(size_t start, size_t end, bool caller_save_only = false);
+
+  bool IsCallerSave(size_t reg, bool processing_core_regs);
+
+  // Run one coloring attempt for the given register kind. Returns whether every
+  // interval got a register. On failure, intervals have been split so that the
+  // next attempt makes progress.
+  bool TryColoring(bool processing_core_regs, bool coalesce);
+
+  // Assign the colors found by a successful coloring attempt to the intervals.
+  void AssignRegisters(const ColoringIteration& iteration, bool processing_core_regs);
+
+  // Split `interval` around the positions where it needs a register, and add the
+  // resulting parts to `intervals`. The rest of the interval stays in its spill slot.
+  void SplitAtRegisterUses(LiveInterval* interval, ArenaVector<LiveInterval*>* intervals);
+
+  // Compute the maximum number of registers live at slow path safepoints.
+  void ComputeMaxSafepointLiveRegisters();
+
+  // Allocate spill slots for all intervals which are not entirely in registers.
+  void AllocateSpillSlots();
+
+  // Allocate a spill slot for the given catch phi. Will allocate the same slot
+  // for phis which share the same vreg. Must be called in reverse linear order
+  // of lifetime positions and ascending vreg numbers for correctness.
+  void AllocateSpillSlotForCatchPhi(HPhi* phi);
+
+  // Intervals to color, split by kind (core and floating point). Parts of
+  // intervals which are not in these lists stay in their spill slot.
+  ArenaVector<LiveInterval*> core_intervals_;
+  ArenaVector<LiveInterval*> fp_intervals_;
+
+  // Intervals for temporaries, saved for special handling in the resolution phase.
+  ArenaVector<LiveInterval*> temp_intervals_;
+
+  // Safepoints, saved for adding them to live intervals while processing instructions.
+  ArenaVector<HInstruction*> safepoints_;
+
+  // Fixed intervals for physical registers. Such intervals cover the positions
+  // where an instruction requires a specific register.
+  ArenaVector<LiveInterval*> physical_core_intervals_;
+  ArenaVector<LiveInterval*> physical_fp_intervals_;
+
+  // Allocated stack slot counters.
+  size_t int_spill_slot_counter_;
+  size_t double_spill_slot_counter_;
+  size_t float_spill_slot_counter_;
+  size_t long_spill_slot_counter_;
+  size_t catch_phi_spill_slot_counter_;
+
+  // Number of stack slots needed for the pointer to the current method and
+  // for outgoing arguments.
+  const size_t reserved_out_slots_;
+
+  // The maximum number of registers live at safe points. Needed by the code generator.
+  size_t max_safepoint_live_core_regs_;
+  size_t max_safepoint_live_fp_regs_;
+
+  // Whether moves should be coalesced. Intended for testing.
+  const bool iterative_move_coalescing_;
+
+  friend class ColoringIteration;
+
+  DISALLOW_COPY_AND_ASSIGN(RegisterAllocatorGraphColor);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_REGISTER_ALLOCATOR_GRAPH_COLOR_H_
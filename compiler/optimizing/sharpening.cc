@@ -25,6 +25,7 @@
 #include "gc/heap.h"
 #include "gc/space/image_space.h"
 #include "handle_scope-inl.h"
+#include "jit/jit.h"
 #include "mirror/dex_cache.h"
 #include "mirror/string.h"
 #include "nodes.h"
@@ -192,7 +193,13 @@ void HSharpening::ProcessLoadString(HLoadString* load_string) {
       // DCHECK(!codegen_->GetCompilerOptions().GetCompilePic());
       mirror::String* string = dex_cache->GetResolvedString(string_index);
       is_in_dex_cache = (string != nullptr);
-      if (string != nullptr && runtime->GetHeap()->ObjectIsInBootImageSpace(string)) {
+      if (runtime->GetJit()->UseCodeSnapshot()) {
+        // Code saved in a JitCodeSnapshot is reused by other processes, and cannot
+        // embed the address of the string or of the dex cache element, nor assume
+        // that the string is resolved there.
+        desired_load_kind = HLoadString::LoadKind::kDexCacheViaMethod;
+        is_in_dex_cache = false;
+      } else if (string != nullptr && runtime->GetHeap()->ObjectIsInBootImageSpace(string)) {
         desired_load_kind = HLoadString::LoadKind::kBootImageAddress;
         address = reinterpret_cast64<uint64_t>(string);
       } else {
@@ -201,7 +208,8 @@ void HSharpening::ProcessLoadString(HLoadString* load_string) {
         // loads the correct string and inlined frames are used correctly for OOM stack trace.
         // TODO: Write a test for this.
         desired_load_kind = HLoadString::LoadKind::kDexCacheAddress;
-        void* dex_cache_element_address = &dex_cache->GetStrings()[string_index];
+        void* dex_cache_element_address =
+            &dex_cache->GetStrings()[mirror::DexCache::StringSlotIndex(string_index)];
         address = reinterpret_cast64<uint64_t>(dex_cache_element_address);
       }
     } else {
@@ -224,6 +232,16 @@ void HSharpening::ProcessLoadString(HLoadString* load_string) {
       }
     }
   }
+  if (kUseHashedDexCache &&
+      (desired_load_kind == HLoadString::LoadKind::kDexCacheAddress ||
+       desired_load_kind == HLoadString::LoadKind::kDexCachePcRelative ||
+       desired_load_kind == HLoadString::LoadKind::kDexCacheViaMethod)) {
+    // The slot of the string in a hashed strings cache may hold another string at any time.
+    // The kDexCacheViaMethod code loads the slot as a whole and checks its string index, and
+    // resolves the string in the runtime on a mismatch.
+    desired_load_kind = HLoadString::LoadKind::kDexCacheViaMethod;
+    is_in_dex_cache = false;
+  }
   if (is_in_dex_cache) {
     load_string->MarkInDexCache();
   }
@@ -474,6 +474,44 @@ class X86_64Assembler FINAL : public Assembler {
   void orpd(XmmRegister dst, XmmRegister src);
   void orps(XmmRegister dst, XmmRegister src);
 
+  // Packed integer (SIMD) instructions.
+  void movdqu(XmmRegister dst, const Address& src);  // load unaligned
+  void movdqu(const Address& dst, XmmRegister src);  // store unaligned
+
+  void paddb(XmmRegister dst, XmmRegister src);
+  void paddw(XmmRegister dst, XmmRegister src);
+  void paddd(XmmRegister dst, XmmRegister src);
+  void paddq(XmmRegister dst, XmmRegister src);
+  void psubb(XmmRegister dst, XmmRegister src);
+  void psubw(XmmRegister dst, XmmRegister src);
+  void psubd(XmmRegister dst, XmmRegister src);
+  void psubq(XmmRegister dst, XmmRegister src);
+  void pmullw(XmmRegister dst, XmmRegister src);
+  void pmulld(XmmRegister dst, XmmRegister src);  // SSE4.1
+
+  void pminsd(XmmRegister dst, XmmRegister src);  // SSE4.1
+  void pmaxsd(XmmRegister dst, XmmRegister src);  // SSE4.1
+
+  void pand(XmmRegister dst, XmmRegister src);
+  void por(XmmRegister dst, XmmRegister src);
+  void pxor(XmmRegister dst, XmmRegister src);
+
+  void pcmpeqb(XmmRegister dst, XmmRegister src);
+
+  void pmovsxbd(XmmRegister dst, XmmRegister src);  // SSE4.1
+  void pmovsxbd(XmmRegister dst, const Address& src);  // SSE4.1
+  void pmovsxwd(XmmRegister dst, XmmRegister src);  // SSE4.1
+  void pmovsxwd(XmmRegister dst, const Address& src);  // SSE4.1
+  void pmovzxwd(XmmRegister dst, XmmRegister src);  // SSE4.1
+  void pmovzxwd(XmmRegister dst, const Address& src);  // SSE4.1
+
+  void punpcklbw(XmmRegister dst, XmmRegister src);
+  void punpcklwd(XmmRegister dst, XmmRegister src);
+  void punpckldq(XmmRegister dst, XmmRegister src);
+  void punpcklqdq(XmmRegister dst, XmmRegister src);
+
+  void pshufd(XmmRegister dst, XmmRegister src, const Immediate& imm);
+
   void flds(const Address& src);
   void fstps(const Address& dst);
   void fsts(const Address& dst);
@@ -552,6 +590,7 @@ class X86_64Assembler FINAL : public Assembler {
   void addl(CpuRegister reg, const Address& address);
   void addl(const Address& address, CpuRegister reg);
   void addl(const Address& address, const Immediate& imm);
+  void addw(const Address& address, const Immediate& imm);
 
   void addq(CpuRegister reg, const Immediate& imm);
   void addq(CpuRegister dst, CpuRegister src);
@@ -875,7 +914,13 @@ class X86_64Assembler FINAL : public Assembler {
 
   void EmitOperand(uint8_t rm, const Operand& operand);
   void EmitImmediate(const Immediate& imm);
-  void EmitComplex(uint8_t rm, const Operand& operand, const Immediate& immediate);
+  // Emit `imm` as a 16-bit immediate if `is_16_op`, for instructions with an operand size
+  // override prefix.
+  void EmitImmediate(const Immediate& imm, bool is_16_op);
+  void EmitComplex(uint8_t rm,
+                   const Operand& operand,
+                   const Immediate& immediate,
+                   bool is_16_op = false);
   void EmitLabel(Label* label, int instruction_size);
   void EmitLabelLink(Label* label);
   void EmitLabelLink(NearLabel* label);
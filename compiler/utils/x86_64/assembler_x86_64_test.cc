@@ -785,6 +785,34 @@ TEST_F(AssemblerX86_64Test, Cmpw) {
   DriverStr(expected, "cmpw");
 }
 
+TEST_F(AssemblerX86_64Test, CmpwImm16) {
+  GetAssembler()->cmpw(x86_64::Address(x86_64::CpuRegister(x86_64::RAX), 8),
+                       x86_64::Immediate(10000));
+  GetAssembler()->cmpw(x86_64::Address(x86_64::CpuRegister(x86_64::R9), 0),
+                       x86_64::Immediate(-300));
+  GetAssembler()->cmpw(x86_64::Address(x86_64::CpuRegister(x86_64::R14), 0),
+                       x86_64::Immediate(20000));
+  const char* expected =
+      "cmpw $10000, 8(%RAX)\n"
+      "cmpw $-300, 0(%R9)\n"
+      "cmpw $20000, 0(%R14)\n";
+  DriverStr(expected, "cmpw_imm16");
+}
+
+TEST_F(AssemblerX86_64Test, Addw) {
+  GetAssembler()->addw(x86_64::Address(x86_64::CpuRegister(x86_64::RAX), 18),
+                       x86_64::Immediate(1));
+  GetAssembler()->addw(x86_64::Address(x86_64::CpuRegister(x86_64::R11), 18),
+                       x86_64::Immediate(1));
+  GetAssembler()->addw(x86_64::Address(x86_64::CpuRegister(x86_64::R9), 0),
+                       x86_64::Immediate(10000));
+  const char* expected =
+      "addw $1, 18(%RAX)\n"
+      "addw $1, 18(%R11)\n"
+      "addw $10000, 0(%R9)\n";
+  DriverStr(expected, "addw");
+}
+
 TEST_F(AssemblerX86_64Test, MovqAddrImm) {
   GetAssembler()->movq(x86_64::Address(x86_64::CpuRegister(x86_64::RAX), 0),
                        x86_64::Immediate(-5));
@@ -1123,6 +1151,141 @@ TEST_F(AssemblerX86_64Test, Orpd) {
   DriverStr(RepeatFF(&x86_64::X86_64Assembler::orpd, "orpd %{reg2}, %{reg1}"), "orpd");
 }
 
+TEST_F(AssemblerX86_64Test, Paddb) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::paddb, "paddb %{reg2}, %{reg1}"), "paddb");
+}
+
+TEST_F(AssemblerX86_64Test, Paddw) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::paddw, "paddw %{reg2}, %{reg1}"), "paddw");
+}
+
+TEST_F(AssemblerX86_64Test, Paddd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::paddd, "paddd %{reg2}, %{reg1}"), "paddd");
+}
+
+TEST_F(AssemblerX86_64Test, Paddq) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::paddq, "paddq %{reg2}, %{reg1}"), "paddq");
+}
+
+TEST_F(AssemblerX86_64Test, Psubb) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::psubb, "psubb %{reg2}, %{reg1}"), "psubb");
+}
+
+TEST_F(AssemblerX86_64Test, Psubw) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::psubw, "psubw %{reg2}, %{reg1}"), "psubw");
+}
+
+TEST_F(AssemblerX86_64Test, Psubd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::psubd, "psubd %{reg2}, %{reg1}"), "psubd");
+}
+
+TEST_F(AssemblerX86_64Test, Psubq) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::psubq, "psubq %{reg2}, %{reg1}"), "psubq");
+}
+
+TEST_F(AssemblerX86_64Test, Pmullw) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmullw, "pmullw %{reg2}, %{reg1}"), "pmullw");
+}
+
+TEST_F(AssemblerX86_64Test, Pmulld) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmulld, "pmulld %{reg2}, %{reg1}"), "pmulld");
+}
+
+TEST_F(AssemblerX86_64Test, Pminsd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pminsd, "pminsd %{reg2}, %{reg1}"), "pminsd");
+}
+
+TEST_F(AssemblerX86_64Test, Pmaxsd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmaxsd, "pmaxsd %{reg2}, %{reg1}"), "pmaxsd");
+}
+
+TEST_F(AssemblerX86_64Test, Pand) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pand, "pand %{reg2}, %{reg1}"), "pand");
+}
+
+TEST_F(AssemblerX86_64Test, Por) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::por, "por %{reg2}, %{reg1}"), "por");
+}
+
+TEST_F(AssemblerX86_64Test, Pxor) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pxor, "pxor %{reg2}, %{reg1}"), "pxor");
+}
+
+TEST_F(AssemblerX86_64Test, Pcmpeqb) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pcmpeqb, "pcmpeqb %{reg2}, %{reg1}"), "pcmpeqb");
+}
+
+TEST_F(AssemblerX86_64Test, Pmovsxbd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmovsxbd, "pmovsxbd %{reg2}, %{reg1}"), "pmovsxbd");
+}
+
+TEST_F(AssemblerX86_64Test, Pmovsxwd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmovsxwd, "pmovsxwd %{reg2}, %{reg1}"), "pmovsxwd");
+}
+
+TEST_F(AssemblerX86_64Test, Pmovzxwd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmovzxwd, "pmovzxwd %{reg2}, %{reg1}"), "pmovzxwd");
+}
+
+TEST_F(AssemblerX86_64Test, Punpcklbw) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::punpcklbw, "punpcklbw %{reg2}, %{reg1}"),
+            "punpcklbw");
+}
+
+TEST_F(AssemblerX86_64Test, Punpcklwd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::punpcklwd, "punpcklwd %{reg2}, %{reg1}"),
+            "punpcklwd");
+}
+
+TEST_F(AssemblerX86_64Test, Punpckldq) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::punpckldq, "punpckldq %{reg2}, %{reg1}"),
+            "punpckldq");
+}
+
+TEST_F(AssemblerX86_64Test, Punpcklqdq) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::punpcklqdq, "punpcklqdq %{reg2}, %{reg1}"),
+            "punpcklqdq");
+}
+
+TEST_F(AssemblerX86_64Test, Pshufd) {
+  DriverStr(RepeatFFI(&x86_64::X86_64Assembler::pshufd, 1, "pshufd ${imm}, %{reg2}, %{reg1}"),
+            "pshufd");
+}
+
+TEST_F(AssemblerX86_64Test, MovdquAddress) {
+  GetAssembler()->movdqu(x86_64::XmmRegister(x86_64::XMM0), x86_64::Address(
+      x86_64::CpuRegister(x86_64::RDI), x86_64::CpuRegister(x86_64::RBX), x86_64::TIMES_4, 12));
+  GetAssembler()->movdqu(x86_64::XmmRegister(x86_64::XMM9), x86_64::Address(
+      x86_64::CpuRegister(x86_64::R13), x86_64::CpuRegister(x86_64::R9), x86_64::TIMES_1, 0));
+  GetAssembler()->movdqu(x86_64::Address(
+      x86_64::CpuRegister(x86_64::RDI), x86_64::CpuRegister(x86_64::R9), x86_64::TIMES_2, 12),
+      x86_64::XmmRegister(x86_64::XMM1));
+  GetAssembler()->movdqu(x86_64::Address(x86_64::CpuRegister(x86_64::R13), 0),
+                         x86_64::XmmRegister(x86_64::XMM12));
+  const char* expected =
+    "movdqu 0xc(%RDI,%RBX,4), %xmm0\n"
+    "movdqu (%R13,%R9,1), %xmm9\n"
+    "movdqu %xmm1, 0xc(%RDI,%R9,2)\n"
+    "movdqu %xmm12, (%R13)\n";
+
+  DriverStr(expected, "movdqu_address");
+}
+
+TEST_F(AssemblerX86_64Test, PmovxAddress) {
+  GetAssembler()->pmovsxbd(x86_64::XmmRegister(x86_64::XMM0), x86_64::Address(
+      x86_64::CpuRegister(x86_64::RDI), x86_64::CpuRegister(x86_64::RBX), x86_64::TIMES_1, 12));
+  GetAssembler()->pmovsxwd(x86_64::XmmRegister(x86_64::XMM9), x86_64::Address(
+      x86_64::CpuRegister(x86_64::R13), x86_64::CpuRegister(x86_64::R9), x86_64::TIMES_2, 0));
+  GetAssembler()->pmovzxwd(x86_64::XmmRegister(x86_64::XMM2), x86_64::Address(
+      x86_64::CpuRegister(x86_64::R13), 0));
+  const char* expected =
+    "pmovsxbd 0xc(%RDI,%RBX,1), %xmm0\n"
+    "pmovsxwd (%R13,%R9,2), %xmm9\n"
+    "pmovzxwd (%R13), %xmm2\n";
+
+  DriverStr(expected, "pmovx_address");
+}
+
 TEST_F(AssemblerX86_64Test, UcomissAddress) {
   GetAssembler()->ucomiss(x86_64::XmmRegister(x86_64::XMM0), x86_64::Address(
       x86_64::CpuRegister(x86_64::RDI), x86_64::CpuRegister(x86_64::RBX), x86_64::TIMES_4, 12));
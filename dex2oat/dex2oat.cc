@@ -317,6 +317,12 @@ NO_RETURN static void Usage(const char* fmt, ...) {
              CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("      Default: %d", CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("");
+  UsageError("  --register-allocation-strategy=(linear-scan|graph-color): the register");
+  UsageError("      allocator used by Optimizing. graph-color is only honored for arm64,");
+  UsageError("      mips64 and x86_64, and is never used for JIT compilation.");
+  UsageError("      Example: --register-allocation-strategy=graph-color");
+  UsageError("      Default: linear-scan");
+  UsageError("");
   UsageError("  --dump-timing: display a breakdown of where time was spent");
   UsageError("");
   UsageError("  --include-patch-information: Include patching information so the generated code");
@@ -414,6 +414,9 @@ class OatDumper {
     os << "IMAGE FILE LOCATION OAT BEGIN:\n";
     os << StringPrintf("0x%08x\n\n", oat_header.GetImageFileLocationOatDataBegin());
 
+    os << "MULTI-DEX TYPE LOOKUP TABLE OFFSET:\n";
+    os << StringPrintf("0x%08x\n\n", oat_header.GetMultiDexTypeLookupTableOffset());
+
     // Print the key-value store.
     {
       os << "KEY VALUE STORE:\n";
@@ -39,6 +39,7 @@ LIBART_COMMON_SRC_FILES := \
   base/timing_logger.cc \
   base/unix_file/fd_file.cc \
   base/unix_file/random_access_file_utils.cc \
+  cha.cc \
   check_jni.cc \
   class_linker.cc \
   class_table.cc \
@@ -52,6 +53,7 @@ LIBART_COMMON_SRC_FILES := \
   elf_file.cc \
   fault_handler.cc \
   gc/allocation_record.cc \
+  gc/allocation_sampler.cc \
   gc/allocator/dlmalloc.cc \
   gc/allocator/rosalloc.cc \
   gc/accounting/bitmap.cc \
@@ -70,6 +72,7 @@ LIBART_COMMON_SRC_FILES := \
   gc/collector/semi_space.cc \
   gc/collector/sticky_mark_sweep.cc \
   gc/gc_cause.cc \
+  gc/gc_stats.cc \
   gc/heap.cc \
   gc/reference_processor.cc \
   gc/reference_queue.cc \
@@ -83,6 +86,7 @@ LIBART_COMMON_SRC_FILES := \
   gc/space/rosalloc_space.cc \
   gc/space/space.cc \
   gc/space/zygote_space.cc \
+  gc/string_dedup_table.cc \
   gc/task_processor.cc \
   hprof/hprof.cc \
   image.cc \
@@ -106,6 +110,8 @@ LIBART_COMMON_SRC_FILES := \
   jit/debugger_interface.cc \
   jit/jit.cc \
   jit/jit_code_cache.cc \
+  jit/jit_code_snapshot.cc \
+  jit/jit_perf_writer.cc \
   jit/offline_profiling_info.cc \
   jit/profiling_info.cc \
   jit/profile_saver.cc  \
@@ -131,6 +137,7 @@ LIBART_COMMON_SRC_FILES := \
   mirror/string.cc \
   mirror/throwable.cc \
   monitor.cc \
+  multi_dex_type_lookup_table.cc \
   native_bridge_art_interface.cc \
   native/dalvik_system_DexFile.cc \
   native/dalvik_system_VMDebug.cc \
@@ -221,6 +228,7 @@ LIBART_COMMON_SRC_FILES += \
   entrypoints/quick/quick_field_entrypoints.cc \
   entrypoints/quick/quick_fillarray_entrypoints.cc \
   entrypoints/quick/quick_instrumentation_entrypoints.cc \
+  entrypoints/quick/quick_jit_entrypoints.cc \
   entrypoints/quick/quick_jni_entrypoints.cc \
   entrypoints/quick/quick_lock_entrypoints.cc \
   entrypoints/quick/quick_math_entrypoints.cc \
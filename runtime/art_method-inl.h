@@ -171,9 +171,9 @@ inline bool ArtMethod::HasSameDexCacheResolvedMethods(ArtMethod* other, size_t p
       other->GetDexCacheResolvedMethods(pointer_size);
 }
 
-inline GcRoot<mirror::Class>* ArtMethod::GetDexCacheResolvedTypes(size_t pointer_size) {
-  return GetNativePointer<GcRoot<mirror::Class>*>(DexCacheResolvedTypesOffset(pointer_size),
-                                                  pointer_size);
+inline mirror::TypeDexCacheType* ArtMethod::GetDexCacheResolvedTypes(size_t pointer_size) {
+  return GetNativePointer<mirror::TypeDexCacheType*>(DexCacheResolvedTypesOffset(pointer_size),
+                                                     pointer_size);
 }
 
 template <bool kWithCheck>
@@ -181,12 +181,14 @@ inline mirror::Class* ArtMethod::GetDexCacheResolvedType(uint32_t type_index, si
   if (kWithCheck) {
     mirror::DexCache* dex_cache =
         GetInterfaceMethodIfProxy(ptr_size)->GetDeclaringClass()->GetDexCache();
-    if (UNLIKELY(type_index >= dex_cache->NumResolvedTypes())) {
-      ThrowArrayIndexOutOfBoundsException(type_index, dex_cache->NumResolvedTypes());
+    const size_t num_type_ids = dex_cache->GetDexFile()->NumTypeIds();
+    if (UNLIKELY(type_index >= num_type_ids)) {
+      ThrowArrayIndexOutOfBoundsException(type_index, num_type_ids);
       return nullptr;
     }
   }
-  mirror::Class* klass = GetDexCacheResolvedTypes(ptr_size)[type_index].Read();
+  mirror::Class* klass =
+      mirror::DexCache::LookupResolvedType(GetDexCacheResolvedTypes(ptr_size), type_index);
   return (klass != nullptr && !klass->IsErroneous()) ? klass : nullptr;
 }
 
@@ -194,7 +196,7 @@ inline bool ArtMethod::HasDexCacheResolvedTypes(size_t pointer_size) {
   return GetDexCacheResolvedTypes(pointer_size) != nullptr;
 }
 
-inline bool ArtMethod::HasSameDexCacheResolvedTypes(GcRoot<mirror::Class>* other_cache,
+inline bool ArtMethod::HasSameDexCacheResolvedTypes(mirror::TypeDexCacheType* other_cache,
                                                     size_t pointer_size) {
   return GetDexCacheResolvedTypes(pointer_size) == other_cache;
 }
@@ -419,7 +421,7 @@ inline void ArtMethod::SetDexCacheResolvedMethods(ArtMethod** new_dex_cache_meth
   SetNativePointer(DexCacheResolvedMethodsOffset(ptr_size), new_dex_cache_methods, ptr_size);
 }
 
-inline void ArtMethod::SetDexCacheResolvedTypes(GcRoot<mirror::Class>* new_dex_cache_types,
+inline void ArtMethod::SetDexCacheResolvedTypes(mirror::TypeDexCacheType* new_dex_cache_types,
                                                 size_t ptr_size) {
   SetNativePointer(DexCacheResolvedTypesOffset(ptr_size), new_dex_cache_types, ptr_size);
 }
@@ -486,8 +488,8 @@ inline void ArtMethod::UpdateObjectsForImageRelocation(const Visitor& visitor,
   if (old_methods != new_methods) {
     SetDexCacheResolvedMethods(new_methods, pointer_size);
   }
-  GcRoot<mirror::Class>* old_types = GetDexCacheResolvedTypes(pointer_size);
-  GcRoot<mirror::Class>* new_types = visitor(old_types);
+  mirror::TypeDexCacheType* old_types = GetDexCacheResolvedTypes(pointer_size);
+  mirror::TypeDexCacheType* new_types = visitor(old_types);
   if (old_types != new_types) {
     SetDexCacheResolvedTypes(new_types, pointer_size);
   }
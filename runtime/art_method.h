@@ -17,6 +17,9 @@
 #ifndef ART_RUNTIME_ART_METHOD_H_
 #define ART_RUNTIME_ART_METHOD_H_
 
+#include <atomic>
+#include <type_traits>
+
 #include "base/bit_utils.h"
 #include "base/casts.h"
 #include "dex_file.h"
@@ -43,6 +46,14 @@ class Array;
 class Class;
 class IfTable;
 class PointerArray;
+template <typename T> struct DexCachePair;
+using TypeDexCachePair = DexCachePair<Class>;
+
+// The type of the elements of the resolved types array of a DexCache, see
+// DexCache::NumTypeSlots().
+using TypeDexCacheType = std::conditional<kUseHashedDexCache,
+                                          std::atomic<TypeDexCachePair>,
+                                          GcRoot<Class>>::type;
 }  // namespace mirror
 
 // Table to resolve IMT conflicts at runtime. The table is attached to
@@ -442,12 +453,12 @@ class ArtMethod FINAL {
   template <bool kWithCheck = true>
   mirror::Class* GetDexCacheResolvedType(uint32_t type_idx, size_t ptr_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
-  void SetDexCacheResolvedTypes(GcRoot<mirror::Class>* new_dex_cache_types, size_t ptr_size)
+  void SetDexCacheResolvedTypes(mirror::TypeDexCacheType* new_dex_cache_types, size_t ptr_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
   bool HasDexCacheResolvedTypes(size_t pointer_size) SHARED_REQUIRES(Locks::mutator_lock_);
   bool HasSameDexCacheResolvedTypes(ArtMethod* other, size_t pointer_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
-  bool HasSameDexCacheResolvedTypes(GcRoot<mirror::Class>* other_cache, size_t pointer_size)
+  bool HasSameDexCacheResolvedTypes(mirror::TypeDexCacheType* other_cache, size_t pointer_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Get the Class* from the type index into this method's dex cache.
@@ -653,7 +664,7 @@ class ArtMethod FINAL {
   void CopyFrom(ArtMethod* src, size_t image_pointer_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  ALWAYS_INLINE GcRoot<mirror::Class>* GetDexCacheResolvedTypes(size_t pointer_size)
+  ALWAYS_INLINE mirror::TypeDexCacheType* GetDexCacheResolvedTypes(size_t pointer_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Note, hotness_counter_ updates are non-atomic but it doesn't need to be precise.  Also,
@@ -675,6 +686,10 @@ class ArtMethod FINAL {
     return hotness_count_;
   }
 
+  static MemberOffset HotnessCountOffset() {
+    return MemberOffset(OFFSETOF_MEMBER(ArtMethod, hotness_count_));
+  }
+
   const uint8_t* GetQuickenedInfo() SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Returns the method header for the compiled code containing 'pc'. Note that runtime
@@ -719,8 +734,9 @@ class ArtMethod FINAL {
   // ifTable.
   uint16_t method_index_;
 
-  // The hotness we measure for this method. Managed by the interpreter. Not atomic, as we allow
-  // missing increments: if the method is hot, we will see it eventually.
+  // The hotness we measure for this method. Managed by the interpreter, and incremented by
+  // baseline JIT code. Not atomic, as we allow missing increments: if the method is hot, we
+  // will see it eventually.
   uint16_t hotness_count_;
 
   // Fake padding field gets inserted here.
@@ -733,7 +749,7 @@ class ArtMethod FINAL {
     ArtMethod** dex_cache_resolved_methods_;
 
     // Short cuts to declaring_class_->dex_cache_ member for fast compiled code access.
-    GcRoot<mirror::Class>* dex_cache_resolved_types_;
+    mirror::TypeDexCacheType* dex_cache_resolved_types_;
 
     // Pointer to JNI function registered to this method, or a function to resolve the JNI function,
     // or the profiling data for non-native methods, or an ImtConflictTable.
@@ -23,6 +23,7 @@
 #include "jit/jit.h"
 #include "lock_word.h"
 #include "mirror/class.h"
+#include "mirror/dex_cache.h"
 #include "mirror/string.h"
 #include "runtime.h"
 #include "thread.h"
@@ -128,7 +129,7 @@ ADD_TEST_EQ(THREAD_SELF_OFFSET,
             art::Thread::SelfOffset<__SIZEOF_POINTER__>().Int32Value())
 
 // Offset of field Thread::tlsPtr_.thread_local_objects.
-#define THREAD_LOCAL_OBJECTS_OFFSET (THREAD_CARD_TABLE_OFFSET + 168 * __SIZEOF_POINTER__)
+#define THREAD_LOCAL_OBJECTS_OFFSET (THREAD_CARD_TABLE_OFFSET + 170 * __SIZEOF_POINTER__)
 ADD_TEST_EQ(THREAD_LOCAL_OBJECTS_OFFSET,
             art::Thread::ThreadLocalObjectsOffset<__SIZEOF_POINTER__>().Int32Value())
 // Offset of field Thread::tlsPtr_.thread_local_pos.
@@ -289,6 +290,10 @@ ADD_TEST_EQ(MIRROR_STRING_COUNT_OFFSET, art::mirror::String::CountOffset().Int32
 #define MIRROR_STRING_VALUE_OFFSET (8 + MIRROR_OBJECT_HEADER_SIZE)
 ADD_TEST_EQ(MIRROR_STRING_VALUE_OFFSET, art::mirror::String::ValueOffset().Int32Value())
 
+// Whether the top bit of the string count flags a compressed (Latin-1) string.
+#define STRING_COMPRESSION_FEATURE 0
+ADD_TEST_EQ(STRING_COMPRESSION_FEATURE, art::mirror::kUseStringCompression)
+
 // Offsets within java.lang.reflect.ArtMethod.
 #define ART_METHOD_DEX_CACHE_METHODS_OFFSET_32 20
 ADD_TEST_EQ(ART_METHOD_DEX_CACHE_METHODS_OFFSET_32,
@@ -306,6 +311,19 @@ ADD_TEST_EQ(ART_METHOD_DEX_CACHE_TYPES_OFFSET_32,
 ADD_TEST_EQ(ART_METHOD_DEX_CACHE_TYPES_OFFSET_64,
             art::ArtMethod::DexCacheResolvedTypesOffset(8).Int32Value())
 
+// With ART_USE_HASHED_DEX_CACHE, the slot of a type id in the resolved types array is the low
+// bits of its index, and holds a (class, type index) pair.
+#define DEX_CACHE_TYPE_CACHE_SLOT_BITS 10
+ADD_TEST_EQ(static_cast<size_t>(1U << DEX_CACHE_TYPE_CACHE_SLOT_BITS),
+            art::mirror::DexCache::kDexCacheTypeCacheSize)
+
+#define DEX_CACHE_TYPE_PAIR_SIZE 8
+ADD_TEST_EQ(static_cast<size_t>(DEX_CACHE_TYPE_PAIR_SIZE), sizeof(art::mirror::TypeDexCachePair))
+
+#define DEX_CACHE_TYPE_PAIR_SIZE_SHIFT 3
+ADD_TEST_EQ(static_cast<size_t>(1U << DEX_CACHE_TYPE_PAIR_SIZE_SHIFT),
+            static_cast<size_t>(DEX_CACHE_TYPE_PAIR_SIZE))
+
 #define ART_METHOD_JNI_OFFSET_32 28
 ADD_TEST_EQ(ART_METHOD_JNI_OFFSET_32,
             art::ArtMethod::EntryPointFromJniOffset(4).Int32Value())
@@ -61,6 +61,7 @@ enum ArenaAllocKind {
   kArenaAllocInstruction,
   kArenaAllocInvokeInputs,
   kArenaAllocPhiInputs,
+  kArenaAllocVectorNode,
   kArenaAllocLoopInfo,
   kArenaAllocLoopInfoBackEdges,
   kArenaAllocTryCatchInfo,
@@ -80,6 +81,7 @@ enum ArenaAllocKind {
   kArenaAllocDCE,
   kArenaAllocLSE,
   kArenaAllocLICM,
+  kArenaAllocLoopOptimization,
   kArenaAllocSsaLiveness,
   kArenaAllocSsaPhiElimination,
   kArenaAllocReferenceTypePropagation,
@@ -93,6 +95,7 @@ enum ArenaAllocKind {
   kArenaAllocGraphChecker,
   kArenaAllocVerifier,
   kArenaAllocCallingConvention,
+  kArenaAllocCHA,
   kNumArenaAllocKinds
 };
 
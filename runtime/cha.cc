@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cha.h"
+
+#include <algorithm>
+
+#include "art_method-inl.h"
+#include "class_linker.h"
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
+#include "linear_alloc.h"
+#include "mirror/class-inl.h"
+#include "mirror/iftable-inl.h"
+#include "runtime.h"
+#include "thread.h"
+
+namespace art {
+
+ClassHierarchyAnalysis::ClassHierarchyAnalysis()
+    : lock_("Class hierarchy analysis lock", kCHALock) {}
+
+void ClassHierarchyAnalysis::AddImplementation(ArtMethod* method,
+                                               ArtMethod* implementation,
+                                               ListOfDependents* invalidated) {
+  auto it = single_implementations_.find(method);
+  if (it == single_implementations_.end()) {
+    // Either not tracked, or already known to have several implementations.
+    return;
+  }
+  if (it->second == nullptr) {
+    it->second = implementation;
+    return;
+  }
+  if (it->second == implementation) {
+    return;
+  }
+  VLOG(class_linker) << "CHA: " << PrettyMethod(method) << " is implemented by "
+                     << PrettyMethod(it->second) << " and " << PrettyMethod(implementation);
+  single_implementations_.erase(it);
+  auto dependents_it = dependents_.find(method);
+  if (dependents_it != dependents_.end()) {
+    invalidated->insert(invalidated->end(),
+                        dependents_it->second.begin(),
+                        dependents_it->second.end());
+    dependents_.erase(dependents_it);
+  }
+}
+
+void ClassHierarchyAnalysis::UpdateAfterLoadingOf(Handle<mirror::Class> klass) {
+  if (klass->IsArrayClass() || klass->IsPrimitive()) {
+    return;
+  }
+
+  Thread* self = Thread::Current();
+  size_t pointer_size = Runtime::Current()->GetClassLinker()->GetImagePointerSize();
+  ListOfDependents invalidated;
+  {
+    MutexLock mu(self, lock_);
+
+    // Start tracking the methods declared by `klass`. Final methods and default
+    // methods are not tracked: the former are already devirtualized, and the
+    // latter are copied in each implementing class.
+    if (!klass->IsFinal()) {
+      for (ArtMethod& method : klass->GetDeclaredVirtualMethods(pointer_size)) {
+        if (method.IsFinal() || method.IsDefault()) {
+          continue;
+        }
+        single_implementations_.emplace(&method, method.IsAbstract() ? nullptr : &method);
+      }
+    }
+
+    if (klass->IsInterface()) {
+      // Interfaces do not implement anything.
+      return;
+    }
+
+    // Virtual methods overridden by `klass`. A method overriding slot `i` is a new
+    // implementation of every method occupying that slot in the superclasses.
+    mirror::Class* super_class = klass->GetSuperClass();
+    if (super_class != nullptr) {
+      int32_t length = std::min(klass->GetVTableLength(), super_class->GetVTableLength());
+      for (int32_t i = 0; i < length; ++i) {
+        ArtMethod* implementation = klass->GetVTableEntry(i, pointer_size);
+        if (implementation == super_class->GetVTableEntry(i, pointer_size) ||
+            !implementation->IsInvokable()) {
+          continue;
+        }
+        ArtMethod* previous = nullptr;
+        for (mirror::Class* current = super_class;
+             current != nullptr && i < current->GetVTableLength();
+             current = current->GetSuperClass()) {
+          ArtMethod* overridden = current->GetVTableEntry(i, pointer_size);
+          if (overridden != previous) {
+            AddImplementation(overridden, implementation, &invalidated);
+            previous = overridden;
+          }
+        }
+      }
+    }
+
+    // Interface methods implemented by `klass`, including the ones it inherits.
+    // Inherited implementations are already recorded and leave the information
+    // unchanged.
+    mirror::IfTable* iftable = klass->GetIfTable();
+    for (size_t i = 0, count = klass->GetIfTableCount(); i < count; ++i) {
+      size_t method_array_count = iftable->GetMethodArrayCount(i);
+      if (method_array_count == 0) {
+        continue;
+      }
+      mirror::Class* interface = iftable->GetInterface(i);
+      mirror::PointerArray* method_array = iftable->GetMethodArray(i);
+      for (size_t j = 0; j < method_array_count; ++j) {
+        ArtMethod* implementation =
+            method_array->GetElementPtrSize<ArtMethod*>(j, pointer_size);
+        if (implementation->IsInvokable()) {
+          AddImplementation(
+              interface->GetVirtualMethod(j, pointer_size), implementation, &invalidated);
+        }
+      }
+    }
+  }
+
+  if (invalidated.empty()) {
+    return;
+  }
+  // Invalidate outside of `lock_`, as committing code acquires `lock_` while
+  // holding the code cache lock. The methods are not tracked anymore, so no new
+  // dependents can be added for them in the meantime.
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit != nullptr) {
+    jit::JitCodeCache* code_cache = jit->GetCodeCache();
+    for (const auto& dependent : invalidated) {
+      VLOG(jit) << "CHA invalidates compiled code of " << PrettyMethod(dependent.first)
+                << " after linking " << PrettyClass(klass.Get());
+      code_cache->InvalidateCompiledCodeFor(dependent.first, dependent.second);
+    }
+  }
+}
+
+ArtMethod* ClassHierarchyAnalysis::GetSingleImplementation(ArtMethod* method) {
+  MutexLock mu(Thread::Current(), lock_);
+  auto it = single_implementations_.find(method);
+  return (it == single_implementations_.end()) ? nullptr : it->second;
+}
+
+bool ClassHierarchyAnalysis::AddDependencies(const ArenaSet<ArtMethod*>& methods,
+                                             ArtMethod* dependent,
+                                             const OatQuickMethodHeader* dependent_header) {
+  MutexLock mu(Thread::Current(), lock_);
+  for (ArtMethod* method : methods) {
+    auto it = single_implementations_.find(method);
+    if (it == single_implementations_.end() || it->second == nullptr) {
+      return false;
+    }
+  }
+  for (ArtMethod* method : methods) {
+    dependents_[method].emplace_back(dependent, dependent_header);
+  }
+  return true;
+}
+
+void ClassHierarchyAnalysis::RemoveDependentsWithMethodHeaders(
+    const std::unordered_set<const OatQuickMethodHeader*>& method_headers) {
+  MutexLock mu(Thread::Current(), lock_);
+  for (auto it = dependents_.begin(); it != dependents_.end();) {
+    ListOfDependents& dependents = it->second;
+    dependents.erase(
+        std::remove_if(dependents.begin(),
+                       dependents.end(),
+                       [&method_headers](const ListOfDependents::value_type& d) {
+                         return method_headers.find(d.second) != method_headers.end();
+                       }),
+        dependents.end());
+    if (dependents.empty()) {
+      it = dependents_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ClassHierarchyAnalysis::RemoveMethodsIn(const LinearAlloc& alloc) {
+  MutexLock mu(Thread::Current(), lock_);
+  for (auto it = single_implementations_.begin(); it != single_implementations_.end();) {
+    if (alloc.ContainsUnsafe(it->first) ||
+        (it->second != nullptr && alloc.ContainsUnsafe(it->second))) {
+      // We cannot tell whether a method whose implementation is being unloaded
+      // had any other implementation, so stop tracking it.
+      it = single_implementations_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = dependents_.begin(); it != dependents_.end();) {
+    if (single_implementations_.find(it->first) == single_implementations_.end()) {
+      // Only tracked methods have dependents.
+      it = dependents_.erase(it);
+      continue;
+    }
+    ListOfDependents& dependents = it->second;
+    dependents.erase(
+        std::remove_if(dependents.begin(),
+                       dependents.end(),
+                       [&alloc](const ListOfDependents::value_type& d) {
+                         return alloc.ContainsUnsafe(d.first);
+                       }),
+        dependents.end());
+    if (dependents.empty()) {
+      it = dependents_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CHA_H_
+#define ART_RUNTIME_CHA_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "base/arena_containers.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "handle.h"
+
+namespace art {
+
+class ArtMethod;
+class LinearAlloc;
+class OatQuickMethodHeader;
+
+namespace mirror {
+class Class;
+}  // namespace mirror
+
+/**
+ * Class Hierarchy Analysis (CHA) tracks, for the virtual and interface methods
+ * of classes linked at runtime, whether there is a single invokable
+ * implementation of the method among the classes loaded so far. The JIT uses
+ * that information to devirtualize and inline calls to such methods.
+ *
+ * Methods are tracked from the moment their declaring class is linked, so that
+ * every implementation is seen by `UpdateAfterLoadingOf`. Methods of classes
+ * linked before the analysis existed (for example boot image classes) are not
+ * tracked, and are never reported to have a single implementation.
+ *
+ * Compiled code relying on a single implementation registers itself as a
+ * dependent of the method. When a newly linked class adds a second
+ * implementation, the method stops being tracked and the compiled code of its
+ * dependents is invalidated, so that it gets recompiled without the
+ * assumption. Code using the assumption is expected to guard the devirtualized
+ * call, so that frames already executing it remain correct.
+ */
+class ClassHierarchyAnalysis {
+ public:
+  ClassHierarchyAnalysis();
+
+  // Record the virtual methods declared by `klass`, and update the single
+  // implementation information of the methods it overrides or implements.
+  // Invalidate the compiled code depending on methods which now have more than
+  // one implementation.
+  void UpdateAfterLoadingOf(Handle<mirror::Class> klass)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Return the single implementation of `method` loaded so far. Return null if
+  // `method` is not tracked, has no implementation, or has several.
+  ArtMethod* GetSingleImplementation(ArtMethod* method) REQUIRES(!lock_);
+
+  // If every method in `methods` still has a single implementation, record the
+  // compiled code `dependent_header` of `dependent` as depending on them, and
+  // return true. Otherwise, record nothing and return false.
+  bool AddDependencies(const ArenaSet<ArtMethod*>& methods,
+                       ArtMethod* dependent,
+                       const OatQuickMethodHeader* dependent_header)
+      REQUIRES(!lock_);
+
+  // Remove the dependencies of compiled code which is about to be freed.
+  void RemoveDependentsWithMethodHeaders(
+      const std::unordered_set<const OatQuickMethodHeader*>& method_headers)
+      REQUIRES(!lock_);
+
+  // Remove all methods and dependents allocated in `alloc`, which is about to
+  // be freed because its class loader got unloaded.
+  void RemoveMethodsIn(const LinearAlloc& alloc) REQUIRES(!lock_);
+
+ private:
+  typedef std::vector<std::pair<ArtMethod*, const OatQuickMethodHeader*>> ListOfDependents;
+
+  // Record `implementation` as an implementation of `method`. If `method` ends
+  // up with several implementations, stop tracking it and move its dependents
+  // to `invalidated`.
+  void AddImplementation(ArtMethod* method,
+                         ArtMethod* implementation,
+                         ListOfDependents* invalidated)
+      REQUIRES(lock_);
+
+  Mutex lock_;
+
+  // Map from a tracked method to its single implementation, or to null if no
+  // implementation has been loaded yet.
+  std::unordered_map<ArtMethod*, ArtMethod*> single_implementations_ GUARDED_BY(lock_);
+
+  // Map from a tracked method to the compiled code relying on its single
+  // implementation.
+  std::unordered_map<ArtMethod*, ListOfDependents> dependents_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(ClassHierarchyAnalysis);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CHA_H_
@@ -63,8 +63,9 @@ inline mirror::Class* ClassLinker::FindArrayClass(Thread* self, mirror::Class**
 inline mirror::String* ClassLinker::ResolveString(uint32_t string_idx, ArtMethod* referrer) {
   mirror::Class* declaring_class = referrer->GetDeclaringClass();
   // MethodVerifier refuses methods with string_idx out of bounds.
-  DCHECK_LT(string_idx, declaring_class->GetDexCache()->NumStrings());
-  mirror::String* resolved_string = declaring_class->GetDexCacheStrings()[string_idx].Read();
+  DCHECK_LT(string_idx, declaring_class->GetDexCache()->GetDexFile()->NumStringIds());
+  mirror::String* resolved_string =
+      mirror::DexCache::LookupResolvedString(declaring_class->GetDexCacheStrings(), string_idx);
   if (UNLIKELY(resolved_string == nullptr)) {
     StackHandleScope<1> hs(Thread::Current());
     Handle<mirror::DexCache> dex_cache(hs.NewHandle(declaring_class->GetDexCache()));
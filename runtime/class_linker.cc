@@ -40,6 +40,7 @@
 #include "base/time_utils.h"
 #include "base/unix_file/fd_file.h"
 #include "base/value_object.h"
+#include "cha.h"
 #include "class_linker-inl.h"
 #include "class_table-inl.h"
 #include "compiler_callbacks.h"
@@ -88,6 +89,7 @@
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
+#include "thread_list.h"
 #include "trace.h"
 #include "utils.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
@@ -1150,7 +1152,7 @@ class FixupArtMethodArrayVisitor : public ArtMethodVisitor {
   explicit FixupArtMethodArrayVisitor(const ImageHeader& header) : header_(header) {}
 
   virtual void Visit(ArtMethod* method) SHARED_REQUIRES(Locks::mutator_lock_) {
-    GcRoot<mirror::Class>* resolved_types = method->GetDexCacheResolvedTypes(sizeof(void*));
+    mirror::TypeDexCacheType* resolved_types = method->GetDexCacheResolvedTypes(sizeof(void*));
     const bool is_copied = method->IsCopied();
     if (resolved_types != nullptr) {
       bool in_image_space = false;
@@ -1164,8 +1166,8 @@ class FixupArtMethodArrayVisitor : public ArtMethodVisitor {
           << reinterpret_cast<void*>(header_.GetImageBegin());
       if (!is_copied || in_image_space) {
         // Go through the array so that we don't need to do a slow map lookup.
-        method->SetDexCacheResolvedTypes(*reinterpret_cast<GcRoot<mirror::Class>**>(resolved_types),
-                                         sizeof(void*));
+        method->SetDexCacheResolvedTypes(
+            *reinterpret_cast<mirror::TypeDexCacheType**>(resolved_types), sizeof(void*));
       }
     }
     ArtMethod** resolved_methods = method->GetDexCacheResolvedMethods(sizeof(void*));
@@ -1274,8 +1276,8 @@ bool ClassLinker::UpdateAppImageClassLoadersAndDexCaches(
       // If the oat file expects the dex cache arrays to be in the BSS, then allocate there and
         // copy over the arrays.
         DCHECK(dex_file != nullptr);
-        const size_t num_strings = dex_file->NumStringIds();
-        const size_t num_types = dex_file->NumTypeIds();
+        const size_t num_strings = mirror::DexCache::NumStringSlots(dex_file->NumStringIds());
+        const size_t num_types = mirror::DexCache::NumTypeSlots(dex_file->NumTypeIds());
         const size_t num_methods = dex_file->NumMethodIds();
         const size_t num_fields = dex_file->NumFieldIds();
         CHECK_EQ(num_strings, dex_cache->NumStrings());
@@ -1287,27 +1289,43 @@ bool ClassLinker::UpdateAppImageClassLoadersAndDexCaches(
         // The space is not yet visible to the GC, we can avoid the read barriers and use
         // std::copy_n.
         if (num_strings != 0u) {
-          GcRoot<mirror::String>* const image_resolved_strings = dex_cache->GetStrings();
-          GcRoot<mirror::String>* const strings =
-              reinterpret_cast<GcRoot<mirror::String>*>(raw_arrays + layout.StringsOffset());
+          mirror::StringDexCacheType* const image_resolved_strings = dex_cache->GetStrings();
+          mirror::StringDexCacheType* const strings =
+              reinterpret_cast<mirror::StringDexCacheType*>(raw_arrays + layout.StringsOffset());
           for (size_t j = 0; kIsDebugBuild && j < num_strings; ++j) {
-            DCHECK(strings[j].IsNull());
+            uint32_t string_idx;
+            DCHECK(mirror::DexCache::ReadSlot<kWithoutReadBarrier>(
+                &strings[j], j, &string_idx) == nullptr);
+          }
+          // Copy the strings slot by slot, the slots of a hashed strings cache are atomic.
+          for (size_t j = 0; j < num_strings; ++j) {
+            uint32_t string_idx;
+            mirror::String* string = mirror::DexCache::ReadSlot<kWithoutReadBarrier>(
+                &image_resolved_strings[j], j, &string_idx);
+            mirror::DexCache::AssignSlot(&strings[j], string_idx, string);
           }
-          std::copy_n(image_resolved_strings, num_strings, strings);
           dex_cache->SetStrings(strings);
         }
         if (num_types != 0u) {
-          GcRoot<mirror::Class>* const image_resolved_types = dex_cache->GetResolvedTypes();
-          GcRoot<mirror::Class>* const types =
-              reinterpret_cast<GcRoot<mirror::Class>*>(raw_arrays + layout.TypesOffset());
+          mirror::TypeDexCacheType* const image_resolved_types = dex_cache->GetResolvedTypes();
+          mirror::TypeDexCacheType* const types =
+              reinterpret_cast<mirror::TypeDexCacheType*>(raw_arrays + layout.TypesOffset());
           for (size_t j = 0; kIsDebugBuild && j < num_types; ++j) {
-            DCHECK(types[j].IsNull());
+            uint32_t type_idx;
+            DCHECK(mirror::DexCache::ReadSlot<kWithoutReadBarrier>(
+                &types[j], j, &type_idx) == nullptr);
+          }
+          // Copy the types slot by slot, the slots of a hashed resolved types cache are atomic.
+          for (size_t j = 0; j < num_types; ++j) {
+            uint32_t type_idx;
+            mirror::Class* klass = mirror::DexCache::ReadSlot<kWithoutReadBarrier>(
+                &image_resolved_types[j], j, &type_idx);
+            mirror::DexCache::AssignSlot(&types[j], type_idx, klass);
           }
-          std::copy_n(image_resolved_types, num_types, types);
           // Store a pointer to the new location for fast ArtMethod patching without requiring map.
           // This leaves random garbage at the start of the dex cache array, but nobody should ever
           // read from it again.
-          *reinterpret_cast<GcRoot<mirror::Class>**>(image_resolved_types) = types;
+          *reinterpret_cast<mirror::TypeDexCacheType**>(image_resolved_types) = types;
           dex_cache->SetResolvedTypes(types);
         }
         if (num_methods != 0u) {
@@ -1344,12 +1362,12 @@ bool ClassLinker::UpdateAppImageClassLoadersAndDexCaches(
         StackHandleScope<1> hs3(self);
         RegisterDexFileLocked(*dex_file, hs3.NewHandle(dex_cache));
       }
-      GcRoot<mirror::Class>* const types = dex_cache->GetResolvedTypes();
       const size_t num_types = dex_cache->NumResolvedTypes();
       if (new_class_set == nullptr) {
         for (int32_t j = 0; j < static_cast<int32_t>(num_types); j++) {
           // The image space is not yet added to the heap, avoid read barriers.
-          mirror::Class* klass = types[j].Read();
+          uint32_t type_idx;
+          mirror::Class* klass = dex_cache->GetTypeSlot(j, &type_idx);
           // There may also be boot image classes,
           if (space->HasAddress(klass)) {
             DCHECK_NE(klass->GetStatus(), mirror::Class::kStatusError);
@@ -1399,7 +1417,8 @@ bool ClassLinker::UpdateAppImageClassLoadersAndDexCaches(
       if (kIsDebugBuild) {
         for (int32_t j = 0; j < static_cast<int32_t>(num_types); j++) {
           // The image space is not yet added to the heap, avoid read barriers.
-          mirror::Class* klass = types[j].Read();
+          uint32_t type_idx;
+          mirror::Class* klass = dex_cache->GetTypeSlot(j, &type_idx);
           if (space->HasAddress(klass)) {
             DCHECK_NE(klass->GetStatus(), mirror::Class::kStatusError);
             if (kIsDebugBuild) {
@@ -1476,14 +1495,14 @@ class UpdateClassLoaderAndResolvedStringsVisitor {
 
   bool operator()(mirror::Class* klass) const SHARED_REQUIRES(Locks::mutator_lock_) {
     if (forward_strings_) {
-      GcRoot<mirror::String>* strings = klass->GetDexCacheStrings();
+      mirror::StringDexCacheType* strings = klass->GetDexCacheStrings();
       if (strings != nullptr) {
         DCHECK(
             space_->GetImageHeader().GetImageSection(ImageHeader::kSectionDexCacheArrays).Contains(
                 reinterpret_cast<uint8_t*>(strings) - space_->Begin()))
             << "String dex cache array for " << PrettyClass(klass) << " is not in app image";
         // Dex caches have already been updated, so take the strings pointer from there.
-        GcRoot<mirror::String>* new_strings = klass->GetDexCache()->GetStrings();
+        mirror::StringDexCacheType* new_strings = klass->GetDexCache()->GetStrings();
         DCHECK_NE(strings, new_strings);
         klass->SetDexCacheStrings(new_strings);
       }
@@ -1635,9 +1654,9 @@ bool ClassLinker::AddImageSpace(
       h_dex_cache->SetDexFile(dex_file.get());
       // Check that each class loader resolved the same way.
       // TODO: Store image class loaders as image roots.
-      GcRoot<mirror::Class>* const types = h_dex_cache->GetResolvedTypes();
       for (int32_t j = 0, num_types = h_dex_cache->NumResolvedTypes(); j < num_types; j++) {
-        mirror::Class* klass = types[j].Read();
+        uint32_t type_idx;
+        mirror::Class* klass = h_dex_cache->GetTypeSlot(j, &type_idx);
         if (klass != nullptr) {
           DCHECK_NE(klass->GetStatus(), mirror::Class::kStatusError);
           mirror::ClassLoader* image_class_loader = klass->GetClassLoader();
@@ -2042,6 +2061,10 @@ void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data) {
   Runtime* const runtime = Runtime::Current();
   JavaVMExt* const vm = runtime->GetJavaVM();
   vm->DeleteWeakGlobalRef(self, data.weak_root);
+  // Stop tracking the methods of the class loader in the class hierarchy analysis.
+  if (runtime->GetClassHierarchyAnalysis() != nullptr) {
+    runtime->GetClassHierarchyAnalysis()->RemoveMethodsIn(*data.allocator);
+  }
   // Notify the JIT that we need to remove the methods and/or profiling info.
   if (runtime->GetJit() != nullptr) {
     jit::JitCodeCache* code_cache = runtime->GetJit()->GetCodeCache();
@@ -2086,21 +2109,27 @@ mirror::DexCache* ClassLinker::AllocDexCache(Thread* self,
     // Zero-initialized.
     raw_arrays = reinterpret_cast<uint8_t*>(linear_alloc->Alloc(self, layout.Size()));
   }
-  GcRoot<mirror::String>* strings = (dex_file.NumStringIds() == 0u) ? nullptr :
-      reinterpret_cast<GcRoot<mirror::String>*>(raw_arrays + layout.StringsOffset());
-  GcRoot<mirror::Class>* types = (dex_file.NumTypeIds() == 0u) ? nullptr :
-      reinterpret_cast<GcRoot<mirror::Class>*>(raw_arrays + layout.TypesOffset());
+  const size_t num_strings = mirror::DexCache::NumStringSlots(dex_file.NumStringIds());
+  mirror::StringDexCacheType* strings = (num_strings == 0u) ? nullptr :
+      reinterpret_cast<mirror::StringDexCacheType*>(raw_arrays + layout.StringsOffset());
+  const size_t num_types = mirror::DexCache::NumTypeSlots(dex_file.NumTypeIds());
+  mirror::TypeDexCacheType* types = (num_types == 0u) ? nullptr :
+      reinterpret_cast<mirror::TypeDexCacheType*>(raw_arrays + layout.TypesOffset());
   ArtMethod** methods = (dex_file.NumMethodIds() == 0u) ? nullptr :
       reinterpret_cast<ArtMethod**>(raw_arrays + layout.MethodsOffset());
   ArtField** fields = (dex_file.NumFieldIds() == 0u) ? nullptr :
       reinterpret_cast<ArtField**>(raw_arrays + layout.FieldsOffset());
   if (kIsDebugBuild) {
     // Sanity check to make sure all the dex cache arrays are empty. b/28992179
-    for (size_t i = 0; i < dex_file.NumStringIds(); ++i) {
-      CHECK(strings[i].Read<kWithoutReadBarrier>() == nullptr);
+    for (size_t i = 0; i < num_strings; ++i) {
+      uint32_t string_idx;
+      CHECK(mirror::DexCache::ReadSlot<kWithoutReadBarrier>(
+          &strings[i], i, &string_idx) == nullptr);
     }
-    for (size_t i = 0; i < dex_file.NumTypeIds(); ++i) {
-      CHECK(types[i].Read<kWithoutReadBarrier>() == nullptr);
+    for (size_t i = 0; i < num_types; ++i) {
+      uint32_t type_idx;
+      CHECK(mirror::DexCache::ReadSlot<kWithoutReadBarrier>(
+          &types[i], i, &type_idx) == nullptr);
     }
     for (size_t i = 0; i < dex_file.NumMethodIds(); ++i) {
       CHECK(mirror::DexCache::GetElementPtrSize(methods, i, image_pointer_size_) == nullptr);
@@ -2112,9 +2141,9 @@ mirror::DexCache* ClassLinker::AllocDexCache(Thread* self,
   dex_cache->Init(&dex_file,
                   location.Get(),
                   strings,
-                  dex_file.NumStringIds(),
+                  num_strings,
                   types,
-                  dex_file.NumTypeIds(),
+                  num_types,
                   methods,
                   dex_file.NumMethodIds(),
                   fields,
@@ -2236,6 +2265,28 @@ ClassPathEntry FindInClassPath(const char* descriptor,
   return ClassPathEntry(nullptr, nullptr);
 }
 
+// Returns the oat file of a DexFile cookie if the cookie holds exactly the dex files of that oat
+// file, so that the lookup table of the oat file can answer for all of them, or null.
+static const OatFile* GetCookieOatFile(mirror::LongArray* long_array)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  const OatFile* oat_file = reinterpret_cast<const OatFile*>(static_cast<uintptr_t>(
+      long_array->GetWithoutChecks(kOatFileIndex)));
+  if (oat_file == nullptr ||
+      oat_file->GetOatDexFiles().size() + kDexFileIndexStart !=
+          static_cast<size_t>(long_array->GetLength())) {
+    return nullptr;
+  }
+  for (int32_t j = kDexFileIndexStart; j < long_array->GetLength(); ++j) {
+    const DexFile* dex_file = reinterpret_cast<const DexFile*>(static_cast<uintptr_t>(
+        long_array->GetWithoutChecks(j)));
+    if (dex_file->GetOatDexFile() == nullptr ||
+        dex_file->GetOatDexFile()->GetOatFile() != oat_file) {
+      return nullptr;
+    }
+  }
+  return oat_file;
+}
+
 bool ClassLinker::FindClassInPathClassLoader(ScopedObjectAccessAlreadyRunnable& soa,
                                              Thread* self,
                                              const char* descriptor,
@@ -2325,11 +2376,29 @@ bool ClassLinker::FindClassInPathClassLoader(ScopedObjectAccessAlreadyRunnable&
             break;
           }
           int32_t long_array_size = long_array->GetLength();
-          // First element is the oat file.
+          // First element is the oat file. If it has a lookup table for all of the dex files,
+          // a single probe either names the dex file defining the class or skips all of them.
+          const OatFile* oat_file = GetCookieOatFile(long_array);
+          const OatDexFile* indexed_oat_dex_file = nullptr;
+          uint32_t indexed_class_def_idx = DexFile::kDexNoIndex;
+          const bool indexed = oat_file != nullptr &&
+              oat_file->FindClassDef(descriptor, hash, &indexed_oat_dex_file,
+                                     &indexed_class_def_idx);
+          if (indexed && indexed_oat_dex_file == nullptr) {
+            continue;
+          }
           for (int32_t j = kDexFileIndexStart; j < long_array_size; ++j) {
             const DexFile* cp_dex_file = reinterpret_cast<const DexFile*>(static_cast<uintptr_t>(
                 long_array->GetWithoutChecks(j)));
-            const DexFile::ClassDef* dex_class_def = cp_dex_file->FindClassDef(descriptor, hash);
+            const DexFile::ClassDef* dex_class_def;
+            if (indexed) {
+              if (cp_dex_file->GetOatDexFile() != indexed_oat_dex_file) {
+                continue;
+              }
+              dex_class_def = &cp_dex_file->GetClassDef(indexed_class_def_idx);
+            } else {
+              dex_class_def = cp_dex_file->FindClassDef(descriptor, hash);
+            }
             if (dex_class_def != nullptr) {
               mirror::Class* klass = DefineClass(self,
                                                  descriptor,
@@ -2357,6 +2426,68 @@ bool ClassLinker::FindClassInPathClassLoader(ScopedObjectAccessAlreadyRunnable&
   return true;
 }
 
+bool ClassLinker::GetPathClassLoaderDexFiles(ScopedObjectAccessAlreadyRunnable& soa,
+                                             mirror::ClassLoader* class_loader,
+                                             std::vector<const DexFile*>* dex_files) {
+  ArtField* const cookie_field = soa.DecodeField(WellKnownClasses::dalvik_system_DexFile_cookie);
+  ArtField* const dex_file_field =
+      soa.DecodeField(WellKnownClasses::dalvik_system_DexPathList__Element_dexFile);
+  mirror::Class* const path_class_loader_class =
+      soa.Decode<mirror::Class*>(WellKnownClasses::dalvik_system_PathClassLoader);
+  for (; !IsBootClassLoader(soa, class_loader); class_loader = class_loader->GetParent()) {
+    if (class_loader->GetClass() != path_class_loader_class) {
+      return false;
+    }
+    mirror::Object* dex_path_list =
+        soa.DecodeField(WellKnownClasses::dalvik_system_PathClassLoader_pathList)->
+        GetObject(class_loader);
+    if (dex_path_list == nullptr || dex_file_field == nullptr || cookie_field == nullptr) {
+      continue;
+    }
+    mirror::Object* dex_elements_obj =
+        soa.DecodeField(WellKnownClasses::dalvik_system_DexPathList_dexElements)->
+        GetObject(dex_path_list);
+    if (dex_elements_obj == nullptr) {
+      continue;
+    }
+    mirror::ObjectArray<mirror::Object>* dex_elements =
+        dex_elements_obj->AsObjectArray<mirror::Object>();
+    for (int32_t i = 0; i < dex_elements->GetLength(); ++i) {
+      mirror::Object* element = dex_elements->GetWithoutChecks(i);
+      if (element == nullptr) {
+        // Left to the Java code, as in FindClassInPathClassLoader.
+        return false;
+      }
+      mirror::Object* dex_file = dex_file_field->GetObject(element);
+      if (dex_file == nullptr) {
+        continue;
+      }
+      mirror::Object* cookie = cookie_field->GetObject(dex_file);
+      if (cookie == nullptr) {
+        return false;
+      }
+      mirror::LongArray* long_array = cookie->AsLongArray();
+      for (int32_t j = kDexFileIndexStart; j < long_array->GetLength(); ++j) {
+        dex_files->push_back(reinterpret_cast<const DexFile*>(static_cast<uintptr_t>(
+            long_array->GetWithoutChecks(j))));
+      }
+    }
+  }
+  return true;
+}
+
+// Returns true if one of the dex files has a class def for the descriptor.
+static bool HasClassDef(const char* descriptor,
+                        size_t hash,
+                        const std::vector<const DexFile*>& dex_files) {
+  for (const DexFile* dex_file : dex_files) {
+    if (dex_file->FindClassDef(descriptor, hash) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
 mirror::Class* ClassLinker::FindClass(Thread* self,
                                       const char* descriptor,
                                       Handle<mirror::ClassLoader> class_loader) {
@@ -2397,6 +2528,21 @@ mirror::Class* ClassLinker::FindClass(Thread* self,
     }
   } else {
     ScopedObjectAccessUnchecked soa(self);
+    // A class which no dex file of the chain defined is not searched again, and the class loader
+    // is not asked either, as long as the chain has the same dex files.
+    ClassTable* const class_table = ClassTableForClassLoader(class_loader.Get());
+    std::vector<const DexFile*> chain_dex_files;
+    const bool known_chain = class_table != nullptr &&
+        GetPathClassLoaderDexFiles(soa, class_loader.Get(), &chain_dex_files);
+    if (known_chain && class_table->InNegativeCache(descriptor, hash, chain_dex_files)) {
+      if (Runtime::Current()->IsAotCompiler()) {
+        self->SetException(Runtime::Current()->GetPreAllocatedNoClassDefFoundError());
+      } else {
+        self->ThrowNewException("Ljava/lang/ClassNotFoundException;",
+                                DescriptorToDot(descriptor).c_str());
+      }
+      return nullptr;
+    }
     mirror::Class* cp_klass;
     if (FindClassInPathClassLoader(soa, self, descriptor, hash, class_loader, &cp_klass)) {
       // The chain was understood. So the value in cp_klass is either the class we were looking
@@ -2404,6 +2550,12 @@ mirror::Class* ClassLinker::FindClass(Thread* self,
       if (cp_klass != nullptr) {
         return cp_klass;
       }
+      // Don't cache a class which failed to be defined, the class loader throws its error.
+      if (known_chain &&
+          !HasClassDef(descriptor, hash, boot_class_path_) &&
+          !HasClassDef(descriptor, hash, chain_dex_files)) {
+        class_table->AddToNegativeCache(descriptor, hash, chain_dex_files);
+      }
       // TODO: We handle the boot classpath loader in FindClassInPathClassLoader. Try to unify this
       //       and the branch above. TODO: throw the right exception here.
 
@@ -3621,14 +3773,12 @@ mirror::Class* ClassLinker::LookupClass(Thread* self,
                                         const char* descriptor,
                                         size_t hash,
                                         mirror::ClassLoader* class_loader) {
-  {
-    ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
-    ClassTable* const class_table = ClassTableForClassLoader(class_loader);
-    if (class_table != nullptr) {
-      mirror::Class* result = class_table->Lookup(descriptor, hash);
-      if (result != nullptr) {
-        return result;
-      }
+  // The class tables are looked up without locks.
+  ClassTable* const class_table = ClassTableForClassLoader(class_loader);
+  if (class_table != nullptr) {
+    mirror::Class* result = class_table->Lookup(descriptor, hash);
+    if (result != nullptr) {
+      return result;
     }
   }
   if (class_loader != nullptr || !dex_cache_boot_image_class_lookup_required_) {
@@ -3684,9 +3834,9 @@ void ClassLinker::AddImageClassesToClassTable(std::vector<gc::space::ImageSpace*
   for (mirror::ObjectArray<mirror::DexCache>* dex_caches : dex_caches_vector) {
     for (int32_t i = 0; i < dex_caches->GetLength(); i++) {
       mirror::DexCache* dex_cache = dex_caches->Get(i);
-      GcRoot<mirror::Class>* types = dex_cache->GetResolvedTypes();
       for (int32_t j = 0, num_types = dex_cache->NumResolvedTypes(); j < num_types; j++) {
-        mirror::Class* klass = types[j].Read();
+        uint32_t type_idx;
+        mirror::Class* klass = dex_cache->GetTypeSlot(j, &type_idx);
         if (klass != nullptr) {
           DCHECK_EQ(klass->GetClassLoader(), class_loader);
           const char* descriptor = klass->GetDescriptor(&temp);
@@ -5055,8 +5205,9 @@ void ClassLinker::RegisterClassLoader(mirror::ClassLoader* class_loader) {
   Thread* const self = Thread::Current();
   ClassLoaderData data;
   data.weak_root = self->GetJniEnv()->vm->AddWeakGlobalRef(self, class_loader);
-  // Create and set the class table.
+  // Create and set the class table. It is read without locks, so publish it fully constructed.
   data.class_table = new ClassTable;
+  QuasiAtomic::ThreadFenceRelease();
   class_loader->SetClassTable(data.class_table);
   // Create and set the linear allocator.
   data.allocator = Runtime::Current()->CreateLinearAlloc();
@@ -5223,6 +5374,11 @@ bool ClassLinker::LinkClass(Thread* self,
     // Return the new class.
     h_new_class_out->Assign(h_new_class.Get());
   }
+
+  ClassHierarchyAnalysis* const cha = Runtime::Current()->GetClassHierarchyAnalysis();
+  if (cha != nullptr) {
+    cha->UpdateAfterLoadingOf(*h_new_class_out);
+  }
   return true;
 }
 
@@ -7983,6 +8139,9 @@ void ClassLinker::DumpForSigQuit(std::ostream& os) {
   ReaderMutexLock mu(soa.Self(), *Locks::classlinker_classes_lock_);
   os << "Zygote loaded classes=" << NumZygoteClasses() << " post zygote classes="
      << NumNonZygoteClasses() << "\n";
+  if (kUseHashedDexCache && mirror::DexCache::kCountHashedCacheLookups) {
+    mirror::DexCache::DumpHashedCacheStats(os);
+  }
 }
 
 class CountClassesVisitor : public ClassLoaderVisitor {
@@ -8267,6 +8426,23 @@ void ClassLinker::CleanupClassLoaders() {
   }
 }
 
+void ClassLinker::ReclaimClassTableStorage(Thread* self) {
+  ClassTable::RetiredStorage retired;
+  {
+    ScopedObjectAccess soa(self);
+    ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
+    boot_class_table_.TakeRetired(&retired);
+    for (const ClassLoaderData& data : class_loaders_) {
+      data.class_table->TakeRetired(&retired);
+    }
+  }
+  if (retired.Empty()) {
+    return;
+  }
+  // The lock free lookups never suspend.
+  Runtime::Current()->GetThreadList()->RunEmptyCheckpoint();
+}
+
 std::set<DexCacheResolvedClasses> ClassLinker::GetResolvedClasses(bool ignore_boot_classes) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   ScopedObjectAccess soa(Thread::Current());
@@ -8288,7 +8464,8 @@ std::set<DexCacheResolvedClasses> ClassLinker::GetResolvedClasses(bool ignore_bo
     const DexFile* dex_file = dex_cache->GetDexFile();
     const std::string& location = dex_file->GetLocation();
     const size_t num_class_defs = dex_file->NumClassDefs();
-    // Use the resolved types, this will miss array classes.
+    // Use the resolved types, this will miss array classes, and the classes evicted from a hashed
+    // resolved types cache.
     const size_t num_types = dex_file->NumTypeIds();
     VLOG(class_linker) << "Collecting class profile for dex file " << location
                        << " types=" << num_types << " class_defs=" << num_class_defs;
@@ -8297,9 +8474,11 @@ std::set<DexCacheResolvedClasses> ClassLinker::GetResolvedClasses(bool ignore_bo
                                              dex_file->GetLocationChecksum());
     size_t num_resolved = 0;
     std::unordered_set<uint16_t> class_set;
-    CHECK_EQ(num_types, dex_cache->NumResolvedTypes());
-    for (size_t i = 0; i < num_types; ++i) {
-      mirror::Class* klass = dex_cache->GetResolvedType(i);
+    const size_t num_type_slots = dex_cache->NumResolvedTypes();
+    CHECK_EQ(mirror::DexCache::NumTypeSlots(num_types), num_type_slots);
+    for (size_t i = 0; i < num_type_slots; ++i) {
+      uint32_t type_idx;
+      mirror::Class* klass = dex_cache->GetTypeSlot(i, &type_idx);
       // Filter out null class loader since that is the boot class loader.
       if (klass == nullptr || (ignore_boot_classes && klass->GetClassLoader() == nullptr)) {
         continue;
@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "art_method.h"
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
@@ -48,6 +49,8 @@ namespace mirror {
   class DexCache;
   class DexCachePointerArray;
   class DexCacheTest_Open_Test;
+  class DexCacheTest_ResolvedStrings_Test;
+  class DexCacheTest_ResolvedTypes_Test;
   class IfTable;
   template<class T> class ObjectArray;
   class StackTraceElement;
@@ -178,6 +181,13 @@ class ClassLinker {
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!dex_lock_);
 
+  // Collects the dex files which FindClassInPathClassLoader searches below the boot class path
+  // for class_loader. Returns false if the class-loader chain could not be handled.
+  bool GetPathClassLoaderDexFiles(ScopedObjectAccessAlreadyRunnable& soa,
+                                  mirror::ClassLoader* class_loader,
+                                  std::vector<const DexFile*>* dex_files)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Finds a class by its descriptor using the "system" class loader, ie by searching the
   // boot_class_path_.
   mirror::Class* FindSystemClass(Thread* self, const char* descriptor)
@@ -586,6 +596,11 @@ class ClassLinker {
       REQUIRES(!Locks::classlinker_classes_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Free the storage which the class tables replaced while lookups may have been using it. Runs
+  // a checkpoint, so it must be called without holding the mutator lock.
+  void ReclaimClassTableStorage(Thread* self)
+      REQUIRES(!Locks::classlinker_classes_lock_, !Locks::mutator_lock_);
+
   // Unlike GetOrCreateAllocatorForClassLoader, GetAllocatorForClassLoader asserts that the
   // allocator for this class loader is already created.
   LinearAlloc* GetAllocatorForClassLoader(mirror::ClassLoader* class_loader)
@@ -659,7 +674,7 @@ class ClassLinker {
     // jweak decode that triggers read barriers (and mark them alive unnecessarily and mess with
     // class unloading.)
     const DexFile* dex_file;
-    GcRoot<mirror::Class>* resolved_types;
+    mirror::TypeDexCacheType* resolved_types;
   };
 
  private:
@@ -1177,7 +1192,10 @@ class ClassLinker {
   friend class JniCompilerTest;  // for GetRuntimeQuickGenericJniStub
   friend class JniInternalTest;  // for GetRuntimeQuickGenericJniStub
   ART_FRIEND_TEST(ClassLinkerTest, RegisterDexFileName);  // for DexLock, and RegisterDexFileLocked
+  ART_FRIEND_TEST(ClassLinkerTest, FindClassNegativeCache);  // for ClassTableForClassLoader
   ART_FRIEND_TEST(mirror::DexCacheTest, Open);  // for AllocDexCache
+  ART_FRIEND_TEST(mirror::DexCacheTest, ResolvedStrings);  // for AllocDexCache
+  ART_FRIEND_TEST(mirror::DexCacheTest, ResolvedTypes);  // for AllocDexCache
   DISALLOW_COPY_AND_ASSIGN(ClassLinker);
 };
 
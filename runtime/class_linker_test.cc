@@ -22,6 +22,7 @@
 #include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "class_linker-inl.h"
+#include "class_table-inl.h"
 #include "common_runtime_test.h"
 #include "dex_file.h"
 #include "experimental_flags.h"
@@ -41,6 +42,7 @@
 #include "handle_scope-inl.h"
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -1265,4 +1267,160 @@ TEST_F(ClassLinkerTest, RegisterDexFileName) {
   }
 }
 
+class CollectClassesVisitor : public ClassVisitor {
+ public:
+  explicit CollectClassesVisitor(std::vector<mirror::Class*>* classes) : classes_(classes) {}
+
+  bool operator()(mirror::Class* klass) OVERRIDE {
+    classes_->push_back(klass);
+    return true;
+  }
+
+ private:
+  std::vector<mirror::Class*>* const classes_;
+};
+
+// Check that the lock free lookups see the classes inserted while the table grew.
+TEST_F(ClassLinkerTest, ClassTableLookupAfterGrowth) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<mirror::Class*> classes;
+  CollectClassesVisitor visitor(&classes);
+  class_linker_->VisitClasses(&visitor);
+  ASSERT_GT(classes.size(), 100u);
+  ClassTable table;
+  std::string temp;
+  for (mirror::Class* klass : classes) {
+    table.Insert(klass);
+  }
+  for (mirror::Class* klass : classes) {
+    const char* descriptor = klass->GetDescriptor(&temp);
+    EXPECT_EQ(klass, table.Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor)));
+    EXPECT_TRUE(table.Contains(klass));
+  }
+  const char* descriptor = classes[0]->GetDescriptor(&temp);
+  EXPECT_TRUE(table.Remove(descriptor));
+  EXPECT_TRUE(table.Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor)) == nullptr);
+  ClassTable::RetiredStorage retired;
+  table.TakeRetired(&retired);
+  EXPECT_FALSE(retired.Empty());
+}
+
+class ClassTableLookupTask : public Task {
+ public:
+  ClassTableLookupTask(ClassTable* table,
+                       const std::vector<mirror::Class*>* classes,
+                       size_t num_inserted,
+                       AtomicInteger* done)
+      : table_(table), classes_(classes), num_inserted_(num_inserted), done_(done) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    std::string temp;
+    do {
+      for (size_t i = 0; i != classes_->size(); ++i) {
+        mirror::Class* klass = (*classes_)[i];
+        const char* descriptor = klass->GetDescriptor(&temp);
+        mirror::Class* result = table_->Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor));
+        if (i < num_inserted_) {
+          // Inserted before the lookups started, must always be found.
+          ASSERT_EQ(klass, result) << descriptor;
+        } else if (result != nullptr) {
+          ASSERT_EQ(klass, result) << descriptor;
+        }
+      }
+    } while (done_->LoadSequentiallyConsistent() == 0);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ClassTable* const table_;
+  const std::vector<mirror::Class*>* const classes_;
+  const size_t num_inserted_;
+  AtomicInteger* const done_;
+};
+
+// Check the lock free lookups while another thread inserts and grows the table.
+TEST_F(ClassLinkerTest, ClassTableConcurrentLookup) {
+  Thread* self = Thread::Current();
+  static constexpr size_t kNumThreads = 4;
+  std::vector<mirror::Class*> classes;
+  ClassTable table;
+  size_t num_inserted;
+  {
+    ScopedObjectAccess soa(self);
+    CollectClassesVisitor visitor(&classes);
+    class_linker_->VisitClasses(&visitor);
+    ASSERT_GT(classes.size(), 100u);
+    num_inserted = classes.size() / 4;
+    for (size_t i = 0; i != num_inserted; ++i) {
+      table.Insert(classes[i]);
+    }
+  }
+  AtomicInteger done(0);
+  ThreadPool thread_pool("Class table lookup thread pool", kNumThreads);
+  for (size_t i = 0; i != kNumThreads; ++i) {
+    thread_pool.AddTask(self, new ClassTableLookupTask(&table, &classes, num_inserted, &done));
+  }
+  thread_pool.StartWorkers(self);
+  {
+    ScopedObjectAccess soa(self);
+    for (size_t i = num_inserted; i != classes.size(); ++i) {
+      table.Insert(classes[i]);
+    }
+  }
+  done.StoreSequentiallyConsistent(1);
+  thread_pool.Wait(self, /* do_work */ false, /* may_hold_locks */ false);
+  ScopedObjectAccess soa(self);
+  std::string temp;
+  for (mirror::Class* klass : classes) {
+    const char* descriptor = klass->GetDescriptor(&temp);
+    EXPECT_EQ(klass, table.Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor)));
+  }
+  ClassTable::RetiredStorage retired;
+  table.TakeRetired(&retired);
+  EXPECT_FALSE(retired.Empty());
+}
+
+TEST_F(ClassLinkerTest, ClassTableNegativeCache) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassTable table;
+  const char* descriptor = "LDoesNotExist;";
+  const size_t hash = ComputeModifiedUtf8Hash(descriptor);
+  std::vector<const DexFile*> dex_files;
+  EXPECT_FALSE(table.InNegativeCache(descriptor, hash, dex_files));
+  table.AddToNegativeCache(descriptor, hash, dex_files);
+  EXPECT_TRUE(table.InNegativeCache(descriptor, hash, dex_files));
+  EXPECT_FALSE(table.InNegativeCache("LDoesNotExistEither;", hash, dex_files));
+  // A new dex file in the chain may define the class.
+  dex_files.push_back(java_lang_dex_file_);
+  EXPECT_FALSE(table.InNegativeCache(descriptor, hash, dex_files));
+  table.AddToNegativeCache("LDoesNotExistEither;", hash, dex_files);
+  EXPECT_TRUE(table.InNegativeCache("LDoesNotExistEither;", hash, dex_files));
+  EXPECT_FALSE(table.InNegativeCache(descriptor, hash, dex_files));
+}
+
+TEST_F(ClassLinkerTest, FindClassNegativeCache) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("Nested"))));
+  ASSERT_TRUE(class_linker_->FindClass(soa.Self(), "LNested;", class_loader) != nullptr);
+  std::vector<const DexFile*> dex_files;
+  ASSERT_TRUE(class_linker_->GetPathClassLoaderDexFiles(soa, class_loader.Get(), &dex_files));
+  ASSERT_EQ(1u, dex_files.size());
+  ClassTable* table = class_linker_->ClassTableForClassLoader(class_loader.Get());
+  ASSERT_TRUE(table != nullptr);
+  const char* descriptor = "LNested$DoesNotExist;";
+  table->AddToNegativeCache(descriptor, ComputeModifiedUtf8Hash(descriptor), dex_files);
+  // A cached miss throws without asking the class loader.
+  EXPECT_TRUE(class_linker_->FindClass(soa.Self(), descriptor, class_loader) == nullptr);
+  ASSERT_TRUE(soa.Self()->IsExceptionPending());
+  EXPECT_TRUE(soa.Self()->GetException()->InstanceOf(
+      class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/ClassNotFoundException;")));
+  soa.Self()->ClearException();
+}
+
 }  // namespace art
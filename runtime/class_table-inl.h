@@ -24,8 +24,8 @@ namespace art {
 template<class Visitor>
 void ClassTable::VisitRoots(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (GcRoot<mirror::Class>& root : class_set) {
+  for (ClassSet* class_set : *class_sets_.LoadRelaxed()) {
+    for (GcRoot<mirror::Class>& root : *class_set) {
       visitor.VisitRoot(root.AddressWithoutBarrier());
     }
   }
@@ -37,8 +37,8 @@ void ClassTable::VisitRoots(Visitor& visitor) {
 template<class Visitor>
 void ClassTable::VisitRoots(const Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (GcRoot<mirror::Class>& root : class_set) {
+  for (ClassSet* class_set : *class_sets_.LoadRelaxed()) {
+    for (GcRoot<mirror::Class>& root : *class_set) {
       visitor.VisitRoot(root.AddressWithoutBarrier());
     }
   }
@@ -50,8 +50,8 @@ void ClassTable::VisitRoots(const Visitor& visitor) {
 template <typename Visitor>
 bool ClassTable::Visit(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (GcRoot<mirror::Class>& root : class_set) {
+  for (ClassSet* class_set : *class_sets_.LoadRelaxed()) {
+    for (GcRoot<mirror::Class>& root : *class_set) {
       if (!visitor(root.Read())) {
         return false;
       }
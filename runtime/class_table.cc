@@ -16,38 +16,64 @@
 
 #include "class_table.h"
 
+#include <iterator>
+
 #include "mirror/class-inl.h"
 
 namespace art {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock),
+      class_sets_(nullptr) {
   Runtime* const runtime = Runtime::Current();
-  classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
-                              runtime->GetHashTableMaxLoadFactor()));
+  ClassSetList* class_sets = new ClassSetList();
+  class_sets->push_back(new ClassSet(runtime->GetHashTableMinLoadFactor(),
+                                     runtime->GetHashTableMaxLoadFactor()));
+  class_sets_.StoreRelaxed(class_sets);
+}
+
+ClassTable::~ClassTable() {
+  std::unique_ptr<ClassSetList> class_sets(class_sets_.LoadRelaxed());
+  for (ClassSet* class_set : *class_sets) {
+    delete class_set;
+  }
+}
+
+void ClassTable::Publish(ClassSetList* class_sets) {
+  retired_.lists.emplace_back(class_sets_.LoadRelaxed());
+  // Release so that lookups see the sets of the list fully built.
+  class_sets_.StoreRelease(class_sets);
+}
+
+void ClassTable::TakeRetired(RetiredStorage* retired) {
+  WriterMutexLock mu(Thread::Current(), lock_);
+  std::move(retired_.lists.begin(), retired_.lists.end(), std::back_inserter(retired->lists));
+  std::move(retired_.sets.begin(), retired_.sets.end(), std::back_inserter(retired->sets));
+  retired_.lists.clear();
+  retired_.sets.clear();
 }
 
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.push_back(ClassSet());
+  ClassSetList* class_sets = new ClassSetList(*class_sets_.LoadRelaxed());
+  class_sets->push_back(new ClassSet());
+  Publish(class_sets);
 }
 
 bool ClassTable::Contains(mirror::Class* klass) {
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(GcRoot<mirror::Class>(klass));
-    if (it != class_set.end()) {
-      return it->Read() == klass;
-    }
-  }
-  return false;
+  return LookupByDescriptor(klass) == klass;
 }
 
 mirror::Class* ClassTable::LookupByDescriptor(mirror::Class* klass) {
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(GcRoot<mirror::Class>(klass));
-    if (it != class_set.end()) {
-      return it->Read();
+  GcRoot<mirror::Class> key(klass);
+  for (ClassSet* class_set : *class_sets_.LoadAcquire()) {
+    auto it = class_set->Find(key);
+    if (it != class_set->end()) {
+      // Read the slot once more, a writer may have changed it since it matched.
+      GcRoot<mirror::Class> found = *it;
+      if (ClassDescriptorHashEquals()(found, key)) {
+        return found.Read();
+      }
     }
   }
   return nullptr;
@@ -55,11 +81,13 @@ mirror::Class* ClassTable::LookupByDescriptor(mirror::Class* klass) {
 
 mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
+  const ClassSetList& class_sets = *class_sets_.LoadRelaxed();
   // Should only be updating latest table.
-  auto existing_it = classes_.back().FindWithHash(descriptor, hash);
-  if (kIsDebugBuild && existing_it == classes_.back().end()) {
-    for (const ClassSet& class_set : classes_) {
-      if (class_set.FindWithHash(descriptor, hash) != class_set.end()) {
+  ClassSet* const latest = class_sets.back();
+  auto existing_it = latest->FindWithHash(descriptor, hash);
+  if (kIsDebugBuild && existing_it == latest->end()) {
+    for (const ClassSet* class_set : class_sets) {
+      if (class_set->FindWithHash(descriptor, hash) != class_set->end()) {
         LOG(FATAL) << "Updating class found in frozen table " << descriptor;
       }
     }
@@ -72,31 +100,36 @@ mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* kl
   CHECK(!klass->IsTemp()) << descriptor;
   VerifyObject(klass);
   // Update the element in the hash set with the new class. This is safe to do since the descriptor
-  // doesn't change.
+  // doesn't change. Lookups see either class.
+  QuasiAtomic::ThreadFenceRelease();
   *existing_it = GcRoot<mirror::Class>(klass);
   return existing;
 }
 
 size_t ClassTable::NumZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
+  const ClassSetList& class_sets = *class_sets_.LoadRelaxed();
   size_t sum = 0;
-  for (size_t i = 0; i < classes_.size() - 1; ++i) {
-    sum += classes_[i].Size();
+  for (size_t i = 0; i < class_sets.size() - 1; ++i) {
+    sum += class_sets[i]->Size();
   }
   return sum;
 }
 
 size_t ClassTable::NumNonZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  return classes_.back().Size();
+  return class_sets_.LoadRelaxed()->back()->Size();
 }
 
 mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.FindWithHash(descriptor, hash);
-    if (it != class_set.end()) {
-     return it->Read();
+  for (ClassSet* class_set : *class_sets_.LoadAcquire()) {
+    auto it = class_set->FindWithHash(descriptor, hash);
+    if (it != class_set->end()) {
+      // Read the slot once more, a writer may have changed it since it matched.
+      GcRoot<mirror::Class> found = *it;
+      if (ClassDescriptorHashEquals()(found, descriptor)) {
+        return found.Read();
+      }
     }
   }
   return nullptr;
@@ -104,26 +137,54 @@ mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
 
 void ClassTable::Insert(mirror::Class* klass) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().Insert(GcRoot<mirror::Class>(klass));
+  InsertWithHashLocked(klass, ClassDescriptorHashEquals()(GcRoot<mirror::Class>(klass)));
 }
 
 void ClassTable::InsertWithoutLocks(mirror::Class* klass) {
-  classes_.back().Insert(GcRoot<mirror::Class>(klass));
+  InsertWithHashLocked(klass, ClassDescriptorHashEquals()(GcRoot<mirror::Class>(klass)));
 }
 
 void ClassTable::InsertWithHash(mirror::Class* klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(GcRoot<mirror::Class>(klass), hash);
+  InsertWithHashLocked(klass, hash);
+}
+
+void ClassTable::InsertWithHashLocked(mirror::Class* klass, size_t hash) {
+  ClassSetList* const class_sets = class_sets_.LoadRelaxed();
+  ClassSet* const class_set = class_sets->back();
+  if (class_set->Size() < class_set->ElementsUntilExpand()) {
+    // The class only fills an empty slot, which lookups either see before or after. Make sure
+    // they see the class behind the slot, too.
+    QuasiAtomic::ThreadFenceRelease();
+    class_set->InsertWithHash(GcRoot<mirror::Class>(klass), hash);
+    return;
+  }
+  // Expanding rehashes the set in place, under the lookups. Expand a copy instead.
+  ClassSet* const expanded = new ClassSet(*class_set);
+  expanded->InsertWithHash(GcRoot<mirror::Class>(klass), hash);
+  ClassSetList* const new_class_sets = new ClassSetList(*class_sets);
+  new_class_sets->back() = expanded;
+  Publish(new_class_sets);
+  retired_.sets.emplace_back(class_set);
 }
 
 bool ClassTable::Remove(const char* descriptor) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(descriptor);
-    if (it != class_set.end()) {
-      class_set.Erase(it);
-      return true;
+  ClassSetList* const class_sets = class_sets_.LoadRelaxed();
+  for (size_t i = 0; i < class_sets->size(); ++i) {
+    ClassSet* const class_set = (*class_sets)[i];
+    if (class_set->Find(descriptor) == class_set->end()) {
+      continue;
     }
+    // Erasing shifts the following entries back in place, under the lookups, which could then
+    // miss an unrelated class. Erase from a copy instead, classes are rarely removed.
+    ClassSet* const copy = new ClassSet(*class_set);
+    copy->Erase(copy->Find(descriptor));
+    ClassSetList* const new_class_sets = new ClassSetList(*class_sets);
+    (*new_class_sets)[i] = copy;
+    Publish(new_class_sets);
+    retired_.sets.emplace_back(class_set);
+    return true;
   }
   return false;
 }
@@ -134,16 +195,23 @@ uint32_t ClassTable::ClassDescriptorHashEquals::operator()(const GcRoot<mirror::
   return ComputeModifiedUtf8Hash(root.Read()->GetDescriptor(&temp));
 }
 
+// The equality functions are also called by lookups without the lock, for which a slot may be
+// cleared between the check that it is not empty and the comparison.
 bool ClassTable::ClassDescriptorHashEquals::operator()(const GcRoot<mirror::Class>& a,
                                                        const GcRoot<mirror::Class>& b) const {
-  DCHECK_EQ(a.Read()->GetClassLoader(), b.Read()->GetClassLoader());
+  mirror::Class* const a_class = a.Read();
+  if (a_class == nullptr) {
+    return false;
+  }
+  DCHECK_EQ(a_class->GetClassLoader(), b.Read()->GetClassLoader());
   std::string temp;
-  return a.Read()->DescriptorEquals(b.Read()->GetDescriptor(&temp));
+  return a_class->DescriptorEquals(b.Read()->GetDescriptor(&temp));
 }
 
 bool ClassTable::ClassDescriptorHashEquals::operator()(const GcRoot<mirror::Class>& a,
                                                        const char* descriptor) const {
-  return a.Read()->DescriptorEquals(descriptor);
+  mirror::Class* const a_class = a.Read();
+  return a_class != nullptr && a_class->DescriptorEquals(descriptor);
 }
 
 uint32_t ClassTable::ClassDescriptorHashEquals::operator()(const char* descriptor) const {
@@ -167,8 +235,8 @@ size_t ClassTable::WriteToMemory(uint8_t* ptr) const {
   ClassSet combined;
   // Combine all the class sets in case there are multiple, also adjusts load factor back to
   // default in case classes were pruned.
-  for (const ClassSet& class_set : classes_) {
-    for (const GcRoot<mirror::Class>& root : class_set) {
+  for (const ClassSet* class_set : *class_sets_.LoadRelaxed()) {
+    for (const GcRoot<mirror::Class>& root : *class_set) {
       combined.Insert(root);
     }
   }
@@ -190,11 +258,43 @@ size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.insert(classes_.begin(), std::move(set));
+  ClassSetList* class_sets = new ClassSetList(*class_sets_.LoadRelaxed());
+  class_sets->insert(class_sets->begin(), new ClassSet(std::move(set)));
+  Publish(class_sets);
 }
 
 void ClassTable::ClearStrongRoots() {
   WriterMutexLock mu(Thread::Current(), lock_);
   strong_roots_.clear();
 }
+
+bool ClassTable::InNegativeCache(const char* descriptor,
+                                 size_t hash,
+                                 const std::vector<const DexFile*>& dex_files) {
+  ReaderMutexLock mu(Thread::Current(), lock_);
+  if (dex_files != negative_cache_dex_files_) {
+    return false;
+  }
+  auto range = negative_cache_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == descriptor) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClassTable::AddToNegativeCache(const char* descriptor,
+                                    size_t hash,
+                                    const std::vector<const DexFile*>& dex_files) {
+  WriterMutexLock mu(Thread::Current(), lock_);
+  if (dex_files != negative_cache_dex_files_) {
+    negative_cache_.clear();
+    negative_cache_dex_files_ = dex_files;
+  } else if (negative_cache_.size() >= kMaxNegativeCacheSize) {
+    negative_cache_.clear();
+  }
+  negative_cache_.emplace(hash, descriptor);
+}
+
 }  // namespace art
@@ -17,10 +17,13 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "atomic.h"
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
@@ -37,6 +40,13 @@ namespace mirror {
 }  // namespace mirror
 
 // Each loader has a ClassTable
+//
+// Lookups don't take the lock: they load the current list of class sets with an acquire, and
+// only the last set is ever inserted into. While it has room, a class is stored into an empty
+// slot after a release fence. A full set is copied and expanded instead, and published with a
+// new list, as is a set which a class is removed from. The replaced lists and sets are retired
+// until ClassLinker::ReclaimClassTableStorage has made sure that no lookup may still be using
+// them. Writers are serialized by the lock.
 class ClassTable {
  public:
   class ClassDescriptorHashEquals {
@@ -67,11 +77,21 @@ class ClassTable {
       ClassDescriptorHashEquals, TrackingAllocator<GcRoot<mirror::Class>, kAllocatorTagClassTable>>
       ClassSet;
 
+  // Storage replaced while lookups may still have been using it.
+  struct RetiredStorage {
+    std::vector<std::unique_ptr<std::vector<ClassSet*>>> lists;
+    std::vector<std::unique_ptr<ClassSet>> sets;
+
+    bool Empty() const {
+      return lists.empty() && sets.empty();
+    }
+  };
+
   ClassTable();
+  ~ClassTable();
 
   // Used by image writer for checking.
   bool Contains(mirror::Class* klass)
-      REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Freeze the current class tables by allocating a new table and never updating or modifying the
@@ -110,14 +130,14 @@ class ClassTable {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Return the first class that matches the descriptor. Returns null if there are none.
+  // Return the first class that matches the descriptor. Returns null if there are none. Does not
+  // take the lock: it may or may not find a class which is being inserted or removed at the same
+  // time, and always finds the other classes.
   mirror::Class* Lookup(const char* descriptor, size_t hash)
-      REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Return the first class that matches the descriptor of klass. Returns null if there are none.
   mirror::Class* LookupByDescriptor(mirror::Class* klass)
-      REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   void Insert(mirror::Class* klass)
@@ -128,7 +148,8 @@ class ClassTable {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Returns true if the class was found and removed, false otherwise.
+  // Returns true if the class was found and removed, false otherwise. Copies the set which held
+  // the class, see Lookup().
   bool Remove(const char* descriptor)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -158,23 +179,61 @@ class ClassTable {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Returns true if the descriptor was added to the negative cache: looking it up through the
+  // class loader and its parents found no class. Entries are only valid for the dex files which
+  // the class loader chain had when they were added.
+  bool InNegativeCache(const char* descriptor,
+                       size_t hash,
+                       const std::vector<const DexFile*>& dex_files)
+      REQUIRES(!lock_);
+
+  // Clears the negative cache first if the dex files of the class loader chain changed.
+  void AddToNegativeCache(const char* descriptor,
+                          size_t hash,
+                          const std::vector<const DexFile*>& dex_files)
+      REQUIRES(!lock_);
+
+  // Move the storage retired since the last call to retired. The caller frees it once no lookup
+  // may be using it.
+  void TakeRetired(RetiredStorage* retired) REQUIRES(!lock_);
+
   ReaderWriterMutex& GetLock() {
     return lock_;
   }
 
  private:
+  typedef std::vector<ClassSet*> ClassSetList;
+
   void InsertWithoutLocks(mirror::Class* klass) NO_THREAD_SAFETY_ANALYSIS;
 
+  void InsertWithHashLocked(mirror::Class* klass, size_t hash)
+      REQUIRES(lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Replace the list of class sets, retiring the current one.
+  void Publish(ClassSetList* class_sets) REQUIRES(lock_);
+
+  // Once the negative cache has this many entries, it is cleared before adding more.
+  static constexpr size_t kMaxNegativeCacheSize = 1024;
+
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
   // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // Read without the lock, see above.
+  Atomic<ClassSetList*> class_sets_;
+  RetiredStorage retired_ GUARDED_BY(lock_);
+  // Descriptors which the class loader failed to find in its dex files, by hash.
+  std::unordered_multimap<size_t, std::string> negative_cache_ GUARDED_BY(lock_);
+  // The dex files of the class loader chain which the negative cache was filled for. A DexPathList
+  // may add dex files to the chain later.
+  std::vector<const DexFile*> negative_cache_dex_files_ GUARDED_BY(lock_);
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
   std::vector<GcRoot<mirror::Object>> strong_roots_ GUARDED_BY(lock_);
 
   friend class ImageWriter;  // for InsertWithoutLocks.
+  DISALLOW_COPY_AND_ASSIGN(ClassTable);
 };
 
 }  // namespace art
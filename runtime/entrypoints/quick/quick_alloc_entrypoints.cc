@@ -38,7 +38,7 @@ extern "C" mirror::Object* artAllocObjectFromCode ##suffix##suffix2( \
       size_t byte_count = klass->GetObjectSize(); \
       byte_count = RoundUp(byte_count, gc::space::BumpPointerSpace::kAlignment); \
       mirror::Object* obj; \
-      if (LIKELY(byte_count < self->TlabSize())) { \
+      if (LIKELY(byte_count < self->TlabFastPathSize())) { \
         obj = self->AllocTlab(byte_count); \
         DCHECK(obj != nullptr) << "AllocTlab can't fail"; \
         obj->SetClass(klass); \
@@ -64,7 +64,7 @@ extern "C" mirror::Object* artAllocObjectFromCodeResolved##suffix##suffix2( \
       size_t byte_count = klass->GetObjectSize(); \
       byte_count = RoundUp(byte_count, gc::space::BumpPointerSpace::kAlignment); \
       mirror::Object* obj; \
-      if (LIKELY(byte_count < self->TlabSize())) { \
+      if (LIKELY(byte_count < self->TlabFastPathSize())) { \
         obj = self->AllocTlab(byte_count); \
         DCHECK(obj != nullptr) << "AllocTlab can't fail"; \
         obj->SetClass(klass); \
@@ -89,7 +89,7 @@ extern "C" mirror::Object* artAllocObjectFromCodeInitialized##suffix##suffix2( \
     size_t byte_count = klass->GetObjectSize(); \
     byte_count = RoundUp(byte_count, gc::space::BumpPointerSpace::kAlignment); \
     mirror::Object* obj; \
-    if (LIKELY(byte_count < self->TlabSize())) { \
+    if (LIKELY(byte_count < self->TlabFastPathSize())) { \
       obj = self->AllocTlab(byte_count); \
       DCHECK(obj != nullptr) << "AllocTlab can't fail"; \
       obj->SetClass(klass); \
@@ -97,6 +97,16 @@ extern "C" mirror::Object* artReadBarrierSlow(mirror::Object* ref,
 extern "C" mirror::Object* artReadBarrierForRootSlow(GcRoot<mirror::Object>* root)
     SHARED_REQUIRES(Locks::mutator_lock_) HOT_ATTR;
 
+// JIT entrypoint called by baseline code once `method` is hot enough to be
+// compiled with all optimizations.
+extern "C" void artCompileOptimized(ArtMethod* method)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
+// JIT entrypoint called by baseline code to record the class of `receiver` in the
+// inline cache of the invoke at `dex_pc` in `caller`.
+extern "C" void artUpdateInlineCache(mirror::Object* receiver, ArtMethod* caller, uint32_t dex_pc)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_ENTRYPOINTS_QUICK_QUICK_ENTRYPOINTS_H_
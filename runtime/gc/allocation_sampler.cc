@@ -0,0 +1,397 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <cmath>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "base/time_utils.h"
+#include "base/unix_file/fd_file.h"
+#include "gc/heap.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "os.h"
+#include "runtime.h"
+#include "stack.h"
+#include "thread-inl.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+class AllocSampleStackVisitor : public StackVisitor {
+ public:
+  AllocSampleStackVisitor(Thread* thread, AllocRecordStackTrace* trace_out)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFramesNoResolve),
+        trace_(trace_out) {}
+
+  bool VisitFrame() OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    if (trace_->GetDepth() >= AllocationSampler::kMaxStackDepth) {
+      return false;
+    }
+    ArtMethod* m = GetMethod();
+    // m may be null if we have inlined methods of unresolved classes. b/27858645
+    if (m != nullptr && !m->IsRuntimeMethod()) {
+      m = m->GetInterfaceMethodIfProxy(sizeof(void*));
+      trace_->AddStackElement(AllocRecordStackTraceElement(m, GetDexPc()));
+    }
+    return true;
+  }
+
+ private:
+  AllocRecordStackTrace* const trace_;
+};
+
+void AllocationSampler::Start(size_t sample_interval, const std::string& profile_file) {
+  CHECK_GT(sample_interval, 0u);
+  Thread* self = Thread::Current();
+  Heap* heap = Runtime::Current()->GetHeap();
+  // The fast paths of the region TLAB allocator stop at the sample points, and the concurrent
+  // copying collector never switches to another allocator. The other allocators have fast paths
+  // that do not count down the allocated bytes.
+  bool instrument_entrypoints = !heap->IsGcConcurrentAndMoving() ||
+      heap->GetCurrentAllocator() != kAllocatorTypeRegionTLAB;
+  {
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    if (heap->IsAllocSamplingEnabled()) {
+      return;  // Already enabled, bail.
+    }
+    AllocationSampler* sampler = heap->GetAllocationSampler();
+    if (sampler == nullptr) {
+      sampler = new AllocationSampler;
+      heap->SetAllocationSampler(sampler);
+    }
+    sampler->sample_interval_ = sample_interval;
+    sampler->profile_file_ = profile_file;
+    sampler->random_.seed(static_cast<std::minstd_rand::result_type>(NanoTime()));
+    sampler->num_samples_ = 0;
+    sampler->sites_.clear();
+    sampler->instrumented_entrypoints_ = instrument_entrypoints;
+    sampler->start_time_ns_ = NanoTime();
+    sampler->stop_time_ns_ = 0;
+    sampler->sampling_time_ns_ = 0;
+    LOG(INFO) << "Enabling allocation sampling every " << PrettySize(sample_interval);
+  }
+  if (instrument_entrypoints) {
+    Runtime::Current()->GetInstrumentation()->InstrumentQuickAllocEntryPoints();
+  }
+  {
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    heap->SetAllocSamplingEnabled(true);
+  }
+}
+
+void AllocationSampler::Stop() {
+  Thread* self = Thread::Current();
+  Heap* heap = Runtime::Current()->GetHeap();
+  bool instrumented_entrypoints;
+  {
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    if (!heap->IsAllocSamplingEnabled()) {
+      return;  // Already disabled, bail.
+    }
+    heap->SetAllocSamplingEnabled(false);
+    AllocationSampler* sampler = heap->GetAllocationSampler();
+    instrumented_entrypoints = sampler->instrumented_entrypoints_;
+    sampler->stop_time_ns_ = NanoTime();
+    LOG(INFO) << "Disabling allocation sampling";
+  }
+  // An allocation coming in before we uninstrument is dropped by SampleAllocation(). The threads
+  // restore the end of their TLAB in their next slow path allocation.
+  if (instrumented_entrypoints) {
+    Runtime::Current()->GetInstrumentation()->UninstrumentQuickAllocEntryPoints();
+  }
+}
+
+size_t AllocationSampler::NextSampleInterval() {
+  // Exponentially distributed, so that sampling is a Poisson process over the allocated bytes.
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double interval = -std::log1p(-uniform(random_)) * sample_interval_;
+  return std::max<size_t>(static_cast<size_t>(interval), 1u);
+}
+
+void AllocationSampler::SampleAllocation(Thread* self, mirror::Object** obj, size_t byte_count) {
+  bool armed = self->GetAllocSampleBytesRemaining() != 0;
+  if (armed) {
+    uint64_t start_ns = NanoTime();
+    // Get stack trace outside of lock in case there are allocations during the stack walk.
+    // The trace has no thread id so that the samples of all threads are aggregated.
+    AllocRecordStackTrace trace;
+    AllocSampleStackVisitor visitor(self, /*out*/ &trace);
+    {
+      StackHandleScope<1> hs(self);
+      auto obj_wrapper = hs.NewHandleWrapper(obj);
+      visitor.WalkStack();
+    }
+    std::string temp;
+    Site site = { std::move(trace), (*obj)->GetClass()->GetDescriptor(&temp) };
+
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    if (!Runtime::Current()->GetHeap()->IsAllocSamplingEnabled()) {
+      // In the process of shutting down sampling, bail.
+      return;
+    }
+    // An allocation of `byte_count` bytes is sampled with probability 1 - exp(-byte_count / mean
+    // interval). Weight the sample by the inverse of that probability.
+    double probability =
+        -std::expm1(-static_cast<double>(byte_count) / static_cast<double>(sample_interval_));
+    SiteCounts& counts = sites_[std::move(site)];
+    counts.objects += 1.0 / probability;
+    counts.bytes += byte_count / probability;
+    ++num_samples_;
+    self->SetAllocSampleBytesRemaining(NextSampleInterval());
+    sampling_time_ns_ += NanoTime() - start_ns;
+  } else {
+    // The first allocation of the thread since it started: only draw the first interval.
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    self->SetAllocSampleBytesRemaining(NextSampleInterval());
+  }
+}
+
+void AllocationSampler::VisitRoots(RootVisitor* visitor) {
+  BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(visitor, RootInfo(kRootDebugger));
+  for (const auto& entry : sites_) {
+    const AllocRecordStackTrace& trace = entry.first.trace;
+    for (size_t i = 0, depth = trace.GetDepth(); i < depth; ++i) {
+      const AllocRecordStackTraceElement& element = trace.GetStackElement(i);
+      DCHECK(element.GetMethod() != nullptr);
+      element.GetMethod()->VisitRoots(buffered_visitor, sizeof(void*));
+    }
+  }
+}
+
+uint64_t AllocationSampler::GetEstimatedBytes() const {
+  double bytes = 0.0;
+  for (const auto& entry : sites_) {
+    bytes += entry.second.bytes;
+  }
+  return static_cast<uint64_t>(bytes);
+}
+
+// Encoder for the protocol buffer messages of perftools.profiles.Profile, see profile.proto in
+// the pprof sources.
+class ProfileEncoder {
+ public:
+  // Field numbers of the messages.
+  static constexpr uint32_t kProfileSampleType = 1;
+  static constexpr uint32_t kProfileSample = 2;
+  static constexpr uint32_t kProfileLocation = 4;
+  static constexpr uint32_t kProfileFunction = 5;
+  static constexpr uint32_t kProfileStringTable = 6;
+  static constexpr uint32_t kProfilePeriodType = 11;
+  static constexpr uint32_t kProfilePeriod = 12;
+  static constexpr uint32_t kValueTypeType = 1;
+  static constexpr uint32_t kValueTypeUnit = 2;
+  static constexpr uint32_t kSampleLocationId = 1;
+  static constexpr uint32_t kSampleValue = 2;
+  static constexpr uint32_t kSampleLabel = 3;
+  static constexpr uint32_t kLabelKey = 1;
+  static constexpr uint32_t kLabelStr = 2;
+  static constexpr uint32_t kLocationId = 1;
+  static constexpr uint32_t kLocationLine = 4;
+  static constexpr uint32_t kLineFunctionId = 1;
+  static constexpr uint32_t kLineLine = 2;
+  static constexpr uint32_t kFunctionId = 1;
+  static constexpr uint32_t kFunctionName = 2;
+  static constexpr uint32_t kFunctionSystemName = 3;
+  static constexpr uint32_t kFunctionFilename = 4;
+
+  void AppendVarint(uint64_t value) {
+    while (value >= 0x80) {
+      buffer_.push_back(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    buffer_.push_back(static_cast<uint8_t>(value));
+  }
+
+  void AppendVarintField(uint32_t field, uint64_t value) {
+    AppendVarint(field << 3);  // Wire type 0.
+    AppendVarint(value);
+  }
+
+  void AppendBytesField(uint32_t field, const void* data, size_t size) {
+    AppendVarint((field << 3) | 2);  // Wire type 2.
+    AppendVarint(size);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+
+  void AppendMessageField(uint32_t field, const ProfileEncoder& message) {
+    AppendBytesField(field, message.buffer_.data(), message.buffer_.size());
+  }
+
+  void AppendPackedField(uint32_t field, const std::vector<uint64_t>& values) {
+    ProfileEncoder packed;
+    for (uint64_t value : values) {
+      packed.AppendVarint(value);
+    }
+    AppendMessageField(field, packed);
+  }
+
+  const std::vector<uint8_t>& GetBuffer() const {
+    return buffer_;
+  }
+
+ private:
+  std::vector<uint8_t> buffer_;
+};
+
+// The string table of a profile, in which index 0 is the empty string.
+class ProfileStringTable {
+ public:
+  ProfileStringTable() {
+    Intern("");
+  }
+
+  uint64_t Intern(const std::string& str) {
+    auto it = indexes_.find(str);
+    if (it != indexes_.end()) {
+      return it->second;
+    }
+    uint64_t index = strings_.size();
+    strings_.push_back(str);
+    indexes_.emplace(str, index);
+    return index;
+  }
+
+  void Encode(ProfileEncoder* profile) const {
+    for (const std::string& str : strings_) {
+      profile->AppendBytesField(ProfileEncoder::kProfileStringTable, str.data(), str.size());
+    }
+  }
+
+ private:
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, uint64_t> indexes_;
+};
+
+bool AllocationSampler::WriteProfile(int fd) {
+  Thread* self = Thread::Current();
+  std::vector<std::pair<Site, SiteCounts>> sites;
+  size_t sample_interval;
+  {
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    sites.reserve(sites_.size());
+    for (const auto& entry : sites_) {
+      sites.emplace_back(entry);
+    }
+    sample_interval = sample_interval_;
+  }
+
+  ProfileEncoder profile;
+  ProfileStringTable strings;
+  auto append_value_type = [&](uint32_t field, const char* type, const char* unit) {
+    ProfileEncoder value_type;
+    value_type.AppendVarintField(ProfileEncoder::kValueTypeType, strings.Intern(type));
+    value_type.AppendVarintField(ProfileEncoder::kValueTypeUnit, strings.Intern(unit));
+    profile.AppendMessageField(field, value_type);
+  };
+  append_value_type(ProfileEncoder::kProfileSampleType, "alloc_objects", "count");
+  append_value_type(ProfileEncoder::kProfileSampleType, "alloc_space", "bytes");
+
+  // One function per method and one location per (method, dex pc) pair. Ids start at 1.
+  std::unordered_map<ArtMethod*, uint64_t> function_ids;
+  std::unordered_map<AllocRecordStackTraceElement, uint64_t, HashAllocRecordTypes> location_ids;
+  uint64_t class_key = strings.Intern("class");
+  for (const std::pair<Site, SiteCounts>& entry : sites) {
+    const AllocRecordStackTrace& trace = entry.first.trace;
+    std::vector<uint64_t> locations;
+    for (size_t i = 0, depth = trace.GetDepth(); i < depth; ++i) {
+      const AllocRecordStackTraceElement& element = trace.GetStackElement(i);
+      ArtMethod* method = element.GetMethod();
+      auto function_it = function_ids.find(method);
+      if (function_it == function_ids.end()) {
+        uint64_t function_id = function_ids.size() + 1u;
+        function_it = function_ids.emplace(method, function_id).first;
+        const char* source_file = method->GetDeclaringClassSourceFile();
+        ProfileEncoder function;
+        function.AppendVarintField(ProfileEncoder::kFunctionId, function_id);
+        uint64_t name = strings.Intern(PrettyMethod(method));
+        function.AppendVarintField(ProfileEncoder::kFunctionName, name);
+        function.AppendVarintField(ProfileEncoder::kFunctionSystemName, name);
+        function.AppendVarintField(ProfileEncoder::kFunctionFilename,
+                                   strings.Intern(source_file != nullptr ? source_file : ""));
+        profile.AppendMessageField(ProfileEncoder::kProfileFunction, function);
+      }
+      auto location_it = location_ids.find(element);
+      if (location_it == location_ids.end()) {
+        uint64_t location_id = location_ids.size() + 1u;
+        location_it = location_ids.emplace(element, location_id).first;
+        ProfileEncoder line;
+        line.AppendVarintField(ProfileEncoder::kLineFunctionId, function_it->second);
+        line.AppendVarintField(ProfileEncoder::kLineLine,
+                               static_cast<uint64_t>(element.ComputeLineNumber()));
+        ProfileEncoder location;
+        location.AppendVarintField(ProfileEncoder::kLocationId, location_id);
+        location.AppendMessageField(ProfileEncoder::kLocationLine, line);
+        profile.AppendMessageField(ProfileEncoder::kProfileLocation, location);
+      }
+      locations.push_back(location_it->second);
+    }
+    ProfileEncoder sample;
+    sample.AppendPackedField(ProfileEncoder::kSampleLocationId, locations);
+    sample.AppendPackedField(ProfileEncoder::kSampleValue,
+                             { static_cast<uint64_t>(std::llround(entry.second.objects)),
+                               static_cast<uint64_t>(std::llround(entry.second.bytes)) });
+    ProfileEncoder label;
+    label.AppendVarintField(ProfileEncoder::kLabelKey, class_key);
+    std::string class_name = PrettyDescriptor(entry.first.class_descriptor.c_str());
+    label.AppendVarintField(ProfileEncoder::kLabelStr, strings.Intern(class_name));
+    sample.AppendMessageField(ProfileEncoder::kSampleLabel, label);
+    profile.AppendMessageField(ProfileEncoder::kProfileSample, sample);
+  }
+  append_value_type(ProfileEncoder::kProfilePeriodType, "space", "bytes");
+  profile.AppendVarintField(ProfileEncoder::kProfilePeriod, sample_interval);
+  strings.Encode(&profile);
+
+  File file(fd, /* check_usage */ false);
+  bool success = file.WriteFully(profile.GetBuffer().data(), profile.GetBuffer().size());
+  file.DisableAutoClose();
+  return success;
+}
+
+void AllocationSampler::DumpForSigQuit(std::ostream& os) {
+  std::string profile_file;
+  {
+    MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
+    uint64_t duration_ns = (stop_time_ns_ != 0 ? stop_time_ns_ : NanoTime()) - start_time_ns_;
+    os << "Allocation sampling: " << num_samples_ << " samples at " << sites_.size()
+       << " sites, " << PrettySize(GetEstimatedBytes()) << " allocated, "
+       << PrettyDuration(sampling_time_ns_) << " spent sampling over "
+       << PrettyDuration(duration_ns) << "\n";
+    profile_file = profile_file_;
+  }
+  if (profile_file.empty()) {
+    return;
+  }
+  std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(profile_file.c_str()));
+  if (file == nullptr) {
+    PLOG(ERROR) << "Could not create allocation profile " << profile_file;
+    return;
+  }
+  if (!WriteProfile(file->Fd()) || file->FlushCloseOrErase() != 0) {
+    PLOG(ERROR) << "Could not write allocation profile " << profile_file;
+    return;
+  }
+  os << "Wrote allocation profile to " << profile_file << "\n";
+}
+
+}  // namespace gc
+}  // namespace art
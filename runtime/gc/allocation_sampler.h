@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+#define ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+
+#include <ostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "allocation_record.h"
+#include "base/mutex.h"
+#include "globals.h"
+#include "object_callbacks.h"
+
+namespace art {
+
+class Thread;
+
+namespace mirror {
+  class Object;
+}
+
+namespace gc {
+
+// Samples the allocations of all threads at a given mean interval of allocated bytes, and
+// aggregates the stack traces of the sampled allocations by allocation site. Unlike the
+// AllocRecordObjectMap, which walks the stack of every allocation, the cost of the sampler on
+// each allocation is a per-thread countdown of allocated bytes, so it can be left enabled. With
+// the region TLAB allocator, the allocation fast paths stay uninstrumented: the end of the TLAB
+// they see is lowered to the next sample point, and only the slow paths count down.
+//
+// The sampled intervals are exponentially distributed, so that each allocated byte has the same
+// probability to be sampled and the estimated counts of each site are unbiased. The samples can
+// be written in the protocol buffer format of pprof.
+class AllocationSampler {
+ public:
+  static constexpr size_t kDefaultSampleInterval = 512 * KB;
+  static constexpr size_t kMaxStackDepth = 64;
+
+  // Start sampling one allocation every `sample_interval` bytes on average, discarding the
+  // samples of any previous run. The profile is written to `profile_file` when the runtime
+  // receives SIGQUIT, unless `profile_file` is empty.
+  static void Start(size_t sample_interval, const std::string& profile_file)
+      REQUIRES(!Locks::alloc_tracker_lock_);
+
+  // Stop sampling. The samples taken so far can still be written.
+  static void Stop() REQUIRES(!Locks::alloc_tracker_lock_);
+
+  AllocationSampler() = default;
+
+  // Called when the allocation of `byte_count` bytes uses up the bytes that `self` had left
+  // before its next sample.
+  void SampleAllocation(Thread* self, mirror::Object** obj, size_t byte_count)
+      REQUIRES(!Locks::alloc_tracker_lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Visit the methods of the sampled stack traces so that they do not get unloaded.
+  void VisitRoots(RootVisitor* visitor)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(Locks::alloc_tracker_lock_);
+
+  size_t GetSampleInterval() const REQUIRES(Locks::alloc_tracker_lock_) {
+    return sample_interval_;
+  }
+
+  size_t GetNumSamples() const REQUIRES(Locks::alloc_tracker_lock_) {
+    return num_samples_;
+  }
+
+  // Return the time the sampled allocations spent in SampleAllocation(), the overhead of the
+  // sampler on top of the countdown.
+  uint64_t GetSamplingTimeNs() const REQUIRES(Locks::alloc_tracker_lock_) {
+    return sampling_time_ns_;
+  }
+
+  // Return the estimated number of bytes allocated since sampling started.
+  uint64_t GetEstimatedBytes() const REQUIRES(Locks::alloc_tracker_lock_);
+
+  // Write the samples as a gzip-less pprof profile, with the estimated number of objects and
+  // bytes allocated by each site. Return false on I/O error.
+  bool WriteProfile(int fd)
+      REQUIRES(!Locks::alloc_tracker_lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Print a summary of the samples, and write the profile to the profile file if one was given.
+  void DumpForSigQuit(std::ostream& os)
+      REQUIRES(!Locks::alloc_tracker_lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+ private:
+  // An allocation site, identified by its (thread-less) stack trace and the allocated class.
+  struct Site {
+    AllocRecordStackTrace trace;
+    std::string class_descriptor;
+
+    bool operator==(const Site& other) const {
+      return class_descriptor == other.class_descriptor && trace == other.trace;
+    }
+  };
+
+  struct HashSite {
+    size_t operator()(const Site& site) const {
+      return HashAllocRecordTypes()(site.trace) * AllocRecordStackTrace::kHashMultiplier +
+          std::hash<std::string>()(site.class_descriptor);
+    }
+  };
+
+  // The estimated allocations of a site, the sum of the inverse sampling probabilities of its
+  // samples.
+  struct SiteCounts {
+    double objects = 0.0;
+    double bytes = 0.0;
+  };
+
+  size_t NextSampleInterval() REQUIRES(Locks::alloc_tracker_lock_);
+
+  size_t sample_interval_ GUARDED_BY(Locks::alloc_tracker_lock_) = kDefaultSampleInterval;
+  std::string profile_file_ GUARDED_BY(Locks::alloc_tracker_lock_);
+  std::minstd_rand random_ GUARDED_BY(Locks::alloc_tracker_lock_);
+  size_t num_samples_ GUARDED_BY(Locks::alloc_tracker_lock_) = 0;
+  // Whether Start() instrumented the allocation entrypoints.
+  bool instrumented_entrypoints_ GUARDED_BY(Locks::alloc_tracker_lock_) = false;
+  uint64_t start_time_ns_ GUARDED_BY(Locks::alloc_tracker_lock_) = 0;
+  // Zero while sampling.
+  uint64_t stop_time_ns_ GUARDED_BY(Locks::alloc_tracker_lock_) = 0;
+  uint64_t sampling_time_ns_ GUARDED_BY(Locks::alloc_tracker_lock_) = 0;
+  std::unordered_map<Site, SiteCounts, HashSite> sites_ GUARDED_BY(Locks::alloc_tracker_lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampler);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
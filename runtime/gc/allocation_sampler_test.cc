@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "handle_scope-inl.h"
+#include "mirror/array-inl.h"
+#include "mirror/object-inl.h"
+#include "scoped_thread_state_change.h"
+#include "thread-inl.h"
+
+namespace art {
+namespace gc {
+
+class AllocationSamplerTest : public CommonRuntimeTest {};
+
+TEST_F(AllocationSamplerTest, EstimatesAllocatedBytes) {
+  static constexpr size_t kSampleInterval = 4 * KB;
+  static constexpr size_t kNumArrays = 4096;
+  static constexpr size_t kArrayLength = 256;
+  Heap* heap = Runtime::Current()->GetHeap();
+  AllocationSampler::Start(kSampleInterval, "");
+  ASSERT_TRUE(heap->IsAllocSamplingEnabled());
+  uint64_t allocated_bytes = 0;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    for (size_t i = 0; i < kNumArrays; ++i) {
+      mirror::IntArray* array = mirror::IntArray::Alloc(soa.Self(), kArrayLength);
+      ASSERT_TRUE(array != nullptr);
+      allocated_bytes += array->SizeOf();
+    }
+  }
+  AllocationSampler::Stop();
+  EXPECT_FALSE(heap->IsAllocSamplingEnabled());
+
+  MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
+  AllocationSampler* sampler = heap->GetAllocationSampler();
+  ASSERT_TRUE(sampler != nullptr);
+  EXPECT_EQ(kSampleInterval, sampler->GetSampleInterval());
+  // About one sample every kSampleInterval bytes. The bounds are loose enough for the test not to
+  // be flaky, but would catch biased weights.
+  EXPECT_GT(sampler->GetNumSamples(), allocated_bytes / kSampleInterval / 2);
+  EXPECT_LT(sampler->GetNumSamples(), allocated_bytes / kSampleInterval * 2);
+  EXPECT_GT(sampler->GetEstimatedBytes(), allocated_bytes / 2);
+  EXPECT_LT(sampler->GetEstimatedBytes(), allocated_bytes * 2);
+  EXPECT_GT(sampler->GetSamplingTimeNs(), 0u);
+}
+
+TEST_F(AllocationSamplerTest, TlabFastPathsStopAtSamplePoint) {
+  static constexpr size_t kTlabSize = 1 * KB;
+  std::unique_ptr<uint8_t[]> tlab(new uint8_t[kTlabSize]);
+  uint8_t non_tlab[8];
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(self);
+  self->SetAllocSampleBytesRemaining(100);
+  self->SetTlab(tlab.get(), tlab.get() + kTlabSize);
+  EXPECT_EQ(kTlabSize, self->TlabSize());
+  EXPECT_EQ(100u, self->TlabFastPathSize());
+
+  // The bytes the fast paths took from the TLAB are counted down with the next slow path one.
+  self->AllocTlab(64);
+  mirror::Object* obj = self->AllocTlab(32);
+  EXPECT_FALSE(self->CountDownAllocSample(obj, 32));
+  EXPECT_EQ(4u, self->GetAllocSampleBytesRemaining());
+  EXPECT_EQ(4u, self->TlabFastPathSize());
+  EXPECT_TRUE(self->CountDownAllocSample(reinterpret_cast<mirror::Object*>(non_tlab), 8));
+  EXPECT_EQ(4u, self->GetAllocSampleBytesRemaining());
+
+  // A sample point past the end of the TLAB lets the fast paths use all of it.
+  self->SetAllocSampleBytesRemaining(2 * kTlabSize);
+  EXPECT_EQ(self->TlabSize(), self->TlabFastPathSize());
+  self->AllocTlab(128);
+  self->SetTlab(nullptr, nullptr);
+  EXPECT_EQ(2 * kTlabSize - 128, self->GetAllocSampleBytesRemaining());
+  self->SetAllocSampleBytesRemaining(0);
+}
+
+TEST_F(AllocationSamplerTest, WriteProfile) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  AllocationSampler::Start(1, "");
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    for (size_t i = 0; i < 16; ++i) {
+      ASSERT_TRUE(mirror::IntArray::Alloc(soa.Self(), 1) != nullptr);
+    }
+  }
+  AllocationSampler::Stop();
+
+  AllocationSampler* sampler;
+  {
+    MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
+    sampler = heap->GetAllocationSampler();
+    // The first allocation of the thread only draws the first sample interval.
+    EXPECT_GE(sampler->GetNumSamples(), 15u);
+  }
+  ScratchFile profile;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    ASSERT_TRUE(sampler->WriteProfile(profile.GetFd()));
+  }
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(profile.GetFilename(), &contents));
+  // The profile starts with the first sample type, a length-delimited field with number 1.
+  ASSERT_GT(contents.size(), 0u);
+  EXPECT_EQ((1 << 3) | 2, contents[0]);
+  EXPECT_NE(std::string::npos, contents.find("alloc_space"));
+  EXPECT_NE(std::string::npos, contents.find("int[]"));
+}
+
+}  // namespace gc
+}  // namespace art
@@ -26,6 +26,9 @@
 #include "thread-inl.h"
 #include "thread_list.h"
 
+#include <sched.h>
+#include <unistd.h>
+
 #include <map>
 #include <list>
 #include <sstream>
@@ -50,9 +53,10 @@ RosAlloc::Run* RosAlloc::dedicated_full_run_ =
 
 RosAlloc::RosAlloc(void* base, size_t capacity, size_t max_capacity,
                    PageReleaseMode page_release_mode, bool running_on_memory_tool,
-                   size_t page_release_size_threshold)
+                   size_t page_release_size_threshold, bool use_per_cpu_runs)
     : base_(reinterpret_cast<uint8_t*>(base)), footprint_(capacity),
       capacity_(capacity), max_capacity_(max_capacity),
+      use_per_cpu_runs_(use_per_cpu_runs), num_cpu_runs_(0U),
       lock_("rosalloc global lock", kRosAllocGlobalLock),
       bulk_free_lock_("rosalloc bulk free lock", kRosAllocBulkFreeLock),
       page_release_mode_(page_release_mode),
@@ -82,6 +86,16 @@ RosAlloc::RosAlloc(void* base, size_t capacity, size_t max_capacity,
     size_bracket_locks_[i] = new Mutex(size_bracket_lock_names_[i].c_str(), kRosAllocBracketLock);
     current_runs_[i] = dedicated_full_run_;
   }
+  if (use_per_cpu_runs_) {
+    num_cpu_runs_ = std::max(sysconf(_SC_NPROCESSORS_CONF), 1L);
+    cpu_runs_.reset(new CpuRuns[num_cpu_runs_]);
+    for (size_t i = 0; i < num_cpu_runs_; ++i) {
+      cpu_runs_[i].lock = new Mutex("rosalloc cpu runs lock", kRosAllocCpuRunsLock);
+      for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; ++idx) {
+        cpu_runs_[i].runs[idx] = dedicated_full_run_;
+      }
+    }
+  }
   DCHECK_EQ(footprint_, capacity_);
   size_t num_of_pages = footprint_ / kPageSize;
   size_t max_num_of_pages = max_capacity_ / kPageSize;
@@ -115,6 +129,9 @@ RosAlloc::~RosAlloc() {
   for (size_t i = 0; i < kNumOfSizeBrackets; i++) {
     delete size_bracket_locks_[i];
   }
+  for (size_t i = 0; i < num_cpu_runs_; ++i) {
+    delete cpu_runs_[i].lock;
+  }
   if (is_running_on_memory_tool_) {
     MEMORY_TOOL_MAKE_DEFINED(base_, capacity_);
   }
@@ -664,7 +681,14 @@ void* RosAlloc::AllocFromRun(Thread* self, size_t size, size_t* bytes_allocated,
   size_t bracket_size;
   size_t idx = SizeToIndexAndBracketSize(size, &bracket_size);
   void* slot_addr;
-  if (LIKELY(idx < kNumThreadLocalSizeBrackets)) {
+  if (UNLIKELY(use_per_cpu_runs_) && idx < kNumThreadLocalSizeBrackets) {
+    // Use the run of the current CPU.
+    slot_addr = AllocFromCpuRun(self, idx, bytes_tl_bulk_allocated);
+    if (LIKELY(slot_addr != nullptr)) {
+      *bytes_allocated = bracket_size;
+      *usable_size = bracket_size;
+    }
+  } else if (LIKELY(idx < kNumThreadLocalSizeBrackets)) {
     // Use a thread-local run.
     Run* thread_local_run = reinterpret_cast<Run*>(self->GetRosAllocRun(idx));
     // Allow invalid since this will always fail the allocation.
@@ -684,41 +708,12 @@ void* RosAlloc::AllocFromRun(Thread* self, size_t size, size_t* bytes_allocated,
       // The run got full. Try to free slots.
       DCHECK(thread_local_run->IsFull());
       MutexLock mu(self, *size_bracket_locks_[idx]);
-      bool is_all_free_after_merge;
-      // This is safe to do for the dedicated_full_run_ since the bitmaps are empty.
-      if (thread_local_run->MergeThreadLocalFreeListToFreeList(&is_all_free_after_merge)) {
-        DCHECK_NE(thread_local_run, dedicated_full_run_);
-        // Some slot got freed. Keep it.
-        DCHECK(!thread_local_run->IsFull());
-        DCHECK_EQ(is_all_free_after_merge, thread_local_run->IsAllFree());
-      } else {
-        // No slots got freed. Try to refill the thread-local run.
-        DCHECK(thread_local_run->IsFull());
-        if (thread_local_run != dedicated_full_run_) {
-          thread_local_run->SetIsThreadLocal(false);
-          if (kIsDebugBuild) {
-            full_runs_[idx].insert(thread_local_run);
-            if (kTraceRosAlloc) {
-              LOG(INFO) << "RosAlloc::AllocFromRun() : Inserted run 0x" << std::hex
-                        << reinterpret_cast<intptr_t>(thread_local_run)
-                        << " into full_runs_[" << std::dec << idx << "]";
-            }
-          }
-          DCHECK(non_full_runs_[idx].find(thread_local_run) == non_full_runs_[idx].end());
-          DCHECK(full_runs_[idx].find(thread_local_run) != full_runs_[idx].end());
-        }
-
-        thread_local_run = RefillRun(self, idx);
-        if (UNLIKELY(thread_local_run == nullptr)) {
-          self->SetRosAllocRun(idx, dedicated_full_run_);
-          return nullptr;
-        }
-        DCHECK(non_full_runs_[idx].find(thread_local_run) == non_full_runs_[idx].end());
-        DCHECK(full_runs_[idx].find(thread_local_run) == full_runs_[idx].end());
-        thread_local_run->SetIsThreadLocal(true);
-        self->SetRosAllocRun(idx, thread_local_run);
-        DCHECK(!thread_local_run->IsFull());
+      thread_local_run = RefreshThreadLocalRun(self, idx, thread_local_run);
+      if (UNLIKELY(thread_local_run == nullptr)) {
+        self->SetRosAllocRun(idx, dedicated_full_run_);
+        return nullptr;
       }
+      self->SetRosAllocRun(idx, thread_local_run);
       DCHECK(thread_local_run != nullptr);
       DCHECK(!thread_local_run->IsFull());
       DCHECK(thread_local_run->IsThreadLocal());
@@ -760,6 +755,84 @@ void* RosAlloc::AllocFromRun(Thread* self, size_t size, size_t* bytes_allocated,
   return slot_addr;
 }
 
+RosAlloc::Run* RosAlloc::RefreshThreadLocalRun(Thread* self, size_t idx, Run* run) {
+  size_bracket_locks_[idx]->AssertHeld(self);
+  DCHECK(run->IsFull());
+  bool is_all_free_after_merge;
+  // This is safe to do for the dedicated_full_run_ since the bitmaps are empty.
+  if (run->MergeThreadLocalFreeListToFreeList(&is_all_free_after_merge)) {
+    DCHECK_NE(run, dedicated_full_run_);
+    // Some slot got freed. Keep it.
+    DCHECK(!run->IsFull());
+    DCHECK_EQ(is_all_free_after_merge, run->IsAllFree());
+    return run;
+  }
+  // No slots got freed. Try to refill the thread-local run.
+  DCHECK(run->IsFull());
+  if (run != dedicated_full_run_) {
+    run->SetIsThreadLocal(false);
+    if (kIsDebugBuild) {
+      full_runs_[idx].insert(run);
+      if (kTraceRosAlloc) {
+        LOG(INFO) << "RosAlloc::RefreshThreadLocalRun() : Inserted run 0x" << std::hex
+                  << reinterpret_cast<intptr_t>(run)
+                  << " into full_runs_[" << std::dec << idx << "]";
+      }
+    }
+    DCHECK(non_full_runs_[idx].find(run) == non_full_runs_[idx].end());
+    DCHECK(full_runs_[idx].find(run) != full_runs_[idx].end());
+  }
+  Run* new_run = RefillRun(self, idx);
+  if (UNLIKELY(new_run == nullptr)) {
+    return nullptr;
+  }
+  DCHECK(non_full_runs_[idx].find(new_run) == non_full_runs_[idx].end());
+  DCHECK(full_runs_[idx].find(new_run) == full_runs_[idx].end());
+  new_run->SetIsThreadLocal(true);
+  DCHECK(!new_run->IsFull());
+  return new_run;
+}
+
+static size_t GetCurrentCpu() {
+#if defined(__linux__)
+  int cpu = sched_getcpu();
+  return cpu >= 0 ? static_cast<size_t>(cpu) : 0U;
+#else
+  return 0U;
+#endif
+}
+
+void* RosAlloc::AllocFromCpuRun(Thread* self, size_t idx, size_t* bytes_tl_bulk_allocated) {
+  DCHECK(use_per_cpu_runs_);
+  DCHECK_LT(idx, kNumThreadLocalSizeBrackets);
+  // The thread may migrate to another CPU from here on, which only costs some contention on the
+  // lock of the CPU it left.
+  CpuRuns* cpu_runs = &cpu_runs_[GetCurrentCpu() % num_cpu_runs_];
+  MutexLock cpu_mu(self, *cpu_runs->lock);
+  Run* cpu_run = cpu_runs->runs[idx];
+  DCHECK(cpu_run->IsThreadLocal() || cpu_run == dedicated_full_run_);
+  void* slot_addr = cpu_run->AllocSlot();
+  if (LIKELY(slot_addr != nullptr)) {
+    // The slot is already counted. Leave it as is.
+    *bytes_tl_bulk_allocated = 0;
+    return slot_addr;
+  }
+  // The run got full. Try to free slots, as for a thread-local run.
+  MutexLock mu(self, *size_bracket_locks_[idx]);
+  cpu_run = RefreshThreadLocalRun(self, idx, cpu_run);
+  if (UNLIKELY(cpu_run == nullptr)) {
+    cpu_runs->runs[idx] = dedicated_full_run_;
+    return nullptr;
+  }
+  cpu_runs->runs[idx] = cpu_run;
+  // Account for all the free slots in the new or refreshed run.
+  *bytes_tl_bulk_allocated = cpu_run->NumberOfFreeSlots() * bracketSizes[idx];
+  slot_addr = cpu_run->AllocSlot();
+  // Must succeed now with a new run.
+  DCHECK(slot_addr != nullptr);
+  return slot_addr;
+}
+
 size_t RosAlloc::FreeFromRun(Thread* self, void* ptr, Run* run) {
   DCHECK_EQ(run->magic_num_, kMagicNum);
   DCHECK_LT(run, ptr);
@@ -1522,24 +1595,47 @@ size_t RosAlloc::RevokeThreadLocalRuns(Thread* thread) {
     if (thread_local_run != dedicated_full_run_) {
       // Note the thread local run may not be full here.
       thread->SetRosAllocRun(idx, dedicated_full_run_);
-      DCHECK_EQ(thread_local_run->magic_num_, kMagicNum);
-      // Count the number of free slots left.
-      size_t num_free_slots = thread_local_run->NumberOfFreeSlots();
-      free_bytes += num_free_slots * bracketSizes[idx];
-      // The above bracket index lock guards thread local free list to avoid race condition
-      // with unioning bulk free list to thread local free list by GC thread in BulkFree.
-      // If thread local run is true, GC thread will help update thread local free list
-      // in BulkFree. And the latest thread local free list will be merged to free list
-      // either when this thread local run is full or when revoking this run here. In this
-      // case the free list wll be updated. If thread local run is false, GC thread will help
-      // merge bulk free list in next BulkFree.
-      // Thus no need to merge bulk free list to free list again here.
-      bool dont_care;
-      thread_local_run->MergeThreadLocalFreeListToFreeList(&dont_care);
-      thread_local_run->SetIsThreadLocal(false);
-      DCHECK(non_full_runs_[idx].find(thread_local_run) == non_full_runs_[idx].end());
-      DCHECK(full_runs_[idx].find(thread_local_run) == full_runs_[idx].end());
-      RevokeRun(self, idx, thread_local_run);
+      free_bytes += RevokeThreadLocalRun(self, idx, thread_local_run);
+    }
+  }
+  return free_bytes;
+}
+
+size_t RosAlloc::RevokeThreadLocalRun(Thread* self, size_t idx, Run* run) {
+  size_bracket_locks_[idx]->AssertHeld(self);
+  DCHECK_NE(run, dedicated_full_run_);
+  DCHECK_EQ(run->magic_num_, kMagicNum);
+  // Count the number of free slots left.
+  size_t num_free_slots = run->NumberOfFreeSlots();
+  // The bracket index lock guards thread local free list to avoid race condition
+  // with unioning bulk free list to thread local free list by GC thread in BulkFree.
+  // If thread local run is true, GC thread will help update thread local free list
+  // in BulkFree. And the latest thread local free list will be merged to free list
+  // either when this thread local run is full or when revoking this run here. In this
+  // case the free list wll be updated. If thread local run is false, GC thread will help
+  // merge bulk free list in next BulkFree.
+  // Thus no need to merge bulk free list to free list again here.
+  bool dont_care;
+  run->MergeThreadLocalFreeListToFreeList(&dont_care);
+  run->SetIsThreadLocal(false);
+  DCHECK(non_full_runs_[idx].find(run) == non_full_runs_[idx].end());
+  DCHECK(full_runs_[idx].find(run) == full_runs_[idx].end());
+  RevokeRun(self, idx, run);
+  return num_free_slots * bracketSizes[idx];
+}
+
+size_t RosAlloc::RevokeCpuRuns() {
+  Thread* self = Thread::Current();
+  size_t free_bytes = 0U;
+  for (size_t i = 0; i < num_cpu_runs_; ++i) {
+    MutexLock cpu_mu(self, *cpu_runs_[i].lock);
+    for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; ++idx) {
+      MutexLock mu(self, *size_bracket_locks_[idx]);
+      Run* cpu_run = cpu_runs_[i].runs[idx];
+      if (cpu_run != dedicated_full_run_) {
+        cpu_runs_[i].runs[idx] = dedicated_full_run_;
+        free_bytes += RevokeThreadLocalRun(self, idx, cpu_run);
+      }
     }
   }
   return free_bytes;
@@ -1588,6 +1684,12 @@ void RosAlloc::RevokeThreadUnsafeCurrentRuns() {
 size_t RosAlloc::RevokeAllThreadLocalRuns() {
   // This is called when a mutator thread won't allocate such as at
   // the Zygote creation time or during the GC pause.
+  if (use_per_cpu_runs_) {
+    // The threads don't own runs, no need to go through the thread list.
+    size_t free_bytes = RevokeCpuRuns();
+    RevokeThreadUnsafeCurrentRuns();
+    return free_bytes;
+  }
   MutexLock mu(Thread::Current(), *Locks::runtime_shutdown_lock_);
   MutexLock mu2(Thread::Current(), *Locks::thread_list_lock_);
   std::list<Thread*> thread_list = Runtime::Current()->GetThreadList()->GetList();
@@ -1621,6 +1723,12 @@ void RosAlloc::AssertAllThreadLocalRunsAreRevoked() {
     for (Thread* t : thread_list) {
       AssertThreadLocalRunsAreRevoked(t);
     }
+    for (size_t i = 0; i < num_cpu_runs_; ++i) {
+      MutexLock cpu_mu(self, *cpu_runs_[i].lock);
+      for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; ++idx) {
+        CHECK_EQ(cpu_runs_[i].runs[idx], dedicated_full_run_);
+      }
+    }
     for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; ++idx) {
       MutexLock brackets_mu(self, *size_bracket_locks_[idx]);
       CHECK_EQ(current_runs_[idx], dedicated_full_run_);
@@ -1856,6 +1964,15 @@ void RosAlloc::Verify() {
             thread_local_run->size_bracket_idx_ == i);
     }
   }
+  for (size_t i = 0; i < num_cpu_runs_; ++i) {
+    MutexLock cpu_mu(self, *cpu_runs_[i].lock);
+    for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; ++idx) {
+      Run* cpu_run = cpu_runs_[i].runs[idx];
+      CHECK(cpu_run != nullptr);
+      CHECK(cpu_run->IsThreadLocal());
+      CHECK(cpu_run == dedicated_full_run_ || cpu_run->size_bracket_idx_ == idx);
+    }
+  }
   for (size_t i = 0; i < kNumOfSizeBrackets; i++) {
     MutexLock brackets_mu(self, *size_bracket_locks_[i]);
     Run* current_run = current_runs_[i];
@@ -1886,7 +2003,7 @@ void RosAlloc::Run::Verify(Thread* self, RosAlloc* rosalloc, bool running_on_mem
   CHECK(IsBulkFreeListEmpty()) << "The bulk free isn't empty " << Dump();
   // Check the thread local runs, the current runs, and the run sets.
   if (IsThreadLocal()) {
-    // If it's a thread local run, then it must be pointed to by an owner thread.
+    // If it's a thread local run, then it must be pointed to by an owner thread or CPU.
     bool owner_found = false;
     std::list<Thread*> thread_list = Runtime::Current()->GetThreadList()->GetList();
     for (auto it = thread_list.begin(); it != thread_list.end(); ++it) {
@@ -1903,7 +2020,19 @@ void RosAlloc::Run::Verify(Thread* self, RosAlloc* rosalloc, bool running_on_mem
         }
       }
     }
-    CHECK(owner_found) << "A thread local run has no owner thread " << Dump();
+    for (size_t i = 0; i < rosalloc->num_cpu_runs_; ++i) {
+      MutexLock mu(self, *rosalloc->cpu_runs_[i].lock);
+      for (size_t j = 0; j < kNumThreadLocalSizeBrackets; j++) {
+        if (rosalloc->cpu_runs_[i].runs[j] == this) {
+          CHECK(!owner_found)
+              << "A thread local run has more than one owner thread or CPU " << Dump();
+          CHECK_EQ(j, idx)
+              << "A mismatching size bracket index in a per-CPU run " << Dump();
+          owner_found = true;
+        }
+      }
+    }
+    CHECK(owner_found) << "A thread local run has no owner thread or CPU " << Dump();
   } else {
     // If it's not thread local, check that the thread local free list is empty.
     CHECK(IsThreadLocalFreeListEmpty())
@@ -729,6 +729,20 @@ class RosAlloc {
   Mutex* size_bracket_locks_[kNumOfSizeBrackets];
   // Bracket lock names (since locks only have char* names).
   std::string size_bracket_lock_names_[kNumOfSizeBrackets];
+  // The runs of the thread-local size brackets shared by the threads running on a CPU.
+  struct CpuRuns {
+    // Guards the runs. Acquired before the size bracket locks.
+    Mutex* lock;
+    Run* runs[kNumThreadLocalSizeBrackets];
+  };
+  // If true, the thread-local size brackets are allocated from per-CPU runs rather than from
+  // thread-local runs. This bounds the number of partially filled runs by the number of CPUs
+  // rather than the number of threads. The threads keep the dedicated full run as their
+  // thread-local runs so that the thread-local allocation fast paths always fail.
+  const bool use_per_cpu_runs_;
+  // The number of elements of cpu_runs_, which is zero unless use_per_cpu_runs_.
+  size_t num_cpu_runs_;
+  std::unique_ptr<CpuRuns[]> cpu_runs_;
   // The types of page map entries.
   enum PageMapKind {
     kPageMapReleased = 0,     // Zero and released back to the OS.
@@ -800,6 +814,15 @@ class RosAlloc {
   // thread-local or current run gets full.
   Run* RefillRun(Thread* self, size_t idx) REQUIRES(!lock_);
 
+  // Used when a thread-local or per-CPU run gets full. Returns the run with the slots freed by
+  // other threads merged, or a new thread-local run if none were freed. Returns null if a new
+  // run can't be allocated. Requires the size bracket lock.
+  Run* RefreshThreadLocalRun(Thread* self, size_t idx, Run* run) REQUIRES(!lock_);
+
+  // Allocate a slot of a thread-local size bracket from the run of the current CPU.
+  void* AllocFromCpuRun(Thread* self, size_t idx, size_t* bytes_tl_bulk_allocated)
+      REQUIRES(!lock_);
+
   // The internal of non-bulk Free().
   size_t FreeInternal(Thread* self, void* ptr) REQUIRES(!lock_);
 
@@ -811,6 +834,10 @@ class RosAlloc {
   // Revoke a run by adding it to non_full_runs_ or freeing the pages.
   void RevokeRun(Thread* self, size_t idx, Run* run) REQUIRES(!lock_);
 
+  // Revoke a thread-local or per-CPU run. Returns the bytes of its free slots. Requires the size
+  // bracket lock.
+  size_t RevokeThreadLocalRun(Thread* self, size_t idx, Run* run) REQUIRES(!lock_);
+
   // Revoke the current runs which share an index with the thread local runs.
   void RevokeThreadUnsafeCurrentRuns() REQUIRES(!lock_);
 
@@ -824,7 +851,8 @@ class RosAlloc {
   RosAlloc(void* base, size_t capacity, size_t max_capacity,
            PageReleaseMode page_release_mode,
            bool running_on_memory_tool,
-           size_t page_release_size_threshold = kDefaultPageReleaseSizeThreshold);
+           size_t page_release_size_threshold = kDefaultPageReleaseSizeThreshold,
+           bool use_per_cpu_runs = false);
   ~RosAlloc();
 
   static size_t RunFreeListOffset() {
@@ -894,10 +922,13 @@ class RosAlloc {
   // Returns the total bytes of free slots in the revoked thread local runs. This is to be
   // subtracted from Heap::num_bytes_allocated_ to cancel out the ahead-of-time counting.
   size_t RevokeThreadLocalRuns(Thread* thread) REQUIRES(!lock_, !bulk_free_lock_);
-  // Releases the thread-local runs assigned to all the threads back to the common set of runs.
-  // Returns the total bytes of free slots in the revoked thread local runs. This is to be
+  // Releases the thread-local runs assigned to all the threads, or the per-CPU runs, back to the
+  // common set of runs. Returns the total bytes of free slots in the revoked runs. This is to be
   // subtracted from Heap::num_bytes_allocated_ to cancel out the ahead-of-time counting.
   size_t RevokeAllThreadLocalRuns() REQUIRES(!Locks::thread_list_lock_, !lock_, !bulk_free_lock_);
+  // Releases the per-CPU runs back to the common set of runs, while mutators may be running.
+  // Returns the total bytes of free slots in the revoked runs, like RevokeAllThreadLocalRuns().
+  size_t RevokeCpuRuns() REQUIRES(!lock_);
   // Assert the thread local runs of a thread are revoked.
   void AssertThreadLocalRunsAreRevoked(Thread* thread) REQUIRES(!bulk_free_lock_);
   // Assert all the thread local runs are revoked.
@@ -921,6 +952,10 @@ class RosAlloc {
     return page_release_mode_ == kPageReleaseModeAll;
   }
 
+  bool UsesPerCpuRuns() const {
+    return use_per_cpu_runs_;
+  }
+
   // Verify for debugging.
   void Verify() REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_, !bulk_free_lock_,
                          !lock_);
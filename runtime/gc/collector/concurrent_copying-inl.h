@@ -32,7 +32,7 @@ inline mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref) {
   if (from_ref == nullptr) {
     return nullptr;
   }
-  DCHECK(heap_->collector_type_ == kCollectorTypeCC);
+  DCHECK(Heap::IsConcurrentCopyingGc(heap_->collector_type_));
   if (UNLIKELY(kUseBakerReadBarrier && !is_active_)) {
     // In the lock word forward address state, the read barrier bits
     // in the lock word are part of the stored forwarding address and
@@ -85,6 +85,11 @@ inline mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref) {
       return to_ref;
     }
     case space::RegionSpace::RegionType::kRegionTypeNone:
+      if (young_gen_) {
+        // A young collection doesn't collect the non-moving spaces. The old objects referring to
+        // the regions being collected were grayed at the flip.
+        return from_ref;
+      }
       return MarkNonMoving(from_ref);
     default:
       UNREACHABLE();
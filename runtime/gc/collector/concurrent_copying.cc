@@ -19,18 +19,24 @@
 #include "art_field-inl.h"
 #include "base/stl_util.h"
 #include "debugger.h"
+#include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
 #include "gc/reference_processor.h"
 #include "gc/space/image_space.h"
+#include "gc/space/large_object_space.h"
 #include "gc/space/space-inl.h"
+#include "gc/string_dedup_table.h"
 #include "image-inl.h"
 #include "intern_table.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
+#include "mirror/string-inl.h"
+#include "runtime.h"
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -39,7 +45,9 @@ namespace collector {
 
 static constexpr size_t kDefaultGcMarkStackSize = 2 * MB;
 
-ConcurrentCopying::ConcurrentCopying(Heap* heap, const std::string& name_prefix)
+ConcurrentCopying::ConcurrentCopying(Heap* heap,
+                                     bool generational,
+                                     const std::string& name_prefix)
     : GarbageCollector(heap,
                        name_prefix + (name_prefix.empty() ? "" : " ") +
                        "concurrent copying + mark sweep"),
@@ -48,15 +56,21 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap, const std::string& name_prefix)
                                                      kDefaultGcMarkStackSize,
                                                      kDefaultGcMarkStackSize)),
       mark_stack_lock_("concurrent copying mark stack lock", kMarkSweepMarkStackLock),
+      parallel_mark_active_workers_(0u),
       thread_running_gc_(nullptr),
       is_marking_(false), is_active_(false), is_asserting_to_space_invariant_(false),
       heap_mark_bitmap_(nullptr), live_stack_freeze_size_(0), mark_stack_mode_(kMarkStackModeOff),
       weak_ref_access_enabled_(true),
       skipped_blocks_lock_("concurrent copying bytes blocks lock", kMarkSweepMarkStackLock),
       rb_table_(heap_->GetReadBarrierTable()),
-      force_evacuate_all_(false) {
+      force_evacuate_all_(false),
+      generational_(generational),
+      young_gen_(false),
+      string_dedup_table_(nullptr) {
   static_assert(space::RegionSpace::kRegionSize == accounting::ReadBarrierTable::kRegionSize,
                 "The region space size and the read barrier table region size must match");
+  // Rejected when parsing -Xgc.
+  CHECK(!generational_ || kUseBakerReadBarrier);
   cc_heap_bitmap_.reset(new accounting::HeapBitmap(heap));
   Thread* self = Thread::Current();
   {
@@ -175,9 +189,24 @@ void ConcurrentCopying::InitializePhase() {
   } else {
     force_evacuate_all_ = false;
   }
+  if (generational_ && !young_gen_) {
+    // A full collection finds the old objects again.
+    if (region_space_old_bitmap_ == nullptr) {
+      region_space_old_bitmap_.reset(accounting::ContinuousSpaceBitmap::Create(
+          "cc region space old bitmap", region_space_->Begin(), region_space_->Capacity()));
+    } else {
+      region_space_old_bitmap_->Clear();
+    }
+  }
+  // Young collections don't deduplicate: they only copy the strings allocated since the previous
+  // collection, which are too young for it.
+  string_dedup_table_ = young_gen_ ? nullptr : heap_->GetStringDedupTable();
+  if (string_dedup_table_ != nullptr) {
+    string_dedup_table_->Reset();
+  }
   BindBitmaps();
   if (kVerboseMode) {
-    LOG(INFO) << "force_evacuate_all=" << force_evacuate_all_;
+    LOG(INFO) << "force_evacuate_all=" << force_evacuate_all_ << " young_gen=" << young_gen_;
     LOG(INFO) << "Largest immune region: " << immune_spaces_.GetLargestImmuneRegion().Begin()
               << "-" << immune_spaces_.GetLargestImmuneRegion().End();
     for (space::ContinuousSpace* space : immune_spaces_.GetSpaces()) {
@@ -238,15 +267,23 @@ class ConcurrentCopying::FlipCallback : public Closure {
     Thread* self = Thread::Current();
     CHECK(thread == self);
     Locks::mutator_lock_->AssertExclusiveHeld(self);
-    cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_);
+    cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_, cc->young_gen_);
     cc->SwapStacks();
     if (ConcurrentCopying::kEnableFromSpaceAccountingCheck) {
       cc->RecordLiveStackFreezeSize(self);
-      cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
-      cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      // Young collections leave the old regions in the to-space.
+      cc->from_space_num_objects_at_first_pause_ =
+          cc->region_space_->GetObjectsAllocatedInFromSpace() +
+          cc->region_space_->GetObjectsAllocatedInUnevacFromSpace();
+      cc->from_space_num_bytes_at_first_pause_ =
+          cc->region_space_->GetBytesAllocatedInFromSpace() +
+          cc->region_space_->GetBytesAllocatedInUnevacFromSpace();
     }
     cc->is_marking_ = true;
     cc->mark_stack_mode_.StoreRelaxed(ConcurrentCopying::kMarkStackModeThreadLocal);
+    if (cc->young_gen_) {
+      cc->GrayOldObjects();
+    }
     if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
       CHECK(Runtime::Current()->IsAotCompiler());
       TimingLogger::ScopedTiming split2("(Paused)VisitTransactionRoots", cc->GetTimings());
@@ -296,6 +333,94 @@ void ConcurrentCopying::RecordLiveStackFreezeSize(Thread* self) {
   live_stack_freeze_size_ = heap_->GetLiveStack()->Size();
 }
 
+// Used to gray the old objects on dirty cards in a young collection.
+class ConcurrentCopying::GrayOldObjectVisitor {
+ public:
+  explicit GrayOldObjectVisitor(ConcurrentCopying* cc) : collector_(cc) {}
+
+  void operator()(mirror::Object* obj) const REQUIRES(Locks::mutator_lock_) {
+    collector_->GrayOldObject(obj);
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+};
+
+// A young collection only marks through the objects which may refer to the
+// regions being collected: the old objects on dirty cards, since the write
+// barrier dirties the card of an object when a reference is stored into it,
+// and the objects allocated outside of the region space since the previous
+// collection. Gray them during the flip pause, with the mutators stopped.
+void ConcurrentCopying::GrayOldObjects() {
+  CHECK(kUseBakerReadBarrier) << "Young collections require the Baker read barrier";
+  TimingLogger::ScopedTiming split("(Paused)GrayOldObjects", GetTimings());
+  WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  accounting::CardTable* card_table = heap_->GetCardTable();
+  GrayOldObjectVisitor visitor(this);
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    accounting::ContinuousSpaceBitmap* bitmap =
+        space == region_space_ ? region_space_old_bitmap_.get() : space->GetLiveBitmap();
+    DCHECK(bitmap != nullptr) << *space;
+    card_table->Scan</*kClearCard*/ true>(bitmap, space->Begin(), space->End(), visitor);
+  }
+  // Only the first card of a large object is dirtied.
+  space::LargeObjectSpace* large_object_space = heap_->GetLargeObjectsSpace();
+  if (large_object_space != nullptr) {
+    large_object_space->GetLiveBitmap()->VisitMarkedRange(
+        reinterpret_cast<uintptr_t>(large_object_space->Begin()),
+        reinterpret_cast<uintptr_t>(large_object_space->End()),
+        [this, card_table](mirror::Object* obj) REQUIRES(Locks::mutator_lock_) {
+          if (card_table->IsDirty(obj)) {
+            *card_table->CardFromAddr(obj) = accounting::CardTable::kCardClean;
+            GrayOldObject(obj);
+          }
+        });
+  }
+  // The objects allocated since the previous collection are not in the live bitmaps yet.
+  accounting::ObjectStack* live_stack = GetLiveStack();
+  for (auto* it = live_stack->Begin(), *end = live_stack->End(); it < end; ++it) {
+    mirror::Object* const obj = it->AsMirrorPtr();
+    if (obj != nullptr && obj->GetClass<kVerifyNone, kWithoutReadBarrier>() != nullptr) {
+      GrayOldObject(obj);
+    }
+  }
+}
+
+void ConcurrentCopying::GrayOldObject(mirror::Object* obj) {
+  DCHECK(obj != nullptr);
+  if (region_space_->HasAddress(obj)) {
+    // The old regions stay in the to-space, the gray objects are turned white once scanned.
+    DCHECK(region_space_->IsInToSpace(obj)) << obj;
+    if (obj->AtomicSetReadBarrierPointer(ReadBarrier::WhitePtr(), ReadBarrier::GrayPtr())) {
+      PushOntoMarkStack(obj);
+    }
+    return;
+  }
+  // Outside of the region space, the gray objects are turned black once scanned. Mark them so
+  // that ClearBlackPtrs() turns them white again.
+  obj->AtomicSetReadBarrierPointer(ReadBarrier::WhitePtr(), ReadBarrier::GrayPtr());
+  bool already_marked;
+  if (immune_spaces_.ContainsObject(obj)) {
+    accounting::ContinuousSpaceBitmap* cc_bitmap = cc_heap_bitmap_->GetContinuousSpaceBitmap(obj);
+    DCHECK(cc_bitmap != nullptr) << "An immune space object must have a bitmap";
+    already_marked = cc_bitmap->AtomicTestAndSet(obj);
+  } else {
+    accounting::ContinuousSpaceBitmap* mark_bitmap =
+        heap_mark_bitmap_->GetContinuousSpaceBitmap(obj);
+    if (mark_bitmap != nullptr) {
+      already_marked = mark_bitmap->AtomicTestAndSet(obj);
+    } else {
+      accounting::LargeObjectBitmap* los_bitmap = heap_mark_bitmap_->GetLargeObjectBitmap(obj);
+      CHECK(los_bitmap != nullptr) << "LOS bitmap covers the entire address range";
+      already_marked = los_bitmap->AtomicTestAndSet(obj);
+    }
+  }
+  if (!already_marked) {
+    DCHECK_EQ(obj->GetReadBarrierPointer(), ReadBarrier::GrayPtr());
+    PushOntoMarkStack(obj);
+  }
+}
+
 // Used to visit objects in the immune spaces.
 class ConcurrentCopying::ImmuneSpaceObjVisitor {
  public:
@@ -386,14 +511,16 @@ void ConcurrentCopying::MarkingPhase() {
     Runtime::Current()->VisitNonThreadRoots(this);
   }
 
-  // Immune spaces.
-  for (auto& space : immune_spaces_.GetSpaces()) {
-    DCHECK(space->IsImageSpace() || space->IsZygoteSpace());
-    accounting::ContinuousSpaceBitmap* live_bitmap = space->GetLiveBitmap();
-    ImmuneSpaceObjVisitor visitor(this);
-    live_bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(space->Begin()),
-                                  reinterpret_cast<uintptr_t>(space->Limit()),
-                                  visitor);
+  // Immune spaces. A young collection only scans the immune objects grayed at the flip.
+  if (!young_gen_) {
+    for (auto& space : immune_spaces_.GetSpaces()) {
+      DCHECK(space->IsImageSpace() || space->IsZygoteSpace());
+      accounting::ContinuousSpaceBitmap* live_bitmap = space->GetLiveBitmap();
+      ImmuneSpaceObjVisitor visitor(this);
+      live_bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(space->Begin()),
+                                    reinterpret_cast<uintptr_t>(space->Limit()),
+                                    visitor);
+    }
   }
 
   Thread* self = Thread::Current();
@@ -579,6 +706,32 @@ void ConcurrentCopying::ExpandGcMarkStack() {
   DCHECK(!gc_mark_stack_->IsFull());
 }
 
+accounting::ObjectStack* ConcurrentCopying::GetPooledMarkStackLocked() {
+  accounting::ObjectStack* mark_stack;
+  if (!pooled_mark_stacks_.empty()) {
+    // Use a pooled mark stack.
+    mark_stack = pooled_mark_stacks_.back();
+    pooled_mark_stacks_.pop_back();
+  } else {
+    // None pooled. Create a new one.
+    mark_stack = accounting::ObjectStack::Create("thread local mark stack", 4 * KB, 4 * KB);
+  }
+  DCHECK(mark_stack != nullptr);
+  DCHECK(mark_stack->IsEmpty());
+  return mark_stack;
+}
+
+void ConcurrentCopying::RecycleMarkStackLocked(accounting::ObjectStack* mark_stack) {
+  if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
+    // The pool has enough. Delete it.
+    delete mark_stack;
+  } else {
+    // Otherwise, put it into the pool for later reuse.
+    mark_stack->Reset();
+    pooled_mark_stacks_.push_back(mark_stack);
+  }
+}
+
 void ConcurrentCopying::PushOntoMarkStack(mirror::Object* to_ref) {
   CHECK_EQ(is_mark_stack_push_disallowed_.LoadRelaxed(), 0)
       << " " << to_ref << " " << PrettyTypeOf(to_ref);
@@ -599,19 +752,7 @@ void ConcurrentCopying::PushOntoMarkStack(mirror::Object* to_ref) {
       if (UNLIKELY(tl_mark_stack == nullptr || tl_mark_stack->IsFull())) {
         MutexLock mu(self, mark_stack_lock_);
         // Get a new thread local mark stack.
-        accounting::AtomicStack<mirror::Object>* new_tl_mark_stack;
-        if (!pooled_mark_stacks_.empty()) {
-          // Use a pooled mark stack.
-          new_tl_mark_stack = pooled_mark_stacks_.back();
-          pooled_mark_stacks_.pop_back();
-        } else {
-          // None pooled. Create a new one.
-          new_tl_mark_stack =
-              accounting::AtomicStack<mirror::Object>::Create(
-                  "thread local mark stack", 4 * KB, 4 * KB);
-        }
-        DCHECK(new_tl_mark_stack != nullptr);
-        DCHECK(new_tl_mark_stack->IsEmpty());
+        accounting::AtomicStack<mirror::Object>* new_tl_mark_stack = GetPooledMarkStackLocked();
         new_tl_mark_stack->PushBack(to_ref);
         self->SetThreadLocalMarkStack(new_tl_mark_stack);
         if (tl_mark_stack != nullptr) {
@@ -674,9 +815,11 @@ class ConcurrentCopying::VerifyNoFromSpaceRefsVisitor : public SingleRootVisitor
             << "To-space ref " << ref << " " << PrettyTypeOf(ref)
             << " has non-white rb_ptr " << ref->GetReadBarrierPointer();
       } else {
+        // A young collection doesn't mark the objects outside of the region space.
         CHECK(ref->GetReadBarrierPointer() == ReadBarrier::BlackPtr() ||
               (ref->GetReadBarrierPointer() == ReadBarrier::WhitePtr() &&
-               collector_->IsOnAllocStack(ref)))
+               (collector_->IsOnAllocStack(ref) ||
+                (collector_->young_gen_ && !collector_->region_space_->HasAddress(ref)))))
             << "Non-moving/unevac from space ref " << ref << " " << PrettyTypeOf(ref)
             << " has non-black rb_ptr " << ref->GetReadBarrierPointer()
             << " but isn't on the alloc stack (and has white rb_ptr)."
@@ -754,7 +897,8 @@ class ConcurrentCopying::VerifyNoFromSpaceRefsObjectVisitor {
       } else {
         CHECK(obj->GetReadBarrierPointer() == ReadBarrier::BlackPtr() ||
               (obj->GetReadBarrierPointer() == ReadBarrier::WhitePtr() &&
-               collector->IsOnAllocStack(obj)))
+               (collector->IsOnAllocStack(obj) ||
+                (collector->young_gen_ && !region_space->HasAddress(obj)))))
             << "Non-moving space/unevac from space ref " << obj << " " << PrettyTypeOf(obj)
             << " has non-black rb_ptr " << obj->GetReadBarrierPointer()
             << " but isn't on the alloc stack (and has white rb_ptr). Is it in the non-moving space="
@@ -973,14 +1117,20 @@ bool ConcurrentCopying::ProcessMarkStackOnce() {
   size_t count = 0;
   MarkStackMode mark_stack_mode = mark_stack_mode_.LoadRelaxed();
   if (mark_stack_mode == kMarkStackModeThreadLocal) {
-    // Process the thread-local mark stacks and the GC mark stack.
-    count += ProcessThreadLocalMarkStacks(false);
-    while (!gc_mark_stack_->IsEmpty()) {
-      mirror::Object* to_ref = gc_mark_stack_->PopBack();
-      ProcessMarkStackRef(to_ref);
-      ++count;
+    size_t thread_count = GetParallelMarkThreadCount();
+    if (thread_count > 1) {
+      // Process the thread-local mark stacks and the GC mark stack with worker threads.
+      count += ProcessMarkStackParallel(thread_count);
+    } else {
+      // Process the thread-local mark stacks and the GC mark stack.
+      count += ProcessThreadLocalMarkStacks(false);
+      while (!gc_mark_stack_->IsEmpty()) {
+        mirror::Object* to_ref = gc_mark_stack_->PopBack();
+        ProcessMarkStackRef(to_ref);
+        ++count;
+      }
+      gc_mark_stack_->Reset();
     }
-    gc_mark_stack_->Reset();
   } else if (mark_stack_mode == kMarkStackModeShared) {
     // Process the shared GC mark stack with a lock.
     {
@@ -1045,19 +1195,192 @@ size_t ConcurrentCopying::ProcessThreadLocalMarkStacks(bool disable_weak_ref_acc
     }
     {
       MutexLock mu(Thread::Current(), mark_stack_lock_);
-      if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
-        // The pool has enough. Delete it.
-        delete mark_stack;
-      } else {
-        // Otherwise, put it into the pool for later reuse.
-        mark_stack->Reset();
-        pooled_mark_stacks_.push_back(mark_stack);
+      RecycleMarkStackLocked(mark_stack);
+    }
+  }
+  return count;
+}
+
+size_t ConcurrentCopying::GetParallelMarkThreadCount() const {
+  // Like MarkSweep, use the GC thread only in a background state (non jank perceptible) to leave
+  // more CPU time for the foreground apps.
+  if (heap_->GetThreadPool() == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return heap_->GetConcGCThreadCount() + 1;
+}
+
+class ConcurrentCopying::ParallelMarkTask : public Task {
+ public:
+  explicit ParallelMarkTask(ConcurrentCopying* collector) : collector_(collector) {}
+
+  virtual void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    // The GC-running thread holds the mutator lock on behalf of the workers.
+    collector_->RunParallelMarkWorker(self);
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+};
+
+size_t ConcurrentCopying::ProcessMarkStackParallel(size_t thread_count) {
+  Thread* self = Thread::Current();
+  // Collect the thread-local mark stacks into revoked_mark_stacks_, which the workers steal from.
+  RevokeThreadLocalMarkStacks(false);
+  {
+    MutexLock mu(self, mark_stack_lock_);
+    size_t num_refs = gc_mark_stack_->Size();
+    for (accounting::ObjectStack* mark_stack : revoked_mark_stacks_) {
+      num_refs += mark_stack->Size();
+    }
+    if (num_refs == 0) {
+      return 0;
+    }
+    if (num_refs >= kMinimumParallelMarkStackSize) {
+      // Share the refs of the GC mark stack too, so that all the initial work can be stolen.
+      while (!gc_mark_stack_->IsEmpty()) {
+        accounting::ObjectStack* mark_stack = GetPooledMarkStackLocked();
+        while (!gc_mark_stack_->IsEmpty() && !mark_stack->IsFull()) {
+          mark_stack->PushBack(gc_mark_stack_->PopBack());
+        }
+        revoked_mark_stacks_.push_back(mark_stack);
       }
+      gc_mark_stack_->Reset();
+    } else {
+      thread_count = 1;
     }
   }
+  if (thread_count == 1) {
+    // Not worth starting the workers.
+    RunParallelMarkWorker(self);
+  } else {
+    ThreadPool* thread_pool = heap_->GetThreadPool();
+    DCHECK(thread_pool != nullptr);
+    thread_pool->SetMaxActiveWorkers(thread_count - 1);
+    for (size_t i = 0; i < thread_count; ++i) {
+      thread_pool->AddTask(self, new ParallelMarkTask(this));
+    }
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, true, true);
+    thread_pool->StopWorkers(self);
+  }
+  if (kIsDebugBuild) {
+    // Mutators may have pushed overflowed mark stacks since, they're processed in the next round.
+    MutexLock mu(self, mark_stack_lock_);
+    CHECK_EQ(parallel_mark_active_workers_, 0u);
+  }
+  DCHECK(gc_mark_stack_->IsEmpty());
+  gc_mark_stack_->Reset();
+  size_t count = parallel_mark_count_.LoadSequentiallyConsistent();
+  parallel_mark_count_.StoreRelaxed(0u);
   return count;
 }
 
+void ConcurrentCopying::RunParallelMarkWorker(Thread* self) {
+  {
+    MutexLock mu(self, mark_stack_lock_);
+    ++parallel_mark_active_workers_;
+  }
+  if (self != thread_running_gc_) {
+    // Copy into a region of its own to avoid contending on the shared evacuation region. If this
+    // fails, Copy() falls back to the shared evacuation region.
+    region_space_->AllocNewEvacTlab(self);
+  }
+  size_t count = ParallelMarkLoop(self);
+  parallel_mark_count_.FetchAndAddSequentiallyConsistent(count);
+  if (self != thread_running_gc_) {
+    if (region_space_->HasEvacTlab(self)) {
+      region_space_->RevokeEvacTlab(self);
+    }
+    accounting::ObjectStack* tl_mark_stack = self->GetThreadLocalMarkStack();
+    if (tl_mark_stack != nullptr) {
+      DCHECK(tl_mark_stack->IsEmpty());
+      MutexLock mu(self, mark_stack_lock_);
+      RecycleMarkStackLocked(tl_mark_stack);
+      self->SetThreadLocalMarkStack(nullptr);
+    }
+  }
+}
+
+size_t ConcurrentCopying::ParallelMarkLoop(Thread* self) {
+  size_t count = 0;
+  while (true) {
+    // Process the refs this thread pushed first. The GC-running thread pushes onto the GC mark
+    // stack and the workers onto their thread-local mark stacks (see PushOntoMarkStack()).
+    while (true) {
+      accounting::ObjectStack* mark_stack = self == thread_running_gc_
+          ? gc_mark_stack_.get()
+          : self->GetThreadLocalMarkStack();
+      if (mark_stack == nullptr || mark_stack->IsEmpty()) {
+        break;
+      }
+      if (parallel_mark_idle_workers_.LoadRelaxed() != 0 &&
+          mark_stack->Size() >= 2 * kMarkStackDonationSize) {
+        DonateMarkStackRefs(self, mark_stack);
+      }
+      ProcessMarkStackRef(mark_stack->PopBack());
+      ++count;
+    }
+    // Steal a mark stack donated, overflowed or revoked by another thread.
+    accounting::ObjectStack* stolen_mark_stack = nullptr;
+    {
+      MutexLock mu(self, mark_stack_lock_);
+      if (!revoked_mark_stacks_.empty()) {
+        stolen_mark_stack = revoked_mark_stacks_.back();
+        revoked_mark_stacks_.pop_back();
+      } else {
+        --parallel_mark_active_workers_;
+      }
+    }
+    if (stolen_mark_stack != nullptr) {
+      for (StackReference<mirror::Object>* p = stolen_mark_stack->Begin();
+           p != stolen_mark_stack->End(); ++p) {
+        ProcessMarkStackRef(p->AsMirrorPtr());
+        ++count;
+      }
+      MutexLock mu(self, mark_stack_lock_);
+      RecycleMarkStackLocked(stolen_mark_stack);
+      continue;
+    }
+    // Out of refs. Wait until another worker donates some, or until all the workers are out of
+    // refs, in which case no more can be pushed by the workers.
+    parallel_mark_idle_workers_.FetchAndAddSequentiallyConsistent(1);
+    bool done;
+    while (true) {
+      {
+        MutexLock mu(self, mark_stack_lock_);
+        if (!revoked_mark_stacks_.empty()) {
+          ++parallel_mark_active_workers_;
+          done = false;
+          break;
+        }
+        if (parallel_mark_active_workers_ == 0) {
+          done = true;
+          break;
+        }
+      }
+      sched_yield();
+    }
+    parallel_mark_idle_workers_.FetchAndSubSequentiallyConsistent(1);
+    if (done) {
+      return count;
+    }
+  }
+}
+
+void ConcurrentCopying::DonateMarkStackRefs(Thread* self, accounting::ObjectStack* mark_stack) {
+  MutexLock mu(self, mark_stack_lock_);
+  accounting::ObjectStack* donated_mark_stack = GetPooledMarkStackLocked();
+  for (size_t i = 0; i < kMarkStackDonationSize; ++i) {
+    donated_mark_stack->PushBack(mark_stack->PopBack());
+  }
+  revoked_mark_stacks_.push_back(donated_mark_stack);
+}
+
 inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
   DCHECK(!region_space_->IsInFromSpace(to_ref));
   if (kUseBakerReadBarrier) {
@@ -1249,7 +1572,12 @@ void ConcurrentCopying::ClearBlackPtrs() {
     if (space == region_space_) {
       continue;
     }
-    accounting::ContinuousSpaceBitmap* mark_bitmap = space->GetMarkBitmap();
+    // The mark bitmap of an image space is its live bitmap, the marked immune objects are in
+    // the cc bitmaps.
+    accounting::ContinuousSpaceBitmap* mark_bitmap = immune_spaces_.ContainsSpace(space)
+        ? cc_heap_bitmap_->GetContinuousSpaceBitmap(
+            reinterpret_cast<mirror::Object*>(space->Begin()))
+        : space->GetMarkBitmap();
     if (kVerboseMode) {
       LOG(INFO) << "ClearBlackPtrs: " << *space << " bitmap: " << *mark_bitmap;
     }
@@ -1329,6 +1657,10 @@ void ConcurrentCopying::ReclaimPhase() {
       LOG(INFO) << "(before) num_bytes_allocated=" << heap_->num_bytes_allocated_.LoadSequentiallyConsistent();
     }
     RecordFree(ObjectBytePair(freed_objects, freed_bytes));
+    if (young_gen_) {
+      // The survivors of a young collection are old objects from now on.
+      GetCurrentIteration()->SetPromotedBytes(to_bytes);
+    }
     if (kVerboseMode) {
       LOG(INFO) << "(after) num_bytes_allocated=" << heap_->num_bytes_allocated_.LoadSequentiallyConsistent();
     }
@@ -1349,8 +1681,17 @@ void ConcurrentCopying::ReclaimPhase() {
     if (kUseBakerReadBarrier) {
       ClearBlackPtrs();
     }
-    Sweep(false);
-    SwapBitmaps();
+    if (young_gen_) {
+      // A young collection doesn't sweep the spaces outside of the region space, the objects
+      // allocated there since the previous collection become old.
+      TimingLogger::ScopedTiming split5("MarkStackAsLive", GetTimings());
+      accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+      heap_->MarkAllocStackAsLive(live_stack);
+      live_stack->Reset();
+    } else {
+      Sweep(false);
+      SwapBitmaps();
+    }
     heap_->UnBindBitmaps();
 
     // Remove bitmaps for the immune spaces.
@@ -1385,6 +1726,10 @@ class ConcurrentCopying::ComputeUnevacFromSpaceLiveRatioVisitor {
       ref->AtomicSetReadBarrierPointer(ReadBarrier::BlackPtr(), ReadBarrier::WhitePtr());
       DCHECK_EQ(ref->GetReadBarrierPointer(), ReadBarrier::WhitePtr()) << ref;
     }
+    if (collector_->generational_) {
+      // The object survived in place.
+      collector_->region_space_old_bitmap_->Set(ref);
+    }
     size_t obj_size = ref->SizeOf();
     size_t alloc_size = RoundUp(obj_size, space::RegionSpace::kAlignment);
     collector_->region_space_->AddLiveBytes(ref, alloc_size);
@@ -1396,7 +1741,10 @@ class ConcurrentCopying::ComputeUnevacFromSpaceLiveRatioVisitor {
 
 // Compute how much live objects are left in regions.
 void ConcurrentCopying::ComputeUnevacFromSpaceLiveRatio() {
-  region_space_->AssertAllRegionLiveBytesZeroOrCleared();
+  if (!young_gen_) {
+    // The old regions of a young collection keep the live bytes of the last full collection.
+    region_space_->AssertAllRegionLiveBytesZeroOrCleared();
+  }
   ComputeUnevacFromSpaceLiveRatioVisitor visitor(this);
   region_space_bitmap_->VisitMarkedRange(reinterpret_cast<uintptr_t>(region_space_->Begin()),
                                          reinterpret_cast<uintptr_t>(region_space_->Limit()),
@@ -1406,7 +1754,8 @@ void ConcurrentCopying::ComputeUnevacFromSpaceLiveRatio() {
 // Assert the to-space invariant.
 void ConcurrentCopying::AssertToSpaceInvariant(mirror::Object* obj, MemberOffset offset,
                                                mirror::Object* ref) {
-  CHECK(heap_->collector_type_ == kCollectorTypeCC) << static_cast<size_t>(heap_->collector_type_);
+  CHECK(Heap::IsConcurrentCopyingGc(heap_->collector_type_))
+      << static_cast<size_t>(heap_->collector_type_);
   if (is_asserting_to_space_invariant_) {
     if (region_space_->IsInToSpace(ref)) {
       // OK.
@@ -1453,7 +1802,8 @@ class RootPrinter {
 
 void ConcurrentCopying::AssertToSpaceInvariant(GcRootSource* gc_root_source,
                                                mirror::Object* ref) {
-  CHECK(heap_->collector_type_ == kCollectorTypeCC) << static_cast<size_t>(heap_->collector_type_);
+  CHECK(Heap::IsConcurrentCopyingGc(heap_->collector_type_))
+      << static_cast<size_t>(heap_->collector_type_);
   if (is_asserting_to_space_invariant_) {
     if (region_space_->IsInToSpace(ref)) {
       // OK.
@@ -1545,6 +1895,10 @@ void ConcurrentCopying::LogFromSpaceRefHolder(mirror::Object* obj, MemberOffset
 
 void ConcurrentCopying::AssertToSpaceInvariantInNonMovingSpace(mirror::Object* obj,
                                                                mirror::Object* ref) {
+  if (young_gen_) {
+    // A young collection doesn't mark the objects outside of the region space.
+    return;
+  }
   // In a non-moving spaces. Check that the ref is marked.
   if (immune_spaces_.ContainsObject(ref)) {
     accounting::ContinuousSpaceBitmap* cc_bitmap =
@@ -1787,12 +2141,39 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
   // call will access the from-space meta objects, but it's ok and necessary.
   size_t obj_size = from_ref->SizeOf<kDefaultVerifyFlags, kWithoutReadBarrier>();
   size_t region_space_alloc_size = RoundUp(obj_size, space::RegionSpace::kAlignment);
+  // Only strings which survived an earlier collection are deduplicated. The runtime fills in
+  // the characters of new strings after allocating them, so a young string may still change.
+  const bool dedup_string = string_dedup_table_ != nullptr &&
+      from_ref->IsString<kVerifyNone, kWithoutReadBarrier>() &&
+      !region_space_->IsInNewlyAllocatedRegion(from_ref);
+  if (dedup_string) {
+    mirror::Object* canonical = DeduplicateString(down_cast<mirror::String*>(from_ref),
+                                                  region_space_alloc_size);
+    if (canonical != nullptr) {
+      return canonical;
+    }
+  }
   size_t region_space_bytes_allocated = 0U;
   size_t non_moving_space_bytes_allocated = 0U;
   size_t bytes_allocated = 0U;
   size_t dummy;
-  mirror::Object* to_ref = region_space_->AllocNonvirtual<true>(
-      region_space_alloc_size, &region_space_bytes_allocated, nullptr, &dummy);
+  mirror::Object* to_ref = nullptr;
+  Thread* const self = Thread::Current();
+  if (region_space_->HasEvacTlab(self)) {
+    // A parallel marking worker copies into its own region without synchronization.
+    if (self->TlabSize() < region_space_alloc_size &&
+        region_space_alloc_size <= space::RegionSpace::kMaxEvacTlabObjectSize) {
+      region_space_->AllocNewEvacTlab(self);
+    }
+    if (self->HasTlab() && self->TlabSize() >= region_space_alloc_size) {
+      to_ref = self->AllocTlab(region_space_alloc_size);
+      region_space_bytes_allocated = region_space_alloc_size;
+    }
+  }
+  if (to_ref == nullptr) {
+    to_ref = region_space_->AllocNonvirtual<true>(
+        region_space_alloc_size, &region_space_bytes_allocated, nullptr, &dummy);
+  }
   bytes_allocated = region_space_bytes_allocated;
   if (to_ref != nullptr) {
     DCHECK_EQ(region_space_alloc_size, region_space_bytes_allocated);
@@ -1817,7 +2198,7 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
                   << " skipped_objects=" << to_space_objects_skipped_.LoadSequentiallyConsistent();
       }
       fall_back_to_non_moving = true;
-      to_ref = heap_->non_moving_space_->Alloc(Thread::Current(), obj_size,
+      to_ref = heap_->non_moving_space_->Alloc(self, obj_size,
                                                &non_moving_space_bytes_allocated, nullptr, &dummy);
       CHECK(to_ref != nullptr) << "Fall-back non-moving space allocation failed";
       bytes_allocated = non_moving_space_bytes_allocated;
@@ -1894,15 +2275,26 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
       bytes_moved_.FetchAndAddSequentiallyConsistent(region_space_alloc_size);
       if (LIKELY(!fall_back_to_non_moving)) {
         DCHECK(region_space_->IsInToSpace(to_ref));
+        if (generational_) {
+          // The copies are old objects.
+          region_space_old_bitmap_->AtomicTestAndSet(to_ref);
+        }
       } else {
         DCHECK(heap_->non_moving_space_->HasAddress(to_ref));
         DCHECK_EQ(bytes_allocated, non_moving_space_bytes_allocated);
+        if (young_gen_) {
+          // A young collection doesn't sweep, so it doesn't swap the bitmaps.
+          heap_->non_moving_space_->GetLiveBitmap()->AtomicTestAndSet(to_ref);
+        }
       }
       if (kUseBakerReadBarrier) {
         DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr());
       }
       DCHECK(GetFwdPtr(from_ref) == to_ref);
       CHECK_NE(to_ref->GetLockWord(false).GetState(), LockWord::kForwardingAddress);
+      if (dedup_string && old_lock_word.GetState() == LockWord::kUnlocked) {
+        string_dedup_table_->Add(down_cast<mirror::String*>(to_ref));
+      }
       PushOntoMarkStack(to_ref);
       return to_ref;
     } else {
@@ -1912,6 +2304,28 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
   }
 }
 
+mirror::Object* ConcurrentCopying::DeduplicateString(mirror::String* from_str,
+                                                     size_t alloc_size) {
+  LockWord old_lock_word = from_str->GetLockWord(false);
+  if (old_lock_word.GetState() != LockWord::kUnlocked) {
+    // A locked string, or one with an identity hash code, keeps its identity. If it is already
+    // forwarded, the caller finds that out when it tries to install its own copy.
+    return nullptr;
+  }
+  mirror::String* canonical = string_dedup_table_->Find(from_str);
+  if (canonical == nullptr) {
+    return nullptr;
+  }
+  // The canonical string was copied and pushed onto the mark stack by this collection, so it can
+  // stand for the from-space string exactly like the copy of another thread which won the race.
+  LockWord new_lock_word = LockWord::FromForwardingAddress(reinterpret_cast<size_t>(canonical));
+  if (!from_str->CasLockWordWeakSequentiallyConsistent(old_lock_word, new_lock_word)) {
+    return nullptr;
+  }
+  string_dedup_table_->RecordDeduplicated(alloc_size);
+  return canonical;
+}
+
 mirror::Object* ConcurrentCopying::IsMarked(mirror::Object* from_ref) {
   DCHECK(from_ref != nullptr);
   space::RegionSpace::RegionType rtype = region_space_->GetRegionType(from_ref);
@@ -1931,6 +2345,9 @@ mirror::Object* ConcurrentCopying::IsMarked(mirror::Object* from_ref) {
     } else {
       to_ref = nullptr;
     }
+  } else if (young_gen_) {
+    // A young collection doesn't collect the non-moving spaces.
+    to_ref = from_ref;
   } else {
     // from_ref is in a non-moving space.
     if (immune_spaces_.ContainsObject(from_ref)) {
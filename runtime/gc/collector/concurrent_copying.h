@@ -36,8 +36,14 @@
 namespace art {
 class RootInfo;
 
+namespace mirror {
+class String;
+}  // namespace mirror
+
 namespace gc {
 
+class StringDedupTable;
+
 namespace accounting {
   typedef SpaceBitmap<kObjectAlignment> ContinuousSpaceBitmap;
   class HeapBitmap;
@@ -59,7 +65,8 @@ class ConcurrentCopying : public GarbageCollector {
   // Enable verbose mode.
   static constexpr bool kVerboseMode = false;
 
-  ConcurrentCopying(Heap* heap, const std::string& name_prefix = "");
+  // If `generational`, the collector also runs young collections, see SetYoungGen().
+  ConcurrentCopying(Heap* heap, bool generational = false, const std::string& name_prefix = "");
   ~ConcurrentCopying();
 
   virtual void RunPhases() OVERRIDE REQUIRES(!mark_stack_lock_, !skipped_blocks_lock_);
@@ -72,10 +79,23 @@ class ConcurrentCopying : public GarbageCollector {
   void BindBitmaps() SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::heap_bitmap_lock_);
   virtual GcType GetGcType() const OVERRIDE {
-    return kGcTypePartial;
+    return young_gen_ ? kGcTypeSticky : kGcTypePartial;
   }
   virtual CollectorType GetCollectorType() const OVERRIDE {
-    return kCollectorTypeCC;
+    return generational_ ? kCollectorTypeGenCC : kCollectorTypeCC;
+  }
+  // Select whether the next collection is a young collection, which only evacuates the regions
+  // allocated since the previous collection and relies on the card table to find the old objects
+  // referring to them. Only for the generational mode.
+  void SetYoungGen(bool young_gen) {
+    DCHECK(generational_ || !young_gen);
+    // The old objects are only known after a full collection.
+    young_gen_ = young_gen && region_space_old_bitmap_ != nullptr;
+  }
+  // Forget the old objects found by the previous full collection, e.g. after another collector
+  // cleared the region space. The next collection is then a full collection.
+  void ResetOldObjects() {
+    region_space_old_bitmap_.reset();
   }
   virtual void RevokeAllThreadLocalBuffers() OVERRIDE;
   void SetRegionSpace(space::RegionSpace* region_space) {
@@ -115,6 +135,9 @@ class ConcurrentCopying : public GarbageCollector {
       REQUIRES(!mark_stack_lock_);
   mirror::Object* Copy(mirror::Object* from_ref) SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!skipped_blocks_lock_, !mark_stack_lock_);
+  // Forward `from_str` to the copy of an equal string, if there is one, and return that copy.
+  mirror::Object* DeduplicateString(mirror::String* from_str, size_t alloc_size)
+      SHARED_REQUIRES(Locks::mutator_lock_);
   void Scan(mirror::Object* to_ref) SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
   void Process(mirror::Object* obj, MemberOffset offset)
@@ -138,6 +161,18 @@ class ConcurrentCopying : public GarbageCollector {
       REQUIRES(!mark_stack_lock_);
   size_t ProcessThreadLocalMarkStacks(bool disable_weak_ref_access)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // The number of threads, including the GC-running thread, which process the mark stacks.
+  size_t GetParallelMarkThreadCount() const;
+  size_t ProcessMarkStackParallel(size_t thread_count)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  void RunParallelMarkWorker(Thread* self)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  size_t ParallelMarkLoop(Thread* self)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  void DonateMarkStackRefs(Thread* self, accounting::ObjectStack* mark_stack)
+      REQUIRES(!mark_stack_lock_);
+  accounting::ObjectStack* GetPooledMarkStackLocked() REQUIRES(mark_stack_lock_);
+  void RecycleMarkStackLocked(accounting::ObjectStack* mark_stack) REQUIRES(mark_stack_lock_);
   void RevokeThreadLocalMarkStacks(bool disable_weak_ref_access)
       SHARED_REQUIRES(Locks::mutator_lock_);
   void SwitchToSharedMarkStackMode() SHARED_REQUIRES(Locks::mutator_lock_)
@@ -185,6 +220,8 @@ class ConcurrentCopying : public GarbageCollector {
   void ExpandGcMarkStack() SHARED_REQUIRES(Locks::mutator_lock_);
   mirror::Object* MarkNonMoving(mirror::Object* from_ref) SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_, !skipped_blocks_lock_);
+  void GrayOldObjects() REQUIRES(Locks::mutator_lock_, !mark_stack_lock_);
+  void GrayOldObject(mirror::Object* obj) REQUIRES(Locks::mutator_lock_, !mark_stack_lock_);
 
   space::RegionSpace* region_space_;      // The underlying region space.
   std::unique_ptr<Barrier> gc_barrier_;
@@ -196,6 +233,16 @@ class ConcurrentCopying : public GarbageCollector {
   static constexpr size_t kMarkStackPoolSize = 256;
   std::vector<accounting::ObjectStack*> pooled_mark_stacks_
       GUARDED_BY(mark_stack_lock_);
+  // Don't process the mark stacks in parallel if they hold fewer refs than this.
+  static constexpr size_t kMinimumParallelMarkStackSize = 128;
+  // The number of refs a parallel marking worker gives away at a time to idle workers.
+  static constexpr size_t kMarkStackDonationSize = 256;
+  // The parallel marking workers that haven't run out of refs to process.
+  size_t parallel_mark_active_workers_ GUARDED_BY(mark_stack_lock_);
+  // The parallel marking workers waiting for refs to steal.
+  Atomic<size_t> parallel_mark_idle_workers_;
+  // The number of refs processed by the parallel marking workers.
+  Atomic<size_t> parallel_mark_count_;
   Thread* thread_running_gc_;
   bool is_marking_;                       // True while marking is ongoing.
   bool is_active_;                        // True while the collection is ongoing.
@@ -237,6 +284,15 @@ class ConcurrentCopying : public GarbageCollector {
   accounting::ReadBarrierTable* rb_table_;
   bool force_evacuate_all_;  // True if all regions are evacuated.
 
+  const bool generational_;  // True if the collector runs young collections.
+  bool young_gen_;           // True if the current collection is a young collection.
+  // The objects of the region space which survived a collection, used in young collections to
+  // find the old objects on dirty cards. Only in the generational mode.
+  std::unique_ptr<accounting::ContinuousSpaceBitmap> region_space_old_bitmap_;
+  // The heap's string deduplication table during a full collection with deduplication enabled,
+  // otherwise null.
+  StringDedupTable* string_dedup_table_;
+
   class AssertToSpaceInvariantFieldVisitor;
   class AssertToSpaceInvariantObjectVisitor;
   class AssertToSpaceInvariantRefsVisitor;
@@ -244,8 +300,10 @@ class ConcurrentCopying : public GarbageCollector {
   class ComputeUnevacFromSpaceLiveRatioVisitor;
   class DisableMarkingCheckpoint;
   class FlipCallback;
+  class GrayOldObjectVisitor;
   class ImmuneSpaceObjVisitor;
   class LostCopyVisitor;
+  class ParallelMarkTask;
   class RefFieldsVisitor;
   class RevokeThreadLocalMarkStackCheckpoint;
   class VerifyNoFromSpaceRefsFieldVisitor;
@@ -49,6 +49,7 @@ void Iteration::Reset(GcCause gc_cause, bool clear_soft_references) {
   freed_ = ObjectBytePair();
   freed_los_ = ObjectBytePair();
   freed_bytes_revoke_ = 0;
+  promoted_bytes_ = 0;
 }
 
 uint64_t Iteration::GetEstimatedThroughput() const {
@@ -105,6 +106,7 @@ void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
     MutexLock mu(self, pause_histogram_lock_);
     pause_histogram_.AdjustAndAddValue(pause_time);
   }
+  stats_.RecordIteration(*current_iteration);
 }
 
 void GarbageCollector::SwapBitmaps() {
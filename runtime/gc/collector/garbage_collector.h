@@ -25,6 +25,7 @@
 #include "base/timing_logger.h"
 #include "gc/collector_type.h"
 #include "gc/gc_cause.h"
+#include "gc/gc_stats.h"
 #include "gc_root.h"
 #include "gc_type.h"
 #include "object_callbacks.h"
@@ -69,6 +70,9 @@ class Iteration {
   TimingLogger* GetTimings() {
     return &timings_;
   }
+  const TimingLogger& GetTimings() const {
+    return timings_;
+  }
   // Returns how long the GC took to complete in nanoseconds.
   uint64_t GetDurationNs() const {
     return duration_ns_;
@@ -91,6 +95,13 @@ class Iteration {
   void SetFreedRevoke(uint64_t freed) {
     freed_bytes_revoke_ = freed;
   }
+  // Returns how many bytes were promoted to the old generation by a generational collector.
+  uint64_t GetPromotedBytes() const {
+    return promoted_bytes_;
+  }
+  void SetPromotedBytes(uint64_t promoted_bytes) {
+    promoted_bytes_ = promoted_bytes;
+  }
   void Reset(GcCause gc_cause, bool clear_soft_references);
   // Returns the estimated throughput of the iteration.
   uint64_t GetEstimatedThroughput() const;
@@ -116,6 +127,7 @@ class Iteration {
   ObjectBytePair freed_;
   ObjectBytePair freed_los_;
   uint64_t freed_bytes_revoke_;  // see Heap::num_bytes_freed_revoke_.
+  uint64_t promoted_bytes_;
   std::vector<uint64_t> pause_times_;
 
   friend class GarbageCollector;
@@ -182,6 +194,10 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
   // Record a free of large objects.
   void RecordFreeLOS(const ObjectBytePair& freed);
   void DumpPerformanceInfo(std::ostream& os) REQUIRES(!pause_histogram_lock_);
+  // Returns the statistics exported to monitoring, which can be read without locks.
+  const CollectorStats& GetStats() const {
+    return stats_;
+  }
 
   // Helper functions for querying if objects are marked. These are used for processing references,
   // and will be used for reading system weaks while the GC is running.
@@ -217,6 +233,8 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
   int64_t total_freed_bytes_;
   CumulativeLogger cumulative_timings_;
   mutable Mutex pause_histogram_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Not reset by ResetMeasurements().
+  CollectorStats stats_;
 
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(GarbageCollector);
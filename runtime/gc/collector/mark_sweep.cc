@@ -1167,6 +1167,11 @@ void MarkSweep::MarkRootsCheckpoint(Thread* self,
   // Request the check point is run on all threads returning a count of the threads that must
   // run through the barrier including self.
   size_t barrier_count = thread_list->RunCheckpoint(&check_point);
+  if (revoke_ros_alloc_thread_local_buffers_at_checkpoint) {
+    // No thread owns the per-CPU runs, so the checkpoint does not revoke them. Their locks let
+    // them be revoked while the threads allocate.
+    GetHeap()->RevokeRosAllocCpuBuffers();
+  }
   // Release locks then wait for all mutator threads to pass the barrier.
   // If there are no threads to wait which implys that all the checkpoint functions are finished,
   // then no need to release locks.
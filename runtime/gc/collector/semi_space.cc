@@ -802,6 +802,7 @@ void SemiSpace::FinishPhase() {
   mark_stack_->Reset();
   space::LargeObjectSpace* los = GetHeap()->GetLargeObjectsSpace();
   if (generational_) {
+    GetCurrentIteration()->SetPromotedBytes(bytes_promoted_);
     // Decide whether to do a whole heap collection or a bump pointer
     // only space collection at the next collection by updating
     // collect_from_space_only_.
@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gc_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sstream>
+
+#include "base/bit_utils.h"
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
+#include "base/unix_file/fd_file.h"
+#include "gc/collector/garbage_collector.h"
+#include "gc/heap.h"
+#include "gc/space/large_object_space.h"
+#include "gc/space/space-inl.h"
+#include "gc/string_dedup_table.h"
+#include "os.h"
+
+namespace art {
+namespace gc {
+
+// Print `str` as a JSON string. The names of the phases and spaces are plain ASCII, only the
+// quotes and the control characters need escaping.
+static void DumpJsonString(std::ostream& os, const char* str) {
+  os << '"';
+  for (const char* c = str; *c != '\0'; ++c) {
+    if (*c == '"' || *c == '\\') {
+      os << '\\' << *c;
+    } else if (static_cast<unsigned char>(*c) < 0x20) {
+      os << StringPrintf("\\u%04x", *c);
+    } else {
+      os << *c;
+    }
+  }
+  os << '"';
+}
+
+// Copy `name` to a fixed size entry name, truncating it if needed.
+static void CopyName(char (&dest)[CollectorStats::kMaxNameLength], const char* name) {
+  strncpy(dest, name, CollectorStats::kMaxNameLength - 1);
+  dest[CollectorStats::kMaxNameLength - 1] = '\0';
+}
+
+static bool NameEquals(const char (&entry_name)[CollectorStats::kMaxNameLength],
+                       const char* name) {
+  return strncmp(entry_name, name, CollectorStats::kMaxNameLength - 1) == 0;
+}
+
+AtomicDurationHistogram::AtomicDurationHistogram() : sum_us_(0u), max_us_(0u) {}
+
+size_t AtomicDurationHistogram::BucketIndex(uint64_t value_us) {
+  if (value_us < kSubBuckets) {
+    return value_us;
+  }
+  // The kSubBucketBits bits after the most significant bit select the sub-bucket.
+  const size_t shift = (63 - CLZ(value_us)) - kSubBucketBits;
+  return (shift + 1) * kSubBuckets + ((value_us >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t AtomicDurationHistogram::BucketEnd(size_t index) {
+  if (index < kSubBuckets) {
+    return index + 1;
+  }
+  const size_t shift = index / kSubBuckets - 1;
+  const uint64_t sub_bucket = index % kSubBuckets;
+  return (kSubBuckets + sub_bucket + 1) << shift;
+}
+
+void AtomicDurationHistogram::AddValue(uint64_t duration_ns) {
+  const uint64_t value_us = duration_ns / 1000;
+  buckets_[BucketIndex(value_us)].FetchAndAddRelaxed(1u);
+  sum_us_.FetchAndAddRelaxed(value_us);
+  uint64_t max_us = max_us_.LoadRelaxed();
+  while (value_us > max_us && !max_us_.CompareExchangeWeakRelaxed(max_us, value_us)) {
+    max_us = max_us_.LoadRelaxed();
+  }
+}
+
+uint64_t AtomicDurationHistogram::GetCount() const {
+  uint64_t count = 0;
+  for (const Atomic<uint64_t>& bucket : buckets_) {
+    count += bucket.LoadRelaxed();
+  }
+  return count;
+}
+
+uint64_t AtomicDurationHistogram::PercentileNs(double percentile) const {
+  // The buckets may be updated while they are read, use a single load of each.
+  uint64_t counts[kNumBuckets];
+  uint64_t total = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].LoadRelaxed();
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(percentile * total + 0.5), 1u);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(BucketEnd(i), std::max<uint64_t>(max_us_.LoadRelaxed(), 1u)) * 1000;
+    }
+  }
+  return GetMaxNs();
+}
+
+void AtomicDurationHistogram::DumpJson(std::ostream& os) const {
+  os << "{\"count\":" << GetCount()
+     << ",\"sum_ns\":" << GetSumNs()
+     << ",\"max_ns\":" << GetMaxNs()
+     << ",\"p50_ns\":" << PercentileNs(0.5)
+     << ",\"p90_ns\":" << PercentileNs(0.9)
+     << ",\"p99_ns\":" << PercentileNs(0.99)
+     << ",\"p999_ns\":" << PercentileNs(0.999)
+     << "}";
+}
+
+CollectorStats::CollectorStats()
+    : iterations_(0u),
+      total_time_ns_(0u),
+      freed_bytes_(0),
+      freed_objects_(0u),
+      promoted_bytes_(0u),
+      num_phases_(0u) {}
+
+CollectorStats::Phase* CollectorStats::FindOrAddPhase(const char* name) {
+  // Only the thread running the collector adds phases, no need for a CAS.
+  const size_t num_phases = num_phases_.LoadRelaxed();
+  for (size_t i = 0; i < num_phases; ++i) {
+    if (NameEquals(phases_[i].name, name)) {
+      return &phases_[i];
+    }
+  }
+  if (num_phases == kMaxPhases) {
+    return nullptr;
+  }
+  Phase* phase = &phases_[num_phases];
+  CopyName(phase->name, name);
+  num_phases_.StoreRelease(num_phases + 1);
+  return phase;
+}
+
+void CollectorStats::RecordIteration(const collector::Iteration& iteration) {
+  const TimingLogger& timings = iteration.GetTimings();
+  TimingLogger::TimingData timing_data(timings.CalculateTimingData());
+  const std::vector<TimingLogger::Timing>& splits = timings.GetTimings();
+  for (size_t i = 0; i < splits.size(); ++i) {
+    if (splits[i].IsStartTiming()) {
+      Phase* phase = FindOrAddPhase(splits[i].GetName());
+      if (phase != nullptr) {
+        phase->count.FetchAndAddRelaxed(1u);
+        phase->total_ns.FetchAndAddRelaxed(timing_data.GetExclusiveTime(i));
+      }
+    }
+  }
+  for (uint64_t pause : iteration.GetPauseTimes()) {
+    pause_histogram_.AddValue(pause);
+  }
+  total_time_ns_.FetchAndAddRelaxed(iteration.GetDurationNs());
+  freed_bytes_.FetchAndAddRelaxed(iteration.GetFreedBytes() +
+                                  iteration.GetFreedLargeObjectBytes());
+  freed_objects_.FetchAndAddRelaxed(iteration.GetFreedObjects() +
+                                    iteration.GetFreedLargeObjects());
+  promoted_bytes_.FetchAndAddRelaxed(iteration.GetPromotedBytes());
+  iterations_.FetchAndAddRelaxed(1u);
+}
+
+void CollectorStats::DumpJsonFields(std::ostream& os) const {
+  os << "\"iterations\":" << iterations_.LoadRelaxed()
+     << ",\"total_time_ns\":" << total_time_ns_.LoadRelaxed()
+     << ",\"freed_bytes\":" << freed_bytes_.LoadRelaxed()
+     << ",\"freed_objects\":" << freed_objects_.LoadRelaxed()
+     << ",\"promoted_bytes\":" << promoted_bytes_.LoadRelaxed()
+     << ",\"pauses\":";
+  pause_histogram_.DumpJson(os);
+  os << ",\"phases\":[";
+  const size_t num_phases = num_phases_.LoadAcquire();
+  for (size_t i = 0; i < num_phases; ++i) {
+    os << (i != 0 ? "," : "") << "{\"name\":";
+    DumpJsonString(os, phases_[i].name);
+    os << ",\"count\":" << phases_[i].count.LoadRelaxed()
+       << ",\"total_ns\":" << phases_[i].total_ns.LoadRelaxed() << "}";
+  }
+  os << "]";
+}
+
+GcStats::GcStats(Heap* heap)
+    : heap_(heap),
+      num_gcs_(0u),
+      allocation_rate_(0u),
+      last_gc_time_ns_(NanoTime()),
+      last_gc_bytes_allocated_ever_(0u),
+      num_spaces_(0u),
+      dump_interval_ns_(Heap::kDefaultGcStatsDumpInterval) {}
+
+void GcStats::RecordSpaceUsage(const char* name, uint64_t gc_index, uint64_t size, uint64_t used) {
+  // Only the thread running the GC adds spaces, no need for a CAS.
+  const size_t num_spaces = num_spaces_.LoadRelaxed();
+  SpaceUsage* space = nullptr;
+  for (size_t i = 0; i < num_spaces; ++i) {
+    if (NameEquals(spaces_[i].name, name)) {
+      space = &spaces_[i];
+      break;
+    }
+  }
+  if (space == nullptr) {
+    if (num_spaces == kMaxSpaces) {
+      return;
+    }
+    space = &spaces_[num_spaces];
+    CopyName(space->name, name);
+    num_spaces_.StoreRelease(num_spaces + 1);
+  }
+  space->size.StoreRelaxed(size);
+  space->used.StoreRelaxed(used);
+  space->last_gc.StoreRelease(gc_index);
+}
+
+void GcStats::RecordGc() {
+  // The spaces are tagged with the index of the GC which last saw them, published after all of
+  // them are updated.
+  const uint64_t gc_index = num_gcs_.LoadRelaxed() + 1;
+  const uint64_t now = NanoTime();
+  const uint64_t bytes_allocated_ever = heap_->GetBytesAllocatedEver();
+  if (now > last_gc_time_ns_ && bytes_allocated_ever >= last_gc_bytes_allocated_ever_) {
+    allocation_rate_.StoreRelaxed(static_cast<uint64_t>(
+        (bytes_allocated_ever - last_gc_bytes_allocated_ever_) * 1000000000.0 /
+        (now - last_gc_time_ns_)));
+  }
+  last_gc_time_ns_ = now;
+  last_gc_bytes_allocated_ever_ = bytes_allocated_ever;
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    uint64_t used = space->IsAllocSpace() ? space->AsAllocSpace()->GetBytesAllocated()
+                                          : space->Size();
+    RecordSpaceUsage(space->GetName(), gc_index, space->Size(), used);
+  }
+  for (space::DiscontinuousSpace* space : heap_->GetDiscontinuousSpaces()) {
+    if (space->IsLargeObjectSpace()) {
+      uint64_t used = space->AsLargeObjectSpace()->GetBytesAllocated();
+      RecordSpaceUsage(space->GetName(), gc_index, used, used);
+    }
+  }
+  num_gcs_.StoreRelease(gc_index);
+}
+
+void GcStats::DumpJson(std::ostream& os) const {
+  uint64_t gc_count = 0;
+  uint64_t gc_time = 0;
+  os << "{\"time_ns\":" << NanoTime() << ",\"collectors\":[";
+  bool first = true;
+  for (collector::GarbageCollector* collector : heap_->garbage_collectors_) {
+    const CollectorStats& stats = collector->GetStats();
+    if (stats.GetIterations() == 0) {
+      continue;
+    }
+    gc_count += stats.GetIterations();
+    gc_time += stats.GetTotalTimeNs();
+    os << (first ? "" : ",") << "{\"name\":";
+    DumpJsonString(os, collector->GetName());
+    os << ",";
+    stats.DumpJsonFields(os);
+    os << "}";
+    first = false;
+  }
+  os << "],\"gc_count\":" << gc_count
+     << ",\"gc_time_ns\":" << gc_time
+     << ",\"bytes_allocated\":" << heap_->GetBytesAllocatedEver()
+     << ",\"allocation_rate\":" << allocation_rate_.LoadRelaxed()
+     << ",\"time_to_safepoint\":";
+  time_to_safepoint_histogram_.DumpJson(os);
+  os << ",\"spaces\":[";
+  const uint64_t num_gcs = num_gcs_.LoadAcquire();
+  const size_t num_spaces = num_spaces_.LoadAcquire();
+  first = true;
+  for (size_t i = 0; i < num_spaces; ++i) {
+    // Skip the spaces removed before the last GC.
+    if (spaces_[i].last_gc.LoadAcquire() < num_gcs) {
+      continue;
+    }
+    os << (first ? "" : ",") << "{\"name\":";
+    DumpJsonString(os, spaces_[i].name);
+    os << ",\"size\":" << spaces_[i].size.LoadRelaxed()
+       << ",\"used\":" << spaces_[i].used.LoadRelaxed() << "}";
+    first = false;
+  }
+  os << "]";
+  const StringDedupTable* string_dedup_table = heap_->GetStringDedupTable();
+  if (string_dedup_table != nullptr) {
+    os << ",\"string_dedup\":{\"strings\":" << string_dedup_table->GetStringsDeduplicated()
+       << ",\"bytes_saved\":" << string_dedup_table->GetBytesSaved() << "}";
+  }
+  os << "}";
+}
+
+bool GcStats::WriteJsonFile(const std::string& file_name) const {
+  std::ostringstream json;
+  DumpJson(json);
+  json << "\n";
+  const std::string contents = json.str();
+  const std::string temp_file_name = file_name + ".tmp";
+  std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(temp_file_name.c_str()));
+  if (file == nullptr) {
+    PLOG(ERROR) << "Could not create GC stats file " << temp_file_name;
+    return false;
+  }
+  if (!file->WriteFully(contents.data(), contents.size()) || file->FlushCloseOrErase() != 0) {
+    PLOG(ERROR) << "Could not write GC stats file " << temp_file_name;
+    return false;
+  }
+  if (rename(temp_file_name.c_str(), file_name.c_str()) != 0) {
+    PLOG(ERROR) << "Could not rename " << temp_file_name << " to " << file_name;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace gc
+}  // namespace art
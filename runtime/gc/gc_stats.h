@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_GC_STATS_H_
+#define ART_RUNTIME_GC_GC_STATS_H_
+
+#include <ostream>
+#include <string>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+namespace gc {
+
+class Heap;
+
+namespace collector {
+class Iteration;
+}  // namespace collector
+
+// A histogram of durations which can be updated and read concurrently without locks. There are
+// kSubBuckets buckets for each power of two of microseconds, so that percentiles are within
+// 1 / kSubBuckets of the exact value.
+class AtomicDurationHistogram {
+ public:
+  AtomicDurationHistogram();
+
+  void AddValue(uint64_t duration_ns);
+
+  uint64_t GetCount() const;
+  uint64_t GetSumNs() const {
+    return sum_us_.LoadRelaxed() * 1000;
+  }
+  uint64_t GetMaxNs() const {
+    return max_us_.LoadRelaxed() * 1000;
+  }
+
+  // Returns an upper bound of the duration under which `percentile` (in [0, 1]) of the values are.
+  uint64_t PercentileNs(double percentile) const;
+
+  // Print the count, sum, max and a few percentiles as a JSON object.
+  void DumpJson(std::ostream& os) const;
+
+ private:
+  static constexpr size_t kSubBucketBits = 3;
+  static constexpr size_t kSubBuckets = 1u << kSubBucketBits;
+  static constexpr size_t kNumBuckets = 64 * kSubBuckets;
+
+  static size_t BucketIndex(uint64_t value_us);
+  // Returns the smallest value, in microseconds, above the values of the bucket.
+  static uint64_t BucketEnd(size_t index);
+
+  Atomic<uint64_t> buckets_[kNumBuckets];
+  Atomic<uint64_t> sum_us_;
+  Atomic<uint64_t> max_us_;
+
+  DISALLOW_COPY_AND_ASSIGN(AtomicDurationHistogram);
+};
+
+// The cumulative statistics of a garbage collector. They are only updated by the thread which
+// runs the collector, at the end of each of its iterations, and can be read by any thread at any
+// time without locks. Unlike the pause histogram and the cumulative timings of the collector,
+// they are never reset.
+class CollectorStats {
+ public:
+  static constexpr size_t kMaxPhases = 64;
+  static constexpr size_t kMaxNameLength = 48;
+
+  CollectorStats();
+
+  void RecordIteration(const collector::Iteration& iteration);
+
+  uint64_t GetIterations() const {
+    return iterations_.LoadRelaxed();
+  }
+  uint64_t GetTotalTimeNs() const {
+    return total_time_ns_.LoadRelaxed();
+  }
+  const AtomicDurationHistogram& GetPauseHistogram() const {
+    return pause_histogram_;
+  }
+
+  // Print the statistics as the fields of a JSON object.
+  void DumpJsonFields(std::ostream& os) const;
+
+ private:
+  // The timing splits of the iterations, by name. Entries are only appended, and the name of an
+  // entry is written before the entry is published by incrementing num_phases_.
+  struct Phase {
+    char name[kMaxNameLength];
+    Atomic<uint64_t> count;
+    Atomic<uint64_t> total_ns;
+  };
+
+  Phase* FindOrAddPhase(const char* name);
+
+  Atomic<uint64_t> iterations_;
+  Atomic<uint64_t> total_time_ns_;
+  Atomic<int64_t> freed_bytes_;
+  Atomic<uint64_t> freed_objects_;
+  Atomic<uint64_t> promoted_bytes_;
+  AtomicDurationHistogram pause_histogram_;
+  Atomic<size_t> num_phases_;
+  Phase phases_[kMaxPhases];
+
+  DISALLOW_COPY_AND_ASSIGN(CollectorStats);
+};
+
+// The heap-wide GC statistics exposed to monitoring: the statistics of each collector, the time
+// to suspend all threads, the allocation rate and the usage of each space. Like CollectorStats,
+// they are updated by the thread running the GC and read without locks, either through
+// VMDebug.getRuntimeStat() or by a periodic dump to a file.
+class GcStats {
+ public:
+  explicit GcStats(Heap* heap);
+
+  // Update the allocation rate and the space usage after a GC.
+  void RecordGc() SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Record how long suspending all threads took.
+  void RecordTimeToSafepoint(uint64_t duration_ns) {
+    time_to_safepoint_histogram_.AddValue(duration_ns);
+  }
+
+  void DumpJson(std::ostream& os) const;
+
+  // Write the statistics as JSON to `file_name`, replacing the previous contents atomically so
+  // that readers never see a partial dump. Return false on I/O error.
+  bool WriteJsonFile(const std::string& file_name) const;
+
+  // Periodically dump the statistics to `file_name` once the heap task daemon runs, see
+  // Heap::StartGcStatsDump().
+  void SetDumpFile(const std::string& file_name, uint64_t interval_ns) {
+    dump_file_name_ = file_name;
+    dump_interval_ns_ = interval_ns;
+  }
+  const std::string& GetDumpFileName() const {
+    return dump_file_name_;
+  }
+  uint64_t GetDumpInterval() const {
+    return dump_interval_ns_;
+  }
+
+ private:
+  // The usage of a space as of the end of the last GC. Like the phases of CollectorStats,
+  // entries are only appended; the spaces which no longer exist are not updated anymore.
+  struct SpaceUsage {
+    char name[CollectorStats::kMaxNameLength];
+    Atomic<uint64_t> last_gc;
+    Atomic<uint64_t> size;
+    Atomic<uint64_t> used;
+  };
+
+  static constexpr size_t kMaxSpaces = 32;
+
+  void RecordSpaceUsage(const char* name, uint64_t gc_index, uint64_t size, uint64_t used);
+
+  Heap* const heap_;
+  AtomicDurationHistogram time_to_safepoint_histogram_;
+  Atomic<uint64_t> num_gcs_;
+  Atomic<uint64_t> allocation_rate_;  // Bytes per second between the last two GCs.
+  uint64_t last_gc_time_ns_;
+  uint64_t last_gc_bytes_allocated_ever_;
+  Atomic<size_t> num_spaces_;
+  SpaceUsage spaces_[kMaxSpaces];
+  std::string dump_file_name_;
+  uint64_t dump_interval_ns_;
+
+  DISALLOW_COPY_AND_ASSIGN(GcStats);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_GC_STATS_H_
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gc_stats.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "runtime.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+class GcStatsTest : public CommonRuntimeTest {};
+
+TEST_F(GcStatsTest, DurationHistogramPercentiles) {
+  AtomicDurationHistogram histogram;
+  EXPECT_EQ(0u, histogram.PercentileNs(0.5));
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.AddValue(i * 1000);
+  }
+  EXPECT_EQ(1000u, histogram.GetCount());
+  EXPECT_EQ(1000 * 1000u, histogram.GetMaxNs());
+  EXPECT_EQ(500500 * 1000u, histogram.GetSumNs());
+  // The percentiles are upper bounds, within 1/8 of the exact values.
+  EXPECT_GE(histogram.PercentileNs(0.5), 500 * 1000u);
+  EXPECT_LE(histogram.PercentileNs(0.5), (500 + 500 / 8) * 1000u);
+  EXPECT_GE(histogram.PercentileNs(0.99), 990 * 1000u);
+  EXPECT_LE(histogram.PercentileNs(0.99), 1000 * 1000u);
+  EXPECT_EQ(1000 * 1000u, histogram.PercentileNs(1.0));
+}
+
+TEST_F(GcStatsTest, DumpJsonAfterGc) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  heap->CollectGarbage(false);
+  // No lock or mutator access is needed to read the stats.
+  std::ostringstream json;
+  heap->GetGcStats()->DumpJson(json);
+  const std::string contents = json.str();
+  ASSERT_FALSE(contents.empty());
+  EXPECT_EQ('{', contents.front());
+  EXPECT_EQ('}', contents.back());
+  EXPECT_NE(std::string::npos, contents.find("\"collectors\":[{\"name\":"));
+  EXPECT_NE(std::string::npos, contents.find("\"p99_ns\":"));
+  EXPECT_NE(std::string::npos, contents.find("\"phases\":[{\"name\":"));
+  EXPECT_NE(std::string::npos, contents.find("\"time_to_safepoint\":{\"count\":"));
+  EXPECT_NE(std::string::npos, contents.find("\"spaces\":[{\"name\":"));
+}
+
+TEST_F(GcStatsTest, WriteJsonFile) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  heap->CollectGarbage(false);
+  ScratchFile file;
+  ASSERT_TRUE(heap->GetGcStats()->WriteJsonFile(file.GetFilename()));
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(file.GetFilename(), &contents));
+  EXPECT_EQ(0u, contents.find("{\"time_ns\":"));
+  EXPECT_EQ('\n', contents.back());
+}
+
+}  // namespace gc
+}  // namespace art
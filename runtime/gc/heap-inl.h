@@ -22,6 +22,7 @@
 #include "base/time_utils.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/allocation_record.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector/semi_space.h"
 #include "gc/space/bump_pointer_space-inl.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -184,6 +185,18 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
   } else {
     DCHECK(!IsAllocTrackingEnabled());
   }
+  // The allocation sampler only instruments the entrypoints when the allocation fast paths do not
+  // stop at the sample points of the thread, see Thread::SetAllocSampleBytesRemaining().
+  if (UNLIKELY(IsAllocSamplingEnabled())) {
+    if (self->CountDownAllocSample(obj, bytes_allocated)) {
+      // allocation_sampler_ is not null since it never becomes null after sampling is enabled.
+      DCHECK(allocation_sampler_ != nullptr);
+      allocation_sampler_->SampleAllocation(self, &obj, bytes_allocated);
+    }
+  } else if (UNLIKELY(self->GetAllocSampleBytesRemaining() != 0)) {
+    // Sampling stopped, let the fast paths use the whole TLAB again.
+    self->SetAllocSampleBytesRemaining(0);
+  }
   if (AllocatorHasAllocationStack(allocator)) {
     PushOnAllocationStack(self, &obj);
   }
@@ -355,6 +368,9 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self,
               return ret;
             }
             *bytes_tl_bulk_allocated = space::RegionSpace::kRegionSize;
+            if (UNLIKELY(region_space_->NeedsPrezeroing())) {
+              RequestRegionPrezero(self);
+            }
             // Fall-through.
           } else {
             // Check OOME for a non-tlab allocation.
@@ -29,6 +29,7 @@
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/time_utils.h"
+#include "class_linker.h"
 #include "common_throws.h"
 #include "cutils/sched_policy.h"
 #include "debugger.h"
@@ -39,12 +40,14 @@
 #include "gc/accounting/mod_union_table-inl.h"
 #include "gc/accounting/remembered_set.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector/concurrent_copying.h"
 #include "gc/collector/mark_compact.h"
 #include "gc/collector/mark_sweep.h"
 #include "gc/collector/partial_mark_sweep.h"
 #include "gc/collector/semi_space.h"
 #include "gc/collector/sticky_mark_sweep.h"
+#include "gc/gc_stats.h"
 #include "gc/reference_processor.h"
 #include "gc/space/bump_pointer_space.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -54,6 +57,7 @@
 #include "gc/space/rosalloc_space-inl.h"
 #include "gc/space/space-inl.h"
 #include "gc/space/zygote_space.h"
+#include "gc/string_dedup_table.h"
 #include "gc/task_processor.h"
 #include "entrypoints/quick/quick_alloc_entrypoints.h"
 #include "heap-inl.h"
@@ -87,6 +91,19 @@ static constexpr size_t kMaxConcurrentRemainingBytes = 512 * KB;
 // relative to partial/full GC. This may be desirable since sticky GCs interfere less with mutator
 // threads (lower pauses, use less memory bandwidth).
 static constexpr double kStickyGcThroughputAdjustment = 1.0;
+// Number of young collections of the generational CC between two full collections.
+static constexpr size_t kGenCCFullCollectionInterval = 5;
+// Weight of the latest GC in the moving averages of the adaptive sizing policy.
+static constexpr double kAdaptiveSizingSmoothing = 0.25;
+// Factors by which the adaptive sizing policy changes its scales after a GC that misses a goal,
+// and the factor by which the scales go back to 1.0 after a GC that meets the goals.
+static constexpr double kAdaptiveScaleUpFactor = 1.25;
+static constexpr double kAdaptiveScaleDownFactor = 0.8;
+static constexpr double kAdaptiveScaleDecayFactor = 0.95;
+// Bounds of the adaptive growth and concurrent start scales.
+static constexpr double kMinAdaptiveGrowthScale = 0.25;
+static constexpr double kMaxAdaptiveGrowthScale = 4.0;
+static constexpr double kMaxAdaptiveConcurrentStartScale = 8.0;
 // Whether or not we compact the zygote in PreZygoteFork.
 static constexpr bool kCompactZygote = kMovingCollector;
 // How many reserve entries are at the end of the allocation stack, these are only needed if the
@@ -144,8 +161,11 @@ Heap::Heap(size_t initial_size,
            bool low_memory_mode,
            size_t long_pause_log_threshold,
            size_t long_gc_log_threshold,
+           size_t gc_pause_target,
+           double gc_cpu_share_target,
            bool ignore_max_footprint,
            bool use_tlab,
+           bool use_rosalloc_per_cpu_runs,
            bool verify_pre_gc_heap,
            bool verify_pre_sweeping_heap,
            bool verify_post_gc_heap,
@@ -169,6 +189,8 @@ Heap::Heap(size_t initial_size,
       low_memory_mode_(low_memory_mode),
       long_pause_log_threshold_(long_pause_log_threshold),
       long_gc_log_threshold_(long_gc_log_threshold),
+      gc_pause_target_(gc_pause_target),
+      gc_cpu_share_target_(gc_cpu_share_target),
       ignore_max_footprint_(ignore_max_footprint),
       zygote_creation_lock_("zygote creation lock", kZygoteCreationLock),
       zygote_space_(nullptr),
@@ -178,6 +200,7 @@ Heap::Heap(size_t initial_size,
       collector_type_running_(kCollectorTypeNone),
       last_gc_type_(collector::kGcTypeNone),
       next_gc_type_(collector::kGcTypePartial),
+      young_cc_collections_since_full_(0u),
       capacity_(capacity),
       growth_limit_(growth_limit),
       max_allowed_footprint_(initial_size),
@@ -221,17 +244,24 @@ Heap::Heap(size_t initial_size,
       max_free_(max_free),
       target_utilization_(target_utilization),
       foreground_heap_growth_multiplier_(foreground_heap_growth_multiplier),
+      adaptive_growth_scale_(1.0),
+      adaptive_concurrent_start_scale_(1.0),
+      smoothed_gc_pause_ns_(0.0),
+      smoothed_gc_cpu_share_(0.0),
+      last_gc_end_time_ns_(0u),
       total_wait_time_(0),
       verify_object_mode_(kVerifyObjectModeDisabled),
       disable_moving_gc_count_(0),
       is_running_on_memory_tool_(Runtime::Current()->IsRunningOnMemoryTool()),
       use_tlab_(use_tlab),
+      use_rosalloc_per_cpu_runs_(use_rosalloc_per_cpu_runs),
       main_space_backup_(nullptr),
       min_interval_homogeneous_space_compaction_by_oom_(
           min_interval_homogeneous_space_compaction_by_oom),
       last_time_homogeneous_space_compaction_by_oom_(NanoTime()),
       pending_collector_transition_(nullptr),
       pending_heap_trim_(nullptr),
+      region_prezero_pending_(false),
       use_homogeneous_space_compaction_for_oom_(use_homogeneous_space_compaction_for_oom),
       running_collection_is_blocking_(false),
       blocking_gc_count_(0U),
@@ -244,6 +274,7 @@ Heap::Heap(size_t initial_size,
       blocking_gc_count_rate_histogram_("blocking gc count rate histogram", 1U,
                                         kGcCountRateMaxBucketCount),
       alloc_tracking_enabled_(false),
+      alloc_sampling_enabled_(false),
       backtrace_lock_(nullptr),
       seen_backtrace_count_(0u),
       unique_backtrace_count_(0u),
@@ -268,7 +299,7 @@ Heap::Heap(size_t initial_size,
   mark_bitmap_.reset(new accounting::HeapBitmap(this));
   // Requested begin for the alloc space, to follow the mapped image and oat files
   uint8_t* requested_alloc_space_begin = nullptr;
-  if (foreground_collector_type_ == kCollectorTypeCC) {
+  if (IsConcurrentCopyingGc(foreground_collector_type_)) {
     // Need to use a low address so that we can allocate a contiguous
     // 2 * Xmx space when there's no image (dex2oat for target).
     CHECK_GE(300 * MB, non_moving_space_capacity);
@@ -350,7 +381,7 @@ Heap::Heap(size_t initial_size,
   */
   // We don't have hspace compaction enabled with GSS or CC.
   if (foreground_collector_type_ == kCollectorTypeGSS ||
-      foreground_collector_type_ == kCollectorTypeCC) {
+      IsConcurrentCopyingGc(foreground_collector_type_)) {
     use_homogeneous_space_compaction_for_oom_ = false;
   }
   bool support_homogeneous_space_compaction =
@@ -400,7 +431,7 @@ Heap::Heap(size_t initial_size,
     request_begin = reinterpret_cast<uint8_t*>(300 * MB);
   }
   // Attempt to create 2 mem maps at or after the requested begin.
-  if (foreground_collector_type_ != kCollectorTypeCC) {
+  if (!IsConcurrentCopyingGc(foreground_collector_type_)) {
     ScopedTrace trace2("Create main mem map");
     if (separate_non_moving_space || !is_zygote) {
       main_mem_map_1.reset(MapAnonymousPreferredAddress(kMemMapSpaceName[0],
@@ -441,7 +472,7 @@ Heap::Heap(size_t initial_size,
     AddSpace(non_moving_space_);
   }
   // Create other spaces based on whether or not we have a moving GC.
-  if (foreground_collector_type_ == kCollectorTypeCC) {
+  if (IsConcurrentCopyingGc(foreground_collector_type_)) {
     region_space_ = space::RegionSpace::Create("Region space", capacity_ * 2, request_begin);
     AddSpace(region_space_);
   } else if (IsMovingGc(foreground_collector_type_) &&
@@ -527,7 +558,7 @@ Heap::Heap(size_t initial_size,
   card_table_.reset(accounting::CardTable::Create(reinterpret_cast<uint8_t*>(kMinHeapAddress),
                                                   4 * GB - kMinHeapAddress));
   CHECK(card_table_.get() != nullptr) << "Failed to create card table";
-  if (foreground_collector_type_ == kCollectorTypeCC && kUseTableLookupReadBarrier) {
+  if (IsConcurrentCopyingGc(foreground_collector_type_) && kUseTableLookupReadBarrier) {
     rb_table_.reset(new accounting::ReadBarrierTable());
     DCHECK(rb_table_->IsAllCleared());
   }
@@ -567,6 +598,7 @@ Heap::Heap(size_t initial_size,
                                                 *thread_flip_lock_));
   task_processor_.reset(new TaskProcessor());
   reference_processor_.reset(new ReferenceProcessor());
+  gc_stats_.reset(new GcStats(this));
   pending_task_lock_ = new Mutex("Pending task lock");
   if (ignore_max_footprint_) {
     SetIdealFootprint(std::numeric_limits<size_t>::max());
@@ -593,8 +625,10 @@ Heap::Heap(size_t initial_size,
                                                        generational ? "generational" : "");
       garbage_collectors_.push_back(semi_space_collector_);
     }
-    if (MayUseCollector(kCollectorTypeCC)) {
-      concurrent_copying_collector_ = new collector::ConcurrentCopying(this);
+    if (MayUseCollector(kCollectorTypeCC) || MayUseCollector(kCollectorTypeGenCC)) {
+      const bool generational = foreground_collector_type_ == kCollectorTypeGenCC;
+      concurrent_copying_collector_ =
+          new collector::ConcurrentCopying(this, generational, generational ? "generational" : "");
       garbage_collectors_.push_back(concurrent_copying_collector_);
     }
     if (MayUseCollector(kCollectorTypeMC)) {
@@ -663,7 +697,8 @@ space::MallocSpace* Heap::CreateMallocSpaceFromMemMap(MemMap* mem_map,
     // Create rosalloc space.
     malloc_space = space::RosAllocSpace::CreateFromMemMap(mem_map, name, kDefaultStartingSize,
                                                           initial_size, growth_limit, capacity,
-                                                          low_memory_mode_, can_move_objects);
+                                                          low_memory_mode_, can_move_objects,
+                                                          use_rosalloc_per_cpu_runs_);
   } else {
     malloc_space = space::DlMallocSpace::CreateFromMemMap(mem_map, name, kDefaultStartingSize,
                                                           initial_size, growth_limit, capacity,
@@ -1045,6 +1080,136 @@ void Heap::VisitObjectsInternal(ObjectCallback callback, void* arg) {
   }
 }
 
+// A part of the heap visited by a single worker of VisitObjectsPausedParallel(): a range of
+// addresses of a space with a live bitmap, a range of regions of the region space, the whole bump
+// pointer space, or a range of entries of the allocation stack if `space` is null.
+struct ParallelVisitChunk {
+  space::Space* space;
+  uintptr_t begin;
+  uintptr_t end;
+};
+
+class ParallelVisitTask : public Task {
+ public:
+  ParallelVisitTask(const std::vector<ParallelVisitChunk>* chunks, Atomic<size_t>* next_chunk,
+                    accounting::ObjectStack* allocation_stack, size_t worker,
+                    Heap::ParallelObjectCallback* callback, void* arg)
+      : chunks_(chunks), next_chunk_(next_chunk), allocation_stack_(allocation_stack),
+        worker_(worker), callback_(callback), arg_(arg) {}
+
+  // The mutator lock is held exclusively by the thread which started the walk, and none of the
+  // objects move or die until it is done.
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    auto visitor = [this](mirror::Object* obj) NO_THREAD_SAFETY_ANALYSIS {
+      callback_(obj, worker_, arg_);
+    };
+    for (size_t i = next_chunk_->FetchAndAddSequentiallyConsistent(1); i < chunks_->size();
+         i = next_chunk_->FetchAndAddSequentiallyConsistent(1)) {
+      const ParallelVisitChunk& chunk = (*chunks_)[i];
+      if (chunk.space == nullptr) {
+        StackReference<mirror::Object>* const begin = allocation_stack_->Begin();
+        for (auto* it = begin + chunk.begin, *end = begin + chunk.end; it < end; ++it) {
+          mirror::Object* const obj = it->AsMirrorPtr();
+          // See VisitObjectsInternal().
+          if (obj != nullptr && obj->GetClass() != nullptr) {
+            visitor(obj);
+          }
+        }
+      } else if (chunk.space->IsRegionSpace()) {
+        chunk.space->AsRegionSpace()->WalkRegions(chunk.begin, chunk.end, VisitCallback, this);
+      } else if (chunk.space->IsBumpPointerSpace()) {
+        chunk.space->AsBumpPointerSpace()->Walk(VisitCallback, this);
+      } else if (chunk.space->IsContinuousSpace()) {
+        chunk.space->AsContinuousSpace()->GetLiveBitmap()->VisitMarkedRange(
+            chunk.begin, chunk.end, visitor);
+      } else {
+        chunk.space->AsDiscontinuousSpace()->GetLiveBitmap()->VisitMarkedRange(
+            chunk.begin, chunk.end, visitor);
+      }
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  static void VisitCallback(mirror::Object* obj, void* arg) {
+    ParallelVisitTask* task = reinterpret_cast<ParallelVisitTask*>(arg);
+    task->callback_(obj, task->worker_, task->arg_);
+  }
+
+  const std::vector<ParallelVisitChunk>* const chunks_;
+  Atomic<size_t>* const next_chunk_;
+  accounting::ObjectStack* const allocation_stack_;
+  const size_t worker_;
+  Heap::ParallelObjectCallback* const callback_;
+  void* const arg_;
+};
+
+void Heap::VisitObjectsPausedParallel(ThreadPool* thread_pool, ParallelObjectCallback* callback,
+                                      void* arg) {
+  // The chunks are small enough for the workers to stay balanced, and large enough for the cost
+  // of claiming them not to matter.
+  static constexpr size_t kChunkBytes = 4 * MB;
+  static constexpr size_t kChunkAllocationStackEntries = 16 * KB;
+  Thread* self = Thread::Current();
+  Locks::mutator_lock_->AssertExclusiveHeld(self);
+  std::vector<ParallelVisitChunk> chunks;
+  if (region_space_ != nullptr) {
+    DCHECK(IsGcConcurrentAndMoving());
+    DCHECK(zygote_creation_lock_.IsExclusiveHeld(self) || IsMovingGCDisabled(self));
+    const size_t regions_per_chunk = kChunkBytes / space::RegionSpace::kRegionSize;
+    for (size_t i = 0; i < region_space_->GetNumRegions(); i += regions_per_chunk) {
+      chunks.push_back({region_space_, i, i + regions_per_chunk});
+    }
+  }
+  if (bump_pointer_space_ != nullptr) {
+    chunks.push_back({bump_pointer_space_, 0, 0});
+  }
+  for (size_t i = 0; i < allocation_stack_->Size(); i += kChunkAllocationStackEntries) {
+    chunks.push_back({nullptr, i, std::min(i + kChunkAllocationStackEntries,
+                                           allocation_stack_->Size())});
+  }
+  {
+    ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    auto add_bitmap_chunks = [&chunks](space::Space* space, uintptr_t begin, uintptr_t end) {
+      for (uintptr_t addr = begin; addr < end; addr += kChunkBytes) {
+        chunks.push_back({space, addr, std::min(addr + kChunkBytes, end)});
+      }
+    };
+    for (space::ContinuousSpace* space : continuous_spaces_) {
+      if (space->GetLiveBitmap() != nullptr) {
+        add_bitmap_chunks(space, reinterpret_cast<uintptr_t>(space->Begin()),
+                          reinterpret_cast<uintptr_t>(space->End()));
+      }
+    }
+    for (space::DiscontinuousSpace* space : discontinuous_spaces_) {
+      // The bitmap spans the whole low 4 GB, only walk the addresses that the space used.
+      space::LargeObjectSpace* los = space->AsLargeObjectSpace();
+      add_bitmap_chunks(los, reinterpret_cast<uintptr_t>(los->Begin()),
+                        reinterpret_cast<uintptr_t>(los->End()));
+    }
+  }
+
+  Atomic<size_t> next_chunk(0);
+  const size_t num_workers = (thread_pool != nullptr) ? thread_pool->GetThreadCount() + 1 : 1;
+  if (num_workers == 1) {
+    ParallelVisitTask task(&chunks, &next_chunk, allocation_stack_.get(), 0, callback, arg);
+    task.Run(self);
+    return;
+  }
+  for (size_t i = 0; i < num_workers; ++i) {
+    thread_pool->AddTask(self, new ParallelVisitTask(&chunks, &next_chunk,
+                                                     allocation_stack_.get(), i, callback, arg));
+  }
+  thread_pool->SetMaxActiveWorkers(num_workers - 1);
+  thread_pool->StartWorkers(self);
+  // The calling thread takes one of the tasks, and all of the tasks run until the chunks run out.
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+}
+
 void Heap::MarkAllocStackAsLive(accounting::ObjectStack* stack) {
   space::ContinuousSpace* space1 = main_space_ != nullptr ? main_space_ : non_moving_space_;
   space::ContinuousSpace* space2 = non_moving_space_;
@@ -1172,6 +1337,10 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   os << "Total GC time: " << PrettyDuration(GetGcTime()) << "\n";
   os << "Total blocking GC count: " << GetBlockingGcCount() << "\n";
   os << "Total blocking GC time: " << PrettyDuration(GetBlockingGcTime()) << "\n";
+  if (gc_pause_target_ != 0 || gc_cpu_share_target_ > 0.0) {
+    os << "Adaptive growth scale: " << adaptive_growth_scale_ << "\n";
+    os << "Adaptive concurrent start scale: " << adaptive_concurrent_start_scale_ << "\n";
+  }
 
   {
     MutexLock mu(Thread::Current(), *gc_complete_lock_);
@@ -1191,6 +1360,13 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   if (kDumpRosAllocStatsOnSigQuit && rosalloc_space_ != nullptr) {
     rosalloc_space_->DumpStats(os);
   }
+  if (string_dedup_table_ != nullptr) {
+    string_dedup_table_->DumpPerformanceInfo(os);
+  }
+  if (region_space_ != nullptr && region_space_->GetPrezeroedTlabRefills() != 0) {
+    os << "Pre-zeroed TLAB refills: " << region_space_->GetPrezeroedTlabRefills() << " of "
+       << region_space_->GetTlabRefills() << "\n";
+  }
 
   {
     MutexLock mu(Thread::Current(), native_histogram_lock_);
@@ -1209,6 +1385,14 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   BaseMutex::DumpAll(os);
 }
 
+void Heap::EnableStringDeduplication() {
+  if (concurrent_copying_collector_ == nullptr) {
+    LOG(WARNING) << "String deduplication requires the concurrent copying collector";
+    return;
+  }
+  string_dedup_table_.reset(new StringDedupTable());
+}
+
 void Heap::ResetGcPerformanceInfo() {
   for (auto& collector : garbage_collectors_) {
     collector->ResetMeasurements();
@@ -1273,6 +1457,7 @@ Heap::~Heap() {
   // If we don't reset then the mark stack complains in its destructor.
   allocation_stack_->Reset();
   allocation_records_.reset();
+  allocation_sampler_.reset();
   live_stack_->Reset();
   STLDeleteValues(&mod_union_tables_);
   STLDeleteValues(&remembered_sets_);
@@ -1385,6 +1570,7 @@ void Heap::Trim(Thread* self) {
         << PrettyDuration(NanoTime() - start_time);
   }
   TrimIndirectReferenceTables(self);
+  runtime->GetClassLinker()->ReclaimClassTableStorage(self);
   TrimSpaces(self);
   // Trim arenas that may have been used by JIT or verifier.
   runtime->GetArenaPool()->TrimMaps();
@@ -2264,6 +2450,16 @@ void Heap::ChangeCollector(CollectorType collector_type) {
         }
         break;
       }
+      case kCollectorTypeGenCC: {
+        gc_plan_.push_back(collector::kGcTypeSticky);
+        gc_plan_.push_back(collector::kGcTypeFull);
+        if (use_tlab_) {
+          ChangeAllocator(kAllocatorTypeRegionTLAB);
+        } else {
+          ChangeAllocator(kAllocatorTypeRegion);
+        }
+        break;
+      }
       case kCollectorTypeMC:  // Fall-through.
       case kCollectorTypeSS:  // Fall-through.
       case kCollectorTypeGSS: {
@@ -2455,7 +2651,7 @@ void Heap::PreZygoteFork() {
     // Compact the bump pointer space to a new zygote bump pointer space.
     bool reset_main_space = false;
     if (IsMovingGc(collector_type_)) {
-      if (collector_type_ == kCollectorTypeCC) {
+      if (IsConcurrentCopyingGc(collector_type_)) {
         zygote_collector.SetFromSpace(region_space_);
       } else {
         zygote_collector.SetFromSpace(bump_pointer_space_);
@@ -2482,8 +2678,11 @@ void Heap::PreZygoteFork() {
       delete old_main_space;
       AddSpace(main_space_);
     } else {
-      if (collector_type_ == kCollectorTypeCC) {
+      if (IsConcurrentCopyingGc(collector_type_)) {
         region_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
+        // The zygote compaction cleared the region space, the old objects of the generational CC
+        // are now in the zygote space.
+        concurrent_copying_collector_->ResetOldObjects();
       } else {
         bump_pointer_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
       }
@@ -2675,7 +2874,11 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
         collector = semi_space_collector_;
         break;
       case kCollectorTypeCC:
+        // Fall-through.
+      case kCollectorTypeGenCC:
         concurrent_copying_collector_->SetRegionSpace(region_space_);
+        concurrent_copying_collector_->SetYoungGen(collector_type_ == kCollectorTypeGenCC &&
+                                                   gc_type == collector::kGcTypeSticky);
         collector = concurrent_copying_collector_;
         break;
       case kCollectorTypeMC:
@@ -2693,7 +2896,10 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       }
       CHECK(temp_space_->IsEmpty());
     }
-    gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    if (collector != concurrent_copying_collector_ ||
+        collector->GetGcType() != collector::kGcTypeSticky) {
+      gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    }
   } else if (current_allocator_ == kAllocatorTypeRosAlloc ||
       current_allocator_ == kAllocatorTypeDlMalloc) {
     collector = FindCollectorByGcType(gc_type);
@@ -2721,10 +2927,13 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
   total_objects_freed_ever_ += GetCurrentGcIteration()->GetFreedObjects();
   total_bytes_freed_ever_ += GetCurrentGcIteration()->GetFreedBytes();
   RequestTrim(self);
+  RequestRegionPrezero(self);
   // Enqueue cleared references.
   reference_processor_->EnqueueClearedReferences(self);
+  UpdateAdaptiveSizing();
   // Grow the heap so that we know when to perform the next GC.
   GrowForUtilization(collector, bytes_allocated_before_gc);
+  gc_stats_->RecordGc();
   LogGC(gc_cause, collector);
   FinishGC(self, gc_type);
   // Inform DDMS that a GC completed.
@@ -3491,6 +3700,20 @@ void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
   DumpGcPerformanceInfo(os);
+  // Dump the samples taken so far, even if sampling stopped since.
+  Thread* self = Thread::Current();
+  AllocationSampler* allocation_sampler;
+  {
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    allocation_sampler = GetAllocationSampler();
+    if (allocation_sampler != nullptr && allocation_sampler->GetNumSamples() == 0) {
+      allocation_sampler = nullptr;
+    }
+  }
+  if (allocation_sampler != nullptr) {
+    ScopedObjectAccess soa(self);
+    allocation_sampler->DumpForSigQuit(os);
+  }
 }
 
 size_t Heap::GetPercentFree() {
@@ -3547,6 +3770,67 @@ double Heap::HeapGrowthMultiplier() const {
   return foreground_heap_growth_multiplier_;
 }
 
+void Heap::UpdateAdaptiveSizing() {
+  if (gc_pause_target_ == 0 && gc_cpu_share_target_ <= 0.0) {
+    return;
+  }
+  const uint64_t now = NanoTime();
+  const uint64_t duration = current_gc_iteration_.GetDurationNs();
+  uint64_t longest_pause = 0;
+  for (uint64_t pause : current_gc_iteration_.GetPauseTimes()) {
+    longest_pause = std::max(longest_pause, pause);
+  }
+  if (IsGcConcurrent() && current_gc_iteration_.GetGcCause() == kGcCauseForAlloc) {
+    // The concurrent GC did not finish before the heap was full: the allocating thread was
+    // blocked for the whole GC.
+    longest_pause = std::max(longest_pause, duration);
+  }
+  // The share of the time since the previous GC finished spent in this GC.
+  double cpu_share = 0.0;
+  if (last_gc_end_time_ns_ != 0u && now > last_gc_end_time_ns_) {
+    cpu_share = std::min(static_cast<double>(duration) / (now - last_gc_end_time_ns_), 1.0);
+  }
+  if (last_gc_end_time_ns_ == 0u) {
+    smoothed_gc_pause_ns_ = longest_pause;
+    smoothed_gc_cpu_share_ = cpu_share;
+  } else {
+    smoothed_gc_pause_ns_ += kAdaptiveSizingSmoothing * (longest_pause - smoothed_gc_pause_ns_);
+    smoothed_gc_cpu_share_ += kAdaptiveSizingSmoothing * (cpu_share - smoothed_gc_cpu_share_);
+  }
+  last_gc_end_time_ns_ = now;
+
+  if (gc_pause_target_ != 0 && smoothed_gc_pause_ns_ > gc_pause_target_) {
+    if (IsGcConcurrent()) {
+      // The pauses of concurrent GCs hardly depend on the heap size, but the allocating threads
+      // block when a concurrent GC starts too late.
+      adaptive_concurrent_start_scale_ *= kAdaptiveScaleUpFactor;
+    } else {
+      // The pauses of the other GCs grow with the heap.
+      adaptive_growth_scale_ *= kAdaptiveScaleDownFactor;
+    }
+  } else if (gc_cpu_share_target_ > 0.0 && smoothed_gc_cpu_share_ > gc_cpu_share_target_) {
+    // Collect less often.
+    adaptive_growth_scale_ *= kAdaptiveScaleUpFactor;
+  } else {
+    // The goals are met, go back to the footprint given by the target utilization.
+    auto decay = [](double scale) {
+      return scale > 1.0 ? std::max(scale * kAdaptiveScaleDecayFactor, 1.0)
+                         : std::min(scale / kAdaptiveScaleDecayFactor, 1.0);
+    };
+    adaptive_growth_scale_ = decay(adaptive_growth_scale_);
+    adaptive_concurrent_start_scale_ = decay(adaptive_concurrent_start_scale_);
+  }
+  adaptive_growth_scale_ = std::max(adaptive_growth_scale_, kMinAdaptiveGrowthScale);
+  adaptive_growth_scale_ = std::min(adaptive_growth_scale_, kMaxAdaptiveGrowthScale);
+  adaptive_concurrent_start_scale_ = std::min(adaptive_concurrent_start_scale_,
+                                              kMaxAdaptiveConcurrentStartScale);
+  VLOG(heap) << "Adaptive sizing: pause="
+             << PrettyDuration(static_cast<uint64_t>(smoothed_gc_pause_ns_))
+             << " GC CPU share=" << smoothed_gc_cpu_share_
+             << " growth scale=" << adaptive_growth_scale_
+             << " concurrent start scale=" << adaptive_concurrent_start_scale_;
+}
+
 void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
                               uint64_t bytes_allocated_before_gc) {
   // We know what our utilization is at this moment.
@@ -3554,8 +3838,9 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
   const uint64_t bytes_allocated = GetBytesAllocated();
   uint64_t target_size;
   collector::GcType gc_type = collector_ran->GetGcType();
-  const double multiplier = HeapGrowthMultiplier();  // Use the multiplier to grow more for
-  // foreground.
+  // Use the multiplier to grow more for foreground, and the adaptive scale to meet the pause and
+  // GC CPU share goals.
+  const double multiplier = HeapGrowthMultiplier() * adaptive_growth_scale_;
   const uint64_t adjusted_min_free = static_cast<uint64_t>(min_free_ * multiplier);
   const uint64_t adjusted_max_free = static_cast<uint64_t>(max_free_ * multiplier);
   if (gc_type != collector::kGcTypeSticky) {
@@ -3567,6 +3852,23 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
     target_size = std::max(target_size, bytes_allocated + adjusted_min_free);
     native_need_to_run_finalization_ = true;
     next_gc_type_ = collector::kGcTypeSticky;
+    young_cc_collections_since_full_ = 0u;
+  } else if (collector_type_ == kCollectorTypeGenCC) {
+    // The young and full cycles of the generational CC are run by the same collector, so their
+    // throughputs can't be compared. Dead objects in old regions are only reclaimed by full cycles:
+    // run one periodically, or as soon as young cycles don't keep the heap under its footprint.
+    ++young_cc_collections_since_full_;
+    if (young_cc_collections_since_full_ < kGenCCFullCollectionInterval &&
+        bytes_allocated <= max_allowed_footprint_) {
+      next_gc_type_ = collector::kGcTypeSticky;
+    } else {
+      next_gc_type_ = collector::kGcTypeFull;
+    }
+    if (bytes_allocated + adjusted_max_free < max_allowed_footprint_) {
+      target_size = bytes_allocated + adjusted_max_free;
+    } else {
+      target_size = std::max(bytes_allocated, static_cast<uint64_t>(max_allowed_footprint_));
+    }
   } else {
     collector::GcType non_sticky_gc_type =
         HasZygoteSpace() ? collector::kGcTypePartial : collector::kGcTypeFull;
@@ -3610,6 +3912,8 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
       size_t remaining_bytes = bytes_allocated_during_gc * gc_duration_seconds;
       remaining_bytes = std::min(remaining_bytes, kMaxConcurrentRemainingBytes);
       remaining_bytes = std::max(remaining_bytes, kMinConcurrentRemainingBytes);
+      // Start earlier if the concurrent GCs have been finishing too late to meet the pause goal.
+      remaining_bytes = static_cast<size_t>(remaining_bytes * adaptive_concurrent_start_scale_);
       if (UNLIKELY(remaining_bytes > max_allowed_footprint_)) {
         // A never going to happen situation that from the estimated allocation rate we will exceed
         // the applications entire footprint with the given estimated allocation rate. Schedule
@@ -3816,6 +4120,56 @@ void Heap::RequestTrim(Thread* self) {
   task_processor_->AddTask(self, added_task);
 }
 
+class Heap::GcStatsDumpTask : public HeapTask {
+ public:
+  explicit GcStatsDumpTask(uint64_t target_time) : HeapTask(target_time) {}
+
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    GcStats* gc_stats = heap->GetGcStats();
+    gc_stats->WriteJsonFile(gc_stats->GetDumpFileName());
+    heap->RequestGcStatsDump(self);
+  }
+};
+
+void Heap::RequestGcStatsDump(Thread* self) {
+  if (gc_stats_->GetDumpFileName().empty() || !CanAddHeapTask(self)) {
+    return;
+  }
+  task_processor_->AddTask(self, new GcStatsDumpTask(NanoTime() + gc_stats_->GetDumpInterval()));
+}
+
+class Heap::RegionPrezeroTask : public HeapTask {
+ public:
+  explicit RegionPrezeroTask(uint64_t target_time) : HeapTask(target_time) {}
+
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    // Zero one region per task so that the other heap tasks don't wait for the whole pool.
+    bool more = heap->region_space_->PrezeroRegion(self);
+    heap->region_prezero_pending_.StoreRelaxed(false);
+    if (more) {
+      heap->RequestRegionPrezero(self);
+    }
+  }
+};
+
+void Heap::SetRegionPrezeroPoolSize(size_t num_regions) {
+  if (region_space_ == nullptr) {
+    LOG(WARNING) << "Region pre-zeroing requires the region space";
+    return;
+  }
+  region_space_->SetPrezeroPoolSize(num_regions);
+}
+
+void Heap::RequestRegionPrezero(Thread* self) {
+  if (region_space_ == nullptr || !region_space_->NeedsPrezeroing() || !CanAddHeapTask(self) ||
+      !region_prezero_pending_.CompareExchangeStrongSequentiallyConsistent(false, true)) {
+    return;
+  }
+  task_processor_->AddTask(self, new RegionPrezeroTask(NanoTime() + kRegionPrezeroWait));
+}
+
 void Heap::RevokeThreadLocalBuffers(Thread* thread) {
   if (rosalloc_space_ != nullptr) {
     size_t freed_bytes_revoke = rosalloc_space_->RevokeThreadLocalBuffers(thread);
@@ -3842,6 +4196,16 @@ void Heap::RevokeRosAllocThreadLocalBuffers(Thread* thread) {
   }
 }
 
+void Heap::RevokeRosAllocCpuBuffers() {
+  if (rosalloc_space_ != nullptr) {
+    size_t freed_bytes_revoke = rosalloc_space_->RevokeCpuBuffers();
+    if (freed_bytes_revoke > 0U) {
+      num_bytes_freed_revoke_.FetchAndAddSequentiallyConsistent(freed_bytes_revoke);
+      CHECK_GE(num_bytes_allocated_.LoadRelaxed(), num_bytes_freed_revoke_.LoadRelaxed());
+    }
+  }
+}
+
 void Heap::RevokeAllThreadLocalBuffers() {
   if (rosalloc_space_ != nullptr) {
     size_t freed_bytes_revoke = rosalloc_space_->RevokeAllThreadLocalBuffers();
@@ -3986,6 +4350,10 @@ void Heap::SetAllocationRecords(AllocRecordObjectMap* records) {
   allocation_records_.reset(records);
 }
 
+void Heap::SetAllocationSampler(AllocationSampler* sampler) {
+  allocation_sampler_.reset(sampler);
+}
+
 void Heap::VisitAllocationRecords(RootVisitor* visitor) const {
   if (IsAllocTrackingEnabled()) {
     MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
@@ -3993,6 +4361,12 @@ void Heap::VisitAllocationRecords(RootVisitor* visitor) const {
       GetAllocationRecords()->VisitRoots(visitor);
     }
   }
+  // The samples outlive sampling, visit them whether or not sampling is enabled.
+  MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
+  AllocationSampler* allocation_sampler = GetAllocationSampler();
+  if (allocation_sampler != nullptr) {
+    allocation_sampler->VisitRoots(visitor);
+  }
 }
 
 void Heap::SweepAllocationRecords(IsMarkedVisitor* visitor) const {
@@ -57,7 +57,10 @@ namespace mirror {
 namespace gc {
 
 class AllocRecordObjectMap;
+class AllocationSampler;
+class GcStats;
 class ReferenceProcessor;
+class StringDedupTable;
 class TaskProcessor;
 
 namespace accounting {
@@ -128,6 +131,10 @@ class Heap {
   static constexpr size_t kDefaultMinFree = kDefaultMaxFree / 4;
   static constexpr size_t kDefaultLongPauseLogThreshold = MsToNs(5);
   static constexpr size_t kDefaultLongGCLogThreshold = MsToNs(100);
+  // No pause or GC CPU share goal: the heap is sized by the target utilization only.
+  static constexpr size_t kDefaultGcPauseTarget = 0;
+  static constexpr double kDefaultGcCpuShareTarget = 0.0;
+  static constexpr uint64_t kDefaultGcStatsDumpInterval = MsToNs(10000);
   static constexpr size_t kDefaultTLABSize = 256 * KB;
   static constexpr double kDefaultTargetUtilization = 0.5;
   static constexpr double kDefaultHeapGrowthMultiplier = 2.0;
@@ -150,6 +157,9 @@ class Heap {
   static constexpr uint64_t kHeapTrimWait = MsToNs(5000);
   // How long we wait after a transition request to perform a collector transition (nanoseconds).
   static constexpr uint64_t kCollectorTransitionWait = MsToNs(5000);
+  // How long we wait after a request to zero a region of the TLAB pool, letting the other heap
+  // tasks go first (nanoseconds).
+  static constexpr uint64_t kRegionPrezeroWait = MsToNs(10);
 
   // Create a heap with the requested sizes. The possible empty
   // image_file_names names specify Spaces to load based on
@@ -173,8 +183,11 @@ class Heap {
        bool low_memory_mode,
        size_t long_pause_threshold,
        size_t long_gc_threshold,
+       size_t gc_pause_target,
+       double gc_cpu_share_target,
        bool ignore_max_footprint,
        bool use_tlab,
+       bool use_rosalloc_per_cpu_runs,
        bool verify_pre_gc_heap,
        bool verify_pre_sweeping_heap,
        bool verify_post_gc_heap,
@@ -237,6 +250,17 @@ class Heap {
   void VisitObjectsPaused(ObjectCallback callback, void* arg)
       REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_, !*gc_complete_lock_);
 
+  // Called for each object of a parallel heap walk, with the index of the visiting worker.
+  typedef void (ParallelObjectCallback)(mirror::Object* obj, size_t worker, void* arg);
+
+  // Visit the same objects as VisitObjectsPaused(), with the calling thread and the threads of
+  // `thread_pool` (which may be null) as workers 0 to thread_pool->GetThreadCount(). The spaces
+  // and the allocation stack are split into chunks which the workers claim one at a time, so the
+  // callback is called concurrently and in no particular order.
+  void VisitObjectsPausedParallel(ThreadPool* thread_pool, ParallelObjectCallback* callback,
+                                  void* arg)
+      REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_, !*gc_complete_lock_);
+
   void CheckPreconditionsForAllocObject(mirror::Class* c, size_t byte_count)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -426,6 +450,18 @@ class Heap {
   // Scales heap growth, min free, and max free.
   double HeapGrowthMultiplier() const;
 
+  // Returns the scale that the adaptive sizing policy currently applies to the heap growth, 1.0
+  // when there are no pause or GC CPU share goals.
+  double GetAdaptiveGrowthScale() const {
+    return adaptive_growth_scale_;
+  }
+
+  // Returns the scale that the adaptive sizing policy currently applies to the bytes left before
+  // the heap footprint when a concurrent GC starts.
+  double GetAdaptiveConcurrentStartScale() const {
+    return adaptive_concurrent_start_scale_;
+  }
+
   // Freed bytes can be negative in cases where we copy objects from a compacted space to a
   // free-list backed space.
   void RecordFree(uint64_t freed_objects, int64_t freed_bytes);
@@ -542,6 +578,7 @@ class Heap {
 
   void RevokeThreadLocalBuffers(Thread* thread);
   void RevokeRosAllocThreadLocalBuffers(Thread* thread);
+  void RevokeRosAllocCpuBuffers();
   void RevokeAllThreadLocalBuffers();
   void AssertThreadLocalBuffersAreRevoked(Thread* thread);
   void AssertAllBumpPointerSpaceThreadLocalBuffersAreRevoked();
@@ -689,6 +726,17 @@ class Heap {
   TaskProcessor* GetTaskProcessor() {
     return task_processor_.get();
   }
+  GcStats* GetGcStats() {
+    return gc_stats_.get();
+  }
+  // Null unless string deduplication is enabled.
+  StringDedupTable* GetStringDedupTable() {
+    return string_dedup_table_.get();
+  }
+
+  // Let full concurrent copying collections merge the strings with equal contents. Off by default
+  // since it makes equal strings identical (==). Called before the first collection.
+  void EnableStringDeduplication();
 
   bool HasZygoteSpace() const {
     return zygote_space_ != nullptr;
@@ -702,6 +750,11 @@ class Heap {
     return collector_type_;
   }
 
+  // Whether the collector is concurrent copying, generational or not.
+  static bool IsConcurrentCopyingGc(CollectorType collector_type) {
+    return collector_type == kCollectorTypeCC || collector_type == kCollectorTypeGenCC;
+  }
+
   bool IsGcConcurrentAndMoving() const {
     if (IsGcConcurrent() && IsMovingGc(collector_type_)) {
       // Assume no transition when a concurrent moving collector is used.
@@ -724,6 +777,17 @@ class Heap {
   // Request asynchronous GC.
   void RequestConcurrentGC(Thread* self, bool force_full) REQUIRES(!*pending_task_lock_);
 
+  // Request an asynchronous dump of the GC statistics to their dump file, if they have one, after
+  // their dump interval. Each dump requests the next one.
+  void RequestGcStatsDump(Thread* self);
+
+  // Keep up to `num_regions` free regions of the region space zeroed and faulted in for the TLAB
+  // refills, see RegionSpace::PrezeroRegion().
+  void SetRegionPrezeroPoolSize(size_t num_regions);
+
+  // Request the asynchronous zeroing of a region if the pool of zeroed regions is short.
+  void RequestRegionPrezero(Thread* self);
+
   // Whether or not we may use a garbage collector, used so that we only create collectors we need.
   bool MayUseCollector(CollectorType type) const;
 
@@ -758,6 +822,24 @@ class Heap {
   void SetAllocationRecords(AllocRecordObjectMap* records)
       REQUIRES(Locks::alloc_tracker_lock_);
 
+  // Allocation sampling support, see AllocationSampler. Like allocation tracking, sampling
+  // uses the instrumented allocation entrypoints.
+  bool IsAllocSamplingEnabled() const {
+    return alloc_sampling_enabled_.LoadRelaxed();
+  }
+
+  void SetAllocSamplingEnabled(bool enabled) REQUIRES(Locks::alloc_tracker_lock_) {
+    alloc_sampling_enabled_.StoreRelaxed(enabled);
+  }
+
+  AllocationSampler* GetAllocationSampler() const
+      REQUIRES(Locks::alloc_tracker_lock_) {
+    return allocation_sampler_.get();
+  }
+
+  void SetAllocationSampler(AllocationSampler* sampler)
+      REQUIRES(Locks::alloc_tracker_lock_);
+
   void VisitAllocationRecords(RootVisitor* visitor) const
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::alloc_tracker_lock_);
@@ -788,6 +870,8 @@ class Heap {
   class ConcurrentGCTask;
   class CollectorTransitionTask;
   class HeapTrimTask;
+  class GcStatsDumpTask;
+  class RegionPrezeroTask;
 
   // Compact source space to target space. Returns the collector used.
   collector::GarbageCollector* Compact(space::ContinuousMemMapAllocSpace* target_space,
@@ -826,6 +910,7 @@ class Heap {
         collector_type == kCollectorTypeSS ||
         collector_type == kCollectorTypeGSS ||
         collector_type == kCollectorTypeCC ||
+        collector_type == kCollectorTypeGenCC ||
         collector_type == kCollectorTypeMC ||
         collector_type == kCollectorTypeHomogeneousSpaceCompact;
   }
@@ -960,6 +1045,10 @@ class Heap {
   void GrowForUtilization(collector::GarbageCollector* collector_ran,
                           uint64_t bytes_allocated_before_gc = 0);
 
+  // Update the adaptive growth and concurrent start scales from the pauses and the duration of
+  // the GC that just finished, if there is a pause or GC CPU share goal.
+  void UpdateAdaptiveSizing();
+
   size_t GetPercentFree();
 
   static void VerificationCallback(mirror::Object* obj, void* arg)
@@ -995,7 +1084,7 @@ class Heap {
   // What kind of concurrency behavior is the runtime after? Currently true for concurrent mark
   // sweep GC, false for other GC types.
   bool IsGcConcurrent() const ALWAYS_INLINE {
-    return collector_type_ == kCollectorTypeCMS || collector_type_ == kCollectorTypeCC;
+    return collector_type_ == kCollectorTypeCMS || IsConcurrentCopyingGc(collector_type_);
   }
 
   // Trim the managed and native spaces by releasing unused memory back to the OS.
@@ -1084,6 +1173,13 @@ class Heap {
   // If we get a GC longer than long GC log threshold, then we print out the GC after it finishes.
   const size_t long_gc_log_threshold_;
 
+  // Longest pause that the adaptive sizing policy aims for, 0 if there is no pause goal.
+  const size_t gc_pause_target_;
+
+  // Share of the wall time that the adaptive sizing policy lets the GC use, 0 if there is no GC
+  // CPU share goal.
+  const double gc_cpu_share_target_;
+
   // If we ignore the max footprint it lets the heap grow until it hits the heap capacity, this is
   // useful for benchmarking since it reduces time spent in GC to a low %.
   const bool ignore_max_footprint_;
@@ -1123,6 +1219,8 @@ class Heap {
   // Last Gc type we ran. Used by WaitForConcurrentGc to know which Gc was waited on.
   volatile collector::GcType last_gc_type_ GUARDED_BY(gc_complete_lock_);
   collector::GcType next_gc_type_;
+  // Number of young collections since the last full collection of the generational CC.
+  size_t young_cc_collections_since_full_;
 
   // Maximum size that the heap can reach.
   size_t capacity_;
@@ -1259,6 +1357,18 @@ class Heap {
   // How much more we grow the heap when we are a foreground app instead of background.
   double foreground_heap_growth_multiplier_;
 
+  // Adapted after each GC to meet the pause and GC CPU share goals. The growth scale multiplies
+  // the heap growth, and the concurrent start scale the bytes left when a concurrent GC starts.
+  double adaptive_growth_scale_;
+  double adaptive_concurrent_start_scale_;
+
+  // Moving averages of the longest pause and of the GC CPU share of the recent GCs.
+  double smoothed_gc_pause_ns_;
+  double smoothed_gc_cpu_share_;
+
+  // When the previous GC finished, 0 before the first GC.
+  uint64_t last_gc_end_time_ns_;
+
   // Total time which mutators are paused or waiting for GC to complete.
   uint64_t total_wait_time_;
 
@@ -1276,6 +1386,10 @@ class Heap {
   const bool is_running_on_memory_tool_;
   const bool use_tlab_;
 
+  // If true, the RosAlloc spaces allocate small objects from per-CPU runs rather than from
+  // thread-local runs.
+  const bool use_rosalloc_per_cpu_runs_;
+
   // Pointer to the space which becomes the new main space when we do homogeneous space compaction.
   // Use unique_ptr since the space is only added during the homogeneous compaction phase.
   std::unique_ptr<space::MallocSpace> main_space_backup_;
@@ -1301,6 +1415,9 @@ class Heap {
   // Whether or not a concurrent GC is pending.
   Atomic<bool> concurrent_gc_pending_;
 
+  // Whether or not a RegionPrezeroTask is pending.
+  Atomic<bool> region_prezero_pending_;
+
   // Active tasks which we can modify (change target time, desired collector type, etc..).
   CollectorTransitionTask* pending_collector_transition_ GUARDED_BY(pending_task_lock_);
   HeapTrimTask* pending_heap_trim_ GUARDED_BY(pending_task_lock_);
@@ -1334,6 +1451,17 @@ class Heap {
   Atomic<bool> alloc_tracking_enabled_;
   std::unique_ptr<AllocRecordObjectMap> allocation_records_;
 
+  // Allocation sampling support. The sampler is kept after sampling stops so that its samples
+  // can still be written.
+  Atomic<bool> alloc_sampling_enabled_;
+  std::unique_ptr<AllocationSampler> allocation_sampler_;
+
+  // The GC statistics exported to monitoring.
+  std::unique_ptr<GcStats> gc_stats_;
+
+  // The strings copied by the current concurrent copying collection, if deduplication is enabled.
+  std::unique_ptr<StringDedupTable> string_dedup_table_;
+
   // GC stress related data structures.
   Mutex* backtrace_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   // Debugging variables, seen backtraces vs unique backtraces.
@@ -1355,6 +1483,7 @@ class Heap {
   friend class collector::ConcurrentCopying;
   friend class collector::MarkSweep;
   friend class collector::SemiSpace;
+  friend class GcStats;
   friend class ReferenceQueue;
   friend class ScopedGCCriticalSection;
   friend class VerifyReferenceCardVisitor;
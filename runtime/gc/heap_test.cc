@@ -14,10 +14,13 @@
  * limitations under the License.
  */
 
+#include <sys/mman.h>
+
 #include "class_linker-inl.h"
 #include "common_runtime_test.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/space/region_space.h"
 #include "handle_scope-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -72,6 +75,37 @@ TEST_F(HeapTest, HeapBitmapCapacityTest) {
   bitmap->Set(fake_end_of_heap_object);
 }
 
+TEST_F(HeapTest, RegionPrezeroPool) {
+  Thread* self = Thread::Current();
+  // Stay runnable so that no GC revokes the TLAB of the test space.
+  ScopedObjectAccess soa(self);
+  Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(self);
+  std::unique_ptr<space::RegionSpace> space(
+      space::RegionSpace::Create("test region space", 8 * space::RegionSpace::kRegionSize,
+                                 nullptr));
+  ASSERT_TRUE(space != nullptr);
+  EXPECT_FALSE(space->NeedsPrezeroing());
+  EXPECT_FALSE(space->PrezeroRegion(self));
+  space->SetPrezeroPoolSize(2);
+  EXPECT_TRUE(space->PrezeroRegion(self));
+  EXPECT_FALSE(space->PrezeroRegion(self));
+  EXPECT_FALSE(space->NeedsPrezeroing());
+
+  ASSERT_TRUE(space->AllocNewTlab(self));
+  EXPECT_TRUE(space->NeedsPrezeroing());
+  // The pages of the new TLAB are already faulted in.
+  std::vector<unsigned char> residency(space::RegionSpace::kRegionSize / kPageSize);
+  ASSERT_EQ(0, mincore(self->GetTlabStart(), space::RegionSpace::kRegionSize, &residency[0]));
+  for (unsigned char resident : residency) {
+    EXPECT_NE(0, resident & 1);
+  }
+  ASSERT_TRUE(space->AllocNewTlab(self));
+  ASSERT_TRUE(space->AllocNewTlab(self));
+  EXPECT_EQ(3u, space->GetTlabRefills());
+  EXPECT_EQ(2u, space->GetPrezeroedTlabRefills());
+  space->RevokeThreadLocalBuffers(self);
+}
+
 class ZygoteHeapTest : public CommonRuntimeTest {
   void SetUpRuntimeOptions(RuntimeOptions* options) {
     CommonRuntimeTest::SetUpRuntimeOptions(options);
@@ -84,5 +118,23 @@ TEST_F(ZygoteHeapTest, PreZygoteFork) {
   Runtime::Current()->GetHeap()->PreZygoteFork();
 }
 
+class AdaptiveSizingHeapTest : public CommonRuntimeTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    // Any GC takes more than this share of the time between back to back GCs.
+    options->push_back(std::make_pair("-XX:GcCpuShareTarget=0.001", nullptr));
+  }
+};
+
+TEST_F(AdaptiveSizingHeapTest, GrowsWhenGcTakesTooMuchTime) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  for (size_t i = 0; i < 8; ++i) {
+    heap->CollectGarbage(false);
+  }
+  EXPECT_GT(heap->GetAdaptiveGrowthScale(), 1.0);
+  // The adapted footprint stays within the growth limit.
+  EXPECT_LE(heap->GetBytesAllocated() + heap->GetFreeMemoryUntilGC(), heap->GetMaxMemory());
+}
+
 }  // namespace gc
 }  // namespace art
@@ -18,6 +18,7 @@
 
 #include "base/time_utils.h"
 #include "collector/garbage_collector.h"
+#include "heap.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/reference-inl.h"
@@ -34,14 +35,18 @@ namespace gc {
 
 static constexpr bool kAsyncReferenceQueueAdd = false;
 
+// Queues with fewer references are cleared by the GC-running thread alone, since waking up the GC
+// workers would cost more than it saves.
+static constexpr size_t kMinParallelClearedReferences = 4 * KB;
+
 ReferenceProcessor::ReferenceProcessor()
     : collector_(nullptr),
       preserving_references_(false),
       condition_("reference processor condition", *Locks::reference_processor_lock_) ,
-      soft_reference_queue_(Locks::reference_queue_soft_references_lock_),
-      weak_reference_queue_(Locks::reference_queue_weak_references_lock_),
+      soft_reference_queue_("ReferenceQueue soft references lock"),
+      weak_reference_queue_("ReferenceQueue weak references lock"),
       finalizer_reference_queue_(Locks::reference_queue_finalizer_references_lock_),
-      phantom_reference_queue_(Locks::reference_queue_phantom_references_lock_),
+      phantom_reference_queue_("ReferenceQueue phantom references lock"),
       cleared_references_(Locks::reference_queue_cleared_references_lock_) {
 }
 
@@ -115,6 +120,78 @@ void ReferenceProcessor::StopPreservingReferences(Thread* self) {
   condition_.Broadcast(self);
 }
 
+size_t ReferenceProcessor::GetThreadCount(bool concurrent) const {
+  // Like the collectors, only use the GC workers in a jank perceptible process state. Transactions
+  // record the cleared referents and are not thread safe.
+  Runtime* runtime = Runtime::Current();
+  Heap* heap = runtime->GetHeap();
+  if (heap->GetThreadPool() == nullptr ||
+      !runtime->InJankPerceptibleProcessState() ||
+      runtime->IsActiveTransaction()) {
+    return 1;
+  }
+  return (concurrent ? heap->GetConcGCThreadCount() : heap->GetParallelGCThreadCount()) + 1;
+}
+
+class ClearWhiteReferencesTask : public Task {
+ public:
+  ClearWhiteReferencesTask(ShardedReferenceQueue* queue,
+                           ReferenceQueue* cleared_references,
+                           collector::GarbageCollector* collector,
+                           Atomic<size_t>* next_shard)
+      : queue_(queue),
+        cleared_references_(cleared_references),
+        collector_(collector),
+        next_shard_(next_shard) {}
+
+  virtual void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    // The GC-running thread holds the mutator lock on behalf of the workers. Clear into a local
+    // list to take the lock of the cleared references once per worker.
+    ReferenceQueue cleared(nullptr);
+    while (true) {
+      size_t index = next_shard_->FetchAndAddSequentiallyConsistent(1u);
+      if (index >= ShardedReferenceQueue::kNumShards) {
+        break;
+      }
+      queue_->GetShard(index)->ClearWhiteReferences(&cleared, collector_);
+    }
+    cleared_references_->AtomicEnqueueList(self, &cleared);
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ShardedReferenceQueue* const queue_;
+  ReferenceQueue* const cleared_references_;
+  collector::GarbageCollector* const collector_;
+  Atomic<size_t>* const next_shard_;
+};
+
+void ReferenceProcessor::ClearWhiteReferences(ShardedReferenceQueue* queue,
+                                              collector::GarbageCollector* collector,
+                                              size_t thread_count) {
+  if (thread_count == 1 || queue->GetNumEnqueued() < kMinParallelClearedReferences) {
+    queue->ClearWhiteReferences(&cleared_references_, collector);
+    return;
+  }
+  Thread* self = Thread::Current();
+  Atomic<size_t> next_shard(0u);
+  ThreadPool* thread_pool = Runtime::Current()->GetHeap()->GetThreadPool();
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  for (size_t i = 0; i < thread_count; ++i) {
+    thread_pool->AddTask(self,
+                         new ClearWhiteReferencesTask(queue, &cleared_references_, collector,
+                                                      &next_shard));
+  }
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+  DCHECK(queue->IsEmpty());
+  queue->ResetNumEnqueued();
+}
+
 // Process reference class instances and schedule finalizations.
 void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timings,
                                            bool clear_soft_references,
@@ -146,9 +223,12 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
       StopPreservingReferences(self);
     }
   }
+  // The soft, weak and phantom reference queues are sharded and their shards cleared in parallel.
+  // The finalizer references are few and need marking, which is single threaded.
+  const size_t thread_count = GetThreadCount(concurrent);
   // Clear all remaining soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences(&soft_reference_queue_, collector, thread_count);
+  ClearWhiteReferences(&weak_reference_queue_, collector, thread_count);
   {
     TimingLogger::ScopedTiming t2(concurrent ? "EnqueueFinalizerReferences" :
         "(Paused)EnqueueFinalizerReferences", timings);
@@ -163,10 +243,19 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
     }
   }
   // Clear all finalizer referent reachable soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences(&soft_reference_queue_, collector, thread_count);
+  ClearWhiteReferences(&weak_reference_queue_, collector, thread_count);
+  if (!kUseReadBarrier && concurrent) {
+    // All the soft and weak references that get cleared are cleared, so Reference.get() no longer
+    // needs to block: disable the slow path and broadcast to the waiters. The referents of
+    // phantom references are never returned, so clearing them below can run with unblocked
+    // mutators. With the read barrier, weak ref access is re-enabled by the collector after it
+    // also swept the system weaks.
+    MutexLock mu(self, *Locks::reference_processor_lock_);
+    DisableSlowPath(self);
+  }
   // Clear all phantom references with white referents.
-  phantom_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences(&phantom_reference_queue_, collector, thread_count);
   // At this point all reference queues other than the cleared references should be empty.
   DCHECK(soft_reference_queue_.IsEmpty());
   DCHECK(weak_reference_queue_.IsEmpty());
@@ -179,10 +268,6 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
     // starts since there is a small window of time where slow_path_enabled_ is enabled but the
     // callback isn't yet set.
     collector_ = nullptr;
-    if (!kUseReadBarrier && concurrent) {
-      // Done processing, disable the slow path and broadcast to the waiters.
-      DisableSlowPath(self);
-    }
   }
 }
 
@@ -81,6 +81,14 @@ class ReferenceProcessor {
   // referents.
   void StartPreservingReferences(Thread* self) REQUIRES(!Locks::reference_processor_lock_);
   void StopPreservingReferences(Thread* self) REQUIRES(!Locks::reference_processor_lock_);
+  // Clear the references of `queue` with white referents, with up to `thread_count` threads
+  // working on different shards of the queue.
+  void ClearWhiteReferences(ShardedReferenceQueue* queue,
+                            collector::GarbageCollector* collector,
+                            size_t thread_count)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  // The number of threads, including the GC-running thread, clearing references.
+  size_t GetThreadCount(bool concurrent) const;
   // Collector which is clearing references, used by the GetReferent to return referents which are
   // already marked.
   collector::GarbageCollector* collector_ GUARDED_BY(Locks::reference_processor_lock_);
@@ -90,11 +98,12 @@ class ReferenceProcessor {
   // Condition that people wait on if they attempt to get the referent of a reference while
   // processing is in progress.
   ConditionVariable condition_ GUARDED_BY(Locks::reference_processor_lock_);
-  // Reference queues used by the GC.
-  ReferenceQueue soft_reference_queue_;
-  ReferenceQueue weak_reference_queue_;
+  // Reference queues used by the GC. The finalizer references are not sharded since
+  // MakeCircularListIfUnenqueued() synchronizes with the GC through the finalizer queue lock.
+  ShardedReferenceQueue soft_reference_queue_;
+  ShardedReferenceQueue weak_reference_queue_;
   ReferenceQueue finalizer_reference_queue_;
-  ReferenceQueue phantom_reference_queue_;
+  ShardedReferenceQueue phantom_reference_queue_;
   ReferenceQueue cleared_references_;
 
   DISALLOW_COPY_AND_ASSIGN(ReferenceProcessor);
@@ -52,6 +52,25 @@ void ReferenceQueue::EnqueueReference(mirror::Reference* ref) {
   list_->SetPendingNext(ref);
 }
 
+void ReferenceQueue::AtomicEnqueueList(Thread* self, ReferenceQueue* list) {
+  MutexLock mu(self, *lock_);
+  EnqueueList(list);
+}
+
+void ReferenceQueue::EnqueueList(ReferenceQueue* list) {
+  if (list->IsEmpty()) {
+    return;
+  }
+  if (!IsEmpty()) {
+    // Splice the two cycles by swapping the successors of their list_ elements.
+    mirror::Reference* head = list_->GetPendingNext();
+    list_->SetPendingNext(list->list_->GetPendingNext());
+    list->list_->SetPendingNext(head);
+  }
+  list_ = list->list_;
+  list->Clear();
+}
+
 mirror::Reference* ReferenceQueue::DequeuePendingReference() {
   DCHECK(!IsEmpty());
   mirror::Reference* ref = list_->GetPendingNext();
@@ -66,7 +85,8 @@ mirror::Reference* ReferenceQueue::DequeuePendingReference() {
   }
   ref->SetPendingNext(nullptr);
   Heap* heap = Runtime::Current()->GetHeap();
-  if (kUseBakerOrBrooksReadBarrier && heap->CurrentCollectorType() == kCollectorTypeCC &&
+  if (kUseBakerOrBrooksReadBarrier &&
+      Heap::IsConcurrentCopyingGc(heap->CurrentCollectorType()) &&
       heap->ConcurrentCopyingCollector()->IsActive()) {
     // Change the gray ptr we left in ConcurrentCopying::ProcessMarkStackRef() to black or white.
     // We check IsActive() above because we don't want to do this when the zygote compaction
@@ -194,5 +214,56 @@ void ReferenceQueue::UpdateRoots(IsMarkedVisitor* visitor) {
   }
 }
 
+ShardedReferenceQueue::ShardedReferenceQueue(const char* lock_name)
+    : num_enqueued_(0u) {
+  for (size_t i = 0; i < kNumShards; ++i) {
+    locks_[i].reset(new Mutex(lock_name, kReferenceQueueShardLock));
+    shards_[i].reset(new ReferenceQueue(locks_[i].get()));
+  }
+}
+
+void ShardedReferenceQueue::AtomicEnqueueIfNotEnqueued(Thread* self, mirror::Reference* ref) {
+  DCHECK(ref != nullptr);
+  // The collectors enqueue a reference at its address after the GC, so a reference always maps to
+  // the same shard and the unprocessed check below is done under the right lock.
+  size_t index = (reinterpret_cast<uintptr_t>(ref) / kObjectAlignment) % kNumShards;
+  MutexLock mu(self, *locks_[index]);
+  if (ref->IsUnprocessed()) {
+    shards_[index]->EnqueueReference(ref);
+    num_enqueued_.FetchAndAddRelaxed(1u);
+  }
+}
+
+void ShardedReferenceQueue::ForwardSoftReferences(MarkObjectVisitor* visitor) {
+  for (size_t i = 0; i < kNumShards; ++i) {
+    shards_[i]->ForwardSoftReferences(visitor);
+  }
+}
+
+void ShardedReferenceQueue::ClearWhiteReferences(ReferenceQueue* cleared_references,
+                                                 collector::GarbageCollector* collector) {
+  for (size_t i = 0; i < kNumShards; ++i) {
+    shards_[i]->ClearWhiteReferences(cleared_references, collector);
+  }
+  ResetNumEnqueued();
+}
+
+bool ShardedReferenceQueue::IsEmpty() const {
+  for (size_t i = 0; i < kNumShards; ++i) {
+    if (!shards_[i]->IsEmpty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ShardedReferenceQueue::GetLength() const {
+  size_t length = 0;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    length += shards_[i]->GetLength();
+  }
+  return length;
+}
+
 }  // namespace gc
 }  // namespace art
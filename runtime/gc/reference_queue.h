@@ -18,6 +18,7 @@
 #define ART_RUNTIME_GC_REFERENCE_QUEUE_H_
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -61,6 +62,14 @@ class ReferenceQueue {
   // Not thread safe, used when mutators are paused to minimize lock overhead.
   void EnqueueReference(mirror::Reference* ref) SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Move all the references of `list` to this queue, leaving `list` empty. Thread safe to call
+  // from multiple threads.
+  void AtomicEnqueueList(Thread* self, ReferenceQueue* list)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!*lock_);
+
+  // Move all the references of `list` to this queue, leaving `list` empty. Not thread safe.
+  void EnqueueList(ReferenceQueue* list) SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Dequeue a reference from the queue and return that dequeued reference.
   mirror::Reference* DequeuePendingReference() SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -110,6 +119,55 @@ class ReferenceQueue {
   DISALLOW_IMPLICIT_CONSTRUCTORS(ReferenceQueue);
 };
 
+// A reference queue split in shards, each with its own lock and list, to which references are
+// distributed by address. GC threads enqueuing references contend less than on a single queue,
+// and the shards can be processed by several GC threads at a time.
+class ShardedReferenceQueue {
+ public:
+  static constexpr size_t kNumShards = 16;
+
+  explicit ShardedReferenceQueue(const char* lock_name);
+
+  // Enqueue a reference in its shard if it is unprocessed. Thread safe.
+  void AtomicEnqueueIfNotEnqueued(Thread* self, mirror::Reference* ref)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  ReferenceQueue* GetShard(size_t index) {
+    DCHECK_LT(index, kNumShards);
+    return shards_[index].get();
+  }
+
+  // The number of references enqueued since the queue was last empty. Not thread safe.
+  size_t GetNumEnqueued() const {
+    return num_enqueued_.LoadRelaxed();
+  }
+
+  // Like ReferenceQueue::ForwardSoftReferences(), for all the shards.
+  void ForwardSoftReferences(MarkObjectVisitor* visitor)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Like ReferenceQueue::ClearWhiteReferences(), for all the shards. Only called with a single
+  // thread, see ReferenceProcessor::ClearWhiteReferences() for the parallel version.
+  void ClearWhiteReferences(ReferenceQueue* cleared_references,
+                            collector::GarbageCollector* collector)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Reset the enqueued count once the shards were emptied.
+  void ResetNumEnqueued() {
+    num_enqueued_.StoreRelaxed(0u);
+  }
+
+  bool IsEmpty() const;
+  size_t GetLength() const SHARED_REQUIRES(Locks::mutator_lock_);
+
+ private:
+  std::unique_ptr<Mutex> locks_[kNumShards];
+  std::unique_ptr<ReferenceQueue> shards_[kNumShards];
+  Atomic<size_t> num_enqueued_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedReferenceQueue);
+};
+
 }  // namespace gc
 }  // namespace art
 
@@ -84,5 +84,43 @@ TEST_F(ReferenceQueueTest, Dump) {
   queue.Dump(LOG(INFO));
 }
 
+TEST_F(ReferenceQueueTest, ShardedEnqueueAndEnqueueList) {
+  static constexpr size_t kNumRefs = 64;
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<kNumRefs + 1> hs(self);
+  ShardedReferenceQueue sharded_queue("Sharded reference queue lock");
+  ASSERT_TRUE(sharded_queue.IsEmpty());
+  auto ref_class = hs.NewHandle(
+      Runtime::Current()->GetClassLinker()->FindClass(self, "Ljava/lang/ref/WeakReference;",
+                                                      ScopedNullHandle<mirror::ClassLoader>()));
+  ASSERT_TRUE(ref_class.Get() != nullptr);
+  std::set<mirror::Reference*> refs;
+  for (size_t i = 0; i < kNumRefs; ++i) {
+    Handle<mirror::Reference> ref(hs.NewHandle(ref_class->AllocObject(self)->AsReference()));
+    ASSERT_TRUE(ref.Get() != nullptr);
+    refs.insert(ref.Get());
+    sharded_queue.AtomicEnqueueIfNotEnqueued(self, ref.Get());
+    // Enqueuing again is a no-op.
+    sharded_queue.AtomicEnqueueIfNotEnqueued(self, ref.Get());
+  }
+  ASSERT_EQ(sharded_queue.GetLength(), kNumRefs);
+  ASSERT_EQ(sharded_queue.GetNumEnqueued(), kNumRefs);
+
+  // Gather the shards into a single queue.
+  Mutex lock("Reference queue lock");
+  ReferenceQueue queue(&lock);
+  for (size_t i = 0; i < ShardedReferenceQueue::kNumShards; ++i) {
+    queue.AtomicEnqueueList(self, sharded_queue.GetShard(i));
+  }
+  ASSERT_TRUE(sharded_queue.IsEmpty());
+  ASSERT_EQ(queue.GetLength(), kNumRefs);
+  std::set<mirror::Reference*> dequeued;
+  while (!queue.IsEmpty()) {
+    dequeued.insert(queue.DequeuePendingReference());
+  }
+  ASSERT_EQ(refs, dequeued);
+}
+
 }  // namespace gc
 }  // namespace art
@@ -1053,17 +1053,17 @@ static bool RelocateInPlace(ImageHeader& image_header,
     for (int32_t i = 0, count = dex_caches->GetLength(); i < count; ++i) {
       mirror::DexCache* dex_cache = dex_caches->Get<kVerifyNone, kWithoutReadBarrier>(i);
       // Fix up dex cache pointers.
-      GcRoot<mirror::String>* strings = dex_cache->GetStrings();
+      mirror::StringDexCacheType* strings = dex_cache->GetStrings();
       if (strings != nullptr) {
-        GcRoot<mirror::String>* new_strings = fixup_adapter.ForwardObject(strings);
+        mirror::StringDexCacheType* new_strings = fixup_adapter.ForwardObject(strings);
         if (strings != new_strings) {
           dex_cache->SetStrings(new_strings);
         }
         dex_cache->FixupStrings<kWithoutReadBarrier>(new_strings, fixup_adapter);
       }
-      GcRoot<mirror::Class>* types = dex_cache->GetResolvedTypes();
+      mirror::TypeDexCacheType* types = dex_cache->GetResolvedTypes();
       if (types != nullptr) {
-        GcRoot<mirror::Class>* new_types = fixup_adapter.ForwardObject(types);
+        mirror::TypeDexCacheType* new_types = fixup_adapter.ForwardObject(types);
         if (types != new_types) {
           dex_cache->SetResolvedTypes(new_types);
         }
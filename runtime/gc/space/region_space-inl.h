@@ -77,7 +77,7 @@ inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes, size_t* by
       }
       for (size_t i = 0; i < num_regions_; ++i) {
         Region* r = &regions_[i];
-        if (r->IsFree()) {
+        if (r->IsAvailable()) {
           r->Unfree(time_);
           r->SetNewlyAllocated();
           ++num_non_free_regions_;
@@ -90,7 +90,7 @@ inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes, size_t* by
     } else {
       for (size_t i = 0; i < num_regions_; ++i) {
         Region* r = &regions_[i];
-        if (r->IsFree()) {
+        if (r->IsAvailable()) {
           r->Unfree(time_);
           ++num_non_free_regions_;
           obj = r->Alloc(num_bytes, bytes_allocated, usable_size, bytes_tl_bulk_allocated);
@@ -222,13 +222,24 @@ uint64_t RegionSpace::GetObjectsAllocatedInternal() {
   return bytes;
 }
 
-template<bool kToSpaceOnly>
-void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg) {
+inline void RegionSpace::Walk(ObjectCallback* callback, void* arg) {
   // TODO: MutexLock on region_lock_ won't work due to lock order
   // issues (the classloader classes lock and the monitor lock). We
   // call this with threads suspended.
   Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
-  for (size_t i = 0; i < num_regions_; ++i) {
+  WalkInternal<false>(callback, arg, 0, num_regions_);
+}
+
+inline void RegionSpace::WalkToSpace(ObjectCallback* callback, void* arg) {
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  WalkInternal<true>(callback, arg, 0, num_regions_);
+}
+
+template<bool kToSpaceOnly>
+void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg, size_t begin_region,
+                               size_t end_region) {
+  DCHECK_LE(end_region, num_regions_);
+  for (size_t i = begin_region; i < end_region; ++i) {
     Region* r = &regions_[i];
     if (r->IsFree() || (kToSpaceOnly && !r->IsInToSpace())) {
       continue;
@@ -286,7 +297,7 @@ mirror::Object* RegionSpace::AllocLarge(size_t num_bytes, size_t* bytes_allocate
     DCHECK_LT(right, left + num_regs)
         << "The inner loop Should iterate at least once";
     while (right < left + num_regs) {
-      if (regions_[right].IsFree()) {
+      if (regions_[right].IsAvailable()) {
         ++right;
       } else {
         found = false;
@@ -297,13 +308,16 @@ mirror::Object* RegionSpace::AllocLarge(size_t num_bytes, size_t* bytes_allocate
       // right points to the one region past the last free region.
       DCHECK_EQ(left + num_regs, right);
       Region* first_reg = &regions_[left];
-      DCHECK(first_reg->IsFree());
+      DCHECK(first_reg->IsAvailable());
       first_reg->UnfreeLarge(time_);
+      if (!kForEvac) {
+        first_reg->SetNewlyAllocated();
+      }
       ++num_non_free_regions_;
       first_reg->SetTop(first_reg->Begin() + num_bytes);
       for (size_t p = left + 1; p < right; ++p) {
         DCHECK_LT(p, num_regions_);
-        DCHECK(regions_[p].IsFree());
+        DCHECK(regions_[p].IsAvailable());
         regions_[p].UnfreeLargeTail(time_);
         ++num_non_free_regions_;
       }
@@ -47,7 +47,8 @@ RegionSpace* RegionSpace::Create(const std::string& name, size_t capacity,
 RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
     : ContinuousMemMapAllocSpace(name, mem_map, mem_map->Begin(), mem_map->End(), mem_map->End(),
                                  kGcRetentionPolicyAlwaysCollect),
-      region_lock_("Region lock", kRegionSpaceRegionLock), time_(1U) {
+      region_lock_("Region lock", kRegionSpaceRegionLock), time_(1U), prezero_pool_size_(0U),
+      num_prezeroed_regions_(0U), tlab_refills_(0U), prezeroed_tlab_refills_(0U) {
   size_t mem_map_size = mem_map->Size();
   CHECK_ALIGNED(mem_map_size, kRegionSize);
   CHECK_ALIGNED(mem_map->Begin(), kRegionSize);
@@ -121,7 +122,7 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
   // previous GC or the live ratio is below threshold, evacuate
   // it.
   bool result;
-  if (is_newly_allocated_) {
+  if (is_newly_allocated_ && IsAllocated()) {
     result = true;
   } else {
     bool is_live_percent_valid = live_bytes_ != static_cast<size_t>(-1);
@@ -145,7 +146,16 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
 
 // Determine which regions to evacuate and mark them as
 // from-space. Mark the rest as unevacuated from-space.
-void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all) {
+//
+// In a young collection, only the regions allocated since the
+// previous GC are collected: the newly allocated regions are
+// evacuated, except large regions which are unevacuated, and the
+// regions of large objects found dead by the previous GC are
+// reclaimed. The other regions hold old objects and stay in the
+// to-space.
+void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table,
+                               bool force_evacuate_all,
+                               bool young_gen) {
   ++time_;
   if (kUseTableLookupReadBarrier) {
     DCHECK(rb_table->IsAllCleared());
@@ -154,6 +164,7 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
   MutexLock mu(Thread::Current(), region_lock_);
   size_t num_expected_large_tails = 0;
   bool prev_large_evacuated = false;
+  bool prev_large_collected = false;
   for (size_t i = 0; i < num_regions_; ++i) {
     Region* r = &regions_[i];
     RegionState state = r->State();
@@ -164,17 +175,28 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         DCHECK((state == RegionState::kRegionStateAllocated ||
                 state == RegionState::kRegionStateLarge) &&
                type == RegionType::kRegionTypeToSpace);
-        bool should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+        bool should_evacuate;
+        bool should_collect;
+        if (young_gen) {
+          should_evacuate = r->IsNewlyAllocated()
+              ? r->IsAllocated()
+              : r->IsLarge() && r->ShouldBeEvacuated();
+          should_collect = should_evacuate || r->IsNewlyAllocated();
+        } else {
+          should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+          should_collect = true;
+        }
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
-        } else {
+        } else if (should_collect) {
           r->SetAsUnevacFromSpace();
           DCHECK(r->IsInUnevacFromSpace());
         }
         if (UNLIKELY(state == RegionState::kRegionStateLarge &&
                      type == RegionType::kRegionTypeToSpace)) {
           prev_large_evacuated = should_evacuate;
+          prev_large_collected = should_collect;
           num_expected_large_tails = RoundUp(r->BytesAllocated(), kRegionSize) / kRegionSize - 1;
           DCHECK_GT(num_expected_large_tails, 0U);
         }
@@ -184,7 +206,7 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         if (prev_large_evacuated) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
-        } else {
+        } else if (prev_large_collected) {
           r->SetAsUnevacFromSpace();
           DCHECK(r->IsInUnevacFromSpace());
         }
@@ -214,6 +236,7 @@ void RegionSpace::ClearFromSpace() {
     }
   }
   evac_region_ = nullptr;
+  partial_evac_regions_.clear();
 }
 
 void RegionSpace::AssertAllRegionLiveBytesZeroOrCleared() {
@@ -276,8 +299,10 @@ void RegionSpace::Clear() {
     }
     r->Clear();
   }
+  num_prezeroed_regions_ = 0U;
   current_region_ = &full_region_;
   evac_region_ = &full_region_;
+  partial_evac_regions_.clear();
 }
 
 void RegionSpace::Dump(std::ostream& os) const {
@@ -339,15 +364,107 @@ bool RegionSpace::AllocNewTlab(Thread* self) {
   if ((num_non_free_regions_ + 1) * 2 > num_regions_) {
     return false;
   }
+  Region* r = nullptr;
+  if (prezero_pool_size_ != 0U) {
+    // Take a zeroed region if there is one, and count the ones left.
+    size_t num_prezeroed = 0U;
+    for (size_t i = 0; i < num_regions_; ++i) {
+      Region* reg = &regions_[i];
+      if (reg->IsAvailable() && reg->IsPrezeroed()) {
+        if (r == nullptr) {
+          r = reg;
+        } else {
+          ++num_prezeroed;
+        }
+      }
+    }
+    num_prezeroed_regions_ = num_prezeroed;
+    if (r != nullptr) {
+      prezeroed_tlab_refills_.FetchAndAddRelaxed(1);
+    }
+  }
+  for (size_t i = 0; r == nullptr && i < num_regions_; ++i) {
+    if (regions_[i].IsAvailable()) {
+      r = &regions_[i];
+    }
+  }
+  if (r == nullptr) {
+    return false;
+  }
+  tlab_refills_.FetchAndAddRelaxed(1);
+  r->Unfree(time_);
+  ++num_non_free_regions_;
+  r->SetNewlyAllocated();
+  r->SetTop(r->End());
+  r->is_a_tlab_ = true;
+  r->thread_ = self;
+  self->SetTlab(r->Begin(), r->End());
+  return true;
+}
+
+void RegionSpace::SetPrezeroPoolSize(size_t num_regions) {
+  MutexLock mu(Thread::Current(), region_lock_);
+  prezero_pool_size_ = num_regions;
+}
+
+bool RegionSpace::PrezeroRegion(Thread* self) {
+  Region* r = nullptr;
+  {
+    MutexLock mu(self, region_lock_);
+    // Zero from the end of the space: the other allocations take the first free region, and
+    // AllocNewTlab() looks for the zeroed ones.
+    size_t num_prezeroed = 0U;
+    for (size_t i = num_regions_; i != 0; --i) {
+      Region* reg = &regions_[i - 1];
+      if (reg->IsAvailable()) {
+        if (reg->IsPrezeroed()) {
+          ++num_prezeroed;
+        } else if (r == nullptr) {
+          r = reg;
+        }
+      }
+    }
+    num_prezeroed_regions_ = num_prezeroed;
+    if (r == nullptr || num_prezeroed >= prezero_pool_size_) {
+      return false;
+    }
+    // Reserve the region so that no allocation takes it while it is written without the lock.
+    r->is_being_prezeroed_ = true;
+  }
+  // Writing the pages faults them in.
+  memset(r->Begin(), 0, kRegionSize);
+  MutexLock mu(self, region_lock_);
+  r->is_being_prezeroed_ = false;
+  if (r->IsFree() && !r->IsPrezeroed()) {
+    r->is_prezeroed_ = true;
+    ++num_prezeroed_regions_;
+  }
+  return num_prezeroed_regions_ < prezero_pool_size_;
+}
+
+bool RegionSpace::AllocNewEvacTlab(Thread* self) {
+  MutexLock mu(self, region_lock_);
+  RevokeThreadLocalBuffersLocked(self);
+  if (!partial_evac_regions_.empty()) {
+    Region* r = partial_evac_regions_.back();
+    partial_evac_regions_.pop_back();
+    uint8_t* tlab_start = r->Top();
+    r->SetTop(r->End());
+    r->is_a_tlab_ = true;
+    r->is_evac_tlab_ = true;
+    r->thread_ = self;
+    self->SetTlab(tlab_start, r->End());
+    return true;
+  }
+  // Like evac_region_, don't retain free regions and don't set as newly allocated.
   for (size_t i = 0; i < num_regions_; ++i) {
     Region* r = &regions_[i];
-    if (r->IsFree()) {
+    if (r->IsAvailable()) {
       r->Unfree(time_);
       ++num_non_free_regions_;
-      // TODO: this is buggy. Debug it.
-      // r->SetNewlyAllocated();
       r->SetTop(r->End());
       r->is_a_tlab_ = true;
+      r->is_evac_tlab_ = true;
       r->thread_ = self;
       self->SetTlab(r->Begin(), r->End());
       return true;
@@ -356,6 +473,31 @@ bool RegionSpace::AllocNewTlab(Thread* self) {
   return false;
 }
 
+void RegionSpace::RevokeEvacTlab(Thread* self) {
+  MutexLock mu(self, region_lock_);
+  RevokeThreadLocalBuffersLocked(self);
+}
+
+void RegionSpace::RevokeEvacTlabLocked(Thread* thread) {
+  uint8_t* tlab_pos = thread->GetTlabPos();
+  Region* r = RefToRegionLocked(reinterpret_cast<mirror::Object*>(thread->GetTlabStart()));
+  DCHECK(r->is_evac_tlab_);
+  r->is_a_tlab_ = false;
+  r->is_evac_tlab_ = false;
+  r->thread_ = nullptr;
+  if (tlab_pos == r->Begin()) {
+    // Nothing was copied into the region. Free it rather than leaving an empty to-space region.
+    r->Clear();
+    --num_non_free_regions_;
+  } else {
+    r->RecordEvacTlabAllocations(thread->GetThreadLocalObjectsAllocated(), tlab_pos);
+    if (static_cast<size_t>(r->End() - tlab_pos) >= kMaxEvacTlabObjectSize) {
+      partial_evac_regions_.push_back(r);
+    }
+  }
+  thread->SetTlab(nullptr, nullptr);
+}
+
 size_t RegionSpace::RevokeThreadLocalBuffers(Thread* thread) {
   MutexLock mu(Thread::Current(), region_lock_);
   RevokeThreadLocalBuffersLocked(thread);
@@ -366,13 +508,18 @@ void RegionSpace::RevokeThreadLocalBuffersLocked(Thread* thread) {
   uint8_t* tlab_start = thread->GetTlabStart();
   DCHECK_EQ(thread->HasTlab(), tlab_start != nullptr);
   if (tlab_start != nullptr) {
-    DCHECK_ALIGNED(tlab_start, kRegionSize);
     Region* r = RefToRegionLocked(reinterpret_cast<mirror::Object*>(tlab_start));
+    if (r->is_evac_tlab_) {
+      RevokeEvacTlabLocked(thread);
+      return;
+    }
+    DCHECK_ALIGNED(tlab_start, kRegionSize);
     DCHECK(r->IsAllocated());
     DCHECK_EQ(thread->GetThreadLocalBytesAllocated(), kRegionSize);
     r->RecordThreadLocalAllocations(thread->GetThreadLocalObjectsAllocated(),
                                     thread->GetThreadLocalBytesAllocated());
     r->is_a_tlab_ = false;
+    r->is_evac_tlab_ = false;
     r->thread_ = nullptr;
   }
   thread->SetTlab(nullptr, nullptr);
@@ -413,7 +560,8 @@ void RegionSpace::Region::Dump(std::ostream& os) const {
      << " state=" << static_cast<uint>(state_) << " type=" << static_cast<uint>(type_)
      << " objects_allocated=" << objects_allocated_
      << " alloc_time=" << alloc_time_ << " live_bytes=" << live_bytes_
-     << " is_newly_allocated=" << is_newly_allocated_ << " is_a_tlab=" << is_a_tlab_ << " thread=" << thread_ << "\n";
+     << " is_newly_allocated=" << is_newly_allocated_ << " is_a_tlab=" << is_a_tlab_
+     << " is_evac_tlab=" << is_evac_tlab_ << " thread=" << thread_ << "\n";
 }
 
 }  // namespace space
@@ -93,6 +93,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
 
   size_t RevokeThreadLocalBuffers(Thread* thread) REQUIRES(!region_lock_);
   void RevokeThreadLocalBuffersLocked(Thread* thread) REQUIRES(region_lock_);
+  void RevokeEvacTlabLocked(Thread* thread) REQUIRES(region_lock_);
   size_t RevokeAllThreadLocalBuffers()
       REQUIRES(!Locks::runtime_shutdown_lock_, !Locks::thread_list_lock_, !region_lock_);
   void AssertThreadLocalBuffersAreRevoked(Thread* thread) REQUIRES(!region_lock_);
@@ -150,13 +151,20 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
 
   // Go through all of the blocks and visit the continuous objects.
   void Walk(ObjectCallback* callback, void* arg)
-      REQUIRES(Locks::mutator_lock_) {
-    WalkInternal<false>(callback, arg);
-  }
+      REQUIRES(Locks::mutator_lock_);
 
   void WalkToSpace(ObjectCallback* callback, void* arg)
-      REQUIRES(Locks::mutator_lock_) {
-    WalkInternal<true>(callback, arg);
+      REQUIRES(Locks::mutator_lock_);
+
+  // Visit the objects starting in the regions [begin_region, end_region). Can be called
+  // concurrently for disjoint ranges while the threads are suspended.
+  void WalkRegions(size_t begin_region, size_t end_region, ObjectCallback* callback, void* arg)
+      NO_THREAD_SAFETY_ANALYSIS {
+    WalkInternal<false>(callback, arg, begin_region, std::min(end_region, num_regions_));
+  }
+
+  size_t GetNumRegions() const {
+    return num_regions_;
   }
 
   accounting::ContinuousSpaceBitmap::SweepCallback* GetSweepCallback() OVERRIDE {
@@ -194,6 +202,16 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return false;
   }
 
+  // Whether `ref` is in a region allocated by the mutators since the previous GC, i.e. whether it
+  // has not survived a collection yet.
+  bool IsInNewlyAllocatedRegion(mirror::Object* ref) {
+    if (HasAddress(ref)) {
+      Region* r = RefToRegionUnlocked(ref);
+      return r->IsNewlyAllocated();
+    }
+    return false;
+  }
+
   RegionType GetRegionType(mirror::Object* ref) {
     if (HasAddress(ref)) {
       Region* r = RefToRegionUnlocked(ref);
@@ -202,7 +220,11 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return RegionType::kRegionTypeNone;
   }
 
-  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all)
+  // Set the regions to collect as from-space. If `young_gen`, only collect the regions
+  // allocated since the previous GC, and leave the other regions in the to-space.
+  void SetFromSpace(accounting::ReadBarrierTable* rb_table,
+                    bool force_evacuate_all,
+                    bool young_gen = false)
       REQUIRES(!region_lock_);
 
   size_t FromSpaceSize() REQUIRES(!region_lock_);
@@ -219,16 +241,52 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
 
   void RecordAlloc(mirror::Object* ref) REQUIRES(!region_lock_);
   bool AllocNewTlab(Thread* self) REQUIRES(!region_lock_);
+  // Allocate a TLAB for the copies made by a GC worker thread during the evacuation, in the
+  // unused part of a region left by a revoked evacuation TLAB if there is one.
+  bool AllocNewEvacTlab(Thread* self) REQUIRES(!region_lock_);
+  // Revoke a TLAB allocated by AllocNewEvacTlab(), freeing its region if it's unused.
+  void RevokeEvacTlab(Thread* self) REQUIRES(!region_lock_);
+  // An evacuation TLAB is not replaced for larger objects that don't fit in it. Regions with at
+  // least this much space left are reused for the next evacuation TLABs.
+  static constexpr size_t kMaxEvacTlabObjectSize = 8 * KB;
+  // Whether the TLAB of the thread was allocated by AllocNewEvacTlab().
+  bool HasEvacTlab(Thread* self) {
+    if (!self->HasTlab()) {
+      return false;
+    }
+    mirror::Object* tlab_start = reinterpret_cast<mirror::Object*>(self->GetTlabStart());
+    return RefToRegionUnlocked(tlab_start)->is_evac_tlab_;
+  }
 
   uint32_t Time() {
     return time_;
   }
 
+  // Keep up to `num_regions` free regions zeroed and faulted in ahead of AllocNewTlab(), so that
+  // the first touch of a new TLAB doesn't page-fault on the allocating thread. 0 disables it.
+  void SetPrezeroPoolSize(size_t num_regions) REQUIRES(!region_lock_);
+  // Whether the pool of zeroed regions is short, as of the last TLAB refill or PrezeroRegion().
+  bool NeedsPrezeroing() const {
+    return num_prezeroed_regions_ < prezero_pool_size_;
+  }
+  // Zero and fault in one free region for the pool. Returns true if the pool is still short.
+  // Called by a background heap task without the mutator lock.
+  bool PrezeroRegion(Thread* self) REQUIRES(!region_lock_);
+
+  uint64_t GetTlabRefills() const {
+    return tlab_refills_.LoadRelaxed();
+  }
+  // The number of TLAB refills which got a region from the zeroed pool.
+  uint64_t GetPrezeroedTlabRefills() const {
+    return prezeroed_tlab_refills_.LoadRelaxed();
+  }
+
  private:
   RegionSpace(const std::string& name, MemMap* mem_map);
 
   template<bool kToSpaceOnly>
-  void WalkInternal(ObjectCallback* callback, void* arg) NO_THREAD_SAFETY_ANALYSIS;
+  void WalkInternal(ObjectCallback* callback, void* arg, size_t begin_region, size_t end_region)
+      NO_THREAD_SAFETY_ANALYSIS;
 
   class Region {
    public:
@@ -237,13 +295,15 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
           begin_(nullptr), top_(nullptr), end_(nullptr),
           state_(RegionState::kRegionStateAllocated), type_(RegionType::kRegionTypeToSpace),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {}
+          is_newly_allocated_(false), is_a_tlab_(false), is_evac_tlab_(false),
+          is_prezeroed_(false), is_being_prezeroed_(false), thread_(nullptr) {}
 
     Region(size_t idx, uint8_t* begin, uint8_t* end)
         : idx_(idx), begin_(begin), top_(begin), end_(end),
           state_(RegionState::kRegionStateFree), type_(RegionType::kRegionTypeNone),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {
+          is_newly_allocated_(false), is_a_tlab_(false), is_evac_tlab_(false),
+          is_prezeroed_(false), is_being_prezeroed_(false), thread_(nullptr) {
       DCHECK_LT(begin, end);
       DCHECK_EQ(static_cast<size_t>(end - begin), kRegionSize);
     }
@@ -269,6 +329,8 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       madvise(begin_, end_ - begin_, MADV_DONTNEED);
       is_newly_allocated_ = false;
       is_a_tlab_ = false;
+      is_evac_tlab_ = false;
+      is_prezeroed_ = false;
       thread_ = nullptr;
     }
 
@@ -286,32 +348,49 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       return is_free;
     }
 
+    // A free region which the allocations may take, i.e. not reserved by PrezeroRegion().
+    bool IsAvailable() const {
+      return IsFree() && !is_being_prezeroed_;
+    }
+
     // Given a free region, declare it non-free (allocated).
     void Unfree(uint32_t alloc_time) {
-      DCHECK(IsFree());
+      DCHECK(IsAvailable());
       state_ = RegionState::kRegionStateAllocated;
       type_ = RegionType::kRegionTypeToSpace;
       alloc_time_ = alloc_time;
+      is_prezeroed_ = false;
     }
 
     void UnfreeLarge(uint32_t alloc_time) {
-      DCHECK(IsFree());
+      DCHECK(IsAvailable());
       state_ = RegionState::kRegionStateLarge;
       type_ = RegionType::kRegionTypeToSpace;
       alloc_time_ = alloc_time;
+      is_prezeroed_ = false;
     }
 
     void UnfreeLargeTail(uint32_t alloc_time) {
-      DCHECK(IsFree());
+      DCHECK(IsAvailable());
       state_ = RegionState::kRegionStateLargeTail;
       type_ = RegionType::kRegionTypeToSpace;
       alloc_time_ = alloc_time;
+      is_prezeroed_ = false;
     }
 
     void SetNewlyAllocated() {
       is_newly_allocated_ = true;
     }
 
+    bool IsNewlyAllocated() const {
+      return is_newly_allocated_;
+    }
+
+    // A free region which PrezeroRegion() faulted in.
+    bool IsPrezeroed() const {
+      return is_prezeroed_;
+    }
+
     // Non-large, non-large-tail allocated.
     bool IsAllocated() const {
       return state_ == RegionState::kRegionStateAllocated;
@@ -365,6 +444,8 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       DCHECK(!IsFree() && IsInToSpace());
       type_ = RegionType::kRegionTypeUnevacFromSpace;
       live_bytes_ = 0U;
+      // The objects surviving in place are no longer young.
+      is_newly_allocated_ = false;
     }
 
     void SetUnevacFromSpaceAsToSpace() {
@@ -451,6 +532,16 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
 
     void Dump(std::ostream& os) const;
 
+    // Only the copies are accounted in the heap, as bytes moved. Record the end of the copies as
+    // the top so that the unused part of the region is not counted as allocated.
+    void RecordEvacTlabAllocations(size_t num_objects, uint8_t* tlab_pos) {
+      DCHECK(IsAllocated());
+      DCHECK_EQ(top_, end_);
+      DCHECK_LE(tlab_pos, end_);
+      objects_allocated_ += num_objects;
+      top_ = tlab_pos;
+    }
+
     void RecordThreadLocalAllocations(size_t num_objects, size_t num_bytes) {
       DCHECK(IsAllocated());
       DCHECK_EQ(objects_allocated_, 0U);
@@ -473,6 +564,9 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     size_t live_bytes_;            // The live bytes. Used to compute the live percent.
     bool is_newly_allocated_;      // True if it's allocated after the last collection.
     bool is_a_tlab_;               // True if it's a tlab.
+    bool is_evac_tlab_;            // True if it's a tlab for the evacuation.
+    bool is_prezeroed_;            // True if it's free, zeroed and faulted in.
+    bool is_being_prezeroed_;      // True while PrezeroRegion() zeroes it without the lock.
     Thread* thread_;               // The owning thread if it's a tlab.
 
     friend class RegionSpace;
@@ -517,8 +611,17 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
                                    // The pointer to the region array.
   Region* current_region_;         // The region that's being allocated currently.
   Region* evac_region_;            // The region that's being evacuated to currently.
+  // The regions of the revoked evacuation TLABs with space left, reused by AllocNewEvacTlab().
+  std::vector<Region*> partial_evac_regions_ GUARDED_BY(region_lock_);
   Region full_region_;             // The dummy/sentinel region that looks full.
 
+  // The free regions zeroed ahead of the TLAB refills. The count is only exact after a refill or
+  // PrezeroRegion(), since the other allocations may also take these regions.
+  size_t prezero_pool_size_;
+  size_t num_prezeroed_regions_;
+  Atomic<uint64_t> tlab_refills_;
+  Atomic<uint64_t> prezeroed_tlab_refills_;
+
   DISALLOW_COPY_AND_ASSIGN(RegionSpace);
 };
 
@@ -55,13 +55,15 @@ RosAllocSpace::RosAllocSpace(MemMap* mem_map, size_t initial_size, const std::st
 RosAllocSpace* RosAllocSpace::CreateFromMemMap(MemMap* mem_map, const std::string& name,
                                                size_t starting_size, size_t initial_size,
                                                size_t growth_limit, size_t capacity,
-                                               bool low_memory_mode, bool can_move_objects) {
+                                               bool low_memory_mode, bool can_move_objects,
+                                               bool use_per_cpu_runs) {
   DCHECK(mem_map != nullptr);
 
   bool running_on_memory_tool = Runtime::Current()->IsRunningOnMemoryTool();
 
   allocator::RosAlloc* rosalloc = CreateRosAlloc(mem_map->Begin(), starting_size, initial_size,
-                                                 capacity, low_memory_mode, running_on_memory_tool);
+                                                 capacity, low_memory_mode, running_on_memory_tool,
+                                                 use_per_cpu_runs);
   if (rosalloc == nullptr) {
     LOG(ERROR) << "Failed to initialize rosalloc for alloc space (" << name << ")";
     return nullptr;
@@ -93,7 +95,8 @@ RosAllocSpace::~RosAllocSpace() {
 
 RosAllocSpace* RosAllocSpace::Create(const std::string& name, size_t initial_size,
                                      size_t growth_limit, size_t capacity, uint8_t* requested_begin,
-                                     bool low_memory_mode, bool can_move_objects) {
+                                     bool low_memory_mode, bool can_move_objects,
+                                     bool use_per_cpu_runs) {
   uint64_t start_time = 0;
   if (VLOG_IS_ON(heap) || VLOG_IS_ON(startup)) {
     start_time = NanoTime();
@@ -119,7 +122,7 @@ RosAllocSpace* RosAllocSpace::Create(const std::string& name, size_t initial_siz
 
   RosAllocSpace* space = CreateFromMemMap(mem_map, name, starting_size, initial_size,
                                           growth_limit, capacity, low_memory_mode,
-                                          can_move_objects);
+                                          can_move_objects, use_per_cpu_runs);
   // We start out with only the initial size possibly containing objects.
   if (VLOG_IS_ON(heap) || VLOG_IS_ON(startup)) {
     LOG(INFO) << "RosAllocSpace::Create exiting (" << PrettyDuration(NanoTime() - start_time)
@@ -131,7 +134,8 @@ RosAllocSpace* RosAllocSpace::Create(const std::string& name, size_t initial_siz
 allocator::RosAlloc* RosAllocSpace::CreateRosAlloc(void* begin, size_t morecore_start,
                                                    size_t initial_size,
                                                    size_t maximum_size, bool low_memory_mode,
-                                                   bool running_on_memory_tool) {
+                                                   bool running_on_memory_tool,
+                                                   bool use_per_cpu_runs) {
   // clear errno to allow PLOG on error
   errno = 0;
   // create rosalloc using our backing storage starting at begin and
@@ -142,7 +146,9 @@ allocator::RosAlloc* RosAllocSpace::CreateRosAlloc(void* begin, size_t morecore_
       low_memory_mode ?
           art::gc::allocator::RosAlloc::kPageReleaseModeAll :
           art::gc::allocator::RosAlloc::kPageReleaseModeSizeAndEnd,
-      running_on_memory_tool);
+      running_on_memory_tool,
+      art::gc::allocator::RosAlloc::kDefaultPageReleaseSizeThreshold,
+      use_per_cpu_runs);
   if (rosalloc != nullptr) {
     rosalloc->SetFootprintLimit(initial_size);
   } else {
@@ -343,6 +349,10 @@ size_t RosAllocSpace::RevokeAllThreadLocalBuffers() {
   return rosalloc_->RevokeAllThreadLocalRuns();
 }
 
+size_t RosAllocSpace::RevokeCpuBuffers() {
+  return rosalloc_->RevokeCpuRuns();
+}
+
 void RosAllocSpace::AssertThreadLocalBuffersAreRevoked(Thread* thread) {
   if (kIsDebugBuild) {
     rosalloc_->AssertThreadLocalRunsAreRevoked(thread);
@@ -361,10 +371,11 @@ void RosAllocSpace::Clear() {
   live_bitmap_->Clear();
   mark_bitmap_->Clear();
   SetEnd(begin_ + starting_size_);
+  bool use_per_cpu_runs = rosalloc_->UsesPerCpuRuns();
   delete rosalloc_;
   rosalloc_ = CreateRosAlloc(mem_map_->Begin(), starting_size_, initial_size_,
                              NonGrowthLimitCapacity(), low_memory_mode_,
-                             Runtime::Current()->IsRunningOnMemoryTool());
+                             Runtime::Current()->IsRunningOnMemoryTool(), use_per_cpu_runs);
   SetFootprintLimit(footprint_limit);
 }
 
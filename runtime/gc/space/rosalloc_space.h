@@ -37,14 +37,16 @@ class RosAllocSpace : public MallocSpace {
   // Create a RosAllocSpace with the requested sizes. The requested
   // base address is not guaranteed to be granted, if it is required,
   // the caller should call Begin on the returned space to confirm the
-  // request was granted.
+  // request was granted. If use_per_cpu_runs, the small allocations are served from per-CPU
+  // runs rather than thread-local runs.
   static RosAllocSpace* Create(const std::string& name, size_t initial_size, size_t growth_limit,
                                size_t capacity, uint8_t* requested_begin, bool low_memory_mode,
-                               bool can_move_objects);
+                               bool can_move_objects, bool use_per_cpu_runs = false);
   static RosAllocSpace* CreateFromMemMap(MemMap* mem_map, const std::string& name,
                                          size_t starting_size, size_t initial_size,
                                          size_t growth_limit, size_t capacity,
-                                         bool low_memory_mode, bool can_move_objects);
+                                         bool low_memory_mode, bool can_move_objects,
+                                         bool use_per_cpu_runs = false);
 
   mirror::Object* AllocWithGrowth(Thread* self, size_t num_bytes, size_t* bytes_allocated,
                                   size_t* usable_size, size_t* bytes_tl_bulk_allocated)
@@ -120,6 +122,8 @@ class RosAllocSpace : public MallocSpace {
 
   size_t RevokeThreadLocalBuffers(Thread* thread);
   size_t RevokeAllThreadLocalBuffers();
+  // Revoke the per-CPU runs, which no thread owns, if the allocator uses them.
+  size_t RevokeCpuBuffers();
   void AssertThreadLocalBuffersAreRevoked(Thread* thread);
   void AssertAllThreadLocalBuffersAreRevoked();
 
@@ -160,11 +164,11 @@ class RosAllocSpace : public MallocSpace {
   void* CreateAllocator(void* base, size_t morecore_start, size_t initial_size,
                         size_t maximum_size, bool low_memory_mode) OVERRIDE {
     return CreateRosAlloc(base, morecore_start, initial_size, maximum_size, low_memory_mode,
-                          RUNNING_ON_MEMORY_TOOL != 0);
+                          RUNNING_ON_MEMORY_TOOL != 0, rosalloc_->UsesPerCpuRuns());
   }
   static allocator::RosAlloc* CreateRosAlloc(void* base, size_t morecore_start, size_t initial_size,
                                              size_t maximum_size, bool low_memory_mode,
-                                             bool running_on_memory_tool);
+                                             bool running_on_memory_tool, bool use_per_cpu_runs);
 
   void InspectAllRosAlloc(void (*callback)(void *start, void *end, size_t num_bytes, void* callback_arg),
                           void* arg, bool do_null_callback_at_end)
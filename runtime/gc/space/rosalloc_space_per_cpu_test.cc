@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "barrier.h"
+#include "base/time_utils.h"
+#include "space_test.h"
+
+namespace art {
+namespace gc {
+namespace space {
+
+// Compares the footprint and the allocation throughput of RosAlloc with thread-local runs and
+// with per-CPU runs when many threads allocate a few small objects each.
+class RosAllocSpacePerCpuTest : public SpaceTest<CommonRuntimeTest> {
+ protected:
+  static constexpr size_t kObjectSize = 32;
+  static constexpr size_t kNumAllocsPerThread = 16;
+  static constexpr size_t kThreadStackSize = 256 * KB;
+
+  struct BenchmarkResult {
+    size_t footprint;
+    uint64_t duration_ns;
+  };
+
+  struct WorkerArgs {
+    RosAllocSpace* space;
+    Barrier* start_barrier;
+    Barrier* done_barrier;
+    Barrier* exit_barrier;
+    Atomic<size_t>* num_failed_allocs;
+  };
+
+  static void* Worker(void* arg) {
+    WorkerArgs* args = reinterpret_cast<WorkerArgs*>(arg);
+    Runtime* runtime = Runtime::Current();
+    CHECK(runtime->AttachCurrentThread("RosAlloc benchmark", true, nullptr, false));
+    Thread* self = Thread::Current();
+    args->start_barrier->Wait(self);
+    for (size_t i = 0; i < kNumAllocsPerThread; ++i) {
+      size_t bytes_allocated, usable_size, bytes_tl_bulk_allocated;
+      mirror::Object* obj = args->space->Alloc(self,
+                                               kObjectSize,
+                                               &bytes_allocated,
+                                               &usable_size,
+                                               &bytes_tl_bulk_allocated);
+      if (obj == nullptr) {
+        args->num_failed_allocs->FetchAndAddSequentiallyConsistent(1);
+      }
+    }
+    args->done_barrier->Pass(self);
+    // Keep the thread-local runs until the footprint is measured.
+    args->exit_barrier->Wait(self);
+    runtime->DetachCurrentThread();
+    return nullptr;
+  }
+
+  // Remove a space added by RunBenchmark(), and make `previous_default` the default space again.
+  void RemoveSpace(RosAllocSpace* space, RosAllocSpace* previous_default) {
+    Heap* heap = Runtime::Current()->GetHeap();
+    // The space allocated outside of the heap's accounting, do not revoke through the heap.
+    space->RevokeAllThreadLocalBuffers();
+    {
+      ScopedThreadStateChange sts(Thread::Current(), kSuspended);
+      ScopedSuspendAll ssa("Remove space");
+      heap->RemoveSpace(space);
+    }
+    CHECK(previous_default != nullptr);
+    heap->SetSpaceAsDefault(previous_default);
+    delete space;
+  }
+
+  BenchmarkResult RunBenchmark(size_t num_threads, bool use_per_cpu_runs) {
+    RosAllocSpace* const previous_default = Runtime::Current()->GetHeap()->GetRosAllocSpace();
+    RosAllocSpace* space = RosAllocSpace::Create("test", 32 * MB, 64 * MB, 64 * MB, nullptr,
+                                                 false, false, use_per_cpu_runs);
+    CHECK(space != nullptr);
+    // The default space, so that the threads' runs are revoked from it when they detach.
+    AddSpace(space);
+    Thread* self = Thread::Current();
+    size_t initial_footprint = space->GetFootprint();
+    Barrier start_barrier(num_threads + 1);
+    Barrier done_barrier(num_threads + 1);
+    Barrier exit_barrier(num_threads + 1);
+    Atomic<size_t> num_failed_allocs(0);
+    WorkerArgs args = { space, &start_barrier, &done_barrier, &exit_barrier, &num_failed_allocs };
+    const char* reason = __PRETTY_FUNCTION__;
+    pthread_attr_t attr;
+    CHECK_PTHREAD_CALL(pthread_attr_init, (&attr), reason);
+    CHECK_PTHREAD_CALL(pthread_attr_setstacksize, (&attr, kThreadStackSize), reason);
+    std::vector<pthread_t> pthreads(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+      CHECK_PTHREAD_CALL(pthread_create, (&pthreads[i], &attr, Worker, &args), reason);
+    }
+    CHECK_PTHREAD_CALL(pthread_attr_destroy, (&attr), reason);
+    BenchmarkResult result;
+    start_barrier.Wait(self);
+    uint64_t start_time = NanoTime();
+    done_barrier.Wait(self);
+    result.duration_ns = NanoTime() - start_time;
+    result.footprint = space->GetFootprint() - initial_footprint;
+    exit_barrier.Wait(self);
+    for (pthread_t pthread : pthreads) {
+      CHECK_PTHREAD_CALL(pthread_join, (pthread, nullptr), reason);
+    }
+    EXPECT_EQ(0u, num_failed_allocs.LoadSequentiallyConsistent());
+    uint64_t num_allocs = num_threads * kNumAllocsPerThread;
+    uint64_t duration_ns = std::max<uint64_t>(result.duration_ns, 1u);
+    LOG(INFO) << (use_per_cpu_runs ? "Per-CPU" : "Thread-local") << " runs, "
+              << num_threads << " threads: footprint=" << PrettySize(result.footprint)
+              << " allocs/ms=" << num_allocs * MsToNs(1) / duration_ns;
+    RemoveSpace(space, previous_default);
+    return result;
+  }
+
+  void CompareRuns(size_t num_threads) {
+    BenchmarkResult thread_local_result = RunBenchmark(num_threads, false);
+    BenchmarkResult per_cpu_result = RunBenchmark(num_threads, true);
+    // With more threads than CPUs, the per-CPU runs leave fewer partially filled runs.
+    size_t num_cpus = std::max(sysconf(_SC_NPROCESSORS_CONF), 1L);
+    if (num_threads >= 4 * num_cpus) {
+      EXPECT_LT(per_cpu_result.footprint, thread_local_result.footprint);
+    }
+  }
+};
+
+TEST_F(RosAllocSpacePerCpuTest, Threads16) {
+  CompareRuns(16);
+}
+
+TEST_F(RosAllocSpacePerCpuTest, Threads256) {
+  CompareRuns(256);
+}
+
+TEST_F(RosAllocSpacePerCpuTest, Threads4096) {
+  CompareRuns(4096);
+}
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
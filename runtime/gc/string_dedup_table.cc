@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "string_dedup_table.h"
+
+#include <string.h>
+
+#include "base/bit_utils.h"
+#include "base/logging.h"
+#include "mirror/object-inl.h"
+#include "mirror/string-inl.h"
+#include "utf.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+StringDedupTable::StringDedupTable(size_t capacity)
+    : capacity_(RoundUpToPowerOfTwo(capacity)),
+      slots_(new Atomic<uint64_t>[capacity_]),
+      strings_deduplicated_(0),
+      bytes_saved_(0) {
+  Reset();
+}
+
+void StringDedupTable::Reset() {
+  for (size_t i = 0; i < capacity_; ++i) {
+    slots_[i].StoreRelaxed(0);
+  }
+}
+
+uint32_t StringDedupTable::ComputeHash(mirror::String* str) {
+  // Hash the characters rather than call GetHashCode(), which would store into the string.
+  const int32_t length = str->GetLength<kVerifyNone>();
+  return static_cast<uint32_t>(str->IsCompressed<kVerifyNone>()
+      ? ComputeUtf16Hash(str->GetValueCompressed(), length)
+      : ComputeUtf16Hash(str->GetValue(), length));
+}
+
+bool StringDedupTable::ContentsEqual(mirror::String* a, mirror::String* b) {
+  // Equal strings have equal counts, including the compression flag.
+  const int32_t count = a->GetCount<kVerifyNone>();
+  if (count != b->GetCount<kVerifyNone>()) {
+    return false;
+  }
+  const int32_t length = mirror::String::GetLengthFromCount(count);
+  return mirror::String::IsCompressed(count)
+      ? memcmp(a->GetValueCompressed(), b->GetValueCompressed(), length * sizeof(uint8_t)) == 0
+      : memcmp(a->GetValue(), b->GetValue(), length * sizeof(uint16_t)) == 0;
+}
+
+size_t StringDedupTable::FirstSlot(uint32_t hash) const {
+  return hash & (capacity_ - 1);
+}
+
+static mirror::String* EntryString(uint64_t entry) {
+  return reinterpret_cast<mirror::String*>(static_cast<uintptr_t>(static_cast<uint32_t>(entry)));
+}
+
+mirror::String* StringDedupTable::Find(mirror::String* str) {
+  const uint32_t hash = ComputeHash(str);
+  size_t slot = FirstSlot(hash);
+  for (size_t i = 0; i < kMaxProbes; ++i) {
+    // Acquire so that the contents of the copy are visible once its entry is.
+    const uint64_t entry = slots_[slot].LoadAcquire();
+    if (entry == 0) {
+      return nullptr;
+    }
+    if (static_cast<uint32_t>(entry >> 32) == hash) {
+      mirror::String* candidate = EntryString(entry);
+      if (candidate != str && ContentsEqual(candidate, str)) {
+        return candidate;
+      }
+    }
+    slot = (slot + 1) & (capacity_ - 1);
+  }
+  return nullptr;
+}
+
+void StringDedupTable::Add(mirror::String* str) {
+  const uint32_t hash = ComputeHash(str);
+  const uint64_t new_entry = (static_cast<uint64_t>(hash) << 32) | PointerToLowMemUInt32(str);
+  DCHECK_NE(new_entry, 0u);
+  size_t slot = FirstSlot(hash);
+  for (size_t i = 0; i < kMaxProbes; ++i) {
+    uint64_t entry = slots_[slot].LoadAcquire();
+    // The sequentially consistent CAS publishes the copied contents along with the entry.
+    if (entry == 0 && slots_[slot].CompareExchangeStrongSequentiallyConsistent(0, new_entry)) {
+      return;
+    }
+    // Another thread may have just claimed the slot for the same contents.
+    entry = slots_[slot].LoadAcquire();
+    if (static_cast<uint32_t>(entry >> 32) == hash && ContentsEqual(EntryString(entry), str)) {
+      return;
+    }
+    slot = (slot + 1) & (capacity_ - 1);
+  }
+}
+
+void StringDedupTable::DumpPerformanceInfo(std::ostream& os) {
+  const uint64_t strings = GetStringsDeduplicated();
+  if (strings != 0) {
+    os << "String deduplication: " << strings << " strings, " << PrettySize(GetBytesSaved())
+       << " saved\n";
+  }
+}
+
+}  // namespace gc
+}  // namespace art
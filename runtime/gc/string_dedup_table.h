@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_STRING_DEDUP_TABLE_H_
+#define ART_RUNTIME_GC_STRING_DEDUP_TABLE_H_
+
+#include <memory>
+#include <ostream>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+namespace mirror {
+class String;
+}  // namespace mirror
+
+namespace gc {
+
+// The strings copied by the current concurrent copying collection, by contents. When the
+// collector is about to copy a string equal to one of them, it forwards the string to that copy
+// instead, which redirects all of the references to it. The collector only adds and forwards
+// strings which survived an earlier collection, as new strings may still be filled in. Since the characters of a string are
+// inline, the duplicates are whole objects rather than shared arrays.
+//
+// The table is lock free: the GC threads and the mutators going through the read barrier copy
+// objects concurrently. An entry packs the hash of the contents with the 32 bit address of the
+// string, so that a slot is claimed with a single CAS. Entries are only added, and all of them
+// are dropped at the start of each collection since the copies then move again.
+class StringDedupTable {
+ public:
+  static constexpr size_t kDefaultCapacity = 64 * 1024;
+
+  explicit StringDedupTable(size_t capacity = kDefaultCapacity);
+
+  // Forget the strings of the previous collection. Only called by the GC thread, before any copy.
+  void Reset();
+
+  // Returns a string added by this collection with the same contents as `str`, or null.
+  mirror::String* Find(mirror::String* str) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Add the copy of a string, unless an equal one was added first or the probes run out.
+  void Add(mirror::String* str) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Record that a string of `bytes` was forwarded to an equal one rather than copied.
+  void RecordDeduplicated(size_t bytes) {
+    strings_deduplicated_.FetchAndAddRelaxed(1);
+    bytes_saved_.FetchAndAddRelaxed(bytes);
+  }
+
+  // The totals since the runtime started; they can be read at any time without locks.
+  uint64_t GetStringsDeduplicated() const {
+    return strings_deduplicated_.LoadRelaxed();
+  }
+  uint64_t GetBytesSaved() const {
+    return bytes_saved_.LoadRelaxed();
+  }
+
+  void DumpPerformanceInfo(std::ostream& os);
+
+ private:
+  // Beyond this many probes, a string is neither found nor added: the table is too full.
+  static constexpr size_t kMaxProbes = 16;
+
+  static uint32_t ComputeHash(mirror::String* str) SHARED_REQUIRES(Locks::mutator_lock_);
+  static bool ContentsEqual(mirror::String* a, mirror::String* b)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  size_t FirstSlot(uint32_t hash) const;
+
+  const size_t capacity_;  // A power of two.
+  std::unique_ptr<Atomic<uint64_t>[]> slots_;
+  Atomic<uint64_t> strings_deduplicated_;
+  Atomic<uint64_t> bytes_saved_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringDedupTable);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_STRING_DEDUP_TABLE_H_
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "string_dedup_table.h"
+
+#include "common_runtime_test.h"
+#include "handle_scope-inl.h"
+#include "mirror/string-inl.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace gc {
+
+class StringDedupTableTest : public CommonRuntimeTest {};
+
+TEST_F(StringDedupTableTest, FindAndAdd) {
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<4> hs(self);
+  Handle<mirror::String> a(hs.NewHandle(mirror::String::AllocFromModifiedUtf8(self, "dedup")));
+  Handle<mirror::String> b(hs.NewHandle(mirror::String::AllocFromModifiedUtf8(self, "dedup")));
+  Handle<mirror::String> c(hs.NewHandle(mirror::String::AllocFromModifiedUtf8(self, "dedupe")));
+  Handle<mirror::String> d(hs.NewHandle(mirror::String::AllocFromModifiedUtf8(self, "pudde")));
+  ASSERT_TRUE(a.Get() != nullptr);
+  ASSERT_TRUE(b.Get() != nullptr);
+  ASSERT_TRUE(c.Get() != nullptr);
+  ASSERT_TRUE(d.Get() != nullptr);
+
+  StringDedupTable table(16);
+  EXPECT_TRUE(table.Find(b.Get()) == nullptr);
+  table.Add(a.Get());
+  EXPECT_EQ(a.Get(), table.Find(b.Get()));
+  // A string is not a duplicate of itself.
+  EXPECT_TRUE(table.Find(a.Get()) == nullptr);
+  EXPECT_TRUE(table.Find(c.Get()) == nullptr);
+  EXPECT_TRUE(table.Find(d.Get()) == nullptr);
+
+  // An equal string doesn't replace the first one.
+  table.Add(b.Get());
+  EXPECT_EQ(a.Get(), table.Find(b.Get()));
+  table.Add(c.Get());
+  EXPECT_EQ(a.Get(), table.Find(b.Get()));
+
+  table.Reset();
+  EXPECT_TRUE(table.Find(b.Get()) == nullptr);
+
+  table.RecordDeduplicated(24);
+  table.RecordDeduplicated(32);
+  EXPECT_EQ(2u, table.GetStringsDeduplicated());
+  EXPECT_EQ(56u, table.GetBytesSaved());
+}
+
+}  // namespace gc
+}  // namespace art
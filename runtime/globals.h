@@ -114,6 +114,14 @@ static constexpr bool kUseTlab = true;
 static constexpr bool kUseTlab = false;
 #endif
 
+// If true, the strings and resolved types of a DexCache are fixed-size caches of (index, object)
+// pairs rather than arrays with an element for each string or type id of the dex file.
+#ifdef ART_USE_HASHED_DEX_CACHE
+static constexpr bool kUseHashedDexCache = true;
+#else
+static constexpr bool kUseHashedDexCache = false;
+#endif
+
 // Kinds of tracing clocks.
 enum class TraceClockSource {
   kThreadCpu,
@@ -20,6 +20,11 @@
  * we generate some of the data (strings and classes) while we dump the
  * heap, and some analysis tools require that the class and string data
  * appear first.
+ *
+ * A file can also be written in a single pass when asked to, or when the
+ * heap is walked with several threads or the output is compressed with gzip.
+ * The string and class records are then interleaved with the heap dump
+ * segments, right before the first segment that refers to them.
  */
 
 #include "hprof.h"
@@ -34,6 +39,7 @@
 #include <time.h>
 #include <time.h>
 #include <unistd.h>
+#include <zlib.h>
 
 #include <set>
 
@@ -61,6 +67,7 @@
 #include "safe_map.h"
 #include "scoped_thread_state_change.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -74,6 +81,9 @@ static constexpr uint32_t kHprofNullThread = 0;
 static constexpr size_t kMaxObjectsPerSegment = 128;
 static constexpr size_t kMaxBytesPerSegment = 4096;
 
+// How many bytes of complete records a thread of a streaming dump buffers before writing them out.
+static constexpr size_t kStreamChunkBytes = 1 * MB;
+
 // The static field-name for the synthetic object generated to account for class static overhead.
 static constexpr const char* kClassOverheadName = "$classOverhead";
 
@@ -391,6 +401,25 @@ class FileEndianOutput FINAL : public EndianOutputBuffered {
   bool errors_;
 };
 
+// This appends the records to a vector, which a streaming dump writes out in chunks.
+class VectorEndianOutput FINAL : public EndianOutputBuffered {
+ public:
+  explicit VectorEndianOutput(size_t reserved_size) : EndianOutputBuffered(reserved_size) {}
+  ~VectorEndianOutput() {}
+
+  std::vector<uint8_t>* GetData() {
+    return &data_;
+  }
+
+ protected:
+  void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
+    data_.insert(data_.end(), buffer, buffer + length);
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
 class NetStateEndianOutput FINAL : public EndianOutputBuffered {
  public:
   NetStateEndianOutput(JDWP::JdwpNetStateBase* net_state, size_t reserved_size)
@@ -412,14 +441,41 @@ class NetStateEndianOutput FINAL : public EndianOutputBuffered {
   JDWP::JdwpNetStateBase* net_state_;
 };
 
+// Compress `data` into a whole gzip member. A gzip file may be made of several members, so each
+// thread of a streaming dump compresses its own chunks.
+static bool GzipCompress(const std::vector<uint8_t>& data, std::vector<uint8_t>* out) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // Add 16 to the window bits for a gzip rather than zlib wrapper. 8 is the default memory level.
+  if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) !=
+      Z_OK) {
+    return false;
+  }
+  out->resize(deflateBound(&stream, data.size()));
+  stream.next_in = const_cast<Bytef*>(data.data());
+  stream.avail_in = data.size();
+  stream.next_out = out->data();
+  stream.avail_out = out->size();
+  const int result = deflate(&stream, Z_FINISH);
+  out->resize(stream.total_out);
+  deflateEnd(&stream);
+  return result == Z_STREAM_END;
+}
+
 #define __ output_->
 
 class Hprof : public SingleRootVisitor {
  public:
-  Hprof(const char* output_filename, int fd, bool direct_to_ddms)
+  Hprof(const char* output_filename, int fd, bool direct_to_ddms, ThreadPool* thread_pool,
+        bool gzip, bool streaming)
       : filename_(output_filename),
         fd_(fd),
-        direct_to_ddms_(direct_to_ddms) {
+        direct_to_ddms_(direct_to_ddms),
+        thread_pool_(thread_pool),
+        gzip_(gzip),
+        streaming_(streaming),
+        owner_(this),
+        tables_lock_("hprof tables lock") {
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
   }
 
@@ -433,27 +489,32 @@ class Hprof : public SingleRootVisitor {
       }
     }
 
-    // First pass to measure the size of the dump.
     size_t overall_size;
-    size_t max_length;
-    {
-      EndianOutput count_output;
-      output_ = &count_output;
-      ProcessHeap(false);
-      overall_size = count_output.SumLength();
-      max_length = count_output.MaxLength();
-      output_ = nullptr;
-    }
-
     bool okay;
-    if (direct_to_ddms_) {
-      if (kDirectStream) {
-        okay = DumpToDdmsDirect(overall_size, max_length, CHUNK_TYPE("HPDS"));
+    if (!direct_to_ddms_ && (streaming_ || thread_pool_ != nullptr || gzip_)) {
+      okay = DumpToFileStreaming();
+      overall_size = stream_bytes_written_;
+    } else {
+      // First pass to measure the size of the dump.
+      size_t max_length;
+      {
+        EndianOutput count_output;
+        output_ = &count_output;
+        ProcessHeap(false);
+        overall_size = count_output.SumLength();
+        max_length = count_output.MaxLength();
+        output_ = nullptr;
+      }
+
+      if (direct_to_ddms_) {
+        if (kDirectStream) {
+          okay = DumpToDdmsDirect(overall_size, max_length, CHUNK_TYPE("HPDS"));
+        } else {
+          okay = DumpToDdmsBuffered(overall_size, max_length);
+        }
       } else {
-        okay = DumpToDdmsBuffered(overall_size, max_length);
+        okay = DumpToFile(overall_size, max_length);
       }
-    } else {
-      okay = DumpToFile(overall_size, max_length);
     }
 
     if (okay) {
@@ -473,6 +534,29 @@ class Hprof : public SingleRootVisitor {
     reinterpret_cast<Hprof*>(arg)->DumpHeapObject(obj);
   }
 
+  // The thread which suspended all the others holds the mutator lock for the workers.
+  static void VisitObjectParallelCallback(mirror::Object* obj, size_t worker, void* arg)
+      NO_THREAD_SAFETY_ANALYSIS {
+    DCHECK(obj != nullptr);
+    DCHECK(arg != nullptr);
+    reinterpret_cast<Hprof*>(arg)->workers_[worker]->DumpHeapObject(obj);
+  }
+
+  // A worker of a streaming dump. It writes the objects it visits to its own buffer, and only
+  // takes the lock of `owner` for the strings, classes and roots it has not seen before.
+  explicit Hprof(Hprof* owner)
+      : filename_(owner->filename_),
+        fd_(owner->fd_),
+        direct_to_ddms_(false),
+        thread_pool_(nullptr),
+        gzip_(owner->gzip_),
+        streaming_(true),
+        owner_(owner),
+        tables_lock_("hprof worker tables lock"),
+        stream_output_(new VectorEndianOutput(kMaxBytesPerSegment)) {
+    output_ = stream_output_.get();
+  }
+
   void DumpHeapObject(mirror::Object* obj)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -535,41 +619,48 @@ class Hprof : public SingleRootVisitor {
 
   void WriteClassTable() SHARED_REQUIRES(Locks::mutator_lock_) {
     for (const auto& p : classes_) {
-      mirror::Class* c = p.first;
-      HprofClassSerialNumber sn = p.second;
-      CHECK(c != nullptr);
-      output_->StartNewRecord(HPROF_TAG_LOAD_CLASS, kHprofTime);
-      // LOAD CLASS format:
-      // U4: class serial number (always > 0)
-      // ID: class object ID. We use the address of the class object structure as its ID.
-      // U4: stack trace serial number
-      // ID: class name string ID
-      __ AddU4(sn);
-      __ AddObjectId(c);
-      __ AddStackTraceSerialNumber(LookupStackTraceSerialNumber(c));
-      __ AddStringId(LookupClassNameId(c));
+      WriteClassRecord(output_, p.first, p.second);
     }
   }
 
+  void WriteClassRecord(EndianOutput* out, mirror::Class* c, HprofClassSerialNumber sn)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    CHECK(c != nullptr);
+    out->StartNewRecord(HPROF_TAG_LOAD_CLASS, kHprofTime);
+    // LOAD CLASS format:
+    // U4: class serial number (always > 0)
+    // ID: class object ID. We use the address of the class object structure as its ID.
+    // U4: stack trace serial number
+    // ID: class name string ID
+    out->AddU4(sn);
+    out->AddObjectId(c);
+    out->AddStackTraceSerialNumber(LookupStackTraceSerialNumber(c));
+    out->AddStringId(LookupClassNameId(c));
+  }
+
   void WriteStringTable() {
     for (const std::pair<std::string, HprofStringId>& p : strings_) {
-      const std::string& string = p.first;
-      const size_t id = p.second;
-
-      output_->StartNewRecord(HPROF_TAG_STRING, kHprofTime);
-
-      // STRING format:
-      // ID:  ID for this string
-      // U1*: UTF8 characters for string (NOT null terminated)
-      //      (the record format encodes the length)
-      __ AddU4(id);
-      __ AddUtf8String(string.c_str());
+      WriteStringRecord(output_, p.first, p.second);
     }
   }
 
+  void WriteStringRecord(EndianOutput* out, const std::string& string, HprofStringId id) {
+    out->StartNewRecord(HPROF_TAG_STRING, kHprofTime);
+    // STRING format:
+    // ID:  ID for this string
+    // U1*: UTF8 characters for string (NOT null terminated)
+    //      (the record format encodes the length)
+    out->AddU4(id);
+    out->AddUtf8String(string.c_str());
+  }
+
   void StartNewHeapDumpSegment() {
     // This flushes the old segment and starts a new one.
     output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_SEGMENT, kHprofTime);
+    if (stream_output_ != nullptr && stream_output_->GetData()->size() >= kStreamChunkBytes) {
+      // Only the new segment is incomplete, write out the previous ones.
+      owner_->WriteStreamChunk(stream_output_->GetData());
+    }
     objects_in_segment_ = 0;
     // Starting a new HEAP_DUMP resets the heap to default.
     current_heap_ = HPROF_HEAP_DEFAULT;
@@ -590,11 +681,19 @@ class Hprof : public SingleRootVisitor {
     if (c != nullptr) {
       auto it = classes_.find(c);
       if (it == classes_.end()) {
+        if (owner_ != this) {
+          // First time this worker sees this class, the owner assigns the serial number.
+          classes_.Put(c, owner_->LookupSharedClassSerialNumber(c));
+          return PointerToLowMemUInt32(c);
+        }
         // first time to see this class
         HprofClassSerialNumber sn = next_class_serial_number_++;
         classes_.Put(c, sn);
         // Make sure that we've assigned a string ID for this class' name
         LookupClassNameId(c);
+        if (stream_file_ != nullptr) {
+          pending_classes_.push_back(c);
+        }
       }
     }
     return PointerToLowMemUInt32(c);
@@ -602,13 +701,14 @@ class Hprof : public SingleRootVisitor {
 
   HprofStackTraceSerialNumber LookupStackTraceSerialNumber(const mirror::Object* obj)
       SHARED_REQUIRES(Locks::mutator_lock_) {
-    auto r = allocation_records_.find(obj);
-    if (r == allocation_records_.end()) {
+    // The traces are only read once the dump has started, so the workers share them without lock.
+    auto r = owner_->allocation_records_.find(obj);
+    if (r == owner_->allocation_records_.end()) {
       return kHprofNullStackTrace;
     } else {
       const gc::AllocRecordStackTrace* trace = r->second;
-      auto result = traces_.find(trace);
-      CHECK(result != traces_.end());
+      auto result = owner_->traces_.find(trace);
+      CHECK(result != owner_->traces_.end());
       return result->second;
     }
   }
@@ -626,11 +726,45 @@ class Hprof : public SingleRootVisitor {
     if (it != strings_.end()) {
       return it->second;
     }
-    HprofStringId id = next_string_id_++;
+    HprofStringId id;
+    if (owner_ != this) {
+      id = owner_->LookupSharedStringId(string);
+    } else {
+      id = next_string_id_++;
+      if (stream_file_ != nullptr) {
+        pending_strings_.emplace_back(string, id);
+      }
+    }
     strings_.Put(string, id);
     return id;
   }
 
+  // The owner's side of the lookups of the workers, which only use their own tables as caches.
+  HprofStringId LookupSharedStringId(const std::string& string) REQUIRES(!tables_lock_) {
+    MutexLock mu(Thread::Current(), tables_lock_);
+    return LookupStringId(string);
+  }
+
+  HprofClassSerialNumber LookupSharedClassSerialNumber(mirror::Class* c)
+      REQUIRES(!tables_lock_) SHARED_REQUIRES(Locks::mutator_lock_) {
+    MutexLock mu(Thread::Current(), tables_lock_);
+    LookupClassId(c);
+    return classes_.Get(c);
+  }
+
+  // Whether a simple root record is new. Workers check their own set first.
+  bool AddSimpleRoot(uint64_t key) {
+    if (!simple_roots_.insert(key).second) {
+      return false;
+    }
+    return owner_ == this || owner_->AddSharedSimpleRoot(key);
+  }
+
+  bool AddSharedSimpleRoot(uint64_t key) REQUIRES(!tables_lock_) {
+    MutexLock mu(Thread::Current(), tables_lock_);
+    return simple_roots_.insert(key).second;
+  }
+
   HprofStringId LookupClassNameId(mirror::Class* c) SHARED_REQUIRES(Locks::mutator_lock_) {
     return LookupStringId(PrettyDescriptor(c));
   }
@@ -734,26 +868,49 @@ class Hprof : public SingleRootVisitor {
     //        Dbg::DdmSendChunkV(CHUNK_TYPE("HPDS"), iov, 2);
   }
 
-  bool DumpToFile(size_t overall_size, size_t max_length)
-      REQUIRES(Locks::mutator_lock_) {
+  // Returns null and throws if the output file cannot be opened.
+  File* OpenOutputFile() SHARED_REQUIRES(Locks::mutator_lock_) {
     // Where exactly are we writing to?
     int out_fd;
     if (fd_ >= 0) {
       out_fd = dup(fd_);
       if (out_fd < 0) {
         ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
-        return false;
+        return nullptr;
       }
     } else {
       out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
       if (out_fd < 0) {
         ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
                               strerror(errno));
-        return false;
+        return nullptr;
       }
     }
+    return new File(out_fd, filename_, true);
+  }
 
-    std::unique_ptr<File> file(new File(out_fd, filename_, true));
+  // Closes the output file, or erases it and throws if the dump failed.
+  bool CloseOutputFile(File* file, bool okay) SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (okay) {
+      okay = file->FlushCloseOrErase() == 0;
+    } else {
+      file->Erase();
+    }
+    if (!okay) {
+      std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
+                                   filename_.c_str(), strerror(errno)));
+      ThrowRuntimeException("%s", msg.c_str());
+      LOG(ERROR) << msg;
+    }
+    return okay;
+  }
+
+  bool DumpToFile(size_t overall_size, size_t max_length)
+      REQUIRES(Locks::mutator_lock_) {
+    std::unique_ptr<File> file(OpenOutputFile());
+    if (file == nullptr) {
+      return false;
+    }
     bool okay;
     {
       FileEndianOutput file_output(file.get(), max_length);
@@ -768,20 +925,107 @@ class Hprof : public SingleRootVisitor {
       }
       output_ = nullptr;
     }
+    return CloseOutputFile(file.get(), okay);
+  }
 
-    if (okay) {
-      okay = file->FlushCloseOrErase() == 0;
-    } else {
-      file->Erase();
+  // Write the dump in a single pass, without measuring it first. The records of the string and
+  // class tables are written as they are discovered, before the first chunk which may refer to
+  // them; this is valid HPROF but jhat, which wants them first, needs DumpToFile() instead.
+  bool DumpToFileStreaming() REQUIRES(Locks::mutator_lock_) {
+    std::unique_ptr<File> file(OpenOutputFile());
+    if (file == nullptr) {
+      return false;
     }
-    if (!okay) {
-      std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
-                                   filename_.c_str(), strerror(errno)));
-      ThrowRuntimeException("%s", msg.c_str());
-      LOG(ERROR) << msg;
+    Runtime* const runtime = Runtime::Current();
+    stream_file_ = file.get();
+    stream_output_.reset(new VectorEndianOutput(kMaxBytesPerSegment));
+    output_ = stream_output_.get();
+    current_heap_ = HPROF_HEAP_DEFAULT;
+    objects_in_segment_ = 0;
+
+    // The fixed header goes out before any string or class.
+    WriteFixedHeader();
+    FlushStreamOutput();
+    // Stack frames refer to the classes of their methods.
+    for (const auto& it : frames_) {
+      LookupClassId(it.first->GetMethod()->GetDeclaringClass());
     }
+    WriteStackTraces();
+    FlushStreamOutput();
 
-    return okay;
+    // The roots are written by this thread, the objects by one worker per thread.
+    output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_SEGMENT, kHprofTime);
+    simple_roots_.clear();
+    runtime->VisitRoots(this);
+    runtime->VisitImageRoots(this);
+    FlushStreamOutput();
+    const size_t num_workers = (thread_pool_ != nullptr) ? thread_pool_->GetThreadCount() + 1 : 1;
+    for (size_t i = 0; i < num_workers; ++i) {
+      workers_.emplace_back(new Hprof(this));
+      workers_.back()->StartNewHeapDumpSegment();
+    }
+    runtime->GetHeap()->VisitObjectsPausedParallel(thread_pool_, VisitObjectParallelCallback, this);
+    for (const std::unique_ptr<Hprof>& worker : workers_) {
+      worker->FlushStreamOutput();
+      total_objects_ += worker->total_objects_;
+    }
+    workers_.clear();
+
+    output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_END, kHprofTime);
+    FlushStreamOutput();
+    output_ = nullptr;
+    stream_output_.reset();
+    stream_file_ = nullptr;
+    return CloseOutputFile(file.get(), !stream_errors_);
+  }
+
+  // Ends the current record and writes out the buffer of this thread.
+  void FlushStreamOutput() SHARED_REQUIRES(Locks::mutator_lock_) {
+    stream_output_->EndRecord();
+    owner_->WriteStreamChunk(stream_output_->GetData());
+  }
+
+  // Write out, then clear, a chunk of complete records of any thread. The string and class records
+  // which are not written yet go first, since the chunk may refer to them.
+  void WriteStreamChunk(std::vector<uint8_t>* chunk)
+      REQUIRES(!tables_lock_) SHARED_REQUIRES(Locks::mutator_lock_) {
+    DCHECK_EQ(owner_, this);
+    if (chunk->empty()) {
+      return;
+    }
+    // Each thread compresses its own chunks, outside of the lock.
+    std::vector<uint8_t> compressed;
+    const bool compressed_okay = !gzip_ || GzipCompress(*chunk, &compressed);
+    MutexLock mu(Thread::Current(), tables_lock_);
+    if (!pending_strings_.empty() || !pending_classes_.empty()) {
+      VectorEndianOutput tables_output(kMaxBytesPerSegment);
+      for (const std::pair<std::string, HprofStringId>& p : pending_strings_) {
+        WriteStringRecord(&tables_output, p.first, p.second);
+      }
+      for (mirror::Class* c : pending_classes_) {
+        WriteClassRecord(&tables_output, c, classes_.Get(c));
+      }
+      tables_output.EndRecord();
+      pending_strings_.clear();
+      pending_classes_.clear();
+      if (gzip_) {
+        std::vector<uint8_t> compressed_tables;
+        stream_errors_ |= !GzipCompress(*tables_output.GetData(), &compressed_tables);
+        WriteStreamBytesLocked(compressed_tables);
+      } else {
+        WriteStreamBytesLocked(*tables_output.GetData());
+      }
+    }
+    stream_errors_ |= !compressed_okay;
+    WriteStreamBytesLocked(gzip_ ? compressed : *chunk);
+    chunk->clear();
+  }
+
+  void WriteStreamBytesLocked(const std::vector<uint8_t>& bytes) REQUIRES(tables_lock_) {
+    if (!stream_errors_) {
+      stream_errors_ = !stream_file_->WriteFully(bytes.data(), bytes.size());
+      stream_bytes_written_ += bytes.size();
+    }
   }
 
   bool DumpToDdmsDirect(size_t overall_size, size_t max_length, uint32_t chunk_type)
@@ -862,6 +1106,26 @@ class Hprof : public SingleRootVisitor {
   int fd_;
   bool direct_to_ddms_;
 
+  // The workers of a parallel dump, or null. This, `gzip_` or `streaming_` selects
+  // DumpToFileStreaming() over the default two-pass DumpToFile().
+  ThreadPool* const thread_pool_;
+  const bool gzip_;
+  const bool streaming_;
+
+  // The Hprof which owns the string and class tables: this, or the one that created this worker.
+  Hprof* const owner_;
+  // Guards the tables of the owner while the workers walk the heap, and the output file.
+  Mutex tables_lock_;
+  std::vector<std::unique_ptr<Hprof>> workers_;
+  // The buffer of a streaming dump, for both the owner and the workers.
+  std::unique_ptr<VectorEndianOutput> stream_output_;
+  // The output of the owner of a streaming dump, and the records it has not written yet.
+  File* stream_file_ = nullptr;
+  std::vector<std::pair<std::string, HprofStringId>> pending_strings_;
+  std::vector<mirror::Class*> pending_classes_;
+  size_t stream_bytes_written_ = 0u;
+  bool stream_errors_ = false;
+
   uint64_t start_ns_ = NanoTime();
 
   EndianOutput* output_ = nullptr;
@@ -973,7 +1237,7 @@ void Hprof::MarkRootObject(const mirror::Object* obj, jobject jni_obj, HprofHeap
     case HPROF_ROOT_DEBUGGER:
     case HPROF_ROOT_VM_INTERNAL: {
       uint64_t key = (static_cast<uint64_t>(heap_tag) << 32) | PointerToLowMemUInt32(obj);
-      if (simple_roots_.insert(key).second) {
+      if (AddSimpleRoot(key)) {
         __ AddU1(heap_tag);
         __ AddObjectId(obj);
       }
@@ -1353,6 +1617,8 @@ void Hprof::DumpHeapInstanceObject(mirror::Object* obj, mirror::Class* klass) {
         // If string is empty, use an object-aligned address within the string for the value.
         string_value = reinterpret_cast<mirror::Object*>(
             reinterpret_cast<uintptr_t>(s) + kObjectAlignment);
+      } else if (s->IsCompressed()) {
+        string_value = reinterpret_cast<mirror::Object*>(s->GetValueCompressed());
       } else {
         string_value = reinterpret_cast<mirror::Object*>(s->GetValue());
       }
@@ -1374,7 +1640,15 @@ void Hprof::DumpHeapInstanceObject(mirror::Object* obj, mirror::Class* klass) {
     __ AddStackTraceSerialNumber(LookupStackTraceSerialNumber(obj));
     __ AddU4(s->GetLength());
     __ AddU1(hprof_basic_char);
-    __ AddU2List(s->GetValue(), s->GetLength());
+    if (s->IsCompressed()) {
+      // Dump the chars of a compressed string as UTF-16 too.
+      const uint8_t* chars = s->GetValueCompressed();
+      for (int32_t i = 0; i < s->GetLength(); ++i) {
+        __ AddU2(chars[i]);
+      }
+    } else {
+      __ AddU2List(s->GetValue(), s->GetLength());
+    }
   }
 }
 
@@ -1407,7 +1681,8 @@ void Hprof::VisitRoot(mirror::Object* obj, const RootInfo& info) {
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
 // Otherwise, "filename" is used to create an output file.
-void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms, size_t num_threads, bool gzip,
+              bool streaming) {
   CHECK(filename != nullptr);
 
   Thread* self = Thread::Current();
@@ -1417,15 +1692,27 @@ void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
     // comment in Heap::VisitObjects().
     heap->IncrementDisableMovingGC(self);
   }
+  // The workers attach to the runtime, so they are created before suspending all threads.
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (!direct_to_ddms && num_threads > 1) {
+    thread_pool.reset(new ThreadPool("Hprof thread pool", num_threads - 1));
+  }
   {
     ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
-    Hprof hprof(filename, fd, direct_to_ddms);
+    Hprof hprof(filename, fd, direct_to_ddms, thread_pool.get(), gzip, streaming);
     hprof.Dump();
   }
+  thread_pool.reset();
   if (heap->IsGcConcurrentAndMoving()) {
     heap->DecrementDisableMovingGC(self);
   }
 }
 
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
+  Runtime* const runtime = Runtime::Current();
+  DumpHeap(filename, fd, direct_to_ddms, runtime->GetHprofDumpThreads(),
+           runtime->IsHprofGzipEnabled(), runtime->IsHprofStreamingEnabled());
+}
+
 }  // namespace hprof
 }  // namespace art
@@ -17,12 +17,23 @@
 #ifndef ART_RUNTIME_HPROF_HPROF_H_
 #define ART_RUNTIME_HPROF_HPROF_H_
 
+#include <stddef.h>
+
 namespace art {
 
 namespace hprof {
 
+// Dump the heap with the -XX:HprofDumpThreads, -XX:HprofCompression and -XX:HprofStreaming
+// settings of the runtime.
 void DumpHeap(const char* filename, int fd, bool direct_to_ddms);
 
+// Unless the dump goes to DDMS, walk the heap with `num_threads` threads and gzip the output if
+// asked to. By default the file is written in two passes, with all string and class records in
+// front of the heap dump. With `streaming`, more than one thread or `gzip` it is written in a
+// single pass instead, with those records interleaved with the heap dump segments.
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms, size_t num_threads, bool gzip,
+              bool streaming);
+
 }  // namespace hprof
 
 }  // namespace art
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hprof.h"
+
+#include <zlib.h>
+
+#include <set>
+
+#include "common_runtime_test.h"
+#include "utils.h"
+
+namespace art {
+namespace hprof {
+
+class HprofTest : public CommonRuntimeTest {
+ protected:
+  // Inflate all of the members of a gzip file.
+  static bool Gunzip(const std::string& in, std::string* out) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // Add 32 to the window bits to accept a gzip header.
+    if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) {
+      return false;
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    stream.avail_in = in.size();
+    uint8_t buffer[64 * KB];
+    int result = Z_OK;
+    while (stream.avail_in != 0) {
+      stream.next_out = buffer;
+      stream.avail_out = sizeof(buffer);
+      result = inflate(&stream, Z_NO_FLUSH);
+      out->append(reinterpret_cast<char*>(buffer), sizeof(buffer) - stream.avail_out);
+      if (result == Z_STREAM_END) {
+        inflateReset(&stream);
+      } else if (result != Z_OK) {
+        break;
+      }
+    }
+    inflateEnd(&stream);
+    return result == Z_STREAM_END;
+  }
+
+  static uint32_t ReadU4(const std::string& data, size_t offset) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data()) + offset;
+    return (bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+  }
+
+  // Check that the records exactly cover the dump, that it ends with a HEAP_DUMP_END record, and
+  // that the class records only refer to strings which came before them. With `tables_first`, also
+  // check that no string or class record follows a heap dump segment.
+  static void CheckRecords(const std::string& data, bool tables_first) {
+    static constexpr char kMagic[] = "JAVA PROFILE 1.0.3";
+    ASSERT_GT(data.size(), sizeof(kMagic));
+    ASSERT_EQ(0, memcmp(data.data(), kMagic, sizeof(kMagic)));
+    std::set<uint32_t> strings;
+    size_t num_classes = 0;
+    size_t num_segments = 0;
+    uint8_t last_tag = 0;
+    // The magic string is followed by the size of the identifiers and the time.
+    size_t offset = sizeof(kMagic) + 3 * sizeof(uint32_t);
+    while (offset < data.size()) {
+      ASSERT_LE(offset + 9, data.size());
+      last_tag = data[offset];
+      const uint32_t length = ReadU4(data, offset + 5);
+      ASSERT_LE(offset + 9 + length, data.size());
+      if (tables_first && (last_tag == 0x01 || last_tag == 0x02)) {
+        EXPECT_EQ(0u, num_segments);
+      }
+      if (last_tag == 0x01) {  // STRING
+        strings.insert(ReadU4(data, offset + 9));
+      } else if (last_tag == 0x02) {  // LOAD_CLASS
+        ++num_classes;
+        EXPECT_EQ(1u, strings.count(ReadU4(data, offset + 9 + 12)));
+      } else if (last_tag == 0x1C) {  // HEAP_DUMP_SEGMENT
+        ++num_segments;
+      }
+      offset += 9 + length;
+    }
+    EXPECT_EQ(data.size(), offset);
+    EXPECT_EQ(0x2C, last_tag);  // HEAP_DUMP_END
+    EXPECT_GT(num_classes, 0u);
+    EXPECT_GT(num_segments, 1u);
+  }
+};
+TEST_F(HprofTest, TwoPassDump) {
+  ScratchFile file;
+  DumpHeap(file.GetFilename().c_str(), -1, false, 1, false, false);
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(file.GetFilename(), &contents));
+  CheckRecords(contents, true);
+}
+
+TEST_F(HprofTest, StreamingDump) {
+  ScratchFile file;
+  DumpHeap(file.GetFilename().c_str(), -1, false, 1, false, true);
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(file.GetFilename(), &contents));
+  CheckRecords(contents, false);
+}
+
+TEST_F(HprofTest, ParallelStreamingDump) {
+  ScratchFile file;
+  DumpHeap(file.GetFilename().c_str(), -1, false, 4, false, false);
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(file.GetFilename(), &contents));
+  CheckRecords(contents, false);
+}
+
+TEST_F(HprofTest, GzipStreamingDump) {
+  ScratchFile file;
+  DumpHeap(file.GetFilename().c_str(), -1, false, 4, true, false);
+  std::string compressed;
+  ASSERT_TRUE(ReadFileToString(file.GetFilename(), &compressed));
+  ASSERT_GT(compressed.size(), 2u);
+  EXPECT_EQ(0x1f, static_cast<uint8_t>(compressed[0]));
+  EXPECT_EQ(0x8b, static_cast<uint8_t>(compressed[1]));
+  std::string contents;
+  ASSERT_TRUE(Gunzip(compressed, &contents));
+  EXPECT_GT(contents.size(), compressed.size());
+  CheckRecords(contents, false);
+}
+
+}  // namespace hprof
+}  // namespace art
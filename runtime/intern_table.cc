@@ -16,6 +16,7 @@
 
 #include "intern_table.h"
 
+#include <iterator>
 #include <memory>
 
 #include "gc_root-inl.h"
@@ -27,31 +28,53 @@
 #include "mirror/object_array-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/string-inl.h"
+#include "scoped_thread_state_change.h"
 #include "thread.h"
+#include "thread_list.h"
 #include "utf.h"
 
 namespace art {
 
+InternTable::Shard::Shard()
+    : lock_("InternTable shard lock", kInternTableShardLock),
+      weak_intern_condition_("New intern condition", lock_),
+      log_new_roots_(false) {
+}
+
 InternTable::InternTable()
     : images_added_to_intern_table_(false),
-      log_new_roots_(false),
-      weak_intern_condition_("New intern condition", *Locks::intern_table_lock_),
       weak_root_state_(gc::kWeakRootStateNormal) {
 }
 
+InternTable::Shard* InternTable::GetShard(int32_t hash) {
+  // Take the top bits of a multiplicative hash, so that the strings of a shard are still spread
+  // over all of the buckets of its sets.
+  return &shards_[(static_cast<uint32_t>(hash) * 0x9e3779b1u) >> (32 - kShardBits)];
+}
+
 size_t InternTable::Size() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size() + weak_interns_.Size();
+  return StrongSize() + WeakSize();
 }
 
 size_t InternTable::StrongSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size();
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  size_t size = image_strong_interns_.Size();
+  for (const Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock_);
+    size += shard.strong_interns_.Size();
+  }
+  return size;
 }
 
 size_t InternTable::WeakSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return weak_interns_.Size();
+  Thread* const self = Thread::Current();
+  size_t size = 0;
+  for (const Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    size += shard.weak_interns_.Size();
+  }
+  return size;
 }
 
 void InternTable::DumpForSigQuit(std::ostream& os) const {
@@ -59,42 +82,61 @@ void InternTable::DumpForSigQuit(std::ostream& os) const {
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* const self = Thread::Current();
   if ((flags & kVisitRootFlagAllRoots) != 0) {
-    strong_interns_.VisitRoots(visitor);
-  } else if ((flags & kVisitRootFlagNewRoots) != 0) {
-    for (auto& root : new_strong_intern_roots_) {
-      mirror::String* old_ref = root.Read<kWithoutReadBarrier>();
-      root.VisitRoot(visitor, RootInfo(kRootInternedString));
-      mirror::String* new_ref = root.Read<kWithoutReadBarrier>();
-      if (new_ref != old_ref) {
-        // The GC moved a root in the log. Need to search the strong interns and update the
-        // corresponding object. This is slow, but luckily for us, this may only happen with a
-        // concurrent moving GC.
-        strong_interns_.Remove(old_ref);
-        strong_interns_.Insert(new_ref);
+    MutexLock mu(self, *Locks::intern_table_lock_);
+    image_strong_interns_.VisitRoots(visitor);
+  }
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    if ((flags & kVisitRootFlagAllRoots) != 0) {
+      shard.strong_interns_.VisitRoots(visitor);
+    } else if ((flags & kVisitRootFlagNewRoots) != 0) {
+      for (auto& root : shard.new_strong_intern_roots_) {
+        mirror::String* old_ref = root.Read<kWithoutReadBarrier>();
+        root.VisitRoot(visitor, RootInfo(kRootInternedString));
+        mirror::String* new_ref = root.Read<kWithoutReadBarrier>();
+        if (new_ref != old_ref) {
+          // The GC moved a root in the log. Need to search the strong interns and update the
+          // corresponding object. This is slow, but luckily for us, this may only happen with a
+          // concurrent moving GC.
+          shard.strong_interns_.Remove(old_ref);
+          shard.strong_interns_.Insert(new_ref);
+        }
       }
     }
-  }
-  if ((flags & kVisitRootFlagClearRootLog) != 0) {
-    new_strong_intern_roots_.clear();
-  }
-  if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
-    log_new_roots_ = true;
-  } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
-    log_new_roots_ = false;
+    if ((flags & kVisitRootFlagClearRootLog) != 0) {
+      shard.new_strong_intern_roots_.clear();
+    }
+    if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
+      shard.log_new_roots_ = true;
+    } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
+      shard.log_new_roots_ = false;
+    }
   }
   // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
 }
 
 mirror::String* InternTable::LookupWeak(Thread* self, mirror::String* s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupWeakLocked(s);
+  Shard* const shard = GetShard(s->GetHashCode());
+  if (CanReadWeakInterns(self)) {
+    mirror::String* weak = shard->weak_interns_.Find(s);
+    if (weak != nullptr) {
+      return weak;
+    }
+  }
+  MutexLock mu(self, shard->lock_);
+  return LookupWeakLocked(shard, s);
 }
 
 mirror::String* InternTable::LookupStrong(Thread* self, mirror::String* s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupStrongLocked(s);
+  Shard* const shard = GetShard(s->GetHashCode());
+  mirror::String* strong = LookupLockFree(self, shard, s, /* is_strong */ true);
+  if (strong != nullptr) {
+    return strong;
+  }
+  MutexLock mu(self, shard->lock_);
+  return LookupStrongLocked(shard, s);
 }
 
 mirror::String* InternTable::LookupStrong(Thread* self,
@@ -104,77 +146,121 @@ mirror::String* InternTable::LookupStrong(Thread* self,
   Utf8String string(utf16_length,
                     utf8_data,
                     ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length));
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(string);
+  mirror::String* strong = image_strong_interns_.Find(string);
+  if (strong != nullptr) {
+    return strong;
+  }
+  Shard* const shard = GetShard(string.GetHash());
+  strong = shard->strong_interns_.Find(string);
+  if (strong != nullptr) {
+    return strong;
+  }
+  MutexLock mu(self, shard->lock_);
+  return shard->strong_interns_.Find(string);
 }
 
-mirror::String* InternTable::LookupWeakLocked(mirror::String* s) {
-  return weak_interns_.Find(s);
+bool InternTable::CanReadWeakInterns(Thread* self) const {
+  return kUseReadBarrier
+      ? self->GetWeakRefAccessEnabled()
+      : weak_root_state_.LoadRelaxed() == gc::kWeakRootStateNormal;
 }
 
-mirror::String* InternTable::LookupStrongLocked(mirror::String* s) {
-  return strong_interns_.Find(s);
+mirror::String* InternTable::LookupLockFree(Thread* self,
+                                            Shard* shard,
+                                            mirror::String* s,
+                                            bool is_strong) {
+  mirror::String* strong = image_strong_interns_.Find(s);
+  if (strong == nullptr) {
+    strong = shard->strong_interns_.Find(s);
+  }
+  if (strong != nullptr || is_strong) {
+    return strong;
+  }
+  // The weak interns are swept while they may not be read. A thread only sees a change of the
+  // weak root state at a suspend point, and there is none until the lookup completes.
+  return CanReadWeakInterns(self) ? shard->weak_interns_.Find(s) : nullptr;
+}
+
+mirror::String* InternTable::LookupWeakLocked(Shard* shard, mirror::String* s) {
+  return shard->weak_interns_.Find(s);
+}
+
+mirror::String* InternTable::LookupStrongLocked(Shard* shard, mirror::String* s) {
+  mirror::String* strong = image_strong_interns_.Find(s);
+  return (strong != nullptr) ? strong : shard->strong_interns_.Find(s);
 }
 
 void InternTable::AddNewTable() {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.AddNewTable();
-  strong_interns_.AddNewTable();
+  Thread* const self = Thread::Current();
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_interns_.AddNewTable();
+    shard.strong_interns_.AddNewTable();
+  }
 }
 
-mirror::String* InternTable::InsertStrong(mirror::String* s) {
+mirror::String* InternTable::InsertStrong(Shard* shard, mirror::String* s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordStrongStringInsertion(s);
   }
-  if (log_new_roots_) {
-    new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
+  if (shard->log_new_roots_) {
+    shard->new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
   }
-  strong_interns_.Insert(s);
+  shard->strong_interns_.Insert(s);
   return s;
 }
 
-mirror::String* InternTable::InsertWeak(mirror::String* s) {
+mirror::String* InternTable::InsertWeak(Shard* shard, mirror::String* s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordWeakStringInsertion(s);
   }
-  weak_interns_.Insert(s);
+  shard->weak_interns_.Insert(s);
   return s;
 }
 
-void InternTable::RemoveStrong(mirror::String* s) {
-  strong_interns_.Remove(s);
+void InternTable::RemoveStrong(Shard* shard, mirror::String* s) {
+  shard->strong_interns_.Remove(s);
 }
 
-void InternTable::RemoveWeak(mirror::String* s) {
+void InternTable::RemoveWeak(Shard* shard, mirror::String* s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordWeakStringRemoval(s);
   }
-  weak_interns_.Remove(s);
+  shard->weak_interns_.Remove(s);
 }
 
 // Insert/remove methods used to undo changes made during an aborted transaction.
 mirror::String* InternTable::InsertStrongFromTransaction(mirror::String* s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertStrong(s);
+  Shard* const shard = GetShard(s->GetHashCode());
+  MutexLock mu(Thread::Current(), shard->lock_);
+  return InsertStrong(shard, s);
 }
 mirror::String* InternTable::InsertWeakFromTransaction(mirror::String* s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertWeak(s);
+  Shard* const shard = GetShard(s->GetHashCode());
+  MutexLock mu(Thread::Current(), shard->lock_);
+  return InsertWeak(shard, s);
 }
 void InternTable::RemoveStrongFromTransaction(mirror::String* s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveStrong(s);
+  Shard* const shard = GetShard(s->GetHashCode());
+  MutexLock mu(Thread::Current(), shard->lock_);
+  RemoveStrong(shard, s);
 }
 void InternTable::RemoveWeakFromTransaction(mirror::String* s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveWeak(s);
+  Shard* const shard = GetShard(s->GetHashCode());
+  MutexLock mu(Thread::Current(), shard->lock_);
+  RemoveWeak(shard, s);
 }
 
 void InternTable::AddImagesStringsToTable(const std::vector<gc::space::ImageSpace*>& image_spaces) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
   for (gc::space::ImageSpace* image_space : image_spaces) {
     const ImageHeader* const header = &image_space->GetImageHeader();
     // Check if we have the interned strings section.
@@ -189,11 +275,14 @@ void InternTable::AddImagesStringsToTable(const std::vector<gc::space::ImageSpac
         mirror::DexCache* dex_cache = dex_caches->Get(i);
         const size_t num_strings = dex_cache->NumStrings();
         for (size_t j = 0; j < num_strings; ++j) {
-          mirror::String* image_string = dex_cache->GetResolvedString(j);
+          uint32_t string_idx;
+          mirror::String* image_string = dex_cache->GetStringSlot(j, &string_idx);
           if (image_string != nullptr) {
-            mirror::String* found = LookupStrongLocked(image_string);
+            Shard* const shard = GetShard(image_string->GetHashCode());
+            MutexLock mu2(self, shard->lock_);
+            mirror::String* found = LookupStrongLocked(shard, image_string);
             if (found == nullptr) {
-              InsertStrong(image_string);
+              InsertStrong(shard, image_string);
             } else {
               DCHECK_EQ(found, image_string);
             }
@@ -202,11 +291,11 @@ void InternTable::AddImagesStringsToTable(const std::vector<gc::space::ImageSpac
       }
     }
   }
-  images_added_to_intern_table_ = true;
+  images_added_to_intern_table_.StoreRelaxed(true);
 }
 
 mirror::String* InternTable::LookupStringFromImage(mirror::String* s) {
-  DCHECK(!images_added_to_intern_table_);
+  DCHECK(!images_added_to_intern_table_.LoadRelaxed());
   const std::vector<gc::space::ImageSpace*>& image_spaces =
       Runtime::Current()->GetHeap()->GetBootImageSpaces();
   if (image_spaces.empty()) {
@@ -237,20 +326,29 @@ mirror::String* InternTable::LookupStringFromImage(mirror::String* s) {
 void InternTable::BroadcastForNewInterns() {
   CHECK(kUseReadBarrier);
   Thread* self = Thread::Current();
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  weak_intern_condition_.Broadcast(self);
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_intern_condition_.Broadcast(self);
+  }
 }
 
-void InternTable::WaitUntilAccessible(Thread* self) {
-  Locks::intern_table_lock_->ExclusiveUnlock(self);
+void InternTable::WaitUntilAccessible(Thread* self, Shard* shard) {
+  shard->lock_.ExclusiveUnlock(self);
   {
     ScopedThreadSuspension sts(self, kWaitingWeakGcRootRead);
-    MutexLock mu(self, *Locks::intern_table_lock_);
-    while (weak_root_state_ == gc::kWeakRootStateNoReadsOrWrites) {
-      weak_intern_condition_.Wait(self);
+    MutexLock mu(self, shard->lock_);
+    while (weak_root_state_.LoadRelaxed() == gc::kWeakRootStateNoReadsOrWrites) {
+      shard->weak_intern_condition_.Wait(self);
     }
   }
-  Locks::intern_table_lock_->ExclusiveLock(self);
+  shard->lock_.ExclusiveLock(self);
+}
+
+void InternTable::ReclaimRetired(RetiredStorage* retired) {
+  // The lock free readers never suspend during a lookup.
+  Runtime::Current()->GetThreadList()->RunEmptyCheckpoint();
+  retired->snapshots.clear();
+  retired->sets.clear();
 }
 
 mirror::String* InternTable::Insert(mirror::String* s, bool is_strong, bool holding_locks) {
@@ -258,7 +356,34 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong, bool hold
     return nullptr;
   }
   Thread* const self = Thread::Current();
-  MutexLock mu(self, *Locks::intern_table_lock_);
+  Shard* const shard = GetShard(s->GetHashCode());
+  // Most strings are already interned, find them without locking.
+  mirror::String* result = LookupLockFree(self, shard, s, is_strong);
+  if (result != nullptr) {
+    return result;
+  }
+  RetiredStorage retired;
+  {
+    MutexLock mu(self, shard->lock_);
+    result = InsertLocked(self, shard, s, is_strong, holding_locks);
+    if (!holding_locks) {
+      shard->strong_interns_.TakeRetired(&retired);
+      shard->weak_interns_.TakeRetired(&retired);
+    }
+  }
+  if (!retired.Empty()) {
+    StackHandleScope<1> hs(self);
+    auto h = hs.NewHandleWrapper(&result);
+    ReclaimRetired(&retired);
+  }
+  return result;
+}
+
+mirror::String* InternTable::InsertLocked(Thread* self,
+                                          Shard* shard,
+                                          mirror::String* s,
+                                          bool is_strong,
+                                          bool holding_locks) {
   if (kDebugLocking && !holding_locks) {
     Locks::mutator_lock_->AssertSharedHeld(self);
     CHECK_EQ(2u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
@@ -266,17 +391,18 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong, bool hold
   while (true) {
     if (holding_locks) {
       if (!kUseReadBarrier) {
-        CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+        CHECK_EQ(weak_root_state_.LoadRelaxed(), gc::kWeakRootStateNormal);
       } else {
         CHECK(self->GetWeakRefAccessEnabled());
       }
     }
     // Check the strong table for a match.
-    mirror::String* strong = LookupStrongLocked(s);
+    mirror::String* strong = LookupStrongLocked(shard, s);
     if (strong != nullptr) {
       return strong;
     }
-    if ((!kUseReadBarrier && weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites) ||
+    if ((!kUseReadBarrier &&
+         weak_root_state_.LoadRelaxed() != gc::kWeakRootStateNoReadsOrWrites) ||
         (kUseReadBarrier && self->GetWeakRefAccessEnabled())) {
       break;
     }
@@ -286,32 +412,32 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong, bool hold
     CHECK(!holding_locks);
     StackHandleScope<1> hs(self);
     auto h = hs.NewHandleWrapper(&s);
-    WaitUntilAccessible(self);
+    WaitUntilAccessible(self, shard);
   }
   if (!kUseReadBarrier) {
-    CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+    CHECK_EQ(weak_root_state_.LoadRelaxed(), gc::kWeakRootStateNormal);
   } else {
     CHECK(self->GetWeakRefAccessEnabled());
   }
   // There is no match in the strong table, check the weak table.
-  mirror::String* weak = LookupWeakLocked(s);
+  mirror::String* weak = LookupWeakLocked(shard, s);
   if (weak != nullptr) {
     if (is_strong) {
       // A match was found in the weak table. Promote to the strong table.
-      RemoveWeak(weak);
-      return InsertStrong(weak);
+      RemoveWeak(shard, weak);
+      return InsertStrong(shard, weak);
     }
     return weak;
   }
   // Check the image for a match.
-  if (!images_added_to_intern_table_) {
+  if (!images_added_to_intern_table_.LoadRelaxed()) {
     mirror::String* const image_string = LookupStringFromImage(s);
     if (image_string != nullptr) {
-      return is_strong ? InsertStrong(image_string) : InsertWeak(image_string);
+      return is_strong ? InsertStrong(shard, image_string) : InsertWeak(shard, image_string);
     }
   }
   // No match in the strong table or the weak table. Insert into the strong / weak table.
-  return is_strong ? InsertStrong(s) : InsertWeak(s);
+  return is_strong ? InsertStrong(shard, s) : InsertWeak(shard, s);
 }
 
 mirror::String* InternTable::InternStrong(int32_t utf16_length, const char* utf8_data) {
@@ -343,8 +469,11 @@ bool InternTable::ContainsWeak(mirror::String* s) {
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.SweepWeaks(visitor);
+  Thread* const self = Thread::Current();
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_interns_.SweepWeaks(visitor);
+  }
 }
 
 size_t InternTable::AddTableFromMemory(const uint8_t* ptr) {
@@ -353,12 +482,38 @@ size_t InternTable::AddTableFromMemory(const uint8_t* ptr) {
 }
 
 size_t InternTable::AddTableFromMemoryLocked(const uint8_t* ptr) {
-  return strong_interns_.AddTableFromMemory(ptr);
+  size_t read_count = 0;
+  std::unique_ptr<UnorderedSet> set(new UnorderedSet(ptr, /*make copy*/false, &read_count));
+  if (set->Empty()) {
+    // Avoid inserting empty sets.
+    return read_count;
+  }
+  // TODO: Disable this for app images if app images have intern tables.
+  static constexpr bool kCheckDuplicates = true;
+  if (kCheckDuplicates) {
+    Thread* const self = Thread::Current();
+    for (GcRoot<mirror::String>& string : *set) {
+      Shard* const shard = GetShard(string.Read()->GetHashCode());
+      MutexLock mu(self, shard->lock_);
+      CHECK(LookupStrongLocked(shard, string.Read()) == nullptr)
+          << "Already found " << string.Read()->ToModifiedUtf8();
+    }
+  }
+  image_strong_interns_.AddTableToFront(set.release());
+  return read_count;
 }
 
 size_t InternTable::WriteToMemory(uint8_t* ptr) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.WriteToMemory(ptr);
+  // The shards are combined into a single set, which is added as an image table when read back.
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  UnorderedSet combined;
+  image_strong_interns_.CopyTo(&combined);
+  for (Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock_);
+    shard.strong_interns_.CopyTo(&combined);
+  }
+  return combined.WriteToMemory(ptr);
 }
 
 std::size_t InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& root) const {
@@ -368,12 +523,15 @@ std::size_t InternTable::StringHashEquals::operator()(const GcRoot<mirror::Strin
   return static_cast<size_t>(root.Read()->GetHashCode());
 }
 
+// The equality functions are also called by lock free readers, for which a slot may be cleared
+// between the check that it is not empty and the comparison.
 bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
                                                const GcRoot<mirror::String>& b) const {
   if (kIsDebugBuild) {
     Locks::mutator_lock_->AssertSharedHeld(Thread::Current());
   }
-  return a.Read()->Equals(b.Read());
+  mirror::String* a_string = a.Read();
+  return a_string != nullptr && a_string->Equals(b.Read());
 }
 
 bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
@@ -382,57 +540,72 @@ bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
     Locks::mutator_lock_->AssertSharedHeld(Thread::Current());
   }
   mirror::String* a_string = a.Read();
+  if (a_string == nullptr) {
+    return false;
+  }
   uint32_t a_length = static_cast<uint32_t>(a_string->GetLength());
   if (a_length != b.GetUtf16Length()) {
     return false;
   }
+  if (a_string->IsCompressed()) {
+    const uint8_t* a_value = a_string->GetValueCompressed();
+    return CompareModifiedUtf8ToUtf16AsCodePointValues(b.GetUtf8Data(), a_value, a_length) == 0;
+  }
   const uint16_t* a_value = a_string->GetValue();
   return CompareModifiedUtf8ToUtf16AsCodePointValues(b.GetUtf8Data(), a_value, a_length) == 0;
 }
 
-size_t InternTable::Table::AddTableFromMemory(const uint8_t* ptr) {
-  size_t read_count = 0;
-  UnorderedSet set(ptr, /*make copy*/false, &read_count);
-  if (set.Empty()) {
-    // Avoid inserting empty sets.
-    return read_count;
-  }
-  // TODO: Disable this for app images if app images have intern tables.
-  static constexpr bool kCheckDuplicates = true;
-  if (kCheckDuplicates) {
-    for (GcRoot<mirror::String>& string : set) {
-      CHECK(Find(string.Read()) == nullptr) << "Already found " << string.Read()->ToModifiedUtf8();
-    }
-  }
-  // Insert at the front since we add new interns into the back.
-  tables_.insert(tables_.begin(), std::move(set));
-  return read_count;
+InternTable::Table::Table() : snapshot_(nullptr) {
+  Runtime* const runtime = Runtime::Current();
+  // Initial table.
+  UnorderedSet* set = new UnorderedSet();
+  set->SetLoadFactor(runtime->GetHashTableMinLoadFactor(), runtime->GetHashTableMaxLoadFactor());
+  TableSnapshot* snapshot = new TableSnapshot();
+  snapshot->sets.push_back(set);
+  snapshot_.StoreRelaxed(snapshot);
 }
 
-size_t InternTable::Table::WriteToMemory(uint8_t* ptr) {
-  if (tables_.empty()) {
-    return 0;
+InternTable::Table::~Table() {
+  std::unique_ptr<TableSnapshot> snapshot(snapshot_.LoadRelaxed());
+  for (UnorderedSet* set : snapshot->sets) {
+    delete set;
   }
-  UnorderedSet* table_to_write;
-  UnorderedSet combined;
-  if (tables_.size() > 1) {
-    table_to_write = &combined;
-    for (UnorderedSet& table : tables_) {
-      for (GcRoot<mirror::String>& string : table) {
-        combined.Insert(string);
-      }
+}
+
+void InternTable::Table::Publish(TableSnapshot* snapshot) {
+  // Release so that readers see the sets of the snapshot fully built.
+  retired_.snapshots.emplace_back(snapshot_.LoadRelaxed());
+  snapshot_.StoreRelease(snapshot);
+}
+
+void InternTable::Table::TakeRetired(RetiredStorage* retired) {
+  std::move(retired_.snapshots.begin(),
+            retired_.snapshots.end(),
+            std::back_inserter(retired->snapshots));
+  std::move(retired_.sets.begin(), retired_.sets.end(), std::back_inserter(retired->sets));
+  retired_.snapshots.clear();
+  retired_.sets.clear();
+}
+
+void InternTable::Table::AddTableToFront(UnorderedSet* set) {
+  TableSnapshot* snapshot = new TableSnapshot(*snapshot_.LoadRelaxed());
+  snapshot->sets.insert(snapshot->sets.begin(), set);
+  Publish(snapshot);
+}
+
+void InternTable::Table::CopyTo(UnorderedSet* set) const {
+  for (UnorderedSet* table : snapshot_.LoadRelaxed()->sets) {
+    for (GcRoot<mirror::String>& string : *table) {
+      set->Insert(string);
     }
-  } else {
-    table_to_write = &tables_.back();
   }
-  return table_to_write->WriteToMemory(ptr);
 }
 
 void InternTable::Table::Remove(mirror::String* s) {
-  for (UnorderedSet& table : tables_) {
-    auto it = table.Find(GcRoot<mirror::String>(s));
-    if (it != table.end()) {
-      table.Erase(it);
+  for (UnorderedSet* table : snapshot_.LoadRelaxed()->sets) {
+    auto it = table->Find(GcRoot<mirror::String>(s));
+    if (it != table->end()) {
+      table->Erase(it);
       return;
     }
   }
@@ -440,51 +613,74 @@ void InternTable::Table::Remove(mirror::String* s) {
 }
 
 mirror::String* InternTable::Table::Find(mirror::String* s) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
-  for (UnorderedSet& table : tables_) {
-    auto it = table.Find(GcRoot<mirror::String>(s));
-    if (it != table.end()) {
-      return it->Read();
+  GcRoot<mirror::String> key(s);
+  for (UnorderedSet* table : snapshot_.LoadAcquire()->sets) {
+    auto it = table->Find(key);
+    if (it != table->end()) {
+      // Read the slot once more: check that it was not changed since it matched.
+      GcRoot<mirror::String> found = *it;
+      if (StringHashEquals()(found, key)) {
+        return found.Read();
+      }
     }
   }
   return nullptr;
 }
 
 mirror::String* InternTable::Table::Find(const Utf8String& string) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
-  for (UnorderedSet& table : tables_) {
-    auto it = table.Find(string);
-    if (it != table.end()) {
-      return it->Read();
+  for (UnorderedSet* table : snapshot_.LoadAcquire()->sets) {
+    auto it = table->Find(string);
+    if (it != table->end()) {
+      GcRoot<mirror::String> found = *it;
+      if (StringHashEquals()(found, string)) {
+        return found.Read();
+      }
     }
   }
   return nullptr;
 }
 
 void InternTable::Table::AddNewTable() {
-  tables_.push_back(UnorderedSet());
+  TableSnapshot* snapshot = new TableSnapshot(*snapshot_.LoadRelaxed());
+  snapshot->sets.push_back(new UnorderedSet());
+  Publish(snapshot);
 }
 
 void InternTable::Table::Insert(mirror::String* s) {
   // Always insert the last table, the image tables are before and we avoid inserting into these
   // to prevent dirty pages.
-  DCHECK(!tables_.empty());
-  tables_.back().Insert(GcRoot<mirror::String>(s));
+  TableSnapshot* const snapshot = snapshot_.LoadRelaxed();
+  UnorderedSet* const set = snapshot->sets.back();
+  if (set->Size() < set->ElementsUntilExpand()) {
+    // The set does not need to expand, so the string only fills an empty slot which readers
+    // either see before or after. Make sure they see the string behind the slot, too.
+    QuasiAtomic::ThreadFenceRelease();
+    set->Insert(GcRoot<mirror::String>(s));
+    return;
+  }
+  // Expanding rehashes the set in place, which the readers may be probing. Expand a copy
+  // instead, and publish it.
+  UnorderedSet* expanded = new UnorderedSet(*set);
+  expanded->Insert(GcRoot<mirror::String>(s));
+  TableSnapshot* new_snapshot = new TableSnapshot(*snapshot);
+  new_snapshot->sets.back() = expanded;
+  Publish(new_snapshot);
+  retired_.sets.emplace_back(set);
 }
 
 void InternTable::Table::VisitRoots(RootVisitor* visitor) {
   BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(
       visitor, RootInfo(kRootInternedString));
-  for (UnorderedSet& table : tables_) {
-    for (auto& intern : table) {
+  for (UnorderedSet* table : snapshot_.LoadRelaxed()->sets) {
+    for (auto& intern : *table) {
       buffered_visitor.VisitRoot(intern);
     }
   }
 }
 
 void InternTable::Table::SweepWeaks(IsMarkedVisitor* visitor) {
-  for (UnorderedSet& table : tables_) {
-    SweepWeaks(&table, visitor);
+  for (UnorderedSet* table : snapshot_.LoadRelaxed()->sets) {
+    SweepWeaks(table, visitor);
   }
 }
 
@@ -503,33 +699,25 @@ void InternTable::Table::SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
 }
 
 size_t InternTable::Table::Size() const {
-  return std::accumulate(tables_.begin(),
-                         tables_.end(),
+  const std::vector<UnorderedSet*>& sets = snapshot_.LoadRelaxed()->sets;
+  return std::accumulate(sets.begin(),
+                         sets.end(),
                          0U,
-                         [](size_t sum, const UnorderedSet& set) {
-                           return sum + set.Size();
+                         [](size_t sum, const UnorderedSet* set) {
+                           return sum + set->Size();
                          });
 }
 
 void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  ChangeWeakRootStateLocked(new_state);
-}
-
-void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
   CHECK(!kUseReadBarrier);
-  weak_root_state_ = new_state;
+  weak_root_state_.StoreSequentiallyConsistent(new_state);
   if (new_state != gc::kWeakRootStateNoReadsOrWrites) {
-    weak_intern_condition_.Broadcast(Thread::Current());
+    Thread* const self = Thread::Current();
+    for (Shard& shard : shards_) {
+      MutexLock mu(self, shard.lock_);
+      shard.weak_intern_condition_.Broadcast(self);
+    }
   }
 }
 
-InternTable::Table::Table() {
-  Runtime* const runtime = Runtime::Current();
-  // Initial table.
-  tables_.push_back(UnorderedSet());
-  tables_.back().SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
-                               runtime->GetHashTableMaxLoadFactor());
-}
-
 }  // namespace art
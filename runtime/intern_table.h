@@ -17,7 +17,9 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "atomic.h"
 #include "base/allocator.h"
@@ -51,6 +53,11 @@ class Transaction;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * Both tables are split by hash into shards, each with its own lock which serializes the writers.
+ * Readers don't take any lock: strings already in the table, the common case, are found lock
+ * free, and only a miss takes the shard lock to look again and insert. The strings of the boot
+ * image are in a separate table, shared by the shards, which is only written at startup.
  */
 class InternTable {
  public:
@@ -78,23 +85,18 @@ class InternTable {
   mirror::String* InternWeak(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Roles::uninterruptible_);
 
-  void SweepInternTableWeaks(IsMarkedVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_)
-      REQUIRES(!Locks::intern_table_lock_);
+  void SweepInternTableWeaks(IsMarkedVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_);
 
-  bool ContainsWeak(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_)
-      REQUIRES(!Locks::intern_table_lock_);
+  bool ContainsWeak(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Lookup a strong intern, returns null if not found.
   mirror::String* LookupStrong(Thread* self, mirror::String* s)
-      REQUIRES(!Locks::intern_table_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
   mirror::String* LookupStrong(Thread* self, uint32_t utf16_length, const char* utf8_data)
-      REQUIRES(!Locks::intern_table_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Lookup a weak intern, returns null if not found.
   mirror::String* LookupWeak(Thread* self, mirror::String* s)
-      REQUIRES(!Locks::intern_table_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Total number of interned strings.
@@ -104,7 +106,7 @@ class InternTable {
   size_t StrongSize() const REQUIRES(!Locks::intern_table_lock_);
 
   // Total number of strongly live interned strings.
-  size_t WeakSize() const REQUIRES(!Locks::intern_table_lock_);
+  size_t WeakSize() const;
 
   void VisitRoots(RootVisitor* visitor, VisitRootFlags flags)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!Locks::intern_table_lock_);
@@ -135,8 +137,7 @@ class InternTable {
       REQUIRES(!Locks::intern_table_lock_);
 
   // Change the weak root state. May broadcast to waiters.
-  void ChangeWeakRootState(gc::WeakRootState new_state)
-      REQUIRES(!Locks::intern_table_lock_);
+  void ChangeWeakRootState(gc::WeakRootState new_state);
 
  private:
   // Modified UTF-8-encoded string treated as UTF16.
@@ -176,106 +177,156 @@ class InternTable {
     }
   };
 
+  typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
+      TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
+
+  // The sets of a table. Readers load it once per lookup, so it is replaced rather than modified.
+  struct TableSnapshot {
+    std::vector<UnorderedSet*> sets;
+  };
+
+  // Storage which was replaced while lock free readers may still have been using it. It is freed
+  // once every thread has passed a suspend point, since lookups never suspend.
+  struct RetiredStorage {
+    std::vector<std::unique_ptr<TableSnapshot>> snapshots;
+    std::vector<std::unique_ptr<UnorderedSet>> sets;
+
+    bool Empty() const {
+      return snapshots.empty() && sets.empty();
+    }
+  };
+
   // Table which holds pre zygote and post zygote interned strings. There is one instance for
-  // weak interns and strong interns.
+  // weak interns and strong interns of each shard, and one for the strings of the images.
+  //
+  // Find may be called without any lock. It returns either null or a string equal to the one
+  // looked up, but may miss a string which is being inserted, removed or moved at the same time;
+  // callers look again holding the lock of the writers to be sure of a miss. The other methods
+  // are the writers, serialized by the caller.
   class Table {
    public:
     Table();
-    mirror::String* Find(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    mirror::String* Find(const Utf8String& string) SHARED_REQUIRES(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Insert(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Remove(mirror::String* s)
-        SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    void VisitRoots(RootVisitor* visitor)
-        SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    void SweepWeaks(IsMarkedVisitor* visitor)
-        SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    ~Table();
+    mirror::String* Find(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
+    mirror::String* Find(const Utf8String& string) SHARED_REQUIRES(Locks::mutator_lock_);
+    void Insert(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
+    void Remove(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
+    void VisitRoots(RootVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_);
+    void SweepWeaks(IsMarkedVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_);
     // Add a new intern table that will only be inserted into from now on.
-    void AddNewTable() REQUIRES(Locks::intern_table_lock_);
-    size_t Size() const REQUIRES(Locks::intern_table_lock_);
-    // Read and add an intern table from ptr.
-    // Tables read are inserted at the front of the table array. Only checks for conflicts in
-    // debug builds. Returns how many bytes were read.
-    size_t AddTableFromMemory(const uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
-    // Write the intern tables to ptr, if there are multiple tables they are combined into a single
-    // one. Returns how many bytes were written.
-    size_t WriteToMemory(uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+    void AddNewTable();
+    // Add a set read from an image. It is inserted at the front since we add new interns into
+    // the back.
+    void AddTableToFront(UnorderedSet* set);
+    size_t Size() const;
+    // Insert all of the strings of the table into `set`.
+    void CopyTo(UnorderedSet* set) const SHARED_REQUIRES(Locks::mutator_lock_);
+    // Move the storage replaced since the last call to `retired`.
+    void TakeRetired(RetiredStorage* retired);
 
    private:
-    typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
-        TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
-
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
-        SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+        SHARED_REQUIRES(Locks::mutator_lock_);
+
+    // Replace the snapshot, retiring the current one.
+    void Publish(TableSnapshot* snapshot);
 
     // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
     // modifying the zygote intern table. The back of table is modified when strings are interned.
-    std::vector<UnorderedSet> tables_;
+    Atomic<TableSnapshot*> snapshot_;
+    RetiredStorage retired_;
+
+    DISALLOW_COPY_AND_ASSIGN(Table);
+  };
+
+  static constexpr size_t kShardBits = 4;
+  static constexpr size_t kNumShards = 1u << kShardBits;
+
+  // The strings whose hash maps to the shard, along with the lock serializing their writers.
+  struct Shard {
+    Shard();
+
+    mutable Mutex lock_ ACQUIRED_AFTER(Locks::intern_table_lock_);
+    ConditionVariable weak_intern_condition_ GUARDED_BY(lock_);
+    // Since this contains (strong) roots, they need a read barrier to
+    // enable concurrent intern table (strong) root scan. Do not
+    // directly access the strings in it. Use functions that contain
+    // read barriers.
+    Table strong_interns_;
+    std::vector<GcRoot<mirror::String>> new_strong_intern_roots_ GUARDED_BY(lock_);
+    bool log_new_roots_ GUARDED_BY(lock_);
+    // Since this contains (weak) roots, they need a read barrier. Do
+    // not directly access the strings in it. Use functions that contain
+    // read barriers.
+    Table weak_interns_;
   };
 
+  Shard* GetShard(int32_t hash);
+
   // Insert if non null, otherwise return null. Must be called holding the mutator lock.
   // If holding_locks is true, then we may also hold other locks. If holding_locks is true, then we
   // require GC is not running since it is not safe to wait while holding locks.
   mirror::String* Insert(mirror::String* s, bool is_strong, bool holding_locks)
-      REQUIRES(!Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
-
-  mirror::String* LookupStrongLocked(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  mirror::String* LookupWeakLocked(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  mirror::String* InsertStrong(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  mirror::String* InsertWeak(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveStrong(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveWeak(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  mirror::String* InsertLocked(Thread* self,
+                               Shard* shard,
+                               mirror::String* s,
+                               bool is_strong,
+                               bool holding_locks)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+
+  // Whether the calling thread may read the weak interns right now.
+  bool CanReadWeakInterns(Thread* self) const;
+
+  // Look for `s` without taking any lock. A weak intern is only looked at for InternWeak since
+  // InternStrong has to promote it holding the lock.
+  mirror::String* LookupLockFree(Thread* self, Shard* shard, mirror::String* s, bool is_strong)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  mirror::String* LookupStrongLocked(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  mirror::String* LookupWeakLocked(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  mirror::String* InsertStrong(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  mirror::String* InsertWeak(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  void RemoveStrong(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  void RemoveWeak(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+
+  // Free storage retired by the tables once no lock free reader can still be using it. Runs a
+  // checkpoint, so it may suspend.
+  void ReclaimRetired(RetiredStorage* retired)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!Roles::uninterruptible_);
 
   // Transaction rollback access.
   mirror::String* LookupStringFromImage(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
   mirror::String* InsertStrongFromTransaction(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
   mirror::String* InsertWeakFromTransaction(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
   void RemoveStrongFromTransaction(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
   void RemoveWeakFromTransaction(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
 
   size_t AddTableFromMemoryLocked(const uint8_t* ptr)
       REQUIRES(Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Change the weak root state. May broadcast to waiters.
-  void ChangeWeakRootStateLocked(gc::WeakRootState new_state)
-      REQUIRES(Locks::intern_table_lock_);
-
   // Wait until we can read weak roots.
-  void WaitUntilAccessible(Thread* self)
-      REQUIRES(Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
-
-  bool images_added_to_intern_table_ GUARDED_BY(Locks::intern_table_lock_);
-  bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
-  ConditionVariable weak_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (strong) roots, they need a read barrier to
-  // enable concurrent intern table (strong) root scan. Do not
-  // directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  std::vector<GcRoot<mirror::String>> new_strong_intern_roots_
-      GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (weak) roots, they need a read barrier. Do
-  // not directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
+  void WaitUntilAccessible(Thread* self, Shard* shard)
+      REQUIRES(shard->lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  Atomic<bool> images_added_to_intern_table_;
+  // The strings of the images, which are never removed. It is only written holding
+  // intern_table_lock_, and is read without locks like the shards.
+  Table image_strong_interns_;
+  Shard shards_[kNumShards];
   // Weak root state, used for concurrent system weak processing and more.
-  gc::WeakRootState weak_root_state_ GUARDED_BY(Locks::intern_table_lock_);
+  Atomic<gc::WeakRootState> weak_root_state_;
 
   friend class Transaction;
   DISALLOW_COPY_AND_ASSIGN(InternTable);
@@ -16,11 +16,13 @@
 
 #include "intern_table.h"
 
+#include "base/stringprintf.h"
 #include "common_runtime_test.h"
 #include "mirror/object.h"
 #include "handle_scope-inl.h"
 #include "mirror/string.h"
 #include "scoped_thread_state_change.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -212,4 +214,51 @@ TEST_F(InternTableTest, LookupStrong) {
   EXPECT_TRUE(lookup_foobbS == nullptr);
 }
 
+class InternStringsTask : public Task {
+ public:
+  InternStringsTask(InternTable* intern_table, size_t num_strings)
+      : intern_table_(intern_table), num_strings_(num_strings) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    for (size_t i = 0; i < num_strings_; ++i) {
+      const std::string contents = StringPrintf("intern table test %zu", i);
+      mirror::String* interned = intern_table_->InternStrong(contents.c_str());
+      ASSERT_TRUE(interned != nullptr);
+      EXPECT_TRUE(interned->Equals(contents.c_str()));
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  InternTable* const intern_table_;
+  const size_t num_strings_;
+};
+
+TEST_F(InternTableTest, ConcurrentInternStrong) {
+  static constexpr size_t kNumThreads = 4;
+  static constexpr size_t kNumStrings = 20000;
+  Thread* self = Thread::Current();
+  // Use the runtime's table, whose strings are roots.
+  InternTable* intern_table = Runtime::Current()->GetInternTable();
+  const size_t initial_size = intern_table->StrongSize();
+  ThreadPool thread_pool("Intern table test thread pool", kNumThreads);
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    thread_pool.AddTask(self, new InternStringsTask(intern_table, kNumStrings));
+  }
+  thread_pool.StartWorkers(self);
+  // Wait while suspended, the workers may run checkpoints.
+  thread_pool.Wait(self, false, false);
+  ScopedObjectAccess soa(self);
+  // All of the threads interned the same strings, each of them must be in the table once.
+  EXPECT_EQ(initial_size + kNumStrings, intern_table->StrongSize());
+  for (size_t i = 0; i < kNumStrings; ++i) {
+    const std::string contents = StringPrintf("intern table test %zu", i);
+    EXPECT_TRUE(intern_table->LookupStrong(self, contents.length(), contents.c_str()) != nullptr);
+  }
+}
+
 }  // namespace art
@@ -348,7 +348,7 @@ static inline const char* GetStringDataByDexStringIndexOrThrow(ShadowFrame& shad
   mirror::Class* declaring_class = method->GetDeclaringClass();
   if (!do_access_check) {
     // MethodVerifier refuses methods with string_idx out of bounds.
-    DCHECK_LT(string_idx, declaring_class->GetDexCache()->NumStrings());
+    DCHECK_LT(string_idx, dex_file->NumStringIds());
   } else {
     // Access checks enabled: perform string index bounds ourselves.
     if (string_idx >= dex_file->GetHeader().string_ids_size_) {
@@ -751,8 +751,9 @@ static inline String* ResolveString(Thread* self, ShadowFrame& shadow_frame, uin
   ArtMethod* method = shadow_frame.GetMethod();
   mirror::Class* declaring_class = method->GetDeclaringClass();
   // MethodVerifier refuses methods with string_idx out of bounds.
-  DCHECK_LT(string_idx, declaring_class->GetDexCache()->NumStrings());
-  mirror::String* s = declaring_class->GetDexCacheStrings()[string_idx].Read();
+  DCHECK_LT(string_idx, declaring_class->GetDexCache()->GetDexFile()->NumStringIds());
+  mirror::String* s =
+      mirror::DexCache::LookupResolvedString(declaring_class->GetDexCacheStrings(), string_idx);
   if (UNLIKELY(s == nullptr)) {
     StackHandleScope<1> hs(self);
     Handle<mirror::DexCache> dex_cache(hs.NewHandle(declaring_class->GetDexCache()));
@@ -998,8 +999,7 @@ static inline void TraceExecution(const ShadowFrame& shadow_frame, const Instruc
       Object* ref_value = shadow_frame.GetVRegReference(i);
       oss << StringPrintf(" vreg%u=0x%08X", i, raw_value);
       if (ref_value != nullptr) {
-        if (ref_value->GetClass()->IsStringClass() &&
-            ref_value->AsString()->GetValue() != nullptr) {
+        if (ref_value->GetClass()->IsStringClass()) {
           oss << "/java.lang.String \"" << ref_value->AsString()->ToModifiedUtf8() << "\"";
         } else {
           oss << "/" << PrettyTypeOf(ref_value);
@@ -400,8 +400,7 @@ TEST_F(UnstartedRuntimeTest, StringInit) {
   interpreter::DoCall<false, false>(method, self, *shadow_frame, inst, inst_data[0], &result);
   mirror::String* string_result = reinterpret_cast<mirror::String*>(result.GetL());
   EXPECT_EQ(string_arg->GetLength(), string_result->GetLength());
-  EXPECT_EQ(memcmp(string_arg->GetValue(), string_result->GetValue(),
-                   string_arg->GetLength() * sizeof(uint16_t)), 0);
+  EXPECT_TRUE(string_arg->Equals(string_result));
 
   ShadowFrame::DeleteDeoptimizedFrame(shadow_frame);
 }
@@ -66,6 +66,15 @@ static inline void AppendUtf16BE(std::vector<uint8_t>& bytes, const uint16_t* ch
   }
 }
 
+// Appends Latin-1 chars, such as those of a compressed string, as UTF-16.
+static inline void AppendUtf16BE(std::vector<uint8_t>& bytes, const uint8_t* chars,
+                                 size_t char_count) {
+  Append4BE(bytes, char_count);
+  for (size_t i = 0; i < char_count; ++i) {
+    Append2BE(bytes, chars[i]);
+  }
+}
+
 // @deprecated
 static inline void Set1(uint8_t* buf, uint8_t val) {
   *buf = val;
@@ -19,6 +19,7 @@
 #include <dlfcn.h>
 
 #include "art_method-inl.h"
+#include "base/time_utils.h"
 #include "debugger.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
 #include "interpreter/interpreter.h"
@@ -26,6 +27,7 @@
 #include "oat_file_manager.h"
 #include "oat_quick_method_header.h"
 #include "offline_profiling_info.h"
+#include "os.h"
 #include "profile_saver.h"
 #include "runtime.h"
 #include "runtime_options.h"
@@ -45,7 +47,7 @@ void* Jit::jit_library_handle_= nullptr;
 void* Jit::jit_compiler_handle_ = nullptr;
 void* (*Jit::jit_load_)(bool*) = nullptr;
 void (*Jit::jit_unload_)(void*) = nullptr;
-bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool) = nullptr;
+bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool) = nullptr;
 void (*Jit::jit_types_loaded_)(void*, mirror::Class**, size_t count) = nullptr;
 bool Jit::generate_debug_info_ = false;
 
@@ -116,6 +118,18 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
         static_cast<size_t>(1));;
   }
 
+  jit_options->thread_pool_size_ = options.GetOrDefault(RuntimeArgumentMap::JITThreadPoolSize);
+  if (jit_options->thread_pool_size_ == 0) {
+    LOG(FATAL) << "JIT thread pool size cannot be 0.";
+  }
+
+  jit_options->use_tiered_compilation_ =
+      options.GetOrDefault(RuntimeArgumentMap::UseTieredJitCompilation);
+  jit_options->code_snapshot_location_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITCodeSnapshot);
+  jit_options->write_perf_map_ = options.GetOrDefault(RuntimeArgumentMap::JITWritePerfMap);
+  jit_options->write_jitdump_ = options.GetOrDefault(RuntimeArgumentMap::JITWriteJitDump);
+
   return jit_options;
 }
 
@@ -127,8 +141,24 @@ bool Jit::ShouldUsePriorityThreadWeight() {
 void Jit::DumpInfo(std::ostream& os) {
   code_cache_->Dump(os);
   cumulative_timings_.Dump(os);
-  MutexLock mu(Thread::Current(), lock_);
+  Thread* self = Thread::Current();
+  if (thread_pool_ != nullptr) {
+    os << "JIT thread pool: " << thread_pool_->GetThreadCount() << " threads, "
+       << thread_pool_->GetTaskCount(self) << " pending tasks\n";
+  }
+  MutexLock mu(self, lock_);
   memory_use_.PrintMemoryUse(os);
+  os << "Peak JIT queue depth: " << peak_queue_depth_ << "\n";
+  os << "Dropped JIT compilations: " << dropped_compilations_ << "\n";
+  Histogram<uint64_t>::CumulativeData data;
+  if (queue_times_.SampleSize() != 0) {
+    queue_times_.CreateHistogram(&data);
+    queue_times_.PrintConfidenceIntervals(os, 0.99, data);
+  }
+  if (compile_times_.SampleSize() != 0) {
+    compile_times_.CreateHistogram(&data);
+    compile_times_.PrintConfidenceIntervals(os, 0.99, data);
+  }
 }
 
 void Jit::DumpForSigQuit(std::ostream& os) {
@@ -143,9 +173,15 @@ void Jit::AddTimingLogger(const TimingLogger& logger) {
 Jit::Jit() : dump_info_on_shutdown_(false),
              cumulative_timings_("JIT timings"),
              memory_use_("Memory used for compilation", 16),
-             lock_("JIT memory use lock"),
+             queue_times_("Time spent in the JIT queue", 1000),
+             compile_times_("Time spent compiling", 1000),
+             peak_queue_depth_(0),
+             dropped_compilations_(0),
+             lock_("JIT statistics lock"),
              use_jit_compilation_(true),
-             save_profiling_info_(false) {}
+             save_profiling_info_(false),
+             use_tiered_compilation_(false),
+             thread_pool_size_(kDefaultThreadPoolSize) {}
 
 Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   DCHECK(options->UseJitCompilation() || options->GetSaveProfilingInfo());
@@ -158,6 +194,8 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
       options->GetCodeCacheInitialCapacity(),
       options->GetCodeCacheMaxCapacity(),
       jit->generate_debug_info_,
+      options->WritePerfMap(),
+      options->WriteJitDump(),
       error_msg));
   if (jit->GetCodeCache() == nullptr) {
     return nullptr;
@@ -168,6 +206,11 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
       << PrettySize(options->GetCodeCacheInitialCapacity())
       << ", max_capacity=" << PrettySize(options->GetCodeCacheMaxCapacity())
       << ", compile_threshold=" << options->GetCompileThreshold()
+      << ", thread_pool_size=" << options->GetThreadPoolSize()
+      << ", use_tiered_compilation=" << options->UseTieredCompilation()
+      << ", code_snapshot=" << options->GetCodeSnapshotLocation()
+      << ", write_perf_map=" << options->WritePerfMap()
+      << ", write_jitdump=" << options->WriteJitDump()
       << ", save_profiling_info=" << options->GetSaveProfilingInfo();
 
 
@@ -176,6 +219,20 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   jit->osr_method_threshold_ = options->GetOsrThreshold();
   jit->priority_thread_weight_ = options->GetPriorityThreadWeight();
   jit->invoke_transition_weight_ = options->GetInvokeTransitionWeight();
+  jit->thread_pool_size_ = options->GetThreadPoolSize();
+  jit->use_tiered_compilation_ = options->UseTieredCompilation();
+
+  if (jit->use_jit_compilation_ && !options->GetCodeSnapshotLocation().empty()) {
+    jit->code_snapshot_location_ = options->GetCodeSnapshotLocation();
+    if (OS::FileExists(jit->code_snapshot_location_.c_str())) {
+      std::string snapshot_error_msg;
+      jit->code_snapshot_ =
+          JitCodeSnapshot::Open(jit->code_snapshot_location_, &snapshot_error_msg);
+      if (jit->code_snapshot_ == nullptr) {
+        LOG(WARNING) << snapshot_error_msg;
+      }
+    }
+  }
 
   jit->CreateThreadPool();
 
@@ -206,7 +263,7 @@ bool Jit::LoadCompilerLibrary(std::string* error_msg) {
     *error_msg = "JIT couldn't find jit_unload entry point";
     return false;
   }
-  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool)>(
+  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool, bool)>(
       dlsym(jit_library_handle_, "jit_compile_method"));
   if (jit_compile_method_ == nullptr) {
     dlclose(jit_library_handle_);
@@ -240,9 +297,10 @@ bool Jit::LoadCompiler(std::string* error_msg) {
   return true;
 }
 
-bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
+bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr, bool baseline) {
   DCHECK(Runtime::Current()->UseJitCompilation());
   DCHECK(!method->IsRuntimeMethod());
+  DCHECK(!osr || !baseline);
 
   // Don't compile the method if it has breakpoints.
   if (Dbg::IsDebuggerActive() && Dbg::MethodHasAnyBreakpoints(method)) {
@@ -260,19 +318,22 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
   // If we get a request to compile a proxy method, we pass the actual Java method
   // of that proxy method, as the compiler does not expect a proxy method.
   ArtMethod* method_to_compile = method->GetInterfaceMethodIfProxy(sizeof(void*));
-  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr)) {
+  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr, baseline)) {
     return false;
   }
 
   VLOG(jit) << "Compiling method "
             << PrettyMethod(method_to_compile)
-            << " osr=" << std::boolalpha << osr;
-  bool success = jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr);
+            << " osr=" << std::boolalpha << osr
+            << " baseline=" << std::boolalpha << baseline;
+  bool success =
+      jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr, baseline);
   code_cache_->DoneCompiling(method_to_compile, self, osr);
   if (!success) {
     VLOG(jit) << "Failed to compile method "
               << PrettyMethod(method_to_compile)
-              << " osr=" << std::boolalpha << osr;
+              << " osr=" << std::boolalpha << osr
+              << " baseline=" << std::boolalpha << baseline;
   }
   return success;
 }
@@ -280,7 +341,9 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
 void Jit::CreateThreadPool() {
   // There is a DCHECK in the 'AddSamples' method to ensure the tread pool
   // is not null when we instrument.
-  thread_pool_.reset(new ThreadPool("Jit thread pool", 1));
+  // Generating debug info requires a single compiler thread, see JitCompiler.
+  size_t thread_count = generate_debug_info_ ? 1u : thread_pool_size_;
+  thread_pool_.reset(new ThreadPool("Jit thread pool", thread_count));
   thread_pool_->SetPthreadPriority(kJitPoolThreadPthreadPriority);
   thread_pool_->StartWorkers(Thread::Current());
 }
@@ -540,15 +603,34 @@ void Jit::AddMemoryUsage(ArtMethod* method, size_t bytes) {
   memory_use_.AddValue(bytes);
 }
 
+void Jit::AddCompilationTimes(uint64_t queue_time_ns, uint64_t compile_time_ns) {
+  MutexLock mu(Thread::Current(), lock_);
+  queue_times_.AdjustAndAddValue(queue_time_ns);
+  compile_times_.AdjustAndAddValue(compile_time_ns);
+}
+
+void Jit::AddDroppedCompilation() {
+  MutexLock mu(Thread::Current(), lock_);
+  ++dropped_compilations_;
+}
+
 class JitCompileTask FINAL : public Task {
  public:
   enum TaskKind {
     kAllocateProfile,
     kCompile,
-    kCompileOsr
+    kCompileOsr,
+    kCompileBaseline,
+    kInstallSnapshotCode
   };
 
-  JitCompileTask(ArtMethod* method, TaskKind kind) : method_(method), kind_(kind) {
+  // OSR requests go first: the method is stuck in a loop in the interpreter.
+  static constexpr int32_t kOsrPriority = std::numeric_limits<int32_t>::max();
+  // Installing code from the snapshot is cheap, so do it before compiling other methods.
+  static constexpr int32_t kInstallSnapshotCodePriority = kOsrPriority - 1;
+
+  JitCompileTask(ArtMethod* method, TaskKind kind, int32_t priority)
+      : method_(method), kind_(kind), priority_(priority), creation_time_ns_(NanoTime()) {
     ScopedObjectAccess soa(Thread::Current());
     // Add a global ref to the class to prevent class unloading until compilation is done.
     klass_ = soa.Vm()->AddGlobalRef(soa.Self(), method_->GetDeclaringClass());
@@ -562,10 +644,34 @@ class JitCompileTask FINAL : public Task {
 
   void Run(Thread* self) OVERRIDE {
     ScopedObjectAccess soa(self);
-    if (kind_ == kCompile) {
-      Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ false);
-    } else if (kind_ == kCompileOsr) {
-      Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ true);
+    Jit* jit = Runtime::Current()->GetJit();
+    if (kind_ == kCompile || kind_ == kCompileOsr || kind_ == kCompileBaseline) {
+      bool osr = (kind_ == kCompileOsr);
+      bool baseline = (kind_ == kCompileBaseline);
+      JitCodeCache* code_cache = jit->GetCodeCache();
+      bool is_compiled = false;
+      if (osr) {
+        is_compiled = code_cache->IsOsrCompiled(method_);
+      } else {
+        // Optimized code replaces baseline code, but not the other way around.
+        is_compiled = code_cache->ContainsPc(method_->GetEntryPointFromQuickCompiledCode()) &&
+            (baseline || !code_cache->IsBaselineCompiled(method_));
+      }
+      if (is_compiled) {
+        // Another request for the same method was served first.
+        VLOG(jit) << "Dropping compilation request of " << PrettyMethod(method_)
+                  << " osr=" << std::boolalpha << osr
+                  << " baseline=" << std::boolalpha << baseline;
+        jit->AddDroppedCompilation();
+      } else {
+        uint64_t start_ns = NanoTime();
+        jit->CompileMethod(method_, self, osr, baseline);
+        jit->AddCompilationTimes(start_ns - creation_time_ns_, NanoTime() - start_ns);
+      }
+    } else if (kind_ == kInstallSnapshotCode) {
+      if (!jit->GetCodeCache()->ContainsPc(method_->GetEntryPointFromQuickCompiledCode())) {
+        jit->InstallSnapshotCode(method_, self);
+      }
     } else {
       DCHECK(kind_ == kAllocateProfile);
       if (ProfilingInfo::Create(self, method_, /* retry_allocation */ true)) {
@@ -579,14 +685,40 @@ class JitCompileTask FINAL : public Task {
     delete this;
   }
 
+  int32_t GetPriority() const OVERRIDE {
+    return priority_;
+  }
+
  private:
   ArtMethod* const method_;
   const TaskKind kind_;
+  const int32_t priority_;
+  const uint64_t creation_time_ns_;
   jobject klass_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCompileTask);
 };
 
+int32_t Jit::GetCompilePriority(ArtMethod* method) {
+  ProfilingInfo* info = method->GetProfilingInfo(sizeof(void*));
+  if (info == nullptr) {
+    return 0;
+  }
+  // Number of samples per second between the method becoming warm and becoming hot.
+  uint32_t elapsed_ms = static_cast<uint32_t>(MilliTime()) - info->GetCreationTimeMs();
+  uint64_t samples = hot_method_threshold_ - warm_method_threshold_;
+  uint64_t rate = samples * 1000 / (static_cast<uint64_t>(elapsed_ms) + 1);
+  return static_cast<int32_t>(
+      std::min(rate, static_cast<uint64_t>(JitCompileTask::kOsrPriority - 1)));
+}
+
+void Jit::AddCompileTask(Thread* self, Task* task) {
+  thread_pool_->AddTask(self, task);
+  size_t queue_depth = thread_pool_->GetTaskCount(self);
+  MutexLock mu(self, lock_);
+  peak_queue_depth_ = std::max(peak_queue_depth_, queue_depth);
+}
+
 void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_backedges) {
   if (thread_pool_ == nullptr) {
     // Should only see this when shutting down.
@@ -611,6 +743,13 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
   }
   int32_t new_count = starting_count + count;   // int32 here to avoid wrap-around;
   if (starting_count < warm_method_threshold_) {
+    if (starting_count == 0 && code_snapshot_ != nullptr && code_snapshot_->HasCodeFor(method)) {
+      // Code from the snapshot is installed at the first invocation, as doing so
+      // is much cheaper than compiling.
+      AddCompileTask(self, new JitCompileTask(method,
+                                              JitCompileTask::kInstallSnapshotCode,
+                                              JitCompileTask::kInstallSnapshotCodePriority));
+    }
     if ((new_count >= warm_method_threshold_) &&
         (method->GetProfilingInfo(sizeof(void*)) == nullptr)) {
       bool success = ProfilingInfo::Create(self, method, /* retry_allocation */ false);
@@ -628,7 +767,8 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
       if (!success) {
         // We failed allocating. Instead of doing the collection on the Java thread, we push
         // an allocation to a compiler thread, that will do the collection.
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kAllocateProfile));
+        AddCompileTask(
+            self, new JitCompileTask(method, JitCompileTask::kAllocateProfile, /* priority */ 0));
       }
     }
     // Avoid jumping more than one state at a time.
@@ -638,7 +778,10 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
       if ((new_count >= hot_method_threshold_) &&
           !code_cache_->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
         DCHECK(thread_pool_ != nullptr);
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompile));
+        JitCompileTask::TaskKind kind = use_tiered_compilation_
+            ? JitCompileTask::kCompileBaseline
+            : JitCompileTask::kCompile;
+        AddCompileTask(self, new JitCompileTask(method, kind, GetCompilePriority(method)));
       }
       // Avoid jumping more than one state at a time.
       new_count = std::min(new_count, osr_method_threshold_ - 1);
@@ -649,7 +792,8 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
       }
       if ((new_count >= osr_method_threshold_) &&  !code_cache_->IsOsrCompiled(method)) {
         DCHECK(thread_pool_ != nullptr);
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompileOsr));
+        AddCompileTask(self, new JitCompileTask(
+            method, JitCompileTask::kCompileOsr, JitCompileTask::kOsrPriority));
       }
     }
   }
@@ -657,12 +801,61 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
   method->SetCounter(new_count);
 }
 
+bool Jit::InstallSnapshotCode(ArtMethod* method, Thread* self) {
+  DCHECK(code_snapshot_ != nullptr);
+  // Like compiled code, installed code needs a ProfilingInfo to be collected.
+  if (method->GetProfilingInfo(sizeof(void*)) == nullptr &&
+      !ProfilingInfo::Create(self, method, /* retry_allocation */ true)) {
+    return false;
+  }
+  if (!code_cache_->NotifyCompilationOf(method, self, /* osr */ false, /* baseline */ false)) {
+    return false;
+  }
+  bool success = code_snapshot_->InstallCode(self, method, code_cache_.get());
+  code_cache_->DoneCompiling(method, self, /* osr */ false);
+  return success;
+}
+
+void Jit::WriteCodeSnapshot(Thread* self) {
+  if (!UseCodeSnapshot()) {
+    return;
+  }
+  std::vector<JitCodeSnapshot::MethodCode> methods;
+  {
+    ScopedObjectAccess soa(self);
+    code_cache_->CopyRelocatableCode(&methods);
+  }
+  std::string error_msg;
+  if (!JitCodeSnapshot::Write(code_snapshot_location_, methods, &error_msg)) {
+    LOG(WARNING) << "Failed to write JIT code snapshot: " << error_msg;
+  }
+}
+
+void Jit::EnqueueOptimizedCompilation(ArtMethod* method, Thread* self) {
+  if (thread_pool_ == nullptr) {
+    // Should only see this when shutting down.
+    DCHECK(Runtime::Current()->IsShuttingDown(self));
+    return;
+  }
+  // Baseline code calls in at every entry and back edge once its method is past the
+  // threshold. Restart the count, so that it only calls in again if the method is still
+  // running baseline code by the time the count is back at the threshold.
+  method->ClearCounter();
+  if (!code_cache_->IsBaselineCompiled(method)) {
+    // The method already got optimized code, or its baseline code has been collected.
+    return;
+  }
+  VLOG(jit) << "Baseline code of " << PrettyMethod(method) << " is hot";
+  AddCompileTask(self, new JitCompileTask(
+      method, JitCompileTask::kCompile, GetCompilePriority(method)));
+}
+
 void Jit::MethodEntered(Thread* thread, ArtMethod* method) {
   Runtime* runtime = Runtime::Current();
   if (UNLIKELY(runtime->UseJitCompilation() && runtime->GetJit()->JitAtFirstUse())) {
     // The compiler requires a ProfilingInfo object.
     ProfilingInfo::Create(thread, method, /* retry_allocation */ true);
-    JitCompileTask compile_task(method, JitCompileTask::kCompile);
+    JitCompileTask compile_task(method, JitCompileTask::kCompile, /* priority */ 0);
     compile_task.Run(thread);
     return;
   }
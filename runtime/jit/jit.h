@@ -22,6 +22,7 @@
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "base/timing_logger.h"
+#include "jit/jit_code_snapshot.h"
 #include "object_callbacks.h"
 #include "offline_profiling_info.h"
 #include "thread_pool.h"
@@ -45,10 +46,13 @@ class Jit {
   static constexpr size_t kDefaultCompileThreshold = kStressMode ? 2 : 10000;
   static constexpr size_t kDefaultPriorityThreadWeightRatio = 1000;
   static constexpr size_t kDefaultInvokeTransitionWeightRatio = 500;
+  static constexpr size_t kDefaultThreadPoolSize = 1;
 
   virtual ~Jit();
   static Jit* Create(JitOptions* options, std::string* error_msg);
-  bool CompileMethod(ArtMethod* method, Thread* self, bool osr)
+  // Compile `method`. Baseline compilation only runs the passes needed to generate code,
+  // and the generated code keeps profiling the method.
+  bool CompileMethod(ArtMethod* method, Thread* self, bool osr, bool baseline = false)
       SHARED_REQUIRES(Locks::mutator_lock_);
   void CreateThreadPool();
 
@@ -71,6 +75,12 @@ class Jit {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Record the time a compilation request spent in the queue, and the time it took to compile.
+  void AddCompilationTimes(uint64_t queue_time_ns, uint64_t compile_time_ns) REQUIRES(!lock_);
+
+  // Record a compilation request dropped because the method got compiled in the meantime.
+  void AddDroppedCompilation() REQUIRES(!lock_);
+
   size_t OSRMethodThreshold() const {
     return osr_method_threshold_;
   }
@@ -83,6 +93,11 @@ class Jit {
     return warm_method_threshold_;
   }
 
+  // The hotness at which baseline code requests an optimized compilation of its method.
+  size_t OptimizeMethodThreshold() const {
+    return osr_method_threshold_;
+  }
+
   uint16_t PriorityThreadWeight() const {
     return priority_thread_weight_;
   }
@@ -96,6 +111,31 @@ class Jit {
     return save_profiling_info_;
   }
 
+  // Returns whether hot methods are first compiled with the baseline compiler, and only
+  // compiled with all optimizations once their baseline code gets hot.
+  bool UseTieredCompilation() const {
+    return use_tiered_compilation_;
+  }
+
+  // Returns whether compiled code is saved to, and installed from, a JitCodeSnapshot.
+  // The JIT then avoids embedding addresses of the current process in the code.
+  bool UseCodeSnapshot() const {
+    return !code_snapshot_location_.empty();
+  }
+
+  // The code snapshot opened at startup, or null if there is none.
+  JitCodeSnapshot* GetCodeSnapshot() {
+    return code_snapshot_.get();
+  }
+
+  // Install the code saved for `method` in the code snapshot opened at startup.
+  bool InstallSnapshotCode(ArtMethod* method, Thread* self)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Save the relocatable compiled code to the code snapshot location, for the next
+  // run of the program.
+  void WriteCodeSnapshot(Thread* self) REQUIRES(!Locks::mutator_lock_);
+
   // Wait until there is no more pending compilation tasks.
   void WaitForCompilationToFinish(Thread* self);
 
@@ -106,6 +146,10 @@ class Jit {
   void AddSamples(Thread* self, ArtMethod* method, uint16_t samples, bool with_backedges)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Request the optimized compilation of `method`, whose baseline code got hot.
+  void EnqueueOptimizedCompilation(ArtMethod* method, Thread* self)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   void InvokeVirtualOrInterface(Thread* thread,
                                 mirror::Object* this_object,
                                 ArtMethod* caller,
@@ -172,30 +216,44 @@ class Jit {
 
   static bool LoadCompiler(std::string* error_msg);
 
+  // Return the priority of the request to compile `method`, which is higher for methods
+  // which became hot faster.
+  int32_t GetCompilePriority(ArtMethod* method) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  void AddCompileTask(Thread* self, Task* task) REQUIRES(!lock_);
+
   // JIT compiler
   static void* jit_library_handle_;
   static void* jit_compiler_handle_;
   static void* (*jit_load_)(bool*);
   static void (*jit_unload_)(void*);
-  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool);
+  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool);
   static void (*jit_types_loaded_)(void*, mirror::Class**, size_t count);
 
   // Performance monitoring.
   bool dump_info_on_shutdown_;
   CumulativeLogger cumulative_timings_;
   Histogram<uint64_t> memory_use_ GUARDED_BY(lock_);
+  Histogram<uint64_t> queue_times_ GUARDED_BY(lock_);
+  Histogram<uint64_t> compile_times_ GUARDED_BY(lock_);
+  size_t peak_queue_depth_ GUARDED_BY(lock_);
+  uint64_t dropped_compilations_ GUARDED_BY(lock_);
   Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
   std::unique_ptr<jit::JitCodeCache> code_cache_;
 
   bool use_jit_compilation_;
   bool save_profiling_info_;
+  bool use_tiered_compilation_;
+  std::string code_snapshot_location_;
+  std::unique_ptr<JitCodeSnapshot> code_snapshot_;
   static bool generate_debug_info_;
   uint16_t hot_method_threshold_;
   uint16_t warm_method_threshold_;
   uint16_t osr_method_threshold_;
   uint16_t priority_thread_weight_;
   uint16_t invoke_transition_weight_;
+  size_t thread_pool_size_;
   std::unique_ptr<ThreadPool> thread_pool_;
 
   DISALLOW_COPY_AND_ASSIGN(Jit);
@@ -225,12 +283,27 @@ class JitOptions {
   size_t GetCodeCacheMaxCapacity() const {
     return code_cache_max_capacity_;
   }
+  size_t GetThreadPoolSize() const {
+    return thread_pool_size_;
+  }
   bool DumpJitInfoOnShutdown() const {
     return dump_info_on_shutdown_;
   }
   bool GetSaveProfilingInfo() const {
     return save_profiling_info_;
   }
+  bool UseTieredCompilation() const {
+    return use_tiered_compilation_;
+  }
+  const std::string& GetCodeSnapshotLocation() const {
+    return code_snapshot_location_;
+  }
+  bool WritePerfMap() const {
+    return write_perf_map_;
+  }
+  bool WriteJitDump() const {
+    return write_jitdump_;
+  }
   bool UseJitCompilation() const {
     return use_jit_compilation_;
   }
@@ -254,16 +327,25 @@ class JitOptions {
   size_t osr_threshold_;
   uint16_t priority_thread_weight_;
   size_t invoke_transition_weight_;
+  size_t thread_pool_size_;
   bool dump_info_on_shutdown_;
   bool save_profiling_info_;
+  bool use_tiered_compilation_;
+  std::string code_snapshot_location_;
+  bool write_perf_map_;
+  bool write_jitdump_;
 
   JitOptions()
       : use_jit_compilation_(false),
         code_cache_initial_capacity_(0),
         code_cache_max_capacity_(0),
         compile_threshold_(0),
+        thread_pool_size_(Jit::kDefaultThreadPoolSize),
         dump_info_on_shutdown_(false),
-        save_profiling_info_(false) { }
+        save_profiling_info_(false),
+        use_tiered_compilation_(false),
+        write_perf_map_(false),
+        write_jitdump_(false) { }
 
   DISALLOW_COPY_AND_ASSIGN(JitOptions);
 };
@@ -17,11 +17,13 @@
 #include "jit_code_cache.h"
 
 #include <sstream>
+#include <unordered_set>
 
 #include "art_method-inl.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/time_utils.h"
+#include "cha.h"
 #include "debugger_interface.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
 #include "gc/accounting/bitmap-inl.h"
@@ -56,6 +58,8 @@ static constexpr size_t kStackMapSizeLogThreshold = 50 * KB;
 JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
                                    size_t max_capacity,
                                    bool generate_debug_info,
+                                   bool write_perf_map,
+                                   bool write_jitdump,
                                    std::string* error_msg) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   CHECK_GE(max_capacity, initial_capacity);
@@ -111,8 +115,13 @@ JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
   data_size = initial_capacity / 2;
   code_size = initial_capacity - data_size;
   DCHECK_EQ(code_size + data_size, initial_capacity);
+  // Debug info is generated for 'perf', which also needs the perf map for symbols.
+  JitPerfWriter* perf_writer =
+      (generate_debug_info || write_perf_map || write_jitdump)
+          ? JitPerfWriter::Create(generate_debug_info || write_perf_map, write_jitdump)
+          : nullptr;
   return new JitCodeCache(
-      code_map, data_map, code_size, data_size, max_capacity, garbage_collect_code);
+      code_map, data_map, code_size, data_size, max_capacity, garbage_collect_code, perf_writer);
 }
 
 JitCodeCache::JitCodeCache(MemMap* code_map,
@@ -120,7 +129,8 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
                            size_t initial_code_capacity,
                            size_t initial_data_capacity,
                            size_t max_capacity,
-                           bool garbage_collect_code)
+                           bool garbage_collect_code,
+                           JitPerfWriter* perf_writer)
     : lock_("Jit code cache", kJitCodeCacheLock),
       lock_cond_("Jit code cache variable", lock_),
       collection_in_progress_(false),
@@ -133,10 +143,12 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
       last_collection_increased_code_cache_(false),
       last_update_time_ns_(0),
       garbage_collect_code_(garbage_collect_code),
+      perf_writer_(perf_writer),
       used_memory_for_data_(0),
       used_memory_for_code_(0),
       number_of_compilations_(0),
       number_of_osr_compilations_(0),
+      number_of_baseline_compilations_(0),
       number_of_deoptimizations_(0),
       number_of_collections_(0),
       histogram_stack_map_memory_use_("Memory used for stack maps", 16),
@@ -202,7 +214,10 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                   size_t fp_spill_mask,
                                   const uint8_t* code,
                                   size_t code_size,
-                                  bool osr) {
+                                  bool osr,
+                                  bool baseline,
+                                  bool relocatable,
+                                  const ArenaSet<ArtMethod*>& cha_single_implementation_list) {
   uint8_t* result = CommitCodeInternal(self,
                                        method,
                                        vmap_table,
@@ -211,7 +226,10 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                        fp_spill_mask,
                                        code,
                                        code_size,
-                                       osr);
+                                       osr,
+                                       baseline,
+                                       relocatable,
+                                       cha_single_implementation_list);
   if (result == nullptr) {
     // Retry.
     GarbageCollectCache(self);
@@ -223,7 +241,10 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                 fp_spill_mask,
                                 code,
                                 code_size,
-                                osr);
+                                osr,
+                                baseline,
+                                relocatable,
+                                cha_single_implementation_list);
   }
   return result;
 }
@@ -256,6 +277,10 @@ void JitCodeCache::FreeCode(const void* code_ptr, ArtMethod* method ATTRIBUTE_UN
     const uint8_t* data = method_header->code_ - method_header->vmap_table_offset_;
     FreeData(const_cast<uint8_t*>(data));
   }
+  relocatable_code_.erase(code_ptr);
+  if (perf_writer_ != nullptr) {
+    perf_writer_->CodeUnloaded(code_ptr, method_header->GetCodeSize());
+  }
   FreeCode(reinterpret_cast<uint8_t*>(allocation));
 }
 
@@ -284,6 +309,14 @@ void JitCodeCache::RemoveMethodsIn(Thread* self, const LinearAlloc& alloc) {
       ++it;
     }
   }
+  for (auto it = baseline_code_map_.begin(); it != baseline_code_map_.end();) {
+    if (alloc.ContainsUnsafe(it->first)) {
+      // Note that the code has already been removed in the loop above.
+      it = baseline_code_map_.erase(it);
+    } else {
+      ++it;
+    }
+  }
   for (auto it = profiling_infos_.begin(); it != profiling_infos_.end();) {
     ProfilingInfo* info = *it;
     if (alloc.ContainsUnsafe(info->GetMethod())) {
@@ -313,7 +346,12 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
                                           size_t fp_spill_mask,
                                           const uint8_t* code,
                                           size_t code_size,
-                                          bool osr) {
+                                          bool osr,
+                                          bool baseline,
+                                          bool relocatable,
+                                          const ArenaSet<ArtMethod*>&
+                                              cha_single_implementation_list) {
+  DCHECK(!relocatable || (!osr && !baseline && cha_single_implementation_list.empty()));
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
   // Ensure the header ends up at expected instruction alignment.
   size_t header_size = RoundUp(sizeof(OatQuickMethodHeader), alignment);
@@ -351,11 +389,35 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
   // We need to update the entry point in the runnable state for the instrumentation.
   {
     MutexLock mu(self, lock_);
+    if (!cha_single_implementation_list.empty()) {
+      // Registering the dependencies under the code cache lock ensures an
+      // invalidation either happened before and fails the commit, or happens
+      // after and sees the code installed.
+      ClassHierarchyAnalysis* cha = Runtime::Current()->GetClassHierarchyAnalysis();
+      if (cha == nullptr || !cha->AddDependencies(cha_single_implementation_list,
+                                                  method,
+                                                  method_header)) {
+        VLOG(jit) << "JIT discarded code of " << PrettyMethod(method)
+                  << ": a method it devirtualized has been overridden";
+        ScopedCodeCacheWrite scc(code_map_.get());
+        FreeCode(memory);
+        return nullptr;
+      }
+    }
     method_code_map_.Put(code_ptr, method);
+    if (relocatable) {
+      relocatable_code_.insert(code_ptr);
+    }
     if (osr) {
       number_of_osr_compilations_++;
       osr_code_map_.Put(method, code_ptr);
     } else {
+      if (baseline) {
+        number_of_baseline_compilations_++;
+        baseline_code_map_.Overwrite(method, code_ptr);
+      } else {
+        baseline_code_map_.erase(method);
+      }
       Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
           method, method_header->GetEntryPoint());
     }
@@ -366,12 +428,16 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
     }
     last_update_time_ns_.StoreRelease(NanoTime());
     VLOG(jit)
-        << "JIT added (osr=" << std::boolalpha << osr << std::noboolalpha << ") "
+        << "JIT added (osr=" << std::boolalpha << osr
+        << ", baseline=" << baseline << std::noboolalpha << ") "
         << PrettyMethod(method) << "@" << method
         << " ccache_size=" << PrettySize(CodeCacheSizeLocked()) << ": "
         << " dcache_size=" << PrettySize(DataCacheSizeLocked()) << ": "
         << reinterpret_cast<const void*>(method_header->GetEntryPoint()) << ","
         << reinterpret_cast<const void*>(method_header->GetEntryPoint() + method_header->code_size_);
+    if (perf_writer_ != nullptr) {
+      perf_writer_->CodeLoaded(method, code_ptr, code_size, vmap_table, osr);
+    }
     histogram_code_memory_use_.AddValue(code_size);
     if (code_size > kCodeSizeLogThreshold) {
       LOG(INFO) << "JIT allocated "
@@ -660,6 +726,7 @@ void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
   ScopedTrace trace(__FUNCTION__);
   MutexLock mu(self, lock_);
   ScopedCodeCacheWrite scc(code_map_.get());
+  std::unordered_set<const OatQuickMethodHeader*> method_headers;
   // Iterate over all compiled code and remove entries that are not marked.
   for (auto it = method_code_map_.begin(); it != method_code_map_.end();) {
     const void* code_ptr = it->first;
@@ -668,10 +735,19 @@ void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
     if (GetLiveBitmap()->Test(allocation)) {
       ++it;
     } else {
+      method_headers.insert(OatQuickMethodHeader::FromCodePointer(code_ptr));
+      auto baseline_it = baseline_code_map_.find(method);
+      if (baseline_it != baseline_code_map_.end() && baseline_it->second == code_ptr) {
+        baseline_code_map_.erase(baseline_it);
+      }
       FreeCode(code_ptr, method);
       it = method_code_map_.erase(it);
     }
   }
+  ClassHierarchyAnalysis* cha = Runtime::Current()->GetClassHierarchyAnalysis();
+  if (cha != nullptr && !method_headers.empty()) {
+    cha->RemoveDependentsWithMethodHeaders(method_headers);
+  }
 }
 
 void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
@@ -913,8 +989,43 @@ bool JitCodeCache::IsOsrCompiled(ArtMethod* method) {
   return osr_code_map_.find(method) != osr_code_map_.end();
 }
 
-bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr) {
-  if (!osr && ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+bool JitCodeCache::IsBaselineCompiled(ArtMethod* method) {
+  MutexLock mu(Thread::Current(), lock_);
+  auto it = baseline_code_map_.find(method);
+  return (it != baseline_code_map_.end()) &&
+      (OatQuickMethodHeader::FromCodePointer(it->second)->GetEntryPoint() ==
+          method->GetEntryPointFromQuickCompiledCode());
+}
+
+void JitCodeCache::CopyRelocatableCode(std::vector<JitCodeSnapshot::MethodCode>* methods) {
+  MutexLock mu(Thread::Current(), lock_);
+  for (const void* code_ptr : relocatable_code_) {
+    ArtMethod* method = method_code_map_.Get(code_ptr);
+    const OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
+    if (method_header->GetEntryPoint() != method->GetEntryPointFromQuickCompiledCode() ||
+        !method_header->IsOptimized()) {
+      // The method does not use this code anymore, for example because it got deoptimized.
+      continue;
+    }
+    const uint8_t* stack_maps =
+        reinterpret_cast<const uint8_t*>(method_header->GetOptimizedCodeInfoPtr());
+    CodeInfoEncoding encoding(stack_maps);
+    JitCodeSnapshot::MethodCode method_code;
+    method_code.dex_file = method->GetDexFile();
+    method_code.method_index = method->GetDexMethodIndex();
+    method_code.frame_info = method_header->GetFrameInfo();
+    method_code.code.assign(method_header->GetCode(),
+                            method_header->GetCode() + method_header->GetCodeSize());
+    method_code.stack_maps.assign(stack_maps,
+                                  stack_maps + encoding.header_size + encoding.non_header_size);
+    methods->push_back(std::move(method_code));
+  }
+}
+
+bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr, bool baseline) {
+  if (!osr &&
+      ContainsPc(method->GetEntryPointFromQuickCompiledCode()) &&
+      (baseline || !IsBaselineCompiled(method))) {
     return false;
   }
 
@@ -1032,6 +1143,7 @@ void JitCodeCache::Dump(std::ostream& os) {
      << "Total number of JIT compilations: " << number_of_compilations_ << "\n"
      << "Total number of JIT compilations for on stack replacement: "
         << number_of_osr_compilations_ << "\n"
+     << "Total number of baseline JIT compilations: " << number_of_baseline_compilations_ << "\n"
      << "Total number of deoptimizations: " << number_of_deoptimizations_ << "\n"
      << "Total number of JIT code cache collections: " << number_of_collections_ << std::endl;
   histogram_stack_map_memory_use_.PrintMemoryUse(os);
@@ -20,11 +20,14 @@
 #include "instrumentation.h"
 
 #include "atomic.h"
+#include "base/arena_containers.h"
 #include "base/histogram-inl.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "gc/accounting/bitmap.h"
 #include "gc_root.h"
+#include "jit/jit_code_snapshot.h"
+#include "jit/jit_perf_writer.h"
 #include "jni.h"
 #include "method_reference.h"
 #include "oat_file.h"
@@ -57,10 +60,13 @@ class JitCodeCache {
   static constexpr size_t kReservedCapacity = kInitialCapacity * 4;
 
   // Create the code cache with a code + data capacity equal to "capacity", error message is passed
-  // in the out arg error_msg.
+  // in the out arg error_msg. `write_perf_map` and `write_jitdump` tell which files describe
+  // the compiled code to the 'perf' tool.
   static JitCodeCache* Create(size_t initial_capacity,
                               size_t max_capacity,
                               bool generate_debug_info,
+                              bool write_perf_map,
+                              bool write_jitdump,
                               std::string* error_msg);
 
   // Number of bytes allocated in the code cache.
@@ -69,7 +75,9 @@ class JitCodeCache {
   // Number of bytes allocated in the data cache.
   size_t DataCacheSize() REQUIRES(!lock_);
 
-  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr)
+  // Return whether `method` should be compiled. A method is compiled again only to
+  // replace its baseline code with optimized code.
+  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr, bool baseline)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
@@ -90,6 +98,11 @@ class JitCodeCache {
       REQUIRES(!lock_);
 
   // Allocate and write code and its metadata to the code cache.
+  // `cha_single_implementation_list` holds the methods whose single implementation
+  // the code relies on. The code is not committed if one of them got a second
+  // implementation during compilation. `baseline` tells whether the code comes from
+  // the baseline tier, and is expected to be replaced by optimized code. `relocatable`
+  // tells whether the code can be saved in a JitCodeSnapshot.
   uint8_t* CommitCode(Thread* self,
                       ArtMethod* method,
                       const uint8_t* vmap_table,
@@ -98,7 +111,10 @@ class JitCodeCache {
                       size_t fp_spill_mask,
                       const uint8_t* code,
                       size_t code_size,
-                      bool osr)
+                      bool osr,
+                      bool baseline,
+                      bool relocatable,
+                      const ArenaSet<ArtMethod*>& cha_single_implementation_list)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
@@ -188,14 +204,24 @@ class JitCodeCache {
 
   bool IsOsrCompiled(ArtMethod* method) REQUIRES(!lock_);
 
+  // Return true if the entry point of `method` is baseline compiled code.
+  bool IsBaselineCompiled(ArtMethod* method) REQUIRES(!lock_);
+
+  // Append to `methods` a copy of the relocatable code which methods currently use
+  // as entry point, to be saved in a JitCodeSnapshot.
+  void CopyRelocatableCode(std::vector<JitCodeSnapshot::MethodCode>* methods)
+      REQUIRES(!lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
  private:
-  // Take ownership of maps.
+  // Take ownership of maps and of the perf writer.
   JitCodeCache(MemMap* code_map,
                MemMap* data_map,
                size_t initial_code_capacity,
                size_t initial_data_capacity,
                size_t max_capacity,
-               bool garbage_collect_code);
+               bool garbage_collect_code,
+               JitPerfWriter* perf_writer);
 
   // Internal version of 'CommitCode' that will not retry if the
   // allocation fails. Return null if the allocation fails.
@@ -207,7 +233,10 @@ class JitCodeCache {
                               size_t fp_spill_mask,
                               const uint8_t* code,
                               size_t code_size,
-                              bool osr)
+                              bool osr,
+                              bool baseline,
+                              bool relocatable,
+                              const ArenaSet<ArtMethod*>& cha_single_implementation_list)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -281,6 +310,11 @@ class JitCodeCache {
   SafeMap<const void*, ArtMethod*> method_code_map_ GUARDED_BY(lock_);
   // Holds osr compiled code associated to the ArtMethod.
   SafeMap<ArtMethod*, const void*> osr_code_map_ GUARDED_BY(lock_);
+  // Holds the latest baseline compiled code of an ArtMethod, until it is replaced
+  // by optimized code.
+  SafeMap<ArtMethod*, const void*> baseline_code_map_ GUARDED_BY(lock_);
+  // Holds the compiled code which can be saved in a JitCodeSnapshot.
+  std::set<const void*> relocatable_code_ GUARDED_BY(lock_);
   // ProfilingInfo objects we have allocated.
   std::vector<ProfilingInfo*> profiling_infos_ GUARDED_BY(lock_);
 
@@ -306,6 +340,9 @@ class JitCodeCache {
   // Whether we can do garbage collection.
   const bool garbage_collect_code_;
 
+  // Describes the compiled code to the 'perf' tool, null if not requested.
+  std::unique_ptr<JitPerfWriter> perf_writer_;
+
   // The size in bytes of used memory for the data portion of the code cache.
   size_t used_memory_for_data_ GUARDED_BY(lock_);
 
@@ -318,6 +355,9 @@ class JitCodeCache {
   // Number of compilations for on-stack-replacement done throughout the lifetime of the JIT.
   size_t number_of_osr_compilations_ GUARDED_BY(lock_);
 
+  // Number of baseline compilations done throughout the lifetime of the JIT.
+  size_t number_of_baseline_compilations_ GUARDED_BY(lock_);
+
   // Number of deoptimizations done throughout the lifetime of the JIT.
   size_t number_of_deoptimizations_ GUARDED_BY(lock_);
 
@@ -0,0 +1,493 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit_code_snapshot.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include "art_method-inl.h"
+#include "base/arena_allocator.h"
+#include "base/arena_containers.h"
+#include "base/stringprintf.h"
+#include "base/systrace.h"
+#include "base/unix_file/fd_file.h"
+#include "dex_file.h"
+#include "gc/heap.h"
+#include "gc/space/image_space.h"
+#include "jit/jit_code_cache.h"
+#include "oat.h"
+#include "os.h"
+#include "runtime.h"
+#include "utils.h"
+
+namespace art {
+namespace jit {
+
+const uint8_t JitCodeSnapshot::kSnapshotMagic[] = { 'j', 'c', 's', '\n' };
+const uint8_t JitCodeSnapshot::kSnapshotVersion[] = { '0', '0', '1', '\0' };
+
+// The snapshot file starts with a header, followed by the dex file and method
+// tables. Strings, code and stack maps are stored after the tables, and referred
+// to by their offset in the file. All values are in the byte order of the runtime.
+struct JitCodeSnapshot::Header {
+  uint8_t magic[4];
+  uint8_t version[4];
+  uint8_t oat_version[4];
+  uint32_t instruction_set;
+  uint32_t boot_image_checksum;
+  // Adler-32 checksum of the file content following the header.
+  uint32_t data_checksum;
+  uint32_t file_size;
+  uint32_t configuration_key_offset;
+  uint32_t configuration_key_size;
+  uint32_t number_of_dex_files;
+  uint32_t number_of_methods;
+};
+
+struct JitCodeSnapshot::DexFileEntry {
+  uint32_t location_checksum;
+  uint32_t location_offset;
+  uint32_t location_size;
+};
+
+// Method entries are sorted by dex file index and method index.
+struct JitCodeSnapshot::MethodEntry {
+  uint32_t dex_file_index;
+  uint32_t method_index;
+  uint32_t frame_size_in_bytes;
+  uint32_t core_spill_mask;
+  uint32_t fp_spill_mask;
+  uint32_t code_offset;
+  uint32_t code_size;
+  uint32_t stack_maps_offset;
+  uint32_t stack_maps_size;
+};
+
+static uint32_t AppendData(std::vector<uint8_t>* data, const void* bytes, size_t size) {
+  uint32_t offset = dchecked_integral_cast<uint32_t>(data->size());
+  const uint8_t* begin = reinterpret_cast<const uint8_t*>(bytes);
+  data->insert(data->end(), begin, begin + size);
+  return offset;
+}
+
+static uint32_t ComputeDataChecksum(const uint8_t* data, size_t size) {
+  return adler32(adler32(0L, Z_NULL, 0), data, size);
+}
+
+uint32_t JitCodeSnapshot::ComputeBootImageChecksum() {
+  uint32_t checksum = adler32(0L, Z_NULL, 0);
+  for (gc::space::ImageSpace* space : Runtime::Current()->GetHeap()->GetBootImageSpaces()) {
+    uint32_t oat_checksum = space->GetImageHeader().GetOatChecksum();
+    checksum = adler32(checksum, reinterpret_cast<const uint8_t*>(&oat_checksum),
+                       sizeof(oat_checksum));
+  }
+  return checksum;
+}
+
+std::string JitCodeSnapshot::ComputeConfigurationKey() {
+  Runtime* runtime = Runtime::Current();
+  std::ostringstream oss;
+  oss << "debuggable=" << runtime->IsDebuggable() << "\n";
+  oss << "compiler-options=" << Join(runtime->GetCompilerOptions(), ' ') << "\n";
+  // The dex files of the class path are also checked one by one when installing code,
+  // but a change in the class path can change how the code of unchanged dex files
+  // behaves, for example by resolving to other classes.
+  std::vector<std::string> class_path;
+  Split(runtime->GetClassPathString(), ':', &class_path);
+  oss << "class-path=";
+  for (const std::string& location : class_path) {
+    uint32_t checksum = 0u;
+    std::string error_msg;
+    if (!DexFile::GetChecksum(location.c_str(), &checksum, &error_msg)) {
+      VLOG(jit) << "Could not compute the checksum of " << location << ": " << error_msg;
+    }
+    oss << location << "@" << checksum << ":";
+  }
+  oss << "\n";
+  return oss.str();
+}
+
+bool JitCodeSnapshot::Write(const std::string& filename,
+                            const std::vector<MethodCode>& methods,
+                            std::string* error_msg) {
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  // Number the dex files, and sort the methods to allow binary searching them.
+  std::vector<const DexFile*> dex_files;
+  SafeMap<const DexFile*, uint32_t> dex_file_indices;
+  for (const MethodCode& method : methods) {
+    if (dex_file_indices.find(method.dex_file) == dex_file_indices.end()) {
+      dex_file_indices.Put(method.dex_file, dex_files.size());
+      dex_files.push_back(method.dex_file);
+    }
+  }
+  std::vector<const MethodCode*> sorted_methods;
+  for (const MethodCode& method : methods) {
+    sorted_methods.push_back(&method);
+  }
+  std::sort(sorted_methods.begin(),
+            sorted_methods.end(),
+            [&dex_file_indices](const MethodCode* lhs, const MethodCode* rhs) {
+              return std::make_pair(dex_file_indices.Get(lhs->dex_file), lhs->method_index) <
+                  std::make_pair(dex_file_indices.Get(rhs->dex_file), rhs->method_index);
+            });
+
+  size_t tables_size = sizeof(Header) +
+      dex_files.size() * sizeof(DexFileEntry) +
+      sorted_methods.size() * sizeof(MethodEntry);
+  std::vector<uint8_t> data(tables_size, 0u);
+
+  std::string configuration_key = ComputeConfigurationKey();
+  Header header;
+  std::copy_n(kSnapshotMagic, sizeof(header.magic), header.magic);
+  std::copy_n(kSnapshotVersion, sizeof(header.version), header.version);
+  std::copy_n(OatHeader::kOatVersion, sizeof(header.oat_version), header.oat_version);
+  header.instruction_set = static_cast<uint32_t>(kRuntimeISA);
+  header.boot_image_checksum = ComputeBootImageChecksum();
+  header.configuration_key_size = configuration_key.size();
+  header.configuration_key_offset =
+      AppendData(&data, configuration_key.data(), configuration_key.size());
+  header.number_of_dex_files = dex_files.size();
+  header.number_of_methods = sorted_methods.size();
+
+  std::vector<DexFileEntry> dex_file_entries;
+  for (const DexFile* dex_file : dex_files) {
+    const std::string& location = dex_file->GetLocation();
+    DexFileEntry entry;
+    entry.location_checksum = dex_file->GetLocationChecksum();
+    entry.location_size = location.size();
+    entry.location_offset = AppendData(&data, location.data(), location.size());
+    dex_file_entries.push_back(entry);
+  }
+
+  std::vector<MethodEntry> method_entries;
+  for (const MethodCode* method : sorted_methods) {
+    MethodEntry entry;
+    entry.dex_file_index = dex_file_indices.Get(method->dex_file);
+    entry.method_index = method->method_index;
+    entry.frame_size_in_bytes = method->frame_info.FrameSizeInBytes();
+    entry.core_spill_mask = method->frame_info.CoreSpillMask();
+    entry.fp_spill_mask = method->frame_info.FpSpillMask();
+    entry.code_size = method->code.size();
+    entry.code_offset = AppendData(&data, method->code.data(), method->code.size());
+    entry.stack_maps_size = method->stack_maps.size();
+    entry.stack_maps_offset =
+        AppendData(&data, method->stack_maps.data(), method->stack_maps.size());
+    method_entries.push_back(entry);
+  }
+
+  header.file_size = data.size();
+  uint8_t* tables = data.data() + sizeof(Header);
+  std::copy_n(reinterpret_cast<const uint8_t*>(dex_file_entries.data()),
+              dex_file_entries.size() * sizeof(DexFileEntry),
+              tables);
+  std::copy_n(reinterpret_cast<const uint8_t*>(method_entries.data()),
+              method_entries.size() * sizeof(MethodEntry),
+              tables + dex_file_entries.size() * sizeof(DexFileEntry));
+  header.data_checksum = ComputeDataChecksum(tables, data.size() - sizeof(Header));
+  std::copy_n(reinterpret_cast<const uint8_t*>(&header), sizeof(Header), data.data());
+
+  // Write to a temporary file first, so that a process starting concurrently
+  // either sees the previous snapshot or the new one. The name is unique to the
+  // writing thread, so that concurrent writers do not write to the same file.
+  std::string temp_filename = StringPrintf("%s.%d.%d.tmp", filename.c_str(), getpid(), GetTid());
+  std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(temp_filename.c_str()));
+  if (file == nullptr) {
+    *error_msg = StringPrintf("Could not create %s: %s", temp_filename.c_str(), strerror(errno));
+    return false;
+  }
+  if (!file->WriteFully(data.data(), data.size())) {
+    *error_msg = StringPrintf("Could not write %s: %s", temp_filename.c_str(), strerror(errno));
+    file->Erase();
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    *error_msg = StringPrintf("Could not close %s: %s", temp_filename.c_str(), strerror(errno));
+    return false;
+  }
+  if (rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    *error_msg = StringPrintf("Could not rename %s to %s: %s",
+                              temp_filename.c_str(),
+                              filename.c_str(),
+                              strerror(errno));
+    unlink(temp_filename.c_str());
+    return false;
+  }
+  VLOG(jit) << "Wrote JIT code snapshot " << filename << " with " << methods.size()
+            << " methods, size=" << PrettySize(data.size());
+  return true;
+}
+
+std::unique_ptr<JitCodeSnapshot> JitCodeSnapshot::Open(const std::string& filename,
+                                                       std::string* error_msg) {
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  std::unique_ptr<File> file(OS::OpenFileForReading(filename.c_str()));
+  if (file == nullptr) {
+    *error_msg = StringPrintf("Could not open %s: %s", filename.c_str(), strerror(errno));
+    return nullptr;
+  }
+  int64_t length = file->GetLength();
+  if (length < static_cast<int64_t>(sizeof(Header)) ||
+      length > std::numeric_limits<uint32_t>::max()) {
+    *error_msg = StringPrintf("Invalid size %" PRId64 " of %s", length, filename.c_str());
+    return nullptr;
+  }
+  std::unique_ptr<MemMap> map(MemMap::MapFile(length,
+                                              PROT_READ,
+                                              MAP_PRIVATE,
+                                              file->Fd(),
+                                              /* start */ 0,
+                                              /* low_4gb */ false,
+                                              filename.c_str(),
+                                              error_msg));
+  if (map == nullptr) {
+    return nullptr;
+  }
+  std::unique_ptr<JitCodeSnapshot> snapshot(new JitCodeSnapshot(map.release()));
+  if (!snapshot->Validate(error_msg)) {
+    *error_msg = StringPrintf("Rejected JIT code snapshot %s: %s",
+                              filename.c_str(),
+                              error_msg->c_str());
+    return nullptr;
+  }
+  VLOG(jit) << "Opened JIT code snapshot " << filename << " with "
+            << snapshot->GetNumberOfMethods() << " methods";
+  return snapshot;
+}
+
+JitCodeSnapshot::JitCodeSnapshot(MemMap* map)
+    : map_(map),
+      lock_("JIT code snapshot lock") {}
+
+const JitCodeSnapshot::Header& JitCodeSnapshot::GetHeader() const {
+  return *reinterpret_cast<const Header*>(map_->Begin());
+}
+
+const JitCodeSnapshot::DexFileEntry* JitCodeSnapshot::GetDexFileEntries() const {
+  return reinterpret_cast<const DexFileEntry*>(map_->Begin() + sizeof(Header));
+}
+
+const JitCodeSnapshot::MethodEntry* JitCodeSnapshot::GetMethodEntries() const {
+  return reinterpret_cast<const MethodEntry*>(
+      GetDexFileEntries() + GetHeader().number_of_dex_files);
+}
+
+std::string JitCodeSnapshot::GetString(uint32_t offset, uint32_t size) const {
+  return std::string(reinterpret_cast<const char*>(map_->Begin() + offset), size);
+}
+
+size_t JitCodeSnapshot::GetNumberOfMethods() const {
+  return GetHeader().number_of_methods;
+}
+
+bool JitCodeSnapshot::Validate(std::string* error_msg) const {
+  const Header& header = GetHeader();
+  size_t size = map_->Size();
+  if (!std::equal(kSnapshotMagic, kSnapshotMagic + sizeof(header.magic), header.magic)) {
+    *error_msg = "invalid magic";
+    return false;
+  }
+  if (!std::equal(kSnapshotVersion, kSnapshotVersion + sizeof(header.version), header.version)) {
+    *error_msg = "unsupported version";
+    return false;
+  }
+  if (header.file_size != size ||
+      header.data_checksum != ComputeDataChecksum(map_->Begin() + sizeof(Header),
+                                                  size - sizeof(Header))) {
+    *error_msg = "truncated or corrupted file";
+    return false;
+  }
+  if (!std::equal(OatHeader::kOatVersion,
+                  OatHeader::kOatVersion + sizeof(header.oat_version),
+                  header.oat_version)) {
+    *error_msg = "created by a different runtime version";
+    return false;
+  }
+  if (header.instruction_set != static_cast<uint32_t>(kRuntimeISA)) {
+    *error_msg = StringPrintf(
+        "created for instruction set %s",
+        GetInstructionSetString(static_cast<InstructionSet>(header.instruction_set)));
+    return false;
+  }
+  if (header.boot_image_checksum != ComputeBootImageChecksum()) {
+    *error_msg = "boot image checksum mismatch";
+    return false;
+  }
+
+  // Check that the tables and the data they refer to are within the file.
+  auto in_bounds = [size](uint64_t offset, uint64_t length) {
+    return offset <= size && length <= size - offset;
+  };
+  uint64_t tables_size = sizeof(Header) +
+      static_cast<uint64_t>(header.number_of_dex_files) * sizeof(DexFileEntry) +
+      static_cast<uint64_t>(header.number_of_methods) * sizeof(MethodEntry);
+  if (!in_bounds(0u, tables_size) ||
+      !in_bounds(header.configuration_key_offset, header.configuration_key_size)) {
+    *error_msg = "invalid layout";
+    return false;
+  }
+  const DexFileEntry* dex_file_entries = GetDexFileEntries();
+  for (uint32_t i = 0; i != header.number_of_dex_files; ++i) {
+    if (!in_bounds(dex_file_entries[i].location_offset, dex_file_entries[i].location_size)) {
+      *error_msg = "invalid dex file entry";
+      return false;
+    }
+  }
+  const MethodEntry* method_entries = GetMethodEntries();
+  for (uint32_t i = 0; i != header.number_of_methods; ++i) {
+    const MethodEntry& entry = method_entries[i];
+    if (entry.dex_file_index >= header.number_of_dex_files ||
+        !in_bounds(entry.code_offset, entry.code_size) ||
+        !in_bounds(entry.stack_maps_offset, entry.stack_maps_size) ||
+        (i != 0 &&
+         std::make_pair(method_entries[i - 1].dex_file_index, method_entries[i - 1].method_index)
+            >= std::make_pair(entry.dex_file_index, entry.method_index))) {
+      *error_msg = "invalid method entry";
+      return false;
+    }
+  }
+
+  // Check the configuration last, as computing it reads the class path.
+  std::string configuration_key =
+      GetString(header.configuration_key_offset, header.configuration_key_size);
+  std::string current_configuration_key = ComputeConfigurationKey();
+  if (configuration_key != current_configuration_key) {
+    VLOG(jit) << "JIT code snapshot configuration:\n" << configuration_key
+              << "Current configuration:\n" << current_configuration_key;
+    *error_msg = "class path or compiler options mismatch";
+    return false;
+  }
+  return true;
+}
+
+int32_t JitCodeSnapshot::GetDexFileIndex(const DexFile& dex_file) {
+  auto it = dex_file_indices_.find(&dex_file);
+  if (it != dex_file_indices_.end()) {
+    return it->second;
+  }
+  int32_t index = -1;
+  const DexFileEntry* dex_file_entries = GetDexFileEntries();
+  for (uint32_t i = 0; i != GetHeader().number_of_dex_files; ++i) {
+    const DexFileEntry& entry = dex_file_entries[i];
+    if (entry.location_checksum == dex_file.GetLocationChecksum() &&
+        GetString(entry.location_offset, entry.location_size) == dex_file.GetLocation()) {
+      index = i;
+      break;
+    }
+  }
+  dex_file_indices_.Put(&dex_file, index);
+  return index;
+}
+
+const JitCodeSnapshot::MethodEntry* JitCodeSnapshot::FindMethodEntry(const DexFile& dex_file,
+                                                                     uint32_t method_index) {
+  int32_t dex_file_index;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    dex_file_index = GetDexFileIndex(dex_file);
+  }
+  if (dex_file_index < 0) {
+    return nullptr;
+  }
+  const MethodEntry* begin = GetMethodEntries();
+  const MethodEntry* end = begin + GetHeader().number_of_methods;
+  auto key = std::make_pair(static_cast<uint32_t>(dex_file_index), method_index);
+  const MethodEntry* entry = std::lower_bound(
+      begin,
+      end,
+      key,
+      [](const MethodEntry& lhs, const std::pair<uint32_t, uint32_t>& rhs) {
+        return std::make_pair(lhs.dex_file_index, lhs.method_index) < rhs;
+      });
+  if (entry == end || entry->dex_file_index != key.first || entry->method_index != key.second) {
+    return nullptr;
+  }
+  return entry;
+}
+
+bool JitCodeSnapshot::HasCodeFor(ArtMethod* method) {
+  if (method->IsProxyMethod() || method->IsNative()) {
+    return false;
+  }
+  return FindMethodEntry(*method->GetDexFile(), method->GetDexMethodIndex()) != nullptr;
+}
+
+bool JitCodeSnapshot::FindCode(const DexFile& dex_file,
+                               uint32_t method_index,
+                               MethodCode* method_code) {
+  const MethodEntry* entry = FindMethodEntry(dex_file, method_index);
+  if (entry == nullptr) {
+    return false;
+  }
+  const uint8_t* begin = map_->Begin();
+  method_code->dex_file = &dex_file;
+  method_code->method_index = method_index;
+  method_code->frame_info = QuickMethodFrameInfo(entry->frame_size_in_bytes,
+                                                 entry->core_spill_mask,
+                                                 entry->fp_spill_mask);
+  method_code->code.assign(begin + entry->code_offset,
+                           begin + entry->code_offset + entry->code_size);
+  method_code->stack_maps.assign(begin + entry->stack_maps_offset,
+                                 begin + entry->stack_maps_offset + entry->stack_maps_size);
+  return true;
+}
+
+bool JitCodeSnapshot::InstallCode(Thread* self, ArtMethod* method, JitCodeCache* code_cache) {
+  if (method->IsProxyMethod() || method->IsNative()) {
+    return false;
+  }
+  const MethodEntry* entry = FindMethodEntry(*method->GetDexFile(), method->GetDexMethodIndex());
+  if (entry == nullptr) {
+    return false;
+  }
+  const uint8_t* begin = map_->Begin();
+  uint8_t* stack_map_data = code_cache->ReserveData(self, entry->stack_maps_size, method);
+  if (stack_map_data == nullptr) {
+    return false;
+  }
+  std::copy_n(begin + entry->stack_maps_offset, entry->stack_maps_size, stack_map_data);
+  // Code in the snapshot never relies on class hierarchy analysis.
+  ArenaAllocator arena(Runtime::Current()->GetJitArenaPool());
+  ArenaSet<ArtMethod*> no_dependencies(std::less<ArtMethod*>(), arena.Adapter(kArenaAllocCHA));
+  const void* code = code_cache->CommitCode(self,
+                                            method,
+                                            stack_map_data,
+                                            entry->frame_size_in_bytes,
+                                            entry->core_spill_mask,
+                                            entry->fp_spill_mask,
+                                            begin + entry->code_offset,
+                                            entry->code_size,
+                                            /* osr */ false,
+                                            /* baseline */ false,
+                                            /* relocatable */ true,
+                                            no_dependencies);
+  if (code == nullptr) {
+    code_cache->ClearData(self, stack_map_data);
+    return false;
+  }
+  VLOG(jit) << "Installed code of " << PrettyMethod(method) << " from the JIT code snapshot";
+  return true;
+}
+
+}  // namespace jit
+}  // namespace art
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_JIT_JIT_CODE_SNAPSHOT_H_
+#define ART_RUNTIME_JIT_JIT_CODE_SNAPSHOT_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "mem_map.h"
+#include "quick/quick_method_frame_info.h"
+#include "safe_map.h"
+
+namespace art {
+
+class ArtMethod;
+class DexFile;
+class Thread;
+
+namespace jit {
+
+class JitCodeCache;
+
+/**
+ * A snapshot of the JIT code cache, saved to disk so that a later run of the
+ * same program can install the compiled code of its hot methods instead of
+ * compiling them again.
+ *
+ * Only relocatable code is saved, that is code which only refers to the process
+ * through the current method, the thread and the runtime entrypoints. Methods are
+ * keyed by the location and checksum of their dex file, and by their method index.
+ * A snapshot is rejected as a whole when the runtime configuration it was created
+ * for differs from the current one: instruction set, oat version, boot image,
+ * class path or compiler options.
+ *
+ * The snapshot file is mapped read-only, and code is copied to the code cache
+ * when a method gets invoked for the first time.
+ */
+class JitCodeSnapshot {
+ public:
+  // Compiled code of a method, as saved in a snapshot.
+  struct MethodCode {
+    const DexFile* dex_file;
+    uint32_t method_index;
+    QuickMethodFrameInfo frame_info;
+    std::vector<uint8_t> code;
+    std::vector<uint8_t> stack_maps;
+  };
+
+  // Write a snapshot of `methods` for the current runtime configuration to `filename`.
+  // The file is replaced atomically.
+  static bool Write(const std::string& filename,
+                    const std::vector<MethodCode>& methods,
+                    std::string* error_msg);
+
+  // Open the snapshot in `filename`. Return null and set `error_msg` if the file cannot
+  // be read, is corrupted, or was created for a different runtime configuration.
+  static std::unique_ptr<JitCodeSnapshot> Open(const std::string& filename,
+                                               std::string* error_msg);
+
+  // Return whether the snapshot holds code for `method`.
+  bool HasCodeFor(ArtMethod* method) SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Copy the code of `method` to `code_cache` and make it the entry point of `method`.
+  // Return whether the code was installed.
+  bool InstallCode(Thread* self, ArtMethod* method, JitCodeCache* code_cache)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Copy to `method_code` the code saved for the method `method_index` of `dex_file`.
+  // Return false if there is none.
+  bool FindCode(const DexFile& dex_file, uint32_t method_index, MethodCode* method_code)
+      REQUIRES(!lock_);
+
+  size_t GetNumberOfMethods() const;
+
+  static const uint8_t kSnapshotMagic[];
+  static const uint8_t kSnapshotVersion[];
+
+ private:
+  struct Header;
+  struct DexFileEntry;
+  struct MethodEntry;
+
+  explicit JitCodeSnapshot(MemMap* map);
+
+  // Check the layout of the mapped file.
+  bool Validate(std::string* error_msg) const;
+
+  const Header& GetHeader() const;
+  const DexFileEntry* GetDexFileEntries() const;
+  const MethodEntry* GetMethodEntries() const;
+  std::string GetString(uint32_t offset, uint32_t size) const;
+
+  // Return the index of `dex_file` in the dex file table, or -1 if the snapshot
+  // has no code for it.
+  int32_t GetDexFileIndex(const DexFile& dex_file) REQUIRES(lock_);
+
+  const MethodEntry* FindMethodEntry(const DexFile& dex_file, uint32_t method_index)
+      REQUIRES(!lock_);
+
+  // Return the boot image checksum and configuration key identifying the runtime
+  // configuration code in the snapshot can be used with.
+  static uint32_t ComputeBootImageChecksum();
+  static std::string ComputeConfigurationKey();
+
+  std::unique_ptr<MemMap> map_;
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Cache of the indices of dex files in the dex file table.
+  SafeMap<const DexFile*, int32_t> dex_file_indices_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(JitCodeSnapshot);
+};
+
+}  // namespace jit
+}  // namespace art
+
+#endif  // ART_RUNTIME_JIT_JIT_CODE_SNAPSHOT_H_
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "base/unix_file/fd_file.h"
+#include "common_runtime_test.h"
+#include "dex_file.h"
+#include "jit/jit_code_snapshot.h"
+#include "os.h"
+
+namespace art {
+namespace jit {
+
+class JitCodeSnapshotTest : public CommonRuntimeTest {
+ protected:
+  JitCodeSnapshot::MethodCode MakeMethodCode(const DexFile* dex_file,
+                                             uint32_t method_index,
+                                             size_t code_size,
+                                             size_t stack_maps_size) {
+    JitCodeSnapshot::MethodCode method_code;
+    method_code.dex_file = dex_file;
+    method_code.method_index = method_index;
+    method_code.frame_info = QuickMethodFrameInfo(64u, 0x3u, 0u);
+    for (size_t i = 0; i < code_size; ++i) {
+      method_code.code.push_back(static_cast<uint8_t>(method_index + i));
+    }
+    for (size_t i = 0; i < stack_maps_size; ++i) {
+      method_code.stack_maps.push_back(static_cast<uint8_t>(method_index * 3 + i));
+    }
+    return method_code;
+  }
+
+  void WriteSnapshot(const std::string& filename, const DexFile* dex_file) {
+    std::vector<JitCodeSnapshot::MethodCode> methods;
+    methods.push_back(MakeMethodCode(dex_file, 2u, 48u, 12u));
+    methods.push_back(MakeMethodCode(dex_file, 0u, 16u, 8u));
+    std::string error_msg;
+    ASSERT_TRUE(JitCodeSnapshot::Write(filename, methods, &error_msg)) << error_msg;
+  }
+};
+
+TEST_F(JitCodeSnapshotTest, WriteAndOpen) {
+  ScratchFile snapshot_file;
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Main"));
+  WriteSnapshot(snapshot_file.GetFilename(), dex_file.get());
+
+  std::string error_msg;
+  std::unique_ptr<JitCodeSnapshot> snapshot =
+      JitCodeSnapshot::Open(snapshot_file.GetFilename(), &error_msg);
+  ASSERT_TRUE(snapshot != nullptr) << error_msg;
+  ASSERT_EQ(2u, snapshot->GetNumberOfMethods());
+
+  for (uint32_t method_index : { 0u, 2u }) {
+    JitCodeSnapshot::MethodCode expected =
+        MakeMethodCode(dex_file.get(), method_index, method_index == 0u ? 16u : 48u,
+                       method_index == 0u ? 8u : 12u);
+    JitCodeSnapshot::MethodCode method_code;
+    ASSERT_TRUE(snapshot->FindCode(*dex_file, method_index, &method_code));
+    ASSERT_EQ(dex_file.get(), method_code.dex_file);
+    ASSERT_EQ(method_index, method_code.method_index);
+    ASSERT_EQ(expected.frame_info.FrameSizeInBytes(), method_code.frame_info.FrameSizeInBytes());
+    ASSERT_EQ(expected.frame_info.CoreSpillMask(), method_code.frame_info.CoreSpillMask());
+    ASSERT_EQ(expected.frame_info.FpSpillMask(), method_code.frame_info.FpSpillMask());
+    ASSERT_EQ(expected.code, method_code.code);
+    ASSERT_EQ(expected.stack_maps, method_code.stack_maps);
+  }
+
+  JitCodeSnapshot::MethodCode method_code;
+  ASSERT_FALSE(snapshot->FindCode(*dex_file, 1u, &method_code));
+
+  // Code is keyed by dex file location and checksum.
+  std::unique_ptr<const DexFile> other_dex_file(OpenTestDexFile("Nested"));
+  ASSERT_FALSE(snapshot->FindCode(*other_dex_file, 0u, &method_code));
+}
+
+TEST_F(JitCodeSnapshotTest, RejectCorrupted) {
+  ScratchFile snapshot_file;
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Main"));
+  WriteSnapshot(snapshot_file.GetFilename(), dex_file.get());
+
+  // The snapshot replaces the scratch file, reopen it by name.
+  std::unique_ptr<File> file(OS::OpenFileReadWrite(snapshot_file.GetFilename().c_str()));
+  ASSERT_TRUE(file != nullptr);
+  int64_t length = file->GetLength();
+  ASSERT_GT(length, 0);
+  uint8_t byte;
+  ASSERT_TRUE(file->PreadFully(&byte, 1u, length - 1));
+  byte ^= 0xff;
+  ASSERT_TRUE(file->PwriteFully(&byte, 1u, length - 1));
+  ASSERT_EQ(0, file->FlushClose());
+
+  std::string error_msg;
+  ASSERT_TRUE(JitCodeSnapshot::Open(snapshot_file.GetFilename(), &error_msg) == nullptr);
+  ASSERT_FALSE(error_msg.empty());
+}
+
+TEST_F(JitCodeSnapshotTest, RejectTruncated) {
+  ScratchFile snapshot_file;
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Main"));
+  WriteSnapshot(snapshot_file.GetFilename(), dex_file.get());
+
+  std::unique_ptr<File> file(OS::OpenFileReadWrite(snapshot_file.GetFilename().c_str()));
+  ASSERT_TRUE(file != nullptr);
+  int64_t length = file->GetLength();
+  ASSERT_EQ(0, file->SetLength(length / 2));
+  ASSERT_EQ(0, file->FlushClose());
+
+  std::string error_msg;
+  ASSERT_TRUE(JitCodeSnapshot::Open(snapshot_file.GetFilename(), &error_msg) == nullptr);
+  ASSERT_FALSE(error_msg.empty());
+}
+
+TEST_F(JitCodeSnapshotTest, RejectMissing) {
+  ScratchFile scratch_file;
+  std::string error_msg;
+  std::string filename = scratch_file.GetFilename() + ".missing";
+  ASSERT_TRUE(JitCodeSnapshot::Open(filename, &error_msg) == nullptr);
+  ASSERT_FALSE(error_msg.empty());
+}
+
+}  // namespace jit
+}  // namespace art
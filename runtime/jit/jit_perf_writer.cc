@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit_perf_writer.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "art_method-inl.h"
+#include "base/time_utils.h"
+#include "base/unix_file/fd_file.h"
+#include "dex_file.h"
+#include "elf_utils.h"
+#include "globals.h"
+#include "stack_map.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace jit {
+
+#ifdef __ANDROID__
+static constexpr const char* kPerfDirectory = "/data/misc/trace";
+#else
+static constexpr const char* kPerfDirectory = "/tmp";
+#endif
+
+// Constants of the jitdump format, as described in
+// tools/perf/Documentation/jitdump-specification.txt of the Linux sources.
+static constexpr uint32_t kJitDumpMagic = 0x4A695444;
+static constexpr uint32_t kJitDumpVersion = 1;
+static constexpr uint32_t kJitDumpHeaderSize = 40;
+static constexpr uint32_t kJitDumpRecordHeaderSize = 16;
+static constexpr uint32_t kJitCodeLoad = 0;
+static constexpr uint32_t kJitCodeDebugInfo = 2;
+static constexpr uint32_t kJitCodeClose = 3;
+
+template <typename T>
+static void Append(std::vector<uint8_t>* buffer, T value) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  buffer->insert(buffer->end(), bytes, bytes + sizeof(T));
+}
+
+static void AppendString(std::vector<uint8_t>* buffer, const std::string& str) {
+  buffer->insert(buffer->end(), str.begin(), str.end());
+  buffer->push_back(0u);
+}
+
+static uint32_t GetElfMachine() {
+  switch (kRuntimeISA) {
+    case kArm:
+    case kThumb2:
+      return EM_ARM;
+    case kArm64:
+      return EM_AARCH64;
+    case kX86:
+      return EM_386;
+    case kX86_64:
+      return EM_X86_64;
+    case kMips:
+    case kMips64:
+      return EM_MIPS;
+    default:
+      return EM_NONE;
+  }
+}
+
+JitPerfWriter* JitPerfWriter::Create(bool write_perf_map, bool write_jitdump) {
+  std::string suffix = std::to_string(getpid());
+  std::unique_ptr<File> perf_map_file;
+  if (write_perf_map) {
+    std::string filename = std::string(kPerfDirectory) + "/perf-" + suffix + ".map";
+    perf_map_file.reset(OS::CreateEmptyFileWriteOnly(filename.c_str()));
+    if (perf_map_file == nullptr) {
+      PLOG(ERROR) << "Could not create perf map at " << filename
+                  << ". Are you on a user build? Perf only works on userdebug/eng builds";
+    }
+  }
+  std::unique_ptr<File> jitdump_file;
+  void* jitdump_marker = MAP_FAILED;
+  if (write_jitdump) {
+    std::string filename = std::string(kPerfDirectory) + "/jit-" + suffix + ".dump";
+    jitdump_file.reset(OS::CreateEmptyFile(filename.c_str()));
+    if (jitdump_file == nullptr) {
+      PLOG(ERROR) << "Could not create jitdump file at " << filename;
+    } else {
+      // 'perf record' only looks at files that the process maps executable.
+      jitdump_marker = mmap(nullptr,
+                            kPageSize,
+                            PROT_READ | PROT_EXEC,
+                            MAP_PRIVATE,
+                            jitdump_file->Fd(),
+                            0);
+      if (jitdump_marker == MAP_FAILED) {
+        PLOG(ERROR) << "Could not map jitdump file " << filename;
+        jitdump_file->Erase();
+        jitdump_file.reset();
+      }
+    }
+  }
+  if (perf_map_file == nullptr && jitdump_file == nullptr) {
+    return nullptr;
+  }
+  JitPerfWriter* writer =
+      new JitPerfWriter(perf_map_file.release(), jitdump_file.release(), jitdump_marker);
+  MutexLock mu(Thread::Current(), writer->lock_);
+  if (writer->jitdump_file_ != nullptr) {
+    writer->WriteJitDumpHeader();
+  }
+  return writer;
+}
+
+JitPerfWriter::JitPerfWriter(File* perf_map_file, File* jitdump_file, void* jitdump_marker)
+    : lock_("JIT perf writer lock"),
+      perf_map_file_(perf_map_file),
+      jitdump_file_(jitdump_file),
+      jitdump_marker_(jitdump_marker),
+      code_index_(0u) {}
+
+JitPerfWriter::~JitPerfWriter() {
+  MutexLock mu(Thread::Current(), lock_);
+  if (perf_map_file_ != nullptr) {
+    UNUSED(perf_map_file_->FlushClose());
+  }
+  if (jitdump_file_ != nullptr) {
+    WriteJitDumpRecord(kJitCodeClose, std::vector<uint8_t>());
+    UNUSED(jitdump_file_->FlushClose());
+  }
+  if (jitdump_marker_ != MAP_FAILED) {
+    munmap(jitdump_marker_, kPageSize);
+  }
+}
+
+void JitPerfWriter::WritePerfMapEntry(const void* code,
+                                      size_t code_size,
+                                      const std::string& name) {
+  std::ostringstream oss;
+  oss << std::hex << reinterpret_cast<uintptr_t>(code) << " " << code_size << " " << name << "\n";
+  std::string str = oss.str();
+  if (!perf_map_file_->WriteFully(str.c_str(), str.size())) {
+    PLOG(WARNING) << "Failed to write perf map, disabling it";
+    UNUSED(perf_map_file_->FlushClose());
+    perf_map_file_.reset();
+  }
+}
+
+void JitPerfWriter::WriteJitDumpHeader() {
+  std::vector<uint8_t> header;
+  Append<uint32_t>(&header, kJitDumpMagic);
+  Append<uint32_t>(&header, kJitDumpVersion);
+  Append<uint32_t>(&header, kJitDumpHeaderSize);
+  Append<uint32_t>(&header, GetElfMachine());
+  Append<uint32_t>(&header, 0u);  // Padding.
+  Append<uint32_t>(&header, static_cast<uint32_t>(getpid()));
+  Append<uint64_t>(&header, NanoTime());
+  Append<uint64_t>(&header, 0u);  // Flags.
+  DCHECK_EQ(header.size(), kJitDumpHeaderSize);
+  if (!jitdump_file_->WriteFully(header.data(), header.size())) {
+    PLOG(WARNING) << "Failed to write jitdump file, disabling it";
+    UNUSED(jitdump_file_->FlushClose());
+    jitdump_file_.reset();
+  }
+}
+
+void JitPerfWriter::WriteJitDumpRecord(uint32_t id, const std::vector<uint8_t>& body) {
+  std::vector<uint8_t> header;
+  Append<uint32_t>(&header, id);
+  Append<uint32_t>(&header, kJitDumpRecordHeaderSize + body.size());
+  // Timestamps use the monotonic clock, see 'perf record -k mono'.
+  Append<uint64_t>(&header, NanoTime());
+  DCHECK_EQ(header.size(), kJitDumpRecordHeaderSize);
+  if (!jitdump_file_->WriteFully(header.data(), header.size()) ||
+      !jitdump_file_->WriteFully(body.data(), body.size())) {
+    PLOG(WARNING) << "Failed to write jitdump file, disabling it";
+    UNUSED(jitdump_file_->FlushClose());
+    jitdump_file_.reset();
+  }
+}
+
+void JitPerfWriter::WriteJitDumpDebugInfo(ArtMethod* method,
+                                          const uint8_t* code,
+                                          const uint8_t* stack_maps) {
+  const char* source_file = method->GetDeclaringClassSourceFile();
+  if (source_file == nullptr || stack_maps == nullptr) {
+    return;
+  }
+  // Map the native pc of each stack map to the line of its dex pc. Inlined frames
+  // are attributed to the line of the call in the outer method.
+  CodeInfo code_info(stack_maps);
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  std::vector<std::pair<uint32_t, int32_t>> lines;
+  for (size_t i = 0, e = code_info.GetNumberOfStackMaps(encoding); i < e; ++i) {
+    StackMap stack_map = code_info.GetStackMapAt(i, encoding);
+    uint32_t dex_pc = stack_map.GetDexPc(encoding.stack_map_encoding);
+    if (dex_pc == DexFile::kDexNoIndex) {
+      continue;
+    }
+    int32_t line = method->GetLineNumFromDexPC(dex_pc);
+    if (line > 0) {
+      lines.emplace_back(stack_map.GetNativePcOffset(encoding.stack_map_encoding), line);
+    }
+  }
+  if (lines.empty()) {
+    return;
+  }
+  std::sort(lines.begin(), lines.end());
+
+  std::vector<uint8_t> body;
+  Append<uint64_t>(&body, reinterpret_cast<uintptr_t>(code));
+  size_t number_of_entries_position = body.size();
+  Append<uint64_t>(&body, 0u);
+  uint64_t number_of_entries = 0u;
+  int32_t previous_line = -1;
+  for (const std::pair<uint32_t, int32_t>& entry : lines) {
+    if (entry.second == previous_line) {
+      continue;
+    }
+    previous_line = entry.second;
+    Append<uint64_t>(&body, reinterpret_cast<uintptr_t>(code) + entry.first);
+    Append<uint32_t>(&body, static_cast<uint32_t>(entry.second));
+    Append<uint32_t>(&body, 0u);  // Discriminator.
+    AppendString(&body, source_file);
+    ++number_of_entries;
+  }
+  memcpy(body.data() + number_of_entries_position, &number_of_entries, sizeof(uint64_t));
+  WriteJitDumpRecord(kJitCodeDebugInfo, body);
+}
+
+void JitPerfWriter::CodeLoaded(ArtMethod* method,
+                               const uint8_t* code,
+                               size_t code_size,
+                               const uint8_t* stack_maps,
+                               bool osr) {
+  std::string name = PrettyMethod(method);
+  if (osr) {
+    name += " [osr]";
+  }
+  MutexLock mu(Thread::Current(), lock_);
+  if (perf_map_file_ != nullptr) {
+    WritePerfMapEntry(code, code_size, name);
+    code_names_.Overwrite(code, name);
+  }
+  if (jitdump_file_ != nullptr) {
+    // Perf expects the debug info of a method before its code.
+    WriteJitDumpDebugInfo(method, code, stack_maps);
+  }
+  if (jitdump_file_ != nullptr) {
+    std::vector<uint8_t> body;
+    Append<uint32_t>(&body, static_cast<uint32_t>(getpid()));
+    Append<uint32_t>(&body, static_cast<uint32_t>(GetTid()));
+    Append<uint64_t>(&body, reinterpret_cast<uintptr_t>(code));
+    Append<uint64_t>(&body, reinterpret_cast<uintptr_t>(code));
+    Append<uint64_t>(&body, code_size);
+    Append<uint64_t>(&body, code_index_++);
+    AppendString(&body, name);
+    body.insert(body.end(), code, code + code_size);
+    WriteJitDumpRecord(kJitCodeLoad, body);
+  }
+}
+
+void JitPerfWriter::CodeUnloaded(const void* code, size_t code_size) {
+  MutexLock mu(Thread::Current(), lock_);
+  auto it = code_names_.find(code);
+  if (it == code_names_.end()) {
+    return;
+  }
+  if (perf_map_file_ != nullptr) {
+    // Tools reading the map take the last entry for an address, until code is
+    // compiled there again.
+    WritePerfMapEntry(code, code_size, "[collected] " + it->second);
+  }
+  code_names_.erase(it);
+  // The jitdump format has no unload record: perf orders code loads by timestamp.
+}
+
+}  // namespace jit
+}  // namespace art
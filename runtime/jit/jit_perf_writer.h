@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_JIT_JIT_PERF_WRITER_H_
+#define ART_RUNTIME_JIT_JIT_PERF_WRITER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "os.h"
+#include "safe_map.h"
+
+namespace art {
+
+class ArtMethod;
+
+namespace jit {
+
+/**
+ * Describes JIT compiled code to the Linux 'perf' tool, so that profiles
+ * show method names instead of anonymous addresses in the code cache.
+ *
+ * Two formats are supported:
+ * - The perf map `perf-<pid>.map`, one text line per compiled method. Perf maps
+ *   cannot remove entries, so collected code is marked with a "[collected]" entry.
+ * - The jitdump file `jit-<pid>.dump`, which `perf inject --jit` uses to build ELF
+ *   files with the code bytes and line tables. Records are timestamped, which lets
+ *   perf tell apart methods compiled at the same address over time.
+ */
+class JitPerfWriter {
+ public:
+  // Create a writer for the perf map if `write_perf_map`, and for the jitdump file
+  // if `write_jitdump`. Return null if no file could be created.
+  static JitPerfWriter* Create(bool write_perf_map, bool write_jitdump);
+
+  ~JitPerfWriter();
+
+  // Record that `code` has been compiled for `method`. The line table of the jitdump
+  // file is derived from the dex pcs of the stack maps in `stack_maps`.
+  void CodeLoaded(ArtMethod* method,
+                  const uint8_t* code,
+                  size_t code_size,
+                  const uint8_t* stack_maps,
+                  bool osr)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Record that `code` has been freed from the code cache.
+  void CodeUnloaded(const void* code, size_t code_size) REQUIRES(!lock_);
+
+ private:
+  JitPerfWriter(File* perf_map_file, File* jitdump_file, void* jitdump_marker);
+
+  void WritePerfMapEntry(const void* code, size_t code_size, const std::string& name)
+      REQUIRES(lock_);
+  void WriteJitDumpHeader() REQUIRES(lock_);
+  void WriteJitDumpRecord(uint32_t id, const std::vector<uint8_t>& body) REQUIRES(lock_);
+  void WriteJitDumpDebugInfo(ArtMethod* method, const uint8_t* code, const uint8_t* stack_maps)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(lock_);
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::unique_ptr<File> perf_map_file_ GUARDED_BY(lock_);
+  std::unique_ptr<File> jitdump_file_ GUARDED_BY(lock_);
+  // Executable mapping of the jitdump file, through which 'perf record' finds the file.
+  void* const jitdump_marker_;
+  // Index of the next code load record.
+  uint64_t code_index_ GUARDED_BY(lock_);
+  // Names of the code in the code cache, to mark the perf map entries of collected code.
+  SafeMap<const void*, std::string> code_names_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(JitPerfWriter);
+};
+
+}  // namespace jit
+}  // namespace art
+
+#endif  // ART_RUNTIME_JIT_JIT_PERF_WRITER_H_
@@ -17,6 +17,7 @@
 #include "profiling_info.h"
 
 #include "art_method-inl.h"
+#include "base/time_utils.h"
 #include "dex_instruction.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
@@ -31,6 +32,7 @@ ProfilingInfo::ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& ent
         is_method_being_compiled_(false),
         is_osr_method_being_compiled_(false),
         current_inline_uses_(0),
+        creation_time_ms_(static_cast<uint32_t>(MilliTime())),
         saved_entry_point_(nullptr) {
   memset(&cache_, 0, number_of_inline_caches_ * sizeof(InlineCache));
   for (size_t i = 0; i < number_of_inline_caches_; ++i) {
@@ -21,6 +21,7 @@
 
 #include "base/macros.h"
 #include "gc_root.h"
+#include "offsets.h"
 
 namespace art {
 
@@ -75,6 +76,12 @@ class InlineCache {
 
   static constexpr uint16_t kIndividualCacheSize = 5;
 
+  // Offset of the first class in the cache, read by baseline JIT code to skip
+  // updating the cache of monomorphic calls.
+  static MemberOffset ClassesOffset() {
+    return MemberOffset(OFFSETOF_MEMBER(InlineCache, classes_));
+  }
+
  private:
   uint32_t dex_pc_;
   GcRoot<mirror::Class> classes_[kIndividualCacheSize];
@@ -161,6 +168,11 @@ class ProfilingInfo {
     current_inline_uses_--;
   }
 
+  // Returns the time, in milliseconds, at which the method became warm.
+  uint32_t GetCreationTimeMs() const {
+    return creation_time_ms_;
+  }
+
   bool IsInUseByCompiler() const {
     return IsMethodBeingCompiled(/*osr*/ true) || IsMethodBeingCompiled(/*osr*/ false) ||
         (current_inline_uses_ > 0);
@@ -188,6 +200,10 @@ class ProfilingInfo {
   // it updates this counter so that the GC does not try to clear the inline caches.
   uint16_t current_inline_uses_;
 
+  // Truncated value of MilliTime() when this ProfilingInfo was created. Only meant
+  // to compute durations, which wrap around correctly.
+  const uint32_t creation_time_ms_;
+
   // Entry point of the corresponding ArtMethod, while the JIT code cache
   // is poking for the liveness of compiled code.
   const void* saved_entry_point_;
@@ -242,6 +242,21 @@ static void ThrowSIOOBE(ScopedObjectAccess& soa, jsize start, jsize length,
                                  array_length);
 }
 
+// Returns a new array of the UTF-16 chars of the string, to be released with delete[].
+static jchar* CopyStringChars(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_) {
+  const int32_t length = s->GetLength();
+  jchar* chars = new jchar[length];
+  if (s->IsCompressed()) {
+    const uint8_t* src = s->GetValueCompressed();
+    for (int32_t i = 0; i < length; ++i) {
+      chars[i] = src[i];
+    }
+  } else {
+    memcpy(chars, s->GetValue(), sizeof(jchar) * length);
+  }
+  return chars;
+}
+
 int ThrowNewException(JNIEnv* env, jclass exception_class, const char* msg, jobject cause)
     REQUIRES(!Locks::mutator_lock_) {
   // Turn the const char* into a java.lang.String.
@@ -1669,8 +1684,15 @@ class JNI {
       ThrowSIOOBE(soa, start, length, s->GetLength());
     } else {
       CHECK_NON_NULL_MEMCPY_ARGUMENT(length, buf);
-      const jchar* chars = s->GetValue();
-      memcpy(buf, chars + start, length * sizeof(jchar));
+      if (s->IsCompressed()) {
+        const uint8_t* chars = s->GetValueCompressed();
+        for (jsize i = 0; i < length; ++i) {
+          buf[i] = static_cast<jchar>(chars[start + i]);
+        }
+      } else {
+        const jchar* chars = s->GetValue();
+        memcpy(buf, chars + start, length * sizeof(jchar));
+      }
     }
   }
 
@@ -1683,9 +1705,15 @@ class JNI {
       ThrowSIOOBE(soa, start, length, s->GetLength());
     } else {
       CHECK_NON_NULL_MEMCPY_ARGUMENT(length, buf);
-      const jchar* chars = s->GetValue();
-      size_t bytes = CountUtf8Bytes(chars + start, length);
-      ConvertUtf16ToModifiedUtf8(buf, bytes, chars + start, length);
+      if (s->IsCompressed()) {
+        const uint8_t* chars = s->GetValueCompressed();
+        size_t bytes = CountUtf8Bytes(chars + start, length);
+        ConvertUtf16ToModifiedUtf8(buf, bytes, chars + start, length);
+      } else {
+        const jchar* chars = s->GetValue();
+        size_t bytes = CountUtf8Bytes(chars + start, length);
+        ConvertUtf16ToModifiedUtf8(buf, bytes, chars + start, length);
+      }
     }
   }
 
@@ -1694,9 +1722,8 @@ class JNI {
     ScopedObjectAccess soa(env);
     mirror::String* s = soa.Decode<mirror::String*>(java_string);
     gc::Heap* heap = Runtime::Current()->GetHeap();
-    if (heap->IsMovableObject(s)) {
-      jchar* chars = new jchar[s->GetLength()];
-      memcpy(chars, s->GetValue(), sizeof(jchar) * s->GetLength());
+    if (heap->IsMovableObject(s) || s->IsCompressed()) {
+      jchar* chars = CopyStringChars(s);
       if (is_copy != nullptr) {
         *is_copy = JNI_TRUE;
       }
@@ -1712,7 +1739,7 @@ class JNI {
     CHECK_NON_NULL_ARGUMENT_RETURN_VOID(java_string);
     ScopedObjectAccess soa(env);
     mirror::String* s = soa.Decode<mirror::String*>(java_string);
-    if (chars != s->GetValue()) {
+    if (s->IsCompressed() || chars != s->GetValue()) {
       delete[] chars;
     }
   }
@@ -1721,6 +1748,13 @@ class JNI {
     CHECK_NON_NULL_ARGUMENT(java_string);
     ScopedObjectAccess soa(env);
     mirror::String* s = soa.Decode<mirror::String*>(java_string);
+    if (s->IsCompressed()) {
+      // There are no UTF-16 chars to point to, return a copy.
+      if (is_copy != nullptr) {
+        *is_copy = JNI_TRUE;
+      }
+      return CopyStringChars(s);
+    }
     gc::Heap* heap = Runtime::Current()->GetHeap();
     if (heap->IsMovableObject(s)) {
       StackHandleScope<1> hs(soa.Self());
@@ -1741,12 +1775,14 @@ class JNI {
 
   static void ReleaseStringCritical(JNIEnv* env,
                                     jstring java_string,
-                                    const jchar* chars ATTRIBUTE_UNUSED) {
+                                    const jchar* chars) {
     CHECK_NON_NULL_ARGUMENT_RETURN_VOID(java_string);
     ScopedObjectAccess soa(env);
     gc::Heap* heap = Runtime::Current()->GetHeap();
     mirror::String* s = soa.Decode<mirror::String*>(java_string);
-    if (heap->IsMovableObject(s)) {
+    if (s->IsCompressed()) {
+      delete[] chars;
+    } else if (heap->IsMovableObject(s)) {
       if (!kUseReadBarrier) {
         heap->DecrementDisableMovingGC(soa.Self());
       } else {
@@ -1767,8 +1803,11 @@ class JNI {
     size_t byte_count = s->GetUtfLength();
     char* bytes = new char[byte_count + 1];
     CHECK(bytes != nullptr);  // bionic aborts anyway.
-    const uint16_t* chars = s->GetValue();
-    ConvertUtf16ToModifiedUtf8(bytes, byte_count, chars, s->GetLength());
+    if (s->IsCompressed()) {
+      ConvertUtf16ToModifiedUtf8(bytes, byte_count, s->GetValueCompressed(), s->GetLength());
+    } else {
+      ConvertUtf16ToModifiedUtf8(bytes, byte_count, s->GetValue(), s->GetLength());
+    }
     bytes[byte_count] = '\0';
     return bytes;
   }
@@ -17,6 +17,9 @@
 #ifndef ART_RUNTIME_MIRROR_CLASS_H_
 #define ART_RUNTIME_MIRROR_CLASS_H_
 
+#include <atomic>
+#include <type_traits>
+
 #include "base/iteration_range.h"
 #include "dex_file.h"
 #include "class_flags.h"
@@ -53,6 +56,13 @@ class Constructor;
 class DexCache;
 class IfTable;
 class Method;
+template <typename T> struct DexCachePair;
+using StringDexCachePair = DexCachePair<String>;
+
+// The type of the elements of the strings array of a DexCache, see DexCache::NumStringSlots().
+using StringDexCacheType = std::conditional<kUseHashedDexCache,
+                                            std::atomic<StringDexCachePair>,
+                                            GcRoot<String>>::type;
 
 // C++ mirror of java.lang.Class
 class MANAGED Class FINAL : public Object {
@@ -1206,8 +1216,8 @@ class MANAGED Class FINAL : public Object {
   bool GetSlowPathEnabled() SHARED_REQUIRES(Locks::mutator_lock_);
   void SetSlowPath(bool enabled) SHARED_REQUIRES(Locks::mutator_lock_);
 
-  GcRoot<String>* GetDexCacheStrings() SHARED_REQUIRES(Locks::mutator_lock_);
-  void SetDexCacheStrings(GcRoot<String>* new_dex_cache_strings)
+  StringDexCacheType* GetDexCacheStrings() SHARED_REQUIRES(Locks::mutator_lock_);
+  void SetDexCacheStrings(StringDexCacheType* new_dex_cache_strings)
       SHARED_REQUIRES(Locks::mutator_lock_);
   static MemberOffset DexCacheStringsOffset() {
     return OFFSET_OF_OBJECT_MEMBER(Class, dex_cache_strings_);
@@ -34,28 +34,79 @@ inline uint32_t DexCache::ClassSize(size_t pointer_size) {
   return Class::ComputeClassSize(true, vtable_entries, 0, 0, 0, 0, 0, pointer_size);
 }
 
+template <ReadBarrierOption kReadBarrierOption, typename T>
+inline T* DexCache::LookupSlot(GcRoot<T>* slot, uint32_t idx ATTRIBUTE_UNUSED) {
+  return slot->template Read<kReadBarrierOption>();
+}
+
+template <ReadBarrierOption kReadBarrierOption, typename T>
+inline T* DexCache::LookupSlot(std::atomic<DexCachePair<T>>* slot, uint32_t idx) {
+  DexCachePair<T> pair = slot->load(std::memory_order_relaxed);
+  return pair.index == idx ? pair.object.template Read<kReadBarrierOption>() : nullptr;
+}
+
+template <typename T>
+inline void DexCache::AssignSlot(GcRoot<T>* slot, uint32_t idx ATTRIBUTE_UNUSED, T* object) {
+  *slot = GcRoot<T>(object);
+}
+
+template <typename T>
+inline void DexCache::AssignSlot(std::atomic<DexCachePair<T>>* slot, uint32_t idx, T* object) {
+  DexCachePair<T> pair;
+  pair.object = GcRoot<T>(object);
+  pair.index = idx;
+  slot->store(pair, std::memory_order_relaxed);
+}
+
+template <ReadBarrierOption kReadBarrierOption, typename T>
+inline T* DexCache::ReadSlot(GcRoot<T>* slot, size_t slot_idx, uint32_t* idx) {
+  *idx = slot_idx;
+  return slot->template Read<kReadBarrierOption>();
+}
+
+template <ReadBarrierOption kReadBarrierOption, typename T>
+inline T* DexCache::ReadSlot(std::atomic<DexCachePair<T>>* slot,
+                             size_t slot_idx ATTRIBUTE_UNUSED,
+                             uint32_t* idx) {
+  DexCachePair<T> pair = slot->load(std::memory_order_relaxed);
+  *idx = pair.index;
+  return pair.object.template Read<kReadBarrierOption>();
+}
+
+template <ReadBarrierOption kReadBarrierOption>
+inline String* DexCache::GetStringSlot(size_t slot_idx, uint32_t* string_idx) {
+  DCHECK_LT(slot_idx, NumStrings());
+  return ReadSlot<kReadBarrierOption>(&GetStrings()[slot_idx], slot_idx, string_idx);
+}
+
+template <ReadBarrierOption kReadBarrierOption>
+inline Class* DexCache::GetTypeSlot(size_t slot_idx, uint32_t* type_idx) {
+  DCHECK_LT(slot_idx, NumResolvedTypes());
+  return ReadSlot<kReadBarrierOption>(&GetResolvedTypes()[slot_idx], slot_idx, type_idx);
+}
+
 inline String* DexCache::GetResolvedString(uint32_t string_idx) {
-  DCHECK_LT(string_idx, NumStrings());
-  return GetStrings()[string_idx].Read();
+  DCHECK_LT(string_idx, GetDexFile()->NumStringIds());
+  return LookupResolvedString(GetStrings(), string_idx);
 }
 
 inline void DexCache::SetResolvedString(uint32_t string_idx, String* resolved) {
-  DCHECK_LT(string_idx, NumStrings());
+  DCHECK_LT(string_idx, GetDexFile()->NumStringIds());
   // TODO default transaction support.
-  GetStrings()[string_idx] = GcRoot<String>(resolved);
+  AssignSlot(&GetStrings()[StringSlotIndex(string_idx)], string_idx, resolved);
   // TODO: Fine-grained marking, so that we don't need to go through all arrays in full.
   Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(this);
 }
 
 inline Class* DexCache::GetResolvedType(uint32_t type_idx) {
-  DCHECK_LT(type_idx, NumResolvedTypes());
-  return GetResolvedTypes()[type_idx].Read();
+  DCHECK_LT(type_idx, GetDexFile()->NumTypeIds());
+  return LookupResolvedType(GetResolvedTypes(), type_idx);
 }
 
 inline void DexCache::SetResolvedType(uint32_t type_idx, Class* resolved) {
-  DCHECK_LT(type_idx, NumResolvedTypes());  // NOTE: Unchecked, i.e. not throwing AIOOB.
+  DCHECK_LT(type_idx, GetDexFile()->NumTypeIds());  // NOTE: Unchecked, i.e. not throwing AIOOB.
   // TODO default transaction support.
-  GetResolvedTypes()[type_idx] = GcRoot<Class>(resolved);
+  AssignSlot(&GetResolvedTypes()[TypeSlotIndex(type_idx)], type_idx, resolved);
   // TODO: Fine-grained marking, so that we don't need to go through all arrays in full.
   Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(this);
 }
@@ -130,34 +181,51 @@ inline void DexCache::VisitReferences(mirror::Class* klass, const Visitor& visit
   VisitInstanceFieldsReferences<kVerifyFlags, kReadBarrierOption>(klass, visitor);
   // Visit arrays after.
   if (kVisitNativeRoots) {
-    GcRoot<mirror::String>* strings = GetStrings();
+    StringDexCacheType* strings = GetStrings();
     for (size_t i = 0, num_strings = NumStrings(); i != num_strings; ++i) {
-      visitor.VisitRootIfNonNull(strings[i].AddressWithoutBarrier());
+      VisitSlotRoot(&strings[i], visitor);
     }
-    GcRoot<mirror::Class>* resolved_types = GetResolvedTypes();
+    TypeDexCacheType* resolved_types = GetResolvedTypes();
     for (size_t i = 0, num_types = NumResolvedTypes(); i != num_types; ++i) {
-      visitor.VisitRootIfNonNull(resolved_types[i].AddressWithoutBarrier());
+      VisitSlotRoot(&resolved_types[i], visitor);
     }
   }
 }
 
+template <typename Visitor, typename T>
+inline void DexCache::VisitSlotRoot(GcRoot<T>* slot, const Visitor& visitor) {
+  visitor.VisitRootIfNonNull(slot->AddressWithoutBarrier());
+}
+
+template <typename Visitor, typename T>
+inline void DexCache::VisitSlotRoot(std::atomic<DexCachePair<T>>* slot, const Visitor& visitor) {
+  // Visit a copy so that the index and the object stay together, and only write back a moved
+  // object.
+  DexCachePair<T> pair = slot->load(std::memory_order_relaxed);
+  T* before = pair.object.template Read<kWithoutReadBarrier>();
+  visitor.VisitRootIfNonNull(pair.object.AddressWithoutBarrier());
+  if (pair.object.template Read<kWithoutReadBarrier>() != before) {
+    slot->store(pair, std::memory_order_relaxed);
+  }
+}
+
 template <ReadBarrierOption kReadBarrierOption, typename Visitor>
-inline void DexCache::FixupStrings(GcRoot<mirror::String>* dest, const Visitor& visitor) {
-  GcRoot<mirror::String>* src = GetStrings();
+inline void DexCache::FixupStrings(StringDexCacheType* dest, const Visitor& visitor) {
   for (size_t i = 0, count = NumStrings(); i < count; ++i) {
-    mirror::String* source = src[i].Read<kReadBarrierOption>();
+    uint32_t string_idx;
+    mirror::String* source = GetStringSlot<kReadBarrierOption>(i, &string_idx);
     mirror::String* new_source = visitor(source);
-    dest[i] = GcRoot<mirror::String>(new_source);
+    AssignSlot(&dest[i], string_idx, new_source);
   }
 }
 
 template <ReadBarrierOption kReadBarrierOption, typename Visitor>
-inline void DexCache::FixupResolvedTypes(GcRoot<mirror::Class>* dest, const Visitor& visitor) {
-  GcRoot<mirror::Class>* src = GetResolvedTypes();
+inline void DexCache::FixupResolvedTypes(TypeDexCacheType* dest, const Visitor& visitor) {
   for (size_t i = 0, count = NumResolvedTypes(); i < count; ++i) {
-    mirror::Class* source = src[i].Read<kReadBarrierOption>();
+    uint32_t type_idx;
+    mirror::Class* source = GetTypeSlot<kReadBarrierOption>(i, &type_idx);
     mirror::Class* new_source = visitor(source);
-    dest[i] = GcRoot<mirror::Class>(new_source);
+    AssignSlot(&dest[i], type_idx, new_source);
   }
 }
 
@@ -31,11 +31,16 @@
 namespace art {
 namespace mirror {
 
+Atomic<uint64_t> DexCache::string_cache_hits_(0u);
+Atomic<uint64_t> DexCache::string_cache_misses_(0u);
+Atomic<uint64_t> DexCache::type_cache_hits_(0u);
+Atomic<uint64_t> DexCache::type_cache_misses_(0u);
+
 void DexCache::Init(const DexFile* dex_file,
                     String* location,
-                    GcRoot<String>* strings,
+                    StringDexCacheType* strings,
                     uint32_t num_strings,
-                    GcRoot<Class>* resolved_types,
+                    TypeDexCacheType* resolved_types,
                     uint32_t num_resolved_types,
                     ArtMethod** resolved_methods,
                     uint32_t num_resolved_methods,
@@ -83,5 +88,12 @@ void DexCache::SetLocation(mirror::String* location) {
   SetFieldObject<false>(OFFSET_OF_OBJECT_MEMBER(DexCache, location_), location);
 }
 
+void DexCache::DumpHashedCacheStats(std::ostream& os) {
+  os << "Hashed dex cache string lookups: hits=" << string_cache_hits_.LoadRelaxed()
+     << " misses=" << string_cache_misses_.LoadRelaxed() << "\n";
+  os << "Hashed dex cache type lookups: hits=" << type_cache_hits_.LoadRelaxed()
+     << " misses=" << type_cache_misses_.LoadRelaxed() << "\n";
+}
+
 }  // namespace mirror
 }  // namespace art
@@ -17,10 +17,17 @@
 #ifndef ART_RUNTIME_MIRROR_DEX_CACHE_H_
 #define ART_RUNTIME_MIRROR_DEX_CACHE_H_
 
+#include <algorithm>
+#include <atomic>
+
 #include "array.h"
 #include "art_field.h"
 #include "art_method.h"
+#include "atomic.h"
+#include "base/bit_utils.h"
 #include "class.h"
+#include "gc_root.h"
+#include "globals.h"
 #include "object.h"
 #include "object_array.h"
 
@@ -35,6 +42,22 @@ namespace mirror {
 
 class String;
 
+// A slot of the strings or resolved types cache when kUseHashedDexCache: the object and the index
+// of the dex file id it was resolved for, read and written together so that a slot never pairs an
+// index with the object of another one.
+template <typename T>
+struct alignas(8) DexCachePair {
+  GcRoot<T> object;
+  uint32_t index;
+};
+// The compiled code loads a pair with one 8-byte load and finds the object in its low half.
+static_assert(sizeof(StringDexCachePair) == 8u, "Unexpected StringDexCachePair size");
+static_assert(offsetof(StringDexCachePair, object) == 0u, "Unexpected StringDexCachePair layout");
+static_assert(offsetof(StringDexCachePair, index) == 4u, "Unexpected StringDexCachePair layout");
+static_assert(sizeof(TypeDexCachePair) == 8u, "Unexpected TypeDexCachePair size");
+static_assert(offsetof(TypeDexCachePair, object) == 0u, "Unexpected TypeDexCachePair layout");
+static_assert(offsetof(TypeDexCachePair, index) == 4u, "Unexpected TypeDexCachePair layout");
+
 // C++ mirror of java.lang.DexCache.
 class MANAGED DexCache FINAL : public Object {
  public:
@@ -46,11 +69,45 @@ class MANAGED DexCache FINAL : public Object {
     return sizeof(DexCache);
   }
 
+  // Number of slots of the strings cache when kUseHashedDexCache. A string id goes in the slot of
+  // its index modulo this size.
+  static constexpr size_t kDexCacheStringCacheSize = 1024;
+  static_assert(IsPowerOfTwo(kDexCacheStringCacheSize),
+                "String dex cache size is not a power of 2.");
+
+  // Number of elements of the strings array for a dex file with `num_string_ids` strings.
+  static constexpr size_t NumStringSlots(size_t num_string_ids) {
+    return kUseHashedDexCache
+        ? std::min(kDexCacheStringCacheSize, num_string_ids)
+        : num_string_ids;
+  }
+
+  static constexpr size_t StringSlotIndex(uint32_t string_idx) {
+    return kUseHashedDexCache ? string_idx % kDexCacheStringCacheSize : string_idx;
+  }
+
+  // Number of slots of the resolved types cache when kUseHashedDexCache. A type id goes in the slot
+  // of its index modulo this size.
+  static constexpr size_t kDexCacheTypeCacheSize = 1024;
+  static_assert(IsPowerOfTwo(kDexCacheTypeCacheSize),
+                "Type dex cache size is not a power of 2.");
+
+  // Number of elements of the resolved types array for a dex file with `num_type_ids` types.
+  static constexpr size_t NumTypeSlots(size_t num_type_ids) {
+    return kUseHashedDexCache
+        ? std::min(kDexCacheTypeCacheSize, num_type_ids)
+        : num_type_ids;
+  }
+
+  static constexpr size_t TypeSlotIndex(uint32_t type_idx) {
+    return kUseHashedDexCache ? type_idx % kDexCacheTypeCacheSize : type_idx;
+  }
+
   void Init(const DexFile* dex_file,
             String* location,
-            GcRoot<String>* strings,
+            StringDexCacheType* strings,
             uint32_t num_strings,
-            GcRoot<Class>* resolved_types,
+            TypeDexCacheType* resolved_types,
             uint32_t num_resolved_types,
             ArtMethod** resolved_methods,
             uint32_t num_resolved_methods,
@@ -62,11 +119,11 @@ class MANAGED DexCache FINAL : public Object {
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier, typename Visitor>
-  void FixupStrings(GcRoot<mirror::String>* dest, const Visitor& visitor)
+  void FixupStrings(StringDexCacheType* dest, const Visitor& visitor)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier, typename Visitor>
-  void FixupResolvedTypes(GcRoot<mirror::Class>* dest, const Visitor& visitor)
+  void FixupResolvedTypes(TypeDexCacheType* dest, const Visitor& visitor)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   String* GetLocation() SHARED_REQUIRES(Locks::mutator_lock_) {
@@ -133,19 +190,81 @@ class MANAGED DexCache FINAL : public Object {
   ALWAYS_INLINE void SetResolvedField(uint32_t idx, ArtField* field, size_t ptr_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  GcRoot<String>* GetStrings() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
-    return GetFieldPtr<GcRoot<String>*>(StringsOffset());
+  StringDexCacheType* GetStrings() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
+    return GetFieldPtr<StringDexCacheType*>(StringsOffset());
   }
 
-  void SetStrings(GcRoot<String>* strings) ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
+  void SetStrings(StringDexCacheType* strings) ALWAYS_INLINE
+      SHARED_REQUIRES(Locks::mutator_lock_) {
     SetFieldPtr<false>(StringsOffset(), strings);
   }
 
-  GcRoot<Class>* GetResolvedTypes() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
-    return GetFieldPtr<GcRoot<Class>*>(ResolvedTypesOffset());
+  // Returns the string resolved for `string_idx` in a strings array, or null.
+  ALWAYS_INLINE static String* LookupResolvedString(StringDexCacheType* strings,
+                                                    uint32_t string_idx)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    String* string = LookupSlot(&strings[StringSlotIndex(string_idx)], string_idx);
+    if (kUseHashedDexCache && kCountHashedCacheLookups) {
+      (string != nullptr ? string_cache_hits_ : string_cache_misses_).FetchAndAddRelaxed(1u);
+    }
+    return string;
+  }
+
+  // Returns the class resolved for `type_idx` in a resolved types array, or null.
+  ALWAYS_INLINE static Class* LookupResolvedType(TypeDexCacheType* resolved_types,
+                                                 uint32_t type_idx)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    Class* type = LookupSlot(&resolved_types[TypeSlotIndex(type_idx)], type_idx);
+    if (kUseHashedDexCache && kCountHashedCacheLookups) {
+      (type != nullptr ? type_cache_hits_ : type_cache_misses_).FetchAndAddRelaxed(1u);
+    }
+    return type;
   }
 
-  void SetResolvedTypes(GcRoot<Class>* resolved_types)
+  // Whether or not we count the hits and misses of the runtime lookups in the hashed caches. All
+  // threads update the same counters, which slows down the lookups.
+  static constexpr bool kCountHashedCacheLookups = false;
+
+  // Dump the hit and miss counts of the runtime lookups in the hashed caches, if
+  // kCountHashedCacheLookups. The compiled code only calls the runtime on a miss, so its hits are
+  // not counted.
+  static void DumpHashedCacheStats(std::ostream& os);
+
+  // Accessors for an element of a strings or resolved types array, whichever its type.
+  // LookupSlot() returns null if the element is not for the dex file id `idx`.
+  template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier, typename T>
+  static T* LookupSlot(GcRoot<T>* slot, uint32_t idx)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier, typename T>
+  static T* LookupSlot(std::atomic<DexCachePair<T>>* slot, uint32_t idx)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  template <typename T>
+  static void AssignSlot(GcRoot<T>* slot, uint32_t idx, T* object)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  template <typename T>
+  static void AssignSlot(std::atomic<DexCachePair<T>>* slot, uint32_t idx, T* object)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Returns the index of the dex file id which the element at `slot_idx` of a strings or resolved
+  // types array was resolved for, and its object, which may be null.
+  template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier, typename T>
+  static T* ReadSlot(GcRoot<T>* slot, size_t slot_idx, /*out*/ uint32_t* idx)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier, typename T>
+  static T* ReadSlot(std::atomic<DexCachePair<T>>* slot, size_t slot_idx, /*out*/ uint32_t* idx)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier>
+  String* GetStringSlot(size_t slot_idx, /*out*/ uint32_t* string_idx)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier>
+  Class* GetTypeSlot(size_t slot_idx, /*out*/ uint32_t* type_idx)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  TypeDexCacheType* GetResolvedTypes() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
+    return GetFieldPtr<TypeDexCacheType*>(ResolvedTypesOffset());
+  }
+
+  void SetResolvedTypes(TypeDexCacheType* resolved_types)
       ALWAYS_INLINE
       SHARED_REQUIRES(Locks::mutator_lock_) {
     SetFieldPtr<false>(ResolvedTypesOffset(), resolved_types);
@@ -208,6 +327,19 @@ class MANAGED DexCache FINAL : public Object {
   static void SetElementPtrSize(PtrType* ptr_array, size_t idx, PtrType ptr, size_t ptr_size);
 
  private:
+  // Lookup counts, if kCountHashedCacheLookups.
+  static Atomic<uint64_t> string_cache_hits_;
+  static Atomic<uint64_t> string_cache_misses_;
+  static Atomic<uint64_t> type_cache_hits_;
+  static Atomic<uint64_t> type_cache_misses_;
+
+  template <typename Visitor, typename T>
+  static void VisitSlotRoot(GcRoot<T>* slot, const Visitor& visitor)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  template <typename Visitor, typename T>
+  static void VisitSlotRoot(std::atomic<DexCachePair<T>>* slot, const Visitor& visitor)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Visit instance fields of the dex cache as well as its associated arrays.
   template <bool kVisitNativeRoots,
             VerifyObjectFlags kVerifyFlags = kDefaultVerifyFlags,
@@ -221,12 +353,14 @@ class MANAGED DexCache FINAL : public Object {
   uint64_t dex_file_;           // const DexFile*
   uint64_t resolved_fields_;    // ArtField*, array with num_resolved_fields_ elements.
   uint64_t resolved_methods_;   // ArtMethod*, array with num_resolved_methods_ elements.
-  uint64_t resolved_types_;     // GcRoot<Class>*, array with num_resolved_types_ elements.
-  uint64_t strings_;            // GcRoot<String>*, array with num_strings_ elements.
+  uint64_t resolved_types_;     // TypeDexCacheType*, array with num_resolved_types_ elements.
+  uint64_t strings_;            // StringDexCacheType*, array with num_strings_ elements.
   uint32_t num_resolved_fields_;    // Number of elements in the resolved_fields_ array.
   uint32_t num_resolved_methods_;   // Number of elements in the resolved_methods_ array.
-  uint32_t num_resolved_types_;     // Number of elements in the resolved_types_ array.
-  uint32_t num_strings_;            // Number of elements in the strings_ array.
+  uint32_t num_resolved_types_;     // Number of elements in the resolved_types_ array, see
+                                    // NumTypeSlots().
+  uint32_t num_strings_;            // Number of elements in the strings_ array, see
+                                    // NumStringSlots().
 
   friend struct art::DexCacheOffsets;  // for verifying offset information
   friend class Object;  // For VisitReferences
@@ -22,6 +22,8 @@
 #include "common_runtime_test.h"
 #include "linear_alloc.h"
 #include "mirror/class_loader-inl.h"
+#include "mirror/dex_cache-inl.h"
+#include "mirror/string.h"
 #include "handle_scope-inl.h"
 #include "scoped_thread_state_change.h"
 
@@ -40,8 +42,10 @@ TEST_F(DexCacheTest, Open) {
                                                 Runtime::Current()->GetLinearAlloc())));
   ASSERT_TRUE(dex_cache.Get() != nullptr);
 
-  EXPECT_EQ(java_lang_dex_file_->NumStringIds(), dex_cache->NumStrings());
-  EXPECT_EQ(java_lang_dex_file_->NumTypeIds(),   dex_cache->NumResolvedTypes());
+  EXPECT_EQ(DexCache::NumStringSlots(java_lang_dex_file_->NumStringIds()),
+            dex_cache->NumStrings());
+  EXPECT_EQ(DexCache::NumTypeSlots(java_lang_dex_file_->NumTypeIds()),
+            dex_cache->NumResolvedTypes());
   EXPECT_EQ(java_lang_dex_file_->NumMethodIds(), dex_cache->NumResolvedMethods());
   EXPECT_EQ(java_lang_dex_file_->NumFieldIds(),  dex_cache->NumResolvedFields());
 }
@@ -90,5 +94,80 @@ TEST_F(DexCacheTest, TestResolvedFieldAccess) {
   }
 }
 
+TEST_F(DexCacheTest, ResolvedStrings) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<3> hs(soa.Self());
+  ASSERT_TRUE(java_lang_dex_file_ != nullptr);
+  ASSERT_GT(java_lang_dex_file_->NumStringIds(), DexCache::kDexCacheStringCacheSize);
+  Handle<DexCache> dex_cache(
+      hs.NewHandle(class_linker_->AllocDexCache(soa.Self(),
+                                                *java_lang_dex_file_,
+                                                Runtime::Current()->GetLinearAlloc())));
+  ASSERT_TRUE(dex_cache.Get() != nullptr);
+  Handle<String> first(hs.NewHandle(String::AllocFromModifiedUtf8(soa.Self(), "first")));
+  ASSERT_TRUE(first.Get() != nullptr);
+  Handle<String> second(hs.NewHandle(String::AllocFromModifiedUtf8(soa.Self(), "second")));
+  ASSERT_TRUE(second.Get() != nullptr);
+
+  // Both string ids go in the same slot of a hashed strings cache.
+  const uint32_t first_idx = 1u;
+  const uint32_t second_idx = first_idx + DexCache::kDexCacheStringCacheSize;
+  EXPECT_TRUE(dex_cache->GetResolvedString(first_idx) == nullptr);
+  dex_cache->SetResolvedString(first_idx, first.Get());
+  EXPECT_EQ(first.Get(), dex_cache->GetResolvedString(first_idx));
+  EXPECT_TRUE(dex_cache->GetResolvedString(second_idx) == nullptr);
+  dex_cache->SetResolvedString(second_idx, second.Get());
+  EXPECT_EQ(second.Get(), dex_cache->GetResolvedString(second_idx));
+  if (kUseHashedDexCache) {
+    EXPECT_TRUE(dex_cache->GetResolvedString(first_idx) == nullptr);
+  } else {
+    EXPECT_EQ(first.Get(), dex_cache->GetResolvedString(first_idx));
+  }
+
+  uint32_t string_idx;
+  EXPECT_EQ(second.Get(), dex_cache->GetStringSlot(DexCache::StringSlotIndex(second_idx),
+                                                   &string_idx));
+  EXPECT_EQ(DexCache::StringSlotIndex(second_idx), DexCache::StringSlotIndex(string_idx));
+  EXPECT_EQ(kUseHashedDexCache ? second_idx : DexCache::StringSlotIndex(second_idx), string_idx);
+}
+
+TEST_F(DexCacheTest, ResolvedTypes) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<3> hs(soa.Self());
+  ASSERT_TRUE(java_lang_dex_file_ != nullptr);
+  ASSERT_GT(java_lang_dex_file_->NumTypeIds(), DexCache::kDexCacheTypeCacheSize);
+  Handle<DexCache> dex_cache(
+      hs.NewHandle(class_linker_->AllocDexCache(soa.Self(),
+                                                *java_lang_dex_file_,
+                                                Runtime::Current()->GetLinearAlloc())));
+  ASSERT_TRUE(dex_cache.Get() != nullptr);
+  Handle<Class> first(hs.NewHandle(class_linker_->FindSystemClass(soa.Self(),
+                                                                  "Ljava/lang/Object;")));
+  ASSERT_TRUE(first.Get() != nullptr);
+  Handle<Class> second(hs.NewHandle(class_linker_->FindSystemClass(soa.Self(),
+                                                                   "Ljava/lang/String;")));
+  ASSERT_TRUE(second.Get() != nullptr);
+
+  // Both type ids go in the same slot of a hashed resolved types cache.
+  const uint32_t first_idx = 1u;
+  const uint32_t second_idx = first_idx + DexCache::kDexCacheTypeCacheSize;
+  EXPECT_TRUE(dex_cache->GetResolvedType(first_idx) == nullptr);
+  dex_cache->SetResolvedType(first_idx, first.Get());
+  EXPECT_EQ(first.Get(), dex_cache->GetResolvedType(first_idx));
+  EXPECT_TRUE(dex_cache->GetResolvedType(second_idx) == nullptr);
+  dex_cache->SetResolvedType(second_idx, second.Get());
+  EXPECT_EQ(second.Get(), dex_cache->GetResolvedType(second_idx));
+  if (kUseHashedDexCache) {
+    EXPECT_TRUE(dex_cache->GetResolvedType(first_idx) == nullptr);
+  } else {
+    EXPECT_EQ(first.Get(), dex_cache->GetResolvedType(first_idx));
+  }
+
+  uint32_t type_idx;
+  EXPECT_EQ(second.Get(), dex_cache->GetTypeSlot(DexCache::TypeSlotIndex(second_idx), &type_idx));
+  EXPECT_EQ(DexCache::TypeSlotIndex(second_idx), DexCache::TypeSlotIndex(type_idx));
+  EXPECT_EQ(kUseHashedDexCache ? second_idx : DexCache::TypeSlotIndex(second_idx), type_idx);
+}
+
 }  // namespace mirror
 }  // namespace art
@@ -61,7 +61,7 @@ class ObjectTest : public CommonRuntimeTest {
     Handle<String> string(
         hs.NewHandle(String::AllocFromModifiedUtf8(self, expected_utf16_length, utf8_in)));
     ASSERT_EQ(expected_utf16_length, string->GetLength());
-    ASSERT_TRUE(string->GetValue() != nullptr);
+    ASSERT_TRUE(string->IsCompressed() || string->GetValue() != nullptr);
     // strlen is necessary because the 1-character string "\x00\x00" is interpreted as ""
     ASSERT_TRUE(string->Equals(utf8_in) || (expected_utf16_length == 1 && strlen(utf8_in) == 0));
     ASSERT_TRUE(string->Equals(StringPiece(utf8_in)) ||
@@ -475,6 +475,38 @@ TEST_F(ObjectTest, StringCompareTo) {
   EXPECT_GT(0, string_5->CompareTo(string.Get()));
 }
 
+TEST_F(ObjectTest, StringCompression) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<4> hs(soa.Self());
+  // "caf\u00e9" is Latin-1, "caf\u20ac" is not.
+  Handle<String> latin1(hs.NewHandle(String::AllocFromModifiedUtf8(soa.Self(), "caf\xc3\xa9")));
+  const uint16_t latin1_utf16[] = { 'c', 'a', 'f', 0xe9 };
+  Handle<String> latin1_2(hs.NewHandle(String::AllocFromUtf16(soa.Self(), 4, latin1_utf16)));
+  Handle<String> wide(hs.NewHandle(String::AllocFromModifiedUtf8(soa.Self(), "caf\xe2\x82\xac")));
+  Handle<String> concat(hs.NewHandle(String::AllocFromStrings(soa.Self(), latin1, wide)));
+  EXPECT_EQ(kUseStringCompression, latin1->IsCompressed());
+  EXPECT_EQ(kUseStringCompression, latin1_2->IsCompressed());
+  EXPECT_FALSE(wide->IsCompressed());
+  EXPECT_FALSE(concat->IsCompressed());
+
+  EXPECT_EQ(4, latin1->GetLength());
+  EXPECT_EQ(0xe9, latin1->CharAt(3));
+  EXPECT_EQ(0x20ac, wide->CharAt(3));
+  EXPECT_EQ(8, concat->GetLength());
+  EXPECT_EQ(0xe9, concat->CharAt(3));
+  EXPECT_EQ(0x20ac, concat->CharAt(7));
+
+  EXPECT_TRUE(latin1->Equals(latin1_2.Get()));
+  EXPECT_FALSE(latin1->Equals(wide.Get()));
+  EXPECT_EQ(latin1->GetHashCode(), latin1_2->GetHashCode());
+  EXPECT_EQ(0, latin1->CompareTo(latin1_2.Get()));
+  EXPECT_GT(0, latin1->CompareTo(wide.Get()));
+  EXPECT_LT(0, wide->CompareTo(latin1.Get()));
+  EXPECT_GT(0, latin1->CompareTo(concat.Get()));
+  EXPECT_EQ("caf\xc3\xa9", latin1->ToModifiedUtf8());
+  EXPECT_EQ(5, latin1->GetUtfLength());
+}
+
 TEST_F(ObjectTest, StringLength) {
   ScopedObjectAccess soa(Thread::Current());
   StackHandleScope<1> hs(soa.Self());
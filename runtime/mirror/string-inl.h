@@ -67,10 +67,16 @@ class SetStringCountAndBytesVisitor {
     // Avoid AsString as object is not yet in live bitmap or allocation stack.
     String* string = down_cast<String*>(obj);
     string->SetCount(count_);
-    uint16_t* value = string->GetValue();
+    const int32_t length = String::GetLengthFromCount(count_);
     const uint8_t* const src = reinterpret_cast<uint8_t*>(src_array_->GetData()) + offset_;
-    for (int i = 0; i < count_; i++) {
-      value[i] = high_byte_ + (src[i] & 0xFF);
+    if (String::IsCompressed(count_)) {
+      DCHECK_EQ(high_byte_, 0);
+      memcpy(string->GetValueCompressed(), src, length * sizeof(uint8_t));
+    } else {
+      uint16_t* value = string->GetValue();
+      for (int i = 0; i < length; i++) {
+        value[i] = high_byte_ + (src[i] & 0xFF);
+      }
     }
   }
 
@@ -94,8 +100,16 @@ class SetStringCountAndValueVisitorFromCharArray {
     // Avoid AsString as object is not yet in live bitmap or allocation stack.
     String* string = down_cast<String*>(obj);
     string->SetCount(count_);
+    const int32_t length = String::GetLengthFromCount(count_);
     const uint16_t* const src = src_array_->GetData() + offset_;
-    memcpy(string->GetValue(), src, count_ * sizeof(uint16_t));
+    if (String::IsCompressed(count_)) {
+      uint8_t* value = string->GetValueCompressed();
+      for (int i = 0; i < length; i++) {
+        value[i] = static_cast<uint8_t>(src[i]);
+      }
+    } else {
+      memcpy(string->GetValue(), src, length * sizeof(uint16_t));
+    }
   }
 
  private:
@@ -117,8 +131,23 @@ class SetStringCountAndValueVisitorFromString {
     // Avoid AsString as object is not yet in live bitmap or allocation stack.
     String* string = down_cast<String*>(obj);
     string->SetCount(count_);
-    const uint16_t* const src = src_string_->GetValue() + offset_;
-    memcpy(string->GetValue(), src, count_ * sizeof(uint16_t));
+    const int32_t length = String::GetLengthFromCount(count_);
+    if (src_string_->IsCompressed()) {
+      // All substrings of a compressed string are compressed.
+      DCHECK(String::IsCompressed(count_));
+      memcpy(string->GetValueCompressed(),
+             src_string_->GetValueCompressed() + offset_,
+             length * sizeof(uint8_t));
+    } else if (String::IsCompressed(count_)) {
+      const uint16_t* const src = src_string_->GetValue() + offset_;
+      uint8_t* value = string->GetValueCompressed();
+      for (int i = 0; i < length; i++) {
+        value[i] = static_cast<uint8_t>(src[i]);
+      }
+    } else {
+      const uint16_t* const src = src_string_->GetValue() + offset_;
+      memcpy(string->GetValue(), src, length * sizeof(uint16_t));
+    }
   }
 
  private:
@@ -132,19 +161,21 @@ inline String* String::Intern() {
 }
 
 inline uint16_t String::CharAt(int32_t index) {
-  int32_t count = GetField32(OFFSET_OF_OBJECT_MEMBER(String, count_));
-  if (UNLIKELY((index < 0) || (index >= count))) {
+  int32_t count = GetCount();
+  int32_t length = GetLengthFromCount(count);
+  if (UNLIKELY((index < 0) || (index >= length))) {
     Thread* self = Thread::Current();
     self->ThrowNewExceptionF("Ljava/lang/StringIndexOutOfBoundsException;",
-                             "length=%i; index=%i", count, index);
+                             "length=%i; index=%i", length, index);
     return 0;
   }
-  return GetValue()[index];
+  return IsCompressed(count) ? GetValueCompressed()[index] : GetValue()[index];
 }
 
 template<VerifyObjectFlags kVerifyFlags>
 inline size_t String::SizeOf() {
-  size_t size = sizeof(String) + (sizeof(uint16_t) * GetLength<kVerifyFlags>());
+  const size_t char_size = IsCompressed<kVerifyFlags>() ? sizeof(uint8_t) : sizeof(uint16_t);
+  size_t size = sizeof(String) + (char_size * GetLength<kVerifyFlags>());
   // String.equals() intrinsics assume zero-padding up to kObjectAlignment,
   // so make sure the zero-padding is actually copied around if GC compaction
   // chooses to copy only SizeOf() bytes.
@@ -153,13 +184,16 @@ inline size_t String::SizeOf() {
 }
 
 template <bool kIsInstrumented, typename PreFenceVisitor>
-inline String* String::Alloc(Thread* self, int32_t utf16_length, gc::AllocatorType allocator_type,
+inline String* String::Alloc(Thread* self, int32_t utf16_length_with_flag,
+                             gc::AllocatorType allocator_type,
                              const PreFenceVisitor& pre_fence_visitor) {
   constexpr size_t header_size = sizeof(String);
+  const bool compressed = IsCompressed(utf16_length_with_flag);
+  const int32_t utf16_length = GetLengthFromCount(utf16_length_with_flag);
   static_assert(sizeof(utf16_length) <= sizeof(size_t),
                 "static_cast<size_t>(utf16_length) must not lose bits.");
   size_t length = static_cast<size_t>(utf16_length);
-  size_t data_size = sizeof(uint16_t) * length;
+  size_t data_size = (compressed ? sizeof(uint8_t) : sizeof(uint16_t)) * length;
   size_t size = header_size + data_size;
   // String.equals() intrinsics assume zero-padding up to kObjectAlignment,
   // so make sure the allocator clears the padding as well.
@@ -191,8 +225,10 @@ template <bool kIsInstrumented>
 inline String* String::AllocFromByteArray(Thread* self, int32_t byte_length,
                                           Handle<ByteArray> array, int32_t offset,
                                           int32_t high_byte, gc::AllocatorType allocator_type) {
-  SetStringCountAndBytesVisitor visitor(byte_length, array, offset, high_byte << 8);
-  String* string = Alloc<kIsInstrumented>(self, byte_length, allocator_type, visitor);
+  // The chars are Latin-1 exactly when the high byte is zero.
+  const int32_t length_with_flag = GetFlaggedCount(byte_length, high_byte == 0);
+  SetStringCountAndBytesVisitor visitor(length_with_flag, array, offset, high_byte << 8);
+  String* string = Alloc<kIsInstrumented>(self, length_with_flag, allocator_type, visitor);
   return string;
 }
 
@@ -202,16 +238,21 @@ inline String* String::AllocFromCharArray(Thread* self, int32_t count,
                                           gc::AllocatorType allocator_type) {
   // It is a caller error to have a count less than the actual array's size.
   DCHECK_GE(array->GetLength(), count);
-  SetStringCountAndValueVisitorFromCharArray visitor(count, array, offset);
-  String* new_string = Alloc<kIsInstrumented>(self, count, allocator_type, visitor);
+  const int32_t length_with_flag =
+      GetFlaggedCount(count, AllLatin1(array->GetData() + offset, count));
+  SetStringCountAndValueVisitorFromCharArray visitor(length_with_flag, array, offset);
+  String* new_string = Alloc<kIsInstrumented>(self, length_with_flag, allocator_type, visitor);
   return new_string;
 }
 
 template <bool kIsInstrumented>
 inline String* String::AllocFromString(Thread* self, int32_t string_length, Handle<String> string,
                                        int32_t offset, gc::AllocatorType allocator_type) {
-  SetStringCountAndValueVisitorFromString visitor(string_length, string, offset);
-  String* new_string = Alloc<kIsInstrumented>(self, string_length, allocator_type, visitor);
+  const bool compressible = string->IsCompressed() ||
+      AllLatin1(string->GetValue() + offset, string_length);
+  const int32_t length_with_flag = GetFlaggedCount(string_length, compressible);
+  SetStringCountAndValueVisitorFromString visitor(length_with_flag, string, offset);
+  String* new_string = Alloc<kIsInstrumented>(self, length_with_flag, allocator_type, visitor);
   return new_string;
 }
 
@@ -220,7 +261,9 @@ inline int32_t String::GetHashCode() {
   if (UNLIKELY(result == 0)) {
     result = ComputeHashCode();
   }
-  DCHECK(result != 0 || ComputeUtf16Hash(GetValue(), GetLength()) == 0)
+  DCHECK(result != 0 ||
+         (IsCompressed() ? ComputeUtf16Hash(GetValueCompressed(), GetLength())
+                         : ComputeUtf16Hash(GetValue(), GetLength())) == 0)
       << ToModifiedUtf8() << " " << result;
   return result;
 }
@@ -34,6 +34,18 @@ namespace mirror {
 // TODO: get global references for these
 GcRoot<Class> String::java_lang_String_;
 
+template <typename CharType>
+static int32_t FastIndexOf(const CharType* chars, int32_t ch, int32_t start, int32_t count) {
+  const CharType* p = chars + start;
+  const CharType* end = chars + count;
+  while (p < end) {
+    if (*p++ == ch) {
+      return (p - 1) - chars;
+    }
+  }
+  return -1;
+}
+
 int32_t String::FastIndexOf(int32_t ch, int32_t start) {
   int32_t count = GetLength();
   if (start < 0) {
@@ -41,15 +53,9 @@ int32_t String::FastIndexOf(int32_t ch, int32_t start) {
   } else if (start > count) {
     start = count;
   }
-  const uint16_t* chars = GetValue();
-  const uint16_t* p = chars + start;
-  const uint16_t* end = chars + count;
-  while (p < end) {
-    if (*p++ == ch) {
-      return (p - 1) - chars;
-    }
-  }
-  return -1;
+  return IsCompressed()
+      ? art::mirror::FastIndexOf(GetValueCompressed(), ch, start, count)
+      : art::mirror::FastIndexOf(GetValue(), ch, start, count);
 }
 
 void String::SetClass(Class* java_lang_String) {
@@ -65,45 +71,86 @@ void String::ResetClass() {
 }
 
 int String::ComputeHashCode() {
-  const int32_t hash_code = ComputeUtf16Hash(GetValue(), GetLength());
+  const int32_t hash_code = IsCompressed()
+      ? ComputeUtf16Hash(GetValueCompressed(), GetLength())
+      : ComputeUtf16Hash(GetValue(), GetLength());
   SetHashCode(hash_code);
   return hash_code;
 }
 
 int32_t String::GetUtfLength() {
-  return CountUtf8Bytes(GetValue(), GetLength());
+  return IsCompressed()
+      ? CountUtf8Bytes(GetValueCompressed(), GetLength())
+      : CountUtf8Bytes(GetValue(), GetLength());
 }
 
 void String::SetCharAt(int32_t index, uint16_t c) {
-  DCHECK((index >= 0) && (index < count_));
-  GetValue()[index] = c;
+  DCHECK((index >= 0) && (index < GetLength()));
+  if (IsCompressed()) {
+    // A compressed string has no room for wider chars, and cannot be decompressed in
+    // place. Storing one would silently truncate it.
+    CHECK(IsLatin1(c)) << "Cannot store char " << c << " into compressed string at " << index;
+    GetValueCompressed()[index] = static_cast<uint8_t>(c);
+  } else {
+    GetValue()[index] = c;
+  }
+}
+
+// Copies the chars of `string` to `dest`, widening them if it is compressed.
+static void CopyChars(String* string, uint16_t* dest) SHARED_REQUIRES(Locks::mutator_lock_) {
+  const int32_t length = string->GetLength();
+  if (string->IsCompressed()) {
+    const uint8_t* src = string->GetValueCompressed();
+    for (int32_t i = 0; i < length; ++i) {
+      dest[i] = src[i];
+    }
+  } else {
+    memcpy(dest, string->GetValue(), length * sizeof(uint16_t));
+  }
 }
 
 String* String::AllocFromStrings(Thread* self, Handle<String> string, Handle<String> string2) {
   int32_t length = string->GetLength();
   int32_t length2 = string2->GetLength();
   gc::AllocatorType allocator_type = Runtime::Current()->GetHeap()->GetCurrentAllocator();
-  SetStringCountVisitor visitor(length + length2);
-  String* new_string = Alloc<true>(self, length + length2, allocator_type, visitor);
+  const bool compressible = string->IsCompressed() && string2->IsCompressed();
+  const int32_t length_with_flag = GetFlaggedCount(length + length2, compressible);
+  SetStringCountVisitor visitor(length_with_flag);
+  String* new_string = Alloc<true>(self, length_with_flag, allocator_type, visitor);
   if (UNLIKELY(new_string == nullptr)) {
     return nullptr;
   }
-  uint16_t* new_value = new_string->GetValue();
-  memcpy(new_value, string->GetValue(), length * sizeof(uint16_t));
-  memcpy(new_value + length, string2->GetValue(), length2 * sizeof(uint16_t));
+  if (compressible) {
+    uint8_t* new_value = new_string->GetValueCompressed();
+    memcpy(new_value, string->GetValueCompressed(), length * sizeof(uint8_t));
+    memcpy(new_value + length, string2->GetValueCompressed(), length2 * sizeof(uint8_t));
+  } else {
+    uint16_t* new_value = new_string->GetValue();
+    CopyChars(string.Get(), new_value);
+    CopyChars(string2.Get(), new_value + length);
+  }
   return new_string;
 }
 
 String* String::AllocFromUtf16(Thread* self, int32_t utf16_length, const uint16_t* utf16_data_in) {
   CHECK(utf16_data_in != nullptr || utf16_length == 0);
   gc::AllocatorType allocator_type = Runtime::Current()->GetHeap()->GetCurrentAllocator();
-  SetStringCountVisitor visitor(utf16_length);
-  String* string = Alloc<true>(self, utf16_length, allocator_type, visitor);
+  const bool compressible = AllLatin1(utf16_data_in, utf16_length);
+  const int32_t length_with_flag = GetFlaggedCount(utf16_length, compressible);
+  SetStringCountVisitor visitor(length_with_flag);
+  String* string = Alloc<true>(self, length_with_flag, allocator_type, visitor);
   if (UNLIKELY(string == nullptr)) {
     return nullptr;
   }
-  uint16_t* array = string->GetValue();
-  memcpy(array, utf16_data_in, utf16_length * sizeof(uint16_t));
+  if (compressible) {
+    uint8_t* array = string->GetValueCompressed();
+    for (int32_t i = 0; i < utf16_length; ++i) {
+      array[i] = static_cast<uint8_t>(utf16_data_in[i]);
+    }
+  } else {
+    uint16_t* array = string->GetValue();
+    memcpy(array, utf16_data_in, utf16_length * sizeof(uint16_t));
+  }
   return string;
 }
 
@@ -121,13 +168,22 @@ String* String::AllocFromModifiedUtf8(Thread* self, int32_t utf16_length, const
 String* String::AllocFromModifiedUtf8(Thread* self, int32_t utf16_length,
                                       const char* utf8_data_in, int32_t utf8_length) {
   gc::AllocatorType allocator_type = Runtime::Current()->GetHeap()->GetCurrentAllocator();
-  SetStringCountVisitor visitor(utf16_length);
-  String* string = Alloc<true>(self, utf16_length, allocator_type, visitor);
+  // Strings of ASCII chars, the most common ones, have one byte per char.
+  const bool compressible = kUseStringCompression &&
+      (utf16_length == utf8_length || IsModifiedUtf8Latin1(utf8_data_in, utf8_length));
+  const int32_t length_with_flag = GetFlaggedCount(utf16_length, compressible);
+  SetStringCountVisitor visitor(length_with_flag);
+  String* string = Alloc<true>(self, length_with_flag, allocator_type, visitor);
   if (UNLIKELY(string == nullptr)) {
     return nullptr;
   }
-  uint16_t* utf16_data_out = string->GetValue();
-  ConvertModifiedUtf8ToUtf16(utf16_data_out, utf16_length, utf8_data_in, utf8_length);
+  if (compressible) {
+    ConvertModifiedUtf8ToLatin1(string->GetValueCompressed(), utf16_length, utf8_data_in,
+                                utf8_length);
+  } else {
+    uint16_t* utf16_data_out = string->GetValue();
+    ConvertModifiedUtf8ToUtf16(utf16_data_out, utf16_length, utf8_data_in, utf8_length);
+  }
   return string;
 }
 
@@ -138,18 +194,16 @@ bool String::Equals(String* that) {
   } else if (that == nullptr) {
     // Null isn't an instanceof anything
     return false;
-  } else if (this->GetLength() != that->GetLength()) {
-    // Quick length inequality test
+  } else if (this->GetCount() != that->GetCount()) {
+    // Quick length inequality test. Equal strings are either both compressed or both not.
     return false;
   } else {
     // Note: don't short circuit on hash code as we're presumably here as the
     // hash code was already equal
-    for (int32_t i = 0; i < that->GetLength(); ++i) {
-      if (this->CharAt(i) != that->CharAt(i)) {
-        return false;
-      }
-    }
-    return true;
+    const int32_t length = GetLength();
+    return IsCompressed()
+        ? memcmp(GetValueCompressed(), that->GetValueCompressed(), length * sizeof(uint8_t)) == 0
+        : memcmp(GetValue(), that->GetValue(), length * sizeof(uint16_t)) == 0;
   }
 }
 
@@ -219,13 +273,27 @@ bool String::Equals(const StringPiece& modified_utf8) {
 
 // Create a modified UTF-8 encoded std::string from a java/lang/String object.
 std::string String::ToModifiedUtf8() {
-  const uint16_t* chars = GetValue();
   size_t byte_count = GetUtfLength();
   std::string result(byte_count, static_cast<char>(0));
-  ConvertUtf16ToModifiedUtf8(&result[0], byte_count, chars, GetLength());
+  if (IsCompressed()) {
+    ConvertUtf16ToModifiedUtf8(&result[0], byte_count, GetValueCompressed(), GetLength());
+  } else {
+    ConvertUtf16ToModifiedUtf8(&result[0], byte_count, GetValue(), GetLength());
+  }
   return result;
 }
 
+// Returns the difference of the first differing chars, or 0.
+template <typename LhsCharType, typename RhsCharType>
+static int32_t CompareChars(const LhsCharType* lhs, const RhsCharType* rhs, int32_t count) {
+  for (int32_t i = 0; i < count; ++i) {
+    if (lhs[i] != rhs[i]) {
+      return static_cast<int32_t>(lhs[i]) - static_cast<int32_t>(rhs[i]);
+    }
+  }
+  return 0;
+}
+
 int32_t String::CompareTo(String* rhs) {
   // Quick test for comparison of a string with itself.
   String* lhs = this;
@@ -242,9 +310,16 @@ int32_t String::CompareTo(String* rhs) {
   int32_t rhsCount = rhs->GetLength();
   int32_t countDiff = lhsCount - rhsCount;
   int32_t minCount = (countDiff < 0) ? lhsCount : rhsCount;
-  const uint16_t* lhsChars = lhs->GetValue();
-  const uint16_t* rhsChars = rhs->GetValue();
-  int32_t otherRes = MemCmp16(lhsChars, rhsChars, minCount);
+  int32_t otherRes;
+  if (lhs->IsCompressed()) {
+    otherRes = rhs->IsCompressed()
+        ? CompareChars(lhs->GetValueCompressed(), rhs->GetValueCompressed(), minCount)
+        : CompareChars(lhs->GetValueCompressed(), rhs->GetValue(), minCount);
+  } else if (rhs->IsCompressed()) {
+    otherRes = CompareChars(lhs->GetValue(), rhs->GetValueCompressed(), minCount);
+  } else {
+    otherRes = MemCmp16(lhs->GetValue(), rhs->GetValue(), minCount);
+  }
   if (otherRes != 0) {
     return otherRes;
   }
@@ -260,7 +335,7 @@ CharArray* String::ToCharArray(Thread* self) {
   Handle<String> string(hs.NewHandle(this));
   CharArray* result = CharArray::Alloc(self, GetLength());
   if (result != nullptr) {
-    memcpy(result->GetData(), string->GetValue(), string->GetLength() * sizeof(uint16_t));
+    CopyChars(string.Get(), result->GetData());
   } else {
     self->AssertPendingOOMException();
   }
@@ -269,8 +344,15 @@ CharArray* String::ToCharArray(Thread* self) {
 
 void String::GetChars(int32_t start, int32_t end, Handle<CharArray> array, int32_t index) {
   uint16_t* data = array->GetData() + index;
-  uint16_t* value = GetValue() + start;
-  memcpy(data, value, (end - start) * sizeof(uint16_t));
+  if (IsCompressed()) {
+    const uint8_t* value = GetValueCompressed() + start;
+    for (int32_t i = 0; i < end - start; ++i) {
+      data[i] = value[i];
+    }
+  } else {
+    uint16_t* value = GetValue() + start;
+    memcpy(data, value, (end - start) * sizeof(uint16_t));
+  }
 }
 
 }  // namespace mirror
@@ -31,6 +31,12 @@ class StubTest_ReadBarrierForRoot_Test;
 
 namespace mirror {
 
+// String compression stores the chars of a string in one byte each when all of them are Latin-1,
+// i.e. below 0x100, and marks it with the most significant bit of count_. A string is compressed
+// if and only if it can be, so that equal strings have equal counts. The libcore String must
+// read its length through the same flag before this can be enabled.
+static constexpr bool kUseStringCompression = false;
+
 // C++ mirror of java.lang.String
 class MANAGED String FINAL : public Object {
  public:
@@ -50,25 +56,81 @@ class MANAGED String FINAL : public Object {
     return OFFSET_OF_OBJECT_MEMBER(String, value_);
   }
 
+  // The chars of an uncompressed string.
   uint16_t* GetValue() SHARED_REQUIRES(Locks::mutator_lock_) {
+    DCHECK(!IsCompressed());
     return &value_[0];
   }
 
+  // The chars of a compressed string.
+  uint8_t* GetValueCompressed() SHARED_REQUIRES(Locks::mutator_lock_) {
+    DCHECK(IsCompressed());
+    return &value_compressed_[0];
+  }
+
   template<VerifyObjectFlags kVerifyFlags = kDefaultVerifyFlags>
   size_t SizeOf() SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // The length and the compression flag of the string.
   template<VerifyObjectFlags kVerifyFlags = kDefaultVerifyFlags>
-  int32_t GetLength() SHARED_REQUIRES(Locks::mutator_lock_) {
+  int32_t GetCount() SHARED_REQUIRES(Locks::mutator_lock_) {
     return GetField32<kVerifyFlags>(OFFSET_OF_OBJECT_MEMBER(String, count_));
   }
 
+  template<VerifyObjectFlags kVerifyFlags = kDefaultVerifyFlags>
+  int32_t GetLength() SHARED_REQUIRES(Locks::mutator_lock_) {
+    return GetLengthFromCount(GetCount<kVerifyFlags>());
+  }
+
+  template<VerifyObjectFlags kVerifyFlags = kDefaultVerifyFlags>
+  bool IsCompressed() SHARED_REQUIRES(Locks::mutator_lock_) {
+    return IsCompressed(GetCount<kVerifyFlags>());
+  }
+
   void SetCount(int32_t new_count) SHARED_REQUIRES(Locks::mutator_lock_) {
     // Count is invariant so use non-transactional mode. Also disable check as we may run inside
     // a transaction.
-    DCHECK_LE(0, new_count);
+    DCHECK_LE(0, GetLengthFromCount(new_count));
     SetField32<false, false>(OFFSET_OF_OBJECT_MEMBER(String, count_), new_count);
   }
 
+  // The flag of count_ which marks a compressed string.
+  static constexpr uint32_t kCompressionFlag = 0x80000000u;
+
+  static constexpr bool IsCompressed(int32_t count) {
+    return kUseStringCompression && (static_cast<uint32_t>(count) & kCompressionFlag) != 0u;
+  }
+
+  static constexpr int32_t GetLengthFromCount(int32_t count) {
+    return kUseStringCompression
+        ? static_cast<int32_t>(static_cast<uint32_t>(count) & ~kCompressionFlag)
+        : count;
+  }
+
+  // Returns the count of a string of `length` chars, compressed if `compressible`.
+  static constexpr int32_t GetFlaggedCount(int32_t length, bool compressible) {
+    return (kUseStringCompression && compressible)
+        ? static_cast<int32_t>(static_cast<uint32_t>(length) | kCompressionFlag)
+        : length;
+  }
+
+  static constexpr bool IsLatin1(uint16_t c) {
+    return c < 0x100u;
+  }
+
+  // Returns true if the string of these chars can be compressed.
+  static bool AllLatin1(const uint16_t* chars, int32_t length) {
+    if (!kUseStringCompression) {
+      return false;
+    }
+    for (int32_t i = 0; i < length; ++i) {
+      if (!IsLatin1(chars[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   int32_t GetHashCode() SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Computes, stores, and returns the hash code.
@@ -83,7 +145,7 @@ class MANAGED String FINAL : public Object {
   String* Intern() SHARED_REQUIRES(Locks::mutator_lock_);
 
   template <bool kIsInstrumented, typename PreFenceVisitor>
-  ALWAYS_INLINE static String* Alloc(Thread* self, int32_t utf16_length,
+  ALWAYS_INLINE static String* Alloc(Thread* self, int32_t utf16_length_with_flag,
                                      gc::AllocatorType allocator_type,
                                      const PreFenceVisitor& pre_fence_visitor)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!Roles::uninterruptible_);
@@ -175,11 +237,16 @@ class MANAGED String FINAL : public Object {
   }
 
   // Field order required by test "ValidateFieldOrderOfJavaCppUnionClasses".
+  // The length of the string, with kCompressionFlag if it is compressed.
   int32_t count_;
 
   uint32_t hash_code_;
 
-  uint16_t value_[0];
+  // The chars, in value_compressed_ if the string is compressed.
+  union {
+    uint16_t value_[0];
+    uint8_t value_compressed_[0];
+  };
 
   static GcRoot<Class> java_lang_String_;
 
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "multi_dex_type_lookup_table.h"
+
+#include <cstring>
+#include <limits>
+
+#include "base/bit_utils.h"
+#include "dex_file-inl.h"
+#include "utf-inl.h"
+
+namespace art {
+
+bool MultiDexTypeLookupTable::SupportedSize(const std::vector<uint32_t>& num_class_defs) {
+  if (num_class_defs.size() > std::numeric_limits<uint16_t>::max()) {
+    return false;
+  }
+  uint64_t total = 0u;
+  for (uint32_t count : num_class_defs) {
+    if (count > std::numeric_limits<uint16_t>::max()) {
+      return false;
+    }
+    total += count;
+  }
+  // Keep the size of the raw data in 32 bits.
+  return total != 0u && total <= std::numeric_limits<uint32_t>::max() / 32u;
+}
+
+uint32_t MultiDexTypeLookupTable::CalculateSize(uint32_t num_class_defs) {
+  // Keep the load factor at or below 3/4 so that the linear probing stays short.
+  return RoundUpToPowerOfTwo(num_class_defs + num_class_defs / 3u + 1u);
+}
+
+uint32_t MultiDexTypeLookupTable::RawDataLength(uint32_t num_class_defs) {
+  return sizeof(uint32_t) + CalculateSize(num_class_defs) * sizeof(Entry);
+}
+
+void MultiDexTypeLookupTable::Create(const std::vector<const DexFile*>& dex_files,
+                                     uint8_t* storage) {
+  static_assert(alignof(Entry) == 4u, "Expecting Entry to be 4-byte aligned.");
+  static_assert(sizeof(Entry) == 12u, "Unexpected Entry size.");
+  DCHECK_ALIGNED(storage, alignof(Entry));
+  std::vector<uint32_t> counts;
+  uint32_t num_class_defs = 0u;
+  for (const DexFile* dex_file : dex_files) {
+    counts.push_back(dex_file->NumClassDefs());
+    num_class_defs += dex_file->NumClassDefs();
+  }
+  DCHECK(SupportedSize(counts));
+  const uint32_t size = CalculateSize(num_class_defs);
+  const uint32_t mask = size - 1u;
+  memcpy(storage, &size, sizeof(size));
+  Entry* entries = reinterpret_cast<Entry*>(storage + sizeof(uint32_t));
+  memset(entries, 0, size * sizeof(Entry));
+  for (size_t dex_file_index = 0; dex_file_index != dex_files.size(); ++dex_file_index) {
+    const DexFile& dex_file = *dex_files[dex_file_index];
+    for (size_t i = 0; i < dex_file.NumClassDefs(); ++i) {
+      const DexFile::ClassDef& class_def = dex_file.GetClassDef(i);
+      const DexFile::TypeId& type_id = dex_file.GetTypeId(class_def.class_idx_);
+      const DexFile::StringId& str_id = dex_file.GetStringId(type_id.descriptor_idx_);
+      const char* descriptor = dex_file.GetStringData(str_id);
+      const uint32_t hash = ComputeModifiedUtf8Hash(descriptor);
+      uint32_t pos = hash & mask;
+      bool duplicate = false;
+      while (!entries[pos].IsEmpty()) {
+        const Entry& entry = entries[pos];
+        if (entry.hash == hash) {
+          const DexFile& other = *dex_files[entry.dex_file_index];
+          const DexFile::ClassDef& other_def = other.GetClassDef(entry.class_def_idx);
+          if (strcmp(descriptor, other.GetClassDescriptor(other_def)) == 0) {
+            // Keep the class defined first.
+            duplicate = true;
+            break;
+          }
+        }
+        pos = (pos + 1u) & mask;
+      }
+      if (!duplicate) {
+        entries[pos].hash = hash;
+        entries[pos].str_offset = str_id.string_data_off_;
+        entries[pos].dex_file_index = dex_file_index;
+        entries[pos].class_def_idx = i;
+      }
+    }
+  }
+}
+
+MultiDexTypeLookupTable* MultiDexTypeLookupTable::Open(
+    const uint8_t* raw_data,
+    size_t raw_data_length,
+    const std::vector<const uint8_t*>& dex_files) {
+  DCHECK_ALIGNED(raw_data, alignof(Entry));
+  if (raw_data_length < sizeof(uint32_t)) {
+    return nullptr;
+  }
+  uint32_t size;
+  memcpy(&size, raw_data, sizeof(size));
+  if (size == 0u ||
+      !IsPowerOfTwo(size) ||
+      (raw_data_length - sizeof(uint32_t)) / sizeof(Entry) < size ||
+      dex_files.size() > std::numeric_limits<uint16_t>::max()) {
+    return nullptr;
+  }
+  return new MultiDexTypeLookupTable(raw_data, dex_files);
+}
+
+MultiDexTypeLookupTable::MultiDexTypeLookupTable(const uint8_t* raw_data,
+                                                 const std::vector<const uint8_t*>& dex_files)
+    : dex_files_(dex_files),
+      size_(*reinterpret_cast<const uint32_t*>(raw_data)),
+      entries_(reinterpret_cast<const Entry*>(raw_data + sizeof(uint32_t))) {}
+
+}  // namespace art
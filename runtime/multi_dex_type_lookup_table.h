@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_MULTI_DEX_TYPE_LOOKUP_TABLE_H_
+#define ART_RUNTIME_MULTI_DEX_TYPE_LOOKUP_TABLE_H_
+
+#include <vector>
+
+#include "base/macros.h"
+#include "dex_file.h"
+#include "leb128.h"
+#include "utf.h"
+
+namespace art {
+
+/**
+ * MultiDexTypeLookupTable finds the dex file and class_def_idx of a class descriptor among all of
+ * the dex files of an oat file with a single hash table, so that a miss costs one probe sequence
+ * rather than one per dex file. Like the TypeLookupTable, it is created by the oat writer and its
+ * raw data is read from the memory-mapped oat file at runtime.
+ *
+ * The raw data is the number of entries, a power of two, followed by the entries. Each entry keeps
+ * the full hash of its descriptor, so that strings are only compared on a likely hit. When several
+ * dex files define the same descriptor, the table holds the first one, as the class loaders do.
+ */
+class MultiDexTypeLookupTable {
+ public:
+  // Method search the dex file index and class_def_idx by class descriptor and it's hash.
+  // Returns false if no dex file of the table defines the class.
+  ALWAYS_INLINE bool Lookup(const char* str,
+                            uint32_t hash,
+                            /*out*/ uint32_t* dex_file_index,
+                            /*out*/ uint32_t* class_def_idx) const {
+    const uint32_t mask = GetSizeMask();
+    for (uint32_t pos = hash & mask; ; pos = (pos + 1) & mask) {
+      const Entry& entry = entries_[pos];
+      if (entry.IsEmpty()) {
+        return false;
+      }
+      if (entry.hash == hash && IsStringsEquals(str, entry)) {
+        *dex_file_index = entry.dex_file_index;
+        *class_def_idx = entry.class_def_idx;
+        return true;
+      }
+    }
+  }
+
+  // Method returns true if a table can be created for dex files with the specified numbers of
+  // class definitions.
+  static bool SupportedSize(const std::vector<uint32_t>& num_class_defs);
+
+  // Method returns length of binary data for the specified total number of class definitions.
+  static uint32_t RawDataLength(uint32_t num_class_defs);
+
+  // Method fills `storage`, of RawDataLength() bytes, with the table for the dex files.
+  static void Create(const std::vector<const DexFile*>& dex_files, uint8_t* storage);
+
+  // Method opens lookup table from binary data of `raw_data_length` bytes. Lookup table does not
+  // owns binary data. The `dex_files` are the raw dex files in the order of the writer. Returns
+  // null if the data is inconsistent with them.
+  static MultiDexTypeLookupTable* Open(const uint8_t* raw_data,
+                                       size_t raw_data_length,
+                                       const std::vector<const uint8_t*>& dex_files);
+
+ private:
+  struct Entry {
+    uint32_t hash;
+    uint32_t str_offset;
+    uint16_t dex_file_index;
+    uint16_t class_def_idx;
+
+    bool IsEmpty() const {
+      return str_offset == 0;
+    }
+  };
+
+  MultiDexTypeLookupTable(const uint8_t* raw_data, const std::vector<const uint8_t*>& dex_files);
+
+  static uint32_t CalculateSize(uint32_t num_class_defs);
+
+  bool IsStringsEquals(const char* str, const Entry& entry) const {
+    DCHECK_LT(entry.dex_file_index, dex_files_.size());
+    const uint8_t* ptr = dex_files_[entry.dex_file_index] + entry.str_offset;
+    // Skip string length.
+    DecodeUnsignedLeb128(&ptr);
+    return CompareModifiedUtf8ToModifiedUtf8AsUtf16CodePointValues(
+        str, reinterpret_cast<const char*>(ptr)) == 0;
+  }
+
+  uint32_t GetSizeMask() const {
+    return size_ - 1u;
+  }
+
+  const std::vector<const uint8_t*> dex_files_;
+  const uint32_t size_;
+  const Entry* const entries_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(MultiDexTypeLookupTable);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_MULTI_DEX_TYPE_LOOKUP_TABLE_H_
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+
+#include "common_runtime_test.h"
+#include "dex_file-inl.h"
+#include "multi_dex_type_lookup_table.h"
+#include "scoped_thread_state_change.h"
+#include "utf-inl.h"
+
+namespace art {
+
+class MultiDexTypeLookupTableTest : public CommonRuntimeTest {
+ protected:
+  // Create the table in `storage` and open it.
+  static MultiDexTypeLookupTable* CreateTable(const std::vector<const DexFile*>& dex_files,
+                                              std::vector<uint32_t>* storage) {
+    std::vector<uint32_t> num_class_defs;
+    uint32_t total = 0u;
+    std::vector<const uint8_t*> dex_file_pointers;
+    for (const DexFile* dex_file : dex_files) {
+      num_class_defs.push_back(dex_file->NumClassDefs());
+      total += dex_file->NumClassDefs();
+      dex_file_pointers.push_back(dex_file->Begin());
+    }
+    EXPECT_TRUE(MultiDexTypeLookupTable::SupportedSize(num_class_defs));
+    const uint32_t length = MultiDexTypeLookupTable::RawDataLength(total);
+    storage->resize(length / sizeof(uint32_t));
+    uint8_t* raw_data = reinterpret_cast<uint8_t*>(storage->data());
+    MultiDexTypeLookupTable::Create(dex_files, raw_data);
+    return MultiDexTypeLookupTable::Open(raw_data, length, dex_file_pointers);
+  }
+};
+
+TEST_F(MultiDexTypeLookupTableTest, Find) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<std::unique_ptr<const DexFile>> opened = OpenTestDexFiles("MultiDex");
+  ASSERT_EQ(2U, opened.size());
+  std::vector<const DexFile*> dex_files = { opened[0].get(), opened[1].get() };
+  std::vector<uint32_t> storage;
+  std::unique_ptr<MultiDexTypeLookupTable> table(CreateTable(dex_files, &storage));
+  ASSERT_NE(nullptr, table.get());
+
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    for (size_t j = 0; j != dex_files[i]->NumClassDefs(); ++j) {
+      const char* descriptor = dex_files[i]->GetClassDescriptor(dex_files[i]->GetClassDef(j));
+      uint32_t dex_file_index;
+      uint32_t class_def_idx;
+      ASSERT_TRUE(table->Lookup(descriptor,
+                                ComputeModifiedUtf8Hash(descriptor),
+                                &dex_file_index,
+                                &class_def_idx)) << descriptor;
+      EXPECT_EQ(i, dex_file_index);
+      EXPECT_EQ(j, class_def_idx);
+    }
+  }
+
+  uint32_t dex_file_index;
+  uint32_t class_def_idx;
+  const char* missing = "LDoesNotExist;";
+  EXPECT_FALSE(table->Lookup(missing,
+                             ComputeModifiedUtf8Hash(missing),
+                             &dex_file_index,
+                             &class_def_idx));
+}
+
+TEST_F(MultiDexTypeLookupTableTest, FindFirstDefinition) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<std::unique_ptr<const DexFile>> opened = OpenTestDexFiles("MultiDex");
+  ASSERT_EQ(2U, opened.size());
+  // The second dex file defines the classes of the first one again.
+  std::vector<const DexFile*> dex_files = { opened[1].get(), opened[0].get(), opened[1].get() };
+  std::vector<uint32_t> storage;
+  std::unique_ptr<MultiDexTypeLookupTable> table(CreateTable(dex_files, &storage));
+  ASSERT_NE(nullptr, table.get());
+
+  const char* descriptor = "LSecond;";
+  uint32_t dex_file_index;
+  uint32_t class_def_idx;
+  ASSERT_TRUE(table->Lookup(descriptor,
+                            ComputeModifiedUtf8Hash(descriptor),
+                            &dex_file_index,
+                            &class_def_idx));
+  EXPECT_EQ(0U, dex_file_index);
+  descriptor = "LMain;";
+  ASSERT_TRUE(table->Lookup(descriptor,
+                            ComputeModifiedUtf8Hash(descriptor),
+                            &dex_file_index,
+                            &class_def_idx));
+  EXPECT_EQ(1U, dex_file_index);
+}
+
+TEST_F(MultiDexTypeLookupTableTest, OpenTruncated) {
+  std::vector<uint32_t> storage = { 16u, 0u, 0u };
+  std::vector<const uint8_t*> dex_files;
+  std::unique_ptr<MultiDexTypeLookupTable> table(MultiDexTypeLookupTable::Open(
+      reinterpret_cast<const uint8_t*>(storage.data()),
+      storage.size() * sizeof(uint32_t),
+      dex_files));
+  EXPECT_EQ(nullptr, table.get());
+}
+
+}  // namespace art
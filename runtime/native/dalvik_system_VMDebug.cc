@@ -26,6 +26,7 @@
 #include "class_linker.h"
 #include "common_throws.h"
 #include "debugger.h"
+#include "gc/gc_stats.h"
 #include "gc/space/bump_pointer_space.h"
 #include "gc/space/dlmalloc_space.h"
 #include "gc/space/large_object_space.h"
@@ -368,6 +369,7 @@ enum class VMDebugRuntimeStatId {
   kArtGcBlockingGcTime,
   kArtGcGcCountRateHistogram,
   kArtGcBlockingGcCountRateHistogram,
+  kArtGcStatsJson,
   kNumRuntimeStats,
 };
 
@@ -408,6 +410,11 @@ static jobject VMDebug_getRuntimeStatInternal(JNIEnv* env, jclass, jint statId)
       heap->DumpBlockingGcCountRateHistogram(output);
       return env->NewStringUTF(output.str().c_str());
     }
+    case VMDebugRuntimeStatId::kArtGcStatsJson: {
+      std::ostringstream output;
+      heap->GetGcStats()->DumpJson(output);
+      return env->NewStringUTF(output.str().c_str());
+    }
     default:
       return nullptr;
   }
@@ -472,6 +479,13 @@ static jobjectArray VMDebug_getRuntimeStatsInternal(JNIEnv* env, jclass) {
       return nullptr;
     }
   }
+  {
+    std::ostringstream output;
+    heap->GetGcStats()->DumpJson(output);
+    if (!SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtGcStatsJson, output.str())) {
+      return nullptr;
+    }
+  }
   return result;
 }
 
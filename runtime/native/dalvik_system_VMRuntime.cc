@@ -444,13 +444,15 @@ static void PreloadDexCachesStatsFilled(DexCacheStats* filled)
       continue;
     }
     for (size_t j = 0; j < dex_cache->NumStrings(); j++) {
-      mirror::String* string = dex_cache->GetResolvedString(j);
+      uint32_t string_idx;
+      mirror::String* string = dex_cache->GetStringSlot(j, &string_idx);
       if (string != nullptr) {
         filled->num_strings++;
       }
     }
     for (size_t j = 0; j < dex_cache->NumResolvedTypes(); j++) {
-      mirror::Class* klass = dex_cache->GetResolvedType(j);
+      uint32_t type_idx;
+      mirror::Class* klass = dex_cache->GetTypeSlot(j, &type_idx);
       if (klass != nullptr) {
         filled->num_types++;
       }
@@ -507,13 +509,13 @@ static void VMRuntime_preloadDexCaches(JNIEnv* env, jobject) {
     Handle<mirror::DexCache> dex_cache(hs.NewHandle(linker->RegisterDexFile(*dex_file, nullptr)));
 
     if (kPreloadDexCachesStrings) {
-      for (size_t j = 0; j < dex_cache->NumStrings(); j++) {
+      for (size_t j = 0; j < dex_file->NumStringIds(); j++) {
         PreloadDexCachesResolveString(dex_cache, j, strings);
       }
     }
 
     if (kPreloadDexCachesTypes) {
-      for (size_t j = 0; j < dex_cache->NumResolvedTypes(); j++) {
+      for (size_t j = 0; j < dex_file->NumTypeIds(); j++) {
         PreloadDexCachesResolveType(soa.Self(), dex_cache.Get(), j);
       }
     }
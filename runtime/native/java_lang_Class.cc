@@ -193,12 +193,16 @@ ALWAYS_INLINE static inline ArtField* FindFieldByName(
   }
   size_t low = 0;
   size_t high = fields->size();
-  const uint16_t* const data = name->GetValue();
+  const bool is_compressed = name->IsCompressed();
+  const uint16_t* const data = is_compressed ? nullptr : name->GetValue();
+  const uint8_t* const data_compressed = is_compressed ? name->GetValueCompressed() : nullptr;
   const size_t length = name->GetLength();
   while (low < high) {
     auto mid = (low + high) / 2;
     ArtField& field = fields->At(mid);
-    int result = CompareModifiedUtf8ToUtf16AsCodePointValues(field.GetName(), data, length);
+    int result = is_compressed
+        ? CompareModifiedUtf8ToUtf16AsCodePointValues(field.GetName(), data_compressed, length)
+        : CompareModifiedUtf8ToUtf16AsCodePointValues(field.GetName(), data, length);
     // Alternate approach, only a few % faster at the cost of more allocations.
     // int result = field->GetStringName(self, true)->CompareTo(name);
     if (result < 0) {
@@ -165,8 +165,19 @@ static jbyteArray charsToBytes(JNIEnv* env, jstring java_string, jint offset, ji
     return nullptr;
   }
 
-  const jchar* src = &(string->GetValue()[offset]);
   jbyte* dst = &bytes[0];
+  if (string->IsCompressed()) {
+    const uint8_t* src = &(string->GetValueCompressed()[offset]);
+    for (int i = length - 1; i >= 0; --i) {
+      jchar ch = *src++;
+      if (ch > maxValidChar) {
+        ch = '?';
+      }
+      *dst++ = static_cast<jbyte>(ch);
+    }
+    return javaBytes;
+  }
+  const jchar* src = &(string->GetValue()[offset]);
   for (int i = length - 1; i >= 0; --i) {
     jchar ch = *src++;
     if (ch > maxValidChar) {
@@ -78,7 +78,8 @@ OatHeader::OatHeader(InstructionSet instruction_set,
       quick_to_interpreter_bridge_offset_(0),
       image_patch_delta_(0),
       image_file_location_oat_checksum_(0),
-      image_file_location_oat_data_begin_(0) {
+      image_file_location_oat_data_begin_(0),
+      multi_dex_type_lookup_table_offset_(0) {
   // Don't want asserts in header as they would be checked in each file that includes it. But the
   // fields are private, so we check inside a method.
   static_assert(sizeof(magic_) == sizeof(kOatMagic),
@@ -155,6 +156,8 @@ void OatHeader::UpdateChecksumWithHeaderData() {
   UpdateChecksum(&dex_file_count_, sizeof(dex_file_count_));
   UpdateChecksum(&image_file_location_oat_checksum_, sizeof(image_file_location_oat_checksum_));
   UpdateChecksum(&image_file_location_oat_data_begin_, sizeof(image_file_location_oat_data_begin_));
+  UpdateChecksum(&multi_dex_type_lookup_table_offset_,
+                 sizeof(multi_dex_type_lookup_table_offset_));
 
   // Update checksum for variable data size.
   UpdateChecksum(&key_value_store_size_, sizeof(key_value_store_size_));
@@ -384,6 +387,17 @@ void OatHeader::SetImageFileLocationOatDataBegin(uint32_t image_file_location_oa
   image_file_location_oat_data_begin_ = image_file_location_oat_data_begin;
 }
 
+uint32_t OatHeader::GetMultiDexTypeLookupTableOffset() const {
+  CHECK(IsValid());
+  return multi_dex_type_lookup_table_offset_;
+}
+
+void OatHeader::SetMultiDexTypeLookupTableOffset(uint32_t offset) {
+  CHECK(IsValid());
+  CHECK_ALIGNED(offset, sizeof(uint32_t));
+  multi_dex_type_lookup_table_offset_ = offset;
+}
+
 uint32_t OatHeader::GetKeyValueStoreSize() const {
   CHECK(IsValid());
   return key_value_store_size_;
@@ -32,7 +32,7 @@ class InstructionSetFeatures;
 class PACKED(4) OatHeader {
  public:
   static constexpr uint8_t kOatMagic[] = { 'o', 'a', 't', '\n' };
-  static constexpr uint8_t kOatVersion[] = { '0', '8', '8', '\0' };
+  static constexpr uint8_t kOatVersion[] = { '0', '9', '0', '\0' };
 
   static constexpr const char* kImageLocationKey = "image-location";
   static constexpr const char* kDex2OatCmdLineKey = "dex2oat-cmdline";
@@ -103,6 +103,10 @@ class PACKED(4) OatHeader {
   uint32_t GetImageFileLocationOatDataBegin() const;
   void SetImageFileLocationOatDataBegin(uint32_t image_file_location_oat_data_begin);
 
+  // The offset of the MultiDexTypeLookupTable of all the dex files, or 0 if there is none.
+  uint32_t GetMultiDexTypeLookupTableOffset() const;
+  void SetMultiDexTypeLookupTableOffset(uint32_t offset);
+
   uint32_t GetKeyValueStoreSize() const;
   const uint8_t* GetKeyValueStore() const;
   const char* GetStoreValueByKey(const char* key) const;
@@ -150,6 +154,8 @@ class PACKED(4) OatHeader {
   uint32_t image_file_location_oat_checksum_;
   uint32_t image_file_location_oat_data_begin_;
 
+  uint32_t multi_dex_type_lookup_table_offset_;
+
   uint32_t key_value_store_size_;
   uint8_t key_value_store_[0];  // note variable width data at end
 
@@ -43,6 +43,7 @@
 #include "mem_map.h"
 #include "mirror/class.h"
 #include "mirror/object-inl.h"
+#include "multi_dex_type_lookup_table.h"
 #include "oat_file-inl.h"
 #include "oat_file_manager.h"
 #include "os.h"
@@ -475,6 +476,35 @@ bool OatFileBase::Setup(const char* abs_dex_location, std::string* error_msg) {
     }
   }
 
+  uint32_t multi_dex_lookup_table_offset = GetOatHeader().GetMultiDexTypeLookupTableOffset();
+  if (multi_dex_lookup_table_offset != 0u) {
+    if (UNLIKELY(multi_dex_lookup_table_offset > Size()) ||
+        UNLIKELY(!IsAligned<alignof(uint32_t)>(multi_dex_lookup_table_offset))) {
+      *error_msg = StringPrintf("In oat file '%s' found invalid multi-dex type lookup table "
+                                    "offset %u of %zu",
+                                GetLocation().c_str(),
+                                multi_dex_lookup_table_offset,
+                                Size());
+      return false;
+    }
+    std::vector<const uint8_t*> dex_file_pointers;
+    for (const OatDexFile* oat_dex_file : oat_dex_files_storage_) {
+      dex_file_pointers.push_back(oat_dex_file->GetDexFilePointer());
+    }
+    multi_dex_lookup_table_.reset(
+        MultiDexTypeLookupTable::Open(Begin() + multi_dex_lookup_table_offset,
+                                      Size() - multi_dex_lookup_table_offset,
+                                      dex_file_pointers));
+    if (multi_dex_lookup_table_ == nullptr) {
+      *error_msg = StringPrintf("In oat file '%s' found truncated multi-dex type lookup table, "
+                                    "offset %u of %zu",
+                                GetLocation().c_str(),
+                                multi_dex_lookup_table_offset,
+                                Size());
+      return false;
+    }
+  }
+
   if (dex_cache_arrays != bss_end_) {
     // We expect the bss section to be either empty (dex_cache_arrays and bss_end_
     // both null) or contain just the dex cache arrays and nothing else.
@@ -1048,6 +1078,22 @@ OatFile::~OatFile() {
   STLDeleteElements(&oat_dex_files_storage_);
 }
 
+bool OatFile::FindClassDef(const char* descriptor,
+                           size_t hash,
+                           const OatDexFile** oat_dex_file,
+                           uint32_t* class_def_idx) const {
+  if (multi_dex_lookup_table_ == nullptr) {
+    return false;
+  }
+  uint32_t dex_file_index;
+  if (multi_dex_lookup_table_->Lookup(descriptor, hash, &dex_file_index, class_def_idx)) {
+    *oat_dex_file = oat_dex_files_storage_[dex_file_index];
+  } else {
+    *oat_dex_file = nullptr;
+  }
+  return true;
+}
+
 const OatHeader& OatFile::GetOatHeader() const {
   return *reinterpret_cast<const OatHeader*>(Begin());
 }
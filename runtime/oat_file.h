@@ -18,6 +18,7 @@
 #define ART_RUNTIME_OAT_FILE_H_
 
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -36,6 +37,7 @@ namespace art {
 class BitVector;
 class ElfFile;
 class MemMap;
+class MultiDexTypeLookupTable;
 class OatMethodOffsets;
 class OatHeader;
 class OatDexFile;
@@ -222,6 +224,14 @@ class OatFile {
     return oat_dex_files_storage_;
   }
 
+  // Look up the first dex file of this oat file defining `descriptor` with the single lookup
+  // table of all of them. Returns false if the oat file has no such table, otherwise sets
+  // `oat_dex_file` to null if none of the dex files defines the class.
+  bool FindClassDef(const char* descriptor,
+                    size_t hash,
+                    /*out*/ const OatDexFile** oat_dex_file,
+                    /*out*/ uint32_t* class_def_idx) const;
+
   size_t Size() const {
     return End() - Begin();
   }
@@ -291,6 +301,9 @@ class OatFile {
   // Owning storage for the OatDexFile objects.
   std::vector<const OatDexFile*> oat_dex_files_storage_;
 
+  // The lookup table of all the dex files, null if the oat file has a single one or predates it.
+  std::unique_ptr<MultiDexTypeLookupTable> multi_dex_lookup_table_;
+
   // NOTE: We use a StringPiece as the key type to avoid a memory allocation on every
   // lookup with a const char* key. The StringPiece doesn't own its backing storage,
   // therefore we're using the OatDexFile::dex_file_location_ as the backing storage
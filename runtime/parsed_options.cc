@@ -132,6 +132,32 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:LongGCLogThreshold=_")  // in ms
           .WithType<MillisecondsToNanoseconds>()  // store as ns
           .IntoKey(M::LongGCLogThreshold)
+      .Define("-XX:GcPauseTarget=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::GcPauseTarget)
+      .Define("-XX:GcCpuShareTarget=_")
+          .WithType<double>().WithRange(0.0, 1.0)
+          .IntoKey(M::GcCpuShareTarget)
+      .Define("-XX:GcStatsFile=_")
+          .WithType<std::string>()
+          .IntoKey(M::GcStatsFile)
+      .Define("-XX:GcStatsInterval=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::GcStatsInterval)
+      .Define("-XX:HprofDumpThreads=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::HprofDumpThreads)
+      .Define("-XX:HprofCompression=_")
+          .WithType<bool>()
+          .WithValueMap({{"none", false}, {"gzip", true}})
+          .IntoKey(M::HprofGzip)
+      .Define("-XX:HprofStreaming")
+          .IntoKey(M::HprofStreaming)
+      .Define("-XX:StringDeduplication")
+          .IntoKey(M::StringDeduplication)
+      .Define("-XX:RegionPrezeroPoolSize=_")  // in regions
+          .WithType<unsigned int>()
+          .IntoKey(M::RegionPrezeroPoolSize)
       .Define("-XX:DumpGCPerformanceOnShutdown")
           .IntoKey(M::DumpGCPerformanceOnShutdown)
       .Define("-XX:DumpJITInfoOnShutdown")
@@ -143,6 +169,14 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:UseTLAB")
           .WithValue(true)
           .IntoKey(M::UseTLAB)
+      .Define("-XX:UseRosAllocPerCpuRuns")
+          .IntoKey(M::UseRosAllocPerCpuRuns)
+      .Define("-XX:AllocSampleInterval=_")
+          .WithType<Memory<1>>()
+          .IntoKey(M::AllocSampleInterval)
+      .Define("-XX:AllocSampleProfile=_")
+          .WithType<std::string>()
+          .IntoKey(M::AllocSampleProfile)
       .Define({"-XX:EnableHSpaceCompactForOOM", "-XX:DisableHSpaceCompactForOOM"})
           .WithValues({true, false})
           .IntoKey(M::EnableHSpaceCompactForOOM)
@@ -175,6 +209,22 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xjittransitionweight:_")
           .WithType<unsigned int>()
           .IntoKey(M::JITInvokeTransitionWeight)
+      .Define("-Xjitthreadpoolsize:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITThreadPoolSize)
+      .Define("-Xusetieredjit:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::UseTieredJitCompilation)
+      .Define("-Xjitcodesnapshot:_")
+          .WithType<std::string>()
+          .IntoKey(M::JITCodeSnapshot)
+      .Define("-Xjitperfmap")
+          .WithValue(true)
+          .IntoKey(M::JITWritePerfMap)
+      .Define("-Xjitdump")
+          .WithValue(true)
+          .IntoKey(M::JITWriteJitDump)
       .Define("-Xjitsaveprofilinginfo")
           .WithValue(true)
           .IntoKey(M::JITSaveProfilingInfo)
@@ -535,6 +585,12 @@ bool ParsedOptions::DoParse(const RuntimeOptions& options,
         background_collector_type_ = collector_type_;
       }
     }
+    // The generational CC shares the heap layout of CC, so it replaces CC in the background
+    // rather than causing a collector transition.
+    if (collector_type_ == gc::kCollectorTypeGenCC &&
+        background_collector_type_ == gc::kCollectorTypeCC) {
+      background_collector_type_ = collector_type_;
+    }
 
     args.Set(M::BackgroundGc, BackgroundGcOption { background_collector_type_ });
   }
@@ -682,10 +738,22 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:MaxSpinsBeforeThinLockInflation=integervalue\n");
   UsageMessage(stream, "  -XX:LongPauseLogThreshold=integervalue\n");
   UsageMessage(stream, "  -XX:LongGCLogThreshold=integervalue\n");
+  UsageMessage(stream, "  -XX:GcPauseTarget=integervalue\n");
+  UsageMessage(stream, "  -XX:GcCpuShareTarget=doublevalue\n");
+  UsageMessage(stream, "  -XX:GcStatsFile=filename\n");
+  UsageMessage(stream, "  -XX:GcStatsInterval=integervalue\n");
+  UsageMessage(stream, "  -XX:HprofDumpThreads=integervalue\n");
+  UsageMessage(stream, "  -XX:HprofCompression={none,gzip}\n");
+  UsageMessage(stream, "  -XX:HprofStreaming\n");
+  UsageMessage(stream, "  -XX:StringDeduplication\n");
+  UsageMessage(stream, "  -XX:RegionPrezeroPoolSize=integervalue\n");
   UsageMessage(stream, "  -XX:DumpGCPerformanceOnShutdown\n");
   UsageMessage(stream, "  -XX:DumpJITInfoOnShutdown\n");
   UsageMessage(stream, "  -XX:IgnoreMaxFootprint\n");
   UsageMessage(stream, "  -XX:UseTLAB\n");
+  UsageMessage(stream, "  -XX:UseRosAllocPerCpuRuns\n");
+  UsageMessage(stream, "  -XX:AllocSampleInterval=N\n");
+  UsageMessage(stream, "  -XX:AllocSampleProfile=filename\n");
   UsageMessage(stream, "  -XX:BackgroundGC=none\n");
   UsageMessage(stream, "  -XX:LargeObjectSpace={disabled,map,freelist}\n");
   UsageMessage(stream, "  -XX:LargeObjectThreshold=N\n");
@@ -714,6 +782,11 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xjitwarmupthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitosrthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitprithreadweight:integervalue\n");
+  UsageMessage(stream, "  -Xjitthreadpoolsize:integervalue\n");
+  UsageMessage(stream, "  -Xusetieredjit:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitcodesnapshot:filename\n");
+  UsageMessage(stream, "  -Xjitperfmap\n");
+  UsageMessage(stream, "  -Xjitdump\n");
   UsageMessage(stream, "  -X[no]relocate\n");
   UsageMessage(stream, "  -X[no]dex2oat (Whether to invoke dex2oat on the application)\n");
   UsageMessage(stream, "  -X[no]image-dex2oat (Whether to create and use a boot image)\n");
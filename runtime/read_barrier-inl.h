@@ -185,7 +185,7 @@ inline bool ReadBarrier::IsDuringStartup() {
     // During startup, the heap can be null.
     return true;
   }
-  if (heap->CurrentCollectorType() != gc::kCollectorTypeCC) {
+  if (!gc::Heap::IsConcurrentCopyingGc(heap->CurrentCollectorType())) {
     // CC isn't running.
     return true;
   }
@@ -61,6 +61,7 @@
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/unix_file/fd_file.h"
+#include "cha.h"
 #include "class_linker-inl.h"
 #include "compiler_callbacks.h"
 #include "compiler_filter.h"
@@ -70,6 +71,8 @@
 #include "experimental_flags.h"
 #include "fault_handler.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/allocation_sampler.h"
+#include "gc/gc_stats.h"
 #include "gc/heap.h"
 #include "gc/space/image_space.h"
 #include "gc/space/space-inl.h"
@@ -215,6 +218,9 @@ Runtime::Runtime()
       system_thread_group_(nullptr),
       system_class_loader_(nullptr),
       dump_gc_performance_on_shutdown_(false),
+      hprof_dump_threads_(1u),
+      hprof_gzip_(false),
+      hprof_streaming_(false),
       preinitialization_transaction_(nullptr),
       verify_(verifier::VerifyMode::kNone),
       allow_dex_file_fallback_(true),
@@ -281,6 +287,11 @@ Runtime::~Runtime() {
                                             WellKnownClasses::java_lang_Daemons_stop);
   }
 
+  if (jit_ != nullptr) {
+    // Save the JIT code while this thread can still access the compiled methods.
+    jit_->WriteCodeSnapshot(self);
+  }
+
   Trace::Shutdown();
 
   if (attach_shutdown_thread) {
@@ -748,7 +759,8 @@ void Runtime::InitNonZygoteOrPostFork(
   // Reset the gc performance data at zygote fork so that the GCs
   // before fork aren't attributed to an app.
   heap_->ResetGcPerformanceInfo();
-
+  // Only dump the GC statistics of the apps, not of the zygote.
+  heap_->RequestGcStatsDump(Thread::Current());
 
   if (!is_system_server &&
       !safe_mode_ &&
@@ -1031,8 +1043,11 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
                        runtime_options.Exists(Opt::LowMemoryMode),
                        runtime_options.GetOrDefault(Opt::LongPauseLogThreshold),
                        runtime_options.GetOrDefault(Opt::LongGCLogThreshold),
+                       runtime_options.GetOrDefault(Opt::GcPauseTarget),
+                       runtime_options.GetOrDefault(Opt::GcCpuShareTarget),
                        runtime_options.Exists(Opt::IgnoreMaxFootprint),
                        runtime_options.GetOrDefault(Opt::UseTLAB),
+                       runtime_options.Exists(Opt::UseRosAllocPerCpuRuns),
                        xgc_option.verify_pre_gc_heap_,
                        xgc_option.verify_pre_sweeping_heap_,
                        xgc_option.verify_post_gc_heap_,
@@ -1049,6 +1064,25 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   }
 
   dump_gc_performance_on_shutdown_ = runtime_options.Exists(Opt::DumpGCPerformanceOnShutdown);
+  hprof_dump_threads_ = std::max(runtime_options.GetOrDefault(Opt::HprofDumpThreads), 1u);
+  hprof_gzip_ = runtime_options.GetOrDefault(Opt::HprofGzip);
+  hprof_streaming_ = runtime_options.Exists(Opt::HprofStreaming);
+  if (runtime_options.Exists(Opt::StringDeduplication)) {
+    heap_->EnableStringDeduplication();
+  }
+  if (runtime_options.GetOrDefault(Opt::RegionPrezeroPoolSize) != 0u) {
+    heap_->SetRegionPrezeroPoolSize(runtime_options.GetOrDefault(Opt::RegionPrezeroPoolSize));
+  }
+  if (runtime_options.Exists(Opt::GcStatsFile)) {
+    heap_->GetGcStats()->SetDumpFile(runtime_options.GetOrDefault(Opt::GcStatsFile),
+                                     runtime_options.GetOrDefault(Opt::GcStatsInterval));
+  }
+
+  size_t alloc_sample_interval = runtime_options.GetOrDefault(Opt::AllocSampleInterval);
+  if (alloc_sample_interval != 0) {
+    gc::AllocationSampler::Start(alloc_sample_interval,
+                                 runtime_options.GetOrDefault(Opt::AllocSampleProfile));
+  }
 
   if (runtime_options.Exists(Opt::JdwpOptions)) {
     Dbg::ConfigureJdwp(runtime_options.GetOrDefault(Opt::JdwpOptions));
@@ -1080,6 +1114,12 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   }
   linear_alloc_.reset(CreateLinearAlloc());
 
+  // Only the JIT compiles code that relies on the class hierarchy analysis, which
+  // otherwise would just slow down class linking.
+  if (jit_options_->UseJitCompilation()) {
+    cha_.reset(new ClassHierarchyAnalysis());
+  }
+
   BlockSignals();
   InitPlatformSignalHandlers();
 
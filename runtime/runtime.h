@@ -74,6 +74,7 @@ namespace verifier {
 }  // namespace verifier
 class ArenaPool;
 class ArtMethod;
+class ClassHierarchyAnalysis;
 class ClassLinker;
 class Closure;
 class CompilerCallbacks;
@@ -453,6 +454,12 @@ class Runtime {
     return jit_.get();
   }
 
+  // Returns the class hierarchy analysis. Null unless the JIT compiles code, as
+  // AOT compiled code cannot rely on the classes loaded at compile time.
+  ClassHierarchyAnalysis* GetClassHierarchyAnalysis() {
+    return cha_.get();
+  }
+
   // Returns true if JIT compilations are enabled. GetJit() will be not null in this case.
   bool UseJitCompilation() const;
   // Returns true if profile saving is enabled. GetJit() will be not null in this case.
@@ -506,14 +513,10 @@ class Runtime {
                                  mirror::Object* value, bool is_volatile) const;
   void RecordWriteArray(mirror::Array* array, size_t index, uint64_t value) const
       SHARED_REQUIRES(Locks::mutator_lock_);
-  void RecordStrongStringInsertion(mirror::String* s) const
-      REQUIRES(Locks::intern_table_lock_);
-  void RecordWeakStringInsertion(mirror::String* s) const
-      REQUIRES(Locks::intern_table_lock_);
-  void RecordStrongStringRemoval(mirror::String* s) const
-      REQUIRES(Locks::intern_table_lock_);
-  void RecordWeakStringRemoval(mirror::String* s) const
-      REQUIRES(Locks::intern_table_lock_);
+  void RecordStrongStringInsertion(mirror::String* s) const;
+  void RecordWeakStringInsertion(mirror::String* s) const;
+  void RecordStrongStringRemoval(mirror::String* s) const;
+  void RecordWeakStringRemoval(mirror::String* s) const;
 
   void SetFaultMessage(const std::string& message) REQUIRES(!fault_message_lock_);
   // Only read by the signal handler, NO_THREAD_SAFETY_ANALYSIS to prevent lock order violations
@@ -596,6 +599,20 @@ class Runtime {
     is_native_debuggable_ = value;
   }
 
+  // The number of threads walking the heap for a heap dump, whether it is compressed, and
+  // whether it is written in a single pass.
+  size_t GetHprofDumpThreads() const {
+    return hprof_dump_threads_;
+  }
+
+  bool IsHprofGzipEnabled() const {
+    return hprof_gzip_;
+  }
+
+  bool IsHprofStreamingEnabled() const {
+    return hprof_streaming_;
+  }
+
   // Returns the build fingerprint, if set. Otherwise an empty string is returned.
   std::string GetFingerprint() {
     return fingerprint_;
@@ -752,6 +769,8 @@ class Runtime {
   std::unique_ptr<jit::Jit> jit_;
   std::unique_ptr<jit::JitOptions> jit_options_;
 
+  std::unique_ptr<ClassHierarchyAnalysis> cha_;
+
   std::unique_ptr<lambda::BoxTable> lambda_box_table_;
 
   // Fault message, printed when we get a SIGSEGV.
@@ -804,6 +823,12 @@ class Runtime {
   // If true, then we dump the GC cumulative timings on shutdown.
   bool dump_gc_performance_on_shutdown_;
 
+  // Set by -XX:HprofDumpThreads, -XX:HprofCompression and -XX:HprofStreaming, see
+  // hprof::DumpHeap().
+  size_t hprof_dump_threads_;
+  bool hprof_gzip_;
+  bool hprof_streaming_;
+
   // Transaction used for pre-initializing classes at compilation time.
   Transaction* preinitialization_transaction_;
 
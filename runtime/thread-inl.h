@@ -230,6 +230,10 @@ inline void Thread::VerifyStack() {
 }
 
 inline size_t Thread::TlabSize() const {
+  return tlab_end_ - tlsPtr_.thread_local_pos;
+}
+
+inline size_t Thread::TlabFastPathSize() const {
   return tlsPtr_.thread_local_end - tlsPtr_.thread_local_pos;
 }
 
@@ -241,6 +245,28 @@ inline mirror::Object* Thread::AllocTlab(size_t bytes) {
   return ret;
 }
 
+inline bool Thread::CountDownAllocSample(mirror::Object* obj, size_t bytes) {
+  uint8_t* pos = tlsPtr_.thread_local_pos;
+  uint8_t* addr = reinterpret_cast<uint8_t*>(obj);
+  if (addr >= tlsPtr_.thread_local_start && addr < pos) {
+    bytes = 0;  // Counted with the other bytes taken from the TLAB.
+  }
+  bytes += pos - alloc_sample_tlab_mark_;
+  if (LIKELY(alloc_sample_bytes_remaining_ > bytes)) {
+    SetAllocSampleBytesRemaining(alloc_sample_bytes_remaining_ - bytes);
+    return false;
+  }
+  return true;
+}
+
+inline void Thread::SetAllocSampleBytesRemaining(size_t bytes) {
+  uint8_t* pos = tlsPtr_.thread_local_pos;
+  alloc_sample_bytes_remaining_ = bytes;
+  alloc_sample_tlab_mark_ = pos;
+  tlsPtr_.thread_local_end =
+      (bytes != 0 && bytes < static_cast<size_t>(tlab_end_ - pos)) ? pos + bytes : tlab_end_;
+}
+
 inline bool Thread::PushOnThreadLocalAllocationStack(mirror::Object* obj) {
   DCHECK_LE(tlsPtr_.thread_local_alloc_stack_top, tlsPtr_.thread_local_alloc_stack_end);
   if (tlsPtr_.thread_local_alloc_stack_top < tlsPtr_.thread_local_alloc_stack_end) {
@@ -2569,6 +2569,8 @@ void Thread::DumpThreadOffset(std::ostream& os, uint32_t offset) {
   QUICK_ENTRY_POINT_INFO(pReadBarrierMark)
   QUICK_ENTRY_POINT_INFO(pReadBarrierSlow)
   QUICK_ENTRY_POINT_INFO(pReadBarrierForRootSlow)
+  QUICK_ENTRY_POINT_INFO(pCompileOptimized)
+  QUICK_ENTRY_POINT_INFO(pUpdateInlineCache)
 #undef QUICK_ENTRY_POINT_INFO
 
   os << offset;
@@ -2921,10 +2923,17 @@ void Thread::SetStackEndForStackOverflow() {
 
 void Thread::SetTlab(uint8_t* start, uint8_t* end) {
   DCHECK_LE(start, end);
+  if (alloc_sample_bytes_remaining_ != 0) {
+    // Count down the bytes allocated in the old TLAB. If they reached the sample point, the next
+    // allocation is sampled.
+    size_t bytes = tlsPtr_.thread_local_pos - alloc_sample_tlab_mark_;
+    alloc_sample_bytes_remaining_ -= std::min(bytes, alloc_sample_bytes_remaining_ - 1);
+  }
   tlsPtr_.thread_local_start = start;
   tlsPtr_.thread_local_pos  = tlsPtr_.thread_local_start;
-  tlsPtr_.thread_local_end = end;
+  tlab_end_ = end;
   tlsPtr_.thread_local_objects = 0;
+  SetAllocSampleBytesRemaining(alloc_sample_bytes_remaining_);
 }
 
 bool Thread::HasTlab() const {
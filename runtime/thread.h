@@ -945,6 +945,21 @@ class Thread {
     tls64_.trace_clock_base = clock_base;
   }
 
+  // Subtract the `bytes` of the allocation of `obj`, and the bytes the allocation fast paths took
+  // from the TLAB since the previous call, from the bytes this thread can allocate before its next
+  // allocation sample. Return true, leaving the count unchanged, if they reach the sample point.
+  ALWAYS_INLINE bool CountDownAllocSample(mirror::Object* obj, size_t bytes);
+
+  // Zero until the allocation sampler drew the first sample interval of the thread.
+  size_t GetAllocSampleBytesRemaining() const {
+    return alloc_sample_bytes_remaining_;
+  }
+
+  // Count `bytes` down from the current TLAB position, and make the TLAB allocation fast paths
+  // stop at the sample point so that the allocation reaching it takes the slow path. Zero lets
+  // the fast paths use the whole TLAB again.
+  void SetAllocSampleBytesRemaining(size_t bytes);
+
   BaseMutex* GetHeldMutex(LockLevel level) const {
     return tlsPtr_.held_mutexes[level];
   }
@@ -981,6 +996,9 @@ class Thread {
 
   // Returns the remaining space in the TLAB.
   size_t TlabSize() const;
+  // Returns the remaining space in the TLAB that the allocation fast paths may use, which is less
+  // than TlabSize() when the next allocation sample point is within the TLAB.
+  size_t TlabFastPathSize() const;
   // Doesn't check that there is room.
   mirror::Object* AllocTlab(size_t bytes);
   void SetTlab(uint8_t* start, uint8_t* end);
@@ -1019,7 +1037,7 @@ class Thread {
   void RevokeThreadLocalAllocationStack();
 
   size_t GetThreadLocalBytesAllocated() const {
-    return tlsPtr_.thread_local_end - tlsPtr_.thread_local_start;
+    return tlab_end_ - tlsPtr_.thread_local_start;
   }
 
   size_t GetThreadLocalObjectsAllocated() const {
@@ -1474,6 +1492,7 @@ class Thread {
     // thread_local_pos and thread_local_end must be consecutive for ldrd and are 8 byte aligned for
     // potentially better performance.
     uint8_t* thread_local_pos;
+    // The end of the TLAB for the allocation fast paths, see tlab_end_.
     uint8_t* thread_local_end;
 
     // Mterp jump table bases.
@@ -1515,6 +1534,15 @@ class Thread {
   // Thread "interrupted" status; stays raised until queried or thrown.
   bool interrupted_ GUARDED_BY(wait_mutex_);
 
+  // The end of the TLAB. tlsPtr_.thread_local_end is lowered to the next allocation sample point
+  // when it is within the TLAB.
+  uint8_t* tlab_end_ = nullptr;
+
+  // Bytes left to allocate before the next allocation sample, see gc::AllocationSampler, counted
+  // from the TLAB position alloc_sample_tlab_mark_.
+  size_t alloc_sample_bytes_remaining_ = 0;
+  uint8_t* alloc_sample_tlab_mark_ = nullptr;
+
   // Debug disable read barrier count, only is checked for debug builds and only in the runtime.
   uint8_t debug_disallow_read_barrier_ = 0;
 
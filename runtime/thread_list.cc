@@ -25,6 +25,7 @@
 
 #include <sstream>
 
+#include "barrier.h"
 #include "base/histogram-inl.h"
 #include "base/mutex-inl.h"
 #include "base/systrace.h"
@@ -32,6 +33,8 @@
 #include "base/timing_logger.h"
 #include "debugger.h"
 #include "gc/collector/concurrent_copying.h"
+#include "gc/gc_stats.h"
+#include "gc/heap.h"
 #include "jni_internal.h"
 #include "lock_word.h"
 #include "monitor.h"
@@ -362,6 +365,32 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function) {
   return count;
 }
 
+// Runs no code on the threads, passing the checkpoint is enough.
+class EmptyCheckpoint : public Closure {
+ public:
+  explicit EmptyCheckpoint(Barrier* barrier) : barrier_(barrier) {
+  }
+  virtual void Run(Thread* thread ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    // If thread is a running mutator, then act on behalf of the waiting thread.
+    // See the code in ThreadList::RunCheckpoint.
+    barrier_->Pass(Thread::Current());
+  }
+
+ private:
+  Barrier* const barrier_;
+};
+
+void ThreadList::RunEmptyCheckpoint() {
+  Thread* self = Thread::Current();
+  Barrier barrier(0);
+  EmptyCheckpoint closure(&barrier);
+  ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
+  size_t barrier_count = RunCheckpoint(&closure);
+  if (barrier_count != 0) {
+    barrier.Increment(self, barrier_count);
+  }
+}
+
 // Request that a checkpoint function be run on all active (non-suspended)
 // threads.  Returns the number of successful requests.
 size_t ThreadList::RunCheckpointOnRunnableThreads(Closure* checkpoint_function) {
@@ -501,6 +530,10 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     const uint64_t end_time = NanoTime();
     const uint64_t suspend_time = end_time - start_time;
     suspend_all_historam_.AdjustAndAddValue(suspend_time);
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    if (heap != nullptr) {
+      heap->GetGcStats()->RecordTimeToSafepoint(suspend_time);
+    }
     if (suspend_time > kLongThreadSuspendThreshold) {
       LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time);
     }
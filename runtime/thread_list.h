@@ -101,6 +101,12 @@ class ThreadList {
   size_t RunCheckpointOnRunnableThreads(Closure* checkpoint_function)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Run a checkpoint which does nothing on all threads, and wait until every thread has passed
+  // it. Used to retire data which threads only access while runnable and without suspending.
+  // The calling thread is suspended while waiting.
+  void RunEmptyCheckpoint()
+      REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
+
   // Flip thread roots from from-space refs to to-space refs. Used by
   // the concurrent copying collector.
   size_t FlipThreadRoots(Closure* thread_flip_visitor,
@@ -17,7 +17,7 @@
 #ifndef ART_RUNTIME_THREAD_POOL_H_
 #define ART_RUNTIME_THREAD_POOL_H_
 
-#include <deque>
+#include <set>
 #include <vector>
 
 #include "barrier.h"
@@ -38,6 +38,10 @@ class Task : public Closure {
  public:
   // Called after Closure::Run has been called.
   virtual void Finalize() { }
+
+  // Tasks with a higher priority are run first. Tasks of equal priority are run in the order
+  // they were added. The priority of a task must not change while it is in a thread pool.
+  virtual int32_t GetPriority() const { return 0; }
 };
 
 class SelfDeletingTask : public Task {
@@ -90,8 +94,9 @@ class ThreadPool {
   // Do not allow workers to grab any new tasks.
   void StopWorkers(Thread* self) REQUIRES(!task_queue_lock_);
 
-  // Add a new task, the first available started worker will process it. Does not delete the task
-  // after running it, it is the caller's responsibility.
+  // Add a new task, the first available started worker will process it, unless tasks with a
+  // higher priority are pending. Does not delete the task after running it, it is the caller's
+  // responsibility.
   void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
 
   // Remove all tasks in the queue.
@@ -138,7 +143,14 @@ class ThreadPool {
   volatile bool shutting_down_ GUARDED_BY(task_queue_lock_);
   // How many worker threads are waiting on the condition.
   volatile size_t waiting_count_ GUARDED_BY(task_queue_lock_);
-  std::deque<Task*> tasks_ GUARDED_BY(task_queue_lock_);
+  // Pending tasks, by decreasing priority. The multiset keeps equal elements in insertion order.
+  class CompareByPriority {
+   public:
+    bool operator()(const Task* a, const Task* b) const {
+      return a->GetPriority() > b->GetPriority();
+    }
+  };
+  std::multiset<Task*, CompareByPriority> tasks_ GUARDED_BY(task_queue_lock_);
   // TODO: make this immutable/const?
   std::vector<ThreadPoolWorker*> threads_;
   // Work balance detection.
@@ -17,6 +17,7 @@
 #include "thread_pool.h"
 
 #include <string>
+#include <vector>
 
 #include "atomic.h"
 #include "common_runtime_test.h"
@@ -136,4 +137,44 @@ TEST_F(ThreadPoolTest, RecursiveTest) {
   EXPECT_EQ((1 << depth) - 1, count.LoadSequentiallyConsistent());
 }
 
+class PriorityTask : public Task {
+ public:
+  PriorityTask(std::vector<int32_t>* order, int32_t priority, int32_t id)
+      : order_(order), priority_(priority), id_(id) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE {
+    order_->push_back(id_);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+  int32_t GetPriority() const OVERRIDE {
+    return priority_;
+  }
+
+ private:
+  std::vector<int32_t>* const order_;
+  const int32_t priority_;
+  const int32_t id_;
+};
+
+// Test that tasks run by decreasing priority, and in insertion order for equal priorities.
+TEST_F(ThreadPoolTest, PriorityOrder) {
+  Thread* self = Thread::Current();
+  // A single worker runs the tasks one at a time, in queue order.
+  ThreadPool thread_pool("Thread pool test thread pool", 1);
+  std::vector<int32_t> order;
+  thread_pool.AddTask(self, new PriorityTask(&order, 0, 0));
+  thread_pool.AddTask(self, new PriorityTask(&order, 5, 1));
+  thread_pool.AddTask(self, new PriorityTask(&order, 0, 2));
+  thread_pool.AddTask(self, new PriorityTask(&order, 10, 3));
+  thread_pool.AddTask(self, new PriorityTask(&order, 5, 4));
+  EXPECT_EQ(5u, thread_pool.GetTaskCount(self));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, false, false);
+  EXPECT_EQ(std::vector<int32_t>({3, 1, 4, 0, 2}), order);
+}
+
 }  // namespace art
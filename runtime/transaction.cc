@@ -186,7 +186,6 @@ void Transaction::RecordWeakStringRemoval(mirror::String* s) {
 }
 
 void Transaction::LogInternedString(const InternStringLog& log) {
-  Locks::intern_table_lock_->AssertExclusiveHeld(Thread::Current());
   MutexLock mu(Thread::Current(), log_lock_);
   intern_string_logs_.push_front(log);
 }
@@ -196,10 +195,16 @@ void Transaction::Rollback() {
   Thread* self = Thread::Current();
   self->AssertNoPendingException();
   MutexLock mu1(self, *Locks::intern_table_lock_);
-  MutexLock mu2(self, log_lock_);
-  UndoObjectModifications();
-  UndoArrayModifications();
-  UndoInternStringTableModifications();
+  std::list<InternStringLog> intern_string_logs;
+  {
+    MutexLock mu2(self, log_lock_);
+    UndoObjectModifications();
+    UndoArrayModifications();
+    intern_string_logs.swap(intern_string_logs_);
+  }
+  // The intern table shard locks are acquired before the log lock, so the intern table is restored
+  // without holding it.
+  UndoInternStringTableModifications(&intern_string_logs);
 }
 
 void Transaction::UndoObjectModifications() {
@@ -220,14 +225,15 @@ void Transaction::UndoArrayModifications() {
   array_logs_.clear();
 }
 
-void Transaction::UndoInternStringTableModifications() {
+void Transaction::UndoInternStringTableModifications(
+    std::list<InternStringLog>* intern_string_logs) {
   InternTable* const intern_table = Runtime::Current()->GetInternTable();
   // We want to undo each operation from the most recent to the oldest. List has been filled so the
   // most recent operation is at list begin so just have to iterate over it.
-  for (InternStringLog& string_log : intern_string_logs_) {
+  for (InternStringLog& string_log : *intern_string_logs) {
     string_log.Undo(intern_table);
   }
-  intern_string_logs_.clear();
+  intern_string_logs->clear();
 }
 
 void Transaction::VisitRoots(RootVisitor* visitor) {
@@ -83,16 +83,12 @@ class Transaction FINAL {
 
   // Record intern string table changes.
   void RecordStrongStringInsertion(mirror::String* s)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordWeakStringInsertion(mirror::String* s)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordStrongStringRemoval(mirror::String* s)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordWeakStringRemoval(mirror::String* s)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
 
   // Abort transaction by undoing all recorded changes.
@@ -193,7 +189,6 @@ class Transaction FINAL {
   };
 
   void LogInternedString(const InternStringLog& log)
-      REQUIRES(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
 
   void UndoObjectModifications()
@@ -202,9 +197,9 @@ class Transaction FINAL {
   void UndoArrayModifications()
       REQUIRES(log_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
-  void UndoInternStringTableModifications()
+  void UndoInternStringTableModifications(std::list<InternStringLog>* intern_string_logs)
       REQUIRES(Locks::intern_table_lock_)
-      REQUIRES(log_lock_)
+      REQUIRES(!log_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   void VisitObjectLogs(RootVisitor* visitor)
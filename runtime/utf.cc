@@ -117,12 +117,46 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
   }
 }
 
-void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
-                                const uint16_t* utf16_in, size_t char_count) {
+bool IsModifiedUtf8Latin1(const char* utf8_data_in, size_t in_bytes) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(utf8_data_in);
+  const uint8_t* const end = p + in_bytes;
+  while (p < end) {
+    const uint8_t ic = *p;
+    if (LIKELY((ic & 0x80) == 0)) {
+      ++p;
+    } else if ((ic & 0xe0) == 0xc0 && (ic & 0x1f) <= 0x03) {
+      // Two-byte encoding of a char below 0x100.
+      p += 2;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ConvertModifiedUtf8ToLatin1(uint8_t* latin1_data_out, size_t out_chars,
+                                 const char* utf8_data_in, size_t in_bytes) {
+  if (LIKELY(out_chars == in_bytes)) {
+    // Common case where all characters are ASCII.
+    memcpy(latin1_data_out, utf8_data_in, in_bytes);
+    return;
+  }
+
+  // String contains non-ASCII characters, all of them below 0x100.
+  const char* const in_end = utf8_data_in + in_bytes;
+  for (const char* p = utf8_data_in; p < in_end;) {
+    const uint32_t ch = GetUtf16FromUtf8(&p);
+    *latin1_data_out++ = dchecked_integral_cast<uint8_t>(ch);
+  }
+}
+
+template <typename CharType>
+static void ConvertToModifiedUtf8(char* utf8_out, size_t byte_count,
+                                  const CharType* utf16_in, size_t char_count) {
   if (LIKELY(byte_count == char_count)) {
     // Common case where all characters are ASCII.
-    const uint16_t *utf16_end = utf16_in + char_count;
-    for (const uint16_t *p = utf16_in; p < utf16_end;) {
+    const CharType *utf16_end = utf16_in + char_count;
+    for (const CharType *p = utf16_in; p < utf16_end;) {
       *utf8_out++ = dchecked_integral_cast<char>(*p++);
     }
     return;
@@ -170,7 +204,18 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
   }
 }
 
-int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count) {
+void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
+                                const uint16_t* utf16_in, size_t char_count) {
+  ConvertToModifiedUtf8(utf8_out, byte_count, utf16_in, char_count);
+}
+
+void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
+                                const uint8_t* latin1_in, size_t char_count) {
+  ConvertToModifiedUtf8(utf8_out, byte_count, latin1_in, char_count);
+}
+
+template <typename CharType>
+static int32_t ComputeHash(const CharType* chars, size_t char_count) {
   uint32_t hash = 0;
   while (char_count--) {
     hash = hash * 31 + *chars++;
@@ -178,6 +223,14 @@ int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count) {
   return static_cast<int32_t>(hash);
 }
 
+int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count) {
+  return ComputeHash(chars, char_count);
+}
+
+int32_t ComputeUtf16Hash(const uint8_t* chars, size_t char_count) {
+  return ComputeHash(chars, char_count);
+}
+
 int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length) {
   uint32_t hash = 0;
   while (utf16_length != 0u) {
@@ -203,7 +256,8 @@ uint32_t ComputeModifiedUtf8Hash(const char* chars) {
   return static_cast<int32_t>(hash);
 }
 
-int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint16_t* utf16,
+template <typename CharType>
+static int CompareModifiedUtf8AsCodePointValues(const char* utf8, const CharType* utf16,
                                                 size_t utf16_length) {
   for (;;) {
     if (*utf8 == '\0') {
@@ -239,6 +293,16 @@ int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint16_t
   }
 }
 
+int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint16_t* utf16,
+                                                size_t utf16_length) {
+  return CompareModifiedUtf8AsCodePointValues(utf8, utf16, utf16_length);
+}
+
+int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint8_t* latin1,
+                                                size_t utf16_length) {
+  return CompareModifiedUtf8AsCodePointValues(utf8, latin1, utf16_length);
+}
+
 size_t CountUtf8Bytes(const uint16_t* chars, size_t char_count) {
   size_t result = 0;
   const uint16_t *end = chars + char_count;
@@ -270,4 +334,13 @@ size_t CountUtf8Bytes(const uint16_t* chars, size_t char_count) {
   return result;
 }
 
+size_t CountUtf8Bytes(const uint8_t* chars, size_t char_count) {
+  size_t result = 0;
+  for (const uint8_t* end = chars + char_count; chars < end; ++chars) {
+    // Chars below 0x80 except the null char take one byte, the others two.
+    result += (*chars != 0 && *chars < 0x80) ? 1u : 2u;
+  }
+  return result;
+}
+
 }  // namespace art
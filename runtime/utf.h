@@ -44,9 +44,11 @@ size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count);
 
 /*
  * Returns the number of modified UTF-8 bytes needed to represent the given
- * UTF-16 string.
+ * UTF-16 string. The functions which take `const uint8_t*` chars do the same
+ * for Latin-1 chars, i.e. UTF-16 chars below 0x100, as in compressed strings.
  */
 size_t CountUtf8Bytes(const uint16_t* chars, size_t char_count);
+size_t CountUtf8Bytes(const uint8_t* chars, size_t char_count);
 
 /*
  * Convert from Modified UTF-8 to UTF-16.
@@ -55,6 +57,18 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_out, const char* utf8_in);
 void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_out, size_t out_chars,
                                 const char* utf8_in, size_t in_bytes);
 
+/*
+ * Returns true if every UTF-16 char of the given modified UTF-8 string is below 0x100,
+ * i.e. if the string can be converted to Latin-1 with ConvertModifiedUtf8ToLatin1.
+ */
+bool IsModifiedUtf8Latin1(const char* utf8_in, size_t in_bytes);
+
+/*
+ * Convert from Modified UTF-8 to Latin-1.
+ */
+void ConvertModifiedUtf8ToLatin1(uint8_t* latin1_out, size_t out_chars,
+                                 const char* utf8_in, size_t in_bytes);
+
 /*
  * Compare two modified UTF-8 strings as UTF-16 code point values in a non-locale sensitive manner
  */
@@ -67,6 +81,8 @@ ALWAYS_INLINE int CompareModifiedUtf8ToModifiedUtf8AsUtf16CodePointValues(const
  */
 int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint16_t* utf16,
                                                 size_t utf16_length);
+int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint8_t* latin1,
+                                                size_t utf16_length);
 
 /*
  * Convert from UTF-16 to Modified UTF-8. Note that the output is _not_
@@ -76,6 +92,8 @@ int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint16_t
  */
 void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
                                 const uint16_t* utf16_in, size_t char_count);
+void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
+                                const uint8_t* latin1_in, size_t char_count);
 
 /*
  * The java.lang.String hashCode() algorithm.
@@ -83,6 +101,7 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
 int32_t ComputeUtf16Hash(mirror::CharArray* chars, int32_t offset, size_t char_count)
     SHARED_REQUIRES(Locks::mutator_lock_);
 int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count);
+int32_t ComputeUtf16Hash(const uint8_t* chars, size_t char_count);
 int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length);
 
 // Compute a hash code of a modified UTF-8 string. Not the standard java hash since it returns a
@@ -378,4 +378,31 @@ TEST_F(UtfTest, ExhaustiveBidirectionalCodePointCheck) {
   }
 }
 
+TEST_F(UtfTest, Latin1) {
+  // "a\u00e9\u0000b" in modified UTF-8, with the NUL encoded as two bytes.
+  const char utf8[] = "a\xc3\xa9\xc0\x80" "b";
+  const size_t utf8_bytes = sizeof(utf8) - 1u;
+  EXPECT_TRUE(IsModifiedUtf8Latin1(utf8, utf8_bytes));
+  EXPECT_FALSE(IsModifiedUtf8Latin1("a\xc4\x80", 3u));        // U+0100.
+  EXPECT_FALSE(IsModifiedUtf8Latin1("\xe2\x82\xac", 3u));    // U+20AC.
+
+  const uint8_t expected[] = { 'a', 0xe9, 0x00, 'b' };
+  uint8_t latin1[4] = { 0xff, 0xff, 0xff, 0xff };
+  ConvertModifiedUtf8ToLatin1(latin1, 4u, utf8, utf8_bytes);
+  for (size_t i = 0; i < 4u; ++i) {
+    EXPECT_EQ(expected[i], latin1[i]) << i;
+  }
+
+  // The Latin-1 overloads must agree with the UTF-16 ones.
+  const uint16_t utf16[] = { 'a', 0xe9, 0x00, 'b' };
+  EXPECT_EQ(CountUtf8Bytes(utf16, 4u), CountUtf8Bytes(latin1, 4u));
+  EXPECT_EQ(ComputeUtf16Hash(utf16, 4u), ComputeUtf16Hash(latin1, 4u));
+  char out[utf8_bytes];
+  ConvertUtf16ToModifiedUtf8(out, utf8_bytes, latin1, 4u);
+  EXPECT_EQ(0, memcmp(utf8, out, utf8_bytes));
+  EXPECT_EQ(0, CompareModifiedUtf8ToUtf16AsCodePointValues("a\xc3\xa9", latin1, 2u));
+  EXPECT_GT(0, CompareModifiedUtf8ToUtf16AsCodePointValues("a", latin1, 2u));
+  EXPECT_LT(0, CompareModifiedUtf8ToUtf16AsCodePointValues("a\xc3\xaa", latin1, 2u));
+}
+
 }  // namespace art
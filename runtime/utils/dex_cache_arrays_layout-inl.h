@@ -23,6 +23,7 @@
 #include "base/logging.h"
 #include "gc_root.h"
 #include "globals.h"
+#include "mirror/dex_cache.h"
 #include "primitive.h"
 
 namespace art {
@@ -50,23 +51,32 @@ inline size_t DexCacheArraysLayout::Alignment() const {
   // GcRoot<> alignment is 4, i.e. lower than or equal to the pointer alignment.
   static_assert(alignof(GcRoot<mirror::Class>) == 4, "Expecting alignof(GcRoot<>) == 4");
   static_assert(alignof(GcRoot<mirror::String>) == 4, "Expecting alignof(GcRoot<>) == 4");
+  // The (index, string) pairs of the hashed strings cache are 8-byte aligned.
+  static_assert(alignof(mirror::StringDexCacheType) == (kUseHashedDexCache ? 8u : 4u),
+                "Unexpected alignof(StringDexCacheType)");
+  // So are the (index, class) pairs of the hashed resolved types cache.
+  static_assert(alignof(mirror::TypeDexCacheType) == (kUseHashedDexCache ? 8u : 4u),
+                "Unexpected alignof(TypeDexCacheType)");
   DCHECK(pointer_size_ == 4u || pointer_size_ == 8u);
   // Pointer alignment is the same as pointer size.
-  return pointer_size_;
+  return std::max({pointer_size_, StringsAlignment(), TypesAlignment()});
 }
 
 inline size_t DexCacheArraysLayout::TypeOffset(uint32_t type_idx) const {
-  return types_offset_ + ElementOffset(sizeof(GcRoot<mirror::Class>), type_idx);
+  return types_offset_ + ElementOffset(sizeof(mirror::TypeDexCacheType),
+                                       mirror::DexCache::TypeSlotIndex(type_idx));
 }
 
 inline size_t DexCacheArraysLayout::TypesSize(size_t num_elements) const {
   // App image patching relies on having enough room for a forwarding pointer in the types array.
   // See FixupArtMethodArrayVisitor and ClassLinker::AddImageSpace.
-  return std::max(ArraySize(sizeof(GcRoot<mirror::Class>), num_elements), pointer_size_);
+  return std::max(ArraySize(sizeof(mirror::TypeDexCacheType),
+                            mirror::DexCache::NumTypeSlots(num_elements)),
+                  pointer_size_);
 }
 
 inline size_t DexCacheArraysLayout::TypesAlignment() const {
-  return alignof(GcRoot<mirror::Class>);
+  return alignof(mirror::TypeDexCacheType);
 }
 
 inline size_t DexCacheArraysLayout::MethodOffset(uint32_t method_idx) const {
@@ -83,15 +93,17 @@ inline size_t DexCacheArraysLayout::MethodsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::StringOffset(uint32_t string_idx) const {
-  return strings_offset_ + ElementOffset(sizeof(GcRoot<mirror::String>), string_idx);
+  return strings_offset_ + ElementOffset(sizeof(mirror::StringDexCacheType),
+                                         mirror::DexCache::StringSlotIndex(string_idx));
 }
 
 inline size_t DexCacheArraysLayout::StringsSize(size_t num_elements) const {
-  return ArraySize(sizeof(GcRoot<mirror::String>), num_elements);
+  return ArraySize(sizeof(mirror::StringDexCacheType),
+                   mirror::DexCache::NumStringSlots(num_elements));
 }
 
 inline size_t DexCacheArraysLayout::StringsAlignment() const {
-  return alignof(GcRoot<mirror::String>);
+  return alignof(mirror::StringDexCacheType);
 }
 
 inline size_t DexCacheArraysLayout::FieldOffset(uint32_t field_idx) const {
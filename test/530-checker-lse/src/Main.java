@@ -78,7 +78,7 @@ public class Main {
   /// CHECK: InstanceFieldGet
 
   /// CHECK-START: double Main.calcCircleArea(double) load_store_elimination (after)
-  /// CHECK: NewInstance
+  /// CHECK-NOT: NewInstance
   /// CHECK-NOT: InstanceFieldSet
   /// CHECK-NOT: InstanceFieldGet
 
@@ -137,7 +137,7 @@ public class Main {
   /// CHECK: InstanceFieldGet
 
   /// CHECK-START: int Main.test3(TestClass) load_store_elimination (after)
-  /// CHECK: NewInstance
+  /// CHECK-NOT: NewInstance
   /// CHECK: StaticFieldGet
   /// CHECK: NewInstance
   /// CHECK: InstanceFieldSet
@@ -256,7 +256,7 @@ public class Main {
   /// CHECK: InstanceFieldGet
 
   /// CHECK-START: int Main.test8() load_store_elimination (after)
-  /// CHECK: NewInstance
+  /// CHECK-NOT: NewInstance
   /// CHECK-NOT: InstanceFieldSet
   /// CHECK: InvokeVirtual
   /// CHECK-NOT: NullCheck
@@ -414,7 +414,7 @@ public class Main {
   /// CHECK: InstanceFieldGet
 
   /// CHECK-START: int Main.test16() load_store_elimination (after)
-  /// CHECK: NewInstance
+  /// CHECK-NOT: NewInstance
   /// CHECK-NOT: InstanceFieldSet
   /// CHECK-NOT: InstanceFieldGet
 
@@ -431,7 +431,7 @@ public class Main {
 
   /// CHECK-START: int Main.test17() load_store_elimination (after)
   /// CHECK: <<Const0:i\d+>> IntConstant 0
-  /// CHECK: NewInstance
+  /// CHECK-NOT: NewInstance
   /// CHECK-NOT: InstanceFieldSet
   /// CHECK-NOT: InstanceFieldGet
   /// CHECK: Return [<<Const0>>]
@@ -527,15 +527,9 @@ public class Main {
   /// CHECK: InstanceFieldGet
 
   /// CHECK-START: int Main.test22() load_store_elimination (after)
-  /// CHECK: NewInstance
-  /// CHECK-NOT: InstanceFieldSet
-  /// CHECK: NewInstance
+  /// CHECK-NOT: NewInstance
   /// CHECK-NOT: InstanceFieldSet
   /// CHECK-NOT: InstanceFieldGet
-  /// CHECK: NewInstance
-  /// CHECK-NOT: InstanceFieldSet
-  /// CHECK-NOT: InstanceFieldGet
-  /// CHECK-NOT: InstanceFieldGet
 
   // For a singleton, loop side effects can kill its field values only if:
   // (1) it dominiates the loop header, and
@@ -566,27 +560,118 @@ public class Main {
   /// CHECK: InstanceFieldSet
 
   /// CHECK-START: int Main.test23(boolean) load_store_elimination (after)
-  /// CHECK: NewInstance
+  /// CHECK-NOT: NewInstance
   /// CHECK-NOT: InstanceFieldSet
   /// CHECK-NOT: InstanceFieldGet
-  /// CHECK: InstanceFieldSet
-  /// CHECK: InstanceFieldGet
-  /// CHECK: Return
-  /// CHECK-NOT: InstanceFieldGet
-  /// CHECK: InstanceFieldSet
+
+  /// CHECK-START: int Main.test23(boolean) load_store_elimination (after)
+  /// CHECK-DAG:     <<Phi:i\d+>>     Phi
+  /// CHECK-DAG:                       Return [<<Phi>>]
 
   // Test store elimination on merging.
   static int test23(boolean b) {
     TestClass obj = new TestClass();
     obj.i = 3;      // This store can be eliminated since the value flows into each branch.
     if (b) {
-      obj.i += 1;   // This store cannot be eliminated due to the merge later.
+      obj.i += 1;   // This store can be eliminated since the merged value is a phi.
+    } else {
+      obj.i += 2;   // This store can be eliminated since the merged value is a phi.
+    }
+    return obj.i;
+  }
+
+  /// CHECK-START: int Main.test25(boolean) load_store_elimination (before)
+  /// CHECK: NewInstance
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldGet
+
+  /// CHECK-START: int Main.test25(boolean) load_store_elimination (after)
+  /// CHECK-DAG:     <<Const0:i\d+>>  IntConstant 0
+  /// CHECK-DAG:     <<Const5:i\d+>>  IntConstant 5
+  /// CHECK-DAG:     <<Phi:i\d+>>     Phi [{{i\d+}},{{i\d+}}]
+  /// CHECK-DAG:                       Return [<<Phi>>]
+
+  /// CHECK-START: int Main.test25(boolean) load_store_elimination (after)
+  /// CHECK-NOT: NewInstance
+  /// CHECK-NOT: InstanceFieldSet
+  /// CHECK-NOT: InstanceFieldGet
+
+  // Test merging a stored value with the default value.
+  static int test25(boolean b) {
+    TestClass obj = new TestClass();
+    if (b) {
+      obj.i = 5;
     } else {
-      obj.i += 2;   // This store cannot be eliminated due to the merge later.
+      obj.j = 6;
     }
     return obj.i;
   }
 
+  /// CHECK-START: int Main.test26(boolean) load_store_elimination (before)
+  /// CHECK: NewInstance
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldGet
+
+  /// CHECK-START: int Main.test26(boolean) load_store_elimination (after)
+  /// CHECK: NewInstance
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldSet
+  /// CHECK-NOT: Phi
+  /// CHECK: InstanceFieldGet
+
+  // Reference values are not merged with phis, so the stores have to stay.
+  static int test26(boolean b) {
+    TestClass obj = new TestClass();
+    if (b) {
+      obj.next = new TestClass(1, 2);
+    } else {
+      obj.next = TestClass.sTestClassObj;
+    }
+    return obj.next.i;
+  }
+
+  /// CHECK-START: int Main.test27() load_store_elimination (before)
+  /// CHECK: NewArray
+  /// CHECK: ArraySet
+  /// CHECK: ArraySet
+  /// CHECK: ArrayGet
+  /// CHECK: ArrayGet
+
+  /// CHECK-START: int Main.test27() load_store_elimination (after)
+  /// CHECK-NOT: NewArray
+  /// CHECK-NOT: ArraySet
+  /// CHECK-NOT: ArrayGet
+
+  // Array elements accessed with constant indices are replaced by their values.
+  static int test27() {
+    int[] array = new int[2];
+    array[0] = 1;
+    array[1] = 2;
+    return array[0] + array[1];
+  }
+
+  /// CHECK-START: int Main.test28(int) load_store_elimination (before)
+  /// CHECK: NewArray
+  /// CHECK: ArraySet
+  /// CHECK: ArraySet
+  /// CHECK: ArrayGet
+
+  /// CHECK-START: int Main.test28(int) load_store_elimination (after)
+  /// CHECK: NewArray
+  /// CHECK: ArraySet
+  /// CHECK: ArraySet
+  /// CHECK: ArrayGet
+
+  // Stores into an array accessed with a non-constant index have to stay.
+  static int test28(int i) {
+    int[] array = new int[2];
+    array[0] = 1;
+    array[1] = 2;
+    return array[i];
+  }
+
   /// CHECK-START: float Main.test24() load_store_elimination (before)
   /// CHECK-DAG:     <<True:i\d+>>     IntConstant 1
   /// CHECK-DAG:     <<Float8:f\d+>>   FloatConstant 8
@@ -686,6 +771,37 @@ public class Main {
     return obj2.i;
   }
 
+  public static Error $noinline$makeError(TestClass2 obj) {
+    return new Error("i=" + obj.i + ", j=" + obj.j);
+  }
+
+  /// CHECK-START: int Main.$noinline$testSinkToThrow(int) load_store_elimination (before)
+  /// CHECK: NewInstance
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldSet
+  /// CHECK: If
+  /// CHECK: InvokeStaticOrDirect
+  /// CHECK: Throw
+
+  /// CHECK-START: int Main.$noinline$testSinkToThrow(int) load_store_elimination (after)
+  /// CHECK: If
+  /// CHECK: NewInstance
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InstanceFieldSet
+  /// CHECK: InvokeStaticOrDirect
+  /// CHECK: Throw
+
+  // Test that an allocation escaping only on a throwing path is only done on that path.
+  public static int $noinline$testSinkToThrow(int i) {
+    TestClass2 obj = new TestClass2();
+    obj.i = i;
+    obj.j = i + 1;
+    if (i < 0) {
+      throw $noinline$makeError(obj);
+    }
+    return i * 2;
+  }
+
   public static void assertIntEquals(int result, int expected) {
     if (expected != result) {
       throw new Error("Expected: " + expected + ", found: " + result);
@@ -744,8 +860,22 @@ public class Main {
     assertIntEquals(test23(true), 4);
     assertIntEquals(test23(false), 5);
     assertFloatEquals(test24(), 8.0f);
+    assertIntEquals(test25(true), 5);
+    assertIntEquals(test25(false), 0);
+    assertIntEquals(test26(true), 1);
+    assertIntEquals(test26(false), -1);
+    assertIntEquals(test27(), 3);
+    assertIntEquals(test28(0), 1);
+    assertIntEquals(test28(1), 2);
     testFinalizableByForcingGc();
     assertIntEquals($noinline$testHSelect(true), 0xdead);
+    assertIntEquals($noinline$testSinkToThrow(3), 6);
+    try {
+      $noinline$testSinkToThrow(-2);
+      throw new AssertionError("Expected an Error");
+    } catch (Error e) {
+      assertIntEquals(e.getMessage().equals("i=-2, j=-1") ? 1 : 0, 1);
+    }
   }
 
   static boolean sFlag;
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+interface Service {
+  int get();
+}
+
+class ServiceImpl implements Service {
+  public int get() {
+    return 42;
+  }
+}
+
+// Only loaded, through reflection, once `$noinline$callService` has been compiled.
+class OtherServiceImpl implements Service {
+  public int get() {
+    return 43;
+  }
+}
+
+abstract class Base {
+  abstract int value();
+}
+
+class Derived extends Base {
+  int value() {
+    return 2;
+  }
+}
+
+// Only loaded, through reflection, once `$noinline$callValue` has been compiled.
+class MoreDerived extends Derived {
+  int value() {
+    return 3;
+  }
+}
+
+public class Main {
+  static boolean doThrow = false;
+  static Service sService = new ServiceImpl();
+  static Base sBase = new Derived();
+
+  /// CHECK-START: int Main.$noinline$callService(boolean) inliner (before)
+  /// CHECK:     InvokeInterface
+
+  /// CHECK-START: int Main.$noinline$callService(boolean) inliner (after)
+  /// CHECK:     ClassTableGet
+  /// CHECK:     NotEqual
+  /// CHECK:     If
+  /// CHECK:     InvokeInterface
+
+  /// CHECK-START: int Main.$noinline$callService(boolean) inliner (after)
+  /// CHECK-NOT: Deoptimize
+
+  // The call is devirtualized to ServiceImpl.get() and guarded. As a subclass of
+  // ServiceImpl may have an IMT conflict for get(), a failing guard keeps the
+  // interface call rather than deoptimizing. With `loadOther`, the compiled code
+  // loads a second implementation and then calls it.
+  public static int $noinline$callService(boolean loadOther) throws Exception {
+    if (doThrow) { throw new Error(); }
+    Service service = loadOther ? (Service) $noinline$newInstance("OtherServiceImpl") : sService;
+    return service.get();
+  }
+
+  /// CHECK-START: int Main.$noinline$callValue(boolean) inliner (before)
+  /// CHECK:     InvokeVirtual
+
+  /// CHECK-START: int Main.$noinline$callValue(boolean) inliner (after)
+  /// CHECK-NOT: InvokeVirtual
+  /// CHECK:     ClassTableGet
+  /// CHECK:     NotEqual
+  /// CHECK:     Deoptimize
+  /// CHECK-NOT: InvokeVirtual
+
+  // The call is devirtualized to Derived.value() and guarded. With `loadOther`,
+  // the compiled code loads an overriding method and then calls it.
+  public static int $noinline$callValue(boolean loadOther) throws Exception {
+    if (doThrow) { throw new Error(); }
+    Base base = loadOther ? (Base) $noinline$newInstance("MoreDerived") : sBase;
+    return base.value();
+  }
+
+  // Use reflection, so that verifying Main does not load the class.
+  public static Object $noinline$newInstance(String className) throws Exception {
+    if (doThrow) { throw new Error(); }
+    return Class.forName(className).newInstance();
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+
+    // Loop enough to get the call sites JITed.
+    for (int i = 0; i < 100000; i++) {
+      assertEquals(42, $noinline$callService(false));
+      assertEquals(2, $noinline$callValue(false));
+    }
+    ensureJitCompiled(Main.class, "$noinline$callService");
+    ensureJitCompiled(Main.class, "$noinline$callValue");
+    assertTrue(hasSingleImplementation(Service.class, "get"));
+    assertTrue(hasSingleImplementation(Base.class, "value"));
+    assertTrue(hasJitCompiledEntrypoint(Main.class, "$noinline$callService"));
+    assertTrue(hasJitCompiledEntrypoint(Main.class, "$noinline$callValue"));
+
+    // Loading the new implementations from the compiled code invalidates it. The
+    // frames still running it must dispatch to the new implementations.
+    assertEquals(43, $noinline$callService(true));
+    assertFalse(hasSingleImplementation(Service.class, "get"));
+    assertFalse(hasJitCompiledEntrypoint(Main.class, "$noinline$callService"));
+    assertTrue(hasJitCompiledEntrypoint(Main.class, "$noinline$callValue"));
+
+    assertEquals(3, $noinline$callValue(true));
+    assertFalse(hasSingleImplementation(Base.class, "value"));
+    assertFalse(hasJitCompiledEntrypoint(Main.class, "$noinline$callValue"));
+
+    assertEquals(42, $noinline$callService(false));
+    assertEquals(2, $noinline$callValue(false));
+    assertEquals(43, $noinline$callService(true));
+    assertEquals(3, $noinline$callValue(true));
+
+    System.out.println("Done");
+  }
+
+  public static void assertEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  public static void assertTrue(boolean value) {
+    if (!value) {
+      throw new Error("Expected true");
+    }
+  }
+
+  public static void assertFalse(boolean value) {
+    if (value) {
+      throw new Error("Expected false");
+    }
+  }
+
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+  private static native boolean hasJitCompiledEntrypoint(Class<?> cls, String methodName);
+  private static native boolean hasSingleImplementation(Class<?> cls, String methodName);
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Test on loop vectorization.
+//
+public class Main {
+
+  /// CHECK-START: void Main.addInvariant(int[], int) loop_optimization (before)
+  /// CHECK-NOT: VecAdd
+  //
+  /// CHECK-START-ARM64: void Main.addInvariant(int[], int) loop_optimization (after)
+  /// CHECK-DAG: VecReplicateScalar loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecLoad            loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: VecAdd             loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: VecStore           loop:<<Loop>>      outer_loop:none
+  private static void addInvariant(int[] a, int x) {
+    for (int i = 0; i < a.length; i++) {
+      a[i] += x;
+    }
+  }
+
+  /// CHECK-START-ARM64: void Main.negNot(long[]) loop_optimization (after)
+  /// CHECK-DAG: VecLoad  loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecNeg   loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: VecNot   loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: VecStore loop:<<Loop>>      outer_loop:none
+  private static void negNot(long[] a) {
+    for (int i = 0; i < a.length; i++) {
+      a[i] = ~(-a[i]);
+    }
+  }
+
+  /// CHECK-START-ARM64: void Main.mulShort(short[]) loop_optimization (after)
+  /// CHECK-DAG: VecLoad  loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecMul   loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: VecStore loop:<<Loop>>      outer_loop:none
+  private static void mulShort(short[] a) {
+    for (int i = 0; i < a.length; i++) {
+      a[i] = (short) (a[i] * 3);
+    }
+  }
+
+  /// CHECK-START-ARM64: int Main.sum(int[]) loop_optimization (after)
+  /// CHECK-DAG: VecLoad   loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecReduce loop:<<Loop>>      outer_loop:none kind:sum
+  private static int sum(int[] a) {
+    int s = 0;
+    for (int i = 0; i < a.length; i++) {
+      s += a[i];
+    }
+    return s;
+  }
+
+  /// CHECK-START-ARM64: long Main.sumWide(long[]) loop_optimization (after)
+  /// CHECK-DAG: VecLoad   loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecReduce loop:<<Loop>>      outer_loop:none kind:sum
+  private static long sumWide(long[] a) {
+    long s = 0;
+    for (int i = 0; i < a.length; i++) {
+      s += a[i];
+    }
+    return s;
+  }
+
+  /// CHECK-START-ARM64: int Main.min(int[]) loop_optimization (after)
+  /// CHECK-DAG: VecLoad   loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecReduce loop:<<Loop>>      outer_loop:none kind:min
+  private static int min(int[] a) {
+    int m = Integer.MAX_VALUE;
+    for (int i = 0; i < a.length; i++) {
+      m = Math.min(m, a[i]);
+    }
+    return m;
+  }
+
+  /// CHECK-START-ARM64: int Main.max(int[]) loop_optimization (after)
+  /// CHECK-DAG: VecLoad   loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecReduce loop:<<Loop>>      outer_loop:none kind:max
+  private static int max(int[] a) {
+    int m = Integer.MIN_VALUE;
+    for (int i = 0; i < a.length; i++) {
+      m = Math.max(m, a[i]);
+    }
+    return m;
+  }
+
+  /// CHECK-START-ARM64: int Main.sumBytes(byte[]) loop_optimization (after)
+  /// CHECK-DAG: VecLoad   loop:<<Loop:B\d+>> outer_loop:none packed_type:PrimInt component_type:PrimByte
+  /// CHECK-DAG: VecReduce loop:<<Loop>>      outer_loop:none kind:sum
+  private static int sumBytes(byte[] a) {
+    int s = 0;
+    for (int i = 0; i < a.length; i++) {
+      s += a[i];
+    }
+    return s;
+  }
+
+  /// CHECK-START: void Main.shift(int[]) loop_optimization (after)
+  /// CHECK-NOT: VecLoad
+  private static void shift(int[] a) {
+    // Loop-carried dependence on the same array.
+    for (int i = 0; i < a.length - 1; i++) {
+      a[i + 1] = a[i];
+    }
+  }
+
+  /// CHECK-START: void Main.noVectorLoop(int[]) loop_optimization (after)
+  /// CHECK-NOT: VecLoad
+  private static void noVectorLoop(int[] a) {
+    // Calls prevent vectorization.
+    for (int i = 0; i < a.length; i++) {
+      a[i] = Integer.bitCount(a[i]) + sideEffect();
+    }
+  }
+
+  private static int sideEffect() {
+    return sDummy++;
+  }
+
+  private static int sDummy = 0;
+
+  public static void main(String[] args) {
+    // Lengths that are not a multiple of any vector length
+    // exercise both the vector loop and the cleanup loop.
+    for (int n = 0; n < 40; n++) {
+      int[] a = new int[n];
+      long[] l = new long[n];
+      short[] s = new short[n];
+      byte[] b = new byte[n];
+      for (int i = 0; i < n; i++) {
+        a[i] = (i & 1) == 0 ? i * 7 : -i * 5;
+        l[i] = i - 100L;
+        s[i] = (short) (i * 1000);
+        b[i] = (byte) (i * 13);
+      }
+      int expectedSum = 0;
+      int expectedMin = Integer.MAX_VALUE;
+      int expectedMax = Integer.MIN_VALUE;
+      int expectedBytes = 0;
+      long expectedWide = 0;
+      for (int i = 0; i < n; i++) {
+        expectedSum += a[i];
+        expectedMin = Math.min(expectedMin, a[i]);
+        expectedMax = Math.max(expectedMax, a[i]);
+        expectedBytes += b[i];
+        expectedWide += l[i];
+      }
+      expectEquals(expectedSum, sum(a));
+      expectEquals(expectedMin, min(a));
+      expectEquals(expectedMax, max(a));
+      expectEquals(expectedBytes, sumBytes(b));
+      expectEquals(expectedWide, sumWide(l));
+
+      addInvariant(a, 11);
+      negNot(l);
+      mulShort(s);
+      for (int i = 0; i < n; i++) {
+        expectEquals(((i & 1) == 0 ? i * 7 : -i * 5) + 11, a[i]);
+        expectEquals(~(-(i - 100L)), l[i]);
+        expectEquals((short) ((short) (i * 1000) * 3), s[i]);
+      }
+
+      shift(a);
+      for (int i = 0; i < n; i++) {
+        expectEquals(11, a[i]);
+      }
+    }
+
+    int[] c = { 1, 2, 3 };
+    noVectorLoop(c);
+    expectEquals(1, c[0]);
+    expectEquals(2, c[1]);
+    expectEquals(4, c[2]);
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(long expected, long result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Test on loop unrolling and peeling.
+//
+public class Main {
+
+  /// CHECK-START: float Main.sum(float[]) loop_optimization (before)
+  /// CHECK:     SuspendCheck loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Loop>>      outer_loop:none
+  /// CHECK-NOT: ArrayGet
+  //
+  /// CHECK-START-ARM64: float Main.sum(float[]) loop_optimization (after)
+  /// CHECK:     SuspendCheck loop:<<Loop:B\d+>>     outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Loop>>          outer_loop:none
+  /// CHECK-NOT: ArrayGet     loop:<<Loop>>
+  /// CHECK:     SuspendCheck loop:<<Unrolled:B\d+>> outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK-NOT: SuspendCheck loop:<<Unrolled>>
+  //
+  /// CHECK-START-X86_64: float Main.sum(float[]) loop_optimization (after)
+  /// CHECK:     SuspendCheck loop:<<Loop:B\d+>>     outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Loop>>          outer_loop:none
+  /// CHECK-NOT: ArrayGet     loop:<<Loop>>
+  /// CHECK:     SuspendCheck loop:<<Unrolled:B\d+>> outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArrayGet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK-NOT: SuspendCheck loop:<<Unrolled>>
+  private static float sum(float[] a) {
+    float s = 0;
+    for (int i = 0; i < a.length; i++) {
+      s += a[i];
+    }
+    return s;
+  }
+
+  /// CHECK-START-ARM64: void Main.swap(double[]) loop_optimization (after)
+  /// CHECK:     SuspendCheck loop:<<Loop:B\d+>>     outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Loop>>          outer_loop:none
+  /// CHECK:     SuspendCheck loop:<<Unrolled:B\d+>> outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Unrolled>>      outer_loop:none
+  //
+  /// CHECK-START-X86_64: void Main.swap(double[]) loop_optimization (after)
+  /// CHECK:     SuspendCheck loop:<<Loop:B\d+>>     outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Loop>>          outer_loop:none
+  /// CHECK:     SuspendCheck loop:<<Unrolled:B\d+>> outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Unrolled>>      outer_loop:none
+  /// CHECK:     ArraySet     loop:<<Unrolled>>      outer_loop:none
+  private static void swap(double[] a) {
+    // Loop carried values that are exchanged between phis.
+    double x = 1;
+    double y = 2;
+    for (int i = 0; i < a.length; i++) {
+      a[i] = x;
+      double t = x;
+      x = y;
+      y = t;
+    }
+  }
+
+  /// CHECK-START: int Main.peelDivZeroCheck(int) loop_optimization (before)
+  /// CHECK-DAG: DivZeroCheck loop:{{B\d+}} outer_loop:none
+  //
+  /// CHECK-START-ARM64: int Main.peelDivZeroCheck(int) loop_optimization (after)
+  /// CHECK-DAG: DivZeroCheck loop:none
+  //
+  /// CHECK-START-X86_64: int Main.peelDivZeroCheck(int) loop_optimization (after)
+  /// CHECK-DAG: DivZeroCheck loop:none
+  //
+  /// CHECK-START-ARM64: int Main.peelDivZeroCheck(int) loop_optimization (after)
+  /// CHECK-NOT: DivZeroCheck loop:{{B\d+}}
+  //
+  /// CHECK-START-X86_64: int Main.peelDivZeroCheck(int) loop_optimization (after)
+  /// CHECK-NOT: DivZeroCheck loop:{{B\d+}}
+  private static int peelDivZeroCheck(int x) {
+    int s = 0;
+    for (int i = 0; i < 100; i++) {
+      s += i / x;
+    }
+    return s;
+  }
+
+  /// CHECK-START: int Main.peelNullCheck(int[]) loop_optimization (before)
+  /// CHECK-DAG: NullCheck loop:{{B\d+}} outer_loop:none
+  //
+  /// CHECK-START-ARM64: int Main.peelNullCheck(int[]) loop_optimization (after)
+  /// CHECK-DAG: NullCheck loop:none
+  //
+  /// CHECK-START-X86_64: int Main.peelNullCheck(int[]) loop_optimization (after)
+  /// CHECK-DAG: NullCheck loop:none
+  //
+  /// CHECK-START-ARM64: int Main.peelNullCheck(int[]) loop_optimization (after)
+  /// CHECK-NOT: NullCheck loop:{{B\d+}}
+  //
+  /// CHECK-START-X86_64: int Main.peelNullCheck(int[]) loop_optimization (after)
+  /// CHECK-NOT: NullCheck loop:{{B\d+}}
+  private static int peelNullCheck(int[] a) {
+    int s = 0;
+    for (int i = 0; i < 10; i++) {
+      s += a.length * i;
+    }
+    return s;
+  }
+
+  /// CHECK-START: void Main.noUnrollCall(int[]) loop_optimization (after)
+  /// CHECK:     SuspendCheck loop:{{B\d+}}
+  /// CHECK-NOT: SuspendCheck loop:{{B\d+}}
+  private static void noUnrollCall(int[] a) {
+    // Calls prevent unrolling.
+    for (int i = 0; i < a.length; i++) {
+      a[i] = sideEffect();
+    }
+  }
+
+  private static int sideEffect() {
+    return sDummy++;
+  }
+
+  private static int sDummy = 0;
+
+  public static void main(String[] args) {
+    // Lengths that are not a multiple of the unrolling factor
+    // exercise both the unrolled loop and the original loop.
+    for (int n = 0; n < 20; n++) {
+      float[] f = new float[n];
+      float expectedSum = 0;
+      for (int i = 0; i < n; i++) {
+        f[i] = i * 0.1f;
+        expectedSum += f[i];
+      }
+      expectEquals(expectedSum, sum(f));
+
+      double[] d = new double[n];
+      swap(d);
+      for (int i = 0; i < n; i++) {
+        expectEquals((i & 1) == 0 ? 1.0 : 2.0, d[i]);
+      }
+    }
+
+    expectEquals(4950, peelDivZeroCheck(1));
+    expectEquals(1617, peelDivZeroCheck(3));
+    try {
+      peelDivZeroCheck(0);
+      throw new Error("Expected ArithmeticException");
+    } catch (ArithmeticException expected) {
+    }
+
+    int[] a = { 1, 2, 3 };
+    expectEquals(45 * 3, peelNullCheck(a));
+    try {
+      peelNullCheck(null);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+
+    noUnrollCall(a);
+    expectEquals(0, a[0]);
+    expectEquals(1, a[1]);
+    expectEquals(2, a[2]);
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(float expected, float result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(double expected, double result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
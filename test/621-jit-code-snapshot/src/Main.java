@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Helper {
+  static int value;
+
+  static {
+    System.out.println("Helper initialized");
+    value = 42;
+  }
+
+  int doubled() {
+    return value * 2;
+  }
+}
+
+public class Main {
+  static final String[] methods = {
+    "$noinline$getStatic", "$noinline$loadString", "$noinline$newInstance"
+  };
+
+  public static void main(String[] args) {
+    System.loadLibrary(args[0]);
+    if (args[1].equals("--install")) {
+      // Install the saved code before the strings and classes it uses are resolved.
+      for (String method : methods) {
+        if (!installSnapshotCode(Main.class, method)) {
+          throw new Error("No code installed from the snapshot for " + method);
+        }
+      }
+    }
+    System.out.println($noinline$getStatic());
+    System.out.println($noinline$loadString());
+    System.out.println($noinline$newInstance().doubled());
+    if (args[1].equals("--save")) {
+      for (String method : methods) {
+        ensureJitCompiled(Main.class, method);
+      }
+      // Check the compiled code before saving it.
+      if ($noinline$getStatic() != 42 ||
+          !$noinline$loadString().equals("a string only used by the snapshot test") ||
+          $noinline$newInstance().doubled() != 84) {
+        throw new Error("Unexpected result of compiled code");
+      }
+    }
+  }
+
+  public static int $noinline$getStatic() {
+    if (doThrow) { throw new Error(); }
+    return Helper.value;
+  }
+
+  public static String $noinline$loadString() {
+    if (doThrow) { throw new Error(); }
+    return "a string only used by the snapshot test";
+  }
+
+  public static Helper $noinline$newInstance() {
+    if (doThrow) { throw new Error(); }
+    return new Helper();
+  }
+
+  // Returns whether the code of the method was installed from the snapshot, which is
+  // always the case if the runtime does not use a JIT code snapshot.
+  private static native boolean installSnapshotCode(Class<?> cls, String methodName);
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+
+  static boolean doThrow = false;
+}
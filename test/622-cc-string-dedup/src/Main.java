@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+
+public class Main {
+  static final String LITERAL = "a string for the deduplication test";
+
+  public static void main(String[] args) throws Exception {
+    Method setCharAt = String.class.getDeclaredMethod("setCharAt", int.class, char.class);
+    setCharAt.setAccessible(true);
+
+    // Equal strings, which a first collection makes old enough to be deduplicated.
+    String hashed = new String(LITERAL);
+    int hash = System.identityHashCode(hashed);
+    String locked = new String(LITERAL);
+    String plain = new String(LITERAL);
+    String plain2 = new String(LITERAL);
+    Runtime.getRuntime().gc();
+
+    synchronized (locked) {
+      // A string allocated right before a collection, and changed right after it, like the
+      // strings which the runtime fills in after allocating them.
+      String building = new String(LITERAL);
+      Runtime.getRuntime().gc();
+      setCharAt.invoke(building, 0, 'A');
+      Runtime.getRuntime().gc();
+
+      if (System.identityHashCode(hashed) == hash && hashed != LITERAL && hashed != plain &&
+          hashed != locked) {
+        System.out.println("Identity hashed string kept");
+      }
+      if (Thread.holdsLock(locked) && locked != LITERAL && locked != plain) {
+        System.out.println("Locked string kept");
+      }
+      if (building.charAt(0) == 'A' && LITERAL.charAt(0) == 'a' && plain.charAt(0) == 'a' &&
+          plain2.charAt(0) == 'a' && locked.charAt(0) == 'a' && hashed.charAt(0) == 'a') {
+        System.out.println("String being built kept");
+      }
+    }
+
+    Runtime.getRuntime().gc();
+    if (plain.equals(LITERAL) && plain2.equals(LITERAL) && hashed.equals(LITERAL) &&
+        locked.equals(LITERAL) && plain.hashCode() == LITERAL.hashCode()) {
+      System.out.println("Equal strings still equal");
+    }
+  }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.ref.WeakReference;
+
+public class Main {
+  static final int NUM_OLD = 1000;
+  static final int ROUNDS = 20;
+  // Enough garbage per round to trigger several concurrent young collections.
+  static final int GARBAGE_PER_ROUND = 16 * 1024 * 1024;
+
+  static class Node {
+    int value;
+    Node next;
+    Node(int value) { this.value = value; }
+  }
+
+  static Object sink;
+
+  public static void main(String[] args) {
+    Node[] old = new Node[NUM_OLD];
+    Object[] oldArray = new Object[NUM_OLD];
+    for (int i = 0; i < NUM_OLD; ++i) {
+      old[i] = new Node(i);
+    }
+    // An explicit collection is a full collection: the objects above are old from now on.
+    Runtime.getRuntime().gc();
+
+    WeakReference<Node> weak = null;
+    Node weakReferent = null;
+    for (int round = 0; round < ROUNDS; ++round) {
+      // Young objects only referenced from old objects.
+      for (int i = 0; i < NUM_OLD; ++i) {
+        Node young = new Node(round * NUM_OLD + i);
+        old[i].next = young;
+        oldArray[i] = new Node(-young.value);
+      }
+      // A strongly reachable young referent, which must not be cleared.
+      weakReferent = new Node(round);
+      old[0].next.next = weakReferent;
+      weak = new WeakReference<Node>(weakReferent);
+      weakReferent = null;
+      makeGarbage();
+      if (round == ROUNDS / 2) {
+        Runtime.getRuntime().gc();
+      }
+      check(old, oldArray, round);
+    }
+
+    System.out.println("old objects intact");
+    System.out.println("young objects intact");
+    Node referent = weak.get();
+    if (referent != old[0].next.next || referent.value != ROUNDS - 1) {
+      throw new Error("Weak reference cleared or wrong");
+    }
+    System.out.println("weak references intact");
+  }
+
+  static void makeGarbage() {
+    for (int allocated = 0; allocated < GARBAGE_PER_ROUND; allocated += 1024) {
+      sink = new byte[1024 - 16];
+    }
+    sink = null;
+  }
+
+  static void check(Node[] old, Object[] oldArray, int round) {
+    for (int i = 0; i < NUM_OLD; ++i) {
+      if (old[i].value != i) {
+        throw new Error("Old object " + i + " corrupted: " + old[i].value);
+      }
+      int expected = round * NUM_OLD + i;
+      if (old[i].next.value != expected) {
+        throw new Error("Young object " + i + " corrupted: " + old[i].next.value);
+      }
+      if (((Node) oldArray[i]).value != -expected) {
+        throw new Error("Young array element " + i + " corrupted");
+      }
+    }
+  }
+}
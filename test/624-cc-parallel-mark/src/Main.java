@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  static final int NUM_TREES = 64;
+  static final int TREE_DEPTH = 10;
+  static final int NUM_COLLECTIONS = 10;
+
+  static class Node {
+    Node left;
+    Node right;
+    // Varied sizes, from small objects to arrays larger than the evacuation TLAB limit.
+    int[] payload;
+    int id;
+  }
+
+  static int nextId = 0;
+
+  static Node makeTree(int depth) {
+    Node node = new Node();
+    node.id = nextId++;
+    node.payload = new int[(node.id % 97 == 0) ? 4 * 1024 : node.id % 64];
+    for (int i = 0; i < node.payload.length; ++i) {
+      node.payload[i] = node.id + i;
+    }
+    if (depth > 0) {
+      node.left = makeTree(depth - 1);
+      node.right = makeTree(depth - 1);
+    }
+    return node;
+  }
+
+  static int checkTree(Node node, int depth) {
+    for (int i = 0; i < node.payload.length; ++i) {
+      if (node.payload[i] != node.id + i) {
+        throw new Error("Corrupted payload of node " + node.id);
+      }
+    }
+    if (depth == 0) {
+      if (node.left != null || node.right != null) {
+        throw new Error("Corrupted leaf " + node.id);
+      }
+      return 1;
+    }
+    return 1 + checkTree(node.left, depth - 1) + checkTree(node.right, depth - 1);
+  }
+
+  static long usedMemory() {
+    Runtime runtime = Runtime.getRuntime();
+    runtime.gc();
+    return runtime.totalMemory() - runtime.freeMemory();
+  }
+
+  public static void main(String[] args) {
+    Node[] trees = new Node[NUM_TREES];
+    for (int i = 0; i < NUM_TREES; ++i) {
+      trees[i] = makeTree(TREE_DEPTH);
+    }
+    int[] hashes = new int[NUM_TREES];
+    for (int i = 0; i < NUM_TREES; ++i) {
+      hashes[i] = System.identityHashCode(trees[i]);
+    }
+
+    long firstUsed = usedMemory();
+    long lastUsed = firstUsed;
+    for (int i = 1; i < NUM_COLLECTIONS; ++i) {
+      lastUsed = usedMemory();
+    }
+
+    int expectedNodes = NUM_TREES * ((1 << (TREE_DEPTH + 1)) - 1);
+    int numNodes = 0;
+    for (int i = 0; i < NUM_TREES; ++i) {
+      if (System.identityHashCode(trees[i]) != hashes[i]) {
+        throw new Error("Identity hash code of tree " + i + " changed");
+      }
+      numNodes += checkTree(trees[i], TREE_DEPTH);
+    }
+    if (numNodes != expectedNodes) {
+      throw new Error("Expected " + expectedNodes + " nodes, got " + numNodes);
+    }
+    System.out.println("graph intact");
+
+    // The copies of the same live set use about as much memory after each collection. The
+    // unused parts of the regions the workers copied into must not be counted as allocated.
+    long slack = firstUsed / 4;
+    if (lastUsed < firstUsed - slack || lastUsed > firstUsed + slack) {
+      System.out.println("heap usage drifted: " + firstUsed + " -> " + lastUsed);
+    } else {
+      System.out.println("heap usage stable");
+    }
+  }
+}
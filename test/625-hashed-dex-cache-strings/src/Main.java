@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  // More than the 1024 slots of the hashed strings cache. The ids of these strings are
+  // consecutive, so the strings at n and at n + 1024 share a slot.
+  static final String[] STRINGS = {
+      "s0000", "s0001", "s0002", "s0003", "s0004", "s0005", "s0006", "s0007", "s0008", "s0009",
+      "s0010", "s0011", "s0012", "s0013", "s0014", "s0015", "s0016", "s0017", "s0018", "s0019",
+      "s0020", "s0021", "s0022", "s0023", "s0024", "s0025", "s0026", "s0027", "s0028", "s0029",
+      "s0030", "s0031", "s0032", "s0033", "s0034", "s0035", "s0036", "s0037", "s0038", "s0039",
+      "s0040", "s0041", "s0042", "s0043", "s0044", "s0045", "s0046", "s0047", "s0048", "s0049",
+      "s0050", "s0051", "s0052", "s0053", "s0054", "s0055", "s0056", "s0057", "s0058", "s0059",
+      "s0060", "s0061", "s0062", "s0063", "s0064", "s0065", "s0066", "s0067", "s0068", "s0069",
+      "s0070", "s0071", "s0072", "s0073", "s0074", "s0075", "s0076", "s0077", "s0078", "s0079",
+      "s0080", "s0081", "s0082", "s0083", "s0084", "s0085", "s0086", "s0087", "s0088", "s0089",
+      "s0090", "s0091", "s0092", "s0093", "s0094", "s0095", "s0096", "s0097", "s0098", "s0099",
+      "s0100", "s0101", "s0102", "s0103", "s0104", "s0105", "s0106", "s0107", "s0108", "s0109",
+      "s0110", "s0111", "s0112", "s0113", "s0114", "s0115", "s0116", "s0117", "s0118", "s0119",
+      "s0120", "s0121", "s0122", "s0123", "s0124", "s0125", "s0126", "s0127", "s0128", "s0129",
+      "s0130", "s0131", "s0132", "s0133", "s0134", "s0135", "s0136", "s0137", "s0138", "s0139",
+      "s0140", "s0141", "s0142", "s0143", "s0144", "s0145", "s0146", "s0147", "s0148", "s0149",
+      "s0150", "s0151", "s0152", "s0153", "s0154", "s0155", "s0156", "s0157", "s0158", "s0159",
+      "s0160", "s0161", "s0162", "s0163", "s0164", "s0165", "s0166", "s0167", "s0168", "s0169",
+      "s0170", "s0171", "s0172", "s0173", "s0174", "s0175", "s0176", "s0177", "s0178", "s0179",
+      "s0180", "s0181", "s0182", "s0183", "s0184", "s0185", "s0186", "s0187", "s0188", "s0189",
+      "s0190", "s0191", "s0192", "s0193", "s0194", "s0195", "s0196", "s0197", "s0198", "s0199",
+      "s0200", "s0201", "s0202", "s0203", "s0204", "s0205", "s0206", "s0207", "s0208", "s0209",
+      "s0210", "s0211", "s0212", "s0213", "s0214", "s0215", "s0216", "s0217", "s0218", "s0219",
+      "s0220", "s0221", "s0222", "s0223", "s0224", "s0225", "s0226", "s0227", "s0228", "s0229",
+      "s0230", "s0231", "s0232", "s0233", "s0234", "s0235", "s0236", "s0237", "s0238", "s0239",
+      "s0240", "s0241", "s0242", "s0243", "s0244", "s0245", "s0246", "s0247", "s0248", "s0249",
+      "s0250", "s0251", "s0252", "s0253", "s0254", "s0255", "s0256", "s0257", "s0258", "s0259",
+      "s0260", "s0261", "s0262", "s0263", "s0264", "s0265", "s0266", "s0267", "s0268", "s0269",
+      "s0270", "s0271", "s0272", "s0273", "s0274", "s0275", "s0276", "s0277", "s0278", "s0279",
+      "s0280", "s0281", "s0282", "s0283", "s0284", "s0285", "s0286", "s0287", "s0288", "s0289",
+      "s0290", "s0291", "s0292", "s0293", "s0294", "s0295", "s0296", "s0297", "s0298", "s0299",
+      "s0300", "s0301", "s0302", "s0303", "s0304", "s0305", "s0306", "s0307", "s0308", "s0309",
+      "s0310", "s0311", "s0312", "s0313", "s0314", "s0315", "s0316", "s0317", "s0318", "s0319",
+      "s0320", "s0321", "s0322", "s0323", "s0324", "s0325", "s0326", "s0327", "s0328", "s0329",
+      "s0330", "s0331", "s0332", "s0333", "s0334", "s0335", "s0336", "s0337", "s0338", "s0339",
+      "s0340", "s0341", "s0342", "s0343", "s0344", "s0345", "s0346", "s0347", "s0348", "s0349",
+      "s0350", "s0351", "s0352", "s0353", "s0354", "s0355", "s0356", "s0357", "s0358", "s0359",
+      "s0360", "s0361", "s0362", "s0363", "s0364", "s0365", "s0366", "s0367", "s0368", "s0369",
+      "s0370", "s0371", "s0372", "s0373", "s0374", "s0375", "s0376", "s0377", "s0378", "s0379",
+      "s0380", "s0381", "s0382", "s0383", "s0384", "s0385", "s0386", "s0387", "s0388", "s0389",
+      "s0390", "s0391", "s0392", "s0393", "s0394", "s0395", "s0396", "s0397", "s0398", "s0399",
+      "s0400", "s0401", "s0402", "s0403", "s0404", "s0405", "s0406", "s0407", "s0408", "s0409",
+      "s0410", "s0411", "s0412", "s0413", "s0414", "s0415", "s0416", "s0417", "s0418", "s0419",
+      "s0420", "s0421", "s0422", "s0423", "s0424", "s0425", "s0426", "s0427", "s0428", "s0429",
+      "s0430", "s0431", "s0432", "s0433", "s0434", "s0435", "s0436", "s0437", "s0438", "s0439",
+      "s0440", "s0441", "s0442", "s0443", "s0444", "s0445", "s0446", "s0447", "s0448", "s0449",
+      "s0450", "s0451", "s0452", "s0453", "s0454", "s0455", "s0456", "s0457", "s0458", "s0459",
+      "s0460", "s0461", "s0462", "s0463", "s0464", "s0465", "s0466", "s0467", "s0468", "s0469",
+      "s0470", "s0471", "s0472", "s0473", "s0474", "s0475", "s0476", "s0477", "s0478", "s0479",
+      "s0480", "s0481", "s0482", "s0483", "s0484", "s0485", "s0486", "s0487", "s0488", "s0489",
+      "s0490", "s0491", "s0492", "s0493", "s0494", "s0495", "s0496", "s0497", "s0498", "s0499",
+      "s0500", "s0501", "s0502", "s0503", "s0504", "s0505", "s0506", "s0507", "s0508", "s0509",
+      "s0510", "s0511", "s0512", "s0513", "s0514", "s0515", "s0516", "s0517", "s0518", "s0519",
+      "s0520", "s0521", "s0522", "s0523", "s0524", "s0525", "s0526", "s0527", "s0528", "s0529",
+      "s0530", "s0531", "s0532", "s0533", "s0534", "s0535", "s0536", "s0537", "s0538", "s0539",
+      "s0540", "s0541", "s0542", "s0543", "s0544", "s0545", "s0546", "s0547", "s0548", "s0549",
+      "s0550", "s0551", "s0552", "s0553", "s0554", "s0555", "s0556", "s0557", "s0558", "s0559",
+      "s0560", "s0561", "s0562", "s0563", "s0564", "s0565", "s0566", "s0567", "s0568", "s0569",
+      "s0570", "s0571", "s0572", "s0573", "s0574", "s0575", "s0576", "s0577", "s0578", "s0579",
+      "s0580", "s0581", "s0582", "s0583", "s0584", "s0585", "s0586", "s0587", "s0588", "s0589",
+      "s0590", "s0591", "s0592", "s0593", "s0594", "s0595", "s0596", "s0597", "s0598", "s0599",
+      "s0600", "s0601", "s0602", "s0603", "s0604", "s0605", "s0606", "s0607", "s0608", "s0609",
+      "s0610", "s0611", "s0612", "s0613", "s0614", "s0615", "s0616", "s0617", "s0618", "s0619",
+      "s0620", "s0621", "s0622", "s0623", "s0624", "s0625", "s0626", "s0627", "s0628", "s0629",
+      "s0630", "s0631", "s0632", "s0633", "s0634", "s0635", "s0636", "s0637", "s0638", "s0639",
+      "s0640", "s0641", "s0642", "s0643", "s0644", "s0645", "s0646", "s0647", "s0648", "s0649",
+      "s0650", "s0651", "s0652", "s0653", "s0654", "s0655", "s0656", "s0657", "s0658", "s0659",
+      "s0660", "s0661", "s0662", "s0663", "s0664", "s0665", "s0666", "s0667", "s0668", "s0669",
+      "s0670", "s0671", "s0672", "s0673", "s0674", "s0675", "s0676", "s0677", "s0678", "s0679",
+      "s0680", "s0681", "s0682", "s0683", "s0684", "s0685", "s0686", "s0687", "s0688", "s0689",
+      "s0690", "s0691", "s0692", "s0693", "s0694", "s0695", "s0696", "s0697", "s0698", "s0699",
+      "s0700", "s0701", "s0702", "s0703", "s0704", "s0705", "s0706", "s0707", "s0708", "s0709",
+      "s0710", "s0711", "s0712", "s0713", "s0714", "s0715", "s0716", "s0717", "s0718", "s0719",
+      "s0720", "s0721", "s0722", "s0723", "s0724", "s0725", "s0726", "s0727", "s0728", "s0729",
+      "s0730", "s0731", "s0732", "s0733", "s0734", "s0735", "s0736", "s0737", "s0738", "s0739",
+      "s0740", "s0741", "s0742", "s0743", "s0744", "s0745", "s0746", "s0747", "s0748", "s0749",
+      "s0750", "s0751", "s0752", "s0753", "s0754", "s0755", "s0756", "s0757", "s0758", "s0759",
+      "s0760", "s0761", "s0762", "s0763", "s0764", "s0765", "s0766", "s0767", "s0768", "s0769",
+      "s0770", "s0771", "s0772", "s0773", "s0774", "s0775", "s0776", "s0777", "s0778", "s0779",
+      "s0780", "s0781", "s0782", "s0783", "s0784", "s0785", "s0786", "s0787", "s0788", "s0789",
+      "s0790", "s0791", "s0792", "s0793", "s0794", "s0795", "s0796", "s0797", "s0798", "s0799",
+      "s0800", "s0801", "s0802", "s0803", "s0804", "s0805", "s0806", "s0807", "s0808", "s0809",
+      "s0810", "s0811", "s0812", "s0813", "s0814", "s0815", "s0816", "s0817", "s0818", "s0819",
+      "s0820", "s0821", "s0822", "s0823", "s0824", "s0825", "s0826", "s0827", "s0828", "s0829",
+      "s0830", "s0831", "s0832", "s0833", "s0834", "s0835", "s0836", "s0837", "s0838", "s0839",
+      "s0840", "s0841", "s0842", "s0843", "s0844", "s0845", "s0846", "s0847", "s0848", "s0849",
+      "s0850", "s0851", "s0852", "s0853", "s0854", "s0855", "s0856", "s0857", "s0858", "s0859",
+      "s0860", "s0861", "s0862", "s0863", "s0864", "s0865", "s0866", "s0867", "s0868", "s0869",
+      "s0870", "s0871", "s0872", "s0873", "s0874", "s0875", "s0876", "s0877", "s0878", "s0879",
+      "s0880", "s0881", "s0882", "s0883", "s0884", "s0885", "s0886", "s0887", "s0888", "s0889",
+      "s0890", "s0891", "s0892", "s0893", "s0894", "s0895", "s0896", "s0897", "s0898", "s0899",
+      "s0900", "s0901", "s0902", "s0903", "s0904", "s0905", "s0906", "s0907", "s0908", "s0909",
+      "s0910", "s0911", "s0912", "s0913", "s0914", "s0915", "s0916", "s0917", "s0918", "s0919",
+      "s0920", "s0921", "s0922", "s0923", "s0924", "s0925", "s0926", "s0927", "s0928", "s0929",
+      "s0930", "s0931", "s0932", "s0933", "s0934", "s0935", "s0936", "s0937", "s0938", "s0939",
+      "s0940", "s0941", "s0942", "s0943", "s0944", "s0945", "s0946", "s0947", "s0948", "s0949",
+      "s0950", "s0951", "s0952", "s0953", "s0954", "s0955", "s0956", "s0957", "s0958", "s0959",
+      "s0960", "s0961", "s0962", "s0963", "s0964", "s0965", "s0966", "s0967", "s0968", "s0969",
+      "s0970", "s0971", "s0972", "s0973", "s0974", "s0975", "s0976", "s0977", "s0978", "s0979",
+      "s0980", "s0981", "s0982", "s0983", "s0984", "s0985", "s0986", "s0987", "s0988", "s0989",
+      "s0990", "s0991", "s0992", "s0993", "s0994", "s0995", "s0996", "s0997", "s0998", "s0999",
+      "s1000", "s1001", "s1002", "s1003", "s1004", "s1005", "s1006", "s1007", "s1008", "s1009",
+      "s1010", "s1011", "s1012", "s1013", "s1014", "s1015", "s1016", "s1017", "s1018", "s1019",
+      "s1020", "s1021", "s1022", "s1023", "s1024", "s1025", "s1026", "s1027", "s1028", "s1029",
+      "s1030", "s1031", "s1032", "s1033", "s1034", "s1035", "s1036", "s1037", "s1038", "s1039",
+      "s1040", "s1041", "s1042", "s1043", "s1044", "s1045", "s1046", "s1047", "s1048", "s1049",
+      "s1050", "s1051", "s1052", "s1053", "s1054", "s1055", "s1056", "s1057", "s1058", "s1059",
+      "s1060", "s1061", "s1062", "s1063", "s1064", "s1065", "s1066", "s1067", "s1068", "s1069",
+      "s1070", "s1071", "s1072", "s1073", "s1074", "s1075", "s1076", "s1077", "s1078", "s1079",
+      "s1080", "s1081", "s1082", "s1083", "s1084", "s1085", "s1086", "s1087", "s1088", "s1089",
+      "s1090", "s1091", "s1092", "s1093", "s1094", "s1095", "s1096", "s1097", "s1098", "s1099",
+  };
+
+  static final int ITERATIONS = 100000;
+
+  public static void main(String[] args) {
+    for (int i = 0; i < ITERATIONS; ++i) {
+      // Alternate between the strings of a slot, so that each load finds the other string.
+      check($noinline$getLow(), 10);
+      check($noinline$getHigh(), 10 + 1024);
+      check($noinline$getBoth(), 70 + 1024);
+    }
+    System.out.println("passed");
+  }
+
+  static void check(String actual, int expected) {
+    // String literals are interned: the same literal is the same object.
+    if (actual != STRINGS[expected]) {
+      throw new Error("Expected " + STRINGS[expected] + ", got " + actual);
+    }
+  }
+
+  static boolean doThrow = false;
+
+  public static String $noinline$getLow() {
+    if (doThrow) { throw new Error(); }
+    return "s0010";
+  }
+
+  public static String $noinline$getHigh() {
+    if (doThrow) { throw new Error(); }
+    return "s1034";
+  }
+
+  public static String $noinline$getBoth() {
+    if (doThrow) { throw new Error(); }
+    String low = "s0070";
+    String high = "s1094";
+    check(low, 70);
+    return high;
+  }
+}
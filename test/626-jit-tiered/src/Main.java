@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+abstract class Shape {
+  abstract int area();
+}
+
+class Square extends Shape {
+  final int side;
+
+  Square(int side) {
+    this.side = side;
+  }
+
+  int area() {
+    return side * side;
+  }
+}
+
+class Rectangle extends Shape {
+  final int width;
+  final int height;
+
+  Rectangle(int width, int height) {
+    this.width = width;
+    this.height = height;
+  }
+
+  int area() {
+    return width * height;
+  }
+}
+
+public class Main {
+  static boolean doThrow = false;
+
+  // The loop back edges and the virtual call are instrumented in baseline code.
+  public static int $noinline$sumAreas(Shape[] shapes) {
+    if (doThrow) { throw new Error(); }
+    int sum = 0;
+    for (Shape shape : shapes) {
+      sum += shape.area();
+    }
+    return sum;
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+
+    Shape[] shapes = new Shape[] {
+        new Square(2), new Rectangle(2, 3), new Square(3), new Rectangle(1, 5) };
+    final int expected = 4 + 6 + 9 + 5;
+
+    // Run the method until it has optimized code. It first runs in the interpreter,
+    // then in baseline code on the instruction sets which have a baseline tier.
+    while (!hasJitCompiledEntrypoint(Main.class, "$noinline$sumAreas") ||
+           hasBaselineCompiledEntrypoint(Main.class, "$noinline$sumAreas")) {
+      for (int i = 0; i < 10000; i++) {
+        assertEquals(expected, $noinline$sumAreas(shapes));
+      }
+      Thread.sleep(1);
+    }
+    assertEquals(expected, $noinline$sumAreas(shapes));
+
+    System.out.println("Done");
+  }
+
+  public static void assertEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static native boolean hasJitCompiledEntrypoint(Class<?> cls, String methodName);
+  private static native boolean hasBaselineCompiledEntrypoint(Class<?> cls, String methodName);
+}